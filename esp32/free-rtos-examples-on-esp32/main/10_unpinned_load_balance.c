@@ -0,0 +1,251 @@
+/**
+ * @file 10_unpinned_load_balance.c
+ * @brief Measures how the ESP32 scheduler spreads unpinned tasks over both cores.
+ *
+ * The workload mixes pinned and unpinned tasks:
+ *   - 2 busy tasks pinned to Core 0  → Core 0 is always deep in work
+ *   - 1 light task pinned to Core 1  → Core 1 is mostly idle
+ *   - WORKER_COUNT unpinned workers  → free to run wherever there is room
+ *
+ * Every REPORT_PERIOD_MS the monitor task prints, for each core:
+ *   - the run-queue length: Ready tasks pinned to that core
+ *   - how much of the period the core spent in its idle task
+ *   - how many work chunks the unpinned workers ran on it
+ * plus the Ready unpinned tasks, which either core may take, and how often
+ * each worker was migrated from one core to the other.
+ *
+ * NOTES:
+ *  - ESP-IDF keeps ONE ready list per priority for both cores. A core that
+ *    runs out of work (enters idle or reaches a tick) takes the highest
+ *    priority Ready task it is allowed to run, so the unpinned workers move to
+ *    the idle core by themselves - there is no per-core queue to steal from.
+ *  - Set PIN_WORKERS to 1 to pin every worker to Core 0 instead. Core 1 then
+ *    sits idle while the workers queue up behind the busy tasks, which is the
+ *    imbalance the shared ready list avoids.
+ *  - Needs ESP-IDF v5.1 or later and, in menuconfig → FreeRTOS:
+ *      * Enable FreeRTOS trace facility
+ *      * Enable FreeRTOS to collect run time stats
+ *      * Enable display of xCoreID in vTaskList
+ */
+
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+#if !defined(CONFIG_FREERTOS_USE_TRACE_FACILITY) || \
+    !defined(CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS) || \
+    !defined(CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID)
+#error "Enable the FreeRTOS trace facility, run time stats and xCoreID in vTaskList in menuconfig"
+#endif
+
+#define WORKER_COUNT      4       // Unpinned worker tasks
+#define WORKER_CHUNK_US   2000    // Busy time of one unit of work
+#define BUSY_BURST_US     8000    // Busy time of one burst of a pinned busy task
+#define REPORT_PERIOD_MS  2000
+#define MAX_TASKS         32      // Size of the uxTaskGetSystemState() snapshot
+#define PIN_WORKERS       0       // 1: pin the workers to Core 0 for comparison
+
+#define NUM_CORES         portNUM_PROCESSORS
+
+
+/*
+ * Counters written by each worker and read by the monitor.
+ * Only the worker writes its own entry, so no locking is needed.
+ */
+typedef struct {
+    volatile uint32_t chunks[NUM_CORES];  // Work chunks run on each core
+    volatile uint32_t migrations;         // Times the worker changed core
+} worker_stats_t;
+
+static worker_stats_t worker_stats[WORKER_COUNT];
+static TaskStatus_t task_status[MAX_TASKS];
+
+
+/**
+ * @brief Spins for the given number of microseconds.
+ *
+ * Stands in for real CPU-bound work. Interrupts and preemption stay enabled,
+ * so the scheduler is free to move the task while it spins.
+ */
+static void burn_cpu(int64_t us)
+{
+    int64_t end = esp_timer_get_time() + us;
+
+    while (esp_timer_get_time() < end) {
+    }
+}
+
+
+/**
+ * @brief Busy task pinned to Core 0.
+ *
+ * Keeps Core 0 loaded: bursts of work with only a 1 tick break between them.
+ */
+void busy_pinned_task(void *pvParameters)
+{
+    (void) pvParameters;
+
+    while (1) {
+        burn_cpu(BUSY_BURST_US);
+        vTaskDelay(1);
+    }
+}
+
+
+/**
+ * @brief Light task pinned to Core 1.
+ *
+ * Does a little work every 100 ms, leaving Core 1 idle most of the time.
+ */
+void light_pinned_task(void *pvParameters)
+{
+    (void) pvParameters;
+
+    while (1) {
+        burn_cpu(WORKER_CHUNK_US);
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+}
+
+
+/**
+ * @brief Worker task, created without core affinity.
+ *
+ * Runs chunks of work and records on which core each chunk ran.
+ * A change of core between two chunks counts as one migration.
+ */
+void worker_task(void *pvParameters)
+{
+    worker_stats_t *stats = (worker_stats_t *) pvParameters;
+    BaseType_t last_core = xPortGetCoreID();
+    uint32_t n = 0;
+
+    while (1) {
+        burn_cpu(WORKER_CHUNK_US);
+
+        BaseType_t core = xPortGetCoreID();
+        stats->chunks[core]++;
+        if (core != last_core) {
+            stats->migrations++;
+            last_core = core;
+        }
+
+        // Block now and then, as real workers wait for input
+        if (++n % 8 == 0) {
+            vTaskDelay(1);
+        }
+    }
+}
+
+
+/**
+ * @brief Prints the per-core statistics every REPORT_PERIOD_MS.
+ *
+ * Run-queue lengths come from a uxTaskGetSystemState() snapshot: a Ready
+ * task counts against the core it is pinned to, or as unpinned.
+ * Idle time is the growth of each core's idle task run time counter
+ * over the period.
+ */
+void monitor_task(void *pvParameters)
+{
+    (void) pvParameters;
+
+    TaskHandle_t idle[NUM_CORES];
+    configRUN_TIME_COUNTER_TYPE last_idle[NUM_CORES] = { 0 };
+    uint32_t last_chunks[NUM_CORES] = { 0 };
+    uint32_t last_migrations = 0;
+    configRUN_TIME_COUNTER_TYPE last_total = 0;
+
+    for (int core = 0; core < NUM_CORES; core++) {
+        idle[core] = xTaskGetIdleTaskHandleForCore(core);
+    }
+
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(REPORT_PERIOD_MS));
+
+        configRUN_TIME_COUNTER_TYPE total = 0;
+        UBaseType_t count = uxTaskGetSystemState(task_status, MAX_TASKS, &total);
+        uint32_t ready[NUM_CORES] = { 0 };
+        uint32_t ready_unpinned = 0;
+        configRUN_TIME_COUNTER_TYPE idle_now[NUM_CORES] = { 0 };
+
+        for (UBaseType_t i = 0; i < count; i++) {
+            TaskStatus_t *t = &task_status[i];
+
+            for (int core = 0; core < NUM_CORES; core++) {
+                if (t->xHandle == idle[core]) {
+                    idle_now[core] = t->ulRunTimeCounter;
+                }
+            }
+
+            if (t->eCurrentState != eReady) {
+                continue;
+            }
+            if (t->xCoreID == tskNO_AFFINITY) {
+                ready_unpinned++;
+            } else if (t->xCoreID < NUM_CORES) {
+                ready[t->xCoreID]++;
+            }
+        }
+
+        configRUN_TIME_COUNTER_TYPE period = total - last_total;
+        uint32_t migrations = 0;
+
+        printf("\n[Balance] %s workers, %u tasks\n", PIN_WORKERS ? "pinned" : "unpinned", (unsigned) count);
+
+        for (int core = 0; core < NUM_CORES; core++) {
+            uint32_t chunks = 0;
+            for (int w = 0; w < WORKER_COUNT; w++) {
+                chunks += worker_stats[w].chunks[core];
+            }
+
+            uint32_t idle_pct = period ? (uint32_t) (((uint64_t) (idle_now[core] - last_idle[core]) * 100U) / period) : 0;
+
+            printf("  Core %d: run queue %lu  idle %3lu%%  worker chunks %lu\n",
+                   core, (unsigned long) ready[core], (unsigned long) idle_pct,
+                   (unsigned long) (chunks - last_chunks[core]));
+
+            last_idle[core] = idle_now[core];
+            last_chunks[core] = chunks;
+        }
+
+        for (int w = 0; w < WORKER_COUNT; w++) {
+            migrations += worker_stats[w].migrations;
+        }
+
+        printf("  Unpinned ready %lu  migrations %lu\n",
+               (unsigned long) ready_unpinned, (unsigned long) (migrations - last_migrations));
+
+        last_migrations = migrations;
+        last_total = total;
+    }
+}
+
+
+/**
+ * @brief Application entry point (called automatically by ESP-IDF).
+ *
+ * The busy tasks and the workers share priority 4 so they time slice on a
+ * loaded core; the monitor runs above them so its reports stay on time.
+ */
+void app_main(void)
+{
+    printf("FreeRTOS Unpinned Load Balance Example Starting...\n");
+
+    for (int i = 0; i < 2; i++) {
+        xTaskCreatePinnedToCore(busy_pinned_task, "Busy_Core0", 2048, NULL, 4, NULL, 0);
+    }
+    xTaskCreatePinnedToCore(light_pinned_task, "Light_Core1", 2048, NULL, 4, NULL, 1);
+
+    for (int w = 0; w < WORKER_COUNT; w++) {
+        char name[configMAX_TASK_NAME_LEN];
+        snprintf(name, sizeof(name), "Worker_%d", w);
+
+        // tskNO_AFFINITY is what xTaskCreate() uses: either core may run it
+        xTaskCreatePinnedToCore(worker_task, name, 2048, &worker_stats[w], 4, NULL,
+                                PIN_WORKERS ? 0 : tskNO_AFFINITY);
+    }
+
+    xTaskCreatePinnedToCore(monitor_task, "Monitor", 4096, NULL, 6, NULL, 1);
+}
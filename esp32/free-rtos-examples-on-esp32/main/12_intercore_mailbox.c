@@ -0,0 +1,416 @@
+/**
+ * @file 12_intercore_mailbox.c
+ * @brief Lock-free mailboxes between the two ESP32 cores, compared with queues.
+ *
+ * Every ordered pair of cores gets its own single-producer/single-consumer
+ * ring: Core 0 → Core 1 and Core 1 → Core 0. Sending a message is a copy into
+ * the ring and one index update, with no kernel lock. Each core runs a
+ * mailbox task, its "doorbell handler", which:
+ *   1. drains every ring addressed to its core, in batches,
+ *   2. handles each message or wakes the local task waiting for it,
+ *   3. arms its doorbell and sleeps when all its rings are empty.
+ * A sender only rings the doorbell (a task notification, which interrupts the
+ * other core) when the receiver has armed it, so a burst of messages costs
+ * one wake-up instead of one per message.
+ *
+ * The same two tests run first over two FreeRTOS queues, then over the
+ * mailboxes:
+ *   - ping-pong: Core 0 sends PING_COUNT pings, one at a time, to Core 1 and
+ *     waits for each pong → average and worst round-trip time
+ *   - stream:    Core 0 sends STREAM_COUNT messages as fast as it can
+ *     → messages per second, and for the mailboxes the average batch drained
+ *     per wake-up
+ *
+ * NOTES:
+ *  - Any task on a core may send: the sender masks interrupts on its own core
+ *    while it fills the slot, so the ring still has one producer at a time.
+ *    Only the mailbox task of the target core reads a ring.
+ *  - The doorbell itself still goes through the kernel (xTaskNotifyGive), but
+ *    only on the empty → non-empty edge, never per message.
+ *  - Round trips are timed with Core 0's cycle counter, from send to pong.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
+
+#define RING_SLOTS          64      // Messages per ring, a power of two
+#define BATCH_MAX           16      // Messages drained from one ring before looking at the next
+#define PING_COUNT          10000
+#define STREAM_COUNT        200000
+#define QUEUE_LENGTH        RING_SLOTS
+#define MAILBOX_PRIORITY    10      // Doorbell handlers run above the application tasks
+
+#define NUM_CORES           portNUM_PROCESSORS
+
+typedef enum {
+    MSG_PING,
+    MSG_PONG,
+    MSG_DATA,
+    MSG_DONE,
+} msg_type_t;
+
+typedef struct {
+    uint32_t type;
+    uint32_t seq;
+} mbox_msg_t;
+
+/*
+ * One direction between two cores. 'head' is written only by the sending
+ * core and 'tail' only by the receiving core.
+ */
+typedef struct {
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    mbox_msg_t slots[RING_SLOTS];
+} ring_t;
+
+/*
+ * The doorbell of one core. 'armed' is set by the mailbox task just before it
+ * sleeps, and tells senders that the next message needs a wake-up.
+ */
+typedef struct {
+    TaskHandle_t task;
+    volatile uint32_t armed;
+    uint32_t wakeups;       // Times the mailbox task was woken by the doorbell
+    uint32_t batches;       // Drains that found at least one message
+    uint32_t messages;
+} doorbell_t;
+
+static ring_t rings[NUM_CORES][NUM_CORES];   // [from][to]
+static doorbell_t doorbells[NUM_CORES];
+
+static TaskHandle_t client_task;             // Waits for pongs and for the end of a stream, on Core 0
+static QueueHandle_t queue_to_core1;
+static QueueHandle_t queue_to_core0;
+static uint32_t stream_next;                 // Next stream sequence number Core 1 expects
+static uint32_t stream_errors;               // Stream messages that arrived out of order
+
+
+static bool ring_put(ring_t *r, const mbox_msg_t *msg)
+{
+    uint32_t head = r->head;
+
+    if (head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) == RING_SLOTS) {
+        return false;
+    }
+
+    r->slots[head % RING_SLOTS] = *msg;
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+
+static bool ring_get(ring_t *r, mbox_msg_t *msg)
+{
+    uint32_t tail = r->tail;
+
+    if (__atomic_load_n(&r->head, __ATOMIC_ACQUIRE) == tail) {
+        return false;
+    }
+
+    *msg = r->slots[tail % RING_SLOTS];
+    __atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+
+/**
+ * @brief Wakes the mailbox task of a core if it is asleep.
+ *
+ * The fence orders the message just published before the read of 'armed'.
+ * The mailbox task does the opposite (sets 'armed', fence, checks the rings),
+ * so either it sees the message or the sender sees the doorbell armed.
+ */
+static void doorbell_ring(int core)
+{
+    doorbell_t *db = &doorbells[core];
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if (db->armed) {
+        db->armed = 0;
+        xTaskNotifyGive(db->task);
+    }
+}
+
+
+/**
+ * @brief Sends a message to another core. Returns false if the ring is full.
+ *
+ * Interrupts are masked on this core only, which keeps other senders on the
+ * same core out of the ring without a lock the other core could contend for.
+ */
+static bool mailbox_send(int to, const mbox_msg_t *msg)
+{
+    UBaseType_t state = portSET_INTERRUPT_MASK_FROM_ISR();
+    bool sent = ring_put(&rings[xPortGetCoreID()][to], msg);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+
+    if (sent) {
+        doorbell_ring(to);
+    }
+    return sent;
+}
+
+
+/**
+ * @brief Sends a message, yielding while the ring is full.
+ */
+static void mailbox_send_wait(int to, mbox_msg_t msg)
+{
+    while (!mailbox_send(to, &msg)) {
+        taskYIELD();
+    }
+}
+
+
+/**
+ * @brief Handles one message on the receiving core.
+ */
+static void mailbox_handle(int from, const mbox_msg_t *msg)
+{
+    switch (msg->type) {
+    case MSG_PING:
+        mailbox_send_wait(from, (mbox_msg_t) { MSG_PONG, msg->seq });
+        break;
+
+    case MSG_DATA:
+        if (msg->seq != stream_next) {
+            stream_errors++;
+        }
+        stream_next = msg->seq + 1;
+        if (stream_next == STREAM_COUNT) {
+            mailbox_send_wait(from, (mbox_msg_t) { MSG_DONE, stream_errors });
+        }
+        break;
+
+    case MSG_PONG:
+    case MSG_DONE:
+        // The client runs on this core, so this wake-up stays local
+        xTaskNotifyGive(client_task);
+        break;
+    }
+}
+
+
+/**
+ * @brief Drains up to BATCH_MAX messages from every ring addressed to a core.
+ * @return The number of messages handled.
+ */
+static uint32_t mailbox_drain(int core)
+{
+    mbox_msg_t msg;
+    uint32_t handled = 0;
+
+    for (int from = 0; from < NUM_CORES; from++) {
+        if (from == core) {
+            continue;
+        }
+        for (int n = 0; n < BATCH_MAX && ring_get(&rings[from][core], &msg); n++) {
+            mailbox_handle(from, &msg);
+            handled++;
+        }
+    }
+    return handled;
+}
+
+
+static bool mailbox_pending(int core)
+{
+    for (int from = 0; from < NUM_CORES; from++) {
+        if (from != core && rings[from][core].head != rings[from][core].tail) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * @brief Doorbell handler, one pinned to each core.
+ */
+void mailbox_task(void *pvParameters)
+{
+    int core = xPortGetCoreID();
+    doorbell_t *db = &doorbells[core];
+
+    (void) pvParameters;
+
+    while (1) {
+        uint32_t n = mailbox_drain(core);
+
+        if (n > 0) {
+            db->batches++;
+            db->messages += n;
+            continue;
+        }
+
+        // Arm the doorbell, then look once more: see doorbell_ring()
+        db->armed = 1;
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        if (!mailbox_pending(core)) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            db->wakeups++;
+        }
+        db->armed = 0;
+    }
+}
+
+
+/**
+ * @brief Core 1 side of the queue test: answers pings and counts the stream.
+ */
+void queue_echo_task(void *pvParameters)
+{
+    mbox_msg_t msg;
+
+    (void) pvParameters;
+
+    while (1) {
+        xQueueReceive(queue_to_core1, &msg, portMAX_DELAY);
+
+        if (msg.type == MSG_PING) {
+            msg.type = MSG_PONG;
+            xQueueSend(queue_to_core0, &msg, portMAX_DELAY);
+        } else if (msg.type == MSG_DATA) {
+            if (msg.seq != stream_next) {
+                stream_errors++;
+            }
+            stream_next = msg.seq + 1;
+            if (stream_next == STREAM_COUNT) {
+                msg = (mbox_msg_t) { MSG_DONE, stream_errors };
+                xQueueSend(queue_to_core0, &msg, portMAX_DELAY);
+            }
+        }
+    }
+}
+
+
+static void print_results(const char *name, uint64_t rtt_cycles, uint32_t rtt_max, int64_t stream_us)
+{
+    uint32_t cpu_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+
+    printf("\n[%s]\n", name);
+    printf("  round trip avg %lu ns  max %lu ns\n",
+           (unsigned long) (rtt_cycles * 1000ULL / PING_COUNT / cpu_mhz),
+           (unsigned long) (rtt_max * 1000ULL / cpu_mhz));
+    printf("  stream %lu msgs/s, %lu out of order\n",
+           (unsigned long) (STREAM_COUNT * 1000000ULL / (uint64_t) stream_us),
+           (unsigned long) stream_errors);
+}
+
+
+static void run_queue_test(void)
+{
+    mbox_msg_t msg;
+    uint64_t rtt_total = 0;
+    uint32_t rtt_max = 0;
+
+    stream_next = stream_errors = 0;
+
+    for (uint32_t i = 0; i < PING_COUNT; i++) {
+        uint32_t start = esp_cpu_get_cycle_count();
+
+        msg = (mbox_msg_t) { MSG_PING, i };
+        xQueueSend(queue_to_core1, &msg, portMAX_DELAY);
+        xQueueReceive(queue_to_core0, &msg, portMAX_DELAY);
+
+        uint32_t rtt = esp_cpu_get_cycle_count() - start;
+        rtt_total += rtt;
+        if (rtt > rtt_max) {
+            rtt_max = rtt;
+        }
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < STREAM_COUNT; i++) {
+        msg = (mbox_msg_t) { MSG_DATA, i };
+        xQueueSend(queue_to_core1, &msg, portMAX_DELAY);
+    }
+    xQueueReceive(queue_to_core0, &msg, portMAX_DELAY);
+
+    print_results("Queues", rtt_total, rtt_max, esp_timer_get_time() - start_us);
+}
+
+
+static void run_mailbox_test(void)
+{
+    doorbell_t *db = &doorbells[1];
+    uint64_t rtt_total = 0;
+    uint32_t rtt_max = 0;
+
+    stream_next = stream_errors = 0;
+
+    for (uint32_t i = 0; i < PING_COUNT; i++) {
+        uint32_t start = esp_cpu_get_cycle_count();
+
+        mailbox_send_wait(1, (mbox_msg_t) { MSG_PING, i });
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        uint32_t rtt = esp_cpu_get_cycle_count() - start;
+        rtt_total += rtt;
+        if (rtt > rtt_max) {
+            rtt_max = rtt;
+        }
+    }
+
+    // Count Core 1's wake-ups and batches for the stream only
+    db->wakeups = db->batches = db->messages = 0;
+
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < STREAM_COUNT; i++) {
+        mailbox_send_wait(1, (mbox_msg_t) { MSG_DATA, i });
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    print_results("Mailboxes", rtt_total, rtt_max, esp_timer_get_time() - start_us);
+    printf("  Core 1: %lu doorbell wake-ups, %lu batches, %lu msgs per batch\n",
+           (unsigned long) db->wakeups, (unsigned long) db->batches,
+           (unsigned long) (db->batches ? db->messages / db->batches : 0));
+}
+
+
+/**
+ * @brief Runs both tests from Core 0.
+ */
+void client(void *pvParameters)
+{
+    (void) pvParameters;
+
+    run_queue_test();
+    run_mailbox_test();
+
+    vTaskDelete(NULL);
+}
+
+
+/**
+ * @brief Application entry point (called automatically by ESP-IDF).
+ */
+void app_main(void)
+{
+    printf("FreeRTOS Inter-Core Mailbox Example Starting...\n");
+
+    queue_to_core1 = xQueueCreate(QUEUE_LENGTH, sizeof(mbox_msg_t));
+    queue_to_core0 = xQueueCreate(QUEUE_LENGTH, sizeof(mbox_msg_t));
+
+    if (queue_to_core1 == NULL || queue_to_core0 == NULL) {
+        printf("Failed to create queues! Stopping.\n");
+        return;
+    }
+
+    for (int core = 0; core < NUM_CORES; core++) {
+        xTaskCreatePinnedToCore(mailbox_task, "Mailbox", 2048, NULL, MAILBOX_PRIORITY,
+                                &doorbells[core].task, core);
+    }
+    xTaskCreatePinnedToCore(queue_echo_task, "Queue_Echo", 2048, NULL, MAILBOX_PRIORITY, NULL, 1);
+
+    xTaskCreatePinnedToCore(client, "Client", 4096, NULL, 5, &client_task, 0);
+}
@@ -3,7 +3,7 @@
 
 #define configUSE_PREEMPTION                    1
 #define configUSE_IDLE_HOOK                     0
-#define configUSE_TICK_HOOK                     0
+#define configUSE_TICK_HOOK                     configUSE_IRQ_REPLAY
 #define configCPU_CLOCK_HZ                      ( ( unsigned long ) 1000000 )
 #define configTICK_RATE_HZ                      ( ( TickType_t ) 1000 )
 #define configMAX_PRIORITIES                    4
@@ -16,4 +16,81 @@
 /* Enable the simple malloc scheme */
 #define configSUPPORT_DYNAMIC_ALLOCATION        1
 
+/* Per-task hardware performance counters, only on the Linux (POSIX port)
+   build. See perf_counters.h. */
+#ifndef configUSE_PERF_COUNTERS
+    #ifdef __linux__
+        #define configUSE_PERF_COUNTERS             1
+    #else
+        #define configUSE_PERF_COUNTERS             0
+    #endif
+#endif
+
+#if ( configUSE_PERF_COUNTERS == 1 )
+    #include "perf_counters.h"
+
+    #define configUSE_TRACE_FACILITY            1
+    #define perfTASK_SWITCHED_IN()              perf_counters_switched_in( pxCurrentTCB )
+    #define perfTASK_SWITCHED_OUT()             perf_counters_switched_out( pxCurrentTCB )
+    #define perfTASK_DELETE( pxTaskToDelete )   perf_counters_task_deleted( pxTaskToDelete )
+#else
+    #define perfTASK_SWITCHED_IN()
+    #define perfTASK_SWITCHED_OUT()
+    #define perfTASK_DELETE( pxTaskToDelete )
+#endif
+
+/* Read-only guard page at the bottom of each task stack, only on the Linux
+   build. An overflow into it calls vApplicationStackOverflowHook(). See
+   stack_guard.h. */
+#ifndef configUSE_STACK_GUARD
+    #ifdef __linux__
+        #define configUSE_STACK_GUARD               1
+    #else
+        #define configUSE_STACK_GUARD               0
+    #endif
+#endif
+
+#if ( configUSE_STACK_GUARD == 1 )
+    #include "stack_guard.h"
+
+    /* The create hook needs both ends of the stack. */
+    #define configRECORD_STACK_HIGH_ADDRESS     1
+    #define traceTASK_CREATE( pxNewTCB )        stack_guard_task_created( pxNewTCB, pxNewTCB->pxStack, pxNewTCB->pxEndOfStack )
+    #define guardTASK_SWITCHED_OUT()            stack_guard_switched_out( pxCurrentTCB )
+    #define guardTASK_DELETE( pxTaskToDelete )  stack_guard_task_deleted( pxTaskToDelete )
+#else
+    #define guardTASK_SWITCHED_OUT()
+    #define guardTASK_DELETE( pxTaskToDelete )
+#endif
+
+#if ( configUSE_PERF_COUNTERS == 1 ) || ( configUSE_STACK_GUARD == 1 )
+    #define traceTASK_SWITCHED_IN()             perfTASK_SWITCHED_IN()
+    #define traceTASK_SWITCHED_OUT()            do { perfTASK_SWITCHED_OUT(); guardTASK_SWITCHED_OUT(); } while( 0 )
+    #define traceTASK_DELETE( pxTaskToDelete )  do { perfTASK_DELETE( pxTaskToDelete ); guardTASK_DELETE( pxTaskToDelete ); } while( 0 )
+#endif
+
+/* Statistical PC sampler driven by SIGPROF, only on the Linux build. Prints
+   captures for tools/pcprof. See pc_sampler.h. */
+#ifndef configUSE_PC_SAMPLER
+    #ifdef __linux__
+        #define configUSE_PC_SAMPLER                1
+    #else
+        #define configUSE_PC_SAMPLER                0
+    #endif
+#endif
+
+#if ( configUSE_PC_SAMPLER == 1 )
+    #include "pc_sampler.h"
+
+    #define configUSE_TRACE_FACILITY            1
+    #define INCLUDE_xTaskGetCurrentTaskHandle   1
+#endif
+
+/* Replay of an interrupt log recorded on the target, only on the Linux build.
+   `make replay` turns it on. The tick hook delivers the events. See
+   irq_replay.h. */
+#ifndef configUSE_IRQ_REPLAY
+    #define configUSE_IRQ_REPLAY                0
+#endif
+
 #endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,357 @@
+// File: irq_replay.c
+// Description:
+// Replays an interrupt log recorded on the target, for the Linux (POSIX port)
+// build.
+// - irq_replay_load() decodes the "irq" lines of a target log into a list of
+//   events, each with its arrival time since the recording started.
+// - irq_replay_tick() runs in the tick hook. It converts the ticks since the
+//   scheduler started into virtual time and calls the handler of every event
+//   that has arrived by then, in the recorded order.
+// - irq_replay_done() closes the oldest open event of a source, so the report
+//   can show how long the application took with each one.
+// Events are delivered at tick resolution: all the events of one tick period
+// are handled in the tick that ends it. The schedule only depends on the log
+// and the tick rate, so runs can be compared across kernel changes. The
+// latencies in wall-clock time do depend on the host's load, so compare them
+// over several runs.
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "irq_replay.h"
+
+#define IRQ_REPLAY_SOURCES  256
+#define IRQ_REPLAY_LINE_LEN 512
+
+typedef struct
+{
+    uint64_t time_ns;           // arrival, since the recording started
+    uint32_t payload;
+    uint8_t source;
+    uint8_t delivered;
+    uint8_t done;
+    TickType_t delivered_tick;
+    TickType_t done_tick;
+    uint64_t delivered_wall_ns;
+    uint64_t done_wall_ns;
+} irq_replay_event_t;
+
+static irq_replay_event_t *replay_events = NULL;
+static size_t replay_count = 0;
+static size_t replay_next = 0;          // next event to deliver
+static size_t replay_done_cursor[IRQ_REPLAY_SOURCES];
+static irq_replay_handler_t replay_handlers[IRQ_REPLAY_SOURCES];
+static unsigned long replay_cpu_hz = 0;
+static unsigned long replay_tick_hz = 0;
+static unsigned long replay_lost = 0;
+
+static int replay_started = 0;
+static TickType_t replay_start_tick;
+static TickType_t replay_last_delivery_tick;
+
+static uint64_t wall_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+// ============================================================================
+// Loading
+// ============================================================================
+static int read_varint(const uint8_t *data, size_t size, size_t *pos, uint32_t *value)
+{
+    *value = 0;
+
+    for (int shift = 0; shift < 35 && *pos < size; shift += 7)
+    {
+        uint8_t byte = data[(*pos)++];
+
+        *value |= (uint32_t) (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int decode_log(const uint8_t *data, size_t size, unsigned long events)
+{
+    uint64_t cycles = 0;
+    size_t pos = 0;
+
+    replay_events = calloc(events > 0 ? events : 1, sizeof(irq_replay_event_t));
+    if (replay_events == NULL)
+    {
+        return -1;
+    }
+
+    for (replay_count = 0; replay_count < events; replay_count++)
+    {
+        irq_replay_event_t *e = &replay_events[replay_count];
+        uint32_t delta;
+
+        if (!read_varint(data, size, &pos, &delta) || pos >= size)
+        {
+            return -1;
+        }
+        e->source = data[pos++];
+        if (!read_varint(data, size, &pos, &e->payload))
+        {
+            return -1;
+        }
+
+        cycles += delta;
+        e->time_ns = cycles / replay_cpu_hz * 1000000000ULL +
+                     cycles % replay_cpu_hz * 1000000000ULL / replay_cpu_hz;
+    }
+
+    return pos == size ? (int) replay_count : -1;
+}
+
+int irq_replay_load(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[IRQ_REPLAY_LINE_LEN];
+    uint8_t *data = NULL;
+    size_t size = 0, capacity = 0;
+    unsigned long events, bytes;
+    int in_log = 0;
+    int result = -1;
+
+    if (f == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        if (sscanf(line, "irq begin %lu %lu", &replay_cpu_hz, &replay_tick_hz) == 2 && replay_cpu_hz != 0)
+        {
+            // A later log replaces an incomplete one.
+            in_log = 1;
+            size = 0;
+        }
+        else if (in_log && strncmp(line, "irq d ", 6) == 0)
+        {
+            for (const char *p = line + 6; p[0] != '\0' && p[1] != '\0'; p += 2)
+            {
+                unsigned int byte;
+
+                if (sscanf(p, "%2x", &byte) != 1)
+                {
+                    break;
+                }
+                if (size == capacity)
+                {
+                    capacity = capacity ? capacity * 2 : 4096;
+                    data = realloc(data, capacity);
+                    if (data == NULL)
+                    {
+                        fclose(f);
+                        return -1;
+                    }
+                }
+                data[size++] = (uint8_t) byte;
+            }
+        }
+        else if (in_log && sscanf(line, "irq end %lx %lx %lx", &events, &bytes, &replay_lost) == 3)
+        {
+            if (bytes == size)
+            {
+                result = decode_log(data, size, events);
+            }
+            break;
+        }
+    }
+
+    fclose(f);
+    free(data);
+
+    if (result < 0)
+    {
+        fprintf(stderr, "%s: no complete interrupt log\n", path);
+        return -1;
+    }
+
+    printf("IRQ replay: %d events over %.3f s, recorded at %lu Hz with a %lu Hz tick\n",
+           result, replay_count ? (double) replay_events[replay_count - 1].time_ns / 1e9 : 0.0,
+           replay_cpu_hz, replay_tick_hz);
+    if (replay_lost != 0)
+    {
+        printf("IRQ replay: the recording was full, %lu later events are missing\n", replay_lost);
+    }
+    if (replay_tick_hz != configTICK_RATE_HZ)
+    {
+        printf("IRQ replay: the target tick was %lu Hz, this build's is %lu Hz\n",
+               replay_tick_hz, (unsigned long) configTICK_RATE_HZ);
+    }
+    return result;
+}
+
+void irq_replay_register(uint8_t source, irq_replay_handler_t handler)
+{
+    replay_handlers[source] = handler;
+}
+
+// ============================================================================
+// Delivery
+// ============================================================================
+void irq_replay_tick(void)
+{
+    BaseType_t woken = pdFALSE;
+    TickType_t now = xTaskGetTickCountFromISR();
+    uint64_t virtual_ns;
+
+    if (!replay_started)
+    {
+        replay_started = 1;
+        replay_start_tick = now;
+    }
+
+    virtual_ns = (uint64_t) (TickType_t) (now - replay_start_tick) * (1000000000ULL / configTICK_RATE_HZ);
+
+    while (replay_next < replay_count && replay_events[replay_next].time_ns <= virtual_ns)
+    {
+        irq_replay_event_t *e = &replay_events[replay_next];
+
+        e->delivered_tick = now;
+        e->delivered_wall_ns = wall_ns();
+        e->delivered = 1;
+        replay_last_delivery_tick = now;
+        replay_next++;
+
+        if (replay_handlers[e->source] != NULL)
+        {
+            replay_handlers[e->source](e->payload, &woken);
+        }
+    }
+
+    // The kernel switches to a task woken here at the end of the tick.
+    (void) woken;
+}
+
+void irq_replay_done(uint8_t source)
+{
+    uint64_t now = wall_ns();
+
+    taskENTER_CRITICAL();
+    for (size_t i = replay_done_cursor[source]; i < replay_next; i++)
+    {
+        irq_replay_event_t *e = &replay_events[i];
+
+        if (e->source == source && !e->done)
+        {
+            e->done = 1;
+            e->done_tick = xTaskGetTickCount();
+            e->done_wall_ns = now;
+            replay_done_cursor[source] = i + 1;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+int irq_replay_finished(void)
+{
+    int finished = 0;
+
+    taskENTER_CRITICAL();
+    if (replay_started && replay_next == replay_count)
+    {
+        finished = 1;
+        for (size_t i = 0; i < replay_count && finished; i++)
+        {
+            if (replay_handlers[replay_events[i].source] != NULL && !replay_events[i].done)
+            {
+                finished = 0;
+            }
+        }
+        if ((TickType_t) (xTaskGetTickCount() - replay_last_delivery_tick) >= IRQ_REPLAY_SETTLE_TICKS)
+        {
+            finished = 1;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return finished;
+}
+
+// ============================================================================
+// Report
+// ============================================================================
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+void irq_replay_report(void)
+{
+    uint64_t *latency = malloc((replay_count > 0 ? replay_count : 1) * sizeof(uint64_t));
+
+    if (latency == NULL)
+    {
+        return;
+    }
+
+    printf("%-6s %8s %8s %8s %10s %10s %10s %9s\n",
+           "Source", "Events", "Handled", "Done", "p50 us", "p99 us", "Max us", "Max ticks");
+
+    for (int source = 0; source < IRQ_REPLAY_SOURCES; source++)
+    {
+        size_t events = 0, done = 0;
+        TickType_t max_ticks = 0;
+
+        for (size_t i = 0; i < replay_count; i++)
+        {
+            const irq_replay_event_t *e = &replay_events[i];
+
+            if (e->source != source)
+            {
+                continue;
+            }
+            events++;
+            if (e->done)
+            {
+                latency[done++] = e->done_wall_ns - e->delivered_wall_ns;
+                if ((TickType_t) (e->done_tick - e->delivered_tick) > max_ticks)
+                {
+                    max_ticks = e->done_tick - e->delivered_tick;
+                }
+            }
+        }
+
+        if (events == 0)
+        {
+            continue;
+        }
+
+        printf("%-6d %8zu %8s %8zu", source, events, replay_handlers[source] ? "yes" : "no", done);
+        if (done > 0)
+        {
+            qsort(latency, done, sizeof(uint64_t), compare_u64);
+            printf(" %10.1f %10.1f %10.1f %9lu\n",
+                   (double) latency[(done - 1) / 2] / 1000.0,
+                   (double) latency[(done * 99 + 99) / 100 - 1] / 1000.0,
+                   (double) latency[done - 1] / 1000.0,
+                   (unsigned long) max_ticks);
+        }
+        else
+        {
+            printf(" %10s %10s %10s %9s\n", "-", "-", "-", "-");
+        }
+    }
+
+    free(latency);
+}
@@ -0,0 +1,62 @@
+// File: irq_replay.h
+// Description:
+// Replays an interrupt log recorded on the target by irq_record.c (see
+// stm32/05_04_Template/Core/Inc/irq_record.h) in the Linux (POSIX port) build.
+// The application registers, for each source, the same handler its interrupt
+// service routine calls on the target. The kernel tick hook then calls each
+// handler with the recorded payload once the virtual time since the scheduler
+// started reaches the time the interrupt arrived. Virtual time is the tick
+// count, so the same log gives the same injection schedule on every run and
+// on every kernel version.
+//
+// To measure how long the application takes to deal with an event, the task
+// that finishes the work calls irq_replay_done() with the event's source.
+// irq_replay_report() prints the latencies per source.
+
+#ifndef IRQ_REPLAY_H
+#define IRQ_REPLAY_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+// Source numbers, as in irq_record.h.
+#define IRQ_REPLAY_USART_RX     1
+#define IRQ_REPLAY_EXTI         2
+#define IRQ_REPLAY_DMA          3
+#define IRQ_REPLAY_USER         16
+
+// Ticks to wait after the last event for the application to finish with it
+// before irq_replay_finished() returns 1.
+#ifndef IRQ_REPLAY_SETTLE_TICKS
+#define IRQ_REPLAY_SETTLE_TICKS 1000
+#endif
+
+// Called in interrupt context, like the handler on the target. Set
+// *higher_priority_task_woken as the FromISR API calls do; the kernel switches
+// to the woken task at the end of the tick.
+typedef void (*irq_replay_handler_t)(uint32_t payload, BaseType_t *higher_priority_task_woken);
+
+// Reads the "irq" lines of a target log. Other lines are skipped. Returns the
+// number of events, or -1 if the file cannot be read or holds no complete log.
+int irq_replay_load(const char *path);
+
+// Sets the handler of a source. Events of a source without a handler are
+// counted but not delivered.
+void irq_replay_register(uint8_t source, irq_replay_handler_t handler);
+
+// Delivers the events that are due. Call from vApplicationTickHook().
+void irq_replay_tick(void);
+
+// Marks the oldest delivered, not yet done event of the source as done.
+// Call from a task.
+void irq_replay_done(uint8_t source);
+
+// Returns 1 once every event has been delivered and either every handled
+// event is done or IRQ_REPLAY_SETTLE_TICKS have passed since the last one.
+int irq_replay_finished(void);
+
+// Prints, per source, the events delivered and done and the latency from
+// delivery to done: in wall-clock microseconds and in ticks.
+void irq_replay_report(void);
+
+#endif // IRQ_REPLAY_H
@@ -2,6 +2,22 @@
 #include "FreeRTOS.h"
 #include "task.h"
 
+#if (configUSE_STACK_GUARD == 1)
+#include <stdlib.h>
+
+// Room for a thread stack above the guard page. See stack_guard.h.
+#define TASK_STACK_DEPTH 4096
+#else
+#define TASK_STACK_DEPTH 1000
+#endif
+
+#if (configUSE_IRQ_REPLAY == 1)
+#include <stdlib.h>
+#include "queue.h"
+#include "semphr.h"
+#include "irq_replay.h"
+#endif
+
 void Task1(void *pvParameters)
 {
     (void) pvParameters;
@@ -22,12 +38,160 @@ void Task2(void *pvParameters)
     }
 }
 
-int main(void)
+#if (configUSE_PERF_COUNTERS == 1)
+void PerfReportTask(void *pvParameters)
+{
+    (void) pvParameters;
+    for (;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(5000));  // 5 seconds
+        perf_counters_print();
+    }
+}
+#endif
+
+#if (configUSE_STACK_GUARD == 1)
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
+{
+    (void) xTask;
+    fprintf(stderr, "Stack overflow in %s\n", pcTaskName);
+    abort();
+}
+#endif
+
+#if (configUSE_IRQ_REPLAY == 1)
+// Interrupt-level application code. On the target the USART and EXTI
+// interrupt handlers call these with the received byte and the pin level, and
+// here the replay calls them with the recorded values.
+static QueueHandle_t rx_queue;
+static SemaphoreHandle_t button_semaphore;
+
+static void App_OnUartByte(uint32_t byte, BaseType_t *woken)
+{
+    uint8_t c = (uint8_t) byte;
+
+    if (xQueueSendFromISR(rx_queue, &c, woken) != pdPASS)
+    {
+        // Overrun: the byte is lost, as it would be on the target
+        irq_replay_done(IRQ_REPLAY_USART_RX);
+    }
+}
+
+static void App_OnButtonEdge(uint32_t pin_and_level, BaseType_t *woken)
+{
+    if ((pin_and_level >> 16) != 0)
+    {
+        xSemaphoreGiveFromISR(button_semaphore, woken);
+    }
+    else
+    {
+        // Release edges need no task work
+        irq_replay_done(IRQ_REPLAY_EXTI);
+    }
+}
+
+// Collects received bytes into command lines.
+void ShellTask(void *pvParameters)
+{
+    char line[32];
+    int length = 0;
+    uint8_t c;
+
+    (void) pvParameters;
+    for (;;)
+    {
+        xQueueReceive(rx_queue, &c, portMAX_DELAY);
+        if (c == '\r')
+        {
+            line[length] = '\0';
+            printf("Shell: %s\n", line);
+            length = 0;
+        }
+        else if (length < (int) sizeof(line) - 1)
+        {
+            line[length++] = (char) c;
+        }
+        irq_replay_done(IRQ_REPLAY_USART_RX);
+    }
+}
+
+void ButtonTask(void *pvParameters)
+{
+    (void) pvParameters;
+    for (;;)
+    {
+        xSemaphoreTake(button_semaphore, portMAX_DELAY);
+        printf("Button pressed\n");
+        irq_replay_done(IRQ_REPLAY_EXTI);
+    }
+}
+
+// Prints the latencies once the whole log has been replayed, and exits.
+void ReplayMonitorTask(void *pvParameters)
+{
+    (void) pvParameters;
+    while (!irq_replay_finished())
+    {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+
+    irq_replay_report();
+#if (configUSE_PERF_COUNTERS == 1)
+    perf_counters_print();
+#endif
+    exit(0);
+}
+
+void vApplicationTickHook(void)
+{
+    irq_replay_tick();
+}
+#endif
+
+int main(int argc, char **argv)
 {
     printf("Starting FreeRTOS demo on PC...\n");
 
-    xTaskCreate(Task1, "Task1", 1000, NULL, 1, NULL);
-    xTaskCreate(Task2, "Task2", 1000, NULL, 1, NULL);
+#if (configUSE_STACK_GUARD == 1)
+    // Must come before the tasks are created so their guards are found.
+    stack_guard_init();
+#endif
+
+#if (configUSE_PERF_COUNTERS == 1)
+    // Must come before the tasks are created so their threads are counted.
+    perf_counters_init();
+#endif
+
+#if (configUSE_PC_SAMPLER == 1)
+    pc_sampler_start();
+#endif
+
+#if (configUSE_IRQ_REPLAY == 1)
+    // The log is the UART output of IrqRecord_Dump() on the target.
+    if (irq_replay_load(argc > 1 ? argv[1] : "irq_replay_example.log") < 0)
+    {
+        return 1;
+    }
+
+    rx_queue = xQueueCreate(64, sizeof(uint8_t));
+    button_semaphore = xSemaphoreCreateBinary();
+    irq_replay_register(IRQ_REPLAY_USART_RX, App_OnUartByte);
+    irq_replay_register(IRQ_REPLAY_EXTI, App_OnButtonEdge);
+
+    // The replay tasks only: the monitor prints the counters at the end.
+    xTaskCreate(ShellTask, "Shell", TASK_STACK_DEPTH, NULL, 2, NULL);
+    xTaskCreate(ButtonTask, "Button", TASK_STACK_DEPTH, NULL, 3, NULL);
+    xTaskCreate(ReplayMonitorTask, "Replay", TASK_STACK_DEPTH, NULL, 1, NULL);
+#else
+    (void) argc;
+    (void) argv;
+
+#if (configUSE_PERF_COUNTERS == 1)
+    xTaskCreate(PerfReportTask, "Perf", TASK_STACK_DEPTH, NULL, 2, NULL);
+#endif
+    xTaskCreate(Task1, "Task1", TASK_STACK_DEPTH, NULL, 1, NULL);
+    xTaskCreate(Task2, "Task2", TASK_STACK_DEPTH, NULL, 1, NULL);
+#endif
 
     vTaskStartScheduler();
 
@@ -0,0 +1,217 @@
+// File: pc_sampler.c
+// Description:
+// Statistical profiler for the Linux (POSIX port) build.
+// - setitimer(ITIMER_PROF) raises SIGPROF each time the process has used
+//   1 / PC_SAMPLER_HZ seconds of CPU time. Linux delivers it to the thread
+//   that was running, which is the thread of the current FreeRTOS task.
+// - The handler reads the interrupted PC from the signal context and stores it
+//   with xTaskGetCurrentTaskHandle(). It only writes to the sample buffer, so
+//   it is async-signal-safe.
+// - The profiler task prints each full buffer as "pcs" lines:
+//
+//     pcs begin <rate Hz> <CPU Hz>
+//     pcs task <task handle> <name>
+//     pcs s <task handle> <pc> <lr>
+//     pcs end <samples> <sampler cycles> <elapsed cycles>
+//
+//   The "cycles" are nanoseconds, so <CPU Hz> is 1000000000. <elapsed> is the
+//   process CPU time of the capture, because that is what the timer counts.
+//
+// Differences from the target sampler:
+// - PCs are printed relative to the executable's load address, so pcprof can
+//   match them against the symbols of a position-independent executable.
+//   Samples in shared libraries, such as libc, are printed as PC 0 and
+//   reported as [unknown].
+// - x86-64 has no link register, so <lr> is 0 and the folded stacks have no
+//   caller level.
+// - The POSIX port blocks every signal while "interrupts" are disabled. A
+//   sample that falls in a critical section is delivered when it ends, so it
+//   lands on the code that leaves the critical section.
+// - Samples taken while the port is switching threads can be charged to the
+//   task on either side of the switch.
+
+#define _GNU_SOURCE
+#include <link.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pc_sampler.h"
+
+// Largest number of tasks whose names are looked up for a printout.
+#define PC_SAMPLER_MAX_TASKS 32
+
+typedef struct
+{
+    TaskHandle_t task;
+    uintptr_t pc;
+} pc_sample_t;
+
+static pc_sample_t pc_samples[PC_SAMPLER_DEPTH];
+static volatile sig_atomic_t pc_sample_count = PC_SAMPLER_DEPTH;
+static volatile uint64_t pc_sampler_ns;
+static uintptr_t pc_load_address;
+static uintptr_t pc_load_end;
+static TaskStatus_t pc_task_status[PC_SAMPLER_MAX_TASKS];
+
+static uint64_t pc_clock_ns(clockid_t clock)
+{
+    struct timespec t;
+
+    clock_gettime(clock, &t);
+    return (uint64_t) t.tv_sec * 1000000000ULL + (uint64_t) t.tv_nsec;
+}
+
+static void pc_set_timer(int on)
+{
+    struct itimerval timer;
+
+    memset(&timer, 0, sizeof(timer));
+    if (on)
+    {
+        timer.it_interval.tv_usec = 1000000 / PC_SAMPLER_HZ;
+        timer.it_value = timer.it_interval;
+    }
+    setitimer(ITIMER_PROF, &timer, NULL);
+}
+
+// ============================================================================
+// Signal handler
+// ============================================================================
+static void pc_sampler_signal(int signal, siginfo_t *info, void *context)
+{
+    uint64_t start = pc_clock_ns(CLOCK_MONOTONIC);
+    const ucontext_t *uc = context;
+    int count = pc_sample_count;
+
+    (void) signal;
+    (void) info;
+
+    if (count < PC_SAMPLER_DEPTH)
+    {
+#if defined(__x86_64__)
+        pc_samples[count].pc = (uintptr_t) uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__aarch64__)
+        pc_samples[count].pc = (uintptr_t) uc->uc_mcontext.pc;
+#else
+#error "pc_sampler.c: no PC in the signal context for this architecture"
+#endif
+        pc_samples[count].task = xTaskGetCurrentTaskHandle();
+
+        if (++count == PC_SAMPLER_DEPTH)
+        {
+            pc_set_timer(0);
+        }
+        pc_sample_count = count;
+    }
+
+    pc_sampler_ns += pc_clock_ns(CLOCK_MONOTONIC) - start;
+}
+
+// The first object dl_iterate_phdr() reports is the executable. Notes where
+// it was loaded and where its last segment ends.
+static int pc_find_executable(struct dl_phdr_info *info, size_t size, void *data)
+{
+    (void) size;
+    (void) data;
+    pc_load_address = (uintptr_t) info->dlpi_addr;
+    for (int i = 0; i < info->dlpi_phnum; i++)
+    {
+        uintptr_t end = pc_load_address + info->dlpi_phdr[i].p_vaddr + info->dlpi_phdr[i].p_memsz;
+
+        if (info->dlpi_phdr[i].p_type == PT_LOAD && end > pc_load_end)
+        {
+            pc_load_end = end;
+        }
+    }
+    return 1;
+}
+
+// The PC as an address in the executable's ELF file, or 0 outside it.
+static unsigned long pc_elf_address(uintptr_t pc)
+{
+    return (pc >= pc_load_address && pc < pc_load_end) ? (unsigned long) (pc - pc_load_address) : 0;
+}
+
+// ============================================================================
+// Printout
+// ============================================================================
+
+// Prints the name of every task that is still alive. A sampled task that has
+// been deleted since shows up in pcprof under its handle.
+static void pc_print_tasks(void)
+{
+    UBaseType_t count = uxTaskGetSystemState(pc_task_status, PC_SAMPLER_MAX_TASKS, NULL);
+
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        printf("pcs task %lx %s\n", (unsigned long) (uintptr_t) pc_task_status[i].xHandle,
+               pc_task_status[i].pcTaskName);
+    }
+}
+
+static void PcSamplerTask(void *pvParameters)
+{
+    uint64_t start, elapsed, sampler_ns;
+
+    (void) pvParameters;
+    for (;;)
+    {
+        pc_sampler_ns = 0;
+        start = pc_clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+        pc_sample_count = 0;
+        pc_set_timer(1);
+
+        while (pc_sample_count < PC_SAMPLER_DEPTH)
+        {
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+
+        elapsed = pc_clock_ns(CLOCK_PROCESS_CPUTIME_ID) - start;
+        sampler_ns = pc_sampler_ns;
+
+        printf("pcs begin %lu %lu\n", (unsigned long) PC_SAMPLER_HZ, 1000000000UL);
+        pc_print_tasks();
+
+        for (int i = 0; i < PC_SAMPLER_DEPTH; i++)
+        {
+            printf("pcs s %lx %lx 0\n", (unsigned long) (uintptr_t) pc_samples[i].task,
+                   pc_elf_address(pc_samples[i].pc));
+        }
+
+        printf("pcs end %lx %llx %llx\n", (unsigned long) PC_SAMPLER_DEPTH,
+               (unsigned long long) sampler_ns, (unsigned long long) elapsed);
+        printf("PC sampler: %d samples at %d Hz, %llu ns each, overhead %.2f%%\n",
+               PC_SAMPLER_DEPTH, PC_SAMPLER_HZ,
+               (unsigned long long) (sampler_ns / PC_SAMPLER_DEPTH),
+               elapsed ? 100.0 * (double) sampler_ns / (double) elapsed : 0.0);
+        fflush(stdout);
+
+        vTaskDelay(pdMS_TO_TICKS(PC_SAMPLER_PAUSE_MS));
+    }
+}
+
+int pc_sampler_start(void)
+{
+    struct sigaction action;
+
+    dl_iterate_phdr(pc_find_executable, NULL);
+
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = pc_sampler_signal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, NULL) != 0)
+    {
+        perror("sigaction(SIGPROF)");
+        return -1;
+    }
+
+    xTaskCreate(PcSamplerTask, "PcSampler", 1000, NULL, 2, NULL);
+    return 0;
+}
@@ -0,0 +1,38 @@
+// File: pc_sampler.h
+// Description:
+// Statistical profiler for the Linux (POSIX port) build, the host counterpart
+// of the 05_04 template's Core/Src/pc_sampler.c. A SIGPROF timer interrupts
+// the process PC_SAMPLER_HZ times per second of CPU time. The signal handler
+// stores the interrupted PC and the current task in a buffer of
+// PC_SAMPLER_DEPTH samples. When the buffer is full the timer stops, and the
+// profiler task prints the samples in the format tools/pcprof reads, then
+// starts the next capture.
+//
+// Included from FreeRTOSConfig.h, so it must not depend on FreeRTOS types.
+
+#ifndef PC_SAMPLER_H
+#define PC_SAMPLER_H
+
+// Samples per second of process CPU time. Each sample costs about a
+// microsecond on a desktop CPU, so 1 kHz takes about 0.1 %. The measured
+// figure is printed with each capture.
+#ifndef PC_SAMPLER_HZ
+#define PC_SAMPLER_HZ 1000
+#endif
+
+// Samples per capture.
+#ifndef PC_SAMPLER_DEPTH
+#define PC_SAMPLER_DEPTH 1024
+#endif
+
+// Pause between the end of one printout and the next capture.
+#ifndef PC_SAMPLER_PAUSE_MS
+#define PC_SAMPLER_PAUSE_MS 1000
+#endif
+
+// Installs the SIGPROF handler and creates the profiler task. Call from main()
+// before the scheduler is started. Returns 0, or -1 if the handler could not
+// be installed.
+int pc_sampler_start(void);
+
+#endif // PC_SAMPLER_H
@@ -0,0 +1,222 @@
+// File: perf_counters.c
+// Description:
+// Per-task hardware performance counters for the Linux (POSIX port) build.
+// - perf_counters_init() opens one perf_event counter per event for the whole
+//   process. Each counter is inherited by the task threads created after it.
+// - When a task is switched in, the counters are read. When it is switched out
+//   they are read again, and the difference is added to that task's entry.
+// - perf_counters_print() lists the counts next to the uxTaskGetSystemState()
+//   data.
+// Only user-space events are counted, so the build runs without privileges
+// (perf_event_paranoid <= 2). The reads at each switch cost a few system calls;
+// that overhead is charged to the task being switched out.
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "perf_counters.h"
+#if (configUSE_STACK_GUARD == 1)
+#include "stack_guard.h"
+#endif
+
+typedef struct
+{
+    const void *task;
+    uint64_t counts[PERF_COUNTER_COUNT];
+} perf_task_entry_t;
+
+static const uint64_t perf_event_config[PERF_COUNTER_COUNT] =
+{
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+static int perf_fd[PERF_COUNTER_COUNT] = { -1, -1, -1, -1 };
+static uint64_t perf_switched_in_at[PERF_COUNTER_COUNT];
+static perf_task_entry_t perf_tasks[PERF_COUNTERS_MAX_TASKS];
+
+// ============================================================================
+// Counter access
+// ============================================================================
+static void perf_read_all(uint64_t values[PERF_COUNTER_COUNT])
+{
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+    {
+        values[i] = 0;
+        if (perf_fd[i] >= 0 && read(perf_fd[i], &values[i], sizeof(values[i])) != (ssize_t) sizeof(values[i]))
+        {
+            values[i] = 0;
+        }
+    }
+}
+
+// The kernel serialises the trace hooks, so the table needs no lock.
+static perf_task_entry_t *perf_find_task(const void *task, int create)
+{
+    perf_task_entry_t *free_entry = NULL;
+
+    for (int i = 0; i < PERF_COUNTERS_MAX_TASKS; i++)
+    {
+        if (perf_tasks[i].task == task)
+        {
+            return &perf_tasks[i];
+        }
+        if (free_entry == NULL && perf_tasks[i].task == NULL)
+        {
+            free_entry = &perf_tasks[i];
+        }
+    }
+
+    if (create && free_entry != NULL)
+    {
+        memset(free_entry, 0, sizeof(*free_entry));
+        free_entry->task = task;
+    }
+    return create ? free_entry : NULL;
+}
+
+int perf_counters_init(void)
+{
+    int opened = 0;
+
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+    {
+        struct perf_event_attr attr;
+
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = perf_event_config[i];
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        perf_fd[i] = (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if (perf_fd[i] >= 0)
+        {
+            opened++;
+        }
+    }
+
+    if (opened == 0)
+    {
+        perror("perf_event_open");
+    }
+    return opened;
+}
+
+// ============================================================================
+// Trace hooks
+// ============================================================================
+void perf_counters_switched_in(const void *task)
+{
+    (void) task;
+    perf_read_all(perf_switched_in_at);
+}
+
+void perf_counters_switched_out(const void *task)
+{
+    uint64_t now[PERF_COUNTER_COUNT];
+    perf_task_entry_t *entry = perf_find_task(task, 1);
+
+    perf_read_all(now);
+    if (entry != NULL)
+    {
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++)
+        {
+            entry->counts[i] += now[i] - perf_switched_in_at[i];
+        }
+    }
+}
+
+void perf_counters_task_deleted(const void *task)
+{
+    perf_task_entry_t *entry = perf_find_task(task, 0);
+
+    // The TCB may be reused by a task created later.
+    if (entry != NULL)
+    {
+        entry->task = NULL;
+    }
+}
+
+int perf_counters_get(const void *task, uint64_t counts[PERF_COUNTER_COUNT])
+{
+    perf_task_entry_t *entry;
+    int found = 0;
+
+    taskENTER_CRITICAL();
+    entry = perf_find_task(task, 0);
+    if (entry != NULL)
+    {
+        memcpy(counts, entry->counts, sizeof(entry->counts));
+        found = 1;
+    }
+    taskEXIT_CRITICAL();
+
+    return found;
+}
+
+// ============================================================================
+// Report
+// ============================================================================
+void perf_counters_print(void)
+{
+    UBaseType_t task_count = uxTaskGetNumberOfTasks();
+    TaskStatus_t *status = malloc(task_count * sizeof(TaskStatus_t));
+
+    if (status == NULL)
+    {
+        return;
+    }
+
+    task_count = uxTaskGetSystemState(status, task_count, NULL);
+
+    printf("%-10s %4s %6s %14s %14s %5s %12s %12s %7s\n",
+           "Task", "Prio", "Stack", "Cycles", "Instructions", "IPC",
+           "Cache miss", "Branch miss", "MPKI");
+
+    for (UBaseType_t i = 0; i < task_count; i++)
+    {
+        uint64_t counts[PERF_COUNTER_COUNT] = { 0 };
+        double ipc = 0.0, mpki = 0.0;
+
+        unsigned long stack_free = status[i].usStackHighWaterMark;
+
+#if (configUSE_STACK_GUARD == 1)
+        // The high water mark counts the guard page as free stack.
+        stack_free -= stack_guard_reserved_bytes(status[i].xHandle) / sizeof(StackType_t);
+#endif
+        perf_counters_get(status[i].xHandle, counts);
+        if (counts[PERF_CYCLES] != 0)
+        {
+            ipc = (double) counts[PERF_INSTRUCTIONS] / (double) counts[PERF_CYCLES];
+        }
+        if (counts[PERF_INSTRUCTIONS] != 0)
+        {
+            mpki = (double) counts[PERF_CACHE_MISSES] * 1000.0 / (double) counts[PERF_INSTRUCTIONS];
+        }
+
+        printf("%-10s %4lu %6lu %14llu %14llu %5.2f %12llu %12llu %7.2f\n",
+               status[i].pcTaskName,
+               (unsigned long) status[i].uxCurrentPriority,
+               stack_free,
+               (unsigned long long) counts[PERF_CYCLES],
+               (unsigned long long) counts[PERF_INSTRUCTIONS],
+               ipc,
+               (unsigned long long) counts[PERF_CACHE_MISSES],
+               (unsigned long long) counts[PERF_BRANCH_MISSES],
+               mpki);
+    }
+
+    free(status);
+}
@@ -0,0 +1,48 @@
+// File: perf_counters.h
+// Description:
+// Per-task hardware performance counters for the Linux (POSIX port) build.
+// The process opens perf_event counters for cycles, instructions, cache misses
+// and branch misses. The kernel's task switch trace hooks snapshot them, so the
+// counts are charged to the FreeRTOS task that was running.
+//
+// Included from FreeRTOSConfig.h, so it must not depend on FreeRTOS types.
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+
+// Tasks that can be tracked at the same time.
+#ifndef PERF_COUNTERS_MAX_TASKS
+#define PERF_COUNTERS_MAX_TASKS 32
+#endif
+
+typedef enum
+{
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_COUNTER_COUNT
+} perf_counter_t;
+
+// Opens the counters. Call from main() before any task is created, because the
+// POSIX port runs each task on its own thread and only threads created after
+// this call are counted. Returns the number of counters that could be opened;
+// counters the CPU or kernel does not offer read as zero.
+int perf_counters_init(void);
+
+// Trace hooks, called by the kernel with the TCB of the running task.
+void perf_counters_switched_in(const void *task);
+void perf_counters_switched_out(const void *task);
+void perf_counters_task_deleted(const void *task);
+
+// Copies the counts charged to a task so far. Returns 0 if the task has not
+// run since perf_counters_init().
+int perf_counters_get(const void *task, uint64_t counts[PERF_COUNTER_COUNT]);
+
+// Prints uxTaskGetSystemState() output for every task with its counts, IPC and
+// miss rates.
+void perf_counters_print(void);
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,168 @@
+// File: stack_guard.c
+// Description:
+// Guard page at the bottom of each task stack for the Linux (POSIX port)
+// build.
+// - When a task is created, the first page boundary in its stack is found and
+//   the page above it is made read-only with mprotect(). The stack grows down,
+//   so a task that runs out of stack writes into that page first. Reads are
+//   still allowed, so the kernel's stack high water mark scan can pass over
+//   the page.
+// - A write into the page raises SIGSEGV on the task's thread. The stack
+//   pointer is then inside the guard, so the handler runs on a signal stack of
+//   its own. sigaltstack() only applies to the thread that calls it, so each
+//   task installs its signal stack from the task switch out hook, which the
+//   POSIX port runs on the thread of the task being switched out.
+// - The handler looks up whose guard the fault address is in and calls
+//   vApplicationStackOverflowHook() with that task. Any other fault, or a hook
+//   that returns, gets the default action.
+// - When a task is deleted its page is made writable again before the kernel
+//   frees the stack.
+//
+// Limits:
+// - A task is only guarded once it has been switched out for the first time.
+//   Before that, a stack overflow still ends the process with SIGSEGV, but
+//   the hook is not called.
+// - The POSIX port only runs a task on its own stack if the stack is at least
+//   PTHREAD_STACK_MIN bytes, so tasks with less room than that above the guard
+//   page are left unguarded.
+// - Only writes are caught. A task that reads below its stack without writing
+//   first is not detected.
+
+#define _GNU_SOURCE
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stack_guard.h"
+
+typedef struct
+{
+    const void *task;
+    uintptr_t low;                   // Lowest address of the stack
+    uintptr_t guard;                 // The read-only page
+    volatile sig_atomic_t on_thread; // Signal stack installed on the task's thread
+} stack_guard_entry_t;
+
+// Application hook, also declared by task.h when the kernel's own checks are on.
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName);
+
+static stack_guard_entry_t guard_tasks[STACK_GUARD_MAX_TASKS];
+static uint8_t guard_signal_stacks[STACK_GUARD_MAX_TASKS][STACK_GUARD_SIGNAL_STACK_SIZE];
+static uintptr_t guard_page_size;
+
+// The kernel serialises the trace hooks, so the table needs no lock.
+static stack_guard_entry_t *guard_find_task(const void *task)
+{
+    for (int i = 0; i < STACK_GUARD_MAX_TASKS; i++)
+    {
+        if (guard_tasks[i].task == task)
+        {
+            return &guard_tasks[i];
+        }
+    }
+    return NULL;
+}
+
+// ============================================================================
+// Signal handler
+// ============================================================================
+static void stack_guard_signal(int signo, siginfo_t *info, void *context)
+{
+    uintptr_t address = (uintptr_t) info->si_addr;
+
+    (void) signo;
+    (void) context;
+
+    for (int i = 0; i < STACK_GUARD_MAX_TASKS; i++)
+    {
+        const void *task = guard_tasks[i].task;
+
+        if (task != NULL && address - guard_tasks[i].guard < guard_page_size)
+        {
+            vApplicationStackOverflowHook((TaskHandle_t) task, pcTaskGetName((TaskHandle_t) task));
+            break;
+        }
+    }
+
+    // Not a guard hit, or the hook returned: the fault is retried with the
+    // default action, which ends the process.
+    signal(SIGSEGV, SIG_DFL);
+}
+
+int stack_guard_init(void)
+{
+    struct sigaction action;
+
+    guard_page_size = (uintptr_t) sysconf(_SC_PAGESIZE);
+
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = stack_guard_signal;
+    action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+    return sigaction(SIGSEGV, &action, NULL);
+}
+
+// ============================================================================
+// Trace hooks
+// ============================================================================
+void stack_guard_task_created(const void *task, void *stack_low, void *stack_high)
+{
+    uintptr_t low = (uintptr_t) stack_low;
+    uintptr_t guard = (low + guard_page_size - 1) & ~(guard_page_size - 1);
+    stack_guard_entry_t *entry = guard_find_task(NULL);
+
+    if (entry == NULL || guard_page_size == 0 ||
+        guard + guard_page_size + PTHREAD_STACK_MIN > (uintptr_t) stack_high)
+    {
+        return;
+    }
+
+    if (mprotect((void *) guard, guard_page_size, PROT_READ) == 0)
+    {
+        entry->low = low;
+        entry->guard = guard;
+        entry->on_thread = 0;
+        entry->task = task;
+    }
+}
+
+void stack_guard_switched_out(const void *task)
+{
+    stack_guard_entry_t *entry = guard_find_task(task);
+
+    if (entry != NULL && !entry->on_thread)
+    {
+        stack_t signal_stack;
+
+        signal_stack.ss_sp = guard_signal_stacks[entry - guard_tasks];
+        signal_stack.ss_size = STACK_GUARD_SIGNAL_STACK_SIZE;
+        signal_stack.ss_flags = 0;
+        entry->on_thread = (sigaltstack(&signal_stack, NULL) == 0);
+    }
+}
+
+void stack_guard_task_deleted(const void *task)
+{
+    stack_guard_entry_t *entry = guard_find_task(task);
+
+    // The stack goes back to the heap, and the TCB may be reused by a task
+    // created later.
+    if (entry != NULL)
+    {
+        mprotect((void *) entry->guard, guard_page_size, PROT_READ | PROT_WRITE);
+        entry->task = NULL;
+    }
+}
+
+size_t stack_guard_reserved_bytes(const void *task)
+{
+    const stack_guard_entry_t *entry = guard_find_task(task);
+
+    return (entry != NULL) ? (size_t) (entry->guard + guard_page_size - entry->low) : 0;
+}
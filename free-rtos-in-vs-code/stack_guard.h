@@ -0,0 +1,45 @@
+// File: stack_guard.h
+// Description:
+// Guard page at the bottom of each task stack for the Linux (POSIX port)
+// build, the host counterpart of the MPU guard region that
+// configCHECK_FOR_STACK_OVERFLOW 3 sets up on the Cortex-M4F target. The POSIX
+// port runs each task on a thread whose stack is the task's stack. The
+// kernel's trace hooks make the first whole page of it read-only, so the first
+// write past the usable stack raises SIGSEGV. The handler reports the task
+// through vApplicationStackOverflowHook().
+//
+// Included from FreeRTOSConfig.h, so it must not depend on FreeRTOS types.
+
+#ifndef STACK_GUARD_H
+#define STACK_GUARD_H
+
+#include <stddef.h>
+
+// Tasks that can be guarded at the same time.
+#ifndef STACK_GUARD_MAX_TASKS
+#define STACK_GUARD_MAX_TASKS 32
+#endif
+
+// Size of the stack the SIGSEGV handler runs on. A task that hits its guard
+// has no stack left, so each task thread gets one of these.
+#ifndef STACK_GUARD_SIGNAL_STACK_SIZE
+#define STACK_GUARD_SIGNAL_STACK_SIZE (64 * 1024)
+#endif
+
+// Installs the SIGSEGV handler. Call from main() before any task is created.
+// Returns 0, or -1 if the handler could not be installed.
+int stack_guard_init(void);
+
+// Trace hooks, called by the kernel with the TCB of the task.
+// stack_guard_task_created() gets the lowest and highest address of the
+// task's stack.
+void stack_guard_task_created(const void *task, void *stack_low, void *stack_high);
+void stack_guard_switched_out(const void *task);
+void stack_guard_task_deleted(const void *task);
+
+// Bytes at the bottom of a task's stack the task cannot use: the guard page
+// and the gap below it. The stack high water mark counts them as free, so
+// subtract them from it. 0 if the task has no guard.
+size_t stack_guard_reserved_bytes(const void *task);
+
+#endif // STACK_GUARD_H
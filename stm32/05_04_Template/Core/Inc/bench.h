@@ -0,0 +1,49 @@
+/**
+  ******************************************************************************
+  * @file           : bench.h
+  * @brief          : Chooses the benchmark or demo the template runs.
+  ******************************************************************************
+  * Set BENCH_SELECT below, or pass -DBENCH_SELECT=<value> to the compiler, to
+  * one of the BENCH_ values.  main() then calls Bench_Start() in freertos.c,
+  * which creates the tasks of that benchmark, and starts the scheduler.  With
+  * BENCH_NONE nothing is created and main() runs as generated.
+  *
+  * Each benchmark source checks the kernel settings it needs at compile time:
+  * selecting one whose features are off in FreeRTOSConfig.h stops the build
+  * with an #error that names them.  Sources that are not selected compile to
+  * nothing when their features are off.
+  ******************************************************************************
+  */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BENCH_NONE                0
+#define BENCH_LIST_COMPACT        1   /* list_compact_bench.c */
+#define BENCH_TIMER_SLACK         2   /* timer_slack_bench.c */
+#define BENCH_MESSAGE_QUEUE       3   /* message_queue_bench.c */
+#define BENCH_QUEUE_COPY          4   /* queue_copy_bench.c */
+#define BENCH_OBJECT_LOCK         5   /* object_lock_bench.c */
+#define BENCH_MPMC_QUEUE          6   /* mpmc_queue_bench.c */
+#define BENCH_IDLE_JOBS           7   /* idle_jobs_demo.c */
+
+#ifndef BENCH_SELECT
+#define BENCH_SELECT              BENCH_NONE
+#endif
+
+/**
+  * @brief  Creates the tasks of the benchmark chosen by BENCH_SELECT.  Call
+  *         before the scheduler is started.
+  * @retval 1 if a benchmark was started, 0 for BENCH_NONE.
+  */
+int Bench_Start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_H */
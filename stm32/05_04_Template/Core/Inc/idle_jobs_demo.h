@@ -0,0 +1,47 @@
+/**
+  ******************************************************************************
+  * @file           : idle_jobs_demo.h
+  * @brief          : Runs background work as idle jobs with per-job budgets
+  *                   and prints how the idle time was shared out.
+  ******************************************************************************
+  */
+
+#ifndef IDLE_JOBS_DEMO_H
+#define IDLE_JOBS_DEMO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Budget of each job per idle turn, in run time counter units.  With the
+   counter set up as in irq_stats.h these are CPU cycles. */
+#ifndef IDLE_JOBS_SCRUB_BUDGET
+#define IDLE_JOBS_SCRUB_BUDGET    20000
+#endif
+
+#ifndef IDLE_JOBS_GC_BUDGET
+#define IDLE_JOBS_GC_BUDGET       50000
+#endif
+
+/* Time between two reports, and between two full memory scrubs. */
+#ifndef IDLE_JOBS_REPORT_MS
+#define IDLE_JOBS_REPORT_MS       2000
+#endif
+
+/* Share of each 10 ms period that the load task keeps the CPU busy. */
+#ifndef IDLE_JOBS_LOAD_PERCENT
+#define IDLE_JOBS_LOAD_PERCENT    60
+#endif
+
+/**
+  * @brief  Registers the idle jobs and creates the load and report tasks.
+  *         Call before the scheduler is started.  Needs configUSE_IDLE_JOBS
+  *         set to 1; results are printed with printf().
+  */
+void IdleJobsDemo_Start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IDLE_JOBS_DEMO_H */
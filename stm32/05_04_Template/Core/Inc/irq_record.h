@@ -0,0 +1,92 @@
+/**
+  ******************************************************************************
+  * @file           : irq_record.h
+  * @brief          : Records when interrupts arrived and what they carried, for
+  *                   replay against the same application code on the host.
+  ******************************************************************************
+  * Call IrqRecord_Event() at the top of each interrupt handler to capture,
+  * with a source number and the value the handler acts on: the received
+  * byte, the pin and level of an EXTI edge, the DMA half that completed.
+  * Keep the work the handler does in a function of the source and that value
+  * alone, so the host replay in free-rtos-in-vs-code can call the same
+  * function:
+  *
+  *   void USART2_IRQHandler(void)
+  *   {
+  *     BaseType_t woken = pdFALSE;
+  *     uint8_t byte = (uint8_t)USART2->DR;
+  *
+  *     IrqRecord_Event(IRQ_RECORD_USART_RX, byte);
+  *     App_OnUartByte(byte, &woken);
+  *     portYIELD_FROM_ISR(woken);
+  *   }
+  *
+  * Each event takes 3 to 11 bytes: the DWT cycles since the previous event
+  * and the payload as varints, and the source as one byte.  Recording stops
+  * when the buffer is full, so the log is always an unbroken prefix of what
+  * happened; later events are only counted.  IrqRecord_Dump() prints the log
+  * over the debug UART as lines that irq_replay.c reads:
+  *
+  *   irq begin <CPU Hz> <tick Hz>
+  *   irq d <up to 32 bytes of the log, in hexadecimal>
+  *   irq end <events> <bytes> <lost events>
+  *
+  * The counts on the end line are hexadecimal.  Other output may be mixed
+  * in; lines that do not start with "irq " are skipped.
+  ******************************************************************************
+  */
+
+#ifndef IRQ_RECORD_H
+#define IRQ_RECORD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Size of the log.  2048 events of a received byte fit in 8 KB. */
+#ifndef IRQ_RECORD_BYTES
+#define IRQ_RECORD_BYTES          8192
+#endif
+
+/* Source numbers.  Applications number their own sources from
+   IRQ_RECORD_USER up to 255. */
+#define IRQ_RECORD_USART_RX       1U    /* Payload: the received byte. */
+#define IRQ_RECORD_EXTI           2U    /* Payload: GPIO pin mask | level << 16. */
+#define IRQ_RECORD_DMA            3U    /* Payload: 0 half transfer, 1 transfer complete. */
+#define IRQ_RECORD_USER           16U
+
+/**
+  * @brief  Clears the log and starts recording.  The first event is timed
+  *         from this call.
+  */
+void IrqRecord_Start(void);
+
+/**
+  * @brief  Stops recording.
+  */
+void IrqRecord_Stop(void);
+
+/**
+  * @brief  Adds an event to the log.  Safe from interrupts of any priority,
+  *         as it only masks interrupts for a few dozen cycles.
+  */
+void IrqRecord_Event(uint8_t source, uint32_t payload);
+
+/**
+  * @retval 1 while recording and the log is not full, 0 otherwise.
+  */
+int IrqRecord_IsRecording(void);
+
+/**
+  * @brief  Stops recording and prints the log using printf().
+  * @retval The number of events in the log.
+  */
+uint32_t IrqRecord_Dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IRQ_RECORD_H */
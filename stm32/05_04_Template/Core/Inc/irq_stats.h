@@ -0,0 +1,100 @@
+/**
+  ******************************************************************************
+  * @file           : irq_stats.h
+  * @brief          : Per-interrupt execution count and cycle accounting.
+  ******************************************************************************
+  * IrqStats_Init() moves the vector table to RAM.  IrqStats_Instrument() then
+  * points chosen vectors at a common wrapper.  The wrapper stamps the DWT
+  * cycle counter on entry and exit, and calls the original handler in
+  * between.  For each interrupt it records how often the interrupt ran, and
+  * the total and longest number of cycles spent in its handler.  Cycles spent
+  * in higher priority interrupts that nested inside a handler are not counted
+  * against that handler.
+  *
+  * To stop the kernel charging interrupt time to the tasks the interrupts
+  * preempted, measure run time in CPU cycles, in FreeRTOSConfig.h:
+  *
+  *   #define configGENERATE_RUN_TIME_STATS             1
+  *   #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()  IrqStats_Init()
+  *   #define portGET_RUN_TIME_COUNTER_VALUE()          IrqStats_GetCycles()
+  *   #define portGET_ISR_RUN_TIME_COUNTER_VALUE()      IrqStats_GetIsrCycles()
+  *
+  * The cycle counter wraps after 2^32 cycles, about 43 s at 100 MHz, so task
+  * run time percentages are only valid over shorter periods.
+  ******************************************************************************
+  */
+
+#ifndef IRQ_STATS_H
+#define IRQ_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "stm32f4xx.h"
+
+/* Deepest interrupt nesting that is tracked.  Each active priority level can
+   add one. */
+#ifndef IRQ_STATS_MAX_NESTING
+#define IRQ_STATS_MAX_NESTING     16
+#endif
+
+typedef struct
+{
+  uint32_t count;           /* Times the handler ran. */
+  uint64_t totalCycles;     /* Cycles in the handler, excluding nested interrupts. */
+  uint32_t maxCycles;       /* Longest single run of the handler. */
+} IrqStats_t;
+
+/**
+  * @brief  Copies the vector table to RAM and starts the DWT cycle counter.
+  *         Safe to call more than once.
+  */
+void IrqStats_Init(void);
+
+/**
+  * @brief  Routes an interrupt through the accounting wrapper.  Any
+  *         interrupt or system exception may be given except SVCall and
+  *         PendSV, which the FreeRTOS port handles at the register level.
+  * @param  irq  The interrupt, e.g. SysTick_IRQn or USART2_IRQn.
+  */
+void IrqStats_Instrument(IRQn_Type irq);
+
+/**
+  * @brief  Copies the counters for one interrupt.
+  * @retval 0 if the interrupt is not instrumented, 1 otherwise.
+  */
+int IrqStats_Get(IRQn_Type irq, IrqStats_t *stats);
+
+/**
+  * @brief  Clears the counters of all interrupts and the nesting high water
+  *         mark.
+  */
+void IrqStats_Reset(void);
+
+/**
+  * @retval The deepest nesting of instrumented interrupts seen.
+  */
+uint32_t IrqStats_GetMaxNesting(void);
+
+/**
+  * @retval The DWT cycle counter.
+  */
+uint32_t IrqStats_GetCycles(void);
+
+/**
+  * @retval Total cycles spent in instrumented interrupts, wrapping at 2^32.
+  */
+uint32_t IrqStats_GetIsrCycles(void);
+
+/**
+  * @brief  Prints the counters of every instrumented interrupt that has run,
+  *         using printf().
+  */
+void IrqStats_Print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IRQ_STATS_H */
@@ -0,0 +1,38 @@
+/**
+  ******************************************************************************
+  * @file           : list_compact_bench.h
+  * @brief          : Reports the RAM taken by kernel list items and list heads
+  *                   and times context switches and sorted list inserts.
+  ******************************************************************************
+  */
+
+#ifndef LIST_COMPACT_BENCH_H
+#define LIST_COMPACT_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Yields timed between the two ping-pong tasks; the average is printed. */
+#ifndef LIST_BENCH_SWITCHES
+#define LIST_BENCH_SWITCHES       10000
+#endif
+
+/* Items in the list used to time vListInsert(). */
+#ifndef LIST_BENCH_ITEMS
+#define LIST_BENCH_ITEMS          16
+#endif
+
+/**
+  * @brief  Prints the structure sizes and creates the benchmark tasks.  Call
+  *         before the scheduler is started.  Build once with
+  *         configUSE_COMPACT_LIST_ITEMS set to 1 and once with it set to 0 to
+  *         compare; results are printed with printf().
+  */
+void ListCompactBench_Start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIST_COMPACT_BENCH_H */
@@ -0,0 +1,52 @@
+/**
+  ******************************************************************************
+  * @file           : message_queue_bench.h
+  * @brief          : Compares a variable-length message queue with a queue of
+  *                   fixed-size items padded to the largest message.
+  ******************************************************************************
+  */
+
+#ifndef MESSAGE_QUEUE_BENCH_H
+#define MESSAGE_QUEUE_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest message the application can send; the fixed-size queue pads every
+   item to this. */
+#ifndef MSGQ_BENCH_MAX_LEN
+#define MSGQ_BENCH_MAX_LEN        512
+#endif
+
+/* Number of messages either queue can hold at the typical message length. */
+#ifndef MSGQ_BENCH_DEPTH
+#define MSGQ_BENCH_DEPTH          8
+#endif
+
+/* Messages sent by each producer task in each pass. */
+#ifndef MSGQ_BENCH_MESSAGES
+#define MSGQ_BENCH_MESSAGES       5000
+#endif
+
+/* Producer and consumer tasks running at the same time. */
+#ifndef MSGQ_BENCH_PRODUCERS
+#define MSGQ_BENCH_PRODUCERS      2
+#endif
+
+#ifndef MSGQ_BENCH_CONSUMERS
+#define MSGQ_BENCH_CONSUMERS      2
+#endif
+
+/**
+  * @brief  Creates the benchmark task.  Call before the scheduler is started.
+  *         Needs configUSE_MESSAGE_QUEUES and configSUPPORT_STATIC_ALLOCATION
+  *         set to 1; results are printed with printf().
+  */
+void MessageQueueBench_Start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MESSAGE_QUEUE_BENCH_H */
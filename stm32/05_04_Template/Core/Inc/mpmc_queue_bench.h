@@ -0,0 +1,43 @@
+/**
+  ******************************************************************************
+  * @file           : mpmc_queue_bench.h
+  * @brief          : Compares the throughput and latency of a kernel queue
+  *                   and an MPMC queue with several producers and consumers.
+  ******************************************************************************
+  */
+
+#ifndef MPMC_QUEUE_BENCH_H
+#define MPMC_QUEUE_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest number of producers, and of consumers; the benchmark runs one pass
+   for each count from 1 up to this, with as many consumers as producers. */
+#ifndef MPMC_BENCH_TASKS
+#define MPMC_BENCH_TASKS          4
+#endif
+
+/* Items sent by each producer task in each pass. */
+#ifndef MPMC_BENCH_MESSAGES
+#define MPMC_BENCH_MESSAGES       5000
+#endif
+
+/* Length of the queue shared by all the tasks.  Must be a power of two. */
+#ifndef MPMC_BENCH_DEPTH
+#define MPMC_BENCH_DEPTH          8
+#endif
+
+/**
+  * @brief  Creates the benchmark task.  Call before the scheduler is started.
+  *         Needs configUSE_MPMC_QUEUES and configSUPPORT_STATIC_ALLOCATION set
+  *         to 1; results are printed with printf().
+  */
+void MpmcQueueBench_Start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MPMC_QUEUE_BENCH_H */
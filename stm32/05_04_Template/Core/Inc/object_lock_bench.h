@@ -0,0 +1,43 @@
+/**
+  ******************************************************************************
+  * @file           : object_lock_bench.h
+  * @brief          : Measures how queue throughput scales with the number of
+  *                   independent producer/consumer pairs.
+  ******************************************************************************
+  */
+
+#ifndef OBJECT_LOCK_BENCH_H
+#define OBJECT_LOCK_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest number of producer/consumer pairs; the benchmark runs one pass for
+   each count from 1 up to this. */
+#ifndef OBJLOCK_BENCH_PAIRS
+#define OBJLOCK_BENCH_PAIRS       4
+#endif
+
+/* Items sent by each producer task in each pass. */
+#ifndef OBJLOCK_BENCH_MESSAGES
+#define OBJLOCK_BENCH_MESSAGES    20000
+#endif
+
+/* Length of the queue of each pair. */
+#ifndef OBJLOCK_BENCH_DEPTH
+#define OBJLOCK_BENCH_DEPTH       8
+#endif
+
+/**
+  * @brief  Creates the benchmark task.  Call before the scheduler is started.
+  *         Needs configSUPPORT_STATIC_ALLOCATION set to 1; results are printed
+  *         with printf().
+  */
+void ObjectLockBench_Start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OBJECT_LOCK_BENCH_H */
@@ -0,0 +1,74 @@
+/**
+  ******************************************************************************
+  * @file           : pc_sampler.h
+  * @brief          : Statistical profiler that samples the program counter of
+  *                   the running task from a timer interrupt.
+  ******************************************************************************
+  * A spare timer interrupts PC_SAMPLER_HZ times a second.  Its handler reads
+  * the PC and LR that the exception entry stacked for the interrupted code,
+  * notes the task that was running, and stores the three in a buffer of
+  * PC_SAMPLER_DEPTH samples.  When the buffer is full the timer stops and
+  * the profiler task prints the samples, the names of the sampled tasks and
+  * the share of the CPU the sampler itself took, then starts the next
+  * capture.  tools/pcprof turns the output into per-task profiles and
+  * flame graphs.
+  *
+  * The interrupt runs above configMAX_SYSCALL_INTERRUPT_PRIORITY, so code in
+  * critical sections is sampled as well.  It never calls the kernel.
+  ******************************************************************************
+  */
+
+#ifndef PC_SAMPLER_H
+#define PC_SAMPLER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Sampling rate, 16 Hz to 100 kHz.  Each sample costs roughly 100 cycles,
+   so the overhead is about PC_SAMPLER_HZ * 100 / SystemCoreClock: 0.1 % at
+   1 kHz and 100 MHz.  The measured figure is printed with each capture. */
+#ifndef PC_SAMPLER_HZ
+#define PC_SAMPLER_HZ             1000
+#endif
+
+/* Samples per capture, 12 bytes each. */
+#ifndef PC_SAMPLER_DEPTH
+#define PC_SAMPLER_DEPTH          1024
+#endif
+
+/* Pause between the end of one printout and the next capture. */
+#ifndef PC_SAMPLER_PAUSE_MS
+#define PC_SAMPLER_PAUSE_MS       1000
+#endif
+
+/* NVIC priority of the sampling interrupt, 0 being the highest. */
+#ifndef PC_SAMPLER_IRQ_PRIORITY
+#define PC_SAMPLER_IRQ_PRIORITY   0
+#endif
+
+/* The timer used for sampling.  TIM11 is a 16-bit timer on APB2 that the
+   template does not otherwise use.  Any TIM with an update interrupt will
+   do; the handler name must match the vector table in the startup file. */
+#ifndef PC_SAMPLER_TIM
+#define PC_SAMPLER_TIM            TIM11
+#define PC_SAMPLER_TIM_IRQn       TIM1_TRG_COM_TIM11_IRQn
+#define PC_SAMPLER_IRQHandler     TIM1_TRG_COM_TIM11_IRQHandler
+#define PC_SAMPLER_TIM_CLK_ENABLE() (RCC->APB2ENR |= RCC_APB2ENR_TIM11EN)
+#define PC_SAMPLER_TIM_ON_APB2    1
+#endif
+
+/**
+  * @brief  Creates the profiler task, which captures and prints samples for
+  *         as long as the application runs.  Call before the scheduler is
+  *         started.  Needs configUSE_TRACE_FACILITY and
+  *         INCLUDE_xTaskGetCurrentTaskHandle set to 1; results are printed
+  *         with printf().
+  */
+void PcSampler_Start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PC_SAMPLER_H */
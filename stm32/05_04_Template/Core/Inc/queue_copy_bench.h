@@ -0,0 +1,40 @@
+/**
+  ******************************************************************************
+  * @file           : queue_copy_bench.h
+  * @brief          : Measures the CPU cycles taken to send and receive one
+  *                   item through queues of 1, 2, 4 and 8-byte items.
+  ******************************************************************************
+  */
+
+#ifndef QUEUE_COPY_BENCH_H
+#define QUEUE_COPY_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Send/receive pairs timed for each item size; the average is printed. */
+#ifndef QCOPY_BENCH_ITERATIONS
+#define QCOPY_BENCH_ITERATIONS    10000
+#endif
+
+/* Items each queue can hold.  The benchmark never has more than one item in
+   a queue, so this only sets how far the read and write positions travel
+   before they wrap. */
+#ifndef QCOPY_BENCH_DEPTH
+#define QCOPY_BENCH_DEPTH         8
+#endif
+
+/**
+  * @brief  Creates the benchmark task.  Call before the scheduler is started.
+  *         Needs configSUPPORT_STATIC_ALLOCATION set to 1.  Build once with
+  *         configQUEUE_SIZED_COPY set to 1 and once with it set to 0 to
+  *         compare; results are printed with printf().
+  */
+void QueueCopyBench_Start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* QUEUE_COPY_BENCH_H */
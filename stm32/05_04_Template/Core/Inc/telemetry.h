@@ -0,0 +1,133 @@
+/**
+  ******************************************************************************
+  * @file           : telemetry.h
+  * @brief          : Live stream of task, queue and heap statistics in compact
+  *                   binary frames, sent over UART by DMA.
+  ******************************************************************************
+  * TELEMETRY_HZ times a second the telemetry task takes a snapshot with
+  * uxTaskGetPartialSystemState(), reads the fill level of each registered
+  * queue and the heap counters, and encodes what changed since the previous
+  * frame.  Stack high water marks are only measured for key frames.
+  * Nothing is formatted as text, and the frame is handed to a DMA channel
+  * that feeds the UART, so the task never waits for the line.  When the
+  * transmit buffer has no room for a frame the frame is dropped and counted,
+  * and the next one is sent in full.  tools/ktop shows the stream as a live
+  * "top" on the host.
+  *
+  * Frame format, little endian.  "v" is an unsigned LEB128 varint:
+  *
+  *   u8 type         1 = key frame, 2 = delta frame
+  *   u8 sequence
+  *   v  tick count
+  *   v  run time of the period, in run time counter units
+  *   v  CPU cycles the previous frame cost the target
+  *   key frames only:  v CPU Hz, v period in ms, v heap size
+  *   v  free heap, v minimum ever free heap, v dropped frames
+  *   v  tasks left out, beyond TELEMETRY_MAX_TASKS
+  *   v  task count, then for each task:
+  *        v task number, u8 flags, v run time of the period
+  *        flags & 1:  v stack high water mark, in words
+  *        flags & 2:  u8 state, u8 priority
+  *        flags & 4:  u8 name length, name
+  *   v  queue count, then for each queue:
+  *        v queue index, u8 flags
+  *        flags & 1:  v items waiting
+  *        flags & 4:  u8 name length, name, v queue length
+  *   u16 CRC-16/CCITT-FALSE of all the bytes above
+  *
+  * A key frame sets every flag.  A delta frame only sets the flags of the
+  * values that changed, and of the tasks and queues that are new, but never
+  * carries a stack high water mark.  Every frame lists every task, so a task
+  * missing from a frame has been deleted, unless tasks were left out.
+  * On the line each frame is COBS encoded and followed by a zero byte, so
+  * the viewer finds the start of the next frame after any garbage.
+  ******************************************************************************
+  */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+/* Frames per second. */
+#ifndef TELEMETRY_HZ
+#define TELEMETRY_HZ              10
+#endif
+
+/* Every TELEMETRY_KEY_EVERY-th frame is a key frame, so a viewer that
+   starts late has the names of all tasks and queues within a second. */
+#ifndef TELEMETRY_KEY_EVERY
+#define TELEMETRY_KEY_EVERY       10
+#endif
+
+/* Largest number of tasks and of queues in a frame.  Tasks beyond
+   TELEMETRY_MAX_TASKS are left out of the frame and counted in it. */
+#ifndef TELEMETRY_MAX_TASKS
+#define TELEMETRY_MAX_TASKS       16
+#endif
+
+#ifndef TELEMETRY_MAX_QUEUES
+#define TELEMETRY_MAX_QUEUES      8
+#endif
+
+/* Size of the transmit ring buffer.  Must be a power of two.  At 115200
+   baud the line carries about 1100 bytes per frame at 10 Hz. */
+#ifndef TELEMETRY_TX_BUFFER
+#define TELEMETRY_TX_BUFFER       2048
+#endif
+
+/* Priority of the telemetry task.  It runs above the application so frames
+   stay on time.  A frame costs thousands of cycles, and a key frame, which
+   also scans every task's stack, tens of thousands; each frame reports the
+   cost of the one before. */
+#ifndef TELEMETRY_TASK_PRIORITY
+#define TELEMETRY_TASK_PRIORITY   (configMAX_PRIORITIES - 1)
+#endif
+
+/* NVIC priority of the DMA interrupt.  Must not be above
+   configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, as the telemetry task
+   shares the ring buffer with it inside a critical section. */
+#ifndef TELEMETRY_IRQ_PRIORITY
+#define TELEMETRY_IRQ_PRIORITY    configLIBRARY_LOWEST_INTERRUPT_PRIORITY
+#endif
+
+/* The UART and its transmit DMA stream: USART2_TX is DMA1 stream 6,
+   channel 4 on the STM32F4.  The handler name must match the vector table
+   in the startup file. */
+#ifndef TELEMETRY_USART
+#define TELEMETRY_USART           USART2
+#define TELEMETRY_DMA             DMA1
+#define TELEMETRY_DMA_STREAM      DMA1_Stream6
+#define TELEMETRY_DMA_CHANNEL     4U
+#define TELEMETRY_DMA_IFCR        HIFCR
+#define TELEMETRY_DMA_FLAGS       (DMA_HIFCR_CTCIF6 | DMA_HIFCR_CHTIF6 | DMA_HIFCR_CTEIF6 | \
+                                   DMA_HIFCR_CDMEIF6 | DMA_HIFCR_CFEIF6)
+#define TELEMETRY_DMA_IRQn        DMA1_Stream6_IRQn
+#define TELEMETRY_DMA_IRQHandler  DMA1_Stream6_IRQHandler
+#define TELEMETRY_DMA_CLK_ENABLE() (RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN)
+#endif
+
+/**
+  * @brief  Adds a queue to the frames.  The name is not copied.
+  * @retval 1 on success, 0 if TELEMETRY_MAX_QUEUES queues were added already.
+  */
+int Telemetry_AddQueue(QueueHandle_t queue, const char *name);
+
+/**
+  * @brief  Sets up the DMA channel of the UART, which must be initialised
+  *         already, and creates the telemetry task.  Needs
+  *         configUSE_TRACE_FACILITY and configGENERATE_RUN_TIME_STATS set
+  *         to 1.  The stream should have the UART to itself.
+  */
+void Telemetry_Start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TELEMETRY_H */
@@ -0,0 +1,44 @@
+/**
+  ******************************************************************************
+  * @file           : timer_slack_bench.h
+  * @brief          : Synthetic 200-timer workload that compares timer service
+  *                   wake-ups with and without timer slack.
+  ******************************************************************************
+  */
+
+#ifndef TIMER_SLACK_BENCH_H
+#define TIMER_SLACK_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of auto-reload timers in the workload. */
+#ifndef TIMER_SLACK_BENCH_TIMERS
+#define TIMER_SLACK_BENCH_TIMERS      200
+#endif
+
+/* How long each pass (no slack, then slack) runs, in milliseconds. */
+#ifndef TIMER_SLACK_BENCH_RUN_MS
+#define TIMER_SLACK_BENCH_RUN_MS      5000
+#endif
+
+/* Slack given to every timer in the second pass, as a fraction of its
+   period: period / TIMER_SLACK_BENCH_SLACK_DIV. */
+#ifndef TIMER_SLACK_BENCH_SLACK_DIV
+#define TIMER_SLACK_BENCH_SLACK_DIV   4
+#endif
+
+/**
+  * @brief  Creates the benchmark task.  Call before the scheduler is started.
+  *         Needs configUSE_TIMERS, configUSE_TIMER_SLACK and
+  *         configGENERATE_TIMER_COMMAND_STATS set to 1; results are printed
+  *         with printf().
+  */
+void TimerSlackBench_Start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIMER_SLACK_BENCH_H */
@@ -0,0 +1,89 @@
+/**
+  ******************************************************************************
+  * @file           : waveform.h
+  * @brief          : Sends bit-banged protocols by DMA from a BSRR word buffer
+  *                   paced by a timer, without the CPU toggling pins.
+  ******************************************************************************
+  * Each update event of TIM1 requests one DMA transfer of a word from the
+  * buffer to GPIOx->BSRR, so the pins change at exact slot boundaries
+  * whatever the CPU is doing.  The buffer has two halves in the stream's
+  * double buffer mode: while the DMA sends one, the transfer complete
+  * interrupt encodes the next part of the stream into the other with
+  * Waveform_Fill(), so streams of any length use a fixed buffer.  After the
+  * last word the interrupt stops the timer and notifies the task that
+  * started the stream.
+  *
+  * Only DMA2 can reach the GPIO ports on the STM32F4, and TIM1_UP is
+  * DMA2 stream 5, channel 6.
+  ******************************************************************************
+  */
+
+#ifndef WAVEFORM_H
+#define WAVEFORM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "FreeRTOS.h"
+#include "stm32f4xx_hal.h"
+#include "waveform_encode.h"
+
+/* Words in each half of the buffer, 4 bytes each.  Rounded down to whole
+   bits.  A half must last longer than the interrupt takes to fill the
+   other: 384 words of 417 ns slots are 160 us. */
+#ifndef WAVEFORM_BUFFER_WORDS
+#define WAVEFORM_BUFFER_WORDS     384
+#endif
+
+/* NVIC priority of the DMA interrupt.  Must not be above
+   configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, as it notifies the task. */
+#ifndef WAVEFORM_IRQ_PRIORITY
+#define WAVEFORM_IRQ_PRIORITY     configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY
+#endif
+
+/* The demo drives a WS2812 chain of WAVEFORM_DEMO_LEDS LEDs on PA7. */
+#ifndef WAVEFORM_DEMO_LEDS
+#define WAVEFORM_DEMO_LEDS        8
+#endif
+
+/**
+  * @brief  Sets up the timer, the DMA stream and the pins for a protocol.
+  * @param  port  Port of all the lanes' pins.
+  * @param  pins  Mask of the pins, which become push-pull outputs.
+  * @retval 1 on success, 0 if the slot length does not fit the timer.
+  */
+int Waveform_Init(GPIO_TypeDef *port, uint16_t pins, const WaveformProtocol_t *protocol);
+
+/**
+  * @retval The slot length the timer really produces, in ns.
+  */
+uint32_t Waveform_GetSlotNs(void);
+
+/**
+  * @brief  Starts sending the same number of bytes on each lane.  The data
+  *         must stay untouched until the stream has ended.  Must be called
+  *         from a task, which is notified at the end.
+  * @retval 1 if the stream started, 0 if one is still being sent.
+  */
+int Waveform_Start(uint8_t lanes, const uint16_t *lanePins, const uint8_t *const *laneData,
+                   uint32_t bytes);
+
+/**
+  * @brief  Waits for the stream started by this task to end.
+  * @retval 1 if it ended, 0 on timeout.
+  */
+int Waveform_Wait(TickType_t timeout);
+
+/**
+  * @brief  Creates a task that animates a WS2812 chain on PA7 and prints the
+  *         share of the CPU the streaming took.  Call before the scheduler
+  *         is started.
+  */
+void Waveform_StartDemo(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WAVEFORM_H */
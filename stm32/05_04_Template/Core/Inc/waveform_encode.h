@@ -0,0 +1,81 @@
+/**
+  ******************************************************************************
+  * @file           : waveform_encode.h
+  * @brief          : Turns bit streams into the GPIO BSRR words that the
+  *                   waveform engine writes to the port, one per timer period.
+  ******************************************************************************
+  * A protocol splits each bit into slotsPerBit slots of slotNs each.  A 0
+  * bit is active for the first highSlots[0] slots and inactive for the rest,
+  * a 1 bit for the first highSlots[1] slots.  That covers pulse width coded
+  * LED chains as well as plain NRZ (one slot per bit, highSlots {0, 1}).
+  * After the last bit the lines stay inactive for trailerSlots slots, the
+  * latch or reset time of the protocol.
+  *
+  * Up to WAVEFORM_MAX_LANES lanes on pins of the same port are sent side by
+  * side: each BSRR word sets the pins of the lanes that are active in that
+  * slot and resets the others, so all lanes cost one DMA transfer per slot.
+  *
+  * This file has no hardware dependencies, so tools/wavesim builds it on the
+  * host to check the timing of what the target would send.
+  ******************************************************************************
+  */
+
+#ifndef WAVEFORM_ENCODE_H
+#define WAVEFORM_ENCODE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Largest number of lanes sent together. */
+#ifndef WAVEFORM_MAX_LANES
+#define WAVEFORM_MAX_LANES        8
+#endif
+
+typedef struct
+{
+  uint32_t slotNs;          /* Length of one slot. */
+  uint8_t slotsPerBit;
+  uint8_t highSlots[2];     /* Active slots at the start of a 0 and of a 1 bit. */
+  uint8_t activeLow;        /* 1: active is low and inactive high. */
+  uint16_t trailerSlots;    /* Inactive slots after the last bit. */
+} WaveformProtocol_t;
+
+/* WS2812B LED chains: 417 ns slots give T0H 0.42 us and T1H 0.83 us in a
+   1.25 us bit, and a 300 us reset, long enough for the newer parts too. */
+#define WAVEFORM_PROTOCOL_WS2812  { 417U, 3U, { 1U, 2U }, 0U, 720U }
+
+typedef struct
+{
+  const WaveformProtocol_t *protocol;
+  uint8_t lanes;
+  uint16_t lanePins[WAVEFORM_MAX_LANES];        /* GPIO pin mask of each lane. */
+  const uint8_t *laneData[WAVEFORM_MAX_LANES];  /* Sent MSB first. */
+  uint32_t bits;                                /* Bits per lane. */
+  uint32_t nextBit;
+  uint32_t trailerLeft;
+} WaveformStream_t;
+
+/**
+  * @brief  Prepares a stream of the same number of bytes on each lane.
+  */
+void Waveform_StreamInit(WaveformStream_t *stream, const WaveformProtocol_t *protocol,
+                         uint8_t lanes, const uint16_t *lanePins,
+                         const uint8_t *const *laneData, uint32_t bytes);
+
+/**
+  * @brief  Writes the next words of the stream, then fills the rest of the
+  *         buffer with inactive levels.
+  * @param  count  Words to write, a multiple of slotsPerBit so no bit is
+  *                split between two buffers.
+  * @retval Words that carry bits or trailer, 0 once the stream has ended.
+  */
+uint32_t Waveform_Fill(WaveformStream_t *stream, uint32_t *words, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WAVEFORM_ENCODE_H */
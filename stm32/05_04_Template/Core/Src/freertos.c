@@ -24,6 +24,14 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "bench.h"
+#include "list_compact_bench.h"
+#include "timer_slack_bench.h"
+#include "message_queue_bench.h"
+#include "queue_copy_bench.h"
+#include "object_lock_bench.h"
+#include "mpmc_queue_bench.h"
+#include "idle_jobs_demo.h"
 
 /* USER CODE END Includes */
 
@@ -70,5 +78,27 @@ void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer, StackTy
 
 /* Private application code --------------------------------------------------*/
 /* USER CODE BEGIN Application */
+int Bench_Start(void)
+{
+#if (BENCH_SELECT == BENCH_LIST_COMPACT)
+  ListCompactBench_Start();
+#elif (BENCH_SELECT == BENCH_TIMER_SLACK)
+  TimerSlackBench_Start();
+#elif (BENCH_SELECT == BENCH_MESSAGE_QUEUE)
+  MessageQueueBench_Start();
+#elif (BENCH_SELECT == BENCH_QUEUE_COPY)
+  QueueCopyBench_Start();
+#elif (BENCH_SELECT == BENCH_OBJECT_LOCK)
+  ObjectLockBench_Start();
+#elif (BENCH_SELECT == BENCH_MPMC_QUEUE)
+  MpmcQueueBench_Start();
+#elif (BENCH_SELECT == BENCH_IDLE_JOBS)
+  IdleJobsDemo_Start();
+#elif (BENCH_SELECT != BENCH_NONE)
+#error "BENCH_SELECT is not one of the BENCH_ values in bench.h"
+#endif
+
+  return (BENCH_SELECT != BENCH_NONE) ? 1 : 0;
+}
 
 /* USER CODE END Application */
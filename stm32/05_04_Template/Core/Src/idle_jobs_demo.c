@@ -0,0 +1,197 @@
+/**
+  ******************************************************************************
+  * @file           : idle_jobs_demo.c
+  * @brief          : Runs background work as idle jobs with per-job budgets
+  *                   and prints how the idle time was shared out.
+  ******************************************************************************
+  * Two jobs share the idle time left by a load task that is busy for
+  * IDLE_JOBS_LOAD_PERCENT of every 10 ms:
+  *   - "scrub" checksums a block of RAM a word at a time, resuming where its
+  *     last turn stopped.  The report task triggers a new pass every period.
+  *   - "gc" stands in for flash garbage collection: the load task dirties a
+  *     block now and then, and each step of the job erases one of them.
+  * Both jobs poll xTaskIdleJobShouldYield() between steps, so they hand the
+  * CPU back as soon as the load task wakes or their budget is spent.
+  *
+  * Every IDLE_JOBS_REPORT_MS the report task prints, for each job, the share
+  * of the idle time it used, its turns, its overruns and whether it still has
+  * work, followed by the idle time no job needed.
+  ******************************************************************************
+  */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "idle_jobs_demo.h"
+#include "bench.h"
+
+#include <stdio.h>
+
+#if (configUSE_IDLE_JOBS == 1)
+
+#define IDLE_JOBS_SCRUB_WORDS     4096U
+#define IDLE_JOBS_GC_STEP_LOOPS   2000U
+
+static uint32_t scrubArea[IDLE_JOBS_SCRUB_WORDS];
+static uint32_t scrubIndex;
+static uint32_t scrubSum;
+static volatile uint32_t scrubPasses;
+
+static volatile uint32_t gcDirty;
+static volatile uint32_t gcErased;
+
+static IdleJobHandle_t scrubJob;
+static IdleJobHandle_t gcJob;
+
+static BaseType_t ScrubJob(void *argument)
+{
+  (void)argument;
+
+  do
+  {
+    scrubSum = (scrubSum << 1 | scrubSum >> 31) ^ scrubArea[scrubIndex];
+
+    if (++scrubIndex == IDLE_JOBS_SCRUB_WORDS)
+    {
+      scrubIndex = 0;
+      scrubSum = 0;
+      scrubPasses++;
+
+      /* Done until the report task asks for the next pass. */
+      return pdFALSE;
+    }
+  } while (xTaskIdleJobShouldYield() == pdFALSE);
+
+  return pdTRUE;
+}
+
+static BaseType_t GcJob(void *argument)
+{
+  volatile uint32_t i;
+
+  (void)argument;
+
+  while (gcDirty != 0U)
+  {
+    /* Erasing a block takes a while and cannot be split. */
+    for (i = 0; i < IDLE_JOBS_GC_STEP_LOOPS; i++)
+    {
+    }
+
+    taskENTER_CRITICAL();
+    gcDirty--;
+    taskEXIT_CRITICAL();
+    gcErased++;
+
+    if (xTaskIdleJobShouldYield() != pdFALSE)
+    {
+      break;
+    }
+  }
+
+  return (gcDirty != 0U) ? pdTRUE : pdFALSE;
+}
+
+static void IdleJobsLoadTask(void *argument)
+{
+  TickType_t start, busy;
+  uint32_t periods = 0;
+
+  (void)argument;
+
+  busy = pdMS_TO_TICKS(10U * IDLE_JOBS_LOAD_PERCENT / 100U);
+
+  for (;;)
+  {
+    start = xTaskGetTickCount();
+    while ((xTaskGetTickCount() - start) < busy)
+    {
+    }
+
+    /* Dirty a flash block every other period. */
+    if ((++periods & 1U) == 0U)
+    {
+      taskENTER_CRITICAL();
+      gcDirty++;
+      taskEXIT_CRITICAL();
+      vTaskTriggerIdleJob(gcJob);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(10U) - busy);
+  }
+}
+
+static void IdleJobsReportTask(void *argument)
+{
+  IdleJobStatus_t jobs[configIDLE_JOB_REGISTRY_SIZE];
+  uint32_t lastTime[configIDLE_JOB_REGISTRY_SIZE] = { 0 };
+  uint32_t lastRuns[configIDLE_JOB_REGISTRY_SIZE] = { 0 };
+  uint32_t lastOverruns[configIDLE_JOB_REGISTRY_SIZE] = { 0 };
+  uint32_t idle, lastIdle = 0, period, used, count, i;
+
+  (void)argument;
+
+  for (;;)
+  {
+    vTaskDelay(pdMS_TO_TICKS(IDLE_JOBS_REPORT_MS));
+
+    count = uxTaskGetIdleJobStats(jobs, configIDLE_JOB_REGISTRY_SIZE, &idle);
+    period = idle - lastIdle;
+    lastIdle = idle;
+    used = 0;
+
+    printf("Idle jobs: scrub passes %lu, blocks erased %lu, dirty %lu\r\n",
+           (unsigned long)scrubPasses, (unsigned long)gcErased, (unsigned long)gcDirty);
+
+    for (i = 0; i < count; i++)
+    {
+      uint32_t time = jobs[i].ulRunTimeCounter - lastTime[i];
+
+      used += time;
+      printf("  %-8s budget %8lu  idle %3lu%%  turns %6lu  overruns %4lu  %s\r\n",
+             jobs[i].pcJobName, (unsigned long)jobs[i].ulBudget,
+             (unsigned long)((period != 0U) ? ((uint64_t)time * 100U) / period : 0U),
+             (unsigned long)(jobs[i].ulRuns - lastRuns[i]),
+             (unsigned long)(jobs[i].ulOverruns - lastOverruns[i]),
+             (jobs[i].xPending != pdFALSE) ? "pending" : "done");
+
+      lastTime[i] = jobs[i].ulRunTimeCounter;
+      lastRuns[i] = jobs[i].ulRuns;
+      lastOverruns[i] = jobs[i].ulOverruns;
+    }
+
+    printf("  spare idle %3lu%%\r\n",
+           (unsigned long)((period != 0U) ? ((uint64_t)(period - used) * 100U) / period : 0U));
+
+    vTaskTriggerIdleJob(scrubJob);
+  }
+}
+
+void IdleJobsDemo_Start(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < IDLE_JOBS_SCRUB_WORDS; i++)
+  {
+    scrubArea[i] = i * 0x9E3779B9UL;
+  }
+
+  scrubJob = xTaskRegisterIdleJob("scrub", ScrubJob, NULL, IDLE_JOBS_SCRUB_BUDGET);
+  gcJob = xTaskRegisterIdleJob("gc", GcJob, NULL, IDLE_JOBS_GC_BUDGET);
+
+  if ((scrubJob == NULL) || (gcJob == NULL))
+  {
+    printf("Idle jobs demo: the idle job registry is full\r\n");
+    return;
+  }
+
+  xTaskCreate(IdleJobsLoadTask, "IjLoad", configMINIMAL_STACK_SIZE, NULL,
+              tskIDLE_PRIORITY + 1U, NULL);
+  xTaskCreate(IdleJobsReportTask, "IjReport", configMINIMAL_STACK_SIZE * 2U, NULL,
+              tskIDLE_PRIORITY + 2U, NULL);
+}
+
+#elif (BENCH_SELECT == BENCH_IDLE_JOBS)
+
+#error "The idle jobs demo needs configUSE_IDLE_JOBS set to 1"
+
+#endif
@@ -0,0 +1,133 @@
+/**
+  ******************************************************************************
+  * @file           : irq_record.c
+  * @brief          : Records when interrupts arrived and what they carried, for
+  *                   replay against the same application code on the host.
+  ******************************************************************************
+  * Events are timed with the DWT cycle counter and stored as the difference
+  * to the previous event, so a burst of received bytes costs three or four
+  * bytes per byte.  The difference is 32 bits wide: a gap of more than 2^32
+  * cycles between two events, about 43 s at 100 MHz, is recorded modulo
+  * 2^32.
+  ******************************************************************************
+  */
+
+#include "FreeRTOS.h"
+#include "irq_record.h"
+#include "stm32f4xx.h"
+
+#include <stdio.h>
+
+/* Largest encoded event: two 5-byte varints and the source. */
+#define IRQ_RECORD_EVENT_MAX      11U
+
+/* Log bytes per "irq d" line. */
+#define IRQ_RECORD_LINE_BYTES     32U
+
+static uint8_t recordLog[IRQ_RECORD_BYTES];
+static uint32_t recordUsed;
+static uint32_t recordEvents;
+static uint32_t recordLost;
+static uint32_t recordLastStamp;
+static volatile uint8_t recordOn;
+static volatile uint8_t recordFull;
+
+static uint32_t PutVarint(uint32_t pos, uint32_t value)
+{
+  while (value >= 0x80U)
+  {
+    recordLog[pos++] = (uint8_t)(value | 0x80U);
+    value >>= 7;
+  }
+  recordLog[pos++] = (uint8_t)value;
+
+  return pos;
+}
+
+void IrqRecord_Start(void)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  __disable_irq();
+  recordUsed = 0;
+  recordEvents = 0;
+  recordLost = 0;
+  recordFull = 0;
+  recordLastStamp = DWT->CYCCNT;
+  recordOn = 1;
+  __set_PRIMASK(primask);
+}
+
+void IrqRecord_Stop(void)
+{
+  recordOn = 0;
+}
+
+void IrqRecord_Event(uint8_t source, uint32_t payload)
+{
+  uint32_t primask, stamp, pos;
+
+  if (recordOn == 0U)
+  {
+    return;
+  }
+
+  /* Masked, so that a nested interrupt cannot take a stamp between this
+     one's stamp and its place in the log. */
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  if ((recordFull != 0U) || ((recordUsed + IRQ_RECORD_EVENT_MAX) > IRQ_RECORD_BYTES))
+  {
+    recordFull = 1;
+    recordLost++;
+  }
+  else
+  {
+    stamp = DWT->CYCCNT;
+    pos = PutVarint(recordUsed, stamp - recordLastStamp);
+    recordLog[pos++] = source;
+    recordUsed = PutVarint(pos, payload);
+    recordLastStamp = stamp;
+    recordEvents++;
+  }
+
+  __set_PRIMASK(primask);
+}
+
+int IrqRecord_IsRecording(void)
+{
+  return ((recordOn != 0U) && (recordFull == 0U)) ? 1 : 0;
+}
+
+uint32_t IrqRecord_Dump(void)
+{
+  uint32_t i;
+
+  IrqRecord_Stop();
+
+  printf("irq begin %lu %lu\r\n", (unsigned long)SystemCoreClock, (unsigned long)configTICK_RATE_HZ);
+
+  for (i = 0; i < recordUsed; i++)
+  {
+    if ((i % IRQ_RECORD_LINE_BYTES) == 0U)
+    {
+      printf("irq d ");
+    }
+
+    printf("%02x", recordLog[i]);
+
+    if ((((i + 1U) % IRQ_RECORD_LINE_BYTES) == 0U) || ((i + 1U) == recordUsed))
+    {
+      printf("\r\n");
+    }
+  }
+
+  printf("irq end %lx %lx %lx\r\n", (unsigned long)recordEvents, (unsigned long)recordUsed,
+         (unsigned long)recordLost);
+
+  return recordEvents;
+}
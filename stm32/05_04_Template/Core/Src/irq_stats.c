@@ -0,0 +1,189 @@
+/**
+  ******************************************************************************
+  * @file           : irq_stats.c
+  * @brief          : Per-interrupt execution count and cycle accounting.
+  ******************************************************************************
+  * Instrumented vectors in the RAM copy of the vector table point at
+  * IrqStats_Wrapper().  The wrapper finds the exception number in IPSR, calls
+  * the handler from the original table and charges the cycles to that
+  * exception.  Each nesting level keeps the cycles used by the interrupts
+  * nested inside it, so they can be taken off its own count when it returns.
+  ******************************************************************************
+  */
+
+#include "irq_stats.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* System exceptions plus the device interrupts of the STM32F411. */
+#define IRQ_STATS_VECTORS         (16U + (uint32_t)SPI5_IRQn + 1U)
+
+/* VTOR needs the table aligned to its size rounded up to a power of two. */
+#define IRQ_STATS_TABLE_ALIGN     512U
+
+typedef void (*IrqHandler_t)(void);
+
+static IrqHandler_t ramVectors[IRQ_STATS_VECTORS] __attribute__((aligned(IRQ_STATS_TABLE_ALIGN)));
+static const IrqHandler_t *originalVectors;
+static uint8_t instrumented[IRQ_STATS_VECTORS];
+static IrqStats_t stats[IRQ_STATS_VECTORS];
+
+static uint32_t nesting;
+static uint32_t maxNesting;
+static uint32_t nestedCycles[IRQ_STATS_MAX_NESTING];
+static volatile uint32_t isrCycles;
+
+static void IrqStats_Wrapper(void)
+{
+  uint32_t vector = __get_IPSR() & 0x1FFU;
+  uint32_t primask, level, start, elapsed, own;
+  IrqStats_t *entry = &stats[vector];
+
+  /* A higher priority interrupt can arrive at any point, so the nesting
+     bookkeeping is done with interrupts masked. */
+  primask = __get_PRIMASK();
+  __disable_irq();
+  level = nesting++;
+  if (nesting > maxNesting)
+  {
+    maxNesting = nesting;
+  }
+  if (level < IRQ_STATS_MAX_NESTING)
+  {
+    nestedCycles[level] = 0;
+  }
+  start = DWT->CYCCNT;
+  __set_PRIMASK(primask);
+
+  originalVectors[vector]();
+
+  __disable_irq();
+  elapsed = DWT->CYCCNT - start;
+  own = elapsed;
+  if (level < IRQ_STATS_MAX_NESTING)
+  {
+    own -= nestedCycles[level];
+  }
+  if (level == 0U)
+  {
+    isrCycles += elapsed;
+  }
+  else if (level <= IRQ_STATS_MAX_NESTING)
+  {
+    nestedCycles[level - 1U] += elapsed;
+  }
+  nesting--;
+
+  entry->count++;
+  entry->totalCycles += own;
+  if (own > entry->maxCycles)
+  {
+    entry->maxCycles = own;
+  }
+  __set_PRIMASK(primask);
+}
+
+void IrqStats_Init(void)
+{
+  uint32_t primask;
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  if (originalVectors != NULL)
+  {
+    return;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  originalVectors = (const IrqHandler_t *)SCB->VTOR;
+  memcpy(ramVectors, originalVectors, sizeof(ramVectors));
+  SCB->VTOR = (uint32_t)ramVectors;
+  __DSB();
+  __set_PRIMASK(primask);
+}
+
+void IrqStats_Instrument(IRQn_Type irq)
+{
+  uint32_t vector = (uint32_t)((int32_t)irq + 16);
+
+  if ((irq == SVCall_IRQn) || (irq == PendSV_IRQn) || (vector >= IRQ_STATS_VECTORS))
+  {
+    return;
+  }
+
+  IrqStats_Init();
+  instrumented[vector] = 1U;
+  ramVectors[vector] = IrqStats_Wrapper;
+  __DSB();
+}
+
+int IrqStats_Get(IRQn_Type irq, IrqStats_t *out)
+{
+  uint32_t vector = (uint32_t)((int32_t)irq + 16);
+  uint32_t primask;
+
+  if ((vector >= IRQ_STATS_VECTORS) || (instrumented[vector] == 0U))
+  {
+    return 0;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  *out = stats[vector];
+  __set_PRIMASK(primask);
+
+  return 1;
+}
+
+void IrqStats_Reset(void)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  memset(stats, 0, sizeof(stats));
+  maxNesting = nesting;
+  __set_PRIMASK(primask);
+}
+
+uint32_t IrqStats_GetMaxNesting(void)
+{
+  return maxNesting;
+}
+
+uint32_t IrqStats_GetCycles(void)
+{
+  return DWT->CYCCNT;
+}
+
+uint32_t IrqStats_GetIsrCycles(void)
+{
+  return isrCycles;
+}
+
+void IrqStats_Print(void)
+{
+  IrqStats_t entry;
+  uint32_t vector;
+
+  /* newlib-nano's printf() has no 64-bit conversions, so the total is
+     printed in thousands of cycles. */
+  printf("\r\nIRQ     count  total kcycles  avg cycles  max cycles\r\n");
+
+  for (vector = 0; vector < IRQ_STATS_VECTORS; vector++)
+  {
+    if (IrqStats_Get((IRQn_Type)((int32_t)vector - 16), &entry) == 0 || entry.count == 0U)
+    {
+      continue;
+    }
+
+    printf("%4ld  %9lu  %13lu  %10lu  %10lu\r\n", (long)vector - 16L,
+           (unsigned long)entry.count, (unsigned long)(entry.totalCycles / 1000U),
+           (unsigned long)(entry.totalCycles / entry.count), (unsigned long)entry.maxCycles);
+  }
+
+  printf("max nesting %lu, %lu cycles in interrupts\r\n",
+         (unsigned long)maxNesting, (unsigned long)isrCycles);
+}
@@ -0,0 +1,156 @@
+/**
+  ******************************************************************************
+  * @file           : list_compact_bench.c
+  * @brief          : Reports the RAM taken by kernel list items and list heads
+  *                   and times context switches and sorted list inserts.
+  ******************************************************************************
+  * Every task holds two list items and every queue two event lists, so the
+  * saving from configUSE_COMPACT_LIST_ITEMS is printed per task and per queue
+  * from the static structure sizes.
+  *
+  * Two tasks of the same priority then hand the processor to each other with
+  * taskYIELD(), LIST_BENCH_SWITCHES times, with the DWT cycle counter running.
+  * Each yield selects the next task through the ready list, which is where
+  * the owner of a list item is looked up on every switch.  Last, items with
+  * pseudo-random values are inserted into a sorted list and removed again.
+  ******************************************************************************
+  */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "list.h"
+#include "list_compact_bench.h"
+#include "stm32f4xx.h"
+
+#include <stdio.h>
+
+typedef struct
+{
+  uint32_t id;
+  ListItem_t item;
+} BenchItem_t;
+
+static volatile uint32_t switches;
+static volatile uint32_t done;
+static uint32_t switchStart;
+static uint32_t switchCycles;
+static BenchItem_t items[LIST_BENCH_ITEMS];
+static List_t list;
+
+static void BenchCycleCounterStart(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static uint32_t BenchCyclesToNs(uint32_t cycles)
+{
+  return (uint32_t)(((uint64_t)cycles * 1000000000U) / SystemCoreClock);
+}
+
+static void BenchPrintSizes(void)
+{
+  printf("\r\nList benchmark: configUSE_COMPACT_LIST_ITEMS=%d\r\n", (int)configUSE_COMPACT_LIST_ITEMS);
+  printf("ListItem_t %2u B  MiniListItem_t %2u B  List_t %2u B\r\n",
+         (unsigned)sizeof(ListItem_t), (unsigned)sizeof(MiniListItem_t), (unsigned)sizeof(List_t));
+  printf("StaticTask_t %3u B  StaticQueue_t %2u B  StaticTimer_t %2u B\r\n",
+         (unsigned)sizeof(StaticTask_t), (unsigned)sizeof(StaticQueue_t), (unsigned)sizeof(StaticTimer_t));
+
+#if (configUSE_COMPACT_LIST_ITEMS == 1)
+  /* A task has a state and an event list item, each without an owner
+     pointer.  A queue has two lists, each without an end item value. */
+  printf("saved %u B per task, %u B per queue\r\n",
+         (unsigned)(2U * sizeof(void *)), (unsigned)(2U * sizeof(TickType_t)));
+#endif
+}
+
+/* Both tasks run this.  The last of them to finish prints the result. */
+static void ListBenchSwitchTask(void *argument)
+{
+  (void)argument;
+
+  if (switches == 0U)
+  {
+    switchStart = DWT->CYCCNT;
+  }
+
+  while (switches < LIST_BENCH_SWITCHES)
+  {
+    switches++;
+    taskYIELD();
+  }
+
+  if (++done == 2U)
+  {
+    switchCycles = DWT->CYCCNT - switchStart;
+    printf("taskYIELD  %4lu cycles/switch  %4lu ns/switch\r\n",
+           (unsigned long)(switchCycles / LIST_BENCH_SWITCHES),
+           (unsigned long)BenchCyclesToNs(switchCycles / LIST_BENCH_SWITCHES));
+  }
+  vTaskDelete(NULL);
+}
+
+static void ListBenchInsertTask(void *argument)
+{
+  uint32_t seed = 0x12345678U;
+  uint32_t start, cycles = 0;
+  uint32_t pass, i;
+
+  (void)argument;
+
+  /* Let the ping-pong tasks finish first. */
+  while (done < 2U)
+  {
+    vTaskDelay(1);
+  }
+
+  vListInitialise(&list);
+  for (i = 0; i < LIST_BENCH_ITEMS; i++)
+  {
+    items[i].id = i;
+    vListInitialiseItem(&items[i].item);
+    listSET_LIST_ITEM_OWNER(&items[i].item, &items[i]);
+  }
+
+  for (pass = 0; pass < 100U; pass++)
+  {
+    for (i = 0; i < LIST_BENCH_ITEMS; i++)
+    {
+      seed = (seed * 1103515245U) + 12345U;
+      listSET_LIST_ITEM_VALUE(&items[i].item, (TickType_t)(seed >> 16));
+    }
+
+    start = DWT->CYCCNT;
+    for (i = 0; i < LIST_BENCH_ITEMS; i++)
+    {
+      vListInsert(&list, &items[i].item);
+    }
+    cycles += DWT->CYCCNT - start;
+
+    /* Empty the list from the head, as the kernel does when tasks time out. */
+    while (listLIST_IS_EMPTY(&list) == pdFALSE)
+    {
+      BenchItem_t *head = listGET_OWNER_OF_HEAD_ENTRY_OF_TYPE(&list, BenchItem_t, item);
+      (void)uxListRemove(&head->item);
+    }
+  }
+
+  cycles /= 100U * LIST_BENCH_ITEMS;
+  printf("vListInsert %3lu cycles/insert  %4lu ns/insert (%u items)\r\n",
+         (unsigned long)cycles, (unsigned long)BenchCyclesToNs(cycles), (unsigned)LIST_BENCH_ITEMS);
+
+  vTaskDelete(NULL);
+}
+
+void ListCompactBench_Start(void)
+{
+  BenchCycleCounterStart();
+  BenchPrintSizes();
+
+  switches = 0;
+  done = 0;
+  xTaskCreate(ListBenchSwitchTask, "LbPing", configMINIMAL_STACK_SIZE * 2U, NULL, tskIDLE_PRIORITY + 2U, NULL);
+  xTaskCreate(ListBenchSwitchTask, "LbPong", configMINIMAL_STACK_SIZE * 2U, NULL, tskIDLE_PRIORITY + 2U, NULL);
+  xTaskCreate(ListBenchInsertTask, "LbIns", configMINIMAL_STACK_SIZE * 2U, NULL, tskIDLE_PRIORITY + 1U, NULL);
+}
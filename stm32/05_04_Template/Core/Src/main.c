@@ -2,6 +2,7 @@
 
 #include "main.h"
 #include "cmsis_os.h"
+#include "bench.h"
 
 
 UART_HandleTypeDef huart2;
@@ -26,6 +27,11 @@ int main(void)
   MX_GPIO_Init();
   MX_USART2_UART_Init();
 
+  /* A benchmark chosen in bench.h runs under the scheduler. */
+  if (Bench_Start() != 0)
+  {
+    vTaskStartScheduler();
+  }
 
 
   while (1)
@@ -0,0 +1,207 @@
+/**
+  ******************************************************************************
+  * @file           : message_queue_bench.c
+  * @brief          : Compares a variable-length message queue with a queue of
+  *                   fixed-size items padded to the largest message.
+  ******************************************************************************
+  * Both passes move the same messages, 8 to 127 bytes long, from
+  * MSGQ_BENCH_PRODUCERS producer tasks to MSGQ_BENCH_CONSUMERS consumer tasks:
+  *   - "fixed":  a FreeRTOS queue whose items are MSGQ_BENCH_MAX_LEN bytes,
+  *               which is how large messages have to be sent through queue.c,
+  *   - "msgq":   a message queue holding only each message and its length.
+  * For each pass the benchmark prints the storage used, the time per message
+  * and the throughput.
+  ******************************************************************************
+  */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "message_queue.h"
+#include "message_queue_bench.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if (configUSE_MESSAGE_QUEUES == 1) && (configSUPPORT_STATIC_ALLOCATION == 1)
+
+/* Longest message in the workload; the message queue is sized for
+   MSGQ_BENCH_DEPTH of these, which still leaves room for one
+   MSGQ_BENCH_MAX_LEN message. */
+#define MSGQ_BENCH_TYPICAL_LEN    128U
+#define MSGQ_BENCH_STORAGE        mqSTORAGE_BYTES(MSGQ_BENCH_DEPTH, MSGQ_BENCH_TYPICAL_LEN)
+#define MSGQ_BENCH_TOTAL          ((uint32_t)MSGQ_BENCH_PRODUCERS * MSGQ_BENCH_MESSAGES)
+
+typedef struct
+{
+  uint16_t length;
+  uint8_t data[MSGQ_BENCH_MAX_LEN - sizeof(uint16_t)];
+} FixedItem_t;
+
+typedef struct
+{
+  size_t storageBytes;
+  TickType_t ticks;
+  uint32_t bytes;
+} BenchResult_t;
+
+static StaticQueue_t fixedQueueStruct;
+static uint8_t fixedQueueStorage[MSGQ_BENCH_DEPTH * sizeof(FixedItem_t)];
+static StaticMessageQueue_t msgQueueStruct;
+static uint8_t msgQueueStorage[MSGQ_BENCH_STORAGE];
+
+static QueueHandle_t fixedQueue;
+static MessageQueueHandle_t msgQueue;
+static TaskHandle_t benchTask;
+static volatile BaseType_t benchUseMsgQueue;
+static volatile uint32_t benchReceived;
+static volatile uint32_t benchBytes;
+
+static size_t BenchLength(uint32_t index)
+{
+  return (size_t)(8U + ((index * 29U) % 120U));
+}
+
+static void BenchProducer(void *argument)
+{
+  static FixedItem_t item[MSGQ_BENCH_PRODUCERS];
+  FixedItem_t *ownItem = &item[(uintptr_t)argument];
+  uint32_t i;
+
+  for (i = 0; i < MSGQ_BENCH_MESSAGES; i++)
+  {
+    ownItem->length = (uint16_t)BenchLength(i);
+    memset(ownItem->data, (int)i, ownItem->length);
+
+    if (benchUseMsgQueue != pdFALSE)
+    {
+      xMessageQueueSend(msgQueue, ownItem->data, ownItem->length, portMAX_DELAY);
+    }
+    else
+    {
+      xQueueSend(fixedQueue, ownItem, portMAX_DELAY);
+    }
+  }
+
+  vTaskDelete(NULL);
+}
+
+static void BenchConsumer(void *argument)
+{
+  static FixedItem_t item[MSGQ_BENCH_CONSUMERS];
+  FixedItem_t *ownItem = &item[(uintptr_t)argument];
+  size_t length;
+
+  for (;;)
+  {
+    if (benchUseMsgQueue != pdFALSE)
+    {
+      length = xMessageQueueReceive(msgQueue, ownItem->data, sizeof(ownItem->data), portMAX_DELAY);
+    }
+    else
+    {
+      xQueueReceive(fixedQueue, ownItem, portMAX_DELAY);
+      length = ownItem->length;
+    }
+
+    taskENTER_CRITICAL();
+    benchBytes += (uint32_t)length;
+    if (++benchReceived == MSGQ_BENCH_TOTAL)
+    {
+      xTaskNotifyGive(benchTask);
+    }
+    taskEXIT_CRITICAL();
+  }
+}
+
+static void BenchRunPass(BaseType_t useMsgQueue, BenchResult_t *result)
+{
+  TaskHandle_t consumers[MSGQ_BENCH_CONSUMERS];
+  TickType_t start;
+  uint32_t i;
+
+  benchUseMsgQueue = useMsgQueue;
+  benchReceived = 0;
+  benchBytes = 0;
+
+  /* The workers run below this task, so none of them starts before all
+     of them have been created. */
+  for (i = 0; i < MSGQ_BENCH_CONSUMERS; i++)
+  {
+    xTaskCreate(BenchConsumer, "MqCons", configMINIMAL_STACK_SIZE, (void *)(uintptr_t)i, tskIDLE_PRIORITY + 1U, &consumers[i]);
+  }
+  for (i = 0; i < MSGQ_BENCH_PRODUCERS; i++)
+  {
+    xTaskCreate(BenchProducer, "MqProd", configMINIMAL_STACK_SIZE, (void *)(uintptr_t)i, tskIDLE_PRIORITY + 1U, NULL);
+  }
+
+  start = xTaskGetTickCount();
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  result->ticks = xTaskGetTickCount() - start;
+  result->bytes = benchBytes;
+
+  /* The consumers are blocked on the empty queue. */
+  for (i = 0; i < MSGQ_BENCH_CONSUMERS; i++)
+  {
+    vTaskDelete(consumers[i]);
+  }
+
+  /* Give the idle task a chance to free the deleted tasks. */
+  vTaskDelay(pdMS_TO_TICKS(50));
+}
+
+static void BenchPrint(const char *name, const BenchResult_t *result)
+{
+  uint32_t us = (uint32_t)(((uint64_t)result->ticks * 1000000U) / configTICK_RATE_HZ);
+
+  printf("%-6s storage=%lu B", name, (unsigned long)result->storageBytes);
+
+  if (us == 0U)
+  {
+    printf("  run too short to time, raise MSGQ_BENCH_MESSAGES\r\n");
+    return;
+  }
+
+  printf("  %lu ns/message  %lu messages/s  %lu KB/s\r\n",
+         (unsigned long)(((uint64_t)us * 1000U) / MSGQ_BENCH_TOTAL),
+         (unsigned long)(((uint64_t)MSGQ_BENCH_TOTAL * 1000000U) / us),
+         (unsigned long)((((uint64_t)result->bytes * 1000000U) / us) / 1024U));
+}
+
+static void MessageQueueBenchTask(void *argument)
+{
+  BenchResult_t fixed, msgq;
+
+  (void)argument;
+
+  benchTask = xTaskGetCurrentTaskHandle();
+  fixedQueue = xQueueCreateStatic(MSGQ_BENCH_DEPTH, sizeof(FixedItem_t), fixedQueueStorage, &fixedQueueStruct);
+  msgQueue = xMessageQueueCreateStatic(sizeof(msgQueueStorage), msgQueueStorage, &msgQueueStruct);
+
+  fixed.storageBytes = sizeof(fixedQueueStorage) + sizeof(StaticQueue_t);
+  msgq.storageBytes = sizeof(msgQueueStorage) + sizeof(StaticMessageQueue_t);
+
+  BenchRunPass(pdFALSE, &fixed);
+  BenchRunPass(pdTRUE, &msgq);
+
+  printf("\r\nMessage queue benchmark: %u producers, %u consumers, %lu messages of 8-127 bytes, max %u\r\n",
+         (unsigned)MSGQ_BENCH_PRODUCERS, (unsigned)MSGQ_BENCH_CONSUMERS,
+         (unsigned long)MSGQ_BENCH_TOTAL, (unsigned)MSGQ_BENCH_MAX_LEN);
+  BenchPrint("fixed", &fixed);
+  BenchPrint("msgq", &msgq);
+
+  vTaskDelete(NULL);
+}
+
+void MessageQueueBench_Start(void)
+{
+  xTaskCreate(MessageQueueBenchTask, "MqBench", configMINIMAL_STACK_SIZE * 2U, NULL,
+              tskIDLE_PRIORITY + 2U, NULL);
+}
+
+#elif (BENCH_SELECT == BENCH_MESSAGE_QUEUE)
+
+#error "The message queue benchmark needs configUSE_MESSAGE_QUEUES and configSUPPORT_STATIC_ALLOCATION set to 1"
+
+#endif
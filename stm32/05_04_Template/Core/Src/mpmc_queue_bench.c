@@ -0,0 +1,249 @@
+/**
+  ******************************************************************************
+  * @file           : mpmc_queue_bench.c
+  * @brief          : Compares the throughput and latency of a kernel queue
+  *                   and an MPMC queue with several producers and consumers.
+  ******************************************************************************
+  * Pass n runs n producers and n consumers on one shared queue, first a
+  * kernel queue (xQueueSend()/xQueueReceive()) and then an MPMC queue
+  * (xMpmcQueueSend()/xMpmcQueueReceive()) of the same depth.  Each item
+  * carries the DWT cycle count of its send, and the consumer files the time
+  * to its receive into a power-of-two histogram, from which the median, the
+  * 99th percentile and the worst case are printed next to the throughput.
+  *
+  * On this single-core part the tasks take turns on the one CPU, so the pass
+  * shows the cost of each queue's own path and of the blocking it causes
+  * rather than any cross-core scaling.  Latencies are bucket upper bounds.
+  ******************************************************************************
+  */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "mpmc_queue.h"
+#include "mpmc_queue_bench.h"
+#include "bench.h"
+#include "stm32f4xx.h"
+
+#include <stdio.h>
+
+#if (configUSE_MPMC_QUEUES == 1) && (configSUPPORT_STATIC_ALLOCATION == 1)
+
+/* Bucket b counts latencies below 2^b cycles, and the last one the rest. */
+#define MPMC_BENCH_BUCKETS  24U
+
+typedef struct
+{
+  uint32_t histogram[MPMC_BENCH_BUCKETS];
+  uint32_t worst;
+} BenchConsumer_t;
+
+static StaticQueue_t kernelQueueStruct;
+static uint8_t kernelQueueStorage[MPMC_BENCH_DEPTH * sizeof(uint32_t)];
+static StaticMpmcQueue_t mpmcQueueStruct;
+static size_t mpmcQueueStorage[mpmcSTORAGE_WORDS(MPMC_BENCH_DEPTH, sizeof(uint32_t))];
+
+static QueueHandle_t kernelQueue;
+static MpmcQueueHandle_t mpmcQueue;
+static BaseType_t useMpmc;
+static BenchConsumer_t consumers[MPMC_BENCH_TASKS];
+static TaskHandle_t benchTask;
+static volatile uint32_t benchTasksDone;
+static volatile uint32_t benchTasksRunning;
+
+static void BenchTaskDone(void)
+{
+  taskENTER_CRITICAL();
+  if (++benchTasksDone == benchTasksRunning)
+  {
+    xTaskNotifyGive(benchTask);
+  }
+  taskEXIT_CRITICAL();
+
+  vTaskDelete(NULL);
+}
+
+static void BenchProducer(void *argument)
+{
+  uint32_t stamp;
+  uint32_t i;
+
+  (void)argument;
+
+  for (i = 0; i < MPMC_BENCH_MESSAGES; i++)
+  {
+    stamp = DWT->CYCCNT;
+
+    if (useMpmc != pdFALSE)
+    {
+      xMpmcQueueSend(mpmcQueue, &stamp, portMAX_DELAY);
+    }
+    else
+    {
+      xQueueSend(kernelQueue, &stamp, portMAX_DELAY);
+    }
+  }
+
+  BenchTaskDone();
+}
+
+static void BenchConsumer(void *argument)
+{
+  BenchConsumer_t *consumer = (BenchConsumer_t *)argument;
+  uint32_t stamp, latency, bucket;
+  uint32_t i;
+
+  /* With as many consumers as producers, each one takes an equal share. */
+  for (i = 0; i < MPMC_BENCH_MESSAGES; i++)
+  {
+    if (useMpmc != pdFALSE)
+    {
+      xMpmcQueueReceive(mpmcQueue, &stamp, portMAX_DELAY);
+    }
+    else
+    {
+      xQueueReceive(kernelQueue, &stamp, portMAX_DELAY);
+    }
+
+    latency = DWT->CYCCNT - stamp;
+
+    for (bucket = 0; (bucket < (MPMC_BENCH_BUCKETS - 1U)) && ((latency >> bucket) != 0U); bucket++)
+    {
+    }
+
+    consumer->histogram[bucket]++;
+    if (latency > consumer->worst)
+    {
+      consumer->worst = latency;
+    }
+  }
+
+  BenchTaskDone();
+}
+
+static uint32_t BenchCyclesToNs(uint32_t cycles)
+{
+  return (uint32_t)(((uint64_t)cycles * 1000000000U) / SystemCoreClock);
+}
+
+/* Returns the upper bound of the bucket that holds the given share, in
+   tenths of a percent, of all the latencies of the pass. */
+static uint32_t BenchPercentile(uint32_t tasks, uint32_t permille)
+{
+  uint32_t wanted = (uint32_t)(((uint64_t)tasks * MPMC_BENCH_MESSAGES * permille + 999U) / 1000U);
+  uint32_t seen = 0;
+  uint32_t bucket, i;
+
+  for (bucket = 0; bucket < MPMC_BENCH_BUCKETS; bucket++)
+  {
+    for (i = 0; i < tasks; i++)
+    {
+      seen += consumers[i].histogram[bucket];
+    }
+
+    if (seen >= wanted)
+    {
+      break;
+    }
+  }
+
+  return 1UL << bucket;
+}
+
+static void BenchRunPass(uint32_t tasks, BaseType_t mpmc)
+{
+  TickType_t ticks;
+  uint32_t total, us, worst, i, j;
+
+  useMpmc = mpmc;
+  benchTasksDone = 0;
+  benchTasksRunning = tasks * 2U;
+  xQueueReset(kernelQueue);
+
+  for (i = 0; i < tasks; i++)
+  {
+    for (j = 0; j < MPMC_BENCH_BUCKETS; j++)
+    {
+      consumers[i].histogram[j] = 0;
+    }
+    consumers[i].worst = 0;
+  }
+
+  /* The workers run below this task, so none of them starts before all
+     of them have been created. */
+  for (i = 0; i < tasks; i++)
+  {
+    xTaskCreate(BenchConsumer, "MqCons", configMINIMAL_STACK_SIZE, &consumers[i], tskIDLE_PRIORITY + 1U, NULL);
+    xTaskCreate(BenchProducer, "MqProd", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1U, NULL);
+  }
+
+  ticks = xTaskGetTickCount();
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  ticks = xTaskGetTickCount() - ticks;
+
+  /* Give the idle task a chance to free the deleted tasks. */
+  vTaskDelay(pdMS_TO_TICKS(50));
+
+  total = tasks * MPMC_BENCH_MESSAGES;
+  us = (uint32_t)(((uint64_t)ticks * 1000000U) / configTICK_RATE_HZ);
+  worst = 0;
+  for (i = 0; i < tasks; i++)
+  {
+    if (consumers[i].worst > worst)
+    {
+      worst = consumers[i].worst;
+    }
+  }
+
+  printf("%s x%lu", (mpmc != pdFALSE) ? "mpmc " : "queue", (unsigned long)tasks);
+
+  if (us == 0U)
+  {
+    printf("  run too short to time, raise MPMC_BENCH_MESSAGES\r\n");
+    return;
+  }
+
+  printf("  %7lu items/s  p50 <%6lu ns  p99 <%7lu ns  max %7lu ns\r\n",
+         (unsigned long)(((uint64_t)total * 1000000U) / us),
+         (unsigned long)BenchCyclesToNs(BenchPercentile(tasks, 500U)),
+         (unsigned long)BenchCyclesToNs(BenchPercentile(tasks, 990U)),
+         (unsigned long)BenchCyclesToNs(worst));
+}
+
+static void MpmcQueueBenchTask(void *argument)
+{
+  uint32_t tasks;
+
+  (void)argument;
+
+  benchTask = xTaskGetCurrentTaskHandle();
+  kernelQueue = xQueueCreateStatic(MPMC_BENCH_DEPTH, sizeof(uint32_t), kernelQueueStorage, &kernelQueueStruct);
+  mpmcQueue = xMpmcQueueCreateStatic(MPMC_BENCH_DEPTH, sizeof(uint32_t), mpmcQueueStorage, &mpmcQueueStruct);
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  printf("\r\nMPMC queue benchmark: %lu items per producer, queue depth %u\r\n",
+         (unsigned long)MPMC_BENCH_MESSAGES, (unsigned)MPMC_BENCH_DEPTH);
+
+  for (tasks = 1; tasks <= MPMC_BENCH_TASKS; tasks++)
+  {
+    BenchRunPass(tasks, pdFALSE);
+    BenchRunPass(tasks, pdTRUE);
+  }
+
+  vTaskDelete(NULL);
+}
+
+void MpmcQueueBench_Start(void)
+{
+  xTaskCreate(MpmcQueueBenchTask, "MqBench", configMINIMAL_STACK_SIZE * 2U, NULL,
+              tskIDLE_PRIORITY + 2U, NULL);
+}
+
+#elif (BENCH_SELECT == BENCH_MPMC_QUEUE)
+
+#error "The MPMC queue benchmark needs configUSE_MPMC_QUEUES and configSUPPORT_STATIC_ALLOCATION set to 1"
+
+#endif
@@ -0,0 +1,153 @@
+/**
+  ******************************************************************************
+  * @file           : object_lock_bench.c
+  * @brief          : Measures how queue throughput scales with the number of
+  *                   independent producer/consumer pairs.
+  ******************************************************************************
+  * Pass n runs n producer/consumer pairs at once, each pair passing
+  * OBJLOCK_BENCH_MESSAGES items through a queue of its own, and prints the
+  * total throughput.  The pairs share nothing, so with configUSE_OBJECT_LOCKS
+  * set on a multi-core port the throughput should grow with the number of
+  * pairs until the cores run out, where one kernel critical section holds it
+  * flat.  On this single-core part every pass shares the one CPU, so the
+  * figures show the cost of the locking layer rather than any scaling: run
+  * the benchmark with configUSE_OBJECT_LOCKS at 0 and at 1 to compare.
+  ******************************************************************************
+  */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "object_lock_bench.h"
+#include "bench.h"
+
+#include <stdio.h>
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+
+typedef struct
+{
+  StaticQueue_t queueStruct;
+  uint8_t queueStorage[OBJLOCK_BENCH_DEPTH * sizeof(uint32_t)];
+  QueueHandle_t queue;
+  TaskHandle_t consumer;
+} BenchPair_t;
+
+static BenchPair_t benchPairs[OBJLOCK_BENCH_PAIRS];
+static TaskHandle_t benchTask;
+static volatile uint32_t benchPairsDone;
+static volatile uint32_t benchPairsRunning;
+
+static void BenchProducer(void *argument)
+{
+  BenchPair_t *pair = (BenchPair_t *)argument;
+  uint32_t i;
+
+  for (i = 0; i < OBJLOCK_BENCH_MESSAGES; i++)
+  {
+    xQueueSend(pair->queue, &i, portMAX_DELAY);
+  }
+
+  vTaskDelete(NULL);
+}
+
+static void BenchConsumer(void *argument)
+{
+  BenchPair_t *pair = (BenchPair_t *)argument;
+  uint32_t item;
+  uint32_t i;
+
+  for (i = 0; i < OBJLOCK_BENCH_MESSAGES; i++)
+  {
+    xQueueReceive(pair->queue, &item, portMAX_DELAY);
+  }
+
+  taskENTER_CRITICAL();
+  if (++benchPairsDone == benchPairsRunning)
+  {
+    xTaskNotifyGive(benchTask);
+  }
+  taskEXIT_CRITICAL();
+
+  vTaskDelete(NULL);
+}
+
+static TickType_t BenchRunPass(uint32_t pairs)
+{
+  TickType_t start;
+  uint32_t i;
+
+  benchPairsDone = 0;
+  benchPairsRunning = pairs;
+
+  /* The workers run below this task, so none of them starts before all
+     of them have been created. */
+  for (i = 0; i < pairs; i++)
+  {
+    xQueueReset(benchPairs[i].queue);
+    xTaskCreate(BenchConsumer, "LkCons", configMINIMAL_STACK_SIZE, &benchPairs[i], tskIDLE_PRIORITY + 1U, NULL);
+    xTaskCreate(BenchProducer, "LkProd", configMINIMAL_STACK_SIZE, &benchPairs[i], tskIDLE_PRIORITY + 1U, NULL);
+  }
+
+  start = xTaskGetTickCount();
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+  return xTaskGetTickCount() - start;
+}
+
+static void ObjectLockBenchTask(void *argument)
+{
+  TickType_t ticks;
+  uint32_t pairs, total, us;
+
+  (void)argument;
+
+  benchTask = xTaskGetCurrentTaskHandle();
+  for (pairs = 0; pairs < OBJLOCK_BENCH_PAIRS; pairs++)
+  {
+    benchPairs[pairs].queue = xQueueCreateStatic(OBJLOCK_BENCH_DEPTH, sizeof(uint32_t),
+                                                 benchPairs[pairs].queueStorage,
+                                                 &benchPairs[pairs].queueStruct);
+  }
+
+  printf("\r\nObject lock benchmark: configUSE_OBJECT_LOCKS=%u, %lu items per pair, queue depth %u\r\n",
+         (unsigned)configUSE_OBJECT_LOCKS, (unsigned long)OBJLOCK_BENCH_MESSAGES,
+         (unsigned)OBJLOCK_BENCH_DEPTH);
+
+  for (pairs = 1; pairs <= OBJLOCK_BENCH_PAIRS; pairs++)
+  {
+    ticks = BenchRunPass(pairs);
+
+    /* Give the idle task a chance to free the deleted tasks. */
+    vTaskDelay(pdMS_TO_TICKS(50));
+
+    total = pairs * OBJLOCK_BENCH_MESSAGES;
+    us = (uint32_t)(((uint64_t)ticks * 1000000U) / configTICK_RATE_HZ);
+
+    printf("pairs=%lu", (unsigned long)pairs);
+
+    if (us == 0U)
+    {
+      printf("  run too short to time, raise OBJLOCK_BENCH_MESSAGES\r\n");
+      continue;
+    }
+
+    printf("  %lu ns/item  %lu items/s\r\n",
+           (unsigned long)(((uint64_t)us * 1000U) / total),
+           (unsigned long)(((uint64_t)total * 1000000U) / us));
+  }
+
+  vTaskDelete(NULL);
+}
+
+void ObjectLockBench_Start(void)
+{
+  xTaskCreate(ObjectLockBenchTask, "LkBench", configMINIMAL_STACK_SIZE * 2U, NULL,
+              tskIDLE_PRIORITY + 2U, NULL);
+}
+
+#elif (BENCH_SELECT == BENCH_OBJECT_LOCK)
+
+#error "The object lock benchmark needs configSUPPORT_STATIC_ALLOCATION set to 1"
+
+#endif
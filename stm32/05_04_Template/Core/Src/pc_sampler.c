@@ -0,0 +1,212 @@
+/**
+  ******************************************************************************
+  * @file           : pc_sampler.c
+  * @brief          : Statistical profiler that samples the program counter of
+  *                   the running task from a timer interrupt.
+  ******************************************************************************
+  * The interrupt handler is a short assembly stub: bit 2 of EXC_RETURN in LR
+  * tells whether the interrupted code was using the process stack (a task)
+  * or the main stack (another interrupt handler, or code from before the
+  * scheduler started).  The stub passes that stack pointer, which points at
+  * the stacked R0-R3, R12, LR, PC and xPSR, to PcSampler_Sample().
+  *
+  * Each capture is printed as lines that tools/pcprof reads:
+  *
+  *   pcs begin <rate Hz> <CPU Hz>
+  *   pcs task <task handle> <name>
+  *   pcs s <task handle> <pc> <lr>
+  *   pcs end <samples> <sampler cycles> <elapsed cycles>
+  *
+  * Numbers are hexadecimal except the rates.  Samples taken in an interrupt
+  * handler have task handle 0.  Other output may be mixed in; pcprof skips
+  * every line that does not start with "pcs ".
+  ******************************************************************************
+  */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pc_sampler.h"
+#include "stm32f4xx.h"
+#include "stm32f4xx_hal.h"
+
+#include <stdio.h>
+
+#if (configUSE_TRACE_FACILITY == 1) && (INCLUDE_xTaskGetCurrentTaskHandle == 1)
+
+/* Cycles for exception entry and return, which the sampler cannot time
+   itself: 12 to stack the frame and 10 to unstack it. */
+#define PC_SAMPLER_ENTRY_EXIT_CYCLES  22U
+
+/* Largest number of tasks whose names are looked up for a printout. */
+#define PC_SAMPLER_MAX_TASKS          16U
+
+typedef struct
+{
+  TaskHandle_t task;
+  uint32_t pc;
+  uint32_t lr;
+} PcSample_t;
+
+static PcSample_t samples[PC_SAMPLER_DEPTH];
+static volatile uint32_t sampleCount;
+static volatile uint32_t samplerCycles;
+static TaskStatus_t taskStatus[PC_SAMPLER_MAX_TASKS];
+
+void PcSampler_Sample(const uint32_t *frame, uint32_t excReturn);
+
+/* Not a C function: it must see LR and the stack pointers exactly as the
+   exception entry left them. */
+__attribute__((naked)) void PC_SAMPLER_IRQHandler(void)
+{
+  __asm volatile
+  (
+    "  tst lr, #4            \n"
+    "  ite eq                \n"
+    "  mrseq r0, msp         \n"
+    "  mrsne r0, psp         \n"
+    "  mov r1, lr            \n"
+    "  b PcSampler_Sample    \n"
+  );
+}
+
+void PcSampler_Sample(const uint32_t *frame, uint32_t excReturn)
+{
+  uint32_t start = DWT->CYCCNT;
+  uint32_t count = sampleCount;
+  PcSample_t *sample;
+
+  PC_SAMPLER_TIM->SR = ~(uint32_t)TIM_SR_UIF;
+
+  if (count < PC_SAMPLER_DEPTH)
+  {
+    sample = &samples[count];
+    sample->pc = frame[6];
+    sample->lr = frame[5];
+
+    /* Only a task runs on the process stack; reading the current task
+       handle is a single load, so is safe at any priority. */
+    sample->task = ((excReturn & 4U) != 0U) ? xTaskGetCurrentTaskHandle() : NULL;
+
+    if (++count == PC_SAMPLER_DEPTH)
+    {
+      PC_SAMPLER_TIM->CR1 &= ~TIM_CR1_CEN;
+    }
+    sampleCount = count;
+  }
+
+  samplerCycles += (DWT->CYCCNT - start) + PC_SAMPLER_ENTRY_EXIT_CYCLES;
+}
+
+static void PcSamplerTimerInit(void)
+{
+  uint32_t clock;
+
+  /* Timers run at twice the bus clock when the bus is divided. */
+#if (PC_SAMPLER_TIM_ON_APB2 == 1)
+  clock = HAL_RCC_GetPCLK2Freq();
+  if ((RCC->CFGR & RCC_CFGR_PPRE2_2) != 0U)
+  {
+    clock *= 2U;
+  }
+#else
+  clock = HAL_RCC_GetPCLK1Freq();
+  if ((RCC->CFGR & RCC_CFGR_PPRE1_2) != 0U)
+  {
+    clock *= 2U;
+  }
+#endif
+
+  PC_SAMPLER_TIM_CLK_ENABLE();
+
+  /* Count at 1 MHz, so any rate from 16 Hz to 100 kHz fits 16 bits. */
+  PC_SAMPLER_TIM->CR1 = 0;
+  PC_SAMPLER_TIM->PSC = (clock / 1000000U) - 1U;
+  PC_SAMPLER_TIM->ARR = (1000000U / PC_SAMPLER_HZ) - 1U;
+  PC_SAMPLER_TIM->EGR = TIM_EGR_UG;
+  PC_SAMPLER_TIM->SR = 0;
+  PC_SAMPLER_TIM->DIER = TIM_DIER_UIE;
+
+  NVIC_SetPriority(PC_SAMPLER_TIM_IRQn, PC_SAMPLER_IRQ_PRIORITY);
+  NVIC_EnableIRQ(PC_SAMPLER_TIM_IRQn);
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/* Prints the name of every task that is still alive.  A sampled task that
+   has been deleted since shows up in pcprof under its handle. */
+static void PcSamplerPrintTasks(void)
+{
+  UBaseType_t count, i;
+
+  count = uxTaskGetSystemState(taskStatus, PC_SAMPLER_MAX_TASKS, NULL);
+
+  for (i = 0; i < count; i++)
+  {
+    printf("pcs task %lx %s\r\n", (unsigned long)(uintptr_t)taskStatus[i].xHandle,
+           taskStatus[i].pcTaskName);
+  }
+}
+
+static void PcSamplerTask(void *argument)
+{
+  uint32_t start, elapsed, cycles, i;
+
+  (void)argument;
+
+  PcSamplerTimerInit();
+
+  for (;;)
+  {
+    sampleCount = 0;
+    samplerCycles = 0;
+    start = DWT->CYCCNT;
+    PC_SAMPLER_TIM->CNT = 0;
+    PC_SAMPLER_TIM->CR1 |= TIM_CR1_CEN;
+
+    while (sampleCount < PC_SAMPLER_DEPTH)
+    {
+      vTaskDelay(pdMS_TO_TICKS(100));
+    }
+
+    elapsed = DWT->CYCCNT - start;
+    cycles = samplerCycles;
+
+    printf("pcs begin %lu %lu\r\n", (unsigned long)PC_SAMPLER_HZ, (unsigned long)SystemCoreClock);
+    PcSamplerPrintTasks();
+
+    for (i = 0; i < PC_SAMPLER_DEPTH; i++)
+    {
+      printf("pcs s %lx %lx %lx\r\n", (unsigned long)(uintptr_t)samples[i].task,
+             (unsigned long)samples[i].pc, (unsigned long)samples[i].lr);
+    }
+
+    printf("pcs end %lx %lx %lx\r\n", (unsigned long)PC_SAMPLER_DEPTH,
+           (unsigned long)cycles, (unsigned long)elapsed);
+
+    /* The elapsed count wraps after 2^32 cycles, so it is only right for
+       captures shorter than about 40 s at 100 MHz. */
+    printf("PC sampler: %lu samples at %lu Hz, %lu cycles each, overhead %lu.%02lu%%\r\n",
+           (unsigned long)PC_SAMPLER_DEPTH, (unsigned long)PC_SAMPLER_HZ,
+           (unsigned long)(cycles / PC_SAMPLER_DEPTH),
+           (unsigned long)(((uint64_t)cycles * 100U) / elapsed),
+           (unsigned long)((((uint64_t)cycles * 10000U) / elapsed) % 100U));
+
+    vTaskDelay(pdMS_TO_TICKS(PC_SAMPLER_PAUSE_MS));
+  }
+}
+
+void PcSampler_Start(void)
+{
+  xTaskCreate(PcSamplerTask, "PcSampler", configMINIMAL_STACK_SIZE * 2U, NULL,
+              tskIDLE_PRIORITY + 1U, NULL);
+}
+
+#else
+
+void PcSampler_Start(void)
+{
+  printf("PC sampler needs configUSE_TRACE_FACILITY and INCLUDE_xTaskGetCurrentTaskHandle set to 1\r\n");
+}
+
+#endif
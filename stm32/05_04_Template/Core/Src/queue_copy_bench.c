@@ -0,0 +1,129 @@
+/**
+  ******************************************************************************
+  * @file           : queue_copy_bench.c
+  * @brief          : Measures the CPU cycles taken to send and receive one
+  *                   item through queues of 1, 2, 4 and 8-byte items.
+  ******************************************************************************
+  * For each item size the benchmark task sends an item to a queue and reads
+  * it straight back, QCOPY_BENCH_ITERATIONS times, with the DWT cycle counter
+  * running.  Nothing blocks and no other task is woken, so the figure is the
+  * cost of xQueueSend() plus xQueueReceive() including the item copies.
+  * A queue of 12-byte items, which is always copied with memcpy(), is timed
+  * as a reference.
+  ******************************************************************************
+  */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "queue_copy_bench.h"
+#include "bench.h"
+#include "stm32f4xx.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if (configSUPPORT_STATIC_ALLOCATION == 1)
+
+typedef struct
+{
+  uint32_t word[3];
+} Item12_t;
+
+static StaticQueue_t queueStruct;
+
+static uint8_t  storage8[QCOPY_BENCH_DEPTH];
+static uint16_t storage16[QCOPY_BENCH_DEPTH];
+static uint32_t storage32[QCOPY_BENCH_DEPTH];
+static uint64_t storage64[QCOPY_BENCH_DEPTH];
+static void    *storagePtr[QCOPY_BENCH_DEPTH];
+static Item12_t storage12[QCOPY_BENCH_DEPTH];
+
+static void BenchCycleCounterStart(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/* Returns the average cycles taken by one send/receive pair. */
+static uint32_t BenchRun(QueueHandle_t queue, void *item)
+{
+  uint32_t start, cycles;
+  uint32_t i;
+
+  start = DWT->CYCCNT;
+  for (i = 0; i < QCOPY_BENCH_ITERATIONS; i++)
+  {
+    xQueueSend(queue, item, 0);
+    xQueueReceive(queue, item, 0);
+  }
+  cycles = DWT->CYCCNT - start;
+
+  return cycles / QCOPY_BENCH_ITERATIONS;
+}
+
+static void BenchPrint(const char *name, size_t itemSize, uint32_t cycles)
+{
+  printf("%-9s %2u B  %4lu cycles/pair  %4lu ns/pair\r\n", name, (unsigned)itemSize,
+         (unsigned long)cycles,
+         (unsigned long)(((uint64_t)cycles * 1000000000U) / SystemCoreClock));
+}
+
+static void QueueCopyBenchTask(void *argument)
+{
+  QueueHandle_t queue;
+  uint8_t  item8 = 0x5AU;
+  uint16_t item16 = 0x5A5AU;
+  uint32_t item32 = 0x5A5A5A5AU;
+  uint64_t item64 = 0x5A5A5A5A5A5A5A5AULL;
+  void    *itemPtr = &item32;
+  Item12_t item12;
+
+  (void)argument;
+
+  memset(&item12, 0x5A, sizeof(item12));
+  BenchCycleCounterStart();
+
+  printf("\r\nQueue copy benchmark: %lu send/receive pairs per size, configQUEUE_SIZED_COPY=%d\r\n",
+         (unsigned long)QCOPY_BENCH_ITERATIONS, (int)configQUEUE_SIZED_COPY);
+
+  /* Each queue is deleted before the next one reuses queueStruct. */
+  queue = xQueueCreateStaticOfType(QCOPY_BENCH_DEPTH, uint8_t, storage8, &queueStruct);
+  BenchPrint("uint8_t", sizeof(item8), BenchRun(queue, &item8));
+  vQueueDelete(queue);
+
+  queue = xQueueCreateStaticOfType(QCOPY_BENCH_DEPTH, uint16_t, storage16, &queueStruct);
+  BenchPrint("uint16_t", sizeof(item16), BenchRun(queue, &item16));
+  vQueueDelete(queue);
+
+  queue = xQueueCreateStaticOfType(QCOPY_BENCH_DEPTH, uint32_t, storage32, &queueStruct);
+  BenchPrint("uint32_t", sizeof(item32), BenchRun(queue, &item32));
+  vQueueDelete(queue);
+
+  queue = xQueueCreateStaticOfType(QCOPY_BENCH_DEPTH, uint64_t, storage64, &queueStruct);
+  BenchPrint("uint64_t", sizeof(item64), BenchRun(queue, &item64));
+  vQueueDelete(queue);
+
+  queue = xQueueCreateStaticOfType(QCOPY_BENCH_DEPTH, void *, storagePtr, &queueStruct);
+  BenchPrint("pointer", sizeof(itemPtr), BenchRun(queue, &itemPtr));
+  vQueueDelete(queue);
+
+  queue = xQueueCreateStaticOfType(QCOPY_BENCH_DEPTH, Item12_t, storage12, &queueStruct);
+  BenchPrint("12 bytes", sizeof(item12), BenchRun(queue, &item12));
+  vQueueDelete(queue);
+
+  vTaskDelete(NULL);
+}
+
+void QueueCopyBench_Start(void)
+{
+  xTaskCreate(QueueCopyBenchTask, "QcBench", configMINIMAL_STACK_SIZE * 2U, NULL,
+              tskIDLE_PRIORITY + 2U, NULL);
+}
+
+#elif (BENCH_SELECT == BENCH_QUEUE_COPY)
+
+#error "The queue copy benchmark needs configSUPPORT_STATIC_ALLOCATION set to 1"
+
+#endif
@@ -101,7 +101,10 @@ void HardFault_Handler(void)
 void MemManage_Handler(void)
 {
   /* USER CODE BEGIN MemoryManagement_IRQn 0 */
-
+#if (configCHECK_FOR_STACK_OVERFLOW == 3)
+  /* A task has run into the MPU guard at the limit of its stack. */
+  vPortStackGuardFaultHandler();
+#endif
   /* USER CODE END MemoryManagement_IRQn 0 */
   while (1)
   {
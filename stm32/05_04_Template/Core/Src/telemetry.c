@@ -0,0 +1,505 @@
+/**
+  ******************************************************************************
+  * @file           : telemetry.c
+  * @brief          : Live stream of task, queue and heap statistics in compact
+  *                   binary frames, sent over UART by DMA.
+  ******************************************************************************
+  * The frame is built in RAM, then COBS encoded straight into a ring buffer.
+  * The DMA stream sends the ring buffer out one contiguous piece at a time;
+  * its transfer complete interrupt frees the piece and starts the next one.
+  * The telemetry task only touches the DMA registers when the stream is
+  * idle, inside a critical section.
+  *
+  * Only key frames measure the stack high water marks: that scans the unused
+  * part of every task's stack with the scheduler suspended, and costs more
+  * than the rest of the frame.  Delta frames take the snapshot without it,
+  * and a task that first shows up in a delta frame gets its watermark in the
+  * key frame that follows.
+  *
+  * The cost of a frame is measured with the DWT cycle counter, from the
+  * snapshot to the hand-over to DMA, and reported in the next frame.  The
+  * DMA interrupt, one per piece, is not included.
+  ******************************************************************************
+  */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "telemetry.h"
+#include "stm32f4xx.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if (configUSE_TRACE_FACILITY == 1) && (configGENERATE_RUN_TIME_STATS == 1)
+
+#define TELEMETRY_FRAME_KEY       1U
+#define TELEMETRY_FRAME_DELTA     2U
+
+#define TELEMETRY_HAS_VALUE       0x01U
+#define TELEMETRY_HAS_STATE       0x02U
+#define TELEMETRY_HAS_NAME        0x04U
+
+/* Longer names are cut short. */
+#define TELEMETRY_NAME_MAX        16U
+
+/* Worst case encoded sizes, with 5 bytes for each varint. */
+#define TELEMETRY_TASK_BYTES      (5U + 1U + 5U + 5U + 2U + 1U + TELEMETRY_NAME_MAX)
+#define TELEMETRY_QUEUE_BYTES     (5U + 1U + 5U + 1U + TELEMETRY_NAME_MAX + 5U)
+#define TELEMETRY_FRAME_MAX       (2U + (12U * 5U) + (TELEMETRY_MAX_TASKS * TELEMETRY_TASK_BYTES) + \
+                                   (TELEMETRY_MAX_QUEUES * TELEMETRY_QUEUE_BYTES) + 2U)
+
+#if (TELEMETRY_TX_BUFFER & (TELEMETRY_TX_BUFFER - 1)) != 0
+#error TELEMETRY_TX_BUFFER must be a power of two
+#endif
+
+typedef struct
+{
+  UBaseType_t number;
+  uint32_t runTime;
+  uint32_t stack;
+  uint8_t state;
+  uint8_t priority;
+} TelemetryTask_t;
+
+typedef struct
+{
+  QueueHandle_t queue;
+  const char *name;
+  UBaseType_t waiting;
+} TelemetryQueue_t;
+
+static TaskStatus_t taskStatus[TELEMETRY_MAX_TASKS];
+static TelemetryTask_t tasks[2][TELEMETRY_MAX_TASKS];
+static uint32_t taskCount;
+static uint32_t tasksLeftOut;
+static uint32_t lastTasksLeftOut;
+static uint32_t lastTasks;
+static TelemetryQueue_t queues[TELEMETRY_MAX_QUEUES];
+static volatile uint32_t queueCount;
+
+static uint8_t frame[TELEMETRY_FRAME_MAX];
+static uint8_t txBuffer[TELEMETRY_TX_BUFFER];
+static uint32_t txHead;
+static volatile uint32_t txTail;
+static volatile uint32_t txInFlight;
+
+static uint8_t *PutVarint(uint8_t *p, uint32_t value)
+{
+  while (value >= 0x80U)
+  {
+    *p++ = (uint8_t)(value | 0x80U);
+    value >>= 7;
+  }
+  *p++ = (uint8_t)value;
+
+  return p;
+}
+
+static uint8_t *PutName(uint8_t *p, const char *name)
+{
+  size_t length = strlen(name);
+
+  if (length > TELEMETRY_NAME_MAX)
+  {
+    length = TELEMETRY_NAME_MAX;
+  }
+
+  *p++ = (uint8_t)length;
+  memcpy(p, name, length);
+
+  return p + length;
+}
+
+static uint16_t Crc16(const uint8_t *data, uint32_t length)
+{
+  uint16_t crc = 0xFFFFU;
+  uint32_t i, bit;
+
+  for (i = 0; i < length; i++)
+  {
+    crc ^= (uint16_t)((uint16_t)data[i] << 8);
+    for (bit = 0; bit < 8U; bit++)
+    {
+      crc = ((crc & 0x8000U) != 0U) ? (uint16_t)((crc << 1) ^ 0x1021U) : (uint16_t)(crc << 1);
+    }
+  }
+
+  return crc;
+}
+
+/* Sends the next contiguous piece of the ring buffer, if there is one.
+   Called with the DMA interrupt masked, or from it. */
+static void TxStartNext(void)
+{
+  uint32_t used = txHead - txTail;
+  uint32_t start = txTail & (TELEMETRY_TX_BUFFER - 1U);
+
+  if (used == 0U)
+  {
+    txInFlight = 0;
+    return;
+  }
+
+  if (used > (TELEMETRY_TX_BUFFER - start))
+  {
+    used = TELEMETRY_TX_BUFFER - start;
+  }
+
+  txInFlight = used;
+  TELEMETRY_DMA->TELEMETRY_DMA_IFCR = TELEMETRY_DMA_FLAGS;
+  TELEMETRY_DMA_STREAM->M0AR = (uint32_t)&txBuffer[start];
+  TELEMETRY_DMA_STREAM->NDTR = used;
+  TELEMETRY_DMA_STREAM->CR |= DMA_SxCR_EN;
+}
+
+void TELEMETRY_DMA_IRQHandler(void)
+{
+  TELEMETRY_DMA->TELEMETRY_DMA_IFCR = TELEMETRY_DMA_FLAGS;
+
+  txTail += txInFlight;
+  TxStartNext();
+}
+
+/* COBS encodes a frame into the ring buffer, followed by the zero byte that
+   ends it, and starts the DMA if it is idle.  Returns 0 if there was not
+   room for the whole frame. */
+static int TxSendFrame(const uint8_t *data, uint32_t length)
+{
+  const uint32_t mask = TELEMETRY_TX_BUFFER - 1U;
+  uint32_t pos = txHead;
+  uint32_t codePos, i;
+  uint8_t code = 1;
+
+  /* One code byte per 254 data bytes, one to start and the delimiter. */
+  if ((length + (length / 254U) + 2U) > (TELEMETRY_TX_BUFFER - (txHead - txTail)))
+  {
+    return 0;
+  }
+
+  codePos = pos++;
+  for (i = 0; i < length; i++)
+  {
+    if (data[i] == 0U)
+    {
+      txBuffer[codePos & mask] = code;
+      codePos = pos++;
+      code = 1;
+    }
+    else
+    {
+      txBuffer[pos++ & mask] = data[i];
+      if (++code == 0xFFU)
+      {
+        txBuffer[codePos & mask] = code;
+        codePos = pos++;
+        code = 1;
+      }
+    }
+  }
+  txBuffer[codePos & mask] = code;
+  txBuffer[pos++ & mask] = 0;
+
+  taskENTER_CRITICAL();
+  txHead = pos;
+  if (txInFlight == 0U)
+  {
+    TxStartNext();
+  }
+  taskEXIT_CRITICAL();
+
+  return 1;
+}
+
+static void TxInit(void)
+{
+  TELEMETRY_DMA_CLK_ENABLE();
+
+  TELEMETRY_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+  while ((TELEMETRY_DMA_STREAM->CR & DMA_SxCR_EN) != 0U)
+  {
+  }
+
+  /* Memory to peripheral, bytes, one request per byte the UART takes. */
+  TELEMETRY_DMA_STREAM->PAR = (uint32_t)&TELEMETRY_USART->DR;
+  TELEMETRY_DMA_STREAM->CR = (TELEMETRY_DMA_CHANNEL << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_DIR_0 |
+                             DMA_SxCR_MINC | DMA_SxCR_TCIE;
+  TELEMETRY_DMA_STREAM->FCR = 0;
+  TELEMETRY_DMA->TELEMETRY_DMA_IFCR = TELEMETRY_DMA_FLAGS;
+
+  TELEMETRY_USART->CR3 |= USART_CR3_DMAT;
+
+  NVIC_SetPriority(TELEMETRY_DMA_IRQn, TELEMETRY_IRQ_PRIORITY);
+  NVIC_EnableIRQ(TELEMETRY_DMA_IRQn);
+}
+
+static const TelemetryTask_t *FindTask(const TelemetryTask_t *list, uint32_t count, UBaseType_t number)
+{
+  uint32_t i;
+
+  for (i = 0; i < count; i++)
+  {
+    if (list[i].number == number)
+    {
+      return &list[i];
+    }
+  }
+
+  return NULL;
+}
+
+/* Builds one frame and returns its length.  Sets *needKey if a task is new
+   and its stack high water mark has still to be sent. */
+static uint32_t BuildFrame(uint8_t sequence, int key, uint32_t period, uint32_t cost, uint32_t dropped,
+                           int *needKey)
+{
+  const TelemetryTask_t *last = tasks[lastTasks];
+  TelemetryTask_t *now = tasks[lastTasks ^ 1U];
+  const TelemetryTask_t *old;
+  uint8_t *p = frame;
+  uint8_t flags;
+  uint32_t count = queueCount;
+  uint32_t i, runTime;
+  UBaseType_t waiting;
+  uint16_t crc;
+
+  *p++ = (key != 0) ? TELEMETRY_FRAME_KEY : TELEMETRY_FRAME_DELTA;
+  *p++ = sequence;
+  p = PutVarint(p, xTaskGetTickCount());
+  p = PutVarint(p, period);
+  p = PutVarint(p, cost);
+
+  if (key != 0)
+  {
+    p = PutVarint(p, SystemCoreClock);
+    p = PutVarint(p, 1000U / TELEMETRY_HZ);
+    p = PutVarint(p, configTOTAL_HEAP_SIZE);
+  }
+
+  p = PutVarint(p, xPortGetFreeHeapSize());
+  p = PutVarint(p, xPortGetMinimumEverFreeHeapSize());
+  p = PutVarint(p, dropped);
+  p = PutVarint(p, tasksLeftOut);
+
+  p = PutVarint(p, taskCount);
+  for (i = 0; i < taskCount; i++)
+  {
+    now[i].number = taskStatus[i].xTaskNumber;
+    now[i].runTime = taskStatus[i].ulRunTimeCounter;
+    now[i].state = (uint8_t)taskStatus[i].eCurrentState;
+    now[i].priority = (uint8_t)taskStatus[i].uxCurrentPriority;
+
+    old = FindTask(last, TELEMETRY_MAX_TASKS, now[i].number);
+
+    /* Only key frames measure the stack. */
+    if (key != 0)
+    {
+      now[i].stack = taskStatus[i].usStackHighWaterMark;
+    }
+    else
+    {
+      now[i].stack = (old != NULL) ? old->stack : 0U;
+    }
+
+    /* The whole counter of a task that was not in the last frame is its run
+       time since it was created, which fits in the period, unless the task
+       list was cut short: then it may have been left out of the last frame,
+       and its run time for the period is not known. */
+    if (old != NULL)
+    {
+      runTime = now[i].runTime - old->runTime;
+    }
+    else if ((tasksLeftOut != 0U) || (lastTasksLeftOut != 0U))
+    {
+      runTime = 0;
+    }
+    else
+    {
+      runTime = now[i].runTime;
+    }
+
+    if (key != 0)
+    {
+      flags = TELEMETRY_HAS_VALUE | TELEMETRY_HAS_STATE | TELEMETRY_HAS_NAME;
+    }
+    else if (old == NULL)
+    {
+      flags = TELEMETRY_HAS_STATE | TELEMETRY_HAS_NAME;
+      *needKey = 1;
+    }
+    else
+    {
+      flags = ((now[i].state != old->state) || (now[i].priority != old->priority)) ? TELEMETRY_HAS_STATE : 0U;
+    }
+
+    p = PutVarint(p, now[i].number);
+    *p++ = flags;
+    p = PutVarint(p, runTime);
+    if ((flags & TELEMETRY_HAS_VALUE) != 0U)
+    {
+      p = PutVarint(p, now[i].stack);
+    }
+    if ((flags & TELEMETRY_HAS_STATE) != 0U)
+    {
+      *p++ = now[i].state;
+      *p++ = now[i].priority;
+    }
+    if ((flags & TELEMETRY_HAS_NAME) != 0U)
+    {
+      p = PutName(p, taskStatus[i].pcTaskName);
+    }
+  }
+
+  /* Slots past the end must not match a task number in the next frame. */
+  for (; i < TELEMETRY_MAX_TASKS; i++)
+  {
+    now[i].number = (UBaseType_t)-1;
+  }
+  lastTasks ^= 1U;
+
+  p = PutVarint(p, count);
+  for (i = 0; i < count; i++)
+  {
+    waiting = uxQueueMessagesWaiting(queues[i].queue);
+    flags = ((key != 0) || (waiting != queues[i].waiting)) ? TELEMETRY_HAS_VALUE : 0U;
+    if (key != 0)
+    {
+      flags |= TELEMETRY_HAS_NAME;
+    }
+    queues[i].waiting = waiting;
+
+    p = PutVarint(p, i);
+    *p++ = flags;
+    if ((flags & TELEMETRY_HAS_VALUE) != 0U)
+    {
+      p = PutVarint(p, waiting);
+    }
+    if ((flags & TELEMETRY_HAS_NAME) != 0U)
+    {
+      p = PutName(p, queues[i].name);
+      p = PutVarint(p, waiting + uxQueueSpacesAvailable(queues[i].queue));
+    }
+  }
+
+  crc = Crc16(frame, (uint32_t)(p - frame));
+  *p++ = (uint8_t)crc;
+  *p++ = (uint8_t)(crc >> 8);
+
+  return (uint32_t)(p - frame);
+}
+
+static void TelemetryTask(void *argument)
+{
+  const TickType_t period = pdMS_TO_TICKS(1000U / TELEMETRY_HZ);
+  TickType_t next = xTaskGetTickCount();
+  TickType_t now;
+  uint32_t totalRunTime, lastTotalRunTime = 0;
+  uint32_t start, cost = 0, dropped = 0, length;
+  UBaseType_t total;
+  uint8_t sequence = 0;
+  int key = 1, needKey;
+
+  (void)argument;
+
+  for (;;)
+  {
+    start = DWT->CYCCNT;
+
+    if ((sequence % TELEMETRY_KEY_EVERY) == 0U)
+    {
+      key = 1;
+    }
+
+    /* With more than TELEMETRY_MAX_TASKS tasks the rest are left out and
+       counted, so the viewer can say so. */
+    taskCount = uxTaskGetPartialSystemState(taskStatus, TELEMETRY_MAX_TASKS, &totalRunTime,
+                                            (key != 0) ? pdTRUE : pdFALSE);
+    total = uxTaskGetNumberOfTasks();
+    lastTasksLeftOut = tasksLeftOut;
+    tasksLeftOut = (total > taskCount) ? (uint32_t)(total - taskCount) : 0U;
+
+    needKey = 0;
+    length = BuildFrame(sequence, key, totalRunTime - lastTotalRunTime, cost, dropped, &needKey);
+    lastTotalRunTime = totalRunTime;
+    sequence++;
+
+    if (TxSendFrame(frame, length) != 0)
+    {
+      key = needKey;
+    }
+    else
+    {
+      /* The viewer missed whatever changed in this frame. */
+      dropped++;
+      key = 1;
+    }
+
+    cost = DWT->CYCCNT - start;
+
+    /* vTaskDelayUntil() is not included in this configuration. */
+    next += period;
+    now = xTaskGetTickCount();
+    if ((TickType_t)(next - now) <= period)
+    {
+      vTaskDelay(next - now);
+    }
+    else
+    {
+      next = now;
+    }
+  }
+}
+
+int Telemetry_AddQueue(QueueHandle_t queue, const char *name)
+{
+  int added = 0;
+
+  taskENTER_CRITICAL();
+  if (queueCount < TELEMETRY_MAX_QUEUES)
+  {
+    queues[queueCount].queue = queue;
+    queues[queueCount].name = name;
+    queues[queueCount].waiting = 0;
+    queueCount++;
+    added = 1;
+  }
+  taskEXIT_CRITICAL();
+
+  return added;
+}
+
+void Telemetry_Start(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < TELEMETRY_MAX_TASKS; i++)
+  {
+    tasks[0][i].number = (UBaseType_t)-1;
+    tasks[1][i].number = (UBaseType_t)-1;
+  }
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  TxInit();
+
+  xTaskCreate(TelemetryTask, "Telemetry", configMINIMAL_STACK_SIZE * 2U, NULL,
+              TELEMETRY_TASK_PRIORITY, NULL);
+}
+
+#else
+
+int Telemetry_AddQueue(QueueHandle_t queue, const char *name)
+{
+  (void)queue;
+  (void)name;
+
+  return 0;
+}
+
+void Telemetry_Start(void)
+{
+  printf("Telemetry needs configUSE_TRACE_FACILITY and configGENERATE_RUN_TIME_STATS set to 1\r\n");
+}
+
+#endif
@@ -0,0 +1,158 @@
+/**
+  ******************************************************************************
+  * @file           : timer_slack_bench.c
+  * @brief          : Synthetic 200-timer workload that compares timer service
+  *                   wake-ups with and without timer slack.
+  ******************************************************************************
+  * The same set of auto-reload timers is run twice: first with no slack, then
+  * with every timer allowed to expire up to a quarter of its period late.
+  * For each pass the benchmark prints:
+  *   - timer service task wake-ups per second,
+  *   - the mean number of ticks between wake-ups (the longest stretch a
+  *     tickless idle could sleep for),
+  *   - idle residency, when run-time stats are enabled.
+  ******************************************************************************
+  */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "timer_slack_bench.h"
+#include "bench.h"
+
+#include <stdio.h>
+
+#if (configUSE_TIMERS == 1) && (configUSE_TIMER_SLACK == 1) && (configGENERATE_TIMER_COMMAND_STATS == 1)
+
+typedef struct
+{
+  uint32_t wakeUps;
+  uint32_t callbacks;
+  TickType_t ticks;
+  uint32_t idlePercent;   /* 0xFFFFFFFF when run-time stats are off */
+} BenchResult_t;
+
+static StaticTimer_t benchTimerBuffers[TIMER_SLACK_BENCH_TIMERS];
+static TimerHandle_t benchTimers[TIMER_SLACK_BENCH_TIMERS];
+static volatile uint32_t benchCallbacks;
+
+/* Periods between 20 and 100 ticks, spread so expiries rarely line up by
+   themselves. */
+static TickType_t BenchPeriod(uint32_t index)
+{
+  return (TickType_t)(20U + ((index * 37U) % 81U));
+}
+
+static void BenchTimerCallback(TimerHandle_t xTimer)
+{
+  (void)xTimer;
+  benchCallbacks++;
+}
+
+static void BenchRunPass(TickType_t slackDiv, BenchResult_t *result)
+{
+  TimerCommandStats_t stats;
+  TickType_t start;
+  uint32_t i;
+#if (configGENERATE_RUN_TIME_STATS == 1) && defined(portGET_RUN_TIME_COUNTER_VALUE)
+  uint32_t idleStart, totalStart, total;
+#endif
+
+  for (i = 0; i < TIMER_SLACK_BENCH_TIMERS; i++)
+  {
+    vTimerSetSlack(benchTimers[i], (slackDiv == 0U) ? 0U : (BenchPeriod(i) / slackDiv));
+    xTimerStart(benchTimers[i], portMAX_DELAY);
+  }
+
+  /* Let the start commands drain before measuring. */
+  vTaskDelay(pdMS_TO_TICKS(200));
+
+  vTimerClearCommandStats();
+  benchCallbacks = 0;
+  start = xTaskGetTickCount();
+#if (configGENERATE_RUN_TIME_STATS == 1) && defined(portGET_RUN_TIME_COUNTER_VALUE)
+  idleStart = ulTaskGetIdleRunTimeCounter();
+  totalStart = portGET_RUN_TIME_COUNTER_VALUE();
+#endif
+
+  vTaskDelay(pdMS_TO_TICKS(TIMER_SLACK_BENCH_RUN_MS));
+
+  vTimerGetCommandStats(&stats);
+  result->wakeUps = stats.uxServiceTaskWakeUps;
+  result->callbacks = benchCallbacks;
+  result->ticks = xTaskGetTickCount() - start;
+  result->idlePercent = 0xFFFFFFFFU;
+#if (configGENERATE_RUN_TIME_STATS == 1) && defined(portGET_RUN_TIME_COUNTER_VALUE)
+  total = portGET_RUN_TIME_COUNTER_VALUE() - totalStart;
+  if (total != 0U)
+  {
+    result->idlePercent = (uint32_t)(((uint64_t)(ulTaskGetIdleRunTimeCounter() - idleStart) * 100U) / total);
+  }
+#endif
+
+  for (i = 0; i < TIMER_SLACK_BENCH_TIMERS; i++)
+  {
+    xTimerStop(benchTimers[i], portMAX_DELAY);
+  }
+  vTaskDelay(pdMS_TO_TICKS(100));
+}
+
+static void BenchPrint(const char *name, const BenchResult_t *result)
+{
+  uint32_t seconds100 = (uint32_t)((result->ticks * 100U) / configTICK_RATE_HZ);
+
+  if (seconds100 == 0U || result->wakeUps == 0U)
+  {
+    printf("%-9s no data\r\n", name);
+    return;
+  }
+
+  printf("%-9s wake-ups/s=%lu  ticks/wake-up=%lu  callbacks=%lu",
+         name,
+         (unsigned long)((result->wakeUps * 100U) / seconds100),
+         (unsigned long)(result->ticks / result->wakeUps),
+         (unsigned long)result->callbacks);
+
+  if (result->idlePercent != 0xFFFFFFFFU)
+  {
+    printf("  idle=%lu%%", (unsigned long)result->idlePercent);
+  }
+  printf("\r\n");
+}
+
+static void TimerSlackBenchTask(void *argument)
+{
+  BenchResult_t noSlack, withSlack;
+  uint32_t i;
+
+  (void)argument;
+
+  for (i = 0; i < TIMER_SLACK_BENCH_TIMERS; i++)
+  {
+    benchTimers[i] = xTimerCreateStatic("bench", BenchPeriod(i), pdTRUE, NULL,
+                                        BenchTimerCallback, &benchTimerBuffers[i]);
+  }
+
+  BenchRunPass(0U, &noSlack);
+  BenchRunPass(TIMER_SLACK_BENCH_SLACK_DIV, &withSlack);
+
+  printf("\r\nTimer slack benchmark: %u timers, %u ms per pass\r\n",
+         (unsigned)TIMER_SLACK_BENCH_TIMERS, (unsigned)TIMER_SLACK_BENCH_RUN_MS);
+  BenchPrint("no slack", &noSlack);
+  BenchPrint("slack", &withSlack);
+
+  vTaskDelete(NULL);
+}
+
+void TimerSlackBench_Start(void)
+{
+  /* Below the timer service task so starting 200 timers does not race it. */
+  xTaskCreate(TimerSlackBenchTask, "SlackBench", configMINIMAL_STACK_SIZE * 2U, NULL,
+              tskIDLE_PRIORITY + 1U, NULL);
+}
+
+#elif (BENCH_SELECT == BENCH_TIMER_SLACK)
+
+#error "The timer slack benchmark needs configUSE_TIMERS, configUSE_TIMER_SLACK and configGENERATE_TIMER_COMMAND_STATS set to 1"
+
+#endif
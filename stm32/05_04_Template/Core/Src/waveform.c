@@ -0,0 +1,350 @@
+/**
+  ******************************************************************************
+  * @file           : waveform.c
+  * @brief          : Sends bit-banged protocols by DMA from a BSRR word buffer
+  *                   paced by a timer, without the CPU toggling pins.
+  ******************************************************************************
+  * The two halves of the buffer each hold either words of the stream or,
+  * once the stream has run out, inactive levels.  When the DMA finishes a
+  * half, the interrupt refills it with the next words; if the other half,
+  * which the DMA has just moved on to, holds no stream words, everything has
+  * been sent and the interrupt stops the timer instead.  A short stream thus
+  * takes one interrupt, and a long one an interrupt per half buffer.
+  *
+  * The stream's end is reported with a task notification to the task that
+  * started it, so that task must not use its notification value for
+  * anything else while a stream is being sent.
+  ******************************************************************************
+  */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "waveform.h"
+#include "stm32f4xx_hal.h"
+
+#include <stdio.h>
+
+#if defined(HAL_TIM_MODULE_ENABLED) && defined(HAL_DMA_MODULE_ENABLED)
+
+/* Shortest slot in timer ticks: each transfer takes the DMA a few bus
+   cycles, and the stream's requests must not queue up. */
+#define WAVEFORM_MIN_TICKS        16U
+
+#define WAVEFORM_DEMO_PERIOD_MS   20U
+#define WAVEFORM_DEMO_REPORT_MS   2000U
+
+static TIM_HandleTypeDef waveformTim;
+static DMA_HandleTypeDef waveformDma;
+static GPIO_TypeDef *waveformPort;
+static uint16_t waveformPins;
+static const WaveformProtocol_t *waveformProtocol;
+static uint32_t waveformSlotNs;
+static uint32_t halfWords;
+
+static uint32_t buffers[2][WAVEFORM_BUFFER_WORDS];
+static uint8_t holdsStream[2];
+static WaveformStream_t stream;
+static volatile uint8_t busy;
+static TaskHandle_t waitingTask;
+static BaseType_t higherPriorityTaskWoken;
+
+/* DWT cycles spent in the DMA interrupt, for the demo. */
+static volatile uint32_t interruptCycles;
+
+static uint32_t InactiveWord(void)
+{
+  return (waveformProtocol->activeLow != 0U) ? waveformPins : ((uint32_t)waveformPins << 16);
+}
+
+static void WaveformStop(void)
+{
+  HAL_TIM_Base_Stop(&waveformTim);
+  __HAL_TIM_DISABLE_DMA(&waveformTim, TIM_DMA_UPDATE);
+
+  /* The stream stops at once; the HAL finishes the abort in the next
+     interrupt. */
+  HAL_DMA_Abort_IT(&waveformDma);
+
+  busy = 0;
+  vTaskNotifyGiveFromISR(waitingTask, &higherPriorityTaskWoken);
+}
+
+static void WaveformHalfDone(uint32_t half)
+{
+  uint32_t start = DWT->CYCCNT;
+
+  holdsStream[half] = 0;
+
+  if (holdsStream[half ^ 1U] == 0U)
+  {
+    WaveformStop();
+  }
+  else
+  {
+    holdsStream[half] = (Waveform_Fill(&stream, buffers[half], halfWords) != 0U) ? 1U : 0U;
+  }
+
+  interruptCycles += DWT->CYCCNT - start;
+}
+
+static void WaveformM0Done(DMA_HandleTypeDef *hdma)
+{
+  (void)hdma;
+  WaveformHalfDone(0);
+}
+
+static void WaveformM1Done(DMA_HandleTypeDef *hdma)
+{
+  (void)hdma;
+  WaveformHalfDone(1);
+}
+
+static void WaveformError(DMA_HandleTypeDef *hdma)
+{
+  (void)hdma;
+
+  if (busy != 0U)
+  {
+    WaveformStop();
+  }
+}
+
+void DMA2_Stream5_IRQHandler(void)
+{
+  higherPriorityTaskWoken = pdFALSE;
+  HAL_DMA_IRQHandler(&waveformDma);
+  portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+int Waveform_Init(GPIO_TypeDef *port, uint16_t pins, const WaveformProtocol_t *protocol)
+{
+  GPIO_InitTypeDef gpio = {0};
+  uint32_t clock, ticks;
+
+  /* Timers run at twice the bus clock when the bus is divided. */
+  clock = HAL_RCC_GetPCLK2Freq();
+  if ((RCC->CFGR & RCC_CFGR_PPRE2_2) != 0U)
+  {
+    clock *= 2U;
+  }
+
+  ticks = (uint32_t)((((uint64_t)clock * protocol->slotNs) + 500000000U) / 1000000000U);
+  if ((ticks < WAVEFORM_MIN_TICKS) || (ticks > 65536U) || (protocol->slotsPerBit == 0U))
+  {
+    return 0;
+  }
+
+  waveformPort = port;
+  waveformPins = pins;
+  waveformProtocol = protocol;
+  waveformSlotNs = (uint32_t)(((uint64_t)ticks * 1000000000U) / clock);
+  halfWords = (WAVEFORM_BUFFER_WORDS / protocol->slotsPerBit) * protocol->slotsPerBit;
+
+  /* The port's clock is enabled by MX_GPIO_Init(). */
+  port->BSRR = InactiveWord();
+  gpio.Pin = pins;
+  gpio.Mode = GPIO_MODE_OUTPUT_PP;
+  gpio.Pull = GPIO_NOPULL;
+  gpio.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+  HAL_GPIO_Init(port, &gpio);
+
+  __HAL_RCC_TIM1_CLK_ENABLE();
+  __HAL_RCC_DMA2_CLK_ENABLE();
+
+  waveformTim.Instance = TIM1;
+  waveformTim.Init.Prescaler = 0;
+  waveformTim.Init.CounterMode = TIM_COUNTERMODE_UP;
+  waveformTim.Init.Period = ticks - 1U;
+  waveformTim.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  waveformTim.Init.RepetitionCounter = 0;
+  waveformTim.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+  if (HAL_TIM_Base_Init(&waveformTim) != HAL_OK)
+  {
+    return 0;
+  }
+
+  waveformDma.Instance = DMA2_Stream5;
+  waveformDma.Init.Channel = DMA_CHANNEL_6;
+  waveformDma.Init.Direction = DMA_MEMORY_TO_PERIPH;
+  waveformDma.Init.PeriphInc = DMA_PINC_DISABLE;
+  waveformDma.Init.MemInc = DMA_MINC_ENABLE;
+  waveformDma.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+  waveformDma.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+  waveformDma.Init.Mode = DMA_CIRCULAR;
+  waveformDma.Init.Priority = DMA_PRIORITY_VERY_HIGH;
+  waveformDma.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+  if (HAL_DMA_Init(&waveformDma) != HAL_OK)
+  {
+    return 0;
+  }
+
+  /* The double buffer mode needs all three. */
+  waveformDma.XferCpltCallback = WaveformM0Done;
+  waveformDma.XferM1CpltCallback = WaveformM1Done;
+  waveformDma.XferErrorCallback = WaveformError;
+
+  HAL_NVIC_SetPriority(DMA2_Stream5_IRQn, WAVEFORM_IRQ_PRIORITY, 0);
+  HAL_NVIC_EnableIRQ(DMA2_Stream5_IRQn);
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  return 1;
+}
+
+uint32_t Waveform_GetSlotNs(void)
+{
+  return waveformSlotNs;
+}
+
+int Waveform_Start(uint8_t lanes, const uint16_t *lanePins, const uint8_t *const *laneData,
+                   uint32_t bytes)
+{
+  if ((busy != 0U) || (waveformProtocol == NULL))
+  {
+    return 0;
+  }
+
+  Waveform_StreamInit(&stream, waveformProtocol, lanes, lanePins, laneData, bytes);
+  holdsStream[0] = (Waveform_Fill(&stream, buffers[0], halfWords) != 0U) ? 1U : 0U;
+  holdsStream[1] = (Waveform_Fill(&stream, buffers[1], halfWords) != 0U) ? 1U : 0U;
+
+  waitingTask = xTaskGetCurrentTaskHandle();
+
+  if (holdsStream[0] == 0U)
+  {
+    /* Nothing to send. */
+    xTaskNotifyGive(waitingTask);
+    return 1;
+  }
+
+  busy = 1;
+  if (HAL_DMAEx_MultiBufferStart_IT(&waveformDma, (uint32_t)buffers[0], (uint32_t)&waveformPort->BSRR,
+                                    (uint32_t)buffers[1], halfWords) != HAL_OK)
+  {
+    busy = 0;
+    return 0;
+  }
+
+  __HAL_TIM_SET_COUNTER(&waveformTim, 0);
+  __HAL_TIM_ENABLE_DMA(&waveformTim, TIM_DMA_UPDATE);
+  HAL_TIM_Base_Start(&waveformTim);
+
+  return 1;
+}
+
+int Waveform_Wait(TickType_t timeout)
+{
+  return (ulTaskNotifyTake(pdTRUE, timeout) != 0U) ? 1 : 0;
+}
+
+/* Colour wheel position 0..255 to GRB. */
+static void WaveformDemoWheel(uint8_t position, uint8_t *grb)
+{
+  uint8_t r, g, b;
+
+  if (position < 85U)
+  {
+    r = (uint8_t)(255U - (position * 3U));
+    g = (uint8_t)(position * 3U);
+    b = 0;
+  }
+  else if (position < 170U)
+  {
+    position = (uint8_t)(position - 85U);
+    r = 0;
+    g = (uint8_t)(255U - (position * 3U));
+    b = (uint8_t)(position * 3U);
+  }
+  else
+  {
+    position = (uint8_t)(position - 170U);
+    r = (uint8_t)(position * 3U);
+    g = 0;
+    b = (uint8_t)(255U - (position * 3U));
+  }
+
+  /* A quarter brightness is plenty on a desk. */
+  grb[0] = (uint8_t)(g / 4U);
+  grb[1] = (uint8_t)(r / 4U);
+  grb[2] = (uint8_t)(b / 4U);
+}
+
+static void WaveformDemoTask(void *argument)
+{
+  static const WaveformProtocol_t ws2812 = WAVEFORM_PROTOCOL_WS2812;
+  static uint8_t leds[WAVEFORM_DEMO_LEDS * 3U];
+  const uint8_t *const data[1] = { leds };
+  const uint16_t pins[1] = { GPIO_PIN_7 };
+  uint32_t frames = 0, failed = 0, frameNs, i;
+  uint8_t offset = 0;
+  TickType_t lastReport;
+
+  (void)argument;
+
+  if (Waveform_Init(GPIOA, GPIO_PIN_7, &ws2812) == 0)
+  {
+    printf("Waveform: cannot make %lu ns slots with TIM1\r\n", (unsigned long)ws2812.slotNs);
+    vTaskDelete(NULL);
+  }
+
+  frameNs = ((sizeof(leds) * 8U * ws2812.slotsPerBit) + ws2812.trailerSlots) * Waveform_GetSlotNs();
+  printf("Waveform: %u LEDs on PA7, %lu ns slots, %lu us per frame\r\n",
+         (unsigned)WAVEFORM_DEMO_LEDS, (unsigned long)Waveform_GetSlotNs(),
+         (unsigned long)(frameNs / 1000U));
+
+  lastReport = xTaskGetTickCount();
+  interruptCycles = 0;
+
+  for (;;)
+  {
+    for (i = 0; i < WAVEFORM_DEMO_LEDS; i++)
+    {
+      WaveformDemoWheel((uint8_t)(offset + ((i * 256U) / WAVEFORM_DEMO_LEDS)), &leds[i * 3U]);
+    }
+    offset++;
+
+    if ((Waveform_Start(1, pins, data, sizeof(leds)) != 0) && (Waveform_Wait(pdMS_TO_TICKS(100)) != 0))
+    {
+      frames++;
+    }
+    else
+    {
+      failed++;
+    }
+
+    if ((xTaskGetTickCount() - lastReport) >= pdMS_TO_TICKS(WAVEFORM_DEMO_REPORT_MS))
+    {
+      /* Interrupt time against the time the frames took on the line. */
+      uint64_t streamCycles = ((uint64_t)frames * frameNs * (SystemCoreClock / 1000000U)) / 1000U;
+
+      printf("Waveform: %lu frames, %lu failed, interrupts %lu cycles per frame, %lu.%02lu%% of the stream time\r\n",
+             (unsigned long)frames, (unsigned long)failed,
+             (unsigned long)(frames ? (interruptCycles / frames) : 0U),
+             (unsigned long)(streamCycles ? ((uint64_t)interruptCycles * 100U) / streamCycles : 0U),
+             (unsigned long)(streamCycles ? (((uint64_t)interruptCycles * 10000U) / streamCycles) % 100U : 0U));
+
+      frames = 0;
+      failed = 0;
+      interruptCycles = 0;
+      lastReport = xTaskGetTickCount();
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(WAVEFORM_DEMO_PERIOD_MS));
+  }
+}
+
+void Waveform_StartDemo(void)
+{
+  xTaskCreate(WaveformDemoTask, "Waveform", configMINIMAL_STACK_SIZE * 2U, NULL,
+              tskIDLE_PRIORITY + 2U, NULL);
+}
+
+#else
+
+void Waveform_StartDemo(void)
+{
+  printf("Waveform engine needs HAL_TIM_MODULE_ENABLED and HAL_DMA_MODULE_ENABLED\r\n");
+}
+
+#endif
@@ -0,0 +1,114 @@
+/**
+  ******************************************************************************
+  * @file           : waveform_encode.c
+  * @brief          : Turns bit streams into the GPIO BSRR words that the
+  *                   waveform engine writes to the port, one per timer period.
+  ******************************************************************************
+  * The engine calls Waveform_Fill() from the DMA interrupt while the other
+  * half of the buffer is being sent, so it has to keep up with the line.  The
+  * lanes are combined once per bit, not once per slot.
+  ******************************************************************************
+  */
+
+#include "waveform_encode.h"
+
+#include <stddef.h>
+
+/* BSRR: the low half sets pins, the high half resets them. */
+static uint32_t ActiveWord(const WaveformProtocol_t *protocol, uint32_t active, uint32_t all)
+{
+  uint32_t inactive = all & ~active;
+
+  if (protocol->activeLow != 0U)
+  {
+    return inactive | (active << 16);
+  }
+
+  return active | (inactive << 16);
+}
+
+void Waveform_StreamInit(WaveformStream_t *stream, const WaveformProtocol_t *protocol,
+                         uint8_t lanes, const uint16_t *lanePins,
+                         const uint8_t *const *laneData, uint32_t bytes)
+{
+  uint8_t lane;
+
+  if (lanes > WAVEFORM_MAX_LANES)
+  {
+    lanes = WAVEFORM_MAX_LANES;
+  }
+
+  stream->protocol = protocol;
+  stream->lanes = lanes;
+  for (lane = 0; lane < lanes; lane++)
+  {
+    stream->lanePins[lane] = lanePins[lane];
+    stream->laneData[lane] = laneData[lane];
+  }
+  stream->bits = bytes * 8U;
+  stream->nextBit = 0;
+  stream->trailerLeft = protocol->trailerSlots;
+}
+
+uint32_t Waveform_Fill(WaveformStream_t *stream, uint32_t *words, uint32_t count)
+{
+  const WaveformProtocol_t *protocol = stream->protocol;
+  const uint32_t slots = protocol->slotsPerBit;
+  uint32_t all = 0;
+  uint32_t used = 0;
+  uint32_t idle, ones, bit, slot;
+  uint8_t mask, lane;
+  size_t byte;
+
+  for (lane = 0; lane < stream->lanes; lane++)
+  {
+    all |= stream->lanePins[lane];
+  }
+  idle = ActiveWord(protocol, 0, all);
+
+  while ((stream->nextBit < stream->bits) && ((used + slots) <= count))
+  {
+    bit = stream->nextBit++;
+    byte = bit >> 3;
+    mask = (uint8_t)(0x80U >> (bit & 7U));
+
+    /* Lanes sending a 1 in this bit. */
+    ones = 0;
+    for (lane = 0; lane < stream->lanes; lane++)
+    {
+      if ((stream->laneData[lane][byte] & mask) != 0U)
+      {
+        ones |= stream->lanePins[lane];
+      }
+    }
+
+    for (slot = 0; slot < slots; slot++)
+    {
+      uint32_t active = 0;
+
+      if (slot < protocol->highSlots[1])
+      {
+        active |= ones;
+      }
+      if (slot < protocol->highSlots[0])
+      {
+        active |= all & ~ones;
+      }
+      words[used++] = ActiveWord(protocol, active, all);
+    }
+  }
+
+  /* The trailer only starts once every bit has been written. */
+  while ((stream->nextBit == stream->bits) && (stream->trailerLeft > 0U) && (used < count))
+  {
+    words[used++] = idle;
+    stream->trailerLeft--;
+  }
+
+  for (slot = used; slot < count; slot++)
+  {
+    words[slot] = idle;
+  }
+
+  return used;
+}
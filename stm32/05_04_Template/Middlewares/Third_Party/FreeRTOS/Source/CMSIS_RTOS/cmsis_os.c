@@ -56,6 +56,10 @@
 #include <string.h>
 #include "cmsis_os.h"
 
+/* The CMSIS-RTOS2 layer in CMSIS_RTOS_V2 is used instead when
+   configUSE_CMSIS_RTOS_V2 is 1. */
+#if (configUSE_CMSIS_RTOS_V2 == 0)
+
 /*
  * ARM Compiler 4/5
  */
@@ -1725,3 +1729,5 @@ uint32_t osSemaphoreGetCount(osSemaphoreId semaphore_id)
 {
   return uxSemaphoreGetCount(semaphore_id);
 }
+
+#endif /* configUSE_CMSIS_RTOS_V2 == 0 */
@@ -0,0 +1,1743 @@
+/* ----------------------------------------------------------------------
+ * Project:      CMSIS-RTOS2 API
+ * Title:        cmsis_os2.c
+ *
+ * CMSIS-RTOS2 API on top of the FreeRTOS kernel.  See cmsis_os2.h for how
+ * the objects map onto kernel objects and for what is not supported.
+ *
+ * Every object is created with the kernel's static create function when
+ * the attributes give it memory (cb_mem, stack_mem, mp_mem, mq_mem), and
+ * with the dynamic one when they leave it to the RTOS.  Passing only part
+ * of the memory, or less than the object needs, is an error.
+ *---------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "cmsis_os2.h"
+
+#if (configUSE_CMSIS_RTOS_V2 == 1)
+
+#include "cmsis_compiler.h"
+
+#if (configSUPPORT_STATIC_ALLOCATION != 1)
+  #error "cmsis_os2.c needs configSUPPORT_STATIC_ALLOCATION set to 1"
+#endif
+#if (configUSE_TASK_NOTIFICATIONS != 1)
+  #error "cmsis_os2.c needs configUSE_TASK_NOTIFICATIONS set to 1 for thread flags"
+#endif
+#if (configUSE_MUTEXES != 1) || (configUSE_COUNTING_SEMAPHORES != 1)
+  #error "cmsis_os2.c needs configUSE_MUTEXES and configUSE_COUNTING_SEMAPHORES set to 1"
+#endif
+
+/* Version reported by osKernelGetInfo(), major.minor.rev as mmnnnrrrr. */
+#define OS2_API_VERSION       20010003U
+#define OS2_KERNEL_VERSION    (((uint32_t)tskKERNEL_VERSION_MAJOR * 10000000U) + \
+                               ((uint32_t)tskKERNEL_VERSION_MINOR * 10000U) +    \
+                               (uint32_t)tskKERNEL_VERSION_BUILD)
+#define OS2_KERNEL_ID         "FreeRTOS " tskKERNEL_VERSION_NUMBER
+
+/* Bit 31 of the flags is the error indicator.  Event groups reserve their
+   top 8 bits for the kernel. */
+#define THREAD_FLAGS_INVALID_BITS     0x80000000U
+#if (configUSE_16_BIT_TICKS == 1)
+  #define EVENT_FLAGS_INVALID_BITS    0xFFFFFF00U
+#else
+  #define EVENT_FLAGS_INVALID_BITS    0xFF000000U
+#endif
+
+/* Recursive mutexes are told apart by bit 0 of the mutex ID; the control
+   block is word aligned so that bit is free. */
+#define MUTEX_RECURSIVE_TAG           1U
+
+/* Bits of osStaticMemoryPool_t.dynamic. */
+#define MEMPOOL_DYNAMIC_CB            1U
+#define MEMPOOL_DYNAMIC_MEM           2U
+
+/* SysTick registers, for the part of osKernelGetSysTimerCount() since the
+   last tick.  A host build can define them in its cmsis_compiler.h. */
+#ifndef SYSTICK_LOAD_REG
+  #define SYSTICK_LOAD_REG            (*((volatile uint32_t *)0xE000E014UL))
+  #define SYSTICK_VALUE_REG           (*((volatile uint32_t *)0xE000E018UL))
+  #define SCB_ICSR_REG                (*((volatile uint32_t *)0xE000ED04UL))
+#endif
+#define SCB_ICSR_PENDSTSET            (1UL << 26U)
+
+static osKernelState_t KernelState = osKernelInactive;
+
+/* Determine whether we are in thread mode or handler mode. */
+static int IsIrq (void)
+{
+  return __get_IPSR() != 0U;
+}
+
+/* The CMSIS priorities come in bands of eight (Low, BelowNormal, Normal, ...).
+   With fewer than 56 kernel priorities each band is one kernel priority, so
+   configMAX_PRIORITIES 7 gives osPriorityLow 1, osPriorityNormal 3 and
+   osPriorityRealtime 6, the same as the v1 layer. */
+static UBaseType_t MakeRtosPriority (osPriority_t prio)
+{
+#if (configMAX_PRIORITIES >= 56)
+  return (UBaseType_t)prio;
+#else
+  return (UBaseType_t)prio / 8U;
+#endif
+}
+
+static osPriority_t MakeCmsisPriority (UBaseType_t prio)
+{
+#if (configMAX_PRIORITIES >= 56)
+  return (osPriority_t)prio;
+#else
+  return (prio == 0U) ? osPriorityIdle : (osPriority_t)(prio * 8U);
+#endif
+}
+
+/* Timeouts are tick counts; osWaitForever is portMAX_DELAY with 32 bit
+   ticks and is mapped to it with 16 bit ticks. */
+static TickType_t MakeTicks (uint32_t timeout)
+{
+  if (timeout == osWaitForever) {
+    return portMAX_DELAY;
+  }
+  return (TickType_t)timeout;
+}
+
+/* Checks the attribute memory of an object.  Returns 1 for static creation,
+   0 for dynamic creation and -1 if the memory is missing or too small. */
+static int CheckCbMem (void *cb_mem, uint32_t cb_size, size_t needed)
+{
+  if (cb_mem != NULL) {
+    return (cb_size >= needed) ? 1 : -1;
+  }
+  return (cb_size == 0U) ? 0 : -1;
+}
+
+static void AddToRegistry (void *handle, const char *name)
+{
+#if (configQUEUE_REGISTRY_SIZE > 0)
+  if ((handle != NULL) && (name != NULL)) {
+    vQueueAddToRegistry((QueueHandle_t)handle, name);
+  }
+#else
+  (void)handle;
+  (void)name;
+#endif
+}
+
+static void RemoveFromRegistry (void *handle)
+{
+#if (configQUEUE_REGISTRY_SIZE > 0)
+  vQueueUnregisterQueue((QueueHandle_t)handle);
+#else
+  (void)handle;
+#endif
+}
+
+static const char *GetRegistryName (void *handle)
+{
+#if (configQUEUE_REGISTRY_SIZE > 0)
+  return pcQueueGetName((QueueHandle_t)handle);
+#else
+  (void)handle;
+  return NULL;
+#endif
+}
+
+/*********************** Kernel Management Functions **************************/
+
+osStatus_t osKernelInitialize (void)
+{
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  if (KernelState != osKernelInactive) {
+    return osError;
+  }
+
+  KernelState = osKernelReady;
+  return osOK;
+}
+
+osStatus_t osKernelGetInfo (osVersion_t *version, char *id_buf, uint32_t id_size)
+{
+  if (version != NULL) {
+    version->api = OS2_API_VERSION;
+    version->kernel = OS2_KERNEL_VERSION;
+  }
+
+  if ((id_buf != NULL) && (id_size != 0U)) {
+    if (id_size > sizeof(OS2_KERNEL_ID)) {
+      id_size = sizeof(OS2_KERNEL_ID);
+    }
+    memcpy(id_buf, OS2_KERNEL_ID, id_size - 1U);
+    id_buf[id_size - 1U] = '\0';
+  }
+
+  return osOK;
+}
+
+osKernelState_t osKernelGetState (void)
+{
+  switch (xTaskGetSchedulerState()) {
+    case taskSCHEDULER_RUNNING:
+      return osKernelRunning;
+    case taskSCHEDULER_SUSPENDED:
+      return (KernelState == osKernelSuspended) ? osKernelSuspended : osKernelLocked;
+    case taskSCHEDULER_NOT_STARTED:
+    default:
+      return (KernelState == osKernelReady) ? osKernelReady : osKernelInactive;
+  }
+}
+
+osStatus_t osKernelStart (void)
+{
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  if (KernelState != osKernelReady) {
+    return osError;
+  }
+
+  KernelState = osKernelRunning;
+  vTaskStartScheduler();
+
+  /* Only reached if the idle or timer task could not be created. */
+  KernelState = osKernelReady;
+  return osError;
+}
+
+int32_t osKernelLock (void)
+{
+  if (IsIrq()) {
+    return (int32_t)osErrorISR;
+  }
+
+  switch (xTaskGetSchedulerState()) {
+    case taskSCHEDULER_SUSPENDED:
+      return 1;
+    case taskSCHEDULER_RUNNING:
+      vTaskSuspendAll();
+      return 0;
+    default:
+      return (int32_t)osError;
+  }
+}
+
+int32_t osKernelUnlock (void)
+{
+  if (IsIrq()) {
+    return (int32_t)osErrorISR;
+  }
+
+  switch (xTaskGetSchedulerState()) {
+    case taskSCHEDULER_SUSPENDED:
+      (void)xTaskResumeAll();
+      return 1;
+    case taskSCHEDULER_RUNNING:
+      return 0;
+    default:
+      return (int32_t)osError;
+  }
+}
+
+int32_t osKernelRestoreLock (int32_t lock)
+{
+  BaseType_t state;
+
+  if (IsIrq()) {
+    return (int32_t)osErrorISR;
+  }
+
+  state = xTaskGetSchedulerState();
+  if ((state == taskSCHEDULER_NOT_STARTED) || ((lock != 0) && (lock != 1))) {
+    return (int32_t)osError;
+  }
+
+  if ((lock == 1) && (state == taskSCHEDULER_RUNNING)) {
+    vTaskSuspendAll();
+  }
+  else if ((lock == 0) && (state == taskSCHEDULER_SUSPENDED)) {
+    (void)xTaskResumeAll();
+  }
+  return lock;
+}
+
+/* The kernel does not tell how long it could sleep from outside the idle
+   task, so 0 is returned: use configUSE_TICKLESS_IDLE for low power. */
+uint32_t osKernelSuspend (void)
+{
+  if (IsIrq() || (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING)) {
+    return 0U;
+  }
+
+  vTaskSuspendAll();
+  KernelState = osKernelSuspended;
+  return 0U;
+}
+
+void osKernelResume (uint32_t sleep_ticks)
+{
+  if (IsIrq() || (KernelState != osKernelSuspended)) {
+    return;
+  }
+
+  KernelState = osKernelRunning;
+  (void)xTaskResumeAll();
+  if (sleep_ticks != 0U) {
+    (void)xTaskCatchUpTicks((TickType_t)sleep_ticks);
+  }
+}
+
+uint32_t osKernelGetTickCount (void)
+{
+  if (IsIrq()) {
+    return (uint32_t)xTaskGetTickCountFromISR();
+  }
+  return (uint32_t)xTaskGetTickCount();
+}
+
+uint32_t osKernelGetTickFreq (void)
+{
+  return configTICK_RATE_HZ;
+}
+
+/* SysTick drives the kernel tick, so the system timer is the tick count
+   times the SysTick period plus the SysTick cycles since the last tick. */
+uint32_t osKernelGetSysTimerCount (void)
+{
+  uint32_t primask = __get_PRIMASK();
+  uint32_t load, val, ticks;
+
+  __disable_irq();
+  ticks = (uint32_t)xTaskGetTickCount();
+  load = SYSTICK_LOAD_REG;
+  val = load - SYSTICK_VALUE_REG;
+  if ((SCB_ICSR_REG & SCB_ICSR_PENDSTSET) != 0U) {
+    /* The counter wrapped but the tick has not been counted yet. */
+    val = load - SYSTICK_VALUE_REG;
+    ticks++;
+  }
+  __set_PRIMASK(primask);
+
+  return (ticks * (load + 1U)) + val;
+}
+
+uint32_t osKernelGetSysTimerFreq (void)
+{
+  return configCPU_CLOCK_HZ;
+}
+
+/*********************** Thread Management Functions **************************/
+
+osThreadId_t osThreadNew (osThreadFunc_t func, void *argument, const osThreadAttr_t *attr)
+{
+  const char *name = "";
+  uint32_t stack = configMINIMAL_STACK_SIZE;
+  osPriority_t prio = osPriorityNormal;
+  TaskHandle_t hTask = NULL;
+
+  if (IsIrq() || (func == NULL)) {
+    return NULL;
+  }
+
+  if (attr != NULL) {
+    if (attr->name != NULL) {
+      name = attr->name;
+    }
+    if (attr->priority != osPriorityNone) {
+      prio = attr->priority;
+    }
+    if ((prio < osPriorityIdle) || (prio > osPriorityRealtime7) ||
+        ((attr->attr_bits & osThreadJoinable) != 0U)) {
+      return NULL;
+    }
+    if (attr->stack_size != 0U) {
+      stack = attr->stack_size / sizeof(StackType_t);
+    }
+
+    if ((attr->cb_mem != NULL) || (attr->stack_mem != NULL)) {
+      /* A supplied stack must come with its size; the default size says
+         nothing about how large the caller's buffer is. */
+      if ((attr->cb_mem == NULL) || (attr->cb_size < sizeof(StaticTask_t)) ||
+          (attr->stack_mem == NULL) || (attr->stack_size == 0U) || (stack == 0U)) {
+        return NULL;
+      }
+      return xTaskCreateStatic((TaskFunction_t)func, name, stack, argument, MakeRtosPriority(prio),
+                               (StackType_t *)attr->stack_mem, (StaticTask_t *)attr->cb_mem);
+    }
+    if (attr->cb_size != 0U) {
+      return NULL;
+    }
+  }
+
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+  if (xTaskCreate((TaskFunction_t)func, name, (configSTACK_DEPTH_TYPE)stack, argument,
+                  MakeRtosPriority(prio), &hTask) != pdPASS) {
+    hTask = NULL;
+  }
+#endif
+
+  return hTask;
+}
+
+const char *osThreadGetName (osThreadId_t thread_id)
+{
+  if (thread_id == NULL) {
+    return NULL;
+  }
+  return pcTaskGetName((TaskHandle_t)thread_id);
+}
+
+osThreadId_t osThreadGetId (void)
+{
+  return xTaskGetCurrentTaskHandle();
+}
+
+osThreadState_t osThreadGetState (osThreadId_t thread_id)
+{
+#if (INCLUDE_eTaskGetState == 1)
+  if (IsIrq() || (thread_id == NULL)) {
+    return osThreadError;
+  }
+
+  switch (eTaskGetState((TaskHandle_t)thread_id)) {
+    case eRunning:   return osThreadRunning;
+    case eReady:     return osThreadReady;
+    case eBlocked:
+    case eSuspended: return osThreadBlocked;
+    case eDeleted:   return osThreadTerminated;
+    case eInvalid:
+    default:         return osThreadError;
+  }
+#else
+  (void)thread_id;
+  return osThreadError;
+#endif
+}
+
+/* The kernel does not keep the stack size of a task. */
+uint32_t osThreadGetStackSize (osThreadId_t thread_id)
+{
+  (void)thread_id;
+  return 0U;
+}
+
+uint32_t osThreadGetStackSpace (osThreadId_t thread_id)
+{
+#if (INCLUDE_uxTaskGetStackHighWaterMark == 1)
+  if (IsIrq() || (thread_id == NULL)) {
+    return 0U;
+  }
+  return (uint32_t)uxTaskGetStackHighWaterMark((TaskHandle_t)thread_id) * sizeof(StackType_t);
+#else
+  (void)thread_id;
+  return 0U;
+#endif
+}
+
+osStatus_t osThreadSetPriority (osThreadId_t thread_id, osPriority_t priority)
+{
+#if (INCLUDE_vTaskPrioritySet == 1)
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  if ((thread_id == NULL) || (priority < osPriorityIdle) || (priority > osPriorityRealtime7)) {
+    return osErrorParameter;
+  }
+
+  vTaskPrioritySet((TaskHandle_t)thread_id, MakeRtosPriority(priority));
+  return osOK;
+#else
+  (void)thread_id;
+  (void)priority;
+  return osError;
+#endif
+}
+
+osPriority_t osThreadGetPriority (osThreadId_t thread_id)
+{
+#if (INCLUDE_uxTaskPriorityGet == 1)
+  if (IsIrq() || (thread_id == NULL)) {
+    return osPriorityError;
+  }
+  return MakeCmsisPriority(uxTaskPriorityGet((TaskHandle_t)thread_id));
+#else
+  (void)thread_id;
+  return osPriorityError;
+#endif
+}
+
+osStatus_t osThreadYield (void)
+{
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+
+  taskYIELD();
+  return osOK;
+}
+
+osStatus_t osThreadSuspend (osThreadId_t thread_id)
+{
+#if (INCLUDE_vTaskSuspend == 1)
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  if (thread_id == NULL) {
+    return osErrorParameter;
+  }
+
+  vTaskSuspend((TaskHandle_t)thread_id);
+  return osOK;
+#else
+  (void)thread_id;
+  return osError;
+#endif
+}
+
+osStatus_t osThreadResume (osThreadId_t thread_id)
+{
+#if (INCLUDE_vTaskSuspend == 1)
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  if (thread_id == NULL) {
+    return osErrorParameter;
+  }
+
+  vTaskResume((TaskHandle_t)thread_id);
+  return osOK;
+#else
+  (void)thread_id;
+  return osError;
+#endif
+}
+
+/* Every thread is created detached. */
+osStatus_t osThreadDetach (osThreadId_t thread_id)
+{
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  return (thread_id == NULL) ? osErrorParameter : osErrorResource;
+}
+
+osStatus_t osThreadJoin (osThreadId_t thread_id)
+{
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  return (thread_id == NULL) ? osErrorParameter : osErrorResource;
+}
+
+__NO_RETURN void osThreadExit (void)
+{
+#if (INCLUDE_vTaskDelete == 1)
+  vTaskDelete(NULL);
+#endif
+  for (;;);
+}
+
+osStatus_t osThreadTerminate (osThreadId_t thread_id)
+{
+#if (INCLUDE_vTaskDelete == 1)
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  if (thread_id == NULL) {
+    return osErrorParameter;
+  }
+
+  vTaskDelete((TaskHandle_t)thread_id);
+  return osOK;
+#else
+  (void)thread_id;
+  return osError;
+#endif
+}
+
+uint32_t osThreadGetCount (void)
+{
+  if (IsIrq()) {
+    return 0U;
+  }
+  return (uint32_t)uxTaskGetNumberOfTasks();
+}
+
+uint32_t osThreadEnumerate (osThreadId_t *thread_array, uint32_t array_items)
+{
+#if (configUSE_TRACE_FACILITY == 1) && (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+  TaskStatus_t *status;
+  uint32_t i, count;
+
+  if (IsIrq() || (thread_array == NULL) || (array_items == 0U)) {
+    return 0U;
+  }
+
+  /* The task count cannot change while the scheduler is suspended. */
+  vTaskSuspendAll();
+  count = (uint32_t)uxTaskGetNumberOfTasks();
+  status = pvPortMalloc(count * sizeof(TaskStatus_t));
+  if (status != NULL) {
+    count = (uint32_t)uxTaskGetSystemState(status, (UBaseType_t)count, NULL);
+    for (i = 0U; (i < count) && (i < array_items); i++) {
+      thread_array[i] = (osThreadId_t)status[i].xHandle;
+    }
+    count = i;
+  }
+  else {
+    count = 0U;
+  }
+  (void)xTaskResumeAll();
+
+  vPortFree(status);
+  return count;
+#else
+  (void)thread_array;
+  (void)array_items;
+  return 0U;
+#endif
+}
+
+/*********************** Thread Flags Functions *******************************/
+
+uint32_t osThreadFlagsSet (osThreadId_t thread_id, uint32_t flags)
+{
+  uint32_t previous = 0U;
+  BaseType_t yield = pdFALSE;
+
+  if ((thread_id == NULL) || ((flags & THREAD_FLAGS_INVALID_BITS) != 0U)) {
+    return osFlagsErrorParameter;
+  }
+
+  if (IsIrq()) {
+    (void)xTaskNotifyAndQueryFromISR((TaskHandle_t)thread_id, flags, eSetBits, &previous, &yield);
+    portYIELD_FROM_ISR(yield);
+  }
+  else {
+    (void)xTaskNotifyAndQuery((TaskHandle_t)thread_id, flags, eSetBits, &previous);
+  }
+
+  return previous | flags;
+}
+
+uint32_t osThreadFlagsClear (uint32_t flags)
+{
+  if (IsIrq()) {
+    return osFlagsErrorISR;
+  }
+  if ((flags & THREAD_FLAGS_INVALID_BITS) != 0U) {
+    return osFlagsErrorParameter;
+  }
+
+  return ulTaskNotifyValueClear(NULL, flags);
+}
+
+uint32_t osThreadFlagsGet (void)
+{
+  if (IsIrq()) {
+    return osFlagsErrorISR;
+  }
+
+  return ulTaskNotifyValueClear(NULL, 0U);
+}
+
+/* Only the waiting thread clears its own flags, so the value read here can
+   only gain bits before it is cleared.  xTaskNotifyWait() is used just to
+   block until the next notification; it does not touch the value. */
+uint32_t osThreadFlagsWait (uint32_t flags, uint32_t options, uint32_t timeout)
+{
+  TickType_t start, elapsed, wait;
+  uint32_t current, matched;
+  BaseType_t done;
+
+  if (IsIrq()) {
+    return osFlagsErrorISR;
+  }
+  if ((flags == 0U) || ((flags & THREAD_FLAGS_INVALID_BITS) != 0U)) {
+    return osFlagsErrorParameter;
+  }
+
+  start = xTaskGetTickCount();
+  for (;;) {
+    current = ulTaskNotifyValueClear(NULL, 0U);
+    matched = current & flags;
+    if ((options & osFlagsWaitAll) != 0U) {
+      done = (matched == flags) ? pdTRUE : pdFALSE;
+    }
+    else {
+      done = (matched != 0U) ? pdTRUE : pdFALSE;
+    }
+
+    if (done != pdFALSE) {
+      if ((options & osFlagsNoClear) == 0U) {
+        (void)ulTaskNotifyValueClear(NULL, matched);
+      }
+      return current;
+    }
+
+    if (timeout == 0U) {
+      return osFlagsErrorResource;
+    }
+    if (timeout == osWaitForever) {
+      wait = portMAX_DELAY;
+    }
+    else {
+      elapsed = xTaskGetTickCount() - start;
+      if (elapsed >= (TickType_t)timeout) {
+        return osFlagsErrorTimeout;
+      }
+      wait = (TickType_t)timeout - elapsed;
+    }
+
+    (void)xTaskNotifyWait(0U, 0U, NULL, wait);
+  }
+}
+
+/*********************** Generic Wait Functions *******************************/
+
+osStatus_t osDelay (uint32_t ticks)
+{
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+
+  if (ticks != 0U) {
+    vTaskDelay(MakeTicks(ticks));
+  }
+  return osOK;
+}
+
+osStatus_t osDelayUntil (uint32_t ticks)
+{
+  TickType_t delay;
+
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+
+  /* A target more than half the tick range ahead is taken to be in the
+     past. */
+  delay = (TickType_t)ticks - xTaskGetTickCount();
+  if ((delay == 0U) || (delay > (portMAX_DELAY >> 1))) {
+    return osErrorParameter;
+  }
+
+  vTaskDelay(delay);
+  return osOK;
+}
+
+/*********************** Timer Management Functions ***************************/
+
+#if (configUSE_TIMERS == 1)
+
+static void TimerCallback (TimerHandle_t hTimer)
+{
+  osStaticTimer_t *cb = (osStaticTimer_t *)pvTimerGetTimerID(hTimer);
+
+  cb->func(cb->argument);
+}
+
+#if (INCLUDE_xTimerPendFunctionCall == 1) && (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+/* Runs in the timer task after it has removed the deleted timer. */
+static void TimerFree (void *cb, uint32_t unused)
+{
+  (void)unused;
+  vPortFree(cb);
+}
+#endif
+
+osTimerId_t osTimerNew (osTimerFunc_t func, osTimerType_t type, void *argument, const osTimerAttr_t *attr)
+{
+  osStaticTimer_t *cb = NULL;
+  const char *name = "";
+  uint32_t dynamic = 0U;
+  TimerHandle_t hTimer;
+
+  if (IsIrq() || (func == NULL)) {
+    return NULL;
+  }
+
+  if (attr != NULL) {
+    if (attr->name != NULL) {
+      name = attr->name;
+    }
+    switch (CheckCbMem(attr->cb_mem, attr->cb_size, sizeof(osStaticTimer_t))) {
+      case 1:  cb = (osStaticTimer_t *)attr->cb_mem; break;
+      case 0:  break;
+      default: return NULL;
+    }
+  }
+
+  /* A heap control block can only be freed once the timer task has
+     processed the delete command, which needs a pended function call. */
+  if (cb == NULL) {
+#if (INCLUDE_xTimerPendFunctionCall == 1) && (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+    cb = pvPortMalloc(sizeof(osStaticTimer_t));
+    dynamic = 1U;
+#endif
+    if (cb == NULL) {
+      return NULL;
+    }
+  }
+
+  cb->func = func;
+  cb->argument = argument;
+  cb->dynamic = dynamic;
+
+  /* The period is set by osTimerStart(). */
+  hTimer = xTimerCreateStatic(name, 1, (type == osTimerPeriodic) ? pdTRUE : pdFALSE,
+                              cb, TimerCallback, &cb->timer);
+  if ((hTimer == NULL) && (dynamic != 0U)) {
+    vPortFree(cb);
+  }
+
+  return (osTimerId_t)hTimer;
+}
+
+const char *osTimerGetName (osTimerId_t timer_id)
+{
+  if (IsIrq() || (timer_id == NULL)) {
+    return NULL;
+  }
+  return pcTimerGetName((TimerHandle_t)timer_id);
+}
+
+osStatus_t osTimerStart (osTimerId_t timer_id, uint32_t ticks)
+{
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  if ((timer_id == NULL) || (ticks == 0U)) {
+    return osErrorParameter;
+  }
+
+  /* Changing the period also starts the timer. */
+  if (xTimerChangePeriod((TimerHandle_t)timer_id, MakeTicks(ticks), 0) != pdPASS) {
+    return osErrorResource;
+  }
+  return osOK;
+}
+
+osStatus_t osTimerStop (osTimerId_t timer_id)
+{
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  if (timer_id == NULL) {
+    return osErrorParameter;
+  }
+
+  if ((xTimerIsTimerActive((TimerHandle_t)timer_id) == pdFALSE) ||
+      (xTimerStop((TimerHandle_t)timer_id, 0) != pdPASS)) {
+    return osErrorResource;
+  }
+  return osOK;
+}
+
+uint32_t osTimerIsRunning (osTimerId_t timer_id)
+{
+  if (IsIrq() || (timer_id == NULL)) {
+    return 0U;
+  }
+  return (xTimerIsTimerActive((TimerHandle_t)timer_id) != pdFALSE) ? 1U : 0U;
+}
+
+/* The timer task removes the timer when it gets to the delete command, so a
+   cb_mem control block must not be reused before then. */
+osStatus_t osTimerDelete (osTimerId_t timer_id)
+{
+  osStaticTimer_t *cb;
+
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  if (timer_id == NULL) {
+    return osErrorParameter;
+  }
+
+  cb = (osStaticTimer_t *)pvTimerGetTimerID((TimerHandle_t)timer_id);
+  if (xTimerDelete((TimerHandle_t)timer_id, portMAX_DELAY) != pdPASS) {
+    return osErrorResource;
+  }
+
+#if (INCLUDE_xTimerPendFunctionCall == 1) && (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+  if (cb->dynamic != 0U) {
+    (void)xTimerPendFunctionCall(TimerFree, cb, 0U, portMAX_DELAY);
+  }
+#else
+  (void)cb;
+#endif
+
+  return osOK;
+}
+
+#else /* configUSE_TIMERS == 1 */
+
+osTimerId_t osTimerNew (osTimerFunc_t func, osTimerType_t type, void *argument, const osTimerAttr_t *attr)
+{
+  (void)func;
+  (void)type;
+  (void)argument;
+  (void)attr;
+  return NULL;
+}
+
+const char *osTimerGetName (osTimerId_t timer_id)
+{
+  (void)timer_id;
+  return NULL;
+}
+
+osStatus_t osTimerStart (osTimerId_t timer_id, uint32_t ticks)
+{
+  (void)timer_id;
+  (void)ticks;
+  return osError;
+}
+
+osStatus_t osTimerStop (osTimerId_t timer_id)
+{
+  (void)timer_id;
+  return osError;
+}
+
+uint32_t osTimerIsRunning (osTimerId_t timer_id)
+{
+  (void)timer_id;
+  return 0U;
+}
+
+osStatus_t osTimerDelete (osTimerId_t timer_id)
+{
+  (void)timer_id;
+  return osError;
+}
+
+#endif /* configUSE_TIMERS == 1 */
+
+/*********************** Event Flags Management Functions *********************/
+
+osEventFlagsId_t osEventFlagsNew (const osEventFlagsAttr_t *attr)
+{
+  EventGroupHandle_t hEventGroup = NULL;
+  int mem = 0;
+
+  if (IsIrq()) {
+    return NULL;
+  }
+
+  if (attr != NULL) {
+    mem = CheckCbMem(attr->cb_mem, attr->cb_size, sizeof(StaticEventGroup_t));
+  }
+
+  if (mem == 1) {
+    hEventGroup = xEventGroupCreateStatic((StaticEventGroup_t *)attr->cb_mem);
+  }
+  else if (mem == 0) {
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+    hEventGroup = xEventGroupCreate();
+#endif
+  }
+
+  return (osEventFlagsId_t)hEventGroup;
+}
+
+/* Event groups have no name. */
+const char *osEventFlagsGetName (osEventFlagsId_t ef_id)
+{
+  (void)ef_id;
+  return NULL;
+}
+
+uint32_t osEventFlagsSet (osEventFlagsId_t ef_id, uint32_t flags)
+{
+  EventGroupHandle_t hEventGroup = (EventGroupHandle_t)ef_id;
+  BaseType_t yield = pdFALSE;
+
+  if ((hEventGroup == NULL) || ((flags & EVENT_FLAGS_INVALID_BITS) != 0U)) {
+    return osFlagsErrorParameter;
+  }
+
+  if (IsIrq()) {
+    /* Setting bits from an interrupt is deferred to the timer task. */
+#if (configUSE_TIMERS == 1) && (INCLUDE_xTimerPendFunctionCall == 1)
+    if (xEventGroupSetBitsFromISR(hEventGroup, (EventBits_t)flags, &yield) == pdFAIL) {
+      return osFlagsErrorResource;
+    }
+    portYIELD_FROM_ISR(yield);
+    return flags;
+#else
+    (void)yield;
+    return osFlagsErrorISR;
+#endif
+  }
+
+  return (uint32_t)xEventGroupSetBits(hEventGroup, (EventBits_t)flags);
+}
+
+uint32_t osEventFlagsClear (osEventFlagsId_t ef_id, uint32_t flags)
+{
+  EventGroupHandle_t hEventGroup = (EventGroupHandle_t)ef_id;
+  uint32_t previous;
+
+  if ((hEventGroup == NULL) || ((flags & EVENT_FLAGS_INVALID_BITS) != 0U)) {
+    return osFlagsErrorParameter;
+  }
+
+  if (IsIrq()) {
+#if (configUSE_TIMERS == 1) && (INCLUDE_xTimerPendFunctionCall == 1)
+    previous = (uint32_t)xEventGroupGetBitsFromISR(hEventGroup);
+    if (xEventGroupClearBitsFromISR(hEventGroup, (EventBits_t)flags) == pdFAIL) {
+      return osFlagsErrorResource;
+    }
+    return previous;
+#else
+    (void)previous;
+    return osFlagsErrorISR;
+#endif
+  }
+
+  return (uint32_t)xEventGroupClearBits(hEventGroup, (EventBits_t)flags);
+}
+
+uint32_t osEventFlagsGet (osEventFlagsId_t ef_id)
+{
+  EventGroupHandle_t hEventGroup = (EventGroupHandle_t)ef_id;
+
+  if (hEventGroup == NULL) {
+    return 0U;
+  }
+  if (IsIrq()) {
+    return (uint32_t)xEventGroupGetBitsFromISR(hEventGroup);
+  }
+  return (uint32_t)xEventGroupGetBits(hEventGroup);
+}
+
+uint32_t osEventFlagsWait (osEventFlagsId_t ef_id, uint32_t flags, uint32_t options, uint32_t timeout)
+{
+  EventGroupHandle_t hEventGroup = (EventGroupHandle_t)ef_id;
+  BaseType_t waitAll = ((options & osFlagsWaitAll) != 0U) ? pdTRUE : pdFALSE;
+  BaseType_t clear = ((options & osFlagsNoClear) == 0U) ? pdTRUE : pdFALSE;
+  uint32_t current;
+
+  if (IsIrq()) {
+    return osFlagsErrorISR;
+  }
+  if ((hEventGroup == NULL) || (flags == 0U) || ((flags & EVENT_FLAGS_INVALID_BITS) != 0U)) {
+    return osFlagsErrorParameter;
+  }
+
+  current = (uint32_t)xEventGroupWaitBits(hEventGroup, (EventBits_t)flags, clear, waitAll,
+                                          MakeTicks(timeout));
+
+  if (((waitAll != pdFALSE) && ((current & flags) != flags)) ||
+      ((waitAll == pdFALSE) && ((current & flags) == 0U))) {
+    return (timeout != 0U) ? osFlagsErrorTimeout : osFlagsErrorResource;
+  }
+  return current;
+}
+
+osStatus_t osEventFlagsDelete (osEventFlagsId_t ef_id)
+{
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  if (ef_id == NULL) {
+    return osErrorParameter;
+  }
+
+  vEventGroupDelete((EventGroupHandle_t)ef_id);
+  return osOK;
+}
+
+/*********************** Mutex Management Functions ***************************/
+
+static SemaphoreHandle_t MutexHandle (osMutexId_t mutex_id)
+{
+  return (SemaphoreHandle_t)((uintptr_t)mutex_id & ~(uintptr_t)MUTEX_RECURSIVE_TAG);
+}
+
+static BaseType_t MutexIsRecursive (osMutexId_t mutex_id)
+{
+  return (((uintptr_t)mutex_id & MUTEX_RECURSIVE_TAG) != 0U) ? pdTRUE : pdFALSE;
+}
+
+osMutexId_t osMutexNew (const osMutexAttr_t *attr)
+{
+  SemaphoreHandle_t hMutex = NULL;
+  uint32_t recursive = 0U;
+  int mem = 0;
+
+  if (IsIrq()) {
+    return NULL;
+  }
+
+  if (attr != NULL) {
+    if ((attr->attr_bits & osMutexRobust) != 0U) {
+      return NULL;
+    }
+    recursive = attr->attr_bits & osMutexRecursive;
+    mem = CheckCbMem(attr->cb_mem, attr->cb_size, sizeof(StaticSemaphore_t));
+  }
+
+  if (recursive != 0U) {
+#if (configUSE_RECURSIVE_MUTEXES == 1)
+    if (mem == 1) {
+      hMutex = xSemaphoreCreateRecursiveMutexStatic((StaticSemaphore_t *)attr->cb_mem);
+    }
+  #if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+    else if (mem == 0) {
+      hMutex = xSemaphoreCreateRecursiveMutex();
+    }
+  #endif
+#endif
+  }
+  else {
+    if (mem == 1) {
+      hMutex = xSemaphoreCreateMutexStatic((StaticSemaphore_t *)attr->cb_mem);
+    }
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+    else if (mem == 0) {
+      hMutex = xSemaphoreCreateMutex();
+    }
+#endif
+  }
+
+  if (hMutex == NULL) {
+    return NULL;
+  }
+
+  AddToRegistry(hMutex, (attr != NULL) ? attr->name : NULL);
+  return (osMutexId_t)((uintptr_t)hMutex | recursive);
+}
+
+const char *osMutexGetName (osMutexId_t mutex_id)
+{
+  if (IsIrq() || (mutex_id == NULL)) {
+    return NULL;
+  }
+  return GetRegistryName(MutexHandle(mutex_id));
+}
+
+osStatus_t osMutexAcquire (osMutexId_t mutex_id, uint32_t timeout)
+{
+  SemaphoreHandle_t hMutex = MutexHandle(mutex_id);
+  BaseType_t taken;
+
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  if (hMutex == NULL) {
+    return osErrorParameter;
+  }
+
+#if (configUSE_RECURSIVE_MUTEXES == 1)
+  if (MutexIsRecursive(mutex_id) != pdFALSE) {
+    taken = xSemaphoreTakeRecursive(hMutex, MakeTicks(timeout));
+  }
+  else
+#endif
+  {
+    taken = xSemaphoreTake(hMutex, MakeTicks(timeout));
+  }
+
+  if (taken != pdPASS) {
+    return (timeout != 0U) ? osErrorTimeout : osErrorResource;
+  }
+  return osOK;
+}
+
+osStatus_t osMutexRelease (osMutexId_t mutex_id)
+{
+  SemaphoreHandle_t hMutex = MutexHandle(mutex_id);
+  BaseType_t given;
+
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  if (hMutex == NULL) {
+    return osErrorParameter;
+  }
+
+#if (configUSE_RECURSIVE_MUTEXES == 1)
+  if (MutexIsRecursive(mutex_id) != pdFALSE) {
+    /* Fails if the caller is not the holder. */
+    given = xSemaphoreGiveRecursive(hMutex);
+  }
+  else
+#endif
+  {
+#if (INCLUDE_xSemaphoreGetMutexHolder == 1)
+    if (xSemaphoreGetMutexHolder(hMutex) != xTaskGetCurrentTaskHandle()) {
+      return osErrorResource;
+    }
+#endif
+    given = xSemaphoreGive(hMutex);
+  }
+
+  return (given == pdPASS) ? osOK : osErrorResource;
+}
+
+osThreadId_t osMutexGetOwner (osMutexId_t mutex_id)
+{
+#if (INCLUDE_xSemaphoreGetMutexHolder == 1)
+  SemaphoreHandle_t hMutex = MutexHandle(mutex_id);
+
+  if (hMutex == NULL) {
+    return NULL;
+  }
+  if (IsIrq()) {
+    return (osThreadId_t)xSemaphoreGetMutexHolderFromISR(hMutex);
+  }
+  return (osThreadId_t)xSemaphoreGetMutexHolder(hMutex);
+#else
+  (void)mutex_id;
+  return NULL;
+#endif
+}
+
+osStatus_t osMutexDelete (osMutexId_t mutex_id)
+{
+  SemaphoreHandle_t hMutex = MutexHandle(mutex_id);
+
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  if (hMutex == NULL) {
+    return osErrorParameter;
+  }
+
+  RemoveFromRegistry(hMutex);
+  vSemaphoreDelete(hMutex);
+  return osOK;
+}
+
+/*********************** Semaphore Management Functions ***********************/
+
+osSemaphoreId_t osSemaphoreNew (uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t *attr)
+{
+  SemaphoreHandle_t hSemaphore = NULL;
+  int mem = 0;
+
+  if (IsIrq() || (max_count == 0U) || (initial_count > max_count)) {
+    return NULL;
+  }
+
+  if (attr != NULL) {
+    mem = CheckCbMem(attr->cb_mem, attr->cb_size, sizeof(StaticSemaphore_t));
+  }
+
+  if (max_count == 1U) {
+    if (mem == 1) {
+      hSemaphore = xSemaphoreCreateBinaryStatic((StaticSemaphore_t *)attr->cb_mem);
+    }
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+    else if (mem == 0) {
+      hSemaphore = xSemaphoreCreateBinary();
+    }
+#endif
+    if ((hSemaphore != NULL) && (initial_count != 0U)) {
+      (void)xSemaphoreGive(hSemaphore);
+    }
+  }
+  else {
+    if (mem == 1) {
+      hSemaphore = xSemaphoreCreateCountingStatic(max_count, initial_count,
+                                                  (StaticSemaphore_t *)attr->cb_mem);
+    }
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+    else if (mem == 0) {
+      hSemaphore = xSemaphoreCreateCounting(max_count, initial_count);
+    }
+#endif
+  }
+
+  AddToRegistry(hSemaphore, (attr != NULL) ? attr->name : NULL);
+  return (osSemaphoreId_t)hSemaphore;
+}
+
+const char *osSemaphoreGetName (osSemaphoreId_t semaphore_id)
+{
+  if (IsIrq() || (semaphore_id == NULL)) {
+    return NULL;
+  }
+  return GetRegistryName(semaphore_id);
+}
+
+osStatus_t osSemaphoreAcquire (osSemaphoreId_t semaphore_id, uint32_t timeout)
+{
+  SemaphoreHandle_t hSemaphore = (SemaphoreHandle_t)semaphore_id;
+  BaseType_t yield = pdFALSE;
+
+  if (hSemaphore == NULL) {
+    return osErrorParameter;
+  }
+
+  if (IsIrq()) {
+    if (timeout != 0U) {
+      return osErrorParameter;
+    }
+    if (xSemaphoreTakeFromISR(hSemaphore, &yield) != pdPASS) {
+      return osErrorResource;
+    }
+    portYIELD_FROM_ISR(yield);
+    return osOK;
+  }
+
+  if (xSemaphoreTake(hSemaphore, MakeTicks(timeout)) != pdPASS) {
+    return (timeout != 0U) ? osErrorTimeout : osErrorResource;
+  }
+  return osOK;
+}
+
+osStatus_t osSemaphoreRelease (osSemaphoreId_t semaphore_id)
+{
+  SemaphoreHandle_t hSemaphore = (SemaphoreHandle_t)semaphore_id;
+  BaseType_t yield = pdFALSE;
+
+  if (hSemaphore == NULL) {
+    return osErrorParameter;
+  }
+
+  if (IsIrq()) {
+    if (xSemaphoreGiveFromISR(hSemaphore, &yield) != pdPASS) {
+      return osErrorResource;
+    }
+    portYIELD_FROM_ISR(yield);
+    return osOK;
+  }
+
+  return (xSemaphoreGive(hSemaphore) == pdPASS) ? osOK : osErrorResource;
+}
+
+uint32_t osSemaphoreGetCount (osSemaphoreId_t semaphore_id)
+{
+  if (semaphore_id == NULL) {
+    return 0U;
+  }
+  if (IsIrq()) {
+    return (uint32_t)uxQueueMessagesWaitingFromISR((QueueHandle_t)semaphore_id);
+  }
+  return (uint32_t)uxSemaphoreGetCount((SemaphoreHandle_t)semaphore_id);
+}
+
+osStatus_t osSemaphoreDelete (osSemaphoreId_t semaphore_id)
+{
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  if (semaphore_id == NULL) {
+    return osErrorParameter;
+  }
+
+  RemoveFromRegistry(semaphore_id);
+  vSemaphoreDelete((SemaphoreHandle_t)semaphore_id);
+  return osOK;
+}
+
+/*********************** Memory Pool Management Functions *********************/
+
+osMemoryPoolId_t osMemoryPoolNew (uint32_t block_count, uint32_t block_size, const osMemoryPoolAttr_t *attr)
+{
+  osStaticMemoryPool_t *mp = NULL;
+  uint8_t *mem = NULL;
+  uint32_t size, total, i;
+  int cbMem = 0;
+
+  if (IsIrq() || (block_count == 0U) || (block_size == 0U)) {
+    return NULL;
+  }
+
+  /* Every free block holds the link to the next one. */
+  size = osMemoryPoolBlockSize(block_size);
+  total = block_count * size;
+  if ((size < block_size) || ((total / size) != block_count)) {
+    return NULL;
+  }
+
+  if (attr != NULL) {
+    cbMem = CheckCbMem(attr->cb_mem, attr->cb_size, sizeof(osStaticMemoryPool_t));
+    if (cbMem == 1) {
+      mp = (osStaticMemoryPool_t *)attr->cb_mem;
+    }
+    if (attr->mp_mem != NULL) {
+      if ((attr->mp_size < total) || (((uintptr_t)attr->mp_mem % sizeof(void *)) != 0U)) {
+        return NULL;
+      }
+      mem = (uint8_t *)attr->mp_mem;
+    }
+    else if (attr->mp_size != 0U) {
+      return NULL;
+    }
+    if (cbMem < 0) {
+      return NULL;
+    }
+  }
+
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+  if (mp == NULL) {
+    mp = pvPortMalloc(sizeof(osStaticMemoryPool_t));
+    if (mp == NULL) {
+      return NULL;
+    }
+    mp->dynamic = MEMPOOL_DYNAMIC_CB;
+  }
+  else {
+    mp->dynamic = 0U;
+  }
+  if (mem == NULL) {
+    mem = pvPortMalloc(total);
+    if (mem == NULL) {
+      if ((mp->dynamic & MEMPOOL_DYNAMIC_CB) != 0U) {
+        vPortFree(mp);
+      }
+      return NULL;
+    }
+    mp->dynamic |= MEMPOOL_DYNAMIC_MEM;
+  }
+#else
+  if ((mp == NULL) || (mem == NULL)) {
+    return NULL;
+  }
+  mp->dynamic = 0U;
+#endif
+
+  mp->mem = mem;
+  mp->block_size = size;
+  mp->block_count = block_count;
+  mp->name = (attr != NULL) ? attr->name : NULL;
+
+  mp->free_list = mem;
+  for (i = 0U; i < block_count; i++) {
+    *(void **)(void *)&mem[i * size] = (i + 1U < block_count) ? (void *)&mem[(i + 1U) * size] : NULL;
+  }
+
+  mp->hSemaphore = xSemaphoreCreateCountingStatic(block_count, block_count, &mp->semaphore);
+  return (osMemoryPoolId_t)mp;
+}
+
+const char *osMemoryPoolGetName (osMemoryPoolId_t mp_id)
+{
+  if (IsIrq() || (mp_id == NULL)) {
+    return NULL;
+  }
+  return ((osStaticMemoryPool_t *)mp_id)->name;
+}
+
+static void *MemoryPoolPop (osStaticMemoryPool_t *mp)
+{
+  void *block = mp->free_list;
+
+  mp->free_list = *(void **)block;
+  return block;
+}
+
+/* Holding a semaphore token guarantees a block on the free list, so the
+   list itself is only protected against other allocators and freers. */
+void *osMemoryPoolAlloc (osMemoryPoolId_t mp_id, uint32_t timeout)
+{
+  osStaticMemoryPool_t *mp = (osStaticMemoryPool_t *)mp_id;
+  BaseType_t yield = pdFALSE;
+  UBaseType_t mask;
+  void *block;
+
+  if (mp == NULL) {
+    return NULL;
+  }
+
+  if (IsIrq()) {
+    if ((timeout != 0U) || (xSemaphoreTakeFromISR(mp->hSemaphore, &yield) != pdPASS)) {
+      return NULL;
+    }
+    mask = taskENTER_CRITICAL_FROM_ISR();
+    block = MemoryPoolPop(mp);
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+    portYIELD_FROM_ISR(yield);
+    return block;
+  }
+
+  if (xSemaphoreTake(mp->hSemaphore, MakeTicks(timeout)) != pdPASS) {
+    return NULL;
+  }
+  taskENTER_CRITICAL();
+  block = MemoryPoolPop(mp);
+  taskEXIT_CRITICAL();
+  return block;
+}
+
+osStatus_t osMemoryPoolFree (osMemoryPoolId_t mp_id, void *block)
+{
+  osStaticMemoryPool_t *mp = (osStaticMemoryPool_t *)mp_id;
+  BaseType_t isr = IsIrq() ? pdTRUE : pdFALSE;
+  BaseType_t yield = pdFALSE;
+  UBaseType_t mask = 0U;
+  osStatus_t status = osOK;
+  uintptr_t offset;
+
+  if ((mp == NULL) || (block == NULL) || ((uint8_t *)block < mp->mem)) {
+    return osErrorParameter;
+  }
+  offset = (uintptr_t)((uint8_t *)block - mp->mem);
+  if ((offset >= ((uintptr_t)mp->block_count * mp->block_size)) || ((offset % mp->block_size) != 0U)) {
+    return osErrorParameter;
+  }
+
+  if (isr != pdFALSE) {
+    mask = taskENTER_CRITICAL_FROM_ISR();
+  }
+  else {
+    taskENTER_CRITICAL();
+  }
+  /* A full semaphore means no block is allocated, so this is a double free. */
+  if (uxQueueMessagesWaiting((QueueHandle_t)mp->hSemaphore) >= mp->block_count) {
+    status = osErrorResource;
+  }
+  else {
+    *(void **)block = mp->free_list;
+    mp->free_list = block;
+  }
+  if (isr != pdFALSE) {
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+  }
+  else {
+    taskEXIT_CRITICAL();
+  }
+
+  if (status != osOK) {
+    return status;
+  }
+
+  if (isr != pdFALSE) {
+    (void)xSemaphoreGiveFromISR(mp->hSemaphore, &yield);
+    portYIELD_FROM_ISR(yield);
+  }
+  else {
+    (void)xSemaphoreGive(mp->hSemaphore);
+  }
+  return osOK;
+}
+
+uint32_t osMemoryPoolGetCapacity (osMemoryPoolId_t mp_id)
+{
+  return (mp_id != NULL) ? ((osStaticMemoryPool_t *)mp_id)->block_count : 0U;
+}
+
+uint32_t osMemoryPoolGetBlockSize (osMemoryPoolId_t mp_id)
+{
+  return (mp_id != NULL) ? ((osStaticMemoryPool_t *)mp_id)->block_size : 0U;
+}
+
+uint32_t osMemoryPoolGetSpace (osMemoryPoolId_t mp_id)
+{
+  osStaticMemoryPool_t *mp = (osStaticMemoryPool_t *)mp_id;
+
+  if (mp == NULL) {
+    return 0U;
+  }
+  if (IsIrq()) {
+    return (uint32_t)uxQueueMessagesWaitingFromISR((QueueHandle_t)mp->hSemaphore);
+  }
+  return (uint32_t)uxSemaphoreGetCount(mp->hSemaphore);
+}
+
+uint32_t osMemoryPoolGetCount (osMemoryPoolId_t mp_id)
+{
+  osStaticMemoryPool_t *mp = (osStaticMemoryPool_t *)mp_id;
+
+  if (mp == NULL) {
+    return 0U;
+  }
+  return mp->block_count - osMemoryPoolGetSpace(mp_id);
+}
+
+osStatus_t osMemoryPoolDelete (osMemoryPoolId_t mp_id)
+{
+  osStaticMemoryPool_t *mp = (osStaticMemoryPool_t *)mp_id;
+
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  if (mp == NULL) {
+    return osErrorParameter;
+  }
+
+  vSemaphoreDelete(mp->hSemaphore);
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+  if ((mp->dynamic & MEMPOOL_DYNAMIC_MEM) != 0U) {
+    vPortFree(mp->mem);
+  }
+  if ((mp->dynamic & MEMPOOL_DYNAMIC_CB) != 0U) {
+    vPortFree(mp);
+  }
+#endif
+  return osOK;
+}
+
+/*********************** Message Queue Management Functions *******************/
+
+osMessageQueueId_t osMessageQueueNew (uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr)
+{
+  QueueHandle_t hQueue = NULL;
+  int mem = 0;
+
+  if (IsIrq() || (msg_count == 0U) || (msg_size == 0U) ||
+      (((msg_count * msg_size) / msg_size) != msg_count)) {
+    return NULL;
+  }
+
+  if (attr != NULL) {
+    mem = CheckCbMem(attr->cb_mem, attr->cb_size, sizeof(StaticQueue_t));
+    if (mem == 1) {
+      if ((attr->mq_mem == NULL) || (attr->mq_size < (msg_count * msg_size))) {
+        mem = -1;
+      }
+    }
+    else if ((attr->mq_mem != NULL) || (attr->mq_size != 0U)) {
+      mem = -1;
+    }
+  }
+
+  if (mem == 1) {
+    hQueue = xQueueCreateStatic(msg_count, msg_size, (uint8_t *)attr->mq_mem,
+                                (StaticQueue_t *)attr->cb_mem);
+  }
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1)
+  else if (mem == 0) {
+    hQueue = xQueueCreate(msg_count, msg_size);
+  }
+#endif
+
+  AddToRegistry(hQueue, (attr != NULL) ? attr->name : NULL);
+  return (osMessageQueueId_t)hQueue;
+}
+
+const char *osMessageQueueGetName (osMessageQueueId_t mq_id)
+{
+  if (IsIrq() || (mq_id == NULL)) {
+    return NULL;
+  }
+  return GetRegistryName(mq_id);
+}
+
+osStatus_t osMessageQueuePut (osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio, uint32_t timeout)
+{
+  QueueHandle_t hQueue = (QueueHandle_t)mq_id;
+  BaseType_t yield = pdFALSE;
+
+  (void)msg_prio;
+
+  if ((hQueue == NULL) || (msg_ptr == NULL)) {
+    return osErrorParameter;
+  }
+
+  if (IsIrq()) {
+    if (timeout != 0U) {
+      return osErrorParameter;
+    }
+    if (xQueueSendToBackFromISR(hQueue, msg_ptr, &yield) != pdTRUE) {
+      return osErrorResource;
+    }
+    portYIELD_FROM_ISR(yield);
+    return osOK;
+  }
+
+  if (xQueueSendToBack(hQueue, msg_ptr, MakeTicks(timeout)) != pdPASS) {
+    return (timeout != 0U) ? osErrorTimeout : osErrorResource;
+  }
+  return osOK;
+}
+
+osStatus_t osMessageQueueGet (osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout)
+{
+  QueueHandle_t hQueue = (QueueHandle_t)mq_id;
+  BaseType_t yield = pdFALSE;
+
+  if ((hQueue == NULL) || (msg_ptr == NULL)) {
+    return osErrorParameter;
+  }
+  if (msg_prio != NULL) {
+    *msg_prio = 0U;
+  }
+
+  if (IsIrq()) {
+    if (timeout != 0U) {
+      return osErrorParameter;
+    }
+    if (xQueueReceiveFromISR(hQueue, msg_ptr, &yield) != pdPASS) {
+      return osErrorResource;
+    }
+    portYIELD_FROM_ISR(yield);
+    return osOK;
+  }
+
+  if (xQueueReceive(hQueue, msg_ptr, MakeTicks(timeout)) != pdPASS) {
+    return (timeout != 0U) ? osErrorTimeout : osErrorResource;
+  }
+  return osOK;
+}
+
+uint32_t osMessageQueueGetCapacity (osMessageQueueId_t mq_id)
+{
+  return (mq_id != NULL) ? (uint32_t)uxQueueGetQueueLength((QueueHandle_t)mq_id) : 0U;
+}
+
+uint32_t osMessageQueueGetMsgSize (osMessageQueueId_t mq_id)
+{
+  return (mq_id != NULL) ? (uint32_t)uxQueueGetQueueItemSize((QueueHandle_t)mq_id) : 0U;
+}
+
+uint32_t osMessageQueueGetCount (osMessageQueueId_t mq_id)
+{
+  if (mq_id == NULL) {
+    return 0U;
+  }
+  if (IsIrq()) {
+    return (uint32_t)uxQueueMessagesWaitingFromISR((QueueHandle_t)mq_id);
+  }
+  return (uint32_t)uxQueueMessagesWaiting((QueueHandle_t)mq_id);
+}
+
+uint32_t osMessageQueueGetSpace (osMessageQueueId_t mq_id)
+{
+  UBaseType_t mask, space;
+
+  if (mq_id == NULL) {
+    return 0U;
+  }
+  if (IsIrq()) {
+    mask = taskENTER_CRITICAL_FROM_ISR();
+    space = uxQueueGetQueueLength((QueueHandle_t)mq_id) - uxQueueMessagesWaitingFromISR((QueueHandle_t)mq_id);
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+    return (uint32_t)space;
+  }
+  return (uint32_t)uxQueueSpacesAvailable((QueueHandle_t)mq_id);
+}
+
+osStatus_t osMessageQueueReset (osMessageQueueId_t mq_id)
+{
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  if (mq_id == NULL) {
+    return osErrorParameter;
+  }
+
+  (void)xQueueReset((QueueHandle_t)mq_id);
+  return osOK;
+}
+
+osStatus_t osMessageQueueDelete (osMessageQueueId_t mq_id)
+{
+  if (IsIrq()) {
+    return osErrorISR;
+  }
+  if (mq_id == NULL) {
+    return osErrorParameter;
+  }
+
+  RemoveFromRegistry(mq_id);
+  vQueueDelete((QueueHandle_t)mq_id);
+  return osOK;
+}
+
+#endif /* configUSE_CMSIS_RTOS_V2 == 1 */
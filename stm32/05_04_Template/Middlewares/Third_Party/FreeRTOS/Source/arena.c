@@ -0,0 +1,324 @@
+/*
+ * FreeRTOS Kernel V10.3.1
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "arena.h"
+
+/* Lint e961, e9021 and e750 are suppressed as a MISRA exception justified
+because the MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
+for the header files above, but not in this file, in order to generate the
+correct privileged Vs unprivileged linkage and placement. */
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE /*lint !e961 !e750 !e9021. */
+
+/* This entire source file will be skipped if the application is not configured
+to include arena functionality.  This #if is closed at the very bottom of this
+file.  If you want to include arenas then ensure configUSE_ARENAS is set to 1
+in FreeRTOSConfig.h. */
+#if( configUSE_ARENAS == 1 )
+
+/* Bits stored in the ucFlags field of the arena. */
+#define arenaFLAGS_IS_STATICALLY_ALLOCATED	( ( uint8_t ) 1 ) /* Set if the arena was created using statically allocated memory. */
+
+/* The arena structure is placed at the start of a dynamically allocated
+arena, so its size is rounded up to keep the storage area aligned. */
+#define arenaSTRUCT_SIZE	( ( sizeof( Arena_t ) + ( size_t ) ( portBYTE_ALIGNMENT - 1 ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/*-----------------------------------------------------------*/
+
+/* Structure that holds state information on the arena.  Memory is handed out
+from the start of the storage area upwards. */
+typedef struct ArenaDef_t /*lint !e9058 Style convention uses tag. */
+{
+	uint8_t *pucStorage;				/* Points to the storage area, aligned to portBYTE_ALIGNMENT. */
+	size_t xSize;						/* The usable length of the storage area, in bytes. */
+	size_t xUsed;						/* The offset of the next free byte. */
+	size_t xHighWaterMark;				/* The largest value xUsed has had. */
+	UBaseType_t uxAllocations;			/* The number of successful allocations. */
+	UBaseType_t uxFailedAllocations;	/* The number of allocations that did not fit. */
+	uint8_t ucFlags;
+} Arena_t;
+
+/*
+ * Called by both xArenaCreate() and xArenaCreateStatic() to initialise the
+ * members of the newly created arena structure.
+ */
+static void prvInitialiseNewArena( Arena_t * const pxArena,
+								   uint8_t * const pucStorage,
+								   size_t xSizeBytes,
+								   uint8_t ucFlags ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+	ArenaHandle_t xArenaCreate( size_t xSizeBytes )
+	{
+	uint8_t *pucAllocatedMemory;
+
+		configASSERT( xSizeBytes > ( size_t ) 0 );
+
+		/* The Arena_t structure is placed at the start of the allocated memory
+		and the storage area follows immediately after. */
+		pucAllocatedMemory = ( uint8_t * ) pvPortMalloc( arenaSTRUCT_SIZE + xSizeBytes ); /*lint !e9079 malloc() only returns void*. */
+
+		if( pucAllocatedMemory != NULL )
+		{
+			prvInitialiseNewArena( ( Arena_t * ) pucAllocatedMemory, /* Structure at the start of the allocated memory. */ /*lint !e9087 Safe cast as allocated memory is aligned. */ /*lint !e826 Area is not too small and alignment is guaranteed provided malloc() behaves as expected and returns aligned buffer. */
+								   pucAllocatedMemory + arenaSTRUCT_SIZE,  /* Storage area follows. */ /*lint !e9016 Indexing past structure valid for uint8_t pointer into allocation. */
+								   xSizeBytes,
+								   0 );
+		}
+
+		return ( ArenaHandle_t ) pucAllocatedMemory; /*lint !e9087 !e826 Safe cast as allocated memory is aligned. */
+	}
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	ArenaHandle_t xArenaCreateStatic( size_t xSizeBytes,
+									  uint8_t * const pucArenaStorageArea,
+									  StaticArena_t * const pxStaticArena )
+	{
+	Arena_t * const pxArena = ( Arena_t * ) pxStaticArena; /*lint !e740 !e9087 Arena_t and StaticArena_t are guaranteed to have the same size and alignment requirement - checked by configASSERT(). */
+	ArenaHandle_t xReturn;
+
+		configASSERT( pucArenaStorageArea );
+		configASSERT( pxStaticArena );
+
+		#if( configASSERT_DEFINED == 1 )
+		{
+			/* Sanity check that the size of the structure used to declare a
+			variable of type StaticArena_t equals the size of the real arena
+			structure. */
+			volatile size_t xSize = sizeof( StaticArena_t );
+			configASSERT( xSize == sizeof( Arena_t ) );
+		} /*lint !e529 xSize is referenced if configASSERT() is defined. */
+		#endif /* configASSERT_DEFINED */
+
+		if( ( pucArenaStorageArea != NULL ) && ( pxStaticArena != NULL ) )
+		{
+			prvInitialiseNewArena( pxArena, pucArenaStorageArea, xSizeBytes, arenaFLAGS_IS_STATICALLY_ALLOCATED );
+			xReturn = ( ArenaHandle_t ) pxStaticArena; /*lint !e9087 Data hiding requires cast to opaque type. */
+		}
+		else
+		{
+			xReturn = NULL;
+		}
+
+		return xReturn;
+	}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+void vArenaDelete( ArenaHandle_t xArena )
+{
+Arena_t * pxArena = xArena;
+
+	configASSERT( pxArena );
+
+	if( ( pxArena->ucFlags & arenaFLAGS_IS_STATICALLY_ALLOCATED ) == ( uint8_t ) 0 )
+	{
+		#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+		{
+			/* Both the structure and the storage area were allocated using a
+			single call to pvPortMalloc(), hence only one call to vPortFree()
+			is required. */
+			vPortFree( ( void * ) pxArena ); /*lint !e9087 Standard free() semantics require void *. */
+		}
+		#else
+		{
+			/* Should not be possible to get here, ucFlags must be corrupt.
+			Force an assert. */
+			configASSERT( xArena == ( ArenaHandle_t ) ~0 );
+		}
+		#endif
+	}
+	else
+	{
+		/* The structure and storage area were not allocated dynamically and
+		cannot be freed - just scrub the structure so future use will assert. */
+		( void ) memset( pxArena, 0x00, sizeof( Arena_t ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void *pvArenaAlloc( ArenaHandle_t xArena, size_t xWantedSize )
+{
+Arena_t * const pxArena = xArena;
+void *pvReturn = NULL;
+size_t xAlignedSize;
+
+	configASSERT( pxArena );
+	configASSERT( pxArena->pucStorage );
+
+	/* Round the request up so the next allocation is aligned too, taking care
+	not to wrap. */
+	xAlignedSize = ( xWantedSize + ( size_t ) portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+	if( ( xWantedSize > ( size_t ) 0 ) &&
+		( xAlignedSize >= xWantedSize ) &&
+		( xAlignedSize <= ( pxArena->xSize - pxArena->xUsed ) ) )
+	{
+		pvReturn = ( void * ) &( pxArena->pucStorage[ pxArena->xUsed ] );
+		pxArena->xUsed += xAlignedSize;
+		( pxArena->uxAllocations )++;
+
+		if( pxArena->xUsed > pxArena->xHighWaterMark )
+		{
+			pxArena->xHighWaterMark = pxArena->xUsed;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		( pxArena->uxFailedAllocations )++;
+	}
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void *pvArenaAllocFromTask( size_t xWantedSize )
+{
+ArenaHandle_t xArena = xTaskGetArena( NULL );
+void *pvReturn = NULL;
+
+	if( xArena != NULL )
+	{
+		pvReturn = pvArenaAlloc( xArena, xWantedSize );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xArenaGetMark( ArenaHandle_t xArena )
+{
+const Arena_t * const pxArena = xArena;
+
+	configASSERT( pxArena );
+
+	return pxArena->xUsed;
+}
+/*-----------------------------------------------------------*/
+
+void vArenaRollback( ArenaHandle_t xArena, size_t xMark )
+{
+Arena_t * const pxArena = xArena;
+
+	configASSERT( pxArena );
+
+	/* A mark beyond the current use was taken before a later rollback or
+	reset, and no longer refers to anything. */
+	configASSERT( xMark <= pxArena->xUsed );
+
+	if( xMark <= pxArena->xUsed )
+	{
+		pxArena->xUsed = xMark;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vArenaReset( ArenaHandle_t xArena )
+{
+Arena_t * const pxArena = xArena;
+
+	configASSERT( pxArena );
+
+	pxArena->xUsed = ( size_t ) 0;
+}
+/*-----------------------------------------------------------*/
+
+void vArenaGetStats( ArenaHandle_t xArena, ArenaStats_t *pxArenaStats )
+{
+const Arena_t * const pxArena = xArena;
+
+	configASSERT( pxArena );
+	configASSERT( pxArenaStats );
+
+	pxArenaStats->xSizeBytes = pxArena->xSize;
+	pxArenaStats->xUsedBytes = pxArena->xUsed;
+	pxArenaStats->xHighWaterMarkBytes = pxArena->xHighWaterMark;
+	pxArenaStats->uxAllocations = pxArena->uxAllocations;
+	pxArenaStats->uxFailedAllocations = pxArena->uxFailedAllocations;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseNewArena( Arena_t * const pxArena,
+								   uint8_t * const pucStorage,
+								   size_t xSizeBytes,
+								   uint8_t ucFlags )
+{
+size_t xAdjustment;
+
+	/* Skip any leading bytes needed to align the storage area. */
+	xAdjustment = ( size_t ) ( ( ( size_t ) portBYTE_ALIGNMENT - ( size_t ) ( ( portPOINTER_SIZE_TYPE ) pucStorage & ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) ) & ( size_t ) portBYTE_ALIGNMENT_MASK ); /*lint !e923 Casting pointer to integer to check alignment. */
+
+	if( xAdjustment > xSizeBytes )
+	{
+		xAdjustment = xSizeBytes;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	( void ) memset( ( void * ) pxArena, 0x00, sizeof( Arena_t ) ); /*lint !e9087 memset() requires void *. */
+	pxArena->pucStorage = pucStorage + xAdjustment;
+	pxArena->xSize = xSizeBytes - xAdjustment;
+	pxArena->ucFlags = ucFlags;
+}
+
+/* This entire source file will be skipped if the application is not configured
+to include arena functionality.  If you want to include arenas then ensure
+configUSE_ARENAS is set to 1 in FreeRTOSConfig.h. */
+#endif /* configUSE_ARENAS == 1 */
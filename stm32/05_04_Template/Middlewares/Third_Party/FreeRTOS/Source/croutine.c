@@ -206,7 +206,7 @@ static void prvCheckPendingReadyList( void )
 		/* The pending ready list can be accessed by an ISR. */
 		portDISABLE_INTERRUPTS();
 		{
-			pxUnblockedCRCB = ( CRCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( (&xPendingReadyCoRoutineList) );
+			pxUnblockedCRCB = listGET_OWNER_OF_HEAD_ENTRY_OF_TYPE( (&xPendingReadyCoRoutineList), CRCB_t, xEventListItem );
 			( void ) uxListRemove( &( pxUnblockedCRCB->xEventListItem ) );
 		}
 		portENABLE_INTERRUPTS();
@@ -242,7 +242,7 @@ CRCB_t *pxCRCB;
 		/* See if this tick has made a timeout expire. */
 		while( listLIST_IS_EMPTY( pxDelayedCoRoutineList ) == pdFALSE )
 		{
-			pxCRCB = ( CRCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxDelayedCoRoutineList );
+			pxCRCB = listGET_OWNER_OF_HEAD_ENTRY_OF_TYPE( pxDelayedCoRoutineList, CRCB_t, xGenericListItem );
 
 			if( xCoRoutineTickCount < listGET_LIST_ITEM_VALUE( &( pxCRCB->xGenericListItem ) ) )
 			{
@@ -296,7 +296,7 @@ void vCoRoutineSchedule( void )
 
 	/* listGET_OWNER_OF_NEXT_ENTRY walks through the list, so the co-routines
 	 of the	same priority get an equal share of the processor time. */
-	listGET_OWNER_OF_NEXT_ENTRY( pxCurrentCoRoutine, &( pxReadyCoRoutineLists[ uxTopCoRoutineReadyPriority ] ) );
+	listGET_OWNER_OF_NEXT_ENTRY_OF_TYPE( pxCurrentCoRoutine, &( pxReadyCoRoutineLists[ uxTopCoRoutineReadyPriority ] ), CRCB_t, xGenericListItem );
 
 	/* Call the co-routine. */
 	( pxCurrentCoRoutine->pxCoRoutineFunction )( pxCurrentCoRoutine, pxCurrentCoRoutine->uxIndex );
@@ -333,7 +333,7 @@ BaseType_t xReturn;
 	/* This function is called from within an interrupt.  It can only access
 	event lists and the pending ready list.  This function assumes that a
 	check has already been made to ensure pxEventList is not empty. */
-	pxUnblockedCRCB = ( CRCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxEventList );
+	pxUnblockedCRCB = listGET_OWNER_OF_HEAD_ENTRY_OF_TYPE( pxEventList, CRCB_t, xEventListItem );
 	( void ) uxListRemove( &( pxUnblockedCRCB->xEventListItem ) );
 	vListInsertEnd( ( List_t * ) &( xPendingReadyCoRoutineList ), &( pxUnblockedCRCB->xEventListItem ) );
 
@@ -72,8 +72,34 @@ typedef struct EventGroupDef_t
 	#if( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
 		uint8_t ucStaticallyAllocated; /*< Set to pdTRUE if the event group is statically allocated to ensure no attempt is made to free the memory. */
 	#endif
+
+	#if( configUSE_OBJECT_LOCKS == 1 )
+		portOBJECT_LOCK_TYPE xObjectLock; /*< Guards the event bits and the list of waiting tasks, see configUSE_OBJECT_LOCKS. */
+	#endif
 } EventGroup_t;
 
+/*
+ * With configUSE_OBJECT_LOCKS set, the critical sections that guard an event
+ * group take only the group's own lock, and the sections that run with the
+ * scheduler suspended also hold it, as suspending the scheduler only stops
+ * tasks on the calling core.
+ */
+#if( configUSE_OBJECT_LOCKS == 1 )
+	#define eventENTER_CRITICAL( pxEventBits )		portENTER_OBJECT_CRITICAL( &( ( pxEventBits )->xObjectLock ) )
+	#define eventEXIT_CRITICAL( pxEventBits )		portEXIT_OBJECT_CRITICAL( &( ( pxEventBits )->xObjectLock ) )
+	#define eventENTER_CRITICAL_FROM_ISR( pxEventBits )	portENTER_OBJECT_CRITICAL_FROM_ISR( &( ( pxEventBits )->xObjectLock ) )
+	#define eventEXIT_CRITICAL_FROM_ISR( pxEventBits, x )	portEXIT_OBJECT_CRITICAL_FROM_ISR( &( ( pxEventBits )->xObjectLock ), ( x ) )
+	#define eventLOCK_GROUP( pxEventBits )			eventENTER_CRITICAL( pxEventBits )
+	#define eventUNLOCK_GROUP( pxEventBits )		eventEXIT_CRITICAL( pxEventBits )
+#else
+	#define eventENTER_CRITICAL( pxEventBits )		taskENTER_CRITICAL()
+	#define eventEXIT_CRITICAL( pxEventBits )		taskEXIT_CRITICAL()
+	#define eventENTER_CRITICAL_FROM_ISR( pxEventBits )	portSET_INTERRUPT_MASK_FROM_ISR()
+	#define eventEXIT_CRITICAL_FROM_ISR( pxEventBits, x )	portCLEAR_INTERRUPT_MASK_FROM_ISR( ( x ) )
+	#define eventLOCK_GROUP( pxEventBits )
+	#define eventUNLOCK_GROUP( pxEventBits )
+#endif
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -115,6 +141,12 @@ static BaseType_t prvTestWaitCondition( const EventBits_t uxCurrentEventBits, co
 			pxEventBits->uxEventBits = 0;
 			vListInitialise( &( pxEventBits->xTasksWaitingForBits ) );
 
+			#if( configUSE_OBJECT_LOCKS == 1 )
+			{
+				portOBJECT_LOCK_INIT( &( pxEventBits->xObjectLock ) );
+			}
+			#endif
+
 			#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
 			{
 				/* Both static and dynamic allocation can be used, so note that
@@ -166,6 +198,12 @@ static BaseType_t prvTestWaitCondition( const EventBits_t uxCurrentEventBits, co
 			pxEventBits->uxEventBits = 0;
 			vListInitialise( &( pxEventBits->xTasksWaitingForBits ) );
 
+			#if( configUSE_OBJECT_LOCKS == 1 )
+			{
+				portOBJECT_LOCK_INIT( &( pxEventBits->xObjectLock ) );
+			}
+			#endif
+
 			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
 			{
 				/* Both static and dynamic allocation can be used, so note this
@@ -204,6 +242,7 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 	#endif
 
 	vTaskSuspendAll();
+	eventLOCK_GROUP( pxEventBits );
 	{
 		uxOriginalBitValue = pxEventBits->uxEventBits;
 
@@ -246,6 +285,7 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 			}
 		}
 	}
+	eventUNLOCK_GROUP( pxEventBits );
 	xAlreadyYielded = xTaskResumeAll();
 
 	if( xTicksToWait != ( TickType_t ) 0 )
@@ -268,7 +308,7 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 		if( ( uxReturn & eventUNBLOCKED_DUE_TO_BIT_SET ) == ( EventBits_t ) 0 )
 		{
 			/* The task timed out, just return the current event bit value. */
-			taskENTER_CRITICAL();
+			eventENTER_CRITICAL( pxEventBits );
 			{
 				uxReturn = pxEventBits->uxEventBits;
 
@@ -285,7 +325,7 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 					mtCOVERAGE_TEST_MARKER();
 				}
 			}
-			taskEXIT_CRITICAL();
+			eventEXIT_CRITICAL( pxEventBits );
 
 			xTimeoutOccurred = pdTRUE;
 		}
@@ -327,6 +367,7 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 	#endif
 
 	vTaskSuspendAll();
+	eventLOCK_GROUP( pxEventBits );
 	{
 		const EventBits_t uxCurrentEventBits = pxEventBits->uxEventBits;
 
@@ -394,6 +435,7 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 			traceEVENT_GROUP_WAIT_BITS_BLOCK( xEventGroup, uxBitsToWaitFor );
 		}
 	}
+	eventUNLOCK_GROUP( pxEventBits );
 	xAlreadyYielded = xTaskResumeAll();
 
 	if( xTicksToWait != ( TickType_t ) 0 )
@@ -415,7 +457,7 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 
 		if( ( uxReturn & eventUNBLOCKED_DUE_TO_BIT_SET ) == ( EventBits_t ) 0 )
 		{
-			taskENTER_CRITICAL();
+			eventENTER_CRITICAL( pxEventBits );
 			{
 				/* The task timed out, just return the current event bit value. */
 				uxReturn = pxEventBits->uxEventBits;
@@ -439,7 +481,7 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 				}
 				xTimeoutOccurred = pdTRUE;
 			}
-			taskEXIT_CRITICAL();
+			eventEXIT_CRITICAL( pxEventBits );
 		}
 		else
 		{
@@ -468,7 +510,7 @@ EventBits_t uxReturn;
 	configASSERT( xEventGroup );
 	configASSERT( ( uxBitsToClear & eventEVENT_BITS_CONTROL_BYTES ) == 0 );
 
-	taskENTER_CRITICAL();
+	eventENTER_CRITICAL( pxEventBits );
 	{
 		traceEVENT_GROUP_CLEAR_BITS( xEventGroup, uxBitsToClear );
 
@@ -479,7 +521,7 @@ EventBits_t uxReturn;
 		/* Clear the bits. */
 		pxEventBits->uxEventBits &= ~uxBitsToClear;
 	}
-	taskEXIT_CRITICAL();
+	eventEXIT_CRITICAL( pxEventBits );
 
 	return uxReturn;
 }
@@ -503,14 +545,14 @@ EventBits_t uxReturn;
 EventBits_t xEventGroupGetBitsFromISR( EventGroupHandle_t xEventGroup )
 {
 UBaseType_t uxSavedInterruptStatus;
-EventGroup_t const * const pxEventBits = xEventGroup;
+EventGroup_t * const pxEventBits = xEventGroup;
 EventBits_t uxReturn;
 
-	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	uxSavedInterruptStatus = eventENTER_CRITICAL_FROM_ISR( pxEventBits );
 	{
 		uxReturn = pxEventBits->uxEventBits;
 	}
-	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	eventEXIT_CRITICAL_FROM_ISR( pxEventBits, uxSavedInterruptStatus );
 
 	return uxReturn;
 } /*lint !e818 EventGroupHandle_t is a typedef used in other functions to so can't be pointer to const. */
@@ -533,6 +575,7 @@ BaseType_t xMatchFound = pdFALSE;
 	pxList = &( pxEventBits->xTasksWaitingForBits );
 	pxListEnd = listGET_END_MARKER( pxList ); /*lint !e826 !e740 !e9087 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
 	vTaskSuspendAll();
+	eventLOCK_GROUP( pxEventBits );
 	{
 		traceEVENT_GROUP_SET_BITS( xEventGroup, uxBitsToSet );
 
@@ -604,6 +647,7 @@ BaseType_t xMatchFound = pdFALSE;
 		bit was set in the control word. */
 		pxEventBits->uxEventBits &= ~uxBitsToClear;
 	}
+	eventUNLOCK_GROUP( pxEventBits );
 	( void ) xTaskResumeAll();
 
 	return pxEventBits->uxEventBits;
@@ -619,6 +663,9 @@ const List_t *pxTasksWaitingForBits = &( pxEventBits->xTasksWaitingForBits );
 	{
 		traceEVENT_GROUP_DELETE( xEventGroup );
 
+		/* The lock is part of the memory freed below, so is only held while
+		the waiting tasks are unblocked. */
+		eventLOCK_GROUP( pxEventBits );
 		while( listCURRENT_LIST_LENGTH( pxTasksWaitingForBits ) > ( UBaseType_t ) 0 )
 		{
 			/* Unblock the task, returning 0 as the event list is being deleted
@@ -626,6 +673,7 @@ const List_t *pxTasksWaitingForBits = &( pxEventBits->xTasksWaitingForBits );
 			configASSERT( pxTasksWaitingForBits->xListEnd.pxNext != ( const ListItem_t * ) &( pxTasksWaitingForBits->xListEnd ) );
 			vTaskRemoveFromUnorderedEventList( pxTasksWaitingForBits->xListEnd.pxNext, eventUNBLOCKED_DUE_TO_BIT_SET );
 		}
+		eventUNLOCK_GROUP( pxEventBits );
 
 		#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) )
 		{
@@ -278,6 +278,40 @@ hold explicit before calling the code. */
 
 #endif /* configUSE_TIMERS */
 
+#ifndef configUSE_TIMER_COMMAND_COALESCING
+	#define configUSE_TIMER_COMMAND_COALESCING 0
+#endif
+
+#ifndef configGENERATE_TIMER_COMMAND_STATS
+	#define configGENERATE_TIMER_COMMAND_STATS 0
+#endif
+
+#ifndef configUSE_TIMER_SLACK
+	#define configUSE_TIMER_SLACK 0
+#endif
+
+#ifndef configTIMER_SERVICE_COUNT
+	#define configTIMER_SERVICE_COUNT 1
+#endif
+
+#if( configUSE_TIMERS == 1 )
+
+	/* One priority per timer service, as an initialiser list. */
+	#ifndef configTIMER_SERVICE_PRIORITIES
+		#if( configTIMER_SERVICE_COUNT == 1 )
+			#define configTIMER_SERVICE_PRIORITIES { configTIMER_TASK_PRIORITY }
+		#else
+			#error If configTIMER_SERVICE_COUNT is greater than 1 then configTIMER_SERVICE_PRIORITIES must also be defined, for example { 2, configMAX_PRIORITIES - 1 }.
+		#endif
+	#endif
+
+#endif /* configUSE_TIMERS */
+
+/* Direct in-daemon timer commands need to know which task is calling. */
+#if ( configUSE_TIMER_COMMAND_COALESCING == 1 ) && ( INCLUDE_xTaskGetCurrentTaskHandle != 1 ) && ( configUSE_MUTEXES != 1 )
+	#error configUSE_TIMER_COMMAND_COALESCING requires INCLUDE_xTaskGetCurrentTaskHandle or configUSE_MUTEXES to be set to 1.
+#endif
+
 #ifndef portSET_INTERRUPT_MASK_FROM_ISR
 	#define portSET_INTERRUPT_MASK_FROM_ISR() 0
 #endif
@@ -398,6 +432,15 @@ hold explicit before calling the code. */
 	#define configCHECK_FOR_STACK_OVERFLOW 0
 #endif
 
+#if( configCHECK_FOR_STACK_OVERFLOW == 3 )
+	#ifndef portSET_STACK_GUARD
+		#error configCHECK_FOR_STACK_OVERFLOW can only be set to 3 when using a port that guards the task stacks in hardware.
+	#endif
+	#if( portSTACK_GROWTH > 0 )
+		#error configCHECK_FOR_STACK_OVERFLOW 3 is only supported on architectures where the stack grows down.
+	#endif
+#endif
+
 #ifndef configRECORD_STACK_HIGH_ADDRESS
 	#define configRECORD_STACK_HIGH_ADDRESS 0
 #endif
@@ -728,6 +771,11 @@ hold explicit before calling the code. */
 		#endif /* portALT_GET_RUN_TIME_COUNTER_VALUE */
 	#endif /* portGET_RUN_TIME_COUNTER_VALUE */
 
+	/* portGET_ISR_RUN_TIME_COUNTER_VALUE() is optional.  If it is defined it
+	must return the total time spent in interrupt handlers, in the same units
+	as the run time counter, and that time is then not charged to the tasks
+	the interrupts preempted.  The value may wrap. */
+
 #endif /* configGENERATE_RUN_TIME_STATS */
 
 #ifndef portCONFIGURE_TIMER_FOR_RUN_TIME_STATS
@@ -822,6 +870,10 @@ hold explicit before calling the code. */
 	#define portASSERT_IF_IN_ISR()
 #endif
 
+#ifndef portASSERT_KERNEL_LOCKED
+	#define portASSERT_KERNEL_LOCKED()
+#endif
+
 #ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
 	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
 #endif
@@ -865,6 +917,105 @@ hold explicit before calling the code. */
 	#define configMESSAGE_BUFFER_LENGTH_TYPE size_t
 #endif
 
+#ifndef configUSE_STREAM_BUFFER_FLUSH_DEADLINE
+	#define configUSE_STREAM_BUFFER_FLUSH_DEADLINE 0
+#endif
+
+#ifndef configUSE_MESSAGE_QUEUES
+	#define configUSE_MESSAGE_QUEUES 0
+#endif
+
+#ifndef configQUEUE_SIZED_COPY
+	#define configQUEUE_SIZED_COPY 0
+#endif
+
+#ifndef configUSE_ARENAS
+	#define configUSE_ARENAS 0
+#endif
+
+/* Selects the CMSIS-RTOS API built on top of the kernel: 0 for the v1 layer in
+CMSIS_RTOS, 1 for the CMSIS-RTOS2 layer in CMSIS_RTOS_V2.  The two define the
+same function names, so only one of them is compiled. */
+#ifndef configUSE_CMSIS_RTOS_V2
+	#define configUSE_CMSIS_RTOS_V2 0
+#endif
+
+/* Set to 1 to drop the owner pointer from list items and the item value from
+list ends.  The owner is then found from the item's offset within the object
+that contains it, see list.h. */
+#ifndef configUSE_COMPACT_LIST_ITEMS
+	#define configUSE_COMPACT_LIST_ITEMS 0
+#endif
+
+/* Set to 1 to start the scheduler with the tasks, queues, semaphores, mutexes
+and timers held in kernel_image.h.  The header is generated by tools/kimage
+from a description of the system and builds every object at compile time, so
+they are ready without being created. */
+#ifndef configUSE_KERNEL_IMAGE
+	#define configUSE_KERNEL_IMAGE 0
+#endif
+
+/* Set to 1 to give each queue, semaphore, event group, stream buffer, message
+queue and timer service its own lock in place of the single kernel critical
+section, so operations on different objects from different cores do not
+serialise on each other.  The port provides the locks:
+
+	portOBJECT_LOCK_TYPE						the type of one object lock
+	portOBJECT_LOCK_INITIALISER					its static initialiser
+	portOBJECT_LOCK_INIT( pxLock )				initialises a lock at run time
+	portENTER_OBJECT_CRITICAL( pxLock )			takes a lock from a task
+	portEXIT_OBJECT_CRITICAL( pxLock )
+	portENTER_OBJECT_CRITICAL_FROM_ISR( pxLock )	takes a lock from an ISR and
+												returns the interrupt mask
+	portEXIT_OBJECT_CRITICAL_FROM_ISR( pxLock, uxSavedInterruptStatus )
+	portLOCK_KERNEL() / portUNLOCK_KERNEL()		the lock on the ready,
+												delayed, pending ready,
+												suspended and event lists
+	portASSERT_KERNEL_LOCKED()					optional, asserts the calling
+												core holds the kernel lock
+
+Locks are always taken in this order, and released in the reverse order:
+
+	1. the lock of the object being operated on,
+	2. for a queue in a queue set, the lock of the set,
+	3. the kernel lock.
+
+tasks.c takes the kernel lock for itself, always with interrupts masked: every
+critical section in tasks.c also holds it, and so do the tick, the context
+switch, the ISR safe functions and the functions objects call to block and
+unblock tasks.  Suspending the scheduler only stops the calling core, so it
+never stands in for the kernel lock.  The tick hook is called after the kernel
+lock is released.  No object lock is ever taken with the kernel lock held, and
+apart from a queue and its queue set no two objects are locked at the same
+time.  Like critical sections, object locks and the kernel lock nest - the core
+that holds a lock can take it again. */
+#ifndef configUSE_OBJECT_LOCKS
+	#define configUSE_OBJECT_LOCKS 0
+#endif
+
+#ifndef configUSE_MPMC_QUEUES
+	#define configUSE_MPMC_QUEUES 0
+#endif
+
+/* The send and receive positions of an MPMC queue are each padded to this
+many bytes so they do not share a cache line.  Set it to the data cache line
+size of the part, or to sizeof( size_t ) on a part without a data cache to
+save RAM. */
+#ifndef configMPMC_QUEUE_CACHE_LINE_SIZE
+	#define configMPMC_QUEUE_CACHE_LINE_SIZE 32
+#endif
+
+/* Set to 1 to let the idle task run background jobs registered with
+xTaskRegisterIdleJob(), and to the number of jobs that can be registered in
+configIDLE_JOB_REGISTRY_SIZE. */
+#ifndef configUSE_IDLE_JOBS
+	#define configUSE_IDLE_JOBS 0
+#endif
+
+#ifndef configIDLE_JOB_REGISTRY_SIZE
+	#define configIDLE_JOB_REGISTRY_SIZE 4
+#endif
+
 /* Sanity check the configuration. */
 #if( configUSE_TICKLESS_IDLE != 0 )
 	#if( INCLUDE_vTaskSuspend != 1 )
@@ -880,6 +1031,27 @@ hold explicit before calling the code. */
 	#error configUSE_MUTEXES must be set to 1 to use recursive mutexes
 #endif
 
+#if( configUSE_IDLE_JOBS == 1 )
+	#if( configGENERATE_RUN_TIME_STATS != 1 )
+		#error configGENERATE_RUN_TIME_STATS must be set to 1 to use idle jobs, as their budgets are measured with the run time stats counter
+	#endif
+#endif
+
+#if( configUSE_OBJECT_LOCKS == 1 )
+	#ifndef portOBJECT_LOCK_TYPE
+		#error configUSE_OBJECT_LOCKS is 1 but the port does not define portOBJECT_LOCK_TYPE and the other object lock macros
+	#endif
+#endif
+
+#if( configUSE_KERNEL_IMAGE == 1 )
+	#if( configSUPPORT_STATIC_ALLOCATION != 1 )
+		#error configSUPPORT_STATIC_ALLOCATION must be set to 1 to use a kernel image
+	#endif
+	#if( configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES == 1 )
+		#error configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES cannot be used with a kernel image
+	#endif
+#endif
+
 #ifndef configINITIAL_TICK_COUNT
 	#define configINITIAL_TICK_COUNT 0
 #endif
@@ -1064,7 +1236,11 @@ struct xSTATIC_LIST_ITEM
 		TickType_t xDummy1;
 	#endif
 	TickType_t xDummy2;
-	void *pvDummy3[ 4 ];
+	#if( configUSE_COMPACT_LIST_ITEMS == 1 )
+		void *pvDummy3[ 3 ];
+	#else
+		void *pvDummy3[ 4 ];
+	#endif
 	#if( configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES == 1 )
 		TickType_t xDummy4;
 	#endif
@@ -1077,7 +1253,9 @@ struct xSTATIC_MINI_LIST_ITEM
 	#if( configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES == 1 )
 		TickType_t xDummy1;
 	#endif
-	TickType_t xDummy2;
+	#if( configUSE_COMPACT_LIST_ITEMS == 0 )
+		TickType_t xDummy2;
+	#endif
 	void *pvDummy3[ 2 ];
 };
 typedef struct xSTATIC_MINI_LIST_ITEM StaticMiniListItem_t;
@@ -1137,6 +1315,9 @@ typedef struct xSTATIC_TCB
 	#if( configNUM_THREAD_LOCAL_STORAGE_POINTERS > 0 )
 		void			*pvDummy15[ configNUM_THREAD_LOCAL_STORAGE_POINTERS ];
 	#endif
+	#if ( configUSE_ARENAS == 1 )
+		void			*pvDummy23;
+	#endif
 	#if ( configGENERATE_RUN_TIME_STATS == 1 )
 		uint32_t		ulDummy16;
 	#endif
@@ -1200,6 +1381,14 @@ typedef struct xSTATIC_QUEUE
 		uint8_t ucDummy9;
 	#endif
 
+	#if ( configUSE_OBJECT_LOCKS == 1 )
+		portOBJECT_LOCK_TYPE xDummyLock;
+	#endif
+
+	#if( configQUEUE_SIZED_COPY == 1 )
+		void *pvDummyCopy;
+	#endif
+
 } StaticQueue_t;
 typedef StaticQueue_t StaticSemaphore_t;
 
@@ -1230,6 +1419,10 @@ typedef struct xSTATIC_EVENT_GROUP
 			uint8_t ucDummy4;
 	#endif
 
+	#if( configUSE_OBJECT_LOCKS == 1 )
+		portOBJECT_LOCK_TYPE xDummyLock;
+	#endif
+
 } StaticEventGroup_t;
 
 /*
@@ -1256,6 +1449,15 @@ typedef struct xSTATIC_TIMER
 	#if( configUSE_TRACE_FACILITY == 1 )
 		UBaseType_t		uxDummy7;
 	#endif
+	#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+		UBaseType_t		uxDummy9[ 3 ];
+	#endif
+	#if( configUSE_TIMER_SLACK == 1 )
+		TickType_t		xDummy10;
+	#endif
+	#if( configTIMER_SERVICE_COUNT > 1 )
+		void			*pvDummy11;
+	#endif
 	uint8_t 			ucDummy8;
 
 } StaticTimer_t;
@@ -1282,8 +1484,74 @@ typedef struct xSTATIC_STREAM_BUFFER
 	#if ( configUSE_TRACE_FACILITY == 1 )
 		UBaseType_t uxDummy4;
 	#endif
+	#if ( configUSE_STREAM_BUFFER_FLUSH_DEADLINE == 1 )
+		TickType_t xDummy5[ 2 ];
+	#endif
+	#if ( configUSE_OBJECT_LOCKS == 1 )
+		portOBJECT_LOCK_TYPE xDummyLock;
+	#endif
 } StaticStreamBuffer_t;
 
+/*
+ * In line with software engineering best practice, FreeRTOS implements a strict
+ * data hiding policy, so the real message queue structure is not accessible to
+ * application code.  The StaticMessageQueue_t structure below is provided so
+ * the memory for a message queue can be allocated statically.  Its size and
+ * alignment requirements are guaranteed to match those of the genuine
+ * structure.
+ */
+typedef struct xSTATIC_MESSAGE_QUEUE
+{
+	StaticList_t xDummy1[ 2 ];
+	void * pvDummy2;
+	size_t uxDummy3[ 4 ];
+	UBaseType_t uxDummy4;
+	uint8_t ucDummy5;
+	#if ( configUSE_OBJECT_LOCKS == 1 )
+		portOBJECT_LOCK_TYPE xDummyLock;
+	#endif
+} StaticMessageQueue_t;
+
+/*
+ * In line with software engineering best practice, FreeRTOS implements a strict
+ * data hiding policy, so the real MPMC queue structure is not accessible to
+ * application code.  The StaticMpmcQueue_t structure below is provided so the
+ * memory for an MPMC queue can be allocated statically.  Its size and
+ * alignment requirements are guaranteed to match those of the genuine
+ * structure.
+ */
+typedef struct xSTATIC_MPMC_QUEUE
+{
+	union
+	{
+		size_t uxDummy1;
+		uint8_t ucDummy1[ configMPMC_QUEUE_CACHE_LINE_SIZE ];
+	} xDummy1[ 2 ];
+	void * pvDummy2;
+	size_t uxDummy3[ 3 ];
+	StaticList_t xDummy4[ 2 ];
+	UBaseType_t uxDummy5[ 2 ];
+	uint8_t ucDummy6;
+	#if ( configUSE_OBJECT_LOCKS == 1 )
+		portOBJECT_LOCK_TYPE xDummyLock;
+	#endif
+} StaticMpmcQueue_t;
+
+/*
+ * In line with software engineering best practice, FreeRTOS implements a strict
+ * data hiding policy, so the real arena structure is not accessible to
+ * application code.  The StaticArena_t structure below is provided so the
+ * memory for an arena can be allocated statically.  Its size and alignment
+ * requirements are guaranteed to match those of the genuine structure.
+ */
+typedef struct xSTATIC_ARENA
+{
+	void * pvDummy1;
+	size_t uxDummy2[ 3 ];
+	UBaseType_t uxDummy3[ 2 ];
+	uint8_t ucDummy4;
+} StaticArena_t;
+
 /* Message buffers are built on stream buffers. */
 typedef StaticStreamBuffer_t StaticMessageBuffer_t;
 
@@ -0,0 +1,278 @@
+/*
+ * FreeRTOS Kernel V10.3.1
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * Arenas hand out memory for allocations that share a lifetime, such as the
+ * buffers a worker task needs while it handles one request.  An allocation
+ * only advances an offset into the arena's storage, so it takes constant
+ * time and leaves no fragments behind.  Individual allocations are not freed.
+ * Instead the whole arena is reset, or rolled back to a mark taken earlier,
+ * in one call.
+ *
+ * An arena can be attached to a task with vTaskSetArena().  The task can then
+ * allocate from it with pvArenaAllocFromTask(), and the arena is deleted along
+ * with the task.
+ *
+ * Arenas are not protected against concurrent access.  Each arena must only be
+ * used by one task at a time, which is the normal case for task scoped memory.
+ * Arenas must not be used from interrupts.
+ *
+ * configUSE_ARENAS must be set to 1 in FreeRTOSConfig.h for arenas to be
+ * available.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include arena.h"
+#endif
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/**
+ * Type by which arenas are referenced.  For example, a call to xArenaCreate()
+ * returns an ArenaHandle_t variable that can then be used as a parameter to
+ * pvArenaAlloc(), vArenaReset(), etc.
+ */
+struct ArenaDef_t;
+typedef struct ArenaDef_t * ArenaHandle_t;
+
+/**
+ * Used with vArenaGetStats() to report how an arena has been used.
+ */
+typedef struct xARENA_STATS
+{
+	size_t xSizeBytes;					/* The usable size of the arena's storage area. */
+	size_t xUsedBytes;					/* The number of bytes currently allocated, including alignment padding. */
+	size_t xHighWaterMarkBytes;			/* The largest value xUsedBytes has had since the arena was created. */
+	UBaseType_t uxAllocations;			/* The number of successful allocations since the arena was created. */
+	UBaseType_t uxFailedAllocations;	/* The number of allocations that failed because the arena was full. */
+} ArenaStats_t;
+
+/**
+ * arena.h
+ *
+<pre>
+ArenaHandle_t xArenaCreate( size_t xSizeBytes );
+</pre>
+ *
+ * Creates a new arena, allocating both the arena structure and its storage
+ * area with one call to pvPortMalloc().  See xArenaCreateStatic() for a
+ * version that uses statically allocated memory.
+ *
+ * configSUPPORT_DYNAMIC_ALLOCATION must be set to 1 or left undefined in
+ * FreeRTOSConfig.h for xArenaCreate() to be available.
+ *
+ * @param xSizeBytes The number of bytes the arena can hand out.  Each
+ * allocation is rounded up to a multiple of portBYTE_ALIGNMENT.
+ *
+ * @return The handle of the created arena, or NULL if there was not enough
+ * heap memory available to create it.
+ *
+ * \defgroup xArenaCreate xArenaCreate
+ * \ingroup ArenaManagement
+ */
+ArenaHandle_t xArenaCreate( size_t xSizeBytes ) PRIVILEGED_FUNCTION;
+
+/**
+ * arena.h
+ *
+<pre>
+ArenaHandle_t xArenaCreateStatic( size_t xSizeBytes,
+                                  uint8_t *pucArenaStorageArea,
+                                  StaticArena_t *pxStaticArena );
+</pre>
+ *
+ * Creates a new arena using statically allocated memory.
+ *
+ * configSUPPORT_STATIC_ALLOCATION must be set to 1 in FreeRTOSConfig.h for
+ * xArenaCreateStatic() to be available.
+ *
+ * @param xSizeBytes The size, in bytes, of the buffer pointed to by
+ * pucArenaStorageArea.
+ *
+ * @param pucArenaStorageArea Must point to a uint8_t array that is at least
+ * xSizeBytes big.  If it is not aligned to portBYTE_ALIGNMENT the first few
+ * bytes are skipped.
+ *
+ * @param pxStaticArena Must point to a variable of type StaticArena_t, which
+ * will be used to hold the arena's data structure.
+ *
+ * @return The handle of the created arena, or NULL if either
+ * pucArenaStorageArea or pxStaticArena is NULL.
+ *
+ * Example use:
+<pre>
+
+static uint8_t ucRequestMemory[ 2048 ];
+static StaticArena_t xRequestArenaStruct;
+
+void vWorkerTask( void *pvParameters )
+{
+ArenaHandle_t xArena;
+char *pcHeader;
+uint8_t *pucBody;
+
+	xArena = xArenaCreateStatic( sizeof( ucRequestMemory ), ucRequestMemory, &xRequestArenaStruct );
+	vTaskSetArena( NULL, xArena );
+
+	for( ;; )
+	{
+		// Wait for a request, then allocate whatever handling it needs.
+		pcHeader = pvArenaAllocFromTask( 64 );
+		pucBody = pvArenaAllocFromTask( 512 );
+
+		// ... Handle the request.
+
+		// Release everything allocated for this request at once.
+		vArenaReset( xArena );
+	}
+}
+
+</pre>
+ * \defgroup xArenaCreateStatic xArenaCreateStatic
+ * \ingroup ArenaManagement
+ */
+ArenaHandle_t xArenaCreateStatic( size_t xSizeBytes,
+								  uint8_t * const pucArenaStorageArea,
+								  StaticArena_t * const pxStaticArena ) PRIVILEGED_FUNCTION;
+
+/**
+ * arena.h
+ *
+<pre>
+void vArenaDelete( ArenaHandle_t xArena );
+</pre>
+ *
+ * Deletes an arena that was previously created using a call to xArenaCreate()
+ * or xArenaCreateStatic().  If the arena was created using dynamic memory then
+ * the memory is freed.  Any memory allocated from the arena must no longer be
+ * in use.
+ *
+ * An arena attached to a task is deleted automatically when the task is
+ * deleted, and must not be deleted by the application.
+ *
+ * \defgroup vArenaDelete vArenaDelete
+ * \ingroup ArenaManagement
+ */
+void vArenaDelete( ArenaHandle_t xArena ) PRIVILEGED_FUNCTION;
+
+/**
+ * arena.h
+ *
+<pre>
+void *pvArenaAlloc( ArenaHandle_t xArena, size_t xWantedSize );
+</pre>
+ *
+ * Allocates xWantedSize bytes from the arena.  The memory is aligned to
+ * portBYTE_ALIGNMENT and stays allocated until the arena is reset, rolled back
+ * to a mark taken before the allocation, or deleted.
+ *
+ * @return A pointer to the allocated memory, or NULL if xWantedSize is 0 or
+ * there is not enough space left in the arena.
+ *
+ * \defgroup pvArenaAlloc pvArenaAlloc
+ * \ingroup ArenaManagement
+ */
+void *pvArenaAlloc( ArenaHandle_t xArena, size_t xWantedSize ) PRIVILEGED_FUNCTION;
+
+/**
+ * arena.h
+ *
+<pre>
+void *pvArenaAllocFromTask( size_t xWantedSize );
+</pre>
+ *
+ * As pvArenaAlloc(), but allocates from the arena attached to the calling
+ * task by vTaskSetArena().
+ *
+ * @return A pointer to the allocated memory, or NULL if the calling task has
+ * no arena or its arena does not have enough space left.
+ *
+ * \defgroup pvArenaAllocFromTask pvArenaAllocFromTask
+ * \ingroup ArenaManagement
+ */
+void *pvArenaAllocFromTask( size_t xWantedSize ) PRIVILEGED_FUNCTION;
+
+/**
+ * arena.h
+ *
+<pre>
+size_t xArenaGetMark( ArenaHandle_t xArena );
+void vArenaRollback( ArenaHandle_t xArena, size_t xMark );
+</pre>
+ *
+ * xArenaGetMark() records how much of the arena is in use.  Passing the
+ * returned mark to vArenaRollback() later releases everything allocated
+ * after the mark was taken, and keeps everything allocated before it.  Marks
+ * can be nested, and must be rolled back in the reverse order to the one in
+ * which they were taken.
+ *
+ * \defgroup xArenaGetMark xArenaGetMark
+ * \ingroup ArenaManagement
+ */
+size_t xArenaGetMark( ArenaHandle_t xArena ) PRIVILEGED_FUNCTION;
+void vArenaRollback( ArenaHandle_t xArena, size_t xMark ) PRIVILEGED_FUNCTION;
+
+/**
+ * arena.h
+ *
+<pre>
+void vArenaReset( ArenaHandle_t xArena );
+</pre>
+ *
+ * Releases everything allocated from the arena.
+ *
+ * \defgroup vArenaReset vArenaReset
+ * \ingroup ArenaManagement
+ */
+void vArenaReset( ArenaHandle_t xArena ) PRIVILEGED_FUNCTION;
+
+/**
+ * arena.h
+ *
+<pre>
+void vArenaGetStats( ArenaHandle_t xArena, ArenaStats_t *pxArenaStats );
+</pre>
+ *
+ * Fills pxArenaStats with the size, current use, high water mark and
+ * allocation counts of the arena.  The high water mark shows how large the
+ * arena needs to be for the application's worst case.
+ *
+ * \defgroup vArenaGetStats vArenaGetStats
+ * \ingroup ArenaManagement
+ */
+void vArenaGetStats( ArenaHandle_t xArena, ArenaStats_t *pxArenaStats ) PRIVILEGED_FUNCTION;
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif	/* !defined( ARENA_H ) */
@@ -137,25 +137,48 @@ use of FreeRTOS.*/
  * Definition of the only type of object that a list can contain.
  */
 struct xLIST;
-struct xLIST_ITEM
-{
-	listFIRST_LIST_ITEM_INTEGRITY_CHECK_VALUE			/*< Set to a known value if configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES is set to 1. */
-	configLIST_VOLATILE TickType_t xItemValue;			/*< The value being listed.  In most cases this is used to sort the list in descending order. */
-	struct xLIST_ITEM * configLIST_VOLATILE pxNext;		/*< Pointer to the next ListItem_t in the list. */
-	struct xLIST_ITEM * configLIST_VOLATILE pxPrevious;	/*< Pointer to the previous ListItem_t in the list. */
-	void * pvOwner;										/*< Pointer to the object (normally a TCB) that contains the list item.  There is therefore a two way link between the object containing the list item and the list item itself. */
-	struct xLIST * configLIST_VOLATILE pxContainer;		/*< Pointer to the list in which this list item is placed (if any). */
-	listSECOND_LIST_ITEM_INTEGRITY_CHECK_VALUE			/*< Set to a known value if configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES is set to 1. */
-};
+#if( configUSE_COMPACT_LIST_ITEMS == 1 )
+	/* The compact item has no owner pointer, the owner is found from the
+	item's offset within it (see listGET_LIST_ITEM_OWNER_OF_TYPE()).  The
+	links come first so the list end, which has no item value, can share
+	them. */
+	struct xLIST_ITEM
+	{
+		listFIRST_LIST_ITEM_INTEGRITY_CHECK_VALUE			/*< Set to a known value if configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES is set to 1. */
+		struct xLIST_ITEM * configLIST_VOLATILE pxNext;		/*< Pointer to the next ListItem_t in the list. */
+		struct xLIST_ITEM * configLIST_VOLATILE pxPrevious;	/*< Pointer to the previous ListItem_t in the list. */
+		configLIST_VOLATILE TickType_t xItemValue;			/*< The value being listed.  In most cases this is used to sort the list in descending order. */
+		struct xLIST * configLIST_VOLATILE pxContainer;		/*< Pointer to the list in which this list item is placed (if any). */
+		listSECOND_LIST_ITEM_INTEGRITY_CHECK_VALUE			/*< Set to a known value if configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES is set to 1. */
+	};
+
+	struct xMINI_LIST_ITEM
+	{
+		listFIRST_LIST_ITEM_INTEGRITY_CHECK_VALUE			/*< Set to a known value if configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES is set to 1. */
+		struct xLIST_ITEM * configLIST_VOLATILE pxNext;
+		struct xLIST_ITEM * configLIST_VOLATILE pxPrevious;
+	};
+#else
+	struct xLIST_ITEM
+	{
+		listFIRST_LIST_ITEM_INTEGRITY_CHECK_VALUE			/*< Set to a known value if configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES is set to 1. */
+		configLIST_VOLATILE TickType_t xItemValue;			/*< The value being listed.  In most cases this is used to sort the list in descending order. */
+		struct xLIST_ITEM * configLIST_VOLATILE pxNext;		/*< Pointer to the next ListItem_t in the list. */
+		struct xLIST_ITEM * configLIST_VOLATILE pxPrevious;	/*< Pointer to the previous ListItem_t in the list. */
+		void * pvOwner;										/*< Pointer to the object (normally a TCB) that contains the list item.  There is therefore a two way link between the object containing the list item and the list item itself. */
+		struct xLIST * configLIST_VOLATILE pxContainer;		/*< Pointer to the list in which this list item is placed (if any). */
+		listSECOND_LIST_ITEM_INTEGRITY_CHECK_VALUE			/*< Set to a known value if configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES is set to 1. */
+	};
+
+	struct xMINI_LIST_ITEM
+	{
+		listFIRST_LIST_ITEM_INTEGRITY_CHECK_VALUE			/*< Set to a known value if configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES is set to 1. */
+		configLIST_VOLATILE TickType_t xItemValue;
+		struct xLIST_ITEM * configLIST_VOLATILE pxNext;
+		struct xLIST_ITEM * configLIST_VOLATILE pxPrevious;
+	};
+#endif /* configUSE_COMPACT_LIST_ITEMS */
 typedef struct xLIST_ITEM ListItem_t;					/* For some reason lint wants this as two separate definitions. */
-
-struct xMINI_LIST_ITEM
-{
-	listFIRST_LIST_ITEM_INTEGRITY_CHECK_VALUE			/*< Set to a known value if configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES is set to 1. */
-	configLIST_VOLATILE TickType_t xItemValue;
-	struct xLIST_ITEM * configLIST_VOLATILE pxNext;
-	struct xLIST_ITEM * configLIST_VOLATILE pxPrevious;
-};
 typedef struct xMINI_LIST_ITEM MiniListItem_t;
 
 /*
@@ -177,16 +200,40 @@ typedef struct xLIST
  * \page listSET_LIST_ITEM_OWNER listSET_LIST_ITEM_OWNER
  * \ingroup LinkedList
  */
-#define listSET_LIST_ITEM_OWNER( pxListItem, pxOwner )		( ( pxListItem )->pvOwner = ( void * ) ( pxOwner ) )
+#if( configUSE_COMPACT_LIST_ITEMS == 1 )
+	#define listSET_LIST_ITEM_OWNER( pxListItem, pxOwner )
+#else
+	#define listSET_LIST_ITEM_OWNER( pxListItem, pxOwner )		( ( pxListItem )->pvOwner = ( void * ) ( pxOwner ) )
+#endif
 
 /*
  * Access macro to get the owner of a list item.  The owner of a list item
  * is the object (usually a TCB) that contains the list item.
  *
+ * Not available when configUSE_COMPACT_LIST_ITEMS is 1, use
+ * listGET_LIST_ITEM_OWNER_OF_TYPE() instead.
+ *
  * \page listGET_LIST_ITEM_OWNER listSET_LIST_ITEM_OWNER
  * \ingroup LinkedList
  */
-#define listGET_LIST_ITEM_OWNER( pxListItem )	( ( pxListItem )->pvOwner )
+#if( configUSE_COMPACT_LIST_ITEMS == 0 )
+	#define listGET_LIST_ITEM_OWNER( pxListItem )	( ( pxListItem )->pvOwner )
+#endif
+
+/*
+ * Access macro to get the owner of a list item, given the type of the owner
+ * and the name of the list item member within it.  With compact list items
+ * the owner address is worked out from the member offset, otherwise the owner
+ * pointer is read.
+ *
+ * \page listGET_LIST_ITEM_OWNER_OF_TYPE listGET_LIST_ITEM_OWNER_OF_TYPE
+ * \ingroup LinkedList
+ */
+#if( configUSE_COMPACT_LIST_ITEMS == 1 )
+	#define listGET_LIST_ITEM_OWNER_OF_TYPE( pxListItem, xType, xMember )	( ( xType * ) ( void * ) ( ( ( uint8_t * ) ( pxListItem ) ) - offsetof( xType, xMember ) ) )
+#else
+	#define listGET_LIST_ITEM_OWNER_OF_TYPE( pxListItem, xType, xMember )	( ( xType * ) listGET_LIST_ITEM_OWNER( pxListItem ) )
+#endif
 
 /*
  * Access macro to set the value of the list item.  In most cases the value is
@@ -274,7 +321,30 @@ typedef struct xLIST
  * \page listGET_OWNER_OF_NEXT_ENTRY listGET_OWNER_OF_NEXT_ENTRY
  * \ingroup LinkedList
  */
-#define listGET_OWNER_OF_NEXT_ENTRY( pxTCB, pxList )										\
+#if( configUSE_COMPACT_LIST_ITEMS == 0 )
+	#define listGET_OWNER_OF_NEXT_ENTRY( pxTCB, pxList )										\
+	{																							\
+	List_t * const pxConstList = ( pxList );													\
+		/* Increment the index to the next item and return the item, ensuring */				\
+		/* we don't return the marker used at the end of the list.  */							\
+		( pxConstList )->pxIndex = ( pxConstList )->pxIndex->pxNext;							\
+		if( ( void * ) ( pxConstList )->pxIndex == ( void * ) &( ( pxConstList )->xListEnd ) )	\
+		{																						\
+			( pxConstList )->pxIndex = ( pxConstList )->pxIndex->pxNext;						\
+		}																						\
+		( pxTCB ) = ( pxConstList )->pxIndex->pvOwner;											\
+	}
+#endif
+
+/*
+ * As listGET_OWNER_OF_NEXT_ENTRY(), but also given the type of the owner and
+ * the name of the list item member within it so it works with compact list
+ * items.
+ *
+ * \page listGET_OWNER_OF_NEXT_ENTRY_OF_TYPE listGET_OWNER_OF_NEXT_ENTRY_OF_TYPE
+ * \ingroup LinkedList
+ */
+#define listGET_OWNER_OF_NEXT_ENTRY_OF_TYPE( pxOwner, pxList, xType, xMember )				\
 {																							\
 List_t * const pxConstList = ( pxList );													\
 	/* Increment the index to the next item and return the item, ensuring */				\
@@ -284,7 +354,7 @@ List_t * const pxConstList = ( pxList );													\
 	{																						\
 		( pxConstList )->pxIndex = ( pxConstList )->pxIndex->pxNext;						\
 	}																						\
-	( pxTCB ) = ( pxConstList )->pxIndex->pvOwner;											\
+	( pxOwner ) = listGET_LIST_ITEM_OWNER_OF_TYPE( ( pxConstList )->pxIndex, xType, xMember );	\
 }
 
 
@@ -304,7 +374,19 @@ List_t * const pxConstList = ( pxList );													\
  * \page listGET_OWNER_OF_HEAD_ENTRY listGET_OWNER_OF_HEAD_ENTRY
  * \ingroup LinkedList
  */
-#define listGET_OWNER_OF_HEAD_ENTRY( pxList )  ( (&( ( pxList )->xListEnd ))->pxNext->pvOwner )
+#if( configUSE_COMPACT_LIST_ITEMS == 0 )
+	#define listGET_OWNER_OF_HEAD_ENTRY( pxList )  ( (&( ( pxList )->xListEnd ))->pxNext->pvOwner )
+#endif
+
+/*
+ * As listGET_OWNER_OF_HEAD_ENTRY(), but also given the type of the owner and
+ * the name of the list item member within it so it works with compact list
+ * items.
+ *
+ * \page listGET_OWNER_OF_HEAD_ENTRY_OF_TYPE listGET_OWNER_OF_HEAD_ENTRY_OF_TYPE
+ * \ingroup LinkedList
+ */
+#define listGET_OWNER_OF_HEAD_ENTRY_OF_TYPE( pxList, xType, xMember )  listGET_LIST_ITEM_OWNER_OF_TYPE( ( pxList )->xListEnd.pxNext, xType, xMember )
 
 /*
  * Check to see if a list item is within a list.  The list item maintains a
@@ -325,12 +407,39 @@ List_t * const pxConstList = ( pxList );													\
  */
 #define listLIST_ITEM_CONTAINER( pxListItem ) ( ( pxListItem )->pxContainer )
 
+/*
+ * Initialisers that build a list at compile time, as used by the kernel image
+ * (configUSE_KERNEL_IMAGE).  The list end of xList is named with
+ * listSTATIC_END_MARKER().  pxOwner is not stored when
+ * configUSE_COMPACT_LIST_ITEMS is 1.
+ */
+#if( configUSE_COMPACT_LIST_ITEMS == 1 )
+	#define listSTATIC_LIST_ITEM( xValue, pxOwner, pxNextItem, pxPreviousItem, pxList )	\
+		{ .pxNext = ( pxNextItem ), .pxPrevious = ( pxPreviousItem ), .xItemValue = ( xValue ), .pxContainer = ( pxList ) }
+	#define listSTATIC_LIST_END( pxFirstItem, pxLastItem )	\
+		{ .pxNext = ( pxFirstItem ), .pxPrevious = ( pxLastItem ) }
+#else
+	#define listSTATIC_LIST_ITEM( xValue, pxOwner, pxNextItem, pxPreviousItem, pxList )	\
+		{ .xItemValue = ( xValue ), .pxNext = ( pxNextItem ), .pxPrevious = ( pxPreviousItem ), .pvOwner = ( void * ) ( pxOwner ), .pxContainer = ( pxList ) }
+	#define listSTATIC_LIST_END( pxFirstItem, pxLastItem )	\
+		{ .xItemValue = portMAX_DELAY, .pxNext = ( pxFirstItem ), .pxPrevious = ( pxLastItem ) }
+#endif
+#define listSTATIC_END_MARKER( xList )	( ( ListItem_t * ) &( ( xList ).xListEnd ) )
+#define listSTATIC_LIST( xList, uxItems, pxFirstItem, pxLastItem )	\
+	{ .uxNumberOfItems = ( uxItems ), .pxIndex = listSTATIC_END_MARKER( xList ), .xListEnd = listSTATIC_LIST_END( ( pxFirstItem ), ( pxLastItem ) ) }
+#define listSTATIC_EMPTY_LIST( xList )	listSTATIC_LIST( xList, 0U, listSTATIC_END_MARKER( xList ), listSTATIC_END_MARKER( xList ) )
+
 /*
  * This provides a crude means of knowing if a list has been initialised, as
  * pxList->xListEnd.xItemValue is set to portMAX_DELAY by the vListInitialise()
- * function.
+ * function.  The compact list end has no item value, but its next pointer is
+ * never NULL once initialised.
  */
-#define listLIST_IS_INITIALISED( pxList ) ( ( pxList )->xListEnd.xItemValue == portMAX_DELAY )
+#if( configUSE_COMPACT_LIST_ITEMS == 1 )
+	#define listLIST_IS_INITIALISED( pxList ) ( ( pxList )->xListEnd.pxNext != NULL )
+#else
+	#define listLIST_IS_INITIALISED( pxList ) ( ( pxList )->xListEnd.xItemValue == portMAX_DELAY )
+#endif
 
 /*
  * Must be called before a list is used!  This initialises all the members
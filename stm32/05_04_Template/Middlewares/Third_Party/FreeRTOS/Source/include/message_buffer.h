@@ -306,6 +306,44 @@ const TickType_t x100ms = pdMS_TO_TICKS( 100 );
  */
 #define xMessageBufferSend( xMessageBuffer, pvTxData, xDataLengthBytes, xTicksToWait ) xStreamBufferSend( ( StreamBufferHandle_t ) xMessageBuffer, pvTxData, xDataLengthBytes, xTicksToWait )
 
+/**
+ * message_buffer.h
+ *
+<pre>
+size_t xMessageBufferSendV( MessageBufferHandle_t xMessageBuffer,
+                            const StreamBufferSegment_t * const pxSegments,
+                            UBaseType_t uxSegmentCount,
+                            TickType_t xTicksToWait );
+</pre>
+ *
+ * Sends one discrete message made up of several separate buffers (a gather
+ * list) - for example a header, a payload and a trailer.  The segments are
+ * copied straight into the message buffer one after the other, and are
+ * received as a single message whose length is the total of the segment
+ * lengths.  No temporary buffer is needed to assemble the message first.
+ *
+ * Behaves exactly as xMessageBufferSend() in all other respects, including
+ * the restriction to a single writer.  See xStreamBufferSendV() for an
+ * example.
+ *
+ * @param xMessageBuffer The handle of the message buffer to which a message is
+ * being sent.
+ *
+ * @param pxSegments An array of uxSegmentCount segments that together form
+ * the message.
+ *
+ * @param uxSegmentCount The number of segments in pxSegments.
+ *
+ * @param xTicksToWait As for xMessageBufferSend().
+ *
+ * @return The total length of the message written, or 0 if there was not
+ * enough space for the whole message.
+ *
+ * \defgroup xMessageBufferSendV xMessageBufferSendV
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferSendV( xMessageBuffer, pxSegments, uxSegmentCount, xTicksToWait ) xStreamBufferSendV( ( StreamBufferHandle_t ) xMessageBuffer, pxSegments, uxSegmentCount, xTicksToWait )
+
 /**
  * message_buffer.h
  *
@@ -498,6 +536,40 @@ const TickType_t xBlockTime = pdMS_TO_TICKS( 20 );
  */
 #define xMessageBufferReceive( xMessageBuffer, pvRxData, xBufferLengthBytes, xTicksToWait ) xStreamBufferReceive( ( StreamBufferHandle_t ) xMessageBuffer, pvRxData, xBufferLengthBytes, xTicksToWait )
 
+/**
+ * message_buffer.h
+ *
+<pre>
+size_t xMessageBufferReceiveV( MessageBufferHandle_t xMessageBuffer,
+                               const StreamBufferSegment_t * const pxSegments,
+                               UBaseType_t uxSegmentCount,
+                               TickType_t xTicksToWait );
+</pre>
+ *
+ * Receives the next discrete message into several separate buffers (a
+ * scatter list), filling each segment before moving on to the next - for
+ * example a fixed size header straight into a header structure and the rest
+ * into a payload buffer.  If the message is longer than all the segments
+ * together it is left in the message buffer and 0 is returned, as with
+ * xMessageBufferReceive().
+ *
+ * @param xMessageBuffer The handle of the message buffer from which a message
+ * is being received.
+ *
+ * @param pxSegments An array of uxSegmentCount segments, filled in order.
+ *
+ * @param uxSegmentCount The number of segments in pxSegments.
+ *
+ * @param xTicksToWait As for xMessageBufferReceive().
+ *
+ * @return The length of the message received, which is the number of bytes
+ * written across all the segments, or 0 if no message was received.
+ *
+ * \defgroup xMessageBufferReceiveV xMessageBufferReceiveV
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferReceiveV( xMessageBuffer, pxSegments, uxSegmentCount, xTicksToWait ) xStreamBufferReceiveV( ( StreamBufferHandle_t ) xMessageBuffer, pxSegments, uxSegmentCount, xTicksToWait )
+
 
 /**
  * message_buffer.h
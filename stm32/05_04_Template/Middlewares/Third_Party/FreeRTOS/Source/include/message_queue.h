@@ -0,0 +1,380 @@
+/*
+ * FreeRTOS Kernel V10.3.1
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * Message queues pass variable length messages between any number of tasks
+ * and interrupts.  Like a queue, and unlike a message buffer, a message queue
+ * can have several writers and several readers at the same time, and any
+ * number of tasks can block on it.  Like a message buffer, and unlike a queue,
+ * each message only occupies its own length plus a
+ * sizeof( configMESSAGE_BUFFER_LENGTH_TYPE ) byte header, rather than a fixed
+ * item size.
+ *
+ * Messages are copied in and out of the storage area inside a critical section,
+ * as queue items are, so the length of the longest message bounds the time
+ * interrupts are masked.
+ *
+ * Tasks blocked waiting to receive are unblocked in priority order.  Reading a
+ * message unblocks every task waiting to send, as the space freed might fit a
+ * shorter message but not a longer one.  They try again in priority order, so
+ * a sender whose message fits is never left blocked behind one whose message
+ * does not, and those that still do not fit block again for the rest of their
+ * block time.  The time interrupts are masked for that grows with the number
+ * of tasks waiting to send.
+ *
+ * configUSE_MESSAGE_QUEUES must be set to 1 in FreeRTOSConfig.h for message
+ * queues to be available.
+ */
+
+#ifndef MESSAGE_QUEUE_H
+#define MESSAGE_QUEUE_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include message_queue.h"
+#endif
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/**
+ * Type by which message queues are referenced.  For example, a call to
+ * xMessageQueueCreate() returns a MessageQueueHandle_t variable that can then
+ * be used as a parameter to xMessageQueueSend(), xMessageQueueReceive(), etc.
+ */
+struct MessageQueueDef_t;
+typedef struct MessageQueueDef_t * MessageQueueHandle_t;
+
+/**
+ * The number of bytes of storage needed to hold uxMessages messages of
+ * xMessageLengthBytes each, including the length header stored with every
+ * message.  Use it to size the storage area passed to xMessageQueueCreate()
+ * or xMessageQueueCreateStatic().
+ */
+#define mqSTORAGE_BYTES( uxMessages, xMessageLengthBytes ) ( ( size_t ) ( uxMessages ) * ( ( size_t ) ( xMessageLengthBytes ) + sizeof( configMESSAGE_BUFFER_LENGTH_TYPE ) ) )
+
+/**
+ * message_queue.h
+ *
+<pre>
+MessageQueueHandle_t xMessageQueueCreate( size_t xStorageSizeBytes );
+</pre>
+ *
+ * Creates a new message queue using dynamically allocated memory.  See
+ * xMessageQueueCreateStatic() for a version that uses statically allocated
+ * memory.
+ *
+ * configSUPPORT_DYNAMIC_ALLOCATION must be set to 1 or left undefined in
+ * FreeRTOSConfig.h for xMessageQueueCreate() to be available.
+ *
+ * @param xStorageSizeBytes The number of bytes of message storage.  Each
+ * message uses its own length plus sizeof( configMESSAGE_BUFFER_LENGTH_TYPE )
+ * bytes - see mqSTORAGE_BYTES().  The storage must be large enough to hold the
+ * longest message that will ever be sent.
+ *
+ * @return The handle of the created message queue, or NULL if there was not
+ * enough heap memory available to create it.
+ *
+ * \defgroup xMessageQueueCreate xMessageQueueCreate
+ * \ingroup MessageQueueManagement
+ */
+MessageQueueHandle_t xMessageQueueCreate( size_t xStorageSizeBytes ) PRIVILEGED_FUNCTION;
+
+/**
+ * message_queue.h
+ *
+<pre>
+MessageQueueHandle_t xMessageQueueCreateStatic( size_t xStorageSizeBytes,
+                                                uint8_t *pucMessageQueueStorageArea,
+                                                StaticMessageQueue_t *pxStaticMessageQueue );
+</pre>
+ *
+ * Creates a new message queue using statically allocated memory.
+ *
+ * configSUPPORT_STATIC_ALLOCATION must be set to 1 in FreeRTOSConfig.h for
+ * xMessageQueueCreateStatic() to be available.
+ *
+ * @param xStorageSizeBytes The size, in bytes, of the buffer pointed to by
+ * pucMessageQueueStorageArea.
+ *
+ * @param pucMessageQueueStorageArea Must point to a uint8_t array that is at
+ * least xStorageSizeBytes big.  Messages are copied into this array.
+ *
+ * @param pxStaticMessageQueue Must point to a variable of type
+ * StaticMessageQueue_t, which will be used to hold the message queue's data
+ * structure.
+ *
+ * @return The handle of the created message queue, or NULL if either
+ * pucMessageQueueStorageArea or pxStaticMessageQueue is NULL.
+ *
+ * Example use:
+<pre>
+
+// Room for eight messages of up to 60 bytes, or fewer longer ones.
+#define STORAGE_SIZE_BYTES mqSTORAGE_BYTES( 8, 60 )
+
+static uint8_t ucStorageBuffer[ STORAGE_SIZE_BYTES ];
+static StaticMessageQueue_t xMessageQueueStruct;
+
+void MyFunction( void )
+{
+MessageQueueHandle_t xMessageQueue;
+
+    xMessageQueue = xMessageQueueCreateStatic( sizeof( ucStorageBuffer ),
+                                               ucStorageBuffer,
+                                               &xMessageQueueStruct );
+
+    // Neither parameter was NULL, so xMessageQueue will not be NULL and can be
+    // used by any number of senders and receivers.
+}
+</pre>
+ * \defgroup xMessageQueueCreateStatic xMessageQueueCreateStatic
+ * \ingroup MessageQueueManagement
+ */
+MessageQueueHandle_t xMessageQueueCreateStatic( size_t xStorageSizeBytes,
+												uint8_t * const pucMessageQueueStorageArea,
+												StaticMessageQueue_t * const pxStaticMessageQueue ) PRIVILEGED_FUNCTION;
+
+/**
+ * message_queue.h
+ *
+<pre>
+void vMessageQueueDelete( MessageQueueHandle_t xMessageQueue );
+</pre>
+ *
+ * Deletes a message queue that was previously created using a call to
+ * xMessageQueueCreate() or xMessageQueueCreateStatic().  If the message queue
+ * was created using dynamic memory then the memory is freed.
+ *
+ * A message queue must not be deleted while tasks are blocked on it.
+ *
+ * @param xMessageQueue The handle of the message queue to be deleted.
+ *
+ * \defgroup vMessageQueueDelete vMessageQueueDelete
+ * \ingroup MessageQueueManagement
+ */
+void vMessageQueueDelete( MessageQueueHandle_t xMessageQueue ) PRIVILEGED_FUNCTION;
+
+/**
+ * message_queue.h
+ *
+<pre>
+BaseType_t xMessageQueueSend( MessageQueueHandle_t xMessageQueue,
+                              const void *pvTxData,
+                              size_t xDataLengthBytes,
+                              TickType_t xTicksToWait );
+</pre>
+ *
+ * Sends a discrete message to the message queue.  The message is copied into
+ * the queue.  Any number of tasks can send to the same message queue at once.
+ *
+ * Use xMessageQueueSendFromISR() to send from an interrupt service routine.
+ *
+ * @param xMessageQueue The handle of the message queue to which a message is
+ * being sent.
+ *
+ * @param pvTxData A pointer to the message that is to be copied into the
+ * message queue.
+ *
+ * @param xDataLengthBytes The length of the message, in bytes.  Must be
+ * greater than 0, and the message plus its length header must fit in the
+ * message queue's storage area.
+ *
+ * @param xTicksToWait The maximum amount of time the calling task should
+ * remain in the Blocked state to wait for enough space to become available in
+ * the message queue.  Setting xTicksToWait to portMAX_DELAY will cause the
+ * task to wait indefinitely (without timing out), provided
+ * INCLUDE_vTaskSuspend is set to 1 in FreeRTOSConfig.h.
+ *
+ * @return pdPASS if the message was sent, otherwise errQUEUE_FULL.
+ *
+ * \defgroup xMessageQueueSend xMessageQueueSend
+ * \ingroup MessageQueueManagement
+ */
+BaseType_t xMessageQueueSend( MessageQueueHandle_t xMessageQueue,
+							  const void *pvTxData,
+							  size_t xDataLengthBytes,
+							  TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * message_queue.h
+ *
+<pre>
+BaseType_t xMessageQueueSendFromISR( MessageQueueHandle_t xMessageQueue,
+                                     const void *pvTxData,
+                                     size_t xDataLengthBytes,
+                                     BaseType_t *pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * Interrupt safe version of the API function that sends a discrete message to
+ * the message queue.
+ *
+ * @param xMessageQueue The handle of the message queue to which a message is
+ * being sent.
+ *
+ * @param pvTxData A pointer to the message that is to be copied into the
+ * message queue.
+ *
+ * @param xDataLengthBytes The length of the message, in bytes.
+ *
+ * @param pxHigherPriorityTaskWoken If sending the message unblocks a task
+ * that has a priority above the currently executing task then
+ * *pxHigherPriorityTaskWoken is set to pdTRUE, and a context switch should be
+ * requested before the interrupt is exited.  Can be NULL.
+ *
+ * @return pdPASS if the message was sent, otherwise errQUEUE_FULL.
+ *
+ * \defgroup xMessageQueueSendFromISR xMessageQueueSendFromISR
+ * \ingroup MessageQueueManagement
+ */
+BaseType_t xMessageQueueSendFromISR( MessageQueueHandle_t xMessageQueue,
+									 const void *pvTxData,
+									 size_t xDataLengthBytes,
+									 BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * message_queue.h
+ *
+<pre>
+size_t xMessageQueueReceive( MessageQueueHandle_t xMessageQueue,
+                             void *pvRxData,
+                             size_t xBufferLengthBytes,
+                             TickType_t xTicksToWait );
+</pre>
+ *
+ * Receives the oldest message from the message queue.  Any number of tasks
+ * can receive from the same message queue at once; each message is received
+ * by exactly one of them.
+ *
+ * Use xMessageQueueReceiveFromISR() to receive from an interrupt service
+ * routine.
+ *
+ * @param xMessageQueue The handle of the message queue from which a message
+ * is being received.
+ *
+ * @param pvRxData A pointer to the buffer into which the received message is
+ * to be copied.
+ *
+ * @param xBufferLengthBytes The length of the buffer pointed to by pvRxData.
+ * If the next message is longer than this then it is left in the message
+ * queue and 0 is returned straight away, without blocking.
+ * xMessageQueueNextLengthBytes() returns the length of the next message.
+ *
+ * @param xTicksToWait The maximum amount of time the task should remain in
+ * the Blocked state to wait for a message, should the message queue be empty.
+ *
+ * @return The length, in bytes, of the message copied into pvRxData, or 0 if
+ * no message was received.
+ *
+ * \defgroup xMessageQueueReceive xMessageQueueReceive
+ * \ingroup MessageQueueManagement
+ */
+size_t xMessageQueueReceive( MessageQueueHandle_t xMessageQueue,
+							 void *pvRxData,
+							 size_t xBufferLengthBytes,
+							 TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * message_queue.h
+ *
+<pre>
+size_t xMessageQueueReceiveFromISR( MessageQueueHandle_t xMessageQueue,
+                                    void *pvRxData,
+                                    size_t xBufferLengthBytes,
+                                    BaseType_t *pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * An interrupt safe version of the API function that receives a discrete
+ * message from the message queue.
+ *
+ * @param pxHigherPriorityTaskWoken If removing the message unblocks a sending
+ * task that has a priority above the currently executing task then
+ * *pxHigherPriorityTaskWoken is set to pdTRUE, and a context switch should be
+ * requested before the interrupt is exited.  Can be NULL.
+ *
+ * @return The length, in bytes, of the message copied into pvRxData, or 0 if
+ * no message was received.
+ *
+ * \defgroup xMessageQueueReceiveFromISR xMessageQueueReceiveFromISR
+ * \ingroup MessageQueueManagement
+ */
+size_t xMessageQueueReceiveFromISR( MessageQueueHandle_t xMessageQueue,
+									void *pvRxData,
+									size_t xBufferLengthBytes,
+									BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * message_queue.h
+ *
+<pre>
+size_t xMessageQueueNextLengthBytes( MessageQueueHandle_t xMessageQueue );
+</pre>
+ *
+ * Returns the length, in bytes, of the next message in the message queue, or
+ * 0 if the message queue is empty.  Another receiver can take the message
+ * before the caller does.
+ *
+ * \defgroup xMessageQueueNextLengthBytes xMessageQueueNextLengthBytes
+ * \ingroup MessageQueueManagement
+ */
+size_t xMessageQueueNextLengthBytes( MessageQueueHandle_t xMessageQueue ) PRIVILEGED_FUNCTION;
+
+/**
+ * message_queue.h
+ *
+<pre>
+UBaseType_t uxMessageQueueMessagesWaiting( MessageQueueHandle_t xMessageQueue );
+</pre>
+ *
+ * Returns the number of messages stored in the message queue.
+ *
+ * \defgroup uxMessageQueueMessagesWaiting uxMessageQueueMessagesWaiting
+ * \ingroup MessageQueueManagement
+ */
+UBaseType_t uxMessageQueueMessagesWaiting( MessageQueueHandle_t xMessageQueue ) PRIVILEGED_FUNCTION;
+
+/**
+ * message_queue.h
+ *
+<pre>
+size_t xMessageQueueSpacesAvailable( MessageQueueHandle_t xMessageQueue );
+</pre>
+ *
+ * Returns the length of the longest message that could be sent to the
+ * message queue without blocking, which is the free storage minus one length
+ * header, or 0 if not even a one byte message would fit.
+ *
+ * \defgroup xMessageQueueSpacesAvailable xMessageQueueSpacesAvailable
+ * \ingroup MessageQueueManagement
+ */
+size_t xMessageQueueSpacesAvailable( MessageQueueHandle_t xMessageQueue ) PRIVILEGED_FUNCTION;
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif	/* !defined( MESSAGE_QUEUE_H ) */
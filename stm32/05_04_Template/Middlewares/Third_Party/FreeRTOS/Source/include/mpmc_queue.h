@@ -0,0 +1,312 @@
+/*
+ * FreeRTOS Kernel V10.3.1
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * MPMC queues pass fixed size items between any number of tasks and
+ * interrupts, like queues, but send and receive do not enter a critical
+ * section unless they have to block or wake a task.  The items are held in a
+ * ring of cells, each tagged with a sequence number that says whether the cell
+ * is ready to be written or read on the current lap of the ring.  A sender
+ * claims the next cell to write, and a receiver the next cell to read, with one
+ * compare-and-swap on a position counter.  The two counters are kept on
+ * separate cache lines, so on a multi-core part the senders and the receivers
+ * do not contend for the same line, and neither contends for the kernel lock.
+ *
+ * The kernel is only entered when a sender finds the queue full or a receiver
+ * finds it empty, and when an item is sent while receivers are blocked (or
+ * received while senders are blocked).  Blocked tasks wait on priority ordered
+ * event lists and block times behave the same as in queue.c.
+ *
+ * An MPMC queue does not support queue sets, peeking, overwriting or sending
+ * to the front.  Items are claimed in FIFO order, but a receiver that claims a
+ * cell whose sender has not finished copying into it reports the queue empty
+ * rather than wait, so under contention an item can become visible a moment
+ * after a later one.
+ *
+ * The implementation uses the GCC __atomic builtins, which GCC, Clang and
+ * armclang provide for every target this kernel supports.
+ *
+ * configUSE_MPMC_QUEUES must be set to 1 in FreeRTOSConfig.h for MPMC queues
+ * to be available.
+ */
+
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include mpmc_queue.h"
+#endif
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/**
+ * Type by which MPMC queues are referenced.  For example, a call to
+ * xMpmcQueueCreate() returns an MpmcQueueHandle_t variable that can then be
+ * used as a parameter to xMpmcQueueSend(), xMpmcQueueReceive(), etc.
+ */
+struct MpmcQueueDef_t;
+typedef struct MpmcQueueDef_t * MpmcQueueHandle_t;
+
+/**
+ * The number of size_t words of storage needed for a queue of uxLength items
+ * of uxItemSize bytes each.  Each item is stored with a size_t sequence number
+ * and padded to a whole number of words.  Use it to size the storage area
+ * passed to xMpmcQueueCreateStatic().
+ */
+#define mpmcCELL_WORDS( uxItemSize ) ( ( ( size_t ) ( uxItemSize ) + ( 2U * sizeof( size_t ) ) - 1U ) / sizeof( size_t ) )
+#define mpmcSTORAGE_WORDS( uxLength, uxItemSize ) ( ( size_t ) ( uxLength ) * mpmcCELL_WORDS( uxItemSize ) )
+
+/**
+ * mpmc_queue.h
+ *
+<pre>
+MpmcQueueHandle_t xMpmcQueueCreate( UBaseType_t uxLength, UBaseType_t uxItemSize );
+</pre>
+ *
+ * Creates a new MPMC queue using dynamically allocated memory.  See
+ * xMpmcQueueCreateStatic() for a version that uses statically allocated
+ * memory.
+ *
+ * configSUPPORT_DYNAMIC_ALLOCATION must be set to 1 or left undefined in
+ * FreeRTOSConfig.h for xMpmcQueueCreate() to be available.
+ *
+ * @param uxLength The maximum number of items the queue can hold.  Must be a
+ * power of two, and at least 2.
+ *
+ * @param uxItemSize The size, in bytes, of each item.  Must be greater than 0.
+ *
+ * @return The handle of the created queue, or NULL if there was not enough
+ * heap memory available to create it.
+ *
+ * \defgroup xMpmcQueueCreate xMpmcQueueCreate
+ * \ingroup MpmcQueueManagement
+ */
+MpmcQueueHandle_t xMpmcQueueCreate( UBaseType_t uxLength, UBaseType_t uxItemSize ) PRIVILEGED_FUNCTION;
+
+/**
+ * mpmc_queue.h
+ *
+<pre>
+MpmcQueueHandle_t xMpmcQueueCreateStatic( UBaseType_t uxLength,
+                                          UBaseType_t uxItemSize,
+                                          size_t *puxStorageArea,
+                                          StaticMpmcQueue_t *pxStaticMpmcQueue );
+</pre>
+ *
+ * Creates a new MPMC queue using statically allocated memory.
+ *
+ * configSUPPORT_STATIC_ALLOCATION must be set to 1 in FreeRTOSConfig.h for
+ * xMpmcQueueCreateStatic() to be available.
+ *
+ * @param uxLength The maximum number of items the queue can hold.  Must be a
+ * power of two, and at least 2.
+ *
+ * @param uxItemSize The size, in bytes, of each item.
+ *
+ * @param puxStorageArea Must point to a size_t array of at least
+ * mpmcSTORAGE_WORDS( uxLength, uxItemSize ) elements.
+ *
+ * @param pxStaticMpmcQueue Must point to a variable of type StaticMpmcQueue_t,
+ * which will be used to hold the queue's data structure.  On a part with a
+ * data cache, align it to configMPMC_QUEUE_CACHE_LINE_SIZE so the send and
+ * receive positions each get a cache line of their own.
+ *
+ * @return The handle of the created queue, or NULL if either puxStorageArea or
+ * pxStaticMpmcQueue is NULL.
+ *
+ * Example use:
+<pre>
+
+typedef struct { uint32_t ulId; uint32_t ulValue; } Sample_t;
+
+static size_t uxStorage[ mpmcSTORAGE_WORDS( 16, sizeof( Sample_t ) ) ];
+static StaticMpmcQueue_t xQueueStruct;
+
+void MyFunction( void )
+{
+MpmcQueueHandle_t xQueue;
+
+    xQueue = xMpmcQueueCreateStatic( 16, sizeof( Sample_t ), uxStorage, &xQueueStruct );
+}
+</pre>
+ * \defgroup xMpmcQueueCreateStatic xMpmcQueueCreateStatic
+ * \ingroup MpmcQueueManagement
+ */
+MpmcQueueHandle_t xMpmcQueueCreateStatic( UBaseType_t uxLength,
+										  UBaseType_t uxItemSize,
+										  size_t * const puxStorageArea,
+										  StaticMpmcQueue_t * const pxStaticMpmcQueue ) PRIVILEGED_FUNCTION;
+
+/**
+ * mpmc_queue.h
+ *
+<pre>
+void vMpmcQueueDelete( MpmcQueueHandle_t xQueue );
+</pre>
+ *
+ * Deletes a queue that was previously created using a call to
+ * xMpmcQueueCreate() or xMpmcQueueCreateStatic().  If the queue was created
+ * using dynamic memory then the memory is freed.
+ *
+ * A queue must not be deleted while tasks are blocked on it, or while another
+ * task or interrupt is sending to or receiving from it.
+ *
+ * \defgroup vMpmcQueueDelete vMpmcQueueDelete
+ * \ingroup MpmcQueueManagement
+ */
+void vMpmcQueueDelete( MpmcQueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
+
+/**
+ * mpmc_queue.h
+ *
+<pre>
+BaseType_t xMpmcQueueSend( MpmcQueueHandle_t xQueue,
+                           const void *pvItemToQueue,
+                           TickType_t xTicksToWait );
+</pre>
+ *
+ * Copies an item to the back of the queue.  Any number of tasks can send to
+ * the same queue at once.
+ *
+ * @param xQueue The handle of the queue to which the item is being sent.
+ *
+ * @param pvItemToQueue A pointer to the item to copy into the queue.
+ *
+ * @param xTicksToWait The maximum amount of time the calling task should
+ * remain in the Blocked state to wait for space, should the queue be full.
+ *
+ * @return pdPASS if the item was sent, otherwise errQUEUE_FULL.
+ *
+ * \defgroup xMpmcQueueSend xMpmcQueueSend
+ * \ingroup MpmcQueueManagement
+ */
+BaseType_t xMpmcQueueSend( MpmcQueueHandle_t xQueue,
+						   const void * const pvItemToQueue,
+						   TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * mpmc_queue.h
+ *
+<pre>
+BaseType_t xMpmcQueueSendFromISR( MpmcQueueHandle_t xQueue,
+                                  const void *pvItemToQueue,
+                                  BaseType_t *pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * Interrupt safe version of xMpmcQueueSend().
+ *
+ * @param pxHigherPriorityTaskWoken If sending the item unblocks a task that
+ * has a priority above the currently executing task then
+ * *pxHigherPriorityTaskWoken is set to pdTRUE, and a context switch should be
+ * requested before the interrupt is exited.  Can be NULL.
+ *
+ * @return pdPASS if the item was sent, otherwise errQUEUE_FULL.
+ *
+ * \defgroup xMpmcQueueSendFromISR xMpmcQueueSendFromISR
+ * \ingroup MpmcQueueManagement
+ */
+BaseType_t xMpmcQueueSendFromISR( MpmcQueueHandle_t xQueue,
+								  const void * const pvItemToQueue,
+								  BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * mpmc_queue.h
+ *
+<pre>
+BaseType_t xMpmcQueueReceive( MpmcQueueHandle_t xQueue,
+                              void *pvBuffer,
+                              TickType_t xTicksToWait );
+</pre>
+ *
+ * Copies the item at the front of the queue into pvBuffer and removes it from
+ * the queue.  Any number of tasks can receive from the same queue at once;
+ * each item is received by exactly one of them.
+ *
+ * @param xQueue The handle of the queue from which the item is received.
+ *
+ * @param pvBuffer Pointer to the buffer into which the item will be copied.
+ *
+ * @param xTicksToWait The maximum amount of time the task should remain in
+ * the Blocked state to wait for an item, should the queue be empty.
+ *
+ * @return pdPASS if an item was received, otherwise pdFAIL.
+ *
+ * \defgroup xMpmcQueueReceive xMpmcQueueReceive
+ * \ingroup MpmcQueueManagement
+ */
+BaseType_t xMpmcQueueReceive( MpmcQueueHandle_t xQueue,
+							  void * const pvBuffer,
+							  TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * mpmc_queue.h
+ *
+<pre>
+BaseType_t xMpmcQueueReceiveFromISR( MpmcQueueHandle_t xQueue,
+                                     void *pvBuffer,
+                                     BaseType_t *pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * Interrupt safe version of xMpmcQueueReceive().
+ *
+ * @param pxHigherPriorityTaskWoken If receiving the item unblocks a sending
+ * task that has a priority above the currently executing task then
+ * *pxHigherPriorityTaskWoken is set to pdTRUE, and a context switch should be
+ * requested before the interrupt is exited.  Can be NULL.
+ *
+ * @return pdPASS if an item was received, otherwise pdFAIL.
+ *
+ * \defgroup xMpmcQueueReceiveFromISR xMpmcQueueReceiveFromISR
+ * \ingroup MpmcQueueManagement
+ */
+BaseType_t xMpmcQueueReceiveFromISR( MpmcQueueHandle_t xQueue,
+									 void * const pvBuffer,
+									 BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * mpmc_queue.h
+ *
+<pre>
+UBaseType_t uxMpmcQueueMessagesWaiting( MpmcQueueHandle_t xQueue );
+</pre>
+ *
+ * Returns the number of items claimed by senders and not yet claimed by
+ * receivers.  The value is only a snapshot while other tasks are using the
+ * queue.
+ *
+ * \defgroup uxMpmcQueueMessagesWaiting uxMpmcQueueMessagesWaiting
+ * \ingroup MpmcQueueManagement
+ */
+UBaseType_t uxMpmcQueueMessagesWaiting( MpmcQueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif	/* !defined( MPMC_QUEUE_H ) */
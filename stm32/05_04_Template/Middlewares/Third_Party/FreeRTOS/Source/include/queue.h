@@ -232,6 +232,65 @@ typedef struct QueueDefinition * QueueSetMemberHandle_t;
 	#define xQueueCreateStatic( uxQueueLength, uxItemSize, pucQueueStorage, pxQueueBuffer ) xQueueGenericCreateStatic( ( uxQueueLength ), ( uxItemSize ), ( pucQueueStorage ), ( pxQueueBuffer ), ( queueQUEUE_TYPE_BASE ) )
 #endif /* configSUPPORT_STATIC_ALLOCATION */
 
+/**
+ * queue. h
+ * <pre>
+ QueueHandle_t xQueueCreateOfType(
+							  UBaseType_t uxQueueLength,
+							  xType
+						  );
+
+ QueueHandle_t xQueueCreateStaticOfType(
+							  UBaseType_t uxQueueLength,
+							  xType,
+							  xType *pxQueueStorage,
+							  StaticQueue_t *pxQueueBuffer
+						  );
+ * </pre>
+ *
+ * Typed forms of xQueueCreate() and xQueueCreateStatic().  The item size is
+ * taken from xType rather than passed separately, and the static form takes
+ * an array of xType as the storage area, so the storage is aligned for the
+ * item type.
+ *
+ * When configQUEUE_SIZED_COPY is set to 1 in FreeRTOSConfig.h, every queue
+ * stores a copy function chosen for its item size when it is created.  A
+ * queue whose items are 1, 2, 4 or 8 bytes long - chars, shorts, 32-bit
+ * integers, pointers, 64-bit integers or small structures - then copies each
+ * item with a single load and store of that width instead of a call to
+ * memcpy() with the item size as a parameter.  The choice is made from the
+ * item size, so queues created with the untyped functions get the same copy
+ * if their item size matches; these macros only make the item type explicit
+ * and, for the static form, align the storage.
+ *
+ * configQUEUE_SIZED_COPY defaults to 0.  Setting it to 1 adds a pointer to
+ * every queue, and every send and receive makes an indirect call, which is
+ * slower than memcpy() for items of other sizes.
+ *
+ * Example usage:
+   <pre>
+ static uint32_t ulEventStorage[ 10 ];
+ static StaticQueue_t xEventQueueBuffer;
+
+ void vATask( void *pvParameters )
+ {
+ QueueHandle_t xEvents, xPointers;
+
+	xEvents = xQueueCreateStaticOfType( 10, uint32_t, ulEventStorage, &xEventQueueBuffer );
+	xPointers = xQueueCreateOfType( 5, struct AMessage * );
+ }
+ </pre>
+ * \defgroup xQueueCreateOfType xQueueCreateOfType
+ * \ingroup QueueManagement
+ */
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+	#define xQueueCreateOfType( uxQueueLength, xType ) xQueueCreate( ( uxQueueLength ), sizeof( xType ) )
+#endif
+
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	#define xQueueCreateStaticOfType( uxQueueLength, xType, pxQueueStorage, pxQueueBuffer ) xQueueCreateStatic( ( uxQueueLength ), sizeof( xType ), ( uint8_t * ) ( xType * ) ( pxQueueStorage ), ( pxQueueBuffer ) )
+#endif
+
 /**
  * queue. h
  * <pre>
@@ -899,6 +958,36 @@ UBaseType_t uxQueueMessagesWaiting( const QueueHandle_t xQueue ) PRIVILEGED_FUNC
  */
 UBaseType_t uxQueueSpacesAvailable( const QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
 
+/**
+ * queue. h
+ * <pre>UBaseType_t uxQueueGetQueueLength( const QueueHandle_t xQueue );</pre>
+ *
+ * Return the number of items the queue was created to hold.
+ *
+ * @param xQueue A handle to the queue being queried.
+ *
+ * @return The length the queue was created with.
+ *
+ * \defgroup uxQueueGetQueueLength uxQueueGetQueueLength
+ * \ingroup QueueManagement
+ */
+UBaseType_t uxQueueGetQueueLength( const QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>UBaseType_t uxQueueGetQueueItemSize( const QueueHandle_t xQueue );</pre>
+ *
+ * Return the size, in bytes, of each item the queue holds.
+ *
+ * @param xQueue A handle to the queue being queried.
+ *
+ * @return The item size the queue was created with.
+ *
+ * \defgroup uxQueueGetQueueItemSize uxQueueGetQueueItemSize
+ * \ingroup QueueManagement
+ */
+UBaseType_t uxQueueGetQueueItemSize( const QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
+
 /**
  * queue. h
  * <pre>void vQueueDelete( QueueHandle_t xQueue );</pre>
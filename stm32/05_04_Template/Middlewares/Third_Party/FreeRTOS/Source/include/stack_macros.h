@@ -40,6 +40,14 @@
  * to which the bytes were set when the task was created have not been
  * overwritten.  Note this second test does not guarantee that an overflowed
  * stack will always be recognised.
+ *
+ * Setting configCHECK_FOR_STACK_OVERFLOW to 3 checks nothing in software.
+ * Instead the port places a no-access guard region at the limit of the
+ * running task's stack, so the first access past the limit faults.  The guard
+ * is moved to the stack of each task as it is switched in using
+ * taskSET_STACK_GUARD().  Only ports that define portSET_STACK_GUARD() support
+ * this method.  The stack high water mark then only counts the stack above the
+ * guard region, as that is all the task can use.
  */
 
 /*-----------------------------------------------------------*/
@@ -75,7 +83,7 @@
 #endif /* configCHECK_FOR_STACK_OVERFLOW == 1 */
 /*-----------------------------------------------------------*/
 
-#if( ( configCHECK_FOR_STACK_OVERFLOW > 1 ) && ( portSTACK_GROWTH < 0 ) )
+#if( ( configCHECK_FOR_STACK_OVERFLOW == 2 ) && ( portSTACK_GROWTH < 0 ) )
 
 	#define taskCHECK_FOR_STACK_OVERFLOW()																\
 	{																									\
@@ -91,10 +99,10 @@
 		}																								\
 	}
 
-#endif /* #if( configCHECK_FOR_STACK_OVERFLOW > 1 ) */
+#endif /* #if( configCHECK_FOR_STACK_OVERFLOW == 2 ) */
 /*-----------------------------------------------------------*/
 
-#if( ( configCHECK_FOR_STACK_OVERFLOW > 1 ) && ( portSTACK_GROWTH > 0 ) )
+#if( ( configCHECK_FOR_STACK_OVERFLOW == 2 ) && ( portSTACK_GROWTH > 0 ) )
 
 	#define taskCHECK_FOR_STACK_OVERFLOW()																								\
 	{																																	\
@@ -115,14 +123,27 @@
 		}																																\
 	}
 
-#endif /* #if( configCHECK_FOR_STACK_OVERFLOW > 1 ) */
+#endif /* #if( configCHECK_FOR_STACK_OVERFLOW == 2 ) */
 /*-----------------------------------------------------------*/
 
-/* Remove stack overflow macro if not being used. */
+#if( configCHECK_FOR_STACK_OVERFLOW == 3 )
+
+	/* Move the guard region to the limit of the stack of the task that has
+	just been selected to run. */
+	#define taskSET_STACK_GUARD()	portSET_STACK_GUARD( pxCurrentTCB->pxStack )
+
+#endif /* configCHECK_FOR_STACK_OVERFLOW == 3 */
+/*-----------------------------------------------------------*/
+
+/* Remove stack overflow macros if not being used. */
 #ifndef taskCHECK_FOR_STACK_OVERFLOW
 	#define taskCHECK_FOR_STACK_OVERFLOW()
 #endif
 
+#ifndef taskSET_STACK_GUARD
+	#define taskSET_STACK_GUARD()
+#endif
+
 
 
 #endif /* STACK_MACROS_H */
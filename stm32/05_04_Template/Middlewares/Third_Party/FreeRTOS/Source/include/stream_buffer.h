@@ -68,6 +68,17 @@ extern "C" {
 struct StreamBufferDef_t;
 typedef struct StreamBufferDef_t * StreamBufferHandle_t;
 
+/**
+ * Describes one part of the data passed to xStreamBufferSendV() or filled by
+ * xStreamBufferReceiveV() - for example a protocol header, payload or
+ * trailer held in separate buffers.
+ */
+typedef struct xSTREAM_BUFFER_SEGMENT
+{
+	void *pvData;		/* Start of the segment. */
+	size_t xLength;		/* Length of the segment in bytes.  May be 0. */
+} StreamBufferSegment_t;
+
 
 /**
  * message_buffer.h
@@ -314,6 +325,68 @@ size_t xStreamBufferSend( StreamBufferHandle_t xStreamBuffer,
 						  size_t xDataLengthBytes,
 						  TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
 
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferSendV( StreamBufferHandle_t xStreamBuffer,
+                           const StreamBufferSegment_t * const pxSegments,
+                           UBaseType_t uxSegmentCount,
+                           TickType_t xTicksToWait );
+</pre>
+ *
+ * Sends data held in several separate buffers (a gather list) to a stream
+ * buffer, as if it had been passed to xStreamBufferSend() as one contiguous
+ * block.  Each segment is copied straight into the stream buffer, so the
+ * caller does not have to assemble the data in a temporary buffer first.
+ * The data only becomes visible to the reader once all the segments have been
+ * copied.
+ *
+ * Behaves exactly as xStreamBufferSend() in all other respects - including
+ * the restriction to a single writer - and xStreamBufferSend() is implemented
+ * as a call to xStreamBufferSendV() with a single segment.
+ *
+ * @param xStreamBuffer The handle of the stream buffer to which a stream is
+ * being sent.
+ *
+ * @param pxSegments An array of uxSegmentCount segments, sent in order.
+ * Segments with a length of 0 are skipped.  The lengths must not add up to
+ * more than a size_t can hold - if they do configASSERT() is called and
+ * nothing is sent.
+ *
+ * @param uxSegmentCount The number of segments in pxSegments.
+ *
+ * @param xTicksToWait As for xStreamBufferSend(), applied to the total length
+ * of the segments.
+ *
+ * @return The number of bytes written to the stream buffer, counting all the
+ * segments together.  As with xStreamBufferSend(), fewer bytes than the total
+ * may be written if the stream buffer is short of space.
+ *
+ * Example use:
+<pre>
+void vSendFrame( StreamBufferHandle_t xStreamBuffer, const Header_t *pxHeader, uint8_t *pucPayload, size_t xPayloadLength, uint16_t usCRC )
+{
+StreamBufferSegment_t xFrame[ 3 ];
+
+    xFrame[ 0 ].pvData = ( void * ) pxHeader;
+    xFrame[ 0 ].xLength = sizeof( Header_t );
+    xFrame[ 1 ].pvData = pucPayload;
+    xFrame[ 1 ].xLength = xPayloadLength;
+    xFrame[ 2 ].pvData = &usCRC;
+    xFrame[ 2 ].xLength = sizeof( usCRC );
+
+    xStreamBufferSendV( xStreamBuffer, xFrame, 3, pdMS_TO_TICKS( 100 ) );
+}
+</pre>
+ * \defgroup xStreamBufferSendV xStreamBufferSendV
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSendV( StreamBufferHandle_t xStreamBuffer,
+						   const StreamBufferSegment_t * const pxSegments,
+						   UBaseType_t uxSegmentCount,
+						   TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
 /**
  * stream_buffer.h
  *
@@ -504,6 +577,45 @@ size_t xStreamBufferReceive( StreamBufferHandle_t xStreamBuffer,
 							 size_t xBufferLengthBytes,
 							 TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
 
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferReceiveV( StreamBufferHandle_t xStreamBuffer,
+                              const StreamBufferSegment_t * const pxSegments,
+                              UBaseType_t uxSegmentCount,
+                              TickType_t xTicksToWait );
+</pre>
+ *
+ * Receives bytes from a stream buffer into several separate buffers (a
+ * scatter list), as if they were one buffer as long as all the segments
+ * together.  The first segment is filled completely before the second is
+ * started, and so on.  Behaves exactly as xStreamBufferReceive() in all other
+ * respects, which is implemented as a call to xStreamBufferReceiveV() with a
+ * single segment.
+ *
+ * @param xStreamBuffer The handle of the stream buffer from which bytes are to
+ * be received.
+ *
+ * @param pxSegments An array of uxSegmentCount segments, filled in order.
+ * As for xStreamBufferSendV(), the lengths must not add up to more than a
+ * size_t can hold.
+ *
+ * @param uxSegmentCount The number of segments in pxSegments.
+ *
+ * @param xTicksToWait As for xStreamBufferReceive().
+ *
+ * @return The number of bytes read from the stream buffer, counting all the
+ * segments together.
+ *
+ * \defgroup xStreamBufferReceiveV xStreamBufferReceiveV
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferReceiveV( StreamBufferHandle_t xStreamBuffer,
+							  const StreamBufferSegment_t * const pxSegments,
+							  UBaseType_t uxSegmentCount,
+							  TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
 /**
  * stream_buffer.h
  *
@@ -739,7 +851,8 @@ BaseType_t xStreamBufferSetTriggerLevel( StreamBufferHandle_t xStreamBuffer, siz
  * level that is greater than the buffer size.
  *
  * A trigger level is set when the stream buffer is created, and can be modified
- * using xStreamBufferSetTriggerLevel().
+ * using xStreamBufferSetTriggerLevel().  vStreamBufferSetFlushDeadline() can
+ * be used to bound how long data waits below the trigger level.
  *
  * @param xStreamBuffer The handle of the stream buffer being updated.
  *
@@ -754,6 +867,75 @@ BaseType_t xStreamBufferSetTriggerLevel( StreamBufferHandle_t xStreamBuffer, siz
  */
 BaseType_t xStreamBufferSetTriggerLevel( StreamBufferHandle_t xStreamBuffer, size_t xTriggerLevel ) PRIVILEGED_FUNCTION;
 
+/**
+ * stream_buffer.h
+ *
+<pre>
+void vStreamBufferSetFlushDeadline( StreamBufferHandle_t xStreamBuffer, TickType_t xFlushDeadline );
+</pre>
+ *
+ * Sets how long data may sit in the stream buffer below the trigger level
+ * before a reading task is unblocked anyway.  configUSE_STREAM_BUFFER_FLUSH_DEADLINE
+ * must be set to 1 in FreeRTOSConfig.h for this function to be available.
+ *
+ * With a flush deadline set, a task blocked in xStreamBufferReceive() is
+ * unblocked when the buffer holds at least the trigger level number of bytes,
+ * or when xFlushDeadline ticks have passed since the buffer started holding
+ * data, or when its own block time expires - whichever comes first.  Unlike
+ * without a deadline, a reader that finds fewer than the trigger level bytes
+ * already in the buffer waits for the rest rather than returning at once.  So
+ * under load data is read in trigger level sized blocks, and when traffic is
+ * light a partial block is delivered at most xFlushDeadline ticks after its
+ * first byte arrived.
+ *
+ * The deadline is timed from the moment the buffer last went from empty to
+ * holding data, and is not restarted by later writes or by reads that leave
+ * data behind.  So once it has passed, every read returns at once until the
+ * buffer has been emptied: a reader working through a backlog one message, or
+ * one buffer's worth, at a time is never made to wait again for data that
+ * arrived while it was busy, at the cost of sometimes delivering bytes that
+ * arrived later earlier than their own deadline.  No byte waits longer than
+ * the deadline.
+ *
+ * When the buffer is empty the reader is woken once by the first byte to
+ * start timing the deadline, then sleeps until the trigger level or the
+ * deadline.  The deadline is measured in ticks, so its resolution is one tick
+ * period; use pdMS_TO_TICKS() to convert from milliseconds.
+ *
+ * The same applies to message buffers, where the trigger level counts the
+ * bytes used to store the message lengths.
+ *
+ * @param xStreamBuffer The handle of the stream buffer being updated.
+ *
+ * @param xFlushDeadline The maximum time, in ticks, data waits in the buffer
+ * before a blocked reader is unblocked.  0, the default, disables the
+ * deadline.  A reader already blocked on the buffer uses the new value the
+ * next time it is woken.
+ *
+ * \defgroup vStreamBufferSetFlushDeadline vStreamBufferSetFlushDeadline
+ * \ingroup StreamBufferManagement
+ */
+void vStreamBufferSetFlushDeadline( StreamBufferHandle_t xStreamBuffer, TickType_t xFlushDeadline ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+<pre>
+TickType_t xStreamBufferGetFlushDeadline( StreamBufferHandle_t xStreamBuffer );
+</pre>
+ *
+ * Returns the flush deadline set by vStreamBufferSetFlushDeadline(), in ticks,
+ * or 0 if the stream buffer has no deadline.
+ * configUSE_STREAM_BUFFER_FLUSH_DEADLINE must be set to 1 in FreeRTOSConfig.h
+ * for this function to be available.
+ *
+ * @param xStreamBuffer The handle of the stream buffer being queried.
+ *
+ * \defgroup xStreamBufferGetFlushDeadline xStreamBufferGetFlushDeadline
+ * \ingroup StreamBufferManagement
+ */
+TickType_t xStreamBufferGetFlushDeadline( StreamBufferHandle_t xStreamBuffer ) PRIVILEGED_FUNCTION;
+
 /**
  * stream_buffer.h
  *
@@ -147,6 +147,32 @@ typedef struct xTASK_STATUS
 	configSTACK_DEPTH_TYPE usStackHighWaterMark;	/* The minimum amount of stack space that has remained for the task since the task was created.  The closer this value is to zero the closer the task has come to overflowing its stack. */
 } TaskStatus_t;
 
+/*
+ * Type by which idle jobs are referenced, see xTaskRegisterIdleJob().
+ */
+struct xIDLE_JOB;
+typedef struct xIDLE_JOB * IdleJobHandle_t;
+
+/*
+ * Defines the prototype to which idle job functions must conform.  The
+ * function returns pdTRUE if it has more work to do, or pdFALSE if it has
+ * nothing left to do until it is triggered again.
+ */
+typedef BaseType_t (*IdleJobFunction_t)( void * );
+
+/* Used with the uxTaskGetIdleJobStats() function to return the state of each
+idle job. */
+typedef struct xIDLE_JOB_STATUS
+{
+	IdleJobHandle_t xHandle;		/* The handle of the job to which the rest of the information in the structure relates. */
+	const char *pcJobName;			/* The name given to the job when it was registered. */ /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+	uint32_t ulBudget;				/* The run time one call of the job should stay within, in run time counter units. */
+	uint32_t ulRunTimeCounter;		/* The total idle time the job has consumed, in run time counter units. */
+	uint32_t ulRuns;				/* The number of times the job function has been called. */
+	uint32_t ulOverruns;			/* The number of calls that ran past ulBudget without being asked to yield. */
+	BaseType_t xPending;			/* pdTRUE if the job has work to do. */
+} IdleJobStatus_t;
+
 /* Possible return values for eTaskConfirmSleepModeStatus(). */
 typedef enum
 {
@@ -1519,6 +1545,19 @@ constant. */
 
 #endif
 
+#if( configUSE_ARENAS == 1 )
+
+	/* Attach an arena (see arena.h) to a task, or detach it by passing NULL.
+	The task can then allocate from the arena with pvArenaAllocFromTask(), and
+	the arena is deleted when the task is deleted.  Passing NULL as the task
+	handle attaches the arena to the calling task.  The following two
+	functions are used to set and query the arena respectively. */
+	struct ArenaDef_t;
+	void vTaskSetArena( TaskHandle_t xTaskToSet, struct ArenaDef_t *pxArena ) PRIVILEGED_FUNCTION;
+	struct ArenaDef_t *xTaskGetArena( TaskHandle_t xTaskToQuery ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /**
  * task.h
  * <pre>BaseType_t xTaskCallApplicationTaskHook( TaskHandle_t xTask, void *pvParameter );</pre>
@@ -1640,6 +1679,41 @@ TaskHandle_t xTaskGetIdleTaskHandle( void ) PRIVILEGED_FUNCTION;
  */
 UBaseType_t uxTaskGetSystemState( TaskStatus_t * const pxTaskStatusArray, const UBaseType_t uxArraySize, uint32_t * const pulTotalRunTime ) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * <PRE>UBaseType_t uxTaskGetPartialSystemState( TaskStatus_t * const pxTaskStatusArray, const UBaseType_t uxArraySize, uint32_t * const pulTotalRunTime, const BaseType_t xGetFreeStackSpace );</PRE>
+ *
+ * configUSE_TRACE_FACILITY must be defined as 1 for this function to be
+ * available.  See the configuration section for more information.
+ *
+ * As uxTaskGetSystemState(), with two differences for code that takes a
+ * snapshot often, such as a statistics stream:
+ *
+ * - If there are more tasks than uxArraySize, the first uxArraySize tasks
+ *   found are returned instead of none.  Compare the return value with
+ *   uxTaskGetNumberOfTasks() to see whether any were left out.
+ *
+ * - The stack high water mark is only measured if xGetFreeStackSpace is
+ *   pdTRUE; otherwise usStackHighWaterMark is set to 0.  Measuring it scans
+ *   the unused part of every task's stack with the scheduler suspended, which
+ *   is most of the time uxTaskGetSystemState() takes.
+ *
+ * @param pxTaskStatusArray A pointer to an array of TaskStatus_t structures.
+ *
+ * @param uxArraySize The number of TaskStatus_t structures in the array.
+ *
+ * @param pulTotalRunTime As for uxTaskGetSystemState().
+ *
+ * @param xGetFreeStackSpace pdTRUE to measure each task's stack high water
+ * mark, pdFALSE to skip it.
+ *
+ * @return The number of TaskStatus_t structures that were populated.
+ *
+ * \defgroup uxTaskGetPartialSystemState uxTaskGetPartialSystemState
+ * \ingroup TaskUtils
+ */
+UBaseType_t uxTaskGetPartialSystemState( TaskStatus_t * const pxTaskStatusArray, const UBaseType_t uxArraySize, uint32_t * const pulTotalRunTime, const BaseType_t xGetFreeStackSpace ) PRIVILEGED_FUNCTION;
+
 /**
  * task. h
  * <PRE>void vTaskList( char *pcWriteBuffer );</PRE>
@@ -1771,6 +1845,97 @@ void vTaskGetRunTimeStats( char *pcWriteBuffer ) PRIVILEGED_FUNCTION; /*lint !e9
 */
 uint32_t ulTaskGetIdleRunTimeCounter( void ) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * <PRE>IdleJobHandle_t xTaskRegisterIdleJob( const char * const pcJobName, IdleJobFunction_t pxJobFunction, void * const pvParameters, const uint32_t ulBudget );</PRE>
+ *
+ * configUSE_IDLE_JOBS must be defined as 1 for this function to be available.
+ *
+ * Registers a job that the idle task runs when no other task is ready, such
+ * as statistics aggregation, flash garbage collection or a heap watermark
+ * scan.  Jobs share the idle task's stack instead of each needing a low
+ * priority task and a stack of its own.
+ *
+ * The idle task calls the job function of one pending job each time round its
+ * loop, taking the jobs in turn.  The function should do a small piece of
+ * work and return, or check xTaskIdleJobShouldYield() between pieces and
+ * return when it returns pdTRUE.  It returns pdTRUE if it has more work to do,
+ * in which case it gets another turn after the other pending jobs, or pdFALSE
+ * if it has nothing to do until vTaskTriggerIdleJob() is called for it.  A new
+ * job is pending, so it runs once at the next idle time.
+ *
+ * As with the idle hook, a job function MUST NOT call any function that might
+ * block.
+ *
+ * configGENERATE_RUN_TIME_STATS must be 1, as budgets and the time each job
+ * uses are measured with the run time stats counter.  The time a job is
+ * preempted for is not charged to it.
+ *
+ * @param pcJobName A name for the job, returned by uxTaskGetIdleJobStats().
+ *
+ * @param pxJobFunction The job function.
+ *
+ * @param pvParameters Passed to the job function.
+ *
+ * @param ulBudget The run time, in run time counter units, one call of the job
+ * function should stay within.  Calls that take longer are counted as
+ * overruns.
+ *
+ * @return The handle of the job, or NULL if configIDLE_JOB_REGISTRY_SIZE jobs
+ * are already registered.  Jobs cannot be unregistered.
+ *
+ * \defgroup xTaskRegisterIdleJob xTaskRegisterIdleJob
+ * \ingroup TaskUtils
+ */
+IdleJobHandle_t xTaskRegisterIdleJob( const char * const pcJobName, IdleJobFunction_t pxJobFunction, void * const pvParameters, const uint32_t ulBudget ) PRIVILEGED_FUNCTION; /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+
+/**
+ * task. h
+ * <PRE>void vTaskTriggerIdleJob( IdleJobHandle_t xJob );</PRE>
+ *
+ * Marks an idle job as having work to do, so the idle task calls it at the
+ * next idle time.  Can be called from tasks and from interrupts.
+ *
+ * \defgroup vTaskTriggerIdleJob vTaskTriggerIdleJob
+ * \ingroup TaskUtils
+ */
+void vTaskTriggerIdleJob( IdleJobHandle_t xJob ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>BaseType_t xTaskIdleJobShouldYield( void );</PRE>
+ *
+ * Called by a job function between pieces of work.  Returns pdTRUE if the job
+ * has used up its budget for this call, or if a task other than the idle task
+ * is ready to run, in which case the job should return.  Must only be called
+ * from a job function.
+ *
+ * \defgroup xTaskIdleJobShouldYield xTaskIdleJobShouldYield
+ * \ingroup TaskUtils
+ */
+BaseType_t xTaskIdleJobShouldYield( void ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>UBaseType_t uxTaskGetIdleJobStats( IdleJobStatus_t * const pxJobStatusArray, const UBaseType_t uxArraySize, uint32_t * const pulTotalIdleTime );</PRE>
+ *
+ * Fills an IdleJobStatus_t structure for each registered idle job.
+ *
+ * @param pxJobStatusArray An array of IdleJobStatus_t structures.
+ *
+ * @param uxArraySize The number of structures in pxJobStatusArray.
+ *
+ * @param pulTotalIdleTime If not NULL, set to the total run time of the idle
+ * task, jobs included, so each job's ulRunTimeCounter can be shown as a share
+ * of the idle time.
+ *
+ * @return The number of structures filled in.
+ *
+ * \defgroup uxTaskGetIdleJobStats uxTaskGetIdleJobStats
+ * \ingroup TaskUtils
+ */
+UBaseType_t uxTaskGetIdleJobStats( IdleJobStatus_t * const pxJobStatusArray, const UBaseType_t uxArraySize, uint32_t * const pulTotalIdleTime ) PRIVILEGED_FUNCTION;
+
 /**
  * task. h
  * <PRE>BaseType_t xTaskNotify( TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction );</PRE>
@@ -2426,6 +2591,18 @@ void vTaskRemoveFromUnorderedEventList( ListItem_t * pxEventListItem, const Tick
  */
 portDONT_DISCARD void vTaskSwitchContext( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Called by ports that guard task stacks in hardware
+ * (configCHECK_FOR_STACK_OVERFLOW set to 3) when the running task has
+ * overflowed its stack.  Calls the application's stack overflow hook for the
+ * running task.
+ */
+void vTaskStackGuardHit( void ) PRIVILEGED_FUNCTION;
+
 /*
  * THESE FUNCTIONS MUST NOT BE USED FROM APPLICATION CODE.  THEY ARE USED BY
  * THE EVENT BITS MODULE.
@@ -87,6 +87,25 @@ typedef void (*TimerCallbackFunction_t)( TimerHandle_t xTimer );
  */
 typedef void (*PendedFunction_t)( void *, uint32_t );
 
+/*
+ * Counters describing the traffic through the timer command queue, filled in
+ * by vTimerGetCommandStats() when configGENERATE_TIMER_COMMAND_STATS is 1.
+ */
+typedef struct xTIMER_COMMAND_STATS
+{
+	UBaseType_t uxCommandsReceived;		/* Messages taken off the timer queue, including pended function calls. */
+	UBaseType_t uxCommandsDirect;		/* Commands issued by the timer service task itself and applied without using the queue. */
+	UBaseType_t uxCommandsCoalesced;	/* Start/reset/stop commands dropped because a newer command for the same timer was already posted. */
+	UBaseType_t uxCommandsFailed;		/* Commands that could not be posted because the queue was full. */
+	UBaseType_t uxQueueHighWaterMark;	/* Most messages ever found in the queue, out of configTIMER_QUEUE_LENGTH. */
+	TickType_t xMaxLatency;				/* Longest time, in ticks, a message waited in the queue. */
+	TickType_t xTotalLatency;			/* Sum of all waits, divide by uxCommandsReceived for the average. */
+	UBaseType_t uxServiceTaskWakeUps;	/* Times the timer service task blocked and then ran again. */
+	UBaseType_t uxCallbacksDispatched;	/* Timer callbacks called by the timer service task. */
+	TickType_t xMaxDispatchLatency;		/* Longest time, in ticks, between a timer's expiry time and its callback being called. */
+	TickType_t xTotalDispatchLatency;	/* Sum of all dispatch latencies, divide by uxCallbacksDispatched for the average. */
+} TimerCommandStats_t;
+
 /**
  * TimerHandle_t xTimerCreate( 	const char * const pcTimerName,
  * 								TickType_t xTimerPeriodInTicks,
@@ -363,6 +382,75 @@ typedef void (*PendedFunction_t)( void *, uint32_t );
 										StaticTimer_t *pxTimerBuffer ) PRIVILEGED_FUNCTION;
 #endif /* configSUPPORT_STATIC_ALLOCATION */
 
+/**
+ * TimerHandle_t xTimerCreateOnService( const char * const pcTimerName,
+ * 										TickType_t xTimerPeriodInTicks,
+ * 										UBaseType_t uxAutoReload,
+ * 										void * pvTimerID,
+ * 										TimerCallbackFunction_t pxCallbackFunction,
+ * 										UBaseType_t uxService );
+ *
+ * TimerHandle_t xTimerCreateStaticOnService( const char * const pcTimerName,
+ * 											TickType_t xTimerPeriodInTicks,
+ * 											UBaseType_t uxAutoReload,
+ * 											void * pvTimerID,
+ * 											TimerCallbackFunction_t pxCallbackFunction,
+ * 											StaticTimer_t *pxTimerBuffer,
+ * 											UBaseType_t uxService );
+ *
+ * As xTimerCreate() and xTimerCreateStatic(), but the timer is managed by timer
+ * service uxService instead of the default service 0.
+ *
+ * configTIMER_SERVICE_COUNT timer service tasks are created when the scheduler
+ * starts, each with its own command queue and list of active timers, and with
+ * the priorities given by configTIMER_SERVICE_PRIORITIES, for example:
+ *
+ * #define configTIMER_SERVICE_COUNT		2
+ * #define configTIMER_SERVICE_PRIORITIES	{ 1, configMAX_PRIORITIES - 1 }
+ *
+ * A timer's callback always runs in the task of its service, so timers with
+ * tight deadlines can be given a high priority service of their own and are
+ * then never held up by slow callbacks of timers on other services.  Commands
+ * sent to a timer (xTimerStart(), xTimerReset(), etc.) go to the queue of its
+ * service.  xTimerPendFunctionCall() and the daemon task startup hook use
+ * service 0.
+ *
+ * Service 0's task is named configTIMER_SERVICE_TASK_NAME and its queue "TmrQ",
+ * as with a single service.  The tasks and queues of the other services get a
+ * space and the service number appended, for example "Tmr Svc 1" and
+ * "TmrQ 1".
+ *
+ * When configSUPPORT_STATIC_ALLOCATION is 1 the application must provide the
+ * memory for services 1 and above through:
+ *
+ * void vApplicationGetTimerServiceTaskMemory( UBaseType_t uxService,
+ * 											StaticTask_t **ppxTimerTaskTCBBuffer,
+ * 											StackType_t **ppxTimerTaskStackBuffer,
+ * 											uint32_t *pulTimerTaskStackSize );
+ *
+ * @param uxService The timer service, from 0 to configTIMER_SERVICE_COUNT - 1.
+ *
+ * @return As xTimerCreate() and xTimerCreateStatic().
+ */
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+	TimerHandle_t xTimerCreateOnService(	const char * const pcTimerName,			/*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+											const TickType_t xTimerPeriodInTicks,
+											const UBaseType_t uxAutoReload,
+											void * const pvTimerID,
+											TimerCallbackFunction_t pxCallbackFunction,
+											const UBaseType_t uxService ) PRIVILEGED_FUNCTION;
+#endif
+
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	TimerHandle_t xTimerCreateStaticOnService(	const char * const pcTimerName,			/*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+												const TickType_t xTimerPeriodInTicks,
+												const UBaseType_t uxAutoReload,
+												void * const pvTimerID,
+												TimerCallbackFunction_t pxCallbackFunction,
+												StaticTimer_t *pxTimerBuffer,
+												const UBaseType_t uxService ) PRIVILEGED_FUNCTION;
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+
 /**
  * void *pvTimerGetTimerID( TimerHandle_t xTimer );
  *
@@ -451,6 +539,16 @@ BaseType_t xTimerIsTimerActive( TimerHandle_t xTimer ) PRIVILEGED_FUNCTION;
  */
 TaskHandle_t xTimerGetTimerDaemonTaskHandle( void ) PRIVILEGED_FUNCTION;
 
+/**
+ * TaskHandle_t xTimerGetServiceTaskHandle( UBaseType_t uxService );
+ *
+ * Returns the handle of the task of timer service uxService (see
+ * xTimerCreateOnService()).  Service 0 is the task returned by
+ * xTimerGetTimerDaemonTaskHandle().  It is not valid to call this function
+ * before the scheduler has been started.
+ */
+TaskHandle_t xTimerGetServiceTaskHandle( UBaseType_t uxService ) PRIVILEGED_FUNCTION;
+
 /**
  * BaseType_t xTimerStart( TimerHandle_t xTimer, TickType_t xTicksToWait );
  *
@@ -1113,6 +1211,11 @@ TaskHandle_t xTimerGetTimerDaemonTaskHandle( void ) PRIVILEGED_FUNCTION;
  * xTimerPendFunctionCallFromISR() can be used to defer processing of a function
  * to the RTOS daemon task.
  *
+ * When configTIMER_SERVICE_COUNT is greater than 1 the function always runs in
+ * the task of timer service 0, the task returned by
+ * xTimerGetTimerDaemonTaskHandle(), and queues behind the commands sent to the
+ * timers of that service.
+ *
  * A mechanism is provided that allows the interrupt to return directly to the
  * task that will subsequently execute the pended callback function.  This
  * allows the callback function to execute contiguously in time with the
@@ -1197,6 +1300,9 @@ BaseType_t xTimerPendFunctionCallFromISR( PendedFunction_t xFunctionToPend, void
   * service task, hence this function is implemented in timers.c and is prefixed
   * with 'Timer').
   *
+  * When configTIMER_SERVICE_COUNT is greater than 1 the function always runs in
+  * the task of timer service 0, as for xTimerPendFunctionCallFromISR().
+  *
   * @param xFunctionToPend The function to execute from the timer service/
   * daemon task.  The function must conform to the PendedFunction_t
   * prototype.
@@ -1288,6 +1394,91 @@ TickType_t xTimerGetPeriod( TimerHandle_t xTimer ) PRIVILEGED_FUNCTION;
 */
 TickType_t xTimerGetExpiryTime( TimerHandle_t xTimer ) PRIVILEGED_FUNCTION;
 
+/**
+ * void vTimerSetSlack( TimerHandle_t xTimer, const TickType_t xSlackInTicks );
+ *
+ * configUSE_TIMER_SLACK must be defined as 1 in FreeRTOSConfig.h for this
+ * function to be available.
+ *
+ * Allows a timer to expire up to xSlackInTicks ticks late.  The timer service
+ * task wakes at the earliest expiry time plus slack of all active timers, then
+ * processes every timer that has expired by then in one batch.  Timers with
+ * nearby expiry times therefore share a single wake-up, which also lets a
+ * tickless idle implementation sleep for longer.  A timer never expires early.
+ *
+ * Timers are created with no slack.  The new value is used the next time the
+ * timer service task works out when to wake.  Auto-reload timers reload
+ * relative to their nominal expiry time, so slack does not make the period
+ * drift.
+ *
+ * @param xTimer The handle of the timer being updated.
+ *
+ * @param xSlackInTicks The most the timer may be delayed, in ticks.
+ */
+void vTimerSetSlack( TimerHandle_t xTimer, const TickType_t xSlackInTicks ) PRIVILEGED_FUNCTION;
+
+/**
+ * TickType_t xTimerGetSlack( TimerHandle_t xTimer );
+ *
+ * configUSE_TIMER_SLACK must be defined as 1 in FreeRTOSConfig.h for this
+ * function to be available.
+ *
+ * @param xTimer The handle of the timer being queried.
+ *
+ * @return The slack set by vTimerSetSlack(), in ticks.
+ */
+TickType_t xTimerGetSlack( TimerHandle_t xTimer ) PRIVILEGED_FUNCTION;
+
+/**
+ * void vTimerGetCommandStats( TimerCommandStats_t *pxStats );
+ *
+ * configGENERATE_TIMER_COMMAND_STATS must be defined as 1 in FreeRTOSConfig.h
+ * for this function to be available.
+ *
+ * Every xTimerStart(), xTimerReset(), xTimerStop(), xTimerChangePeriod() and
+ * xTimerPendFunctionCall() is posted to the timer service task through the
+ * timer command queue.  This function returns how deep that queue has got and
+ * how long commands waited in it, which helps size configTIMER_QUEUE_LENGTH and
+ * configTIMER_TASK_PRIORITY.
+ *
+ * When configUSE_TIMER_COMMAND_COALESCING is also 1 the counters show how many
+ * commands were applied directly by the timer service task (for example from
+ * inside a timer callback), and how many queued start, reset or stop commands
+ * were dropped because a later command for the same timer made them redundant.
+ *
+ * @param pxStats The structure into which a snapshot of the counters is
+ * copied.
+ */
+void vTimerGetCommandStats( TimerCommandStats_t *pxStats ) PRIVILEGED_FUNCTION;
+
+/**
+ * void vTimerGetServiceStats( UBaseType_t uxService, TimerCommandStats_t *pxStats );
+ *
+ * configGENERATE_TIMER_COMMAND_STATS must be defined as 1 in FreeRTOSConfig.h
+ * for this function to be available.
+ *
+ * As vTimerGetCommandStats(), which reports on service 0, but for timer service
+ * uxService.  The dispatch latency members show how late, after their expiry
+ * times, the callbacks of that service's timers ran - compare services to check
+ * a high priority service is not being held up.
+ *
+ * @param uxService The timer service, from 0 to configTIMER_SERVICE_COUNT - 1.
+ *
+ * @param pxStats The structure into which a snapshot of the counters is
+ * copied.
+ */
+void vTimerGetServiceStats( UBaseType_t uxService, TimerCommandStats_t *pxStats ) PRIVILEGED_FUNCTION;
+
+/**
+ * void vTimerClearCommandStats( void );
+ *
+ * configGENERATE_TIMER_COMMAND_STATS must be defined as 1 in FreeRTOSConfig.h
+ * for this function to be available.
+ *
+ * Zeros the counters of every timer service.
+ */
+void vTimerClearCommandStats( void ) PRIVILEGED_FUNCTION;
+
 /*
  * Functions beyond this part are not part of the public API and are intended
  * for use by the kernel only.
@@ -41,9 +41,13 @@ void vListInitialise( List_t * const pxList )
 	as the only list entry. */
 	pxList->pxIndex = ( ListItem_t * ) &( pxList->xListEnd );			/*lint !e826 !e740 !e9087 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
 
-	/* The list end value is the highest possible value in the list to
-	ensure it remains at the end of the list. */
-	pxList->xListEnd.xItemValue = portMAX_DELAY;
+	#if( configUSE_COMPACT_LIST_ITEMS == 0 )
+	{
+		/* The list end value is the highest possible value in the list to
+		ensure it remains at the end of the list. */
+		pxList->xListEnd.xItemValue = portMAX_DELAY;
+	}
+	#endif
 
 	/* The list end next and previous pointers point to itself so we know
 	when the list is empty. */
@@ -147,11 +151,27 @@ const TickType_t xValueOfInsertion = pxNewListItem->xItemValue;
 			   before vTaskStartScheduler() has been called?).
 		**********************************************************************/
 
-		for( pxIterator = ( ListItem_t * ) &( pxList->xListEnd ); pxIterator->pxNext->xItemValue <= xValueOfInsertion; pxIterator = pxIterator->pxNext ) /*lint !e826 !e740 !e9087 The mini list structure is used as the list end to save RAM.  This is checked and valid. *//*lint !e440 The iterator moves to a different value, not xValueOfInsertion. */
+		#if( configUSE_COMPACT_LIST_ITEMS == 1 )
+		{
+			/* The compact list end has no item value to stop the iteration,
+			so the end is tested for explicitly. */
+			const ListItem_t * const pxEnd = ( const ListItem_t * ) &( pxList->xListEnd ); /*lint !e826 !e740 !e9087 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
+
+			for( pxIterator = ( ListItem_t * ) &( pxList->xListEnd ); ( pxIterator->pxNext != pxEnd ) && ( pxIterator->pxNext->xItemValue <= xValueOfInsertion ); pxIterator = pxIterator->pxNext ) /*lint !e826 !e740 !e9087 The mini list structure is used as the list end to save RAM.  This is checked and valid. *//*lint !e440 The iterator moves to a different value, not xValueOfInsertion. */
+			{
+				/* There is nothing to do here, just iterating to the wanted
+				insertion position. */
+			}
+		}
+		#else
 		{
-			/* There is nothing to do here, just iterating to the wanted
-			insertion position. */
+			for( pxIterator = ( ListItem_t * ) &( pxList->xListEnd ); pxIterator->pxNext->xItemValue <= xValueOfInsertion; pxIterator = pxIterator->pxNext ) /*lint !e826 !e740 !e9087 The mini list structure is used as the list end to save RAM.  This is checked and valid. *//*lint !e440 The iterator moves to a different value, not xValueOfInsertion. */
+			{
+				/* There is nothing to do here, just iterating to the wanted
+				insertion position. */
+			}
 		}
+		#endif
 	}
 
 	pxNewListItem->pxNext = pxIterator->pxNext;
@@ -0,0 +1,779 @@
+/*
+ * FreeRTOS Kernel V10.3.1
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "message_queue.h"
+
+/* Lint e961, e9021 and e750 are suppressed as a MISRA exception justified
+because the MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
+for the header files above, but not in this file, in order to generate the
+correct privileged Vs unprivileged linkage and placement. */
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE /*lint !e961 !e750 !e9021. */
+
+/* This entire source file will be skipped if the application is not configured
+to include message queue functionality.  This #if is closed at the very bottom
+of this file.  If you want to include message queues then ensure
+configUSE_MESSAGE_QUEUES is set to 1 in FreeRTOSConfig.h. */
+#if( configUSE_MESSAGE_QUEUES == 1 )
+
+#if( configUSE_PREEMPTION == 0 )
+	/* If the cooperative scheduler is being used then a yield should not be
+	performed just because a higher priority task has been woken. */
+	#define mqYIELD_IF_USING_PREEMPTION()
+#else
+	#define mqYIELD_IF_USING_PREEMPTION() portYIELD_WITHIN_API()
+#endif
+
+/* With configUSE_OBJECT_LOCKS set, the critical sections that guard a message
+queue take only the message queue's own lock. */
+#if( configUSE_OBJECT_LOCKS == 1 )
+	#define mqENTER_CRITICAL( pxMessageQueue )		portENTER_OBJECT_CRITICAL( &( ( pxMessageQueue )->xObjectLock ) )
+	#define mqEXIT_CRITICAL( pxMessageQueue )		portEXIT_OBJECT_CRITICAL( &( ( pxMessageQueue )->xObjectLock ) )
+	#define mqENTER_CRITICAL_FROM_ISR( pxMessageQueue )	portENTER_OBJECT_CRITICAL_FROM_ISR( &( ( pxMessageQueue )->xObjectLock ) )
+	#define mqEXIT_CRITICAL_FROM_ISR( pxMessageQueue, x )	portEXIT_OBJECT_CRITICAL_FROM_ISR( &( ( pxMessageQueue )->xObjectLock ), ( x ) )
+#else
+	#define mqENTER_CRITICAL( pxMessageQueue )		taskENTER_CRITICAL()
+	#define mqEXIT_CRITICAL( pxMessageQueue )		taskEXIT_CRITICAL()
+	#define mqENTER_CRITICAL_FROM_ISR( pxMessageQueue )	portSET_INTERRUPT_MASK_FROM_ISR()
+	#define mqEXIT_CRITICAL_FROM_ISR( pxMessageQueue, x )	portCLEAR_INTERRUPT_MASK_FROM_ISR( ( x ) )
+#endif
+
+/* The number of bytes used to hold the length of each message. */
+#define mqBYTES_TO_STORE_MESSAGE_LENGTH	( sizeof( configMESSAGE_BUFFER_LENGTH_TYPE ) )
+
+/* Bits stored in the ucFlags field of the message queue. */
+#define mqFLAGS_IS_STATICALLY_ALLOCATED	( ( uint8_t ) 1 ) /* Set if the message queue was created using statically allocated memory. */
+
+/*-----------------------------------------------------------*/
+
+/* Structure that holds state information on the message queue.  Messages are
+stored back to back in a ring of bytes, each preceded by its length. */
+typedef struct MessageQueueDef_t /*lint !e9058 Style convention uses tag. */
+{
+	List_t xTasksWaitingToSend;		/* List of tasks that are blocked waiting for space.  Stored in priority order. */
+	List_t xTasksWaitingToReceive;	/* List of tasks that are blocked waiting for a message.  Stored in priority order. */
+	uint8_t *pucStorage;			/* Points to the storage area that holds the messages. */
+	size_t xLength;					/* The length of the storage area, in bytes. */
+	size_t xHead;					/* Index of the next byte to write. */
+	size_t xTail;					/* Index of the next byte to read. */
+	size_t xBytesUsed;				/* The number of bytes of the storage area holding messages and their lengths. */
+	UBaseType_t uxMessagesWaiting;	/* The number of messages currently in the message queue. */
+	uint8_t ucFlags;
+
+	#if( configUSE_OBJECT_LOCKS == 1 )
+		portOBJECT_LOCK_TYPE xObjectLock;	/* Guards the storage and both event lists, see configUSE_OBJECT_LOCKS. */
+	#endif
+} MessageQueue_t;
+
+/*
+ * Called by both xMessageQueueCreate() and xMessageQueueCreateStatic() to
+ * initialise the members of the newly created message queue structure.
+ */
+static void prvInitialiseNewMessageQueue( MessageQueue_t * const pxMessageQueue,
+										  uint8_t * const pucStorage,
+										  size_t xStorageSizeBytes,
+										  uint8_t ucFlags ) PRIVILEGED_FUNCTION;
+
+/*
+ * Copies xCount bytes from pucData into the storage area starting at xIndex,
+ * wrapping at the end of the storage area.  Returns the index that follows the
+ * last byte written.
+ */
+static size_t prvCopyToStorage( MessageQueue_t * const pxMessageQueue,
+								size_t xIndex,
+								const uint8_t *pucData,
+								size_t xCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Copies xCount bytes out of the storage area starting at xIndex into pucData,
+ * wrapping at the end of the storage area.  Returns the index that follows the
+ * last byte read.
+ */
+static size_t prvCopyFromStorage( const MessageQueue_t * const pxMessageQueue,
+								  size_t xIndex,
+								  uint8_t *pucData,
+								  size_t xCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Returns the length of the oldest message.  The message queue must not be
+ * empty.
+ */
+static size_t prvNextMessageLength( const MessageQueue_t * const pxMessageQueue ) PRIVILEGED_FUNCTION;
+
+/*
+ * Write a message and its length to the message queue, or read the oldest one
+ * out of it.  Must be called from a critical section, or with interrupts
+ * masked, after checking there is space or a message respectively.
+ */
+static void prvWriteMessage( MessageQueue_t * const pxMessageQueue,
+							 const void *pvTxData,
+							 size_t xDataLengthBytes ) PRIVILEGED_FUNCTION;
+static void prvReadMessage( MessageQueue_t * const pxMessageQueue,
+							void *pvRxData,
+							size_t xMessageLength ) PRIVILEGED_FUNCTION;
+
+/*
+ * Unblocks every task waiting to send, after a message has been read.  Messages
+ * differ in length, so the space freed might fit a sender other than the one of
+ * highest priority, or several senders.  Each tries again in priority order,
+ * and those whose message still does not fit block again.  Must be called from
+ * a critical section, or with interrupts masked.  Returns pdTRUE if a task of
+ * higher priority than the calling task was unblocked.
+ */
+static BaseType_t prvUnblockSenders( MessageQueue_t * const pxMessageQueue ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+	MessageQueueHandle_t xMessageQueueCreate( size_t xStorageSizeBytes )
+	{
+	uint8_t *pucAllocatedMemory;
+
+		/* There must be room for at least a one byte message. */
+		configASSERT( xStorageSizeBytes > mqBYTES_TO_STORE_MESSAGE_LENGTH );
+
+		/* The MessageQueue_t structure is placed at the start of the allocated
+		memory and the storage area follows immediately after. */
+		pucAllocatedMemory = ( uint8_t * ) pvPortMalloc( xStorageSizeBytes + sizeof( MessageQueue_t ) ); /*lint !e9079 malloc() only returns void*. */
+
+		if( pucAllocatedMemory != NULL )
+		{
+			prvInitialiseNewMessageQueue( ( MessageQueue_t * ) pucAllocatedMemory, /* Structure at the start of the allocated memory. */ /*lint !e9087 Safe cast as allocated memory is aligned. */ /*lint !e826 Area is not too small and alignment is guaranteed provided malloc() behaves as expected and returns aligned buffer. */
+										  pucAllocatedMemory + sizeof( MessageQueue_t ),  /* Storage area follows. */ /*lint !e9016 Indexing past structure valid for uint8_t pointer into allocation. */
+										  xStorageSizeBytes,
+										  0 );
+		}
+
+		return ( MessageQueueHandle_t ) pucAllocatedMemory; /*lint !e9087 !e826 Safe cast as allocated memory is aligned. */
+	}
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	MessageQueueHandle_t xMessageQueueCreateStatic( size_t xStorageSizeBytes,
+													uint8_t * const pucMessageQueueStorageArea,
+													StaticMessageQueue_t * const pxStaticMessageQueue )
+	{
+	MessageQueue_t * const pxMessageQueue = ( MessageQueue_t * ) pxStaticMessageQueue; /*lint !e740 !e9087 MessageQueue_t and StaticMessageQueue_t are guaranteed to have the same size and alignment requirement - checked by configASSERT(). */
+	MessageQueueHandle_t xReturn;
+
+		configASSERT( pucMessageQueueStorageArea );
+		configASSERT( pxStaticMessageQueue );
+		configASSERT( xStorageSizeBytes > mqBYTES_TO_STORE_MESSAGE_LENGTH );
+
+		#if( configASSERT_DEFINED == 1 )
+		{
+			/* Sanity check that the size of the structure used to declare a
+			variable of type StaticMessageQueue_t equals the size of the real
+			message queue structure. */
+			volatile size_t xSize = sizeof( StaticMessageQueue_t );
+			configASSERT( xSize == sizeof( MessageQueue_t ) );
+		} /*lint !e529 xSize is referenced if configASSERT() is defined. */
+		#endif /* configASSERT_DEFINED */
+
+		if( ( pucMessageQueueStorageArea != NULL ) && ( pxStaticMessageQueue != NULL ) )
+		{
+			prvInitialiseNewMessageQueue( pxMessageQueue,
+										  pucMessageQueueStorageArea,
+										  xStorageSizeBytes,
+										  mqFLAGS_IS_STATICALLY_ALLOCATED );
+
+			xReturn = ( MessageQueueHandle_t ) pxStaticMessageQueue; /*lint !e9087 Data hiding requires cast to opaque type. */
+		}
+		else
+		{
+			xReturn = NULL;
+		}
+
+		return xReturn;
+	}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+void vMessageQueueDelete( MessageQueueHandle_t xMessageQueue )
+{
+MessageQueue_t * pxMessageQueue = xMessageQueue;
+
+	configASSERT( pxMessageQueue );
+
+	/* Deleting a message queue that tasks are blocked on would leave them
+	referencing freed memory. */
+	configASSERT( listLIST_IS_EMPTY( &( pxMessageQueue->xTasksWaitingToSend ) ) != pdFALSE );
+	configASSERT( listLIST_IS_EMPTY( &( pxMessageQueue->xTasksWaitingToReceive ) ) != pdFALSE );
+
+	if( ( pxMessageQueue->ucFlags & mqFLAGS_IS_STATICALLY_ALLOCATED ) == ( uint8_t ) 0 )
+	{
+		#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+		{
+			/* Both the structure and the storage area were allocated using a
+			single call to pvPortMalloc(), hence only one call to vPortFree()
+			is required. */
+			vPortFree( ( void * ) pxMessageQueue ); /*lint !e9087 Standard free() semantics require void *. */
+		}
+		#else
+		{
+			/* Should not be possible to get here, ucFlags must be corrupt.
+			Force an assert. */
+			configASSERT( xMessageQueue == ( MessageQueueHandle_t ) ~0 );
+		}
+		#endif
+	}
+	else
+	{
+		/* The structure and storage area were not allocated dynamically and
+		cannot be freed - just scrub the structure so future use will assert. */
+		( void ) memset( pxMessageQueue, 0x00, sizeof( MessageQueue_t ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMessageQueueSend( MessageQueueHandle_t xMessageQueue,
+							  const void *pvTxData,
+							  size_t xDataLengthBytes,
+							  TickType_t xTicksToWait )
+{
+MessageQueue_t * const pxMessageQueue = xMessageQueue;
+const size_t xRequiredSpace = xDataLengthBytes + mqBYTES_TO_STORE_MESSAGE_LENGTH;
+BaseType_t xEntryTimeSet = pdFALSE;
+TimeOut_t xTimeOut;
+
+	configASSERT( pxMessageQueue );
+	configASSERT( pvTxData );
+	configASSERT( xDataLengthBytes > ( size_t ) 0 );
+
+	/* The length must be representable in the length header, and a message
+	that can never fit would block forever. */
+	configASSERT( ( size_t ) ( ( configMESSAGE_BUFFER_LENGTH_TYPE ) xDataLengthBytes ) == xDataLengthBytes );
+	configASSERT( xRequiredSpace <= pxMessageQueue->xLength );
+
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
+
+	/*lint -save -e904 This function relaxes the coding standard somewhat to
+	allow return statements within the function itself.  This is done in the
+	interest of execution time efficiency. */
+	for( ;; )
+	{
+		/* As with queues, the copy is performed inside the critical section so
+		any number of tasks and interrupts can send and receive at once. */
+		mqENTER_CRITICAL( pxMessageQueue );
+		{
+			if( ( pxMessageQueue->xLength - pxMessageQueue->xBytesUsed ) >= xRequiredSpace )
+			{
+				prvWriteMessage( pxMessageQueue, pvTxData, xDataLengthBytes );
+
+				/* Each message can satisfy one receiver. */
+				if( listLIST_IS_EMPTY( &( pxMessageQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+				{
+					if( xTaskRemoveFromEventList( &( pxMessageQueue->xTasksWaitingToReceive ) ) != pdFALSE )
+					{
+						mqYIELD_IF_USING_PREEMPTION();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				mqEXIT_CRITICAL( pxMessageQueue );
+				return pdPASS;
+			}
+			else if( xTicksToWait == ( TickType_t ) 0 )
+			{
+				/* Not enough space and no block time specified. */
+				mqEXIT_CRITICAL( pxMessageQueue );
+				return errQUEUE_FULL;
+			}
+			else if( xEntryTimeSet == pdFALSE )
+			{
+				vTaskInternalSetTimeOutState( &xTimeOut );
+				xEntryTimeSet = pdTRUE;
+			}
+			else if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+			{
+				/* Woken, but the space freed was too little, or was taken by
+				another sender, before the block time expired. */
+				mqEXIT_CRITICAL( pxMessageQueue );
+				return errQUEUE_FULL;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			/* Interrupts are masked, so the event list cannot be accessed by an
+			interrupt while the task is being placed on it.  The yield is held
+			pending until the critical section is exited. */
+			vTaskPlaceOnEventList( &( pxMessageQueue->xTasksWaitingToSend ), xTicksToWait );
+			portYIELD_WITHIN_API();
+		}
+		mqEXIT_CRITICAL( pxMessageQueue );
+	} /*lint -restore */
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMessageQueueSendFromISR( MessageQueueHandle_t xMessageQueue,
+									 const void *pvTxData,
+									 size_t xDataLengthBytes,
+									 BaseType_t * const pxHigherPriorityTaskWoken )
+{
+MessageQueue_t * const pxMessageQueue = xMessageQueue;
+const size_t xRequiredSpace = xDataLengthBytes + mqBYTES_TO_STORE_MESSAGE_LENGTH;
+UBaseType_t uxSavedInterruptStatus;
+BaseType_t xReturn;
+
+	configASSERT( pxMessageQueue );
+	configASSERT( pvTxData );
+	configASSERT( xDataLengthBytes > ( size_t ) 0 );
+	configASSERT( ( size_t ) ( ( configMESSAGE_BUFFER_LENGTH_TYPE ) xDataLengthBytes ) == xDataLengthBytes );
+
+	/* See the comments in xQueueGenericSendFromISR(). */
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+	uxSavedInterruptStatus = mqENTER_CRITICAL_FROM_ISR( pxMessageQueue );
+	{
+		if( ( pxMessageQueue->xLength - pxMessageQueue->xBytesUsed ) >= xRequiredSpace )
+		{
+			prvWriteMessage( pxMessageQueue, pvTxData, xDataLengthBytes );
+
+			/* Tasks only touch the event lists inside critical sections, so
+			they can be updated directly here rather than deferred as queue.c
+			has to when the queue is locked. */
+			if( listLIST_IS_EMPTY( &( pxMessageQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+			{
+				if( xTaskRemoveFromEventList( &( pxMessageQueue->xTasksWaitingToReceive ) ) != pdFALSE )
+				{
+					if( pxHigherPriorityTaskWoken != NULL )
+					{
+						*pxHigherPriorityTaskWoken = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			xReturn = pdPASS;
+		}
+		else
+		{
+			xReturn = errQUEUE_FULL;
+		}
+	}
+	mqEXIT_CRITICAL_FROM_ISR( pxMessageQueue, uxSavedInterruptStatus );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xMessageQueueReceive( MessageQueueHandle_t xMessageQueue,
+							 void *pvRxData,
+							 size_t xBufferLengthBytes,
+							 TickType_t xTicksToWait )
+{
+MessageQueue_t * const pxMessageQueue = xMessageQueue;
+BaseType_t xEntryTimeSet = pdFALSE;
+TimeOut_t xTimeOut;
+size_t xMessageLength;
+
+	configASSERT( pxMessageQueue );
+	configASSERT( pvRxData );
+
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
+
+	/*lint -save -e904 This function relaxes the coding standard somewhat to
+	allow return statements within the function itself.  This is done in the
+	interest of execution time efficiency. */
+	for( ;; )
+	{
+		mqENTER_CRITICAL( pxMessageQueue );
+		{
+			if( pxMessageQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
+			{
+				xMessageLength = prvNextMessageLength( pxMessageQueue );
+
+				if( xMessageLength <= xBufferLengthBytes )
+				{
+					prvReadMessage( pxMessageQueue, pvRxData, xMessageLength );
+
+					if( prvUnblockSenders( pxMessageQueue ) != pdFALSE )
+					{
+						mqYIELD_IF_USING_PREEMPTION();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					/* The buffer provided is too small - leave the message in
+					the message queue. */
+					xMessageLength = 0;
+				}
+
+				mqEXIT_CRITICAL( pxMessageQueue );
+				return xMessageLength;
+			}
+			else if( xTicksToWait == ( TickType_t ) 0 )
+			{
+				mqEXIT_CRITICAL( pxMessageQueue );
+				return 0;
+			}
+			else if( xEntryTimeSet == pdFALSE )
+			{
+				vTaskInternalSetTimeOutState( &xTimeOut );
+				xEntryTimeSet = pdTRUE;
+			}
+			else if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+			{
+				mqEXIT_CRITICAL( pxMessageQueue );
+				return 0;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			vTaskPlaceOnEventList( &( pxMessageQueue->xTasksWaitingToReceive ), xTicksToWait );
+			portYIELD_WITHIN_API();
+		}
+		mqEXIT_CRITICAL( pxMessageQueue );
+	} /*lint -restore */
+}
+/*-----------------------------------------------------------*/
+
+size_t xMessageQueueReceiveFromISR( MessageQueueHandle_t xMessageQueue,
+									void *pvRxData,
+									size_t xBufferLengthBytes,
+									BaseType_t * const pxHigherPriorityTaskWoken )
+{
+MessageQueue_t * const pxMessageQueue = xMessageQueue;
+UBaseType_t uxSavedInterruptStatus;
+size_t xMessageLength = 0;
+
+	configASSERT( pxMessageQueue );
+	configASSERT( pvRxData );
+
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+	uxSavedInterruptStatus = mqENTER_CRITICAL_FROM_ISR( pxMessageQueue );
+	{
+		if( pxMessageQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
+		{
+			xMessageLength = prvNextMessageLength( pxMessageQueue );
+
+			if( xMessageLength <= xBufferLengthBytes )
+			{
+				prvReadMessage( pxMessageQueue, pvRxData, xMessageLength );
+
+				if( prvUnblockSenders( pxMessageQueue ) != pdFALSE )
+				{
+					if( pxHigherPriorityTaskWoken != NULL )
+					{
+						*pxHigherPriorityTaskWoken = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				xMessageLength = 0;
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	mqEXIT_CRITICAL_FROM_ISR( pxMessageQueue, uxSavedInterruptStatus );
+
+	return xMessageLength;
+}
+/*-----------------------------------------------------------*/
+
+size_t xMessageQueueNextLengthBytes( MessageQueueHandle_t xMessageQueue )
+{
+MessageQueue_t * const pxMessageQueue = xMessageQueue;
+size_t xReturn = 0;
+
+	configASSERT( pxMessageQueue );
+
+	mqENTER_CRITICAL( pxMessageQueue );
+	{
+		if( pxMessageQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
+		{
+			xReturn = prvNextMessageLength( pxMessageQueue );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	mqEXIT_CRITICAL( pxMessageQueue );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxMessageQueueMessagesWaiting( MessageQueueHandle_t xMessageQueue )
+{
+const MessageQueue_t * const pxMessageQueue = xMessageQueue;
+
+	configASSERT( pxMessageQueue );
+
+	return pxMessageQueue->uxMessagesWaiting;
+}
+/*-----------------------------------------------------------*/
+
+size_t xMessageQueueSpacesAvailable( MessageQueueHandle_t xMessageQueue )
+{
+MessageQueue_t * const pxMessageQueue = xMessageQueue;
+size_t xSpace;
+
+	configASSERT( pxMessageQueue );
+
+	mqENTER_CRITICAL( pxMessageQueue );
+	{
+		xSpace = pxMessageQueue->xLength - pxMessageQueue->xBytesUsed;
+	}
+	mqEXIT_CRITICAL( pxMessageQueue );
+
+	if( xSpace > mqBYTES_TO_STORE_MESSAGE_LENGTH )
+	{
+		xSpace -= mqBYTES_TO_STORE_MESSAGE_LENGTH;
+	}
+	else
+	{
+		xSpace = 0;
+	}
+
+	return xSpace;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvCopyToStorage( MessageQueue_t * const pxMessageQueue,
+								size_t xIndex,
+								const uint8_t *pucData,
+								size_t xCount )
+{
+size_t xFirstLength;
+
+	/* Write as many bytes as fit before the end of the storage area, then
+	wrap to the start for the rest. */
+	xFirstLength = configMIN( pxMessageQueue->xLength - xIndex, xCount );
+	( void ) memcpy( ( void * ) ( &( pxMessageQueue->pucStorage[ xIndex ] ) ), ( const void * ) pucData, xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+
+	if( xCount > xFirstLength )
+	{
+		( void ) memcpy( ( void * ) pxMessageQueue->pucStorage, ( const void * ) &( pucData[ xFirstLength ] ), xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	xIndex += xCount;
+	if( xIndex >= pxMessageQueue->xLength )
+	{
+		xIndex -= pxMessageQueue->xLength;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xIndex;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvCopyFromStorage( const MessageQueue_t * const pxMessageQueue,
+								  size_t xIndex,
+								  uint8_t *pucData,
+								  size_t xCount )
+{
+size_t xFirstLength;
+
+	xFirstLength = configMIN( pxMessageQueue->xLength - xIndex, xCount );
+	( void ) memcpy( ( void * ) pucData, ( const void * ) &( pxMessageQueue->pucStorage[ xIndex ] ), xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+
+	if( xCount > xFirstLength )
+	{
+		( void ) memcpy( ( void * ) &( pucData[ xFirstLength ] ), ( const void * ) pxMessageQueue->pucStorage, xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	xIndex += xCount;
+	if( xIndex >= pxMessageQueue->xLength )
+	{
+		xIndex -= pxMessageQueue->xLength;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xIndex;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvNextMessageLength( const MessageQueue_t * const pxMessageQueue )
+{
+configMESSAGE_BUFFER_LENGTH_TYPE xTempLength;
+
+	( void ) prvCopyFromStorage( pxMessageQueue, pxMessageQueue->xTail, ( uint8_t * ) &xTempLength, mqBYTES_TO_STORE_MESSAGE_LENGTH );
+
+	return ( size_t ) xTempLength;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteMessage( MessageQueue_t * const pxMessageQueue,
+							 const void *pvTxData,
+							 size_t xDataLengthBytes )
+{
+const configMESSAGE_BUFFER_LENGTH_TYPE xTempLength = ( configMESSAGE_BUFFER_LENGTH_TYPE ) xDataLengthBytes;
+size_t xHead;
+
+	xHead = prvCopyToStorage( pxMessageQueue, pxMessageQueue->xHead, ( const uint8_t * ) &xTempLength, mqBYTES_TO_STORE_MESSAGE_LENGTH );
+	pxMessageQueue->xHead = prvCopyToStorage( pxMessageQueue, xHead, ( const uint8_t * ) pvTxData, xDataLengthBytes ); /*lint !e9079 Storage area is implemented as uint8_t for ease of sizing and access. */
+	pxMessageQueue->xBytesUsed += xDataLengthBytes + mqBYTES_TO_STORE_MESSAGE_LENGTH;
+	( pxMessageQueue->uxMessagesWaiting )++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReadMessage( MessageQueue_t * const pxMessageQueue,
+							void *pvRxData,
+							size_t xMessageLength )
+{
+size_t xTail;
+
+	/* Skip the length, which the caller has already read. */
+	xTail = pxMessageQueue->xTail + mqBYTES_TO_STORE_MESSAGE_LENGTH;
+	if( xTail >= pxMessageQueue->xLength )
+	{
+		xTail -= pxMessageQueue->xLength;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	pxMessageQueue->xTail = prvCopyFromStorage( pxMessageQueue, xTail, ( uint8_t * ) pvRxData, xMessageLength ); /*lint !e9079 Storage area is implemented as uint8_t for ease of sizing and access. */
+	pxMessageQueue->xBytesUsed -= xMessageLength + mqBYTES_TO_STORE_MESSAGE_LENGTH;
+	( pxMessageQueue->uxMessagesWaiting )--;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvUnblockSenders( MessageQueue_t * const pxMessageQueue )
+{
+BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	while( listLIST_IS_EMPTY( &( pxMessageQueue->xTasksWaitingToSend ) ) == pdFALSE )
+	{
+		if( xTaskRemoveFromEventList( &( pxMessageQueue->xTasksWaitingToSend ) ) != pdFALSE )
+		{
+			xHigherPriorityTaskWoken = pdTRUE;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+	return xHigherPriorityTaskWoken;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseNewMessageQueue( MessageQueue_t * const pxMessageQueue,
+										  uint8_t * const pucStorage,
+										  size_t xStorageSizeBytes,
+										  uint8_t ucFlags )
+{
+	( void ) memset( ( void * ) pxMessageQueue, 0x00, sizeof( MessageQueue_t ) ); /*lint !e9087 memset() requires void *. */
+	pxMessageQueue->pucStorage = pucStorage;
+	pxMessageQueue->xLength = xStorageSizeBytes;
+	pxMessageQueue->ucFlags = ucFlags;
+
+	vListInitialise( &( pxMessageQueue->xTasksWaitingToSend ) );
+	vListInitialise( &( pxMessageQueue->xTasksWaitingToReceive ) );
+
+	#if( configUSE_OBJECT_LOCKS == 1 )
+	{
+		portOBJECT_LOCK_INIT( &( pxMessageQueue->xObjectLock ) );
+	}
+	#endif
+}
+
+/* This entire source file will be skipped if the application is not configured
+to include message queue functionality.  If you want to include message queues
+then ensure configUSE_MESSAGE_QUEUES is set to 1 in FreeRTOSConfig.h. */
+#endif /* configUSE_MESSAGE_QUEUES == 1 */
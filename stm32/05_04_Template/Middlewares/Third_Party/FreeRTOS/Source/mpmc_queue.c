@@ -0,0 +1,763 @@
+/*
+ * FreeRTOS Kernel V10.3.1
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "mpmc_queue.h"
+
+/* Lint e961, e9021 and e750 are suppressed as a MISRA exception justified
+because the MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
+for the header files above, but not in this file, in order to generate the
+correct privileged Vs unprivileged linkage and placement. */
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE /*lint !e961 !e750 !e9021. */
+
+/* This entire source file will be skipped if the application is not configured
+to include MPMC queue functionality.  This #if is closed at the very bottom of
+this file.  If you want to include MPMC queues then ensure
+configUSE_MPMC_QUEUES is set to 1 in FreeRTOSConfig.h. */
+#if( configUSE_MPMC_QUEUES == 1 )
+
+#if( configUSE_PREEMPTION == 0 )
+	/* If the cooperative scheduler is being used then a yield should not be
+	performed just because a higher priority task has been woken. */
+	#define mpmcYIELD_IF_USING_PREEMPTION()
+#else
+	#define mpmcYIELD_IF_USING_PREEMPTION() portYIELD_WITHIN_API()
+#endif
+
+/* The critical sections only guard the event lists and the counts of waiting
+tasks.  With configUSE_OBJECT_LOCKS set they take only the queue's own lock. */
+#if( configUSE_OBJECT_LOCKS == 1 )
+	#define mpmcENTER_CRITICAL( pxQueue )			portENTER_OBJECT_CRITICAL( &( ( pxQueue )->xObjectLock ) )
+	#define mpmcEXIT_CRITICAL( pxQueue )			portEXIT_OBJECT_CRITICAL( &( ( pxQueue )->xObjectLock ) )
+	#define mpmcENTER_CRITICAL_FROM_ISR( pxQueue )	portENTER_OBJECT_CRITICAL_FROM_ISR( &( ( pxQueue )->xObjectLock ) )
+	#define mpmcEXIT_CRITICAL_FROM_ISR( pxQueue, x )	portEXIT_OBJECT_CRITICAL_FROM_ISR( &( ( pxQueue )->xObjectLock ), ( x ) )
+#else
+	#define mpmcENTER_CRITICAL( pxQueue )			taskENTER_CRITICAL()
+	#define mpmcEXIT_CRITICAL( pxQueue )			taskEXIT_CRITICAL()
+	#define mpmcENTER_CRITICAL_FROM_ISR( pxQueue )	portSET_INTERRUPT_MASK_FROM_ISR()
+	#define mpmcEXIT_CRITICAL_FROM_ISR( pxQueue, x )	portCLEAR_INTERRUPT_MASK_FROM_ISR( ( x ) )
+#endif
+
+/* Atomic accesses to the positions and the cell sequence numbers. */
+#define mpmcLOAD_RELAXED( pxValue )				__atomic_load_n( ( pxValue ), __ATOMIC_RELAXED )
+#define mpmcLOAD_ACQUIRE( pxValue )				__atomic_load_n( ( pxValue ), __ATOMIC_ACQUIRE )
+#define mpmcSTORE_RELEASE( pxValue, xNew )		__atomic_store_n( ( pxValue ), ( xNew ), __ATOMIC_RELEASE )
+#define mpmcCOMPARE_AND_SWAP( pxValue, pxExpected, xNew ) \
+	__atomic_compare_exchange_n( ( pxValue ), ( pxExpected ), ( xNew ), pdTRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED )
+
+/* Orders a cell update before the following read of a count of waiting tasks,
+and the update of such a count before the following attempt on a cell.  With
+one on each side, either the sender sees the waiting receiver or the receiver
+sees the item, and the same for a receiver and a waiting sender. */
+#define mpmcFULL_BARRIER()						__atomic_thread_fence( __ATOMIC_SEQ_CST )
+
+/* Bits stored in the ucFlags field of the queue. */
+#define mpmcFLAGS_IS_STATICALLY_ALLOCATED	( ( uint8_t ) 1 ) /* Set if the queue was created using statically allocated memory. */
+
+/*-----------------------------------------------------------*/
+
+/* A position counter on a cache line of its own. */
+typedef union MpmcPosition
+{
+	size_t xPosition;
+	uint8_t ucPad[ configMPMC_QUEUE_CACHE_LINE_SIZE ];
+} MpmcPosition_t;
+
+/* Structure that holds state information on the queue.  The storage area holds
+xMask + 1 cells of xCellWords words each: a sequence number followed by the
+item.  A cell whose sequence number equals a position is free to be written by
+the sender that claims that position, and one whose sequence number is one
+more than a position holds the item for the receiver that claims it. */
+typedef struct MpmcQueueDef_t /*lint !e9058 Style convention uses tag. */
+{
+	MpmcPosition_t xSendPosition;		/* The position the next sender claims.  Only ever increases. */
+	MpmcPosition_t xReceivePosition;	/* The position the next receiver claims.  Only ever increases. */
+	size_t *puxStorage;					/* Points to the cells. */
+	size_t xMask;						/* The number of cells minus one, which is a power of two minus one. */
+	size_t xCellWords;					/* The size of one cell, in size_t words. */
+	size_t xItemSize;					/* The size of one item, in bytes. */
+	List_t xTasksWaitingToSend;			/* List of tasks that are blocked waiting for space.  Stored in priority order. */
+	List_t xTasksWaitingToReceive;		/* List of tasks that are blocked waiting for an item.  Stored in priority order. */
+	volatile UBaseType_t uxSendersWaiting;		/* Tasks between deciding to block on a full queue and waking again. */
+	volatile UBaseType_t uxReceiversWaiting;	/* Tasks between deciding to block on an empty queue and waking again. */
+	uint8_t ucFlags;
+
+	#if( configUSE_OBJECT_LOCKS == 1 )
+		portOBJECT_LOCK_TYPE xObjectLock;	/* Guards the event lists, see configUSE_OBJECT_LOCKS. */
+	#endif
+} MpmcQueue_t;
+
+/*
+ * Called by both xMpmcQueueCreate() and xMpmcQueueCreateStatic() to
+ * initialise the members of the newly created queue structure.
+ */
+static void prvInitialiseNewMpmcQueue( MpmcQueue_t * const pxQueue,
+									   size_t * const puxStorage,
+									   UBaseType_t uxLength,
+									   UBaseType_t uxItemSize,
+									   uint8_t ucFlags ) PRIVILEGED_FUNCTION;
+
+/*
+ * Claim a cell and copy an item into or out of it without entering a critical
+ * section.  Return pdFALSE if the queue is full or empty respectively.
+ */
+static BaseType_t prvTrySend( MpmcQueue_t * const pxQueue, const void * const pvItemToQueue ) PRIVILEGED_FUNCTION;
+static BaseType_t prvTryReceive( MpmcQueue_t * const pxQueue, void * const pvBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Unblock the highest priority task waiting on pxList, if any.  uxWaiting is
+ * the count of waiting tasks that goes with the list, which is read without
+ * entering a critical section so the fast path stays free of one.  Returns
+ * pdTRUE if the unblocked task has a priority above the calling task.
+ */
+static BaseType_t prvWakeWaitingTask( MpmcQueue_t * const pxQueue,
+									  List_t * const pxList,
+									  const volatile UBaseType_t *puxWaiting ) PRIVILEGED_FUNCTION;
+static BaseType_t prvWakeWaitingTaskFromISR( MpmcQueue_t * const pxQueue,
+											 List_t * const pxList,
+											 const volatile UBaseType_t *puxWaiting ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+	MpmcQueueHandle_t xMpmcQueueCreate( UBaseType_t uxLength, UBaseType_t uxItemSize )
+	{
+	uint8_t *pucAllocatedMemory;
+	const size_t xStorageBytes = mpmcSTORAGE_WORDS( uxLength, uxItemSize ) * sizeof( size_t );
+
+		/* The MpmcQueue_t structure is placed at the start of the allocated
+		memory and the cells follow immediately after.  The structure is a
+		whole number of words long, so the cells are aligned. */
+		pucAllocatedMemory = ( uint8_t * ) pvPortMalloc( sizeof( MpmcQueue_t ) + xStorageBytes ); /*lint !e9079 malloc() only returns void*. */
+
+		if( pucAllocatedMemory != NULL )
+		{
+			prvInitialiseNewMpmcQueue( ( MpmcQueue_t * ) pucAllocatedMemory, /* Structure at the start of the allocated memory. */ /*lint !e9087 Safe cast as allocated memory is aligned. */ /*lint !e826 Area is not too small and alignment is guaranteed provided malloc() behaves as expected and returns aligned buffer. */
+									   ( size_t * ) ( pucAllocatedMemory + sizeof( MpmcQueue_t ) ), /* Cells follow. */ /*lint !e9016 !e826 !e9087 Indexing past structure valid for uint8_t pointer into allocation. */
+									   uxLength,
+									   uxItemSize,
+									   0 );
+		}
+
+		return ( MpmcQueueHandle_t ) pucAllocatedMemory; /*lint !e9087 !e826 Safe cast as allocated memory is aligned. */
+	}
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	MpmcQueueHandle_t xMpmcQueueCreateStatic( UBaseType_t uxLength,
+											  UBaseType_t uxItemSize,
+											  size_t * const puxStorageArea,
+											  StaticMpmcQueue_t * const pxStaticMpmcQueue )
+	{
+	MpmcQueue_t * const pxQueue = ( MpmcQueue_t * ) pxStaticMpmcQueue; /*lint !e740 !e9087 MpmcQueue_t and StaticMpmcQueue_t are guaranteed to have the same size and alignment requirement - checked by configASSERT(). */
+	MpmcQueueHandle_t xReturn;
+
+		configASSERT( puxStorageArea );
+		configASSERT( pxStaticMpmcQueue );
+
+		#if( configASSERT_DEFINED == 1 )
+		{
+			/* Sanity check that the size of the structure used to declare a
+			variable of type StaticMpmcQueue_t equals the size of the real
+			queue structure. */
+			volatile size_t xSize = sizeof( StaticMpmcQueue_t );
+			configASSERT( xSize == sizeof( MpmcQueue_t ) );
+		} /*lint !e529 xSize is referenced if configASSERT() is defined. */
+		#endif /* configASSERT_DEFINED */
+
+		if( ( puxStorageArea != NULL ) && ( pxStaticMpmcQueue != NULL ) )
+		{
+			prvInitialiseNewMpmcQueue( pxQueue,
+									   puxStorageArea,
+									   uxLength,
+									   uxItemSize,
+									   mpmcFLAGS_IS_STATICALLY_ALLOCATED );
+
+			xReturn = ( MpmcQueueHandle_t ) pxStaticMpmcQueue; /*lint !e9087 Data hiding requires cast to opaque type. */
+		}
+		else
+		{
+			xReturn = NULL;
+		}
+
+		return xReturn;
+	}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+void vMpmcQueueDelete( MpmcQueueHandle_t xQueue )
+{
+MpmcQueue_t * pxQueue = xQueue;
+
+	configASSERT( pxQueue );
+
+	/* Deleting a queue that tasks are blocked on would leave them referencing
+	freed memory. */
+	configASSERT( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) != pdFALSE );
+	configASSERT( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE );
+
+	if( ( pxQueue->ucFlags & mpmcFLAGS_IS_STATICALLY_ALLOCATED ) == ( uint8_t ) 0 )
+	{
+		#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+		{
+			/* Both the structure and the cells were allocated using a single
+			call to pvPortMalloc(), hence only one call to vPortFree() is
+			required. */
+			vPortFree( ( void * ) pxQueue ); /*lint !e9087 Standard free() semantics require void *. */
+		}
+		#else
+		{
+			/* Should not be possible to get here, ucFlags must be corrupt.
+			Force an assert. */
+			configASSERT( xQueue == ( MpmcQueueHandle_t ) ~0 );
+		}
+		#endif
+	}
+	else
+	{
+		/* The structure and cells were not allocated dynamically and cannot be
+		freed - just scrub the structure so future use will assert. */
+		( void ) memset( pxQueue, 0x00, sizeof( MpmcQueue_t ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMpmcQueueSend( MpmcQueueHandle_t xQueue,
+						   const void * const pvItemToQueue,
+						   TickType_t xTicksToWait )
+{
+MpmcQueue_t * const pxQueue = xQueue;
+BaseType_t xEntryTimeSet = pdFALSE;
+TimeOut_t xTimeOut;
+
+	configASSERT( pxQueue );
+	configASSERT( pvItemToQueue );
+
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
+
+	/*lint -save -e904 This function relaxes the coding standard somewhat to
+	allow return statements within the function itself.  This is done in the
+	interest of execution time efficiency. */
+	for( ;; )
+	{
+		if( prvTrySend( pxQueue, pvItemToQueue ) != pdFALSE )
+		{
+			if( prvWakeWaitingTask( pxQueue, &( pxQueue->xTasksWaitingToReceive ), &( pxQueue->uxReceiversWaiting ) ) != pdFALSE )
+			{
+				mpmcYIELD_IF_USING_PREEMPTION();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			return pdPASS;
+		}
+		else if( xTicksToWait == ( TickType_t ) 0 )
+		{
+			return errQUEUE_FULL;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		mpmcENTER_CRITICAL( pxQueue );
+		{
+			if( xEntryTimeSet == pdFALSE )
+			{
+				vTaskInternalSetTimeOutState( &xTimeOut );
+				xEntryTimeSet = pdTRUE;
+			}
+			else if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+			{
+				/* Woken, but the space was taken by another sender before the
+				block time expired. */
+				mpmcEXIT_CRITICAL( pxQueue );
+				return errQUEUE_FULL;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			/* Announce the wait before trying once more, so a receiver that
+			frees a cell after this attempt sees it and wakes this task. */
+			( pxQueue->uxSendersWaiting )++;
+			mpmcFULL_BARRIER();
+
+			if( prvTrySend( pxQueue, pvItemToQueue ) != pdFALSE )
+			{
+				( pxQueue->uxSendersWaiting )--;
+				mpmcEXIT_CRITICAL( pxQueue );
+
+				if( prvWakeWaitingTask( pxQueue, &( pxQueue->xTasksWaitingToReceive ), &( pxQueue->uxReceiversWaiting ) ) != pdFALSE )
+				{
+					mpmcYIELD_IF_USING_PREEMPTION();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				return pdPASS;
+			}
+
+			/* A receiver that frees a cell from now on has to enter the
+			critical section to wake this task, so cannot do so before the
+			task is on the event list.  The yield is held pending until the
+			critical section is exited. */
+			vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
+			portYIELD_WITHIN_API();
+		}
+		mpmcEXIT_CRITICAL( pxQueue );
+
+		mpmcENTER_CRITICAL( pxQueue );
+		{
+			( pxQueue->uxSendersWaiting )--;
+		}
+		mpmcEXIT_CRITICAL( pxQueue );
+	} /*lint -restore */
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMpmcQueueSendFromISR( MpmcQueueHandle_t xQueue,
+								  const void * const pvItemToQueue,
+								  BaseType_t * const pxHigherPriorityTaskWoken )
+{
+MpmcQueue_t * const pxQueue = xQueue;
+BaseType_t xReturn;
+
+	configASSERT( pxQueue );
+	configASSERT( pvItemToQueue );
+
+	/* See the comments in xQueueGenericSendFromISR(). */
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+	if( prvTrySend( pxQueue, pvItemToQueue ) != pdFALSE )
+	{
+		if( prvWakeWaitingTaskFromISR( pxQueue, &( pxQueue->xTasksWaitingToReceive ), &( pxQueue->uxReceiversWaiting ) ) != pdFALSE )
+		{
+			if( pxHigherPriorityTaskWoken != NULL )
+			{
+				*pxHigherPriorityTaskWoken = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		xReturn = pdPASS;
+	}
+	else
+	{
+		xReturn = errQUEUE_FULL;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMpmcQueueReceive( MpmcQueueHandle_t xQueue,
+							  void * const pvBuffer,
+							  TickType_t xTicksToWait )
+{
+MpmcQueue_t * const pxQueue = xQueue;
+BaseType_t xEntryTimeSet = pdFALSE;
+TimeOut_t xTimeOut;
+
+	configASSERT( pxQueue );
+	configASSERT( pvBuffer );
+
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
+
+	/*lint -save -e904 This function relaxes the coding standard somewhat to
+	allow return statements within the function itself.  This is done in the
+	interest of execution time efficiency. */
+	for( ;; )
+	{
+		if( prvTryReceive( pxQueue, pvBuffer ) != pdFALSE )
+		{
+			if( prvWakeWaitingTask( pxQueue, &( pxQueue->xTasksWaitingToSend ), &( pxQueue->uxSendersWaiting ) ) != pdFALSE )
+			{
+				mpmcYIELD_IF_USING_PREEMPTION();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			return pdPASS;
+		}
+		else if( xTicksToWait == ( TickType_t ) 0 )
+		{
+			return pdFAIL;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		mpmcENTER_CRITICAL( pxQueue );
+		{
+			if( xEntryTimeSet == pdFALSE )
+			{
+				vTaskInternalSetTimeOutState( &xTimeOut );
+				xEntryTimeSet = pdTRUE;
+			}
+			else if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+			{
+				mpmcEXIT_CRITICAL( pxQueue );
+				return pdFAIL;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			/* See the matching comments in xMpmcQueueSend(). */
+			( pxQueue->uxReceiversWaiting )++;
+			mpmcFULL_BARRIER();
+
+			if( prvTryReceive( pxQueue, pvBuffer ) != pdFALSE )
+			{
+				( pxQueue->uxReceiversWaiting )--;
+				mpmcEXIT_CRITICAL( pxQueue );
+
+				if( prvWakeWaitingTask( pxQueue, &( pxQueue->xTasksWaitingToSend ), &( pxQueue->uxSendersWaiting ) ) != pdFALSE )
+				{
+					mpmcYIELD_IF_USING_PREEMPTION();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				return pdPASS;
+			}
+
+			vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+			portYIELD_WITHIN_API();
+		}
+		mpmcEXIT_CRITICAL( pxQueue );
+
+		mpmcENTER_CRITICAL( pxQueue );
+		{
+			( pxQueue->uxReceiversWaiting )--;
+		}
+		mpmcEXIT_CRITICAL( pxQueue );
+	} /*lint -restore */
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMpmcQueueReceiveFromISR( MpmcQueueHandle_t xQueue,
+									 void * const pvBuffer,
+									 BaseType_t * const pxHigherPriorityTaskWoken )
+{
+MpmcQueue_t * const pxQueue = xQueue;
+BaseType_t xReturn;
+
+	configASSERT( pxQueue );
+	configASSERT( pvBuffer );
+
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+	if( prvTryReceive( pxQueue, pvBuffer ) != pdFALSE )
+	{
+		if( prvWakeWaitingTaskFromISR( pxQueue, &( pxQueue->xTasksWaitingToSend ), &( pxQueue->uxSendersWaiting ) ) != pdFALSE )
+		{
+			if( pxHigherPriorityTaskWoken != NULL )
+			{
+				*pxHigherPriorityTaskWoken = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		xReturn = pdPASS;
+	}
+	else
+	{
+		xReturn = pdFAIL;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxMpmcQueueMessagesWaiting( MpmcQueueHandle_t xQueue )
+{
+const MpmcQueue_t * const pxQueue = xQueue;
+size_t xReceivePosition, xSendPosition;
+
+	configASSERT( pxQueue );
+
+	/* Read the receive position first, so it cannot have overtaken the send
+	position read after it. */
+	xReceivePosition = mpmcLOAD_ACQUIRE( &( pxQueue->xReceivePosition.xPosition ) );
+	xSendPosition = mpmcLOAD_ACQUIRE( &( pxQueue->xSendPosition.xPosition ) );
+
+	return ( UBaseType_t ) ( xSendPosition - xReceivePosition );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvTrySend( MpmcQueue_t * const pxQueue, const void * const pvItemToQueue )
+{
+size_t xPosition, xSequence, *puxCell;
+ptrdiff_t xDifference;
+
+	xPosition = mpmcLOAD_RELAXED( &( pxQueue->xSendPosition.xPosition ) );
+
+	for( ;; )
+	{
+		puxCell = &( pxQueue->puxStorage[ ( xPosition & pxQueue->xMask ) * pxQueue->xCellWords ] );
+		xSequence = mpmcLOAD_ACQUIRE( puxCell );
+		xDifference = ( ptrdiff_t ) xSequence - ( ptrdiff_t ) xPosition;
+
+		if( xDifference == 0 )
+		{
+			/* The cell is free on this lap - claim it.  On failure xPosition
+			is updated to the position another sender claimed. */
+			if( mpmcCOMPARE_AND_SWAP( &( pxQueue->xSendPosition.xPosition ), &xPosition, xPosition + 1U ) != pdFALSE )
+			{
+				break;
+			}
+		}
+		else if( xDifference < 0 )
+		{
+			/* The cell still holds the item from the previous lap. */
+			return pdFALSE;
+		}
+		else
+		{
+			/* Another sender claimed the position since it was read. */
+			xPosition = mpmcLOAD_RELAXED( &( pxQueue->xSendPosition.xPosition ) );
+		}
+	}
+
+	( void ) memcpy( ( void * ) &( puxCell[ 1 ] ), pvItemToQueue, pxQueue->xItemSize ); /*lint !e9087 memcpy() requires void *. */
+	mpmcSTORE_RELEASE( puxCell, xPosition + 1U );
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvTryReceive( MpmcQueue_t * const pxQueue, void * const pvBuffer )
+{
+size_t xPosition, xSequence, *puxCell;
+ptrdiff_t xDifference;
+
+	xPosition = mpmcLOAD_RELAXED( &( pxQueue->xReceivePosition.xPosition ) );
+
+	for( ;; )
+	{
+		puxCell = &( pxQueue->puxStorage[ ( xPosition & pxQueue->xMask ) * pxQueue->xCellWords ] );
+		xSequence = mpmcLOAD_ACQUIRE( puxCell );
+		xDifference = ( ptrdiff_t ) xSequence - ( ptrdiff_t ) ( xPosition + 1U );
+
+		if( xDifference == 0 )
+		{
+			if( mpmcCOMPARE_AND_SWAP( &( pxQueue->xReceivePosition.xPosition ), &xPosition, xPosition + 1U ) != pdFALSE )
+			{
+				break;
+			}
+		}
+		else if( xDifference < 0 )
+		{
+			/* Empty, or the sender that claimed the cell is still copying
+			into it. */
+			return pdFALSE;
+		}
+		else
+		{
+			xPosition = mpmcLOAD_RELAXED( &( pxQueue->xReceivePosition.xPosition ) );
+		}
+	}
+
+	( void ) memcpy( pvBuffer, ( const void * ) &( puxCell[ 1 ] ), pxQueue->xItemSize );
+
+	/* Free the cell for the sender one lap on. */
+	mpmcSTORE_RELEASE( puxCell, xPosition + pxQueue->xMask + 1U );
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWakeWaitingTask( MpmcQueue_t * const pxQueue,
+									  List_t * const pxList,
+									  const volatile UBaseType_t *puxWaiting )
+{
+BaseType_t xReturn = pdFALSE;
+
+	/* Only used for its lock. */
+	( void ) pxQueue;
+
+	mpmcFULL_BARRIER();
+
+	if( *puxWaiting != ( UBaseType_t ) 0 )
+	{
+		mpmcENTER_CRITICAL( pxQueue );
+		{
+			if( listLIST_IS_EMPTY( pxList ) == pdFALSE )
+			{
+				xReturn = xTaskRemoveFromEventList( pxList );
+			}
+			else
+			{
+				/* The waiting task has not reached the event list yet, or
+				has already been woken. */
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		mpmcEXIT_CRITICAL( pxQueue );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWakeWaitingTaskFromISR( MpmcQueue_t * const pxQueue,
+											 List_t * const pxList,
+											 const volatile UBaseType_t *puxWaiting )
+{
+BaseType_t xReturn = pdFALSE;
+UBaseType_t uxSavedInterruptStatus;
+
+	/* Only used for its lock. */
+	( void ) pxQueue;
+
+	mpmcFULL_BARRIER();
+
+	if( *puxWaiting != ( UBaseType_t ) 0 )
+	{
+		/* Tasks only touch the event lists inside critical sections, so they
+		can be updated directly here. */
+		uxSavedInterruptStatus = mpmcENTER_CRITICAL_FROM_ISR( pxQueue );
+		{
+			if( listLIST_IS_EMPTY( pxList ) == pdFALSE )
+			{
+				xReturn = xTaskRemoveFromEventList( pxList );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		mpmcEXIT_CRITICAL_FROM_ISR( pxQueue, uxSavedInterruptStatus );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseNewMpmcQueue( MpmcQueue_t * const pxQueue,
+									   size_t * const puxStorage,
+									   UBaseType_t uxLength,
+									   UBaseType_t uxItemSize,
+									   uint8_t ucFlags )
+{
+size_t x;
+
+	/* The length must be a power of two so a position maps to a cell with a
+	mask, and at least two so a cell freed on one lap is not mistaken for a
+	cell filled on the same lap. */
+	configASSERT( uxLength >= ( UBaseType_t ) 2 );
+	configASSERT( ( uxLength & ( uxLength - ( UBaseType_t ) 1 ) ) == ( UBaseType_t ) 0 );
+	configASSERT( uxItemSize > ( UBaseType_t ) 0 );
+
+	( void ) memset( ( void * ) pxQueue, 0x00, sizeof( MpmcQueue_t ) ); /*lint !e9087 memset() requires void *. */
+	pxQueue->puxStorage = puxStorage;
+	pxQueue->xMask = ( size_t ) uxLength - 1U;
+	pxQueue->xCellWords = mpmcCELL_WORDS( uxItemSize );
+	pxQueue->xItemSize = ( size_t ) uxItemSize;
+	pxQueue->ucFlags = ucFlags;
+
+	/* Cell x is free for the sender that claims position x. */
+	for( x = 0; x < ( size_t ) uxLength; x++ )
+	{
+		puxStorage[ x * pxQueue->xCellWords ] = x;
+	}
+
+	vListInitialise( &( pxQueue->xTasksWaitingToSend ) );
+	vListInitialise( &( pxQueue->xTasksWaitingToReceive ) );
+
+	#if( configUSE_OBJECT_LOCKS == 1 )
+	{
+		portOBJECT_LOCK_INIT( &( pxQueue->xObjectLock ) );
+	}
+	#endif
+}
+
+/* This entire source file will be skipped if the application is not configured
+to include MPMC queue functionality.  If you want to include MPMC queues then
+ensure configUSE_MPMC_QUEUES is set to 1 in FreeRTOSConfig.h. */
+#endif /* configUSE_MPMC_QUEUES == 1 */
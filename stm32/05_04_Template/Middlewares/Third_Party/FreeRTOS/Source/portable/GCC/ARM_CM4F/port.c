@@ -59,6 +59,26 @@
 #define portNVIC_PENDSVCLEAR_BIT 			( 1UL << 27UL )
 #define portNVIC_PEND_SYSTICK_CLEAR_BIT		( 1UL << 25UL )
 
+/* Constants required to set up the stack guard region when
+configCHECK_FOR_STACK_OVERFLOW is 3. */
+#define portMPU_TYPE_REG					( * ( ( volatile uint32_t * ) 0xe000ed90 ) )
+#define portMPU_CTRL_REG					( * ( ( volatile uint32_t * ) 0xe000ed94 ) )
+#define portMPU_REGION_NUMBER_REG			( * ( ( volatile uint32_t * ) 0xe000ed98 ) )
+#define portMPU_REGION_ATTRIBUTE_REG		( * ( ( volatile uint32_t * ) 0xe000eda0 ) )
+#define portSCB_SYS_HANDLER_CTRL_STATE_REG	( * ( ( volatile uint32_t * ) 0xe000ed24 ) )
+#define portSCB_MEM_FAULT_STATUS_REG		( * ( ( volatile uint8_t * ) 0xe000ed28 ) )
+#define portSCB_MEM_FAULT_ADDRESS_REG		( * ( ( volatile uint32_t * ) 0xe000ed34 ) )
+#define portMPU_TYPE_DREGION_MASK			( 0xffUL << 8UL )
+#define portMPU_ENABLE						( 1UL << 0UL )
+#define portMPU_BACKGROUND_ENABLE			( 1UL << 2UL )
+#define portMPU_REGION_ENABLE				( 1UL << 0UL )
+#define portMPU_REGION_EXECUTE_NEVER		( 1UL << 28UL )
+#define portMPU_REGION_ADDRESS_MASK			( 0xffffffe0UL )
+#define portSCB_MEM_FAULT_ENABLE			( 1UL << 16UL )
+#define portMMFSR_MSTKERR					( 1UL << 4UL )
+#define portMMFSR_MLSPERR					( 1UL << 5UL )
+#define portMMFSR_MMARVALID					( 1UL << 7UL )
+
 /* Constants used to detect a Cortex-M7 r0p1 core, which should use the ARM_CM7
 r0p1 port. */
 #define portCPUID							( * ( ( volatile uint32_t * ) 0xE000ed00 ) )
@@ -124,6 +144,13 @@ void xPortPendSVHandler( void ) __attribute__ (( naked ));
 void xPortSysTickHandler( void );
 void vPortSVCHandler( void ) __attribute__ (( naked ));
 
+/*
+ * Program the MPU region that guards the limit of the running task's stack.
+ */
+#if( configCHECK_FOR_STACK_OVERFLOW == 3 )
+	static void prvSetupStackGuard( void );
+#endif
+
 /*
  * Start first task is a separate function so it can be tested in isolation.
  */
@@ -375,6 +402,14 @@ BaseType_t xPortStartScheduler( void )
 	/* Lazy save always. */
 	*( portFPCCR ) |= portASPEN_AND_LSPEN_BITS;
 
+	#if( configCHECK_FOR_STACK_OVERFLOW == 3 )
+	{
+		/* vTaskStartScheduler() has already moved the guard to the stack of
+		the first task. */
+		prvSetupStackGuard();
+	}
+	#endif
+
 	/* Start the first task. */
 	prvPortStartFirstTask();
 
@@ -392,6 +427,71 @@ BaseType_t xPortStartScheduler( void )
 }
 /*-----------------------------------------------------------*/
 
+#if( configCHECK_FOR_STACK_OVERFLOW == 3 )
+
+	static void prvSetupStackGuard( void )
+	{
+	uint32_t ulSizeField = 0UL;
+
+		/* The part must have an MPU, and the guard must be a power of two of
+		at least 32 bytes. */
+		configASSERT( ( portMPU_TYPE_REG & portMPU_TYPE_DREGION_MASK ) != 0UL );
+		configASSERT( configSTACK_GUARD_SIZE >= 32UL );
+		configASSERT( ( configSTACK_GUARD_SIZE & ( configSTACK_GUARD_SIZE - 1UL ) ) == 0UL );
+
+		/* The region size is encoded as log2( size ) - 1. */
+		while( ( 2UL << ulSizeField ) < configSTACK_GUARD_SIZE )
+		{
+			ulSizeField++;
+		}
+
+		/* Leaving the access permission bits clear makes the region
+		inaccessible to privileged and unprivileged code alike.  The rest of
+		the memory map keeps its default attributes through the background
+		region, so this port needs no other MPU configuration. */
+		portMPU_REGION_NUMBER_REG = portSTACK_GUARD_REGION;
+		portMPU_REGION_ATTRIBUTE_REG = portMPU_REGION_EXECUTE_NEVER | ( ulSizeField << 1UL ) | portMPU_REGION_ENABLE;
+
+		/* Report overflows as MemManage faults rather than escalating them to
+		HardFault. */
+		portSCB_SYS_HANDLER_CTRL_STATE_REG |= portSCB_MEM_FAULT_ENABLE;
+		portMPU_CTRL_REG = portMPU_BACKGROUND_ENABLE | portMPU_ENABLE;
+
+		__asm volatile( "dsb" ::: "memory" );
+		__asm volatile( "isb" );
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortStackGuardFaultHandler( void )
+	{
+	uint32_t ulStatus = portSCB_MEM_FAULT_STATUS_REG;
+	uint32_t ulGuardBase;
+
+		portMPU_REGION_NUMBER_REG = portSTACK_GUARD_REGION;
+		ulGuardBase = portMPU_REGION_BASE_ADDRESS_REG & portMPU_REGION_ADDRESS_MASK;
+
+		/* Hardware stacking onto the guard, of the integer or the lazily
+		saved floating point context, does not record a fault address.
+		Nothing else uses the MPU in this port, so such faults can only come
+		from the task stack running into its guard. */
+		if( ( ulStatus & ( portMMFSR_MSTKERR | portMMFSR_MLSPERR ) ) != 0UL )
+		{
+			vTaskStackGuardHit();
+		}
+		else if( ( ( ulStatus & portMMFSR_MMARVALID ) != 0UL ) &&
+				 ( ( portSCB_MEM_FAULT_ADDRESS_REG - ulGuardBase ) < configSTACK_GUARD_SIZE ) )
+		{
+			vTaskStackGuardHit();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+#endif /* configCHECK_FOR_STACK_OVERFLOW */
+/*-----------------------------------------------------------*/
+
 void vPortEndScheduler( void )
 {
 	/* Not implemented in ports where there is nothing to return to.
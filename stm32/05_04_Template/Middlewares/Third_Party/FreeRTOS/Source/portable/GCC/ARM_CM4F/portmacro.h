@@ -103,6 +103,22 @@ extern void vPortExitCritical( void );
 #define portENTER_CRITICAL()					vPortEnterCritical()
 #define portEXIT_CRITICAL()						vPortExitCritical()
 
+/* Object locks, see configUSE_OBJECT_LOCKS.  There is only one core, so masking
+interrupts is all a lock has to do and the lock itself holds nothing.  Each
+object still gets its own lock so the kernel builds the same way it would on a
+multi-core port. */
+#if( configUSE_OBJECT_LOCKS == 1 )
+	#define portOBJECT_LOCK_TYPE									uint8_t
+	#define portOBJECT_LOCK_INITIALISER								0U
+	#define portOBJECT_LOCK_INIT( pxLock )							( *( pxLock ) = 0U )
+	#define portENTER_OBJECT_CRITICAL( pxLock )						vPortEnterCritical()
+	#define portEXIT_OBJECT_CRITICAL( pxLock )						vPortExitCritical()
+	#define portENTER_OBJECT_CRITICAL_FROM_ISR( pxLock )			ulPortRaiseBASEPRI()
+	#define portEXIT_OBJECT_CRITICAL_FROM_ISR( pxLock, x )			vPortSetBASEPRI( x )
+	#define portLOCK_KERNEL()
+	#define portUNLOCK_KERNEL()
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* Task function macros as described on the FreeRTOS.org WEB site.  These are
@@ -119,6 +135,43 @@ not necessary for to use this port.  They are defined so the common demo files
 #endif
 /*-----------------------------------------------------------*/
 
+/* Stack overflow detection using an MPU guard region. */
+#if( configCHECK_FOR_STACK_OVERFLOW == 3 )
+
+	/* Size of the no-access region placed at the limit of the running task's
+	stack.  Must be a power of two and at least 32.  The region is aligned to
+	its size, so it starts within configSTACK_GUARD_SIZE - 1 bytes above the
+	stack limit, and up to 2 * configSTACK_GUARD_SIZE - 1 bytes of each stack
+	cannot be used. */
+	#ifndef configSTACK_GUARD_SIZE
+		#define configSTACK_GUARD_SIZE		32UL
+	#endif
+
+	/* The highest numbered region takes priority over any the application
+	sets up. */
+	#define portSTACK_GUARD_REGION			( 7UL )
+
+	#define portMPU_REGION_BASE_ADDRESS_REG	( * ( ( volatile uint32_t * ) 0xe000ed9c ) )
+	#define portMPU_REGION_VALID			( 1UL << 4UL )
+
+	#define portSTACK_GUARD_BASE( pxStack )	( ( ( uint32_t ) ( pxStack ) + ( configSTACK_GUARD_SIZE - 1UL ) ) & ~( configSTACK_GUARD_SIZE - 1UL ) )
+	#define portSTACK_GUARD_END( pxStack )	( portSTACK_GUARD_BASE( pxStack ) + configSTACK_GUARD_SIZE )
+
+	/* Called from vTaskSwitchContext(), so from within the PendSV handler.
+	Writing the base address register with the region number and the VALID
+	bit moves the region in a single store; the size and access permissions
+	set by xPortStartScheduler() are left as they are.  The exception return
+	that follows makes the change take effect before the task runs. */
+	#define portSET_STACK_GUARD( pxStack )	portMPU_REGION_BASE_ADDRESS_REG = ( portSTACK_GUARD_BASE( pxStack ) | portMPU_REGION_VALID | portSTACK_GUARD_REGION )
+
+	/* To be called from the MemManage fault handler.  Calls the stack
+	overflow hook if the fault was caused by the running task accessing its
+	guard region, and returns otherwise. */
+	void vPortStackGuardFaultHandler( void );
+
+#endif /* configCHECK_FOR_STACK_OVERFLOW */
+/*-----------------------------------------------------------*/
+
 /* Architecture specific optimisations. */
 #ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
 	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1
@@ -89,6 +89,35 @@ zero. */
 	#define queueYIELD_IF_USING_PREEMPTION() portYIELD_WITHIN_API()
 #endif
 
+#if( configQUEUE_SIZED_COPY == 1 )
+	/* Most queues hold chars, integers, pointers or other items of 1, 2, 4 or
+	8 bytes.  A memcpy() with a constant length is compiled to a load and a
+	store of that width (unaligned accesses are fine on the ports that use
+	this), so each of those sizes has its own copy function, and the one that
+	matches the item size is stored in the queue when it is created.  A send or
+	receive then makes one indirect call instead of testing the item size or
+	calling memcpy() with a variable length.  Other sizes use memcpy() as
+	before. */
+	typedef void ( *QueueCopyFunction_t )( void *pvDest, const void *pvSource, UBaseType_t uxItemSize );
+
+	static void prvCopyItem1( void *pvDest, const void *pvSource, UBaseType_t uxItemSize ) PRIVILEGED_FUNCTION;
+	static void prvCopyItem2( void *pvDest, const void *pvSource, UBaseType_t uxItemSize ) PRIVILEGED_FUNCTION;
+	static void prvCopyItem4( void *pvDest, const void *pvSource, UBaseType_t uxItemSize ) PRIVILEGED_FUNCTION;
+	static void prvCopyItem8( void *pvDest, const void *pvSource, UBaseType_t uxItemSize ) PRIVILEGED_FUNCTION;
+	static void prvCopyItemBytes( void *pvDest, const void *pvSource, UBaseType_t uxItemSize ) PRIVILEGED_FUNCTION;
+
+	/* A constant expression, so it can also be used by queueIMAGE_QUEUE(). */
+	#define queueCOPY_FUNCTION( uxItemSize )					\
+		( ( ( uxItemSize ) == 1U ) ? prvCopyItem1 :			\
+		  ( ( uxItemSize ) == 2U ) ? prvCopyItem2 :			\
+		  ( ( uxItemSize ) == 4U ) ? prvCopyItem4 :			\
+		  ( ( uxItemSize ) == 8U ) ? prvCopyItem8 : prvCopyItemBytes )
+
+	#define queueCOPY_ITEM( pxQueue, pvDest, pvSource ) ( pxQueue )->pxCopyItem( ( void * ) ( pvDest ), ( pvSource ), ( pxQueue )->uxItemSize )
+#else
+	#define queueCOPY_ITEM( pxQueue, pvDest, pvSource ) ( void ) memcpy( ( void * ) ( pvDest ), ( pvSource ), ( size_t ) ( pxQueue )->uxItemSize )
+#endif
+
 /*
  * Definition of the queue used by the scheduler.
  * Items are queued by copy, not reference.  See the following link for the
@@ -128,6 +157,14 @@ typedef struct QueueDefinition 		/* The old naming convention is used to prevent
 		uint8_t ucQueueType;
 	#endif
 
+	#if ( configUSE_OBJECT_LOCKS == 1 )
+		portOBJECT_LOCK_TYPE xObjectLock;	/*< Guards this queue in place of the kernel critical section. */
+	#endif
+
+	#if( configQUEUE_SIZED_COPY == 1 )
+		QueueCopyFunction_t pxCopyItem;	/*< Copies one item, chosen for uxItemSize when the queue is created. */
+	#endif
+
 } xQUEUE;
 
 /* The old xQUEUE name is maintained above then typedefed to the new Queue_t
@@ -163,6 +200,86 @@ typedef xQUEUE Queue_t;
 
 #endif /* configQUEUE_REGISTRY_SIZE */
 
+#if( configUSE_KERNEL_IMAGE == 1 )
+
+	#if( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+		#define queueIMAGE_ALLOCATION_FIELDS			.ucStaticallyAllocated = pdTRUE,
+	#else
+		#define queueIMAGE_ALLOCATION_FIELDS
+	#endif
+
+	#if( configUSE_TRACE_FACILITY == 1 )
+		#define queueIMAGE_TRACE_FIELDS( ucType )		.ucQueueType = ( ucType ),
+	#else
+		#define queueIMAGE_TRACE_FIELDS( ucType )
+	#endif
+
+	#if( configUSE_OBJECT_LOCKS == 1 )
+		#define queueIMAGE_LOCK_FIELDS					.xObjectLock = portOBJECT_LOCK_INITIALISER,
+	#else
+		#define queueIMAGE_LOCK_FIELDS
+	#endif
+
+	#if( configQUEUE_SIZED_COPY == 1 )
+		#define queueIMAGE_COPY_FIELDS( uxSize )		.pxCopyItem = queueCOPY_FUNCTION( uxSize ),
+	#else
+		#define queueIMAGE_COPY_FIELDS( uxSize )
+	#endif
+
+	/* Used by kernel_image.h to build queues and semaphores as
+	prvInitialiseNewQueue() would leave them.  A semaphore has no storage area,
+	so pucStorage is the queue itself and uxSize is 0. */
+	#define queueIMAGE_QUEUE( xImageQueue, pucStorage, uxQueueLength, uxSize, uxInitialCount, ucType )																							\
+	{																																															\
+		.pcHead = ( int8_t * ) ( pucStorage ),																																					\
+		.pcWriteTo = ( int8_t * ) ( pucStorage ),																																				\
+		.u.xQueue = { .pcTail = ( int8_t * ) ( pucStorage ) + ( ( uxQueueLength ) * ( uxSize ) ), .pcReadFrom = ( int8_t * ) ( pucStorage ) + ( ( ( uxQueueLength ) - 1U ) * ( uxSize ) ) },	\
+		.xTasksWaitingToSend = listSTATIC_EMPTY_LIST( ( xImageQueue ).xTasksWaitingToSend ),																									\
+		.xTasksWaitingToReceive = listSTATIC_EMPTY_LIST( ( xImageQueue ).xTasksWaitingToReceive ),																								\
+		.uxMessagesWaiting = ( uxInitialCount ),																																				\
+		.uxLength = ( uxQueueLength ),																																							\
+		.uxItemSize = ( uxSize ),																																								\
+		.cRxLock = queueUNLOCKED,																																								\
+		.cTxLock = queueUNLOCKED,																																								\
+		queueIMAGE_ALLOCATION_FIELDS																																							\
+		queueIMAGE_TRACE_FIELDS( ucType )																																						\
+		queueIMAGE_LOCK_FIELDS																																									\
+		queueIMAGE_COPY_FIELDS( uxSize )																																						\
+	}
+
+	/* As above for a mutex, which starts out available as prvInitialiseMutex()
+	leaves it. */
+	#define queueIMAGE_MUTEX( xImageQueue, ucType )													\
+	{																								\
+		.pcHead = queueQUEUE_IS_MUTEX,																\
+		.pcWriteTo = ( int8_t * ) &( xImageQueue ),													\
+		.u.xSemaphore = { .xMutexHolder = NULL, .uxRecursiveCallCount = 0U },						\
+		.xTasksWaitingToSend = listSTATIC_EMPTY_LIST( ( xImageQueue ).xTasksWaitingToSend ),		\
+		.xTasksWaitingToReceive = listSTATIC_EMPTY_LIST( ( xImageQueue ).xTasksWaitingToReceive ),	\
+		.uxMessagesWaiting = 1U,																	\
+		.uxLength = 1U,																				\
+		.uxItemSize = queueSEMAPHORE_QUEUE_ITEM_LENGTH,												\
+		.cRxLock = queueUNLOCKED,																	\
+		.cTxLock = queueUNLOCKED,																	\
+		queueIMAGE_ALLOCATION_FIELDS																\
+		queueIMAGE_TRACE_FIELDS( ucType )															\
+		queueIMAGE_LOCK_FIELDS																		\
+		queueIMAGE_COPY_FIELDS( queueSEMAPHORE_QUEUE_ITEM_LENGTH )									\
+	}
+
+	/* Defines the queues, semaphores and mutexes of the image, their storage
+	areas and queueIMAGE_REGISTRY. */
+	#define KERNEL_IMAGE_QUEUES
+	#include "kernel_image.h"
+	#undef KERNEL_IMAGE_QUEUES
+
+	#if ( configQUEUE_REGISTRY_SIZE > 0 )
+		/* The image objects are registered under their names from the start. */
+		PRIVILEGED_DATA QueueRegistryItem_t xQueueRegistry[ configQUEUE_REGISTRY_SIZE ] = queueIMAGE_REGISTRY;
+	#endif
+
+#endif /* configUSE_KERNEL_IMAGE */
+
 /*
  * Unlocks a queue locked by a call to prvLockQueue.  Locking a queue does not
  * prevent an ISR from adding or removing items to the queue, but does prevent
@@ -233,12 +350,41 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength, const UBaseT
 #endif
 /*-----------------------------------------------------------*/
 
+/*
+ * Critical sections that guard the members of one queue.  With
+ * configUSE_OBJECT_LOCKS set to 1 each queue has its own lock, otherwise they
+ * are the kernel critical section.  The const casts allow the lock of a queue
+ * that is otherwise only read to be taken.
+ */
+#if( configUSE_OBJECT_LOCKS == 1 )
+	#define queueENTER_CRITICAL( pxQueue )			portENTER_OBJECT_CRITICAL( &( ( ( Queue_t * ) ( pxQueue ) )->xObjectLock ) )
+	#define queueEXIT_CRITICAL( pxQueue )			portEXIT_OBJECT_CRITICAL( &( ( ( Queue_t * ) ( pxQueue ) )->xObjectLock ) )
+	#define queueENTER_CRITICAL_FROM_ISR( pxQueue )	portENTER_OBJECT_CRITICAL_FROM_ISR( &( ( ( Queue_t * ) ( pxQueue ) )->xObjectLock ) )
+	#define queueEXIT_CRITICAL_FROM_ISR( pxQueue, uxSavedInterruptStatus ) portEXIT_OBJECT_CRITICAL_FROM_ISR( &( ( ( Queue_t * ) ( pxQueue ) )->xObjectLock ), ( uxSavedInterruptStatus ) )
+
+	/* A task on another core can hold the queue locked by prvLockQueue()
+	while it checks the queue and then places itself on one of its event lists.
+	Task level code on this core must then leave the event lists alone and
+	count the event in the queue lock, as an ISR would, so the waiting task is
+	unblocked by prvUnlockQueue() and the wake up is not lost. */
+	#define queueIS_LOCKED( cLock )					( ( cLock ) != queueUNLOCKED )
+#else
+	#define queueENTER_CRITICAL( pxQueue )			taskENTER_CRITICAL()
+	#define queueEXIT_CRITICAL( pxQueue )			taskEXIT_CRITICAL()
+	#define queueENTER_CRITICAL_FROM_ISR( pxQueue )	portSET_INTERRUPT_MASK_FROM_ISR()
+	#define queueEXIT_CRITICAL_FROM_ISR( pxQueue, uxSavedInterruptStatus ) portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus )
+
+	/* On a single core a queue is only ever locked by the task that is
+	running, or by one that has the scheduler suspended. */
+	#define queueIS_LOCKED( cLock )					pdFALSE
+#endif
+
 /*
  * Macro to mark a queue as locked.  Locking a queue prevents an ISR from
  * accessing the queue event lists.
  */
 #define prvLockQueue( pxQueue )								\
-	taskENTER_CRITICAL();									\
+	queueENTER_CRITICAL( pxQueue );							\
 	{														\
 		if( ( pxQueue )->cRxLock == queueUNLOCKED )			\
 		{													\
@@ -249,7 +395,7 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength, const UBaseT
 			( pxQueue )->cTxLock = queueLOCKED_UNMODIFIED;	\
 		}													\
 	}														\
-	taskEXIT_CRITICAL()
+	queueEXIT_CRITICAL( pxQueue )
 /*-----------------------------------------------------------*/
 
 BaseType_t xQueueGenericReset( QueueHandle_t xQueue, BaseType_t xNewQueue )
@@ -258,7 +404,7 @@ Queue_t * const pxQueue = xQueue;
 
 	configASSERT( pxQueue );
 
-	taskENTER_CRITICAL();
+	queueENTER_CRITICAL( pxQueue );
 	{
 		pxQueue->u.xQueue.pcTail = pxQueue->pcHead + ( pxQueue->uxLength * pxQueue->uxItemSize ); /*lint !e9016 Pointer arithmetic allowed on char types, especially when it assists conveying intent. */
 		pxQueue->uxMessagesWaiting = ( UBaseType_t ) 0U;
@@ -297,7 +443,7 @@ Queue_t * const pxQueue = xQueue;
 			vListInitialise( &( pxQueue->xTasksWaitingToReceive ) );
 		}
 	}
-	taskEXIT_CRITICAL();
+	queueEXIT_CRITICAL( pxQueue );
 
 	/* A value is returned for calling semantic consistency with previous
 	versions. */
@@ -443,6 +589,20 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength, const UBaseT
 	defined. */
 	pxNewQueue->uxLength = uxQueueLength;
 	pxNewQueue->uxItemSize = uxItemSize;
+
+	#if( configQUEUE_SIZED_COPY == 1 )
+	{
+		pxNewQueue->pxCopyItem = queueCOPY_FUNCTION( uxItemSize );
+	}
+	#endif
+
+	#if( configUSE_OBJECT_LOCKS == 1 )
+	{
+		/* xQueueGenericReset() takes the lock. */
+		portOBJECT_LOCK_INIT( &( pxNewQueue->xObjectLock ) );
+	}
+	#endif
+
 	( void ) xQueueGenericReset( pxNewQueue, pdTRUE );
 
 	#if ( configUSE_TRACE_FACILITY == 1 )
@@ -539,7 +699,7 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength, const UBaseT
 		calling task is the mutex holder, but not a good way of determining the
 		identity of the mutex holder, as the holder may change between the
 		following critical section exiting and the function returning. */
-		taskENTER_CRITICAL();
+		queueENTER_CRITICAL( pxSemaphore );
 		{
 			if( pxSemaphore->uxQueueType == queueQUEUE_IS_MUTEX )
 			{
@@ -550,7 +710,7 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength, const UBaseT
 				pxReturn = NULL;
 			}
 		}
-		taskEXIT_CRITICAL();
+		queueEXIT_CRITICAL( pxSemaphore );
 
 		return pxReturn;
 	} /*lint !e818 xSemaphore cannot be a pointer to const because it is a typedef. */
@@ -758,7 +918,7 @@ Queue_t * const pxQueue = xQueue;
 	interest of execution time efficiency. */
 	for( ;; )
 	{
-		taskENTER_CRITICAL();
+		queueENTER_CRITICAL( pxQueue );
 		{
 			/* Is there room on the queue now?  The running task must be the
 			highest priority task wanting to access the queue.  If the head item
@@ -799,7 +959,21 @@ Queue_t * const pxQueue = xQueue;
 					{
 						/* If there was a task waiting for data to arrive on the
 						queue then unblock it now. */
-						if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+						if( queueIS_LOCKED( pxQueue->cTxLock ) != pdFALSE )
+						{
+							/* Another core has the queue locked, see queueIS_LOCKED(). */
+							pxQueue->cTxLock = ( int8_t ) ( pxQueue->cTxLock + 1 );
+
+							if( xYieldRequired != pdFALSE )
+							{
+								queueYIELD_IF_USING_PREEMPTION();
+							}
+							else
+							{
+								mtCOVERAGE_TEST_MARKER();
+							}
+						}
+						else if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
 						{
 							if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
 							{
@@ -834,7 +1008,21 @@ Queue_t * const pxQueue = xQueue;
 
 					/* If there was a task waiting for data to arrive on the
 					queue then unblock it now. */
-					if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+					if( queueIS_LOCKED( pxQueue->cTxLock ) != pdFALSE )
+					{
+						/* Another core has the queue locked, see queueIS_LOCKED(). */
+						pxQueue->cTxLock = ( int8_t ) ( pxQueue->cTxLock + 1 );
+
+						if( xYieldRequired != pdFALSE )
+						{
+							queueYIELD_IF_USING_PREEMPTION();
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					else if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
 					{
 						if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
 						{
@@ -864,7 +1052,7 @@ Queue_t * const pxQueue = xQueue;
 				}
 				#endif /* configUSE_QUEUE_SETS */
 
-				taskEXIT_CRITICAL();
+				queueEXIT_CRITICAL( pxQueue );
 				return pdPASS;
 			}
 			else
@@ -873,7 +1061,7 @@ Queue_t * const pxQueue = xQueue;
 				{
 					/* The queue was full and no block time is specified (or
 					the block time has expired) so leave now. */
-					taskEXIT_CRITICAL();
+					queueEXIT_CRITICAL( pxQueue );
 
 					/* Return to the original privilege level before exiting
 					the function. */
@@ -894,7 +1082,7 @@ Queue_t * const pxQueue = xQueue;
 				}
 			}
 		}
-		taskEXIT_CRITICAL();
+		queueEXIT_CRITICAL( pxQueue );
 
 		/* Interrupts and other tasks can send to and receive from the queue
 		now the critical section has been exited. */
@@ -978,7 +1166,7 @@ Queue_t * const pxQueue = xQueue;
 	read, instead return a flag to say whether a context switch is required or
 	not (i.e. has a task with a higher priority than us been woken by this
 	post). */
-	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	uxSavedInterruptStatus = queueENTER_CRITICAL_FROM_ISR( pxQueue );
 	{
 		if( ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) || ( xCopyPosition == queueOVERWRITE ) )
 		{
@@ -1103,7 +1291,7 @@ Queue_t * const pxQueue = xQueue;
 			xReturn = errQUEUE_FULL;
 		}
 	}
-	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	queueEXIT_CRITICAL_FROM_ISR( pxQueue, uxSavedInterruptStatus );
 
 	return xReturn;
 }
@@ -1148,7 +1336,7 @@ Queue_t * const pxQueue = xQueue;
 	link: http://www.freertos.org/RTOS-Cortex-M3-M4.html */
 	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
 
-	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	uxSavedInterruptStatus = queueENTER_CRITICAL_FROM_ISR( pxQueue );
 	{
 		const UBaseType_t uxMessagesWaiting = pxQueue->uxMessagesWaiting;
 
@@ -1268,7 +1456,7 @@ Queue_t * const pxQueue = xQueue;
 			xReturn = errQUEUE_FULL;
 		}
 	}
-	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	queueEXIT_CRITICAL_FROM_ISR( pxQueue, uxSavedInterruptStatus );
 
 	return xReturn;
 }
@@ -1300,7 +1488,7 @@ Queue_t * const pxQueue = xQueue;
 	interest of execution time efficiency. */
 	for( ;; )
 	{
-		taskENTER_CRITICAL();
+		queueENTER_CRITICAL( pxQueue );
 		{
 			const UBaseType_t uxMessagesWaiting = pxQueue->uxMessagesWaiting;
 
@@ -1316,7 +1504,12 @@ Queue_t * const pxQueue = xQueue;
 				/* There is now space in the queue, were any tasks waiting to
 				post to the queue?  If so, unblock the highest priority waiting
 				task. */
-				if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) == pdFALSE )
+				if( queueIS_LOCKED( pxQueue->cRxLock ) != pdFALSE )
+				{
+					/* Another core has the queue locked, see queueIS_LOCKED(). */
+					pxQueue->cRxLock = ( int8_t ) ( pxQueue->cRxLock + 1 );
+				}
+				else if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) == pdFALSE )
 				{
 					if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToSend ) ) != pdFALSE )
 					{
@@ -1332,7 +1525,7 @@ Queue_t * const pxQueue = xQueue;
 					mtCOVERAGE_TEST_MARKER();
 				}
 
-				taskEXIT_CRITICAL();
+				queueEXIT_CRITICAL( pxQueue );
 				return pdPASS;
 			}
 			else
@@ -1341,7 +1534,7 @@ Queue_t * const pxQueue = xQueue;
 				{
 					/* The queue was empty and no block time is specified (or
 					the block time has expired) so leave now. */
-					taskEXIT_CRITICAL();
+					queueEXIT_CRITICAL( pxQueue );
 					traceQUEUE_RECEIVE_FAILED( pxQueue );
 					return errQUEUE_EMPTY;
 				}
@@ -1359,7 +1552,7 @@ Queue_t * const pxQueue = xQueue;
 				}
 			}
 		}
-		taskEXIT_CRITICAL();
+		queueEXIT_CRITICAL( pxQueue );
 
 		/* Interrupts and other tasks can send to and receive from the queue
 		now the critical section has been exited. */
@@ -1445,7 +1638,7 @@ Queue_t * const pxQueue = xQueue;
 	of execution time efficiency. */
 	for( ;; )
 	{
-		taskENTER_CRITICAL();
+		queueENTER_CRITICAL( pxQueue );
 		{
 			/* Semaphores are queues with an item size of 0, and where the
 			number of messages in the queue is the semaphore's count value. */
@@ -1478,7 +1671,12 @@ Queue_t * const pxQueue = xQueue;
 
 				/* Check to see if other tasks are blocked waiting to give the
 				semaphore, and if so, unblock the highest priority such task. */
-				if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) == pdFALSE )
+				if( queueIS_LOCKED( pxQueue->cRxLock ) != pdFALSE )
+				{
+					/* Another core has the queue locked, see queueIS_LOCKED(). */
+					pxQueue->cRxLock = ( int8_t ) ( pxQueue->cRxLock + 1 );
+				}
+				else if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) == pdFALSE )
 				{
 					if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToSend ) ) != pdFALSE )
 					{
@@ -1494,7 +1692,7 @@ Queue_t * const pxQueue = xQueue;
 					mtCOVERAGE_TEST_MARKER();
 				}
 
-				taskEXIT_CRITICAL();
+				queueEXIT_CRITICAL( pxQueue );
 				return pdPASS;
 			}
 			else
@@ -1512,7 +1710,7 @@ Queue_t * const pxQueue = xQueue;
 
 					/* The semaphore count was 0 and no block time is specified
 					(or the block time has expired) so exit now. */
-					taskEXIT_CRITICAL();
+					queueEXIT_CRITICAL( pxQueue );
 					traceQUEUE_RECEIVE_FAILED( pxQueue );
 					return errQUEUE_EMPTY;
 				}
@@ -1530,7 +1728,7 @@ Queue_t * const pxQueue = xQueue;
 				}
 			}
 		}
-		taskEXIT_CRITICAL();
+		queueEXIT_CRITICAL( pxQueue );
 
 		/* Interrupts and other tasks can give to and take from the semaphore
 		now the critical section has been exited. */
@@ -1553,11 +1751,11 @@ Queue_t * const pxQueue = xQueue;
 				{
 					if( pxQueue->uxQueueType == queueQUEUE_IS_MUTEX )
 					{
-						taskENTER_CRITICAL();
+						queueENTER_CRITICAL( pxQueue );
 						{
 							xInheritanceOccurred = xTaskPriorityInherit( pxQueue->u.xSemaphore.xMutexHolder );
 						}
-						taskEXIT_CRITICAL();
+						queueEXIT_CRITICAL( pxQueue );
 					}
 					else
 					{
@@ -1604,7 +1802,7 @@ Queue_t * const pxQueue = xQueue;
 					test the mutex type again to check it is actually a mutex. */
 					if( xInheritanceOccurred != pdFALSE )
 					{
-						taskENTER_CRITICAL();
+						queueENTER_CRITICAL( pxQueue );
 						{
 							UBaseType_t uxHighestWaitingPriority;
 
@@ -1616,7 +1814,7 @@ Queue_t * const pxQueue = xQueue;
 							uxHighestWaitingPriority = prvGetDisinheritPriorityAfterTimeout( pxQueue );
 							vTaskPriorityDisinheritAfterTimeout( pxQueue->u.xSemaphore.xMutexHolder, uxHighestWaitingPriority );
 						}
-						taskEXIT_CRITICAL();
+						queueEXIT_CRITICAL( pxQueue );
 					}
 				}
 				#endif /* configUSE_MUTEXES */
@@ -1660,7 +1858,7 @@ Queue_t * const pxQueue = xQueue;
 	interest of execution time efficiency. */
 	for( ;; )
 	{
-		taskENTER_CRITICAL();
+		queueENTER_CRITICAL( pxQueue );
 		{
 			const UBaseType_t uxMessagesWaiting = pxQueue->uxMessagesWaiting;
 
@@ -1681,7 +1879,12 @@ Queue_t * const pxQueue = xQueue;
 
 				/* The data is being left in the queue, so see if there are
 				any other tasks waiting for the data. */
-				if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+				if( queueIS_LOCKED( pxQueue->cTxLock ) != pdFALSE )
+				{
+					/* Another core has the queue locked, see queueIS_LOCKED(). */
+					pxQueue->cTxLock = ( int8_t ) ( pxQueue->cTxLock + 1 );
+				}
+				else if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
 				{
 					if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
 					{
@@ -1698,7 +1901,7 @@ Queue_t * const pxQueue = xQueue;
 					mtCOVERAGE_TEST_MARKER();
 				}
 
-				taskEXIT_CRITICAL();
+				queueEXIT_CRITICAL( pxQueue );
 				return pdPASS;
 			}
 			else
@@ -1707,7 +1910,7 @@ Queue_t * const pxQueue = xQueue;
 				{
 					/* The queue was empty and no block time is specified (or
 					the block time has expired) so leave now. */
-					taskEXIT_CRITICAL();
+					queueEXIT_CRITICAL( pxQueue );
 					traceQUEUE_PEEK_FAILED( pxQueue );
 					return errQUEUE_EMPTY;
 				}
@@ -1726,7 +1929,7 @@ Queue_t * const pxQueue = xQueue;
 				}
 			}
 		}
-		taskEXIT_CRITICAL();
+		queueEXIT_CRITICAL( pxQueue );
 
 		/* Interrupts and other tasks can send to and receive from the queue
 		now the critical section has been exited. */
@@ -1807,7 +2010,7 @@ Queue_t * const pxQueue = xQueue;
 	link: http://www.freertos.org/RTOS-Cortex-M3-M4.html */
 	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
 
-	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	uxSavedInterruptStatus = queueENTER_CRITICAL_FROM_ISR( pxQueue );
 	{
 		const UBaseType_t uxMessagesWaiting = pxQueue->uxMessagesWaiting;
 
@@ -1867,7 +2070,7 @@ Queue_t * const pxQueue = xQueue;
 			traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue );
 		}
 	}
-	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	queueEXIT_CRITICAL_FROM_ISR( pxQueue, uxSavedInterruptStatus );
 
 	return xReturn;
 }
@@ -1900,7 +2103,7 @@ Queue_t * const pxQueue = xQueue;
 	link: http://www.freertos.org/RTOS-Cortex-M3-M4.html */
 	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
 
-	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	uxSavedInterruptStatus = queueENTER_CRITICAL_FROM_ISR( pxQueue );
 	{
 		/* Cannot block in an ISR, so check there is data available. */
 		if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
@@ -1921,7 +2124,7 @@ Queue_t * const pxQueue = xQueue;
 			traceQUEUE_PEEK_FROM_ISR_FAILED( pxQueue );
 		}
 	}
-	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	queueEXIT_CRITICAL_FROM_ISR( pxQueue, uxSavedInterruptStatus );
 
 	return xReturn;
 }
@@ -1933,11 +2136,11 @@ UBaseType_t uxReturn;
 
 	configASSERT( xQueue );
 
-	taskENTER_CRITICAL();
+	queueENTER_CRITICAL( xQueue );
 	{
 		uxReturn = ( ( Queue_t * ) xQueue )->uxMessagesWaiting;
 	}
-	taskEXIT_CRITICAL();
+	queueEXIT_CRITICAL( xQueue );
 
 	return uxReturn;
 } /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
@@ -1950,16 +2153,38 @@ Queue_t * const pxQueue = xQueue;
 
 	configASSERT( pxQueue );
 
-	taskENTER_CRITICAL();
+	queueENTER_CRITICAL( pxQueue );
 	{
 		uxReturn = pxQueue->uxLength - pxQueue->uxMessagesWaiting;
 	}
-	taskEXIT_CRITICAL();
+	queueEXIT_CRITICAL( pxQueue );
 
 	return uxReturn;
 } /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
 /*-----------------------------------------------------------*/
 
+UBaseType_t uxQueueGetQueueLength( const QueueHandle_t xQueue )
+{
+Queue_t * const pxQueue = xQueue;
+
+	configASSERT( pxQueue );
+
+	/* Set when the queue is created and never changed, so no critical section
+	is needed. */
+	return pxQueue->uxLength;
+} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueGetQueueItemSize( const QueueHandle_t xQueue )
+{
+Queue_t * const pxQueue = xQueue;
+
+	configASSERT( pxQueue );
+
+	return pxQueue->uxItemSize;
+} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
+/*-----------------------------------------------------------*/
+
 UBaseType_t uxQueueMessagesWaitingFromISR( const QueueHandle_t xQueue )
 {
 UBaseType_t uxReturn;
@@ -2099,7 +2324,7 @@ UBaseType_t uxMessagesWaiting;
 	}
 	else if( xPosition == queueSEND_TO_BACK )
 	{
-		( void ) memcpy( ( void * ) pxQueue->pcWriteTo, pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports, plus previous logic ensures a null pointer can only be passed to memcpy() if the copy size is 0.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes. */
+		queueCOPY_ITEM( pxQueue, pxQueue->pcWriteTo, pvItemToQueue ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports, plus previous logic ensures a null pointer can only be passed to memcpy() if the copy size is 0.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes. */
 		pxQueue->pcWriteTo += pxQueue->uxItemSize; /*lint !e9016 Pointer arithmetic on char types ok, especially in this use case where it is the clearest way of conveying intent. */
 		if( pxQueue->pcWriteTo >= pxQueue->u.xQueue.pcTail ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
 		{
@@ -2112,7 +2337,7 @@ UBaseType_t uxMessagesWaiting;
 	}
 	else
 	{
-		( void ) memcpy( ( void * ) pxQueue->u.xQueue.pcReadFrom, pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e9087 !e418 MISRA exception as the casts are only redundant for some ports.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes.  Assert checks null pointer only used when length is 0. */
+		queueCOPY_ITEM( pxQueue, pxQueue->u.xQueue.pcReadFrom, pvItemToQueue ); /*lint !e961 !e9087 !e418 MISRA exception as the casts are only redundant for some ports.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes.  Assert checks null pointer only used when length is 0. */
 		pxQueue->u.xQueue.pcReadFrom -= pxQueue->uxItemSize;
 		if( pxQueue->u.xQueue.pcReadFrom < pxQueue->pcHead ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
 		{
@@ -2163,11 +2388,49 @@ static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer
 		{
 			mtCOVERAGE_TEST_MARKER();
 		}
-		( void ) memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->u.xQueue.pcReadFrom, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports.  Also previous logic ensures a null pointer can only be passed to memcpy() when the count is 0.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes. */
+		queueCOPY_ITEM( pxQueue, pvBuffer, pxQueue->u.xQueue.pcReadFrom ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports.  Also previous logic ensures a null pointer can only be passed to memcpy() when the count is 0.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes. */
 	}
 }
 /*-----------------------------------------------------------*/
 
+#if( configQUEUE_SIZED_COPY == 1 )
+
+	static void prvCopyItem1( void *pvDest, const void *pvSource, UBaseType_t uxItemSize )
+	{
+		( void ) uxItemSize;
+		*( ( uint8_t * ) pvDest ) = *( ( const uint8_t * ) pvSource );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCopyItem2( void *pvDest, const void *pvSource, UBaseType_t uxItemSize )
+	{
+		( void ) uxItemSize;
+		( void ) memcpy( pvDest, pvSource, ( size_t ) 2 );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCopyItem4( void *pvDest, const void *pvSource, UBaseType_t uxItemSize )
+	{
+		( void ) uxItemSize;
+		( void ) memcpy( pvDest, pvSource, ( size_t ) 4 );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCopyItem8( void *pvDest, const void *pvSource, UBaseType_t uxItemSize )
+	{
+		( void ) uxItemSize;
+		( void ) memcpy( pvDest, pvSource, ( size_t ) 8 );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCopyItemBytes( void *pvDest, const void *pvSource, UBaseType_t uxItemSize )
+	{
+		( void ) memcpy( pvDest, pvSource, ( size_t ) uxItemSize );
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* configQUEUE_SIZED_COPY */
+
 static void prvUnlockQueue( Queue_t * const pxQueue )
 {
 	/* THIS FUNCTION MUST BE CALLED WITH THE SCHEDULER SUSPENDED. */
@@ -2176,7 +2439,7 @@ static void prvUnlockQueue( Queue_t * const pxQueue )
 	removed from the queue while the queue was locked.  When a queue is
 	locked items can be added or removed, but the event lists cannot be
 	updated. */
-	taskENTER_CRITICAL();
+	queueENTER_CRITICAL( pxQueue );
 	{
 		int8_t cTxLock = pxQueue->cTxLock;
 
@@ -2254,10 +2517,10 @@ static void prvUnlockQueue( Queue_t * const pxQueue )
 
 		pxQueue->cTxLock = queueUNLOCKED;
 	}
-	taskEXIT_CRITICAL();
+	queueEXIT_CRITICAL( pxQueue );
 
 	/* Do the same for the Rx lock. */
-	taskENTER_CRITICAL();
+	queueENTER_CRITICAL( pxQueue );
 	{
 		int8_t cRxLock = pxQueue->cRxLock;
 
@@ -2284,7 +2547,7 @@ static void prvUnlockQueue( Queue_t * const pxQueue )
 
 		pxQueue->cRxLock = queueUNLOCKED;
 	}
-	taskEXIT_CRITICAL();
+	queueEXIT_CRITICAL( pxQueue );
 }
 /*-----------------------------------------------------------*/
 
@@ -2292,7 +2555,7 @@ static BaseType_t prvIsQueueEmpty( const Queue_t *pxQueue )
 {
 BaseType_t xReturn;
 
-	taskENTER_CRITICAL();
+	queueENTER_CRITICAL( pxQueue );
 	{
 		if( pxQueue->uxMessagesWaiting == ( UBaseType_t )  0 )
 		{
@@ -2303,7 +2566,7 @@ BaseType_t xReturn;
 			xReturn = pdFALSE;
 		}
 	}
-	taskEXIT_CRITICAL();
+	queueEXIT_CRITICAL( pxQueue );
 
 	return xReturn;
 }
@@ -2332,7 +2595,7 @@ static BaseType_t prvIsQueueFull( const Queue_t *pxQueue )
 {
 BaseType_t xReturn;
 
-	taskENTER_CRITICAL();
+	queueENTER_CRITICAL( pxQueue );
 	{
 		if( pxQueue->uxMessagesWaiting == pxQueue->uxLength )
 		{
@@ -2343,7 +2606,7 @@ BaseType_t xReturn;
 			xReturn = pdFALSE;
 		}
 	}
-	taskEXIT_CRITICAL();
+	queueEXIT_CRITICAL( pxQueue );
 
 	return xReturn;
 }
@@ -2788,7 +3051,7 @@ Queue_t * const pxQueue = xQueue;
 	{
 	BaseType_t xReturn;
 
-		taskENTER_CRITICAL();
+		queueENTER_CRITICAL( xQueueOrSemaphore );
 		{
 			if( ( ( Queue_t * ) xQueueOrSemaphore )->pxQueueSetContainer != NULL )
 			{
@@ -2807,7 +3070,7 @@ Queue_t * const pxQueue = xQueue;
 				xReturn = pdPASS;
 			}
 		}
-		taskEXIT_CRITICAL();
+		queueEXIT_CRITICAL( xQueueOrSemaphore );
 
 		return xReturn;
 	}
@@ -2836,12 +3099,12 @@ Queue_t * const pxQueue = xQueue;
 		}
 		else
 		{
-			taskENTER_CRITICAL();
+			queueENTER_CRITICAL( pxQueueOrSemaphore );
 			{
 				/* The queue is no longer contained in the set. */
 				pxQueueOrSemaphore->pxQueueSetContainer = NULL;
 			}
-			taskEXIT_CRITICAL();
+			queueEXIT_CRITICAL( pxQueueOrSemaphore );
 			xReturn = pdPASS;
 		}
 
@@ -2883,8 +3146,18 @@ Queue_t * const pxQueue = xQueue;
 	{
 	Queue_t *pxQueueSetContainer = pxQueue->pxQueueSetContainer;
 	BaseType_t xReturn = pdFALSE;
+	#if( configUSE_OBJECT_LOCKS == 1 )
+		UBaseType_t uxSavedInterruptStatus;
+	#endif
 
-		/* This function must be called form a critical section. */
+		/* This function must be called form a critical section.  With object
+		locks that is the critical section of the member queue, so the lock of
+		the set is taken as well.  It is called from tasks and from ISRs. */
+		#if( configUSE_OBJECT_LOCKS == 1 )
+		{
+			uxSavedInterruptStatus = queueENTER_CRITICAL_FROM_ISR( pxQueueSetContainer );
+		}
+		#endif
 
 		configASSERT( pxQueueSetContainer );
 		configASSERT( pxQueueSetContainer->uxMessagesWaiting < pxQueueSetContainer->uxLength );
@@ -2927,6 +3200,12 @@ Queue_t * const pxQueue = xQueue;
 			mtCOVERAGE_TEST_MARKER();
 		}
 
+		#if( configUSE_OBJECT_LOCKS == 1 )
+		{
+			queueEXIT_CRITICAL_FROM_ISR( pxQueueSetContainer, uxSavedInterruptStatus );
+		}
+		#endif
+
 		return xReturn;
 	}
 
@@ -49,6 +49,26 @@ for the header files above, but not in this file, in order to generate the
 correct privileged Vs unprivileged linkage and placement. */
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE /*lint !e961 !e750 !e9021. */
 
+/* With configUSE_OBJECT_LOCKS set, the critical sections that guard a stream
+buffer take only the buffer's own lock.  The default notification macros below
+also hold it while suspending the scheduler, as that only stops tasks on the
+calling core. */
+#if( configUSE_OBJECT_LOCKS == 1 )
+	#define sbENTER_CRITICAL( pxStreamBuffer )		portENTER_OBJECT_CRITICAL( &( ( pxStreamBuffer )->xObjectLock ) )
+	#define sbEXIT_CRITICAL( pxStreamBuffer )		portEXIT_OBJECT_CRITICAL( &( ( pxStreamBuffer )->xObjectLock ) )
+	#define sbENTER_CRITICAL_FROM_ISR( pxStreamBuffer )	portENTER_OBJECT_CRITICAL_FROM_ISR( &( ( pxStreamBuffer )->xObjectLock ) )
+	#define sbEXIT_CRITICAL_FROM_ISR( pxStreamBuffer, x )	portEXIT_OBJECT_CRITICAL_FROM_ISR( &( ( pxStreamBuffer )->xObjectLock ), ( x ) )
+	#define sbLOCK_BUFFER( pxStreamBuffer )			sbENTER_CRITICAL( pxStreamBuffer )
+	#define sbUNLOCK_BUFFER( pxStreamBuffer )		sbEXIT_CRITICAL( pxStreamBuffer )
+#else
+	#define sbENTER_CRITICAL( pxStreamBuffer )		taskENTER_CRITICAL()
+	#define sbEXIT_CRITICAL( pxStreamBuffer )		taskEXIT_CRITICAL()
+	#define sbENTER_CRITICAL_FROM_ISR( pxStreamBuffer )	portSET_INTERRUPT_MASK_FROM_ISR()
+	#define sbEXIT_CRITICAL_FROM_ISR( pxStreamBuffer, x )	portCLEAR_INTERRUPT_MASK_FROM_ISR( ( x ) )
+	#define sbLOCK_BUFFER( pxStreamBuffer )
+	#define sbUNLOCK_BUFFER( pxStreamBuffer )
+#endif
+
 /* If the user has not provided application specific Rx notification macros,
 or #defined the notification macros away, them provide default implementations
 that uses task notifications. */
@@ -56,6 +76,7 @@ that uses task notifications. */
 #ifndef sbRECEIVE_COMPLETED
 	#define sbRECEIVE_COMPLETED( pxStreamBuffer )										\
 		vTaskSuspendAll();																\
+		sbLOCK_BUFFER( pxStreamBuffer );												\
 		{																				\
 			if( ( pxStreamBuffer )->xTaskWaitingToSend != NULL )						\
 			{																			\
@@ -65,6 +86,7 @@ that uses task notifications. */
 				( pxStreamBuffer )->xTaskWaitingToSend = NULL;							\
 			}																			\
 		}																				\
+		sbUNLOCK_BUFFER( pxStreamBuffer );												\
 		( void ) xTaskResumeAll();
 #endif /* sbRECEIVE_COMPLETED */
 
@@ -74,7 +96,7 @@ that uses task notifications. */
 	{																					\
 	UBaseType_t uxSavedInterruptStatus;													\
 																						\
-		uxSavedInterruptStatus = ( UBaseType_t ) portSET_INTERRUPT_MASK_FROM_ISR();		\
+		uxSavedInterruptStatus = ( UBaseType_t ) sbENTER_CRITICAL_FROM_ISR( pxStreamBuffer );	\
 		{																				\
 			if( ( pxStreamBuffer )->xTaskWaitingToSend != NULL )						\
 			{																			\
@@ -85,7 +107,7 @@ that uses task notifications. */
 				( pxStreamBuffer )->xTaskWaitingToSend = NULL;							\
 			}																			\
 		}																				\
-		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );					\
+		sbEXIT_CRITICAL_FROM_ISR( pxStreamBuffer, uxSavedInterruptStatus );				\
 	}
 #endif /* sbRECEIVE_COMPLETED_FROM_ISR */
 
@@ -95,6 +117,7 @@ that uses task notifications. */
 #ifndef sbSEND_COMPLETED
 	#define sbSEND_COMPLETED( pxStreamBuffer )											\
 		vTaskSuspendAll();																\
+		sbLOCK_BUFFER( pxStreamBuffer );												\
 		{																				\
 			if( ( pxStreamBuffer )->xTaskWaitingToReceive != NULL )						\
 			{																			\
@@ -104,6 +127,7 @@ that uses task notifications. */
 				( pxStreamBuffer )->xTaskWaitingToReceive = NULL;						\
 			}																			\
 		}																				\
+		sbUNLOCK_BUFFER( pxStreamBuffer );												\
 		( void ) xTaskResumeAll();
 #endif /* sbSEND_COMPLETED */
 
@@ -112,7 +136,7 @@ that uses task notifications. */
 	{																					\
 	UBaseType_t uxSavedInterruptStatus;													\
 																						\
-		uxSavedInterruptStatus = ( UBaseType_t ) portSET_INTERRUPT_MASK_FROM_ISR();		\
+		uxSavedInterruptStatus = ( UBaseType_t ) sbENTER_CRITICAL_FROM_ISR( pxStreamBuffer );	\
 		{																				\
 			if( ( pxStreamBuffer )->xTaskWaitingToReceive != NULL )						\
 			{																			\
@@ -123,7 +147,7 @@ that uses task notifications. */
 				( pxStreamBuffer )->xTaskWaitingToReceive = NULL;						\
 			}																			\
 		}																				\
-		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );					\
+		sbEXIT_CRITICAL_FROM_ISR( pxStreamBuffer, uxSavedInterruptStatus );				\
 	}
 #endif /* sbSEND_COMPLETE_FROM_ISR */
 /*lint -restore (9026) */
@@ -152,6 +176,15 @@ typedef struct StreamBufferDef_t /*lint !e9058 Style convention uses tag. */
 	#if ( configUSE_TRACE_FACILITY == 1 )
 		UBaseType_t uxStreamBufferNumber;		/* Used for tracing purposes. */
 	#endif
+
+	#if ( configUSE_STREAM_BUFFER_FLUSH_DEADLINE == 1 )
+		TickType_t xFlushDeadlineTicks;		/* A waiting reader is unblocked once this long has passed since xFirstByteTime, even below the trigger level.  0 disables the deadline. */
+		TickType_t xFirstByteTime;			/* Tick count at which the buffer last went from empty to holding data.  Deliberately not moved by a read that leaves data behind, see vStreamBufferSetFlushDeadline(). */
+	#endif
+
+	#if ( configUSE_OBJECT_LOCKS == 1 )
+		portOBJECT_LOCK_TYPE xObjectLock;	/* Guards the waiting task handles, see configUSE_OBJECT_LOCKS.  Must stay the last member, see prvInitialiseNewStreamBuffer(). */
+	#endif
 } StreamBuffer_t;
 
 /*
@@ -160,12 +193,15 @@ typedef struct StreamBufferDef_t /*lint !e9058 Style convention uses tag. */
 static size_t prvBytesInBuffer( const StreamBuffer_t * const pxStreamBuffer ) PRIVILEGED_FUNCTION;
 
 /*
- * Add xCount bytes from pucData into the pxStreamBuffer message buffer.
- * Returns the number of bytes written, which will either equal xCount in the
- * success case, or 0 if there was not enough space in the buffer (in which case
- * no data is written into the buffer).
+ * Copy xCount bytes from pucData into the pxStreamBuffer buffer, starting at
+ * index xHead.  Returns the index that follows the last byte written.  The
+ * buffer's own head is not updated, so data written in several parts can be
+ * made visible to the reader in one step.
  */
-static size_t prvWriteBytesToBuffer( StreamBuffer_t * const pxStreamBuffer, const uint8_t *pucData, size_t xCount ) PRIVILEGED_FUNCTION;
+static size_t prvWriteBytesToBuffer( StreamBuffer_t * const pxStreamBuffer,
+									 const uint8_t *pucData,
+									 size_t xCount,
+									 size_t xHead ) PRIVILEGED_FUNCTION;
 
 /*
  * If the stream buffer is being used as a message buffer, then reads an entire
@@ -175,7 +211,8 @@ static size_t prvWriteBytesToBuffer( StreamBuffer_t * const pxStreamBuffer, cons
  * buffer's data storage area.
  */
 static size_t prvReadMessageFromBuffer( StreamBuffer_t *pxStreamBuffer,
-										void *pvRxData,
+										const StreamBufferSegment_t * const pxSegments,
+										UBaseType_t uxSegmentCount,
 										size_t xBufferLengthBytes,
 										size_t xBytesAvailable,
 										size_t xBytesToStoreMessageLength ) PRIVILEGED_FUNCTION;
@@ -188,19 +225,30 @@ static size_t prvReadMessageFromBuffer( StreamBuffer_t *pxStreamBuffer,
  * data storage area.
  */
 static size_t prvWriteMessageToBuffer(  StreamBuffer_t * const pxStreamBuffer,
-										const void * pvTxData,
+										const StreamBufferSegment_t * const pxSegments,
+										UBaseType_t uxSegmentCount,
 										size_t xDataLengthBytes,
 										size_t xSpace,
 										size_t xRequiredSpace ) PRIVILEGED_FUNCTION;
 
 /*
- * Read xMaxCount bytes from the pxStreamBuffer message buffer and write them
- * to pucData.
+ * Copy xCount bytes out of the pxStreamBuffer buffer, starting at index xTail,
+ * into pucData.  Returns the index that follows the last byte read.  The
+ * buffer's own tail is not updated, so the space is only released to the
+ * writer once the caller has finished with it.
  */
-static size_t prvReadBytesFromBuffer( StreamBuffer_t *pxStreamBuffer,
+static size_t prvReadBytesFromBuffer( const StreamBuffer_t *pxStreamBuffer,
 									  uint8_t *pucData,
-									  size_t xMaxCount,
-									  size_t xBytesAvailable ) PRIVILEGED_FUNCTION;
+									  size_t xCount,
+									  size_t xTail ) PRIVILEGED_FUNCTION;
+
+/*
+ * Returns the total number of bytes described by an array of segments, or 0 if
+ * the total does not fit in a size_t - in which case nothing is sent or
+ * received.
+ */
+static size_t prvSegmentsLength( const StreamBufferSegment_t * const pxSegments,
+								 UBaseType_t uxSegmentCount ) PRIVILEGED_FUNCTION;
 
 /*
  * Called by both pxStreamBufferCreate() and pxStreamBufferCreateStatic() to
@@ -212,6 +260,31 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
 										  size_t xTriggerLevelBytes,
 										  uint8_t ucFlags ) PRIVILEGED_FUNCTION;
 
+#if( configUSE_STREAM_BUFFER_FLUSH_DEADLINE == 1 )
+
+	/*
+	 * Called after xBytesWritten bytes have been added to the buffer.  If the
+	 * buffer was empty before the write then xTimeNow is recorded as the time
+	 * the buffer started holding data, which the deadline is timed from until
+	 * the buffer is next emptied, and pdTRUE is returned if the buffer has a
+	 * flush deadline - in which case a blocked reader must be woken so it can
+	 * start timing the deadline.
+	 */
+	static BaseType_t prvRecordArrivalTime( StreamBuffer_t * const pxStreamBuffer,
+											size_t xBytesWritten,
+											TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Blocks the calling task until the trigger level is reached, the oldest
+	 * unread byte has been in the buffer for the flush deadline, or
+	 * xTicksToWait expires - whichever comes first.
+	 */
+	static void prvWaitForTriggerOrDeadline( StreamBuffer_t * const pxStreamBuffer,
+											 size_t xBytesToStoreMessageLength,
+											 TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_STREAM_BUFFER_FLUSH_DEADLINE */
+
 /*-----------------------------------------------------------*/
 
 #if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
@@ -265,6 +338,12 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
 										   xTriggerLevelBytes,
 										   ucFlags );
 
+			#if( configUSE_OBJECT_LOCKS == 1 )
+			{
+				portOBJECT_LOCK_INIT( &( ( ( StreamBuffer_t * ) pucAllocatedMemory )->xObjectLock ) ); /*lint !e9087 !e826 See above. */
+			}
+			#endif
+
 			traceSTREAM_BUFFER_CREATE( ( ( StreamBuffer_t * ) pucAllocatedMemory ), xIsMessageBuffer );
 		}
 		else
@@ -336,6 +415,12 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
 										  xTriggerLevelBytes,
 										  ucFlags );
 
+			#if( configUSE_OBJECT_LOCKS == 1 )
+			{
+				portOBJECT_LOCK_INIT( &( pxStreamBuffer->xObjectLock ) );
+			}
+			#endif
+
 			/* Remember this was statically allocated in case it is ever deleted
 			again. */
 			pxStreamBuffer->ucFlags |= sbFLAGS_IS_STATICALLY_ALLOCATED;
@@ -397,6 +482,9 @@ BaseType_t xReturn = pdFAIL;
 #if( configUSE_TRACE_FACILITY == 1 )
 	UBaseType_t uxStreamBufferNumber;
 #endif
+#if( configUSE_STREAM_BUFFER_FLUSH_DEADLINE == 1 )
+	TickType_t xFlushDeadlineTicks;
+#endif
 
 	configASSERT( pxStreamBuffer );
 
@@ -408,8 +496,14 @@ BaseType_t xReturn = pdFAIL;
 	}
 	#endif
 
+	#if( configUSE_STREAM_BUFFER_FLUSH_DEADLINE == 1 )
+	{
+		xFlushDeadlineTicks = pxStreamBuffer->xFlushDeadlineTicks;
+	}
+	#endif
+
 	/* Can only reset a message buffer if there are no tasks blocked on it. */
-	taskENTER_CRITICAL();
+	sbENTER_CRITICAL( pxStreamBuffer );
 	{
 		if( pxStreamBuffer->xTaskWaitingToReceive == NULL )
 		{
@@ -428,11 +522,17 @@ BaseType_t xReturn = pdFAIL;
 				}
 				#endif
 
+				#if( configUSE_STREAM_BUFFER_FLUSH_DEADLINE == 1 )
+				{
+					pxStreamBuffer->xFlushDeadlineTicks = xFlushDeadlineTicks;
+				}
+				#endif
+
 				traceSTREAM_BUFFER_RESET( xStreamBuffer );
 			}
 		}
 	}
-	taskEXIT_CRITICAL();
+	sbEXIT_CRITICAL( pxStreamBuffer );
 
 	return xReturn;
 }
@@ -467,6 +567,35 @@ BaseType_t xReturn;
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_STREAM_BUFFER_FLUSH_DEADLINE == 1 )
+
+	void vStreamBufferSetFlushDeadline( StreamBufferHandle_t xStreamBuffer, TickType_t xFlushDeadline )
+	{
+	StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+
+		configASSERT( pxStreamBuffer );
+
+		/* A reader that is already blocked picks the new value up the next
+		time it is woken. */
+		pxStreamBuffer->xFlushDeadlineTicks = xFlushDeadline;
+	}
+
+#endif /* configUSE_STREAM_BUFFER_FLUSH_DEADLINE */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_STREAM_BUFFER_FLUSH_DEADLINE == 1 )
+
+	TickType_t xStreamBufferGetFlushDeadline( StreamBufferHandle_t xStreamBuffer )
+	{
+	const StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+
+		configASSERT( pxStreamBuffer );
+		return pxStreamBuffer->xFlushDeadlineTicks;
+	}
+
+#endif /* configUSE_STREAM_BUFFER_FLUSH_DEADLINE */
+/*-----------------------------------------------------------*/
+
 size_t xStreamBufferSpacesAvailable( StreamBufferHandle_t xStreamBuffer )
 {
 const StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
@@ -508,14 +637,36 @@ size_t xStreamBufferSend( StreamBufferHandle_t xStreamBuffer,
 						  size_t xDataLengthBytes,
 						  TickType_t xTicksToWait )
 {
+StreamBufferSegment_t xSegment;
+
+	configASSERT( pvTxData );
+
+	xSegment.pvData = ( void * ) pvTxData; /*lint !e9005 The data is only read. */
+	xSegment.xLength = xDataLengthBytes;
+
+	return xStreamBufferSendV( xStreamBuffer, &xSegment, 1, xTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSendV( StreamBufferHandle_t xStreamBuffer,
+						   const StreamBufferSegment_t * const pxSegments,
+						   UBaseType_t uxSegmentCount,
+						   TickType_t xTicksToWait )
+{
 StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
 size_t xReturn, xSpace = 0;
-size_t xRequiredSpace = xDataLengthBytes;
+size_t xDataLengthBytes, xRequiredSpace;
 TimeOut_t xTimeOut;
+BaseType_t xFirstData = pdFALSE;
 
-	configASSERT( pvTxData );
+	configASSERT( pxSegments );
 	configASSERT( pxStreamBuffer );
 
+	/* The segments are written one after the other, as if they were a single
+	block of data. */
+	xDataLengthBytes = prvSegmentsLength( pxSegments, uxSegmentCount );
+	xRequiredSpace = xDataLengthBytes;
+
 	/* This send function is used to write to both message buffers and stream
 	buffers.  If this is a message buffer then the space needed must be
 	increased by the amount of bytes needed to store the length of the
@@ -526,6 +677,10 @@ TimeOut_t xTimeOut;
 
 		/* Overflow? */
 		configASSERT( xRequiredSpace > xDataLengthBytes );
+
+		/* A message must contain at least one byte, otherwise it could never
+		be received. */
+		configASSERT( xDataLengthBytes > ( size_t ) 0 );
 	}
 	else
 	{
@@ -540,7 +695,7 @@ TimeOut_t xTimeOut;
 		{
 			/* Wait until the required number of bytes are free in the message
 			buffer. */
-			taskENTER_CRITICAL();
+			sbENTER_CRITICAL( pxStreamBuffer );
 			{
 				xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
 
@@ -555,11 +710,11 @@ TimeOut_t xTimeOut;
 				}
 				else
 				{
-					taskEXIT_CRITICAL();
+					sbEXIT_CRITICAL( pxStreamBuffer );
 					break;
 				}
 			}
-			taskEXIT_CRITICAL();
+			sbEXIT_CRITICAL( pxStreamBuffer );
 
 			traceBLOCKING_ON_STREAM_BUFFER_SEND( xStreamBuffer );
 			( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
@@ -581,14 +736,22 @@ TimeOut_t xTimeOut;
 		mtCOVERAGE_TEST_MARKER();
 	}
 
-	xReturn = prvWriteMessageToBuffer( pxStreamBuffer, pvTxData, xDataLengthBytes, xSpace, xRequiredSpace );
+	xReturn = prvWriteMessageToBuffer( pxStreamBuffer, pxSegments, uxSegmentCount, xDataLengthBytes, xSpace, xRequiredSpace );
 
 	if( xReturn > ( size_t ) 0 )
 	{
 		traceSTREAM_BUFFER_SEND( xStreamBuffer, xReturn );
 
+		#if( configUSE_STREAM_BUFFER_FLUSH_DEADLINE == 1 )
+		{
+			/* xRequiredSpace - xDataLengthBytes is the size of the message
+			length, if any, that was written ahead of the data. */
+			xFirstData = prvRecordArrivalTime( pxStreamBuffer, xReturn + ( xRequiredSpace - xDataLengthBytes ), xTaskGetTickCount() );
+		}
+		#endif
+
 		/* Was a task waiting for the data? */
-		if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+		if( ( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes ) || ( xFirstData != pdFALSE ) )
 		{
 			sbSEND_COMPLETED( pxStreamBuffer );
 		}
@@ -615,10 +778,15 @@ size_t xStreamBufferSendFromISR( StreamBufferHandle_t xStreamBuffer,
 StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
 size_t xReturn, xSpace;
 size_t xRequiredSpace = xDataLengthBytes;
+BaseType_t xFirstData = pdFALSE;
+StreamBufferSegment_t xSegment;
 
 	configASSERT( pvTxData );
 	configASSERT( pxStreamBuffer );
 
+	xSegment.pvData = ( void * ) pvTxData; /*lint !e9005 The data is only read. */
+	xSegment.xLength = xDataLengthBytes;
+
 	/* This send function is used to write to both message buffers and stream
 	buffers.  If this is a message buffer then the space needed must be
 	increased by the amount of bytes needed to store the length of the
@@ -633,12 +801,18 @@ size_t xRequiredSpace = xDataLengthBytes;
 	}
 
 	xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
-	xReturn = prvWriteMessageToBuffer( pxStreamBuffer, pvTxData, xDataLengthBytes, xSpace, xRequiredSpace );
+	xReturn = prvWriteMessageToBuffer( pxStreamBuffer, &xSegment, 1, xDataLengthBytes, xSpace, xRequiredSpace );
 
 	if( xReturn > ( size_t ) 0 )
 	{
+		#if( configUSE_STREAM_BUFFER_FLUSH_DEADLINE == 1 )
+		{
+			xFirstData = prvRecordArrivalTime( pxStreamBuffer, xReturn + ( xRequiredSpace - xDataLengthBytes ), xTaskGetTickCountFromISR() );
+		}
+		#endif
+
 		/* Was a task waiting for the data? */
-		if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+		if( ( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes ) || ( xFirstData != pdFALSE ) )
 		{
 			sbSEND_COMPLETE_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
 		}
@@ -659,13 +833,20 @@ size_t xRequiredSpace = xDataLengthBytes;
 /*-----------------------------------------------------------*/
 
 static size_t prvWriteMessageToBuffer( StreamBuffer_t * const pxStreamBuffer,
-									   const void * pvTxData,
+									   const StreamBufferSegment_t * const pxSegments,
+									   UBaseType_t uxSegmentCount,
 									   size_t xDataLengthBytes,
 									   size_t xSpace,
 									   size_t xRequiredSpace )
 {
 	BaseType_t xShouldWrite;
-	size_t xReturn;
+	size_t xReturn, xNextHead, xSegmentLength;
+	UBaseType_t uxSegment;
+	configMESSAGE_BUFFER_LENGTH_TYPE xMessageLength;
+
+	/* Use a local copy of the head so the message, including its length, only
+	becomes visible to the reader once it has been completely written. */
+	xNextHead = pxStreamBuffer->xHead;
 
 	if( xSpace == ( size_t ) 0 )
 	{
@@ -688,7 +869,8 @@ static size_t prvWriteMessageToBuffer( StreamBuffer_t * const pxStreamBuffer,
 		into the buffer.  Start by writing the length of the data, the data
 		itself will be written later in this function. */
 		xShouldWrite = pdTRUE;
-		( void ) prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) &( xDataLengthBytes ), sbBYTES_TO_STORE_MESSAGE_LENGTH );
+		xMessageLength = ( configMESSAGE_BUFFER_LENGTH_TYPE ) xDataLengthBytes;
+		xNextHead = prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) &( xMessageLength ), sbBYTES_TO_STORE_MESSAGE_LENGTH, xNextHead );
 	}
 	else
 	{
@@ -698,8 +880,26 @@ static size_t prvWriteMessageToBuffer( StreamBuffer_t * const pxStreamBuffer,
 
 	if( xShouldWrite != pdFALSE )
 	{
-		/* Writes the data itself. */
-		xReturn = prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) pvTxData, xDataLengthBytes ); /*lint !e9079 Storage buffer is implemented as uint8_t for ease of sizing, alighment and access. */
+		/* Writes the data itself, one segment after the other, stopping once
+		xDataLengthBytes have been written. */
+		xReturn = 0;
+
+		for( uxSegment = 0; ( uxSegment < uxSegmentCount ) && ( xReturn < xDataLengthBytes ); uxSegment++ )
+		{
+			xSegmentLength = configMIN( pxSegments[ uxSegment ].xLength, xDataLengthBytes - xReturn );
+
+			if( xSegmentLength > ( size_t ) 0 )
+			{
+				xNextHead = prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) pxSegments[ uxSegment ].pvData, xSegmentLength, xNextHead ); /*lint !e9079 Storage buffer is implemented as uint8_t for ease of sizing, alighment and access. */
+				xReturn += xSegmentLength;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+
+		pxStreamBuffer->xHead = xNextHead;
 	}
 	else
 	{
@@ -715,12 +915,33 @@ size_t xStreamBufferReceive( StreamBufferHandle_t xStreamBuffer,
 							 size_t xBufferLengthBytes,
 							 TickType_t xTicksToWait )
 {
+StreamBufferSegment_t xSegment;
+
+	configASSERT( pvRxData );
+
+	xSegment.pvData = pvRxData;
+	xSegment.xLength = xBufferLengthBytes;
+
+	return xStreamBufferReceiveV( xStreamBuffer, &xSegment, 1, xTicksToWait );
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferReceiveV( StreamBufferHandle_t xStreamBuffer,
+							  const StreamBufferSegment_t * const pxSegments,
+							  UBaseType_t uxSegmentCount,
+							  TickType_t xTicksToWait )
+{
 StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
 size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
+size_t xBufferLengthBytes;
 
-	configASSERT( pvRxData );
+	configASSERT( pxSegments );
 	configASSERT( pxStreamBuffer );
 
+	/* The segments are filled one after the other, as if they were a single
+	buffer. */
+	xBufferLengthBytes = prvSegmentsLength( pxSegments, uxSegmentCount );
+
 	/* This receive function is used by both message buffers, which store
 	discrete messages, and stream buffers, which store a continuous stream of
 	bytes.  Discrete messages include an additional
@@ -735,11 +956,28 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 		xBytesToStoreMessageLength = 0;
 	}
 
+	#if( configUSE_STREAM_BUFFER_FLUSH_DEADLINE == 1 )
+	{
+		/* With a flush deadline the reader does not return as soon as any data
+		is present, but waits for the trigger level or the deadline.  The wait
+		is done here, after which the buffer is read without blocking. */
+		if( ( xTicksToWait != ( TickType_t ) 0 ) && ( pxStreamBuffer->xFlushDeadlineTicks != ( TickType_t ) 0 ) )
+		{
+			prvWaitForTriggerOrDeadline( pxStreamBuffer, xBytesToStoreMessageLength, xTicksToWait );
+			xTicksToWait = 0;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif
+
 	if( xTicksToWait != ( TickType_t ) 0 )
 	{
 		/* Checking if there is data and clearing the notification state must be
 		performed atomically. */
-		taskENTER_CRITICAL();
+		sbENTER_CRITICAL( pxStreamBuffer );
 		{
 			xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
 
@@ -762,7 +1000,7 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 				mtCOVERAGE_TEST_MARKER();
 			}
 		}
-		taskEXIT_CRITICAL();
+		sbEXIT_CRITICAL( pxStreamBuffer );
 
 		if( xBytesAvailable <= xBytesToStoreMessageLength )
 		{
@@ -791,7 +1029,7 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 	read bytes from the buffer. */
 	if( xBytesAvailable > xBytesToStoreMessageLength )
 	{
-		xReceivedLength = prvReadMessageFromBuffer( pxStreamBuffer, pvRxData, xBufferLengthBytes, xBytesAvailable, xBytesToStoreMessageLength );
+		xReceivedLength = prvReadMessageFromBuffer( pxStreamBuffer, pxSegments, uxSegmentCount, xBufferLengthBytes, xBytesAvailable, xBytesToStoreMessageLength );
 
 		/* Was a task waiting for space in the buffer? */
 		if( xReceivedLength != ( size_t ) 0 )
@@ -817,7 +1055,7 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 size_t xStreamBufferNextMessageLengthBytes( StreamBufferHandle_t xStreamBuffer )
 {
 StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
-size_t xReturn, xBytesAvailable, xOriginalTail;
+size_t xReturn, xBytesAvailable;
 configMESSAGE_BUFFER_LENGTH_TYPE xTempReturn;
 
 	configASSERT( pxStreamBuffer );
@@ -831,13 +1069,9 @@ configMESSAGE_BUFFER_LENGTH_TYPE xTempReturn;
 			/* The number of bytes available is greater than the number of bytes
 			required to hold the length of the next message, so another message
 			is available.  Return its length without removing the length bytes
-			from the buffer.  A copy of the tail is stored so the buffer can be
-			returned to its prior state as the message is not actually being
-			removed from the buffer. */
-			xOriginalTail = pxStreamBuffer->xTail;
-			( void ) prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempReturn, sbBYTES_TO_STORE_MESSAGE_LENGTH, xBytesAvailable );
+			from the buffer - the tail is not moved. */
+			( void ) prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempReturn, sbBYTES_TO_STORE_MESSAGE_LENGTH, pxStreamBuffer->xTail );
 			xReturn = ( size_t ) xTempReturn;
-			pxStreamBuffer->xTail = xOriginalTail;
 		}
 		else
 		{
@@ -865,10 +1099,14 @@ size_t xStreamBufferReceiveFromISR( StreamBufferHandle_t xStreamBuffer,
 {
 StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
 size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
+StreamBufferSegment_t xSegment;
 
 	configASSERT( pvRxData );
 	configASSERT( pxStreamBuffer );
 
+	xSegment.pvData = pvRxData;
+	xSegment.xLength = xBufferLengthBytes;
+
 	/* This receive function is used by both message buffers, which store
 	discrete messages, and stream buffers, which store a continuous stream of
 	bytes.  Discrete messages include an additional
@@ -892,7 +1130,7 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 	read bytes from the buffer. */
 	if( xBytesAvailable > xBytesToStoreMessageLength )
 	{
-		xReceivedLength = prvReadMessageFromBuffer( pxStreamBuffer, pvRxData, xBufferLengthBytes, xBytesAvailable, xBytesToStoreMessageLength );
+		xReceivedLength = prvReadMessageFromBuffer( pxStreamBuffer, &xSegment, 1, xBufferLengthBytes, xBytesAvailable, xBytesToStoreMessageLength );
 
 		/* Was a task waiting for space in the buffer? */
 		if( xReceivedLength != ( size_t ) 0 )
@@ -916,22 +1154,26 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 /*-----------------------------------------------------------*/
 
 static size_t prvReadMessageFromBuffer( StreamBuffer_t *pxStreamBuffer,
-										void *pvRxData,
+										const StreamBufferSegment_t * const pxSegments,
+										UBaseType_t uxSegmentCount,
 										size_t xBufferLengthBytes,
 										size_t xBytesAvailable,
 										size_t xBytesToStoreMessageLength )
 {
-size_t xOriginalTail, xReceivedLength, xNextMessageLength;
+size_t xNextTail, xCount, xReceivedLength = 0, xNextMessageLength, xSegmentLength;
 configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
+UBaseType_t uxSegment;
+
+	/* Use a local copy of the tail so the space is only released to the
+	writer once the whole message has been read - and not at all if the
+	message does not fit in the buffer provided. */
+	xNextTail = pxStreamBuffer->xTail;
 
 	if( xBytesToStoreMessageLength != ( size_t ) 0 )
 	{
 		/* A discrete message is being received.  First receive the length
-		of the message.  A copy of the tail is stored so the buffer can be
-		returned to its prior state if the length of the message is too
-		large for the provided buffer. */
-		xOriginalTail = pxStreamBuffer->xTail;
-		( void ) prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempNextMessageLength, xBytesToStoreMessageLength, xBytesAvailable );
+		of the message. */
+		xNextTail = prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempNextMessageLength, xBytesToStoreMessageLength, xNextTail );
 		xNextMessageLength = ( size_t ) xTempNextMessageLength;
 
 		/* Reduce the number of bytes available by the number of bytes just
@@ -942,10 +1184,8 @@ configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
 		user. */
 		if( xNextMessageLength > xBufferLengthBytes )
 		{
-			/* The user has provided insufficient space to read the message
-			so return the buffer to its previous state (so the length of
-			the message is in the buffer again). */
-			pxStreamBuffer->xTail = xOriginalTail;
+			/* The user has provided insufficient space to read the message,
+			so leave it in the buffer. */
 			xNextMessageLength = 0;
 		}
 		else
@@ -960,8 +1200,35 @@ configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
 		xNextMessageLength = xBufferLengthBytes;
 	}
 
-	/* Read the actual data. */
-	xReceivedLength = prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) pvRxData, xNextMessageLength, xBytesAvailable ); /*lint !e9079 Data storage area is implemented as uint8_t array for ease of sizing, indexing and alignment. */
+	/* Use the minimum of the wanted bytes and the available bytes. */
+	xCount = configMIN( xNextMessageLength, xBytesAvailable );
+
+	if( xCount > ( size_t ) 0 )
+	{
+		/* Read the actual data, filling one segment after the other. */
+		for( uxSegment = 0; ( uxSegment < uxSegmentCount ) && ( xReceivedLength < xCount ); uxSegment++ )
+		{
+			xSegmentLength = configMIN( pxSegments[ uxSegment ].xLength, xCount - xReceivedLength );
+
+			if( xSegmentLength > ( size_t ) 0 )
+			{
+				xNextTail = prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) pxSegments[ uxSegment ].pvData, xSegmentLength, xNextTail ); /*lint !e9079 Data storage area is implemented as uint8_t array for ease of sizing, indexing and alignment. */
+				xReceivedLength += xSegmentLength;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+
+		/* Move the tail to effectively remove the data read from the
+		buffer. */
+		pxStreamBuffer->xTail = xNextTail;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
 
 	return xReceivedLength;
 }
@@ -1033,7 +1300,7 @@ UBaseType_t uxSavedInterruptStatus;
 
 	configASSERT( pxStreamBuffer );
 
-	uxSavedInterruptStatus = ( UBaseType_t ) portSET_INTERRUPT_MASK_FROM_ISR();
+	uxSavedInterruptStatus = ( UBaseType_t ) sbENTER_CRITICAL_FROM_ISR( pxStreamBuffer );
 	{
 		if( ( pxStreamBuffer )->xTaskWaitingToReceive != NULL )
 		{
@@ -1049,7 +1316,7 @@ UBaseType_t uxSavedInterruptStatus;
 			xReturn = pdFALSE;
 		}
 	}
-	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	sbEXIT_CRITICAL_FROM_ISR( pxStreamBuffer, uxSavedInterruptStatus );
 
 	return xReturn;
 }
@@ -1063,7 +1330,7 @@ UBaseType_t uxSavedInterruptStatus;
 
 	configASSERT( pxStreamBuffer );
 
-	uxSavedInterruptStatus = ( UBaseType_t ) portSET_INTERRUPT_MASK_FROM_ISR();
+	uxSavedInterruptStatus = ( UBaseType_t ) sbENTER_CRITICAL_FROM_ISR( pxStreamBuffer );
 	{
 		if( ( pxStreamBuffer )->xTaskWaitingToSend != NULL )
 		{
@@ -1079,28 +1346,26 @@ UBaseType_t uxSavedInterruptStatus;
 			xReturn = pdFALSE;
 		}
 	}
-	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	sbEXIT_CRITICAL_FROM_ISR( pxStreamBuffer, uxSavedInterruptStatus );
 
 	return xReturn;
 }
 /*-----------------------------------------------------------*/
 
-static size_t prvWriteBytesToBuffer( StreamBuffer_t * const pxStreamBuffer, const uint8_t *pucData, size_t xCount )
+static size_t prvWriteBytesToBuffer( StreamBuffer_t * const pxStreamBuffer, const uint8_t *pucData, size_t xCount, size_t xHead )
 {
-size_t xNextHead, xFirstLength;
+size_t xFirstLength;
 
 	configASSERT( xCount > ( size_t ) 0 );
 
-	xNextHead = pxStreamBuffer->xHead;
-
 	/* Calculate the number of bytes that can be added in the first write -
 	which may be less than the total number of bytes that need to be added if
 	the buffer will wrap back to the beginning. */
-	xFirstLength = configMIN( pxStreamBuffer->xLength - xNextHead, xCount );
+	xFirstLength = configMIN( pxStreamBuffer->xLength - xHead, xCount );
 
 	/* Write as many bytes as can be written in the first write. */
-	configASSERT( ( xNextHead + xFirstLength ) <= pxStreamBuffer->xLength );
-	( void ) memcpy( ( void* ) ( &( pxStreamBuffer->pucBuffer[ xNextHead ] ) ), ( const void * ) pucData, xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+	configASSERT( ( xHead + xFirstLength ) <= pxStreamBuffer->xLength );
+	( void ) memcpy( ( void* ) ( &( pxStreamBuffer->pucBuffer[ xHead ] ) ), ( const void * ) pucData, xFirstLength ); /*lint !e9087 memcpy() requires void *. */
 
 	/* If the number of bytes written was less than the number that could be
 	written in the first write... */
@@ -1115,74 +1380,89 @@ size_t xNextHead, xFirstLength;
 		mtCOVERAGE_TEST_MARKER();
 	}
 
-	xNextHead += xCount;
-	if( xNextHead >= pxStreamBuffer->xLength )
+	xHead += xCount;
+	if( xHead >= pxStreamBuffer->xLength )
 	{
-		xNextHead -= pxStreamBuffer->xLength;
+		xHead -= pxStreamBuffer->xLength;
 	}
 	else
 	{
 		mtCOVERAGE_TEST_MARKER();
 	}
 
-	pxStreamBuffer->xHead = xNextHead;
-
-	return xCount;
+	return xHead;
 }
 /*-----------------------------------------------------------*/
 
-static size_t prvReadBytesFromBuffer( StreamBuffer_t *pxStreamBuffer, uint8_t *pucData, size_t xMaxCount, size_t xBytesAvailable )
+static size_t prvReadBytesFromBuffer( const StreamBuffer_t *pxStreamBuffer, uint8_t *pucData, size_t xCount, size_t xTail )
 {
-size_t xCount, xFirstLength, xNextTail;
+size_t xFirstLength;
 
-	/* Use the minimum of the wanted bytes and the available bytes. */
-	xCount = configMIN( xBytesAvailable, xMaxCount );
+	configASSERT( xCount > ( size_t ) 0 );
 
-	if( xCount > ( size_t ) 0 )
+	/* Calculate the number of bytes that can be read - which may be less than
+	the number wanted if the data wraps around to the start of the buffer. */
+	xFirstLength = configMIN( pxStreamBuffer->xLength - xTail, xCount );
+
+	/* Obtain the number of bytes it is possible to obtain in the first read.
+	Asserts check bounds of read and write. */
+	configASSERT( ( xTail + xFirstLength ) <= pxStreamBuffer->xLength );
+	( void ) memcpy( ( void * ) pucData, ( const void * ) &( pxStreamBuffer->pucBuffer[ xTail ] ), xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+
+	/* If the total number of wanted bytes is greater than the number that
+	could be read in the first read... */
+	if( xCount > xFirstLength )
 	{
-		xNextTail = pxStreamBuffer->xTail;
+		/*...then read the remaining bytes from the start of the buffer. */
+		( void ) memcpy( ( void * ) &( pucData[ xFirstLength ] ), ( void * ) ( pxStreamBuffer->pucBuffer ), xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
 
-		/* Calculate the number of bytes that can be read - which may be
-		less than the number wanted if the data wraps around to the start of
-		the buffer. */
-		xFirstLength = configMIN( pxStreamBuffer->xLength - xNextTail, xCount );
+	xTail += xCount;
+	if( xTail >= pxStreamBuffer->xLength )
+	{
+		xTail -= pxStreamBuffer->xLength;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
 
-		/* Obtain the number of bytes it is possible to obtain in the first
-		read.  Asserts check bounds of read and write. */
-		configASSERT( xFirstLength <= xMaxCount );
-		configASSERT( ( xNextTail + xFirstLength ) <= pxStreamBuffer->xLength );
-		( void ) memcpy( ( void * ) pucData, ( const void * ) &( pxStreamBuffer->pucBuffer[ xNextTail ] ), xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+	return xTail;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvSegmentsLength( const StreamBufferSegment_t * const pxSegments, UBaseType_t uxSegmentCount )
+{
+size_t xLength = 0;
+UBaseType_t uxSegment;
 
-		/* If the total number of wanted bytes is greater than the number
-		that could be read in the first read... */
-		if( xCount > xFirstLength )
+	for( uxSegment = 0; uxSegment < uxSegmentCount; uxSegment++ )
+	{
+		configASSERT( ( pxSegments[ uxSegment ].pvData != NULL ) || ( pxSegments[ uxSegment ].xLength == ( size_t ) 0 ) );
+
+		/* Overflow?  The wrapped total would be smaller than the data the
+		segments describe, so would pass the space check and then be written
+		or read short. */
+		if( pxSegments[ uxSegment ].xLength > ( ( ~( size_t ) 0 ) - xLength ) )
 		{
-			/*...then read the remaining bytes from the start of the buffer. */
-			configASSERT( xCount <= xMaxCount );
-			( void ) memcpy( ( void * ) &( pucData[ xFirstLength ] ), ( void * ) ( pxStreamBuffer->pucBuffer ), xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+			/* The segment lengths must not add up to more than a size_t can
+			hold.  Without configASSERT() the call is treated as having no
+			data, so nothing is written or read. */
+			configASSERT( pdFALSE );
+			xLength = 0;
+			break;
 		}
 		else
 		{
-			mtCOVERAGE_TEST_MARKER();
-		}
-
-		/* Move the tail pointer to effectively remove the data read from
-		the buffer. */
-		xNextTail += xCount;
-
-		if( xNextTail >= pxStreamBuffer->xLength )
-		{
-			xNextTail -= pxStreamBuffer->xLength;
+			xLength += pxSegments[ uxSegment ].xLength;
 		}
-
-		pxStreamBuffer->xTail = xNextTail;
-	}
-	else
-	{
-		mtCOVERAGE_TEST_MARKER();
 	}
 
-	return xCount;
+	return xLength;
 }
 /*-----------------------------------------------------------*/
 
@@ -1225,12 +1505,143 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
 	} /*lint !e529 !e438 xWriteValue is only used if configASSERT() is defined. */
 	#endif
 
-	( void ) memset( ( void * ) pxStreamBuffer, 0x00, sizeof( StreamBuffer_t ) ); /*lint !e9087 memset() requires void *. */
+	#if( configUSE_OBJECT_LOCKS == 1 )
+	{
+		/* xStreamBufferReset() calls this with the lock held, so leave the
+		lock, which is the last member, alone.  The create functions
+		initialise it. */
+		( void ) memset( ( void * ) pxStreamBuffer, 0x00, offsetof( StreamBuffer_t, xObjectLock ) ); /*lint !e9087 memset() requires void *. */
+	}
+	#else
+	{
+		( void ) memset( ( void * ) pxStreamBuffer, 0x00, sizeof( StreamBuffer_t ) ); /*lint !e9087 memset() requires void *. */
+	}
+	#endif
 	pxStreamBuffer->pucBuffer = pucBuffer;
 	pxStreamBuffer->xLength = xBufferSizeBytes;
 	pxStreamBuffer->xTriggerLevelBytes = xTriggerLevelBytes;
 	pxStreamBuffer->ucFlags = ucFlags;
 }
+/*-----------------------------------------------------------*/
+
+#if( configUSE_STREAM_BUFFER_FLUSH_DEADLINE == 1 )
+
+	static BaseType_t prvRecordArrivalTime( StreamBuffer_t * const pxStreamBuffer,
+											size_t xBytesWritten,
+											TickType_t xTimeNow )
+	{
+	BaseType_t xReturn = pdFALSE;
+
+		/* Checking after the write rather than before means a reader that
+		emptied the buffer while the write was in progress cannot be missed.
+		If the reader consumed some of the new bytes then it is running and
+		does not need waking, and the arrival time is at worst a little
+		early, which only makes the deadline expire sooner. */
+		if( prvBytesInBuffer( pxStreamBuffer ) <= xBytesWritten )
+		{
+			pxStreamBuffer->xFirstByteTime = xTimeNow;
+
+			if( pxStreamBuffer->xFlushDeadlineTicks != ( TickType_t ) 0 )
+			{
+				xReturn = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_STREAM_BUFFER_FLUSH_DEADLINE */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_STREAM_BUFFER_FLUSH_DEADLINE == 1 )
+
+	static void prvWaitForTriggerOrDeadline( StreamBuffer_t * const pxStreamBuffer,
+											 size_t xBytesToStoreMessageLength,
+											 TickType_t xTicksToWait )
+	{
+	TimeOut_t xTimeOut;
+	TickType_t xBlockTime, xAge;
+	size_t xBytesAvailable;
+	BaseType_t xDataReady;
+
+		vTaskSetTimeOutState( &xTimeOut );
+
+		for( ;; )
+		{
+			/* Checking the data and clearing the notification state must be
+			performed atomically. */
+			sbENTER_CRITICAL( pxStreamBuffer );
+			{
+				xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+				xBlockTime = xTicksToWait;
+				xDataReady = pdFALSE;
+
+				if( xBytesAvailable <= xBytesToStoreMessageLength )
+				{
+					/* Empty.  The writer wakes this task when the first byte
+					arrives so the deadline can be timed from then. */
+					mtCOVERAGE_TEST_MARKER();
+				}
+				else if( xBytesAvailable >= pxStreamBuffer->xTriggerLevelBytes )
+				{
+					xDataReady = pdTRUE;
+				}
+				else
+				{
+					/* Below the trigger level - sleep no longer than the time
+					left until the oldest byte reaches its deadline. */
+					xAge = xTaskGetTickCount() - pxStreamBuffer->xFirstByteTime;
+
+					if( xAge >= pxStreamBuffer->xFlushDeadlineTicks )
+					{
+						xDataReady = pdTRUE;
+					}
+					else
+					{
+						xBlockTime = configMIN( xBlockTime, pxStreamBuffer->xFlushDeadlineTicks - xAge );
+					}
+				}
+
+				if( xDataReady == pdFALSE )
+				{
+					( void ) xTaskNotifyStateClear( NULL );
+
+					/* Should only be one reader. */
+					configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
+					pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			sbEXIT_CRITICAL( pxStreamBuffer );
+
+			if( xDataReady != pdFALSE )
+			{
+				break;
+			}
+
+			traceBLOCKING_ON_STREAM_BUFFER_RECEIVE( pxStreamBuffer );
+			( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xBlockTime );
+			pxStreamBuffer->xTaskWaitingToReceive = NULL;
+
+			if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+			{
+				break;
+			}
+		}
+	}
+
+#endif /* configUSE_STREAM_BUFFER_FLUSH_DEADLINE */
 
 #if ( configUSE_TRACE_FACILITY == 1 )
 
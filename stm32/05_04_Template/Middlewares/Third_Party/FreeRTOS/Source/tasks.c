@@ -40,6 +40,10 @@ task.h is included from an application file. */
 #include "timers.h"
 #include "stack_macros.h"
 
+#if( configUSE_ARENAS == 1 )
+	#include "arena.h"
+#endif
+
 /* Lint e9021, e961 and e750 are suppressed as a MISRA exception justified
 because the MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
 for the header files above, but not in this file, in order to generate the
@@ -143,7 +147,7 @@ configIDLE_TASK_NAME in FreeRTOSConfig.h. */
 																										\
 		/* listGET_OWNER_OF_NEXT_ENTRY indexes through the list, so the tasks of						\
 		the	same priority get an equal share of the processor time. */									\
-		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ) );			\
+		listGET_OWNER_OF_NEXT_ENTRY_OF_TYPE( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ), TCB_t, xStateListItem );			\
 		uxTopReadyPriority = uxTopPriority;																\
 	} /* taskSELECT_HIGHEST_PRIORITY_TASK */
 
@@ -173,7 +177,7 @@ configIDLE_TASK_NAME in FreeRTOSConfig.h. */
 		/* Find the highest priority list that contains ready tasks. */								\
 		portGET_HIGHEST_PRIORITY( uxTopPriority, uxTopReadyPriority );								\
 		configASSERT( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ uxTopPriority ] ) ) > 0 );		\
-		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ) );		\
+		listGET_OWNER_OF_NEXT_ENTRY_OF_TYPE( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ), TCB_t, xStateListItem );		\
 	} /* taskSELECT_HIGHEST_PRIORITY_TASK() */
 
 	/*-----------------------------------------------------------*/
@@ -216,6 +220,7 @@ count overflows. */
  * the task.  It is inserted at the end of the list.
  */
 #define prvAddTaskToReadyList( pxTCB )																\
+	portASSERT_KERNEL_LOCKED();																		\
 	traceMOVED_TASK_TO_READY_STATE( pxTCB );														\
 	taskRECORD_READY_PRIORITY( ( pxTCB )->uxPriority );												\
 	vListInsertEnd( &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xStateListItem ) ); \
@@ -244,6 +249,43 @@ to its original value when it is released. */
 	#define taskEVENT_LIST_ITEM_VALUE_IN_USE	0x80000000UL
 #endif
 
+/* With configUSE_OBJECT_LOCKS set to 1, kernel objects call the functions that
+block and unblock tasks holding only their own lock, and suspending the
+scheduler only stops the calling core.  So every access to the ready, delayed,
+pending ready, suspended and event lists takes the kernel lock, and always with
+interrupts masked, so an ISR on the same core cannot wait for a lock its own
+core holds:
+
+	taskENTER_KERNEL_CRITICAL()		a critical section that also holds the
+									kernel lock.  Every critical section in
+									this file is one.
+	taskLOCK_KERNEL()				the kernel lock alone, where interrupts are
+									already masked - in an ISR safe function,
+									the tick, the context switch, or under an
+									object lock.
+	taskLOCK_KERNEL_FROM_TASK()		the kernel lock and a critical section
+									where the lists are otherwise only guarded
+									by suspending the scheduler.
+
+The kernel lock nests.  See FreeRTOS.h for the order in which locks are taken.
+Otherwise the critical sections are the plain ones, and the caller's critical
+section or scheduler suspension protects the lists. */
+#if( configUSE_OBJECT_LOCKS == 1 )
+	#define taskENTER_KERNEL_CRITICAL()		{ taskENTER_CRITICAL(); portLOCK_KERNEL(); }
+	#define taskEXIT_KERNEL_CRITICAL()		{ portUNLOCK_KERNEL(); taskEXIT_CRITICAL(); }
+	#define taskLOCK_KERNEL()				portLOCK_KERNEL()
+	#define taskUNLOCK_KERNEL()				portUNLOCK_KERNEL()
+	#define taskLOCK_KERNEL_FROM_TASK()		taskENTER_KERNEL_CRITICAL()
+	#define taskUNLOCK_KERNEL_FROM_TASK()	taskEXIT_KERNEL_CRITICAL()
+#else
+	#define taskENTER_KERNEL_CRITICAL()		taskENTER_CRITICAL()
+	#define taskEXIT_KERNEL_CRITICAL()		taskEXIT_CRITICAL()
+	#define taskLOCK_KERNEL()
+	#define taskUNLOCK_KERNEL()
+	#define taskLOCK_KERNEL_FROM_TASK()
+	#define taskUNLOCK_KERNEL_FROM_TASK()
+#endif
+
 /*
  * Task control block.  A task control block (TCB) is allocated for each task,
  * and stores task state information, including a pointer to the task's context
@@ -289,6 +331,10 @@ typedef struct tskTaskControlBlock 			/* The old naming convention is used to pr
 		void			*pvThreadLocalStoragePointers[ configNUM_THREAD_LOCAL_STORAGE_POINTERS ];
 	#endif
 
+	#if ( configUSE_ARENAS == 1 )
+		struct ArenaDef_t *pxArena;			/*< The arena attached to the task, if any.  It is deleted with the task. */
+	#endif
+
 	#if( configGENERATE_RUN_TIME_STATS == 1 )
 		uint32_t		ulRunTimeCounter;	/*< Stores the amount of time the task has spent in the Running state. */
 	#endif
@@ -334,7 +380,11 @@ typedef tskTCB TCB_t;
 
 /*lint -save -e956 A manual analysis and inspection has been used to determine
 which static variables must be declared volatile. */
-PRIVILEGED_DATA TCB_t * volatile pxCurrentTCB = NULL;
+#if( configUSE_KERNEL_IMAGE == 1 )
+	PRIVILEGED_DATA TCB_t * volatile pxCurrentTCB;	/* Given its first value with the kernel image below. */
+#else
+	PRIVILEGED_DATA TCB_t * volatile pxCurrentTCB = NULL;
+#endif
 
 /* Lists for ready and blocked tasks. --------------------
 xDelayedTaskList1 and xDelayedTaskList2 could be move to function scople but
@@ -360,6 +410,97 @@ PRIVILEGED_DATA static List_t xPendingReadyList;						/*< Tasks that have been r
 
 #endif
 
+#if( configUSE_KERNEL_IMAGE == 1 )
+
+	#if( portUSING_MPU_WRAPPERS == 1 )
+		#error A kernel image cannot be used with the MPU wrappers.
+	#endif
+
+	/* One task of the kernel image.  kernel_image.h builds the TCB, already
+	in its ready list, at compile time.  The initial stack frame is port
+	specific so it is written by prvInitialiseImageTasks() when the scheduler
+	starts.  A NULL pxTaskCode marks the idle task. */
+	typedef struct xKERNEL_IMAGE_TASK
+	{
+		TCB_t *pxTCB;
+		TaskFunction_t pxTaskCode;
+		void *pvParameters;
+		uint32_t ulStackDepth;
+	} KernelImageTask_t;
+
+	#if( tskSTATIC_AND_DYNAMIC_ALLOCATION_POSSIBLE != 0 ) /*lint !e731 !e9029 Macro has been consolidated for readability reasons. */
+		#define tskIMAGE_ALLOCATION_FIELDS				.ucStaticallyAllocated = tskSTATICALLY_ALLOCATED_STACK_AND_TCB,
+	#else
+		#define tskIMAGE_ALLOCATION_FIELDS
+	#endif
+
+	#if( configUSE_TRACE_FACILITY == 1 )
+		#define tskIMAGE_TRACE_FIELDS( uxNumber )		.uxTCBNumber = ( uxNumber ),
+	#else
+		#define tskIMAGE_TRACE_FIELDS( uxNumber )
+	#endif
+
+	#if( configUSE_MUTEXES == 1 )
+		#define tskIMAGE_MUTEX_FIELDS( uxPriority )	.uxBasePriority = ( uxPriority ),
+	#else
+		#define tskIMAGE_MUTEX_FIELDS( uxPriority )
+	#endif
+
+	/* Used by kernel_image.h to build a TCB as prvInitialiseNewTask() and
+	prvAddNewTaskToReadyList() would leave it, with the state list item linked
+	between pxNextReady and pxPreviousReady in the ready list of uxTaskPriority. */
+	#define tskIMAGE_STATE_ITEM( xTCB )				( &( ( xTCB ).xStateListItem ) )
+	#define tskIMAGE_READY_LIST_END( uxPriority )	listSTATIC_END_MARKER( pxReadyTasksLists[ uxPriority ] )
+	#define tskIMAGE_TCB( xTCB, pcName, uxTaskPriority, pxStackBuffer, pxNextReady, pxPreviousReady, uxNumber )											\
+	{																																					\
+		.xStateListItem = listSTATIC_LIST_ITEM( 0, &( xTCB ), ( pxNextReady ), ( pxPreviousReady ), &( pxReadyTasksLists[ uxTaskPriority ] ) ),			\
+		.xEventListItem = listSTATIC_LIST_ITEM( ( TickType_t ) configMAX_PRIORITIES - ( TickType_t ) ( uxTaskPriority ), &( xTCB ), NULL, NULL, NULL ),	\
+		.uxPriority = ( uxTaskPriority ),																												\
+		.pxStack = ( pxStackBuffer ),																													\
+		.pcTaskName = pcName,																															\
+		tskIMAGE_TRACE_FIELDS( uxNumber )																												\
+		tskIMAGE_MUTEX_FIELDS( uxTaskPriority )																											\
+		tskIMAGE_ALLOCATION_FIELDS																														\
+	}
+
+	/* Defines the TCBs, stacks and the xKernelImageTasks[] table, and the
+	tskIMAGE_ values used below. */
+	#define KERNEL_IMAGE_TASKS
+	#include "kernel_image.h"
+	#undef KERNEL_IMAGE_TASKS
+
+	/* The lists declared above start out as the image leaves them. */
+	PRIVILEGED_DATA TCB_t * volatile pxCurrentTCB = tskIMAGE_CURRENT_TCB;
+	PRIVILEGED_DATA static List_t pxReadyTasksLists[ configMAX_PRIORITIES ] = tskIMAGE_READY_LISTS;
+	PRIVILEGED_DATA static List_t xDelayedTaskList1 = listSTATIC_EMPTY_LIST( xDelayedTaskList1 );
+	PRIVILEGED_DATA static List_t xDelayedTaskList2 = listSTATIC_EMPTY_LIST( xDelayedTaskList2 );
+	PRIVILEGED_DATA static List_t * volatile pxDelayedTaskList = &xDelayedTaskList1;
+	PRIVILEGED_DATA static List_t * volatile pxOverflowDelayedTaskList = &xDelayedTaskList2;
+	PRIVILEGED_DATA static List_t xPendingReadyList = listSTATIC_EMPTY_LIST( xPendingReadyList );
+
+	#if( INCLUDE_vTaskDelete == 1 )
+		PRIVILEGED_DATA static List_t xTasksWaitingTermination = listSTATIC_EMPTY_LIST( xTasksWaitingTermination );
+	#endif
+
+	#if( INCLUDE_vTaskSuspend == 1 )
+		PRIVILEGED_DATA static List_t xSuspendedTaskList = listSTATIC_EMPTY_LIST( xSuspendedTaskList );
+	#endif
+
+	#if( configUSE_PORT_OPTIMISED_TASK_SELECTION == 0 )
+		#define tskIMAGE_TOP_READY_PRIORITY		tskIMAGE_HIGHEST_PRIORITY
+	#else
+		#define tskIMAGE_TOP_READY_PRIORITY		tskIMAGE_READY_PRIORITIES
+	#endif
+
+#else
+
+	/* Without an image the kernel starts with no tasks. */
+	#define tskIMAGE_NUMBER_OF_TASKS		0U
+	#define tskIMAGE_TOP_READY_PRIORITY		tskIDLE_PRIORITY
+	#define tskIMAGE_IDLE_TASK				NULL
+
+#endif /* configUSE_KERNEL_IMAGE */
+
 /* Global POSIX errno. Its value is changed upon context switching to match
 the errno of the currently running task. */
 #if ( configUSE_POSIX_ERRNO == 1 )
@@ -367,16 +508,16 @@ the errno of the currently running task. */
 #endif
 
 /* Other file private variables. --------------------------------*/
-PRIVILEGED_DATA static volatile UBaseType_t uxCurrentNumberOfTasks 	= ( UBaseType_t ) 0U;
+PRIVILEGED_DATA static volatile UBaseType_t uxCurrentNumberOfTasks 	= ( UBaseType_t ) tskIMAGE_NUMBER_OF_TASKS;
 PRIVILEGED_DATA static volatile TickType_t xTickCount 				= ( TickType_t ) configINITIAL_TICK_COUNT;
-PRIVILEGED_DATA static volatile UBaseType_t uxTopReadyPriority 		= tskIDLE_PRIORITY;
+PRIVILEGED_DATA static volatile UBaseType_t uxTopReadyPriority 		= tskIMAGE_TOP_READY_PRIORITY;
 PRIVILEGED_DATA static volatile BaseType_t xSchedulerRunning 		= pdFALSE;
 PRIVILEGED_DATA static volatile TickType_t xPendedTicks 			= ( TickType_t ) 0U;
 PRIVILEGED_DATA static volatile BaseType_t xYieldPending 			= pdFALSE;
 PRIVILEGED_DATA static volatile BaseType_t xNumOfOverflows 			= ( BaseType_t ) 0;
-PRIVILEGED_DATA static UBaseType_t uxTaskNumber 					= ( UBaseType_t ) 0U;
+PRIVILEGED_DATA static UBaseType_t uxTaskNumber 					= ( UBaseType_t ) tskIMAGE_NUMBER_OF_TASKS;
 PRIVILEGED_DATA static volatile TickType_t xNextTaskUnblockTime		= ( TickType_t ) 0U; /* Initialised to portMAX_DELAY before the scheduler starts. */
-PRIVILEGED_DATA static TaskHandle_t xIdleTaskHandle					= NULL;			/*< Holds the handle of the idle task.  The idle task is created automatically when the scheduler is started. */
+PRIVILEGED_DATA static TaskHandle_t xIdleTaskHandle					= tskIMAGE_IDLE_TASK;			/*< Holds the handle of the idle task.  The idle task is created automatically when the scheduler is started. */
 
 /* Context switches are held pending while the scheduler is suspended.  Also,
 interrupts must not manipulate the xStateListItem of a TCB, or any of the
@@ -395,6 +536,34 @@ PRIVILEGED_DATA static volatile UBaseType_t uxSchedulerSuspended	= ( UBaseType_t
 	PRIVILEGED_DATA static uint32_t ulTaskSwitchedInTime = 0UL;	/*< Holds the value of a timer/counter the last time a task was switched in. */
 	PRIVILEGED_DATA static uint32_t ulTotalRunTime = 0UL;		/*< Holds the total amount of execution time as defined by the run time counter clock. */
 
+	#ifdef portGET_ISR_RUN_TIME_COUNTER_VALUE
+		PRIVILEGED_DATA static uint32_t ulIsrTimeAtSwitchIn = 0UL;	/*< Holds the time spent in interrupts, in run time counter units, the last time a task was switched in. */
+	#endif
+
+#endif
+
+#if ( configUSE_IDLE_JOBS == 1 )
+
+	/* A job registered with xTaskRegisterIdleJob(). */
+	typedef struct xIDLE_JOB
+	{
+		const char *pcJobName;				/*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+		IdleJobFunction_t pxJobFunction;
+		void *pvParameters;
+		uint32_t ulBudget;					/*< Run time, in run time counter units, one call of the job should stay within. */
+		volatile BaseType_t xPending;		/*< Set when the job has work to do. */
+		uint32_t ulRunTimeCounter;			/*< Idle time consumed by the job so far. */
+		uint32_t ulRuns;
+		uint32_t ulOverruns;				/*< Calls that went past ulBudget without being asked to yield. */
+	} IdleJob_t;
+
+	PRIVILEGED_DATA static IdleJob_t xIdleJobs[ configIDLE_JOB_REGISTRY_SIZE ];
+	PRIVILEGED_DATA static volatile UBaseType_t uxIdleJobCount = 0U;
+	PRIVILEGED_DATA static UBaseType_t uxNextIdleJob = 0U;				/*< The job the round robin looks at first. */
+	PRIVILEGED_DATA static IdleJob_t *pxCurrentIdleJob = NULL;			/*< The job the idle task is running, if any. */
+	PRIVILEGED_DATA static uint32_t ulIdleJobStartTime = 0UL;			/*< Idle task run time when the current job was called. */
+	PRIVILEGED_DATA static BaseType_t xIdleJobAskedToYield = pdFALSE;	/*< Set once xTaskIdleJobShouldYield() has returned pdTRUE to the current job. */
+
 #endif
 
 /*lint -restore */
@@ -481,14 +650,15 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait, const BaseT
 /*
  * Fills an TaskStatus_t structure with information on each task that is
  * referenced from the pxList list (which may be a ready list, a delayed list,
- * a suspended list, etc.).
+ * a suspended list, etc.), up to uxArraySize structures.  The stack high water
+ * mark is only measured if xGetFreeStackSpace is pdTRUE.
  *
  * THIS FUNCTION IS INTENDED FOR DEBUGGING ONLY, AND SHOULD NOT BE CALLED FROM
  * NORMAL APPLICATION CODE.
  */
 #if ( configUSE_TRACE_FACILITY == 1 )
 
-	static UBaseType_t prvListTasksWithinSingleList( TaskStatus_t *pxTaskStatusArray, List_t *pxList, eTaskState eState ) PRIVILEGED_FUNCTION;
+	static UBaseType_t prvListTasksWithinSingleList( TaskStatus_t *pxTaskStatusArray, UBaseType_t uxArraySize, List_t *pxList, eTaskState eState, BaseType_t xGetFreeStackSpace ) PRIVILEGED_FUNCTION;
 
 #endif
 
@@ -534,6 +704,35 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait, const BaseT
  */
 static void prvResetNextTaskUnblockTime( void );
 
+#if ( configUSE_IDLE_JOBS == 1 )
+
+	/*
+	 * Called from the idle task.  Runs the next pending idle job in round
+	 * robin order, unless another task is ready to run.
+	 */
+	static void prvRunIdleJobs( void ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Returns pdTRUE if any idle job has work to do.
+	 */
+	#if ( configUSE_TICKLESS_IDLE != 0 )
+		static BaseType_t prvIdleJobsPending( void ) PRIVILEGED_FUNCTION;
+	#endif
+
+	/*
+	 * Returns pdTRUE if a task other than the idle task is ready to run, so
+	 * the idle task should not start, or should stop, running a job.
+	 */
+	static BaseType_t prvOtherTaskReady( void ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Returns the run time of the idle task including the time since it was
+	 * last switched in.  Must be called from the idle task.
+	 */
+	static uint32_t prvGetIdleRunTime( void ) PRIVILEGED_FUNCTION;
+
+#endif
+
 #if ( ( configUSE_TRACE_FACILITY == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) )
 
 	/*
@@ -563,6 +762,14 @@ static void prvInitialiseNewTask( 	TaskFunction_t pxTaskCode,
  */
 static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB ) PRIVILEGED_FUNCTION;
 
+/*
+ * Writes the initial stack frame of each task in the kernel image.  Everything
+ * else about the tasks was set up at compile time.
+ */
+#if( configUSE_KERNEL_IMAGE == 1 )
+	static void prvInitialiseImageTasks( void ) PRIVILEGED_FUNCTION;
+#endif
+
 /*
  * freertos_tasks_c_additions_init() should only be called if the user definable
  * macro FREERTOS_TASKS_C_ADDITIONS_INIT() is defined, as that is the only macro
@@ -987,6 +1194,12 @@ UBaseType_t x;
 	}
 	#endif
 
+	#if( configUSE_ARENAS == 1 )
+	{
+		pxNewTCB->pxArena = NULL;
+	}
+	#endif
+
 	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
 	{
 		pxNewTCB->ulNotifiedValue = 0;
@@ -1078,7 +1291,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 {
 	/* Ensure interrupts don't access the task lists while the lists are being
 	updated. */
-	taskENTER_CRITICAL();
+	taskENTER_KERNEL_CRITICAL();
 	{
 		uxCurrentNumberOfTasks++;
 		if( pxCurrentTCB == NULL )
@@ -1135,7 +1348,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 
 		portSETUP_TCB( pxNewTCB );
 	}
-	taskEXIT_CRITICAL();
+	taskEXIT_KERNEL_CRITICAL();
 
 	if( xSchedulerRunning != pdFALSE )
 	{
@@ -1157,17 +1370,93 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_KERNEL_IMAGE == 1 )
+
+	static void prvInitialiseImageTasks( void )
+	{
+	UBaseType_t uxTask;
+	const KernelImageTask_t *pxImageTask;
+	TCB_t *pxTCB;
+	StackType_t *pxTopOfStack;
+	TaskFunction_t pxTaskCode;
+
+		for( uxTask = 0; uxTask < ( UBaseType_t ) tskIMAGE_NUMBER_OF_TASKS; uxTask++ )
+		{
+			pxImageTask = &( xKernelImageTasks[ uxTask ] );
+			pxTCB = pxImageTask->pxTCB;
+			pxTaskCode = ( pxImageTask->pxTaskCode != NULL ) ? pxImageTask->pxTaskCode : prvIdleTask;
+
+			#if( tskSET_NEW_STACKS_TO_KNOWN_VALUE == 1 )
+			{
+				( void ) memset( pxTCB->pxStack, ( int ) tskSTACK_FILL_BYTE, ( size_t ) pxImageTask->ulStackDepth * sizeof( StackType_t ) );
+			}
+			#endif /* tskSET_NEW_STACKS_TO_KNOWN_VALUE */
+
+			/* As prvInitialiseNewTask(). */
+			#if( portSTACK_GROWTH < 0 )
+			{
+				pxTopOfStack = &( pxTCB->pxStack[ pxImageTask->ulStackDepth - ( uint32_t ) 1 ] );
+				pxTopOfStack = ( StackType_t * ) ( ( ( portPOINTER_SIZE_TYPE ) pxTopOfStack ) & ( ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) ) ); /*lint !e923 !e9033 !e9078 MISRA exception.  Avoiding casts between pointers and integers is not practical.  Size differences accounted for using portPOINTER_SIZE_TYPE type.  Checked by assert(). */
+				configASSERT( ( ( ( portPOINTER_SIZE_TYPE ) pxTopOfStack & ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) == 0UL ) );
+
+				#if( configRECORD_STACK_HIGH_ADDRESS == 1 )
+				{
+					pxTCB->pxEndOfStack = pxTopOfStack;
+				}
+				#endif /* configRECORD_STACK_HIGH_ADDRESS */
+			}
+			#else /* portSTACK_GROWTH */
+			{
+				pxTopOfStack = pxTCB->pxStack;
+				configASSERT( ( ( ( portPOINTER_SIZE_TYPE ) pxTCB->pxStack & ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) == 0UL ) );
+				pxTCB->pxEndOfStack = pxTCB->pxStack + ( pxImageTask->ulStackDepth - ( uint32_t ) 1 );
+			}
+			#endif /* portSTACK_GROWTH */
+
+			#if( configUSE_NEWLIB_REENTRANT == 1 )
+			{
+				_REENT_INIT_PTR( ( &( pxTCB->xNewLib_reent ) ) );
+			}
+			#endif
+
+			#if( portHAS_STACK_OVERFLOW_CHECKING == 1 )
+			{
+				#if( portSTACK_GROWTH < 0 )
+				{
+					pxTCB->pxTopOfStack = pxPortInitialiseStack( pxTopOfStack, pxTCB->pxStack, pxTaskCode, pxImageTask->pvParameters );
+				}
+				#else /* portSTACK_GROWTH */
+				{
+					pxTCB->pxTopOfStack = pxPortInitialiseStack( pxTopOfStack, pxTCB->pxEndOfStack, pxTaskCode, pxImageTask->pvParameters );
+				}
+				#endif /* portSTACK_GROWTH */
+			}
+			#else /* portHAS_STACK_OVERFLOW_CHECKING */
+			{
+				pxTCB->pxTopOfStack = pxPortInitialiseStack( pxTopOfStack, pxTaskCode, pxImageTask->pvParameters );
+			}
+			#endif /* portHAS_STACK_OVERFLOW_CHECKING */
+
+			traceTASK_CREATE( pxTCB );
+			portSETUP_TCB( pxTCB );
+		}
+	}
+
+#endif /* configUSE_KERNEL_IMAGE */
+/*-----------------------------------------------------------*/
+
 #if ( INCLUDE_vTaskDelete == 1 )
 
 	void vTaskDelete( TaskHandle_t xTaskToDelete )
 	{
 	TCB_t *pxTCB;
 
-		taskENTER_CRITICAL();
+		taskENTER_KERNEL_CRITICAL();
 		{
 			/* If null is passed in here then it is the calling task that is
 			being deleted. */
 			pxTCB = prvGetTCBFromHandle( xTaskToDelete );
+			portASSERT_KERNEL_LOCKED();
 
 			/* Remove task from the ready/delayed list. */
 			if( uxListRemove( &( pxTCB->xStateListItem ) ) == ( UBaseType_t ) 0 )
@@ -1231,7 +1520,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				prvResetNextTaskUnblockTime();
 			}
 		}
-		taskEXIT_CRITICAL();
+		taskEXIT_KERNEL_CRITICAL();
 
 		/* Force a reschedule if it is the currently running task that has just
 		been deleted. */
@@ -1312,7 +1601,9 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 
 				/* prvAddCurrentTaskToDelayedList() needs the block time, not
 				the time to wake, so subtract the current tick count. */
+				taskLOCK_KERNEL_FROM_TASK();
 				prvAddCurrentTaskToDelayedList( xTimeToWake - xConstTickCount, pdFALSE );
+				taskUNLOCK_KERNEL_FROM_TASK();
 			}
 			else
 			{
@@ -1357,7 +1648,9 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 
 				This task cannot be in an event list as it is the currently
 				executing task. */
+				taskLOCK_KERNEL_FROM_TASK();
 				prvAddCurrentTaskToDelayedList( xTicksToDelay, pdFALSE );
+				taskUNLOCK_KERNEL_FROM_TASK();
 			}
 			xAlreadyYielded = xTaskResumeAll();
 		}
@@ -1398,13 +1691,13 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 		}
 		else
 		{
-			taskENTER_CRITICAL();
+			taskENTER_KERNEL_CRITICAL();
 			{
 				pxStateList = listLIST_ITEM_CONTAINER( &( pxTCB->xStateListItem ) );
 				pxDelayedList = pxDelayedTaskList;
 				pxOverflowedDelayedList = pxOverflowDelayedTaskList;
 			}
-			taskEXIT_CRITICAL();
+			taskEXIT_KERNEL_CRITICAL();
 
 			if( ( pxStateList == pxDelayedList ) || ( pxStateList == pxOverflowedDelayedList ) )
 			{
@@ -1480,14 +1773,14 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 	TCB_t const *pxTCB;
 	UBaseType_t uxReturn;
 
-		taskENTER_CRITICAL();
+		taskENTER_KERNEL_CRITICAL();
 		{
 			/* If null is passed in here then it is the priority of the task
 			that called uxTaskPriorityGet() that is being queried. */
 			pxTCB = prvGetTCBFromHandle( xTask );
 			uxReturn = pxTCB->uxPriority;
 		}
-		taskEXIT_CRITICAL();
+		taskEXIT_KERNEL_CRITICAL();
 
 		return uxReturn;
 	}
@@ -1555,7 +1848,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 			mtCOVERAGE_TEST_MARKER();
 		}
 
-		taskENTER_CRITICAL();
+		taskENTER_KERNEL_CRITICAL();
 		{
 			/* If null is passed in here then it is the priority of the calling
 			task that is being changed. */
@@ -1693,7 +1986,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				( void ) uxPriorityUsedOnEntry;
 			}
 		}
-		taskEXIT_CRITICAL();
+		taskEXIT_KERNEL_CRITICAL();
 	}
 
 #endif /* INCLUDE_vTaskPrioritySet */
@@ -1705,13 +1998,14 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 	{
 	TCB_t *pxTCB;
 
-		taskENTER_CRITICAL();
+		taskENTER_KERNEL_CRITICAL();
 		{
 			/* If null is passed in here then it is the running task that is
 			being suspended. */
 			pxTCB = prvGetTCBFromHandle( xTaskToSuspend );
 
 			traceTASK_SUSPEND( pxTCB );
+			portASSERT_KERNEL_LOCKED();
 
 			/* Remove task from the ready/delayed list and place in the
 			suspended list. */
@@ -1747,17 +2041,17 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 			}
 			#endif
 		}
-		taskEXIT_CRITICAL();
+		taskEXIT_KERNEL_CRITICAL();
 
 		if( xSchedulerRunning != pdFALSE )
 		{
 			/* Reset the next expected unblock time in case it referred to the
 			task that is now in the Suspended state. */
-			taskENTER_CRITICAL();
+			taskENTER_KERNEL_CRITICAL();
 			{
 				prvResetNextTaskUnblockTime();
 			}
-			taskEXIT_CRITICAL();
+			taskEXIT_KERNEL_CRITICAL();
 		}
 		else
 		{
@@ -1859,7 +2153,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 		currently executing task. */
 		if( ( pxTCB != pxCurrentTCB ) && ( pxTCB != NULL ) )
 		{
-			taskENTER_CRITICAL();
+			taskENTER_KERNEL_CRITICAL();
 			{
 				if( prvTaskIsTaskSuspended( pxTCB ) != pdFALSE )
 				{
@@ -1888,7 +2182,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 					mtCOVERAGE_TEST_MARKER();
 				}
 			}
-			taskEXIT_CRITICAL();
+			taskEXIT_KERNEL_CRITICAL();
 		}
 		else
 		{
@@ -1929,6 +2223,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 		portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
 
 		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		taskLOCK_KERNEL();
 		{
 			if( prvTaskIsTaskSuspended( pxTCB ) != pdFALSE )
 			{
@@ -1964,6 +2259,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				mtCOVERAGE_TEST_MARKER();
 			}
 		}
+		taskUNLOCK_KERNEL();
 		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
 
 		return xYieldRequired;
@@ -1977,7 +2273,14 @@ void vTaskStartScheduler( void )
 BaseType_t xReturn;
 
 	/* Add the idle task at the lowest priority. */
-	#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	#if( configUSE_KERNEL_IMAGE == 1 )
+	{
+		/* The idle task is part of the image, which is already in the ready
+		lists.  Only the initial stack frames are left to write. */
+		prvInitialiseImageTasks();
+		xReturn = pdPASS;
+	}
+	#elif( configSUPPORT_STATIC_ALLOCATION == 1 )
 	{
 		StaticTask_t *pxIdleTaskTCBBuffer = NULL;
 		StackType_t *pxIdleTaskStackBuffer = NULL;
@@ -2070,6 +2373,9 @@ BaseType_t xReturn;
 
 		traceTASK_SWITCHED_IN();
 
+		/* Guard the stack of the task that will run first, if configured. */
+		taskSET_STACK_GUARD();
+
 		/* Setting up the timer tick is hardware specific and thus in the
 		portable interface. */
 		if( xPortStartScheduler() != pdFALSE )
@@ -2205,7 +2511,7 @@ BaseType_t xAlreadyYielded = pdFALSE;
 	removed task will have been added to the xPendingReadyList.  Once the
 	scheduler has been resumed it is safe to move all the pending ready
 	tasks from this list into their appropriate ready list. */
-	taskENTER_CRITICAL();
+	taskENTER_KERNEL_CRITICAL();
 	{
 		--uxSchedulerSuspended;
 
@@ -2217,7 +2523,7 @@ BaseType_t xAlreadyYielded = pdFALSE;
 				appropriate ready list. */
 				while( listLIST_IS_EMPTY( &xPendingReadyList ) == pdFALSE )
 				{
-					pxTCB = listGET_OWNER_OF_HEAD_ENTRY( ( &xPendingReadyList ) ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+					pxTCB = listGET_OWNER_OF_HEAD_ENTRY_OF_TYPE( ( &xPendingReadyList ), TCB_t, xEventListItem ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
 					( void ) uxListRemove( &( pxTCB->xEventListItem ) );
 					( void ) uxListRemove( &( pxTCB->xStateListItem ) );
 					prvAddTaskToReadyList( pxTCB );
@@ -2295,7 +2601,7 @@ BaseType_t xAlreadyYielded = pdFALSE;
 			mtCOVERAGE_TEST_MARKER();
 		}
 	}
-	taskEXIT_CRITICAL();
+	taskEXIT_KERNEL_CRITICAL();
 
 	return xAlreadyYielded;
 }
@@ -2380,11 +2686,11 @@ TCB_t *pxTCB;
 
 		if( listCURRENT_LIST_LENGTH( pxList ) > ( UBaseType_t ) 0 )
 		{
-			listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList );  /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+			listGET_OWNER_OF_NEXT_ENTRY_OF_TYPE( pxFirstTCB, pxList, TCB_t, xStateListItem );  /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
 
 			do
 			{
-				listGET_OWNER_OF_NEXT_ENTRY( pxNextTCB, pxList ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+				listGET_OWNER_OF_NEXT_ENTRY_OF_TYPE( pxNextTCB, pxList, TCB_t, xStateListItem ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
 
 				/* Check each character in the name looking for a match or
 				mismatch. */
@@ -2446,6 +2752,7 @@ TCB_t *pxTCB;
 		configASSERT( strlen( pcNameToQuery ) < configMAX_TASK_NAME_LEN );
 
 		vTaskSuspendAll();
+		taskLOCK_KERNEL_FROM_TASK();
 		{
 			/* Search the ready lists. */
 			do
@@ -2492,6 +2799,7 @@ TCB_t *pxTCB;
 			}
 			#endif
 		}
+		taskUNLOCK_KERNEL_FROM_TASK();
 		( void ) xTaskResumeAll();
 
 		return pxTCB;
@@ -2504,68 +2812,89 @@ TCB_t *pxTCB;
 
 	UBaseType_t uxTaskGetSystemState( TaskStatus_t * const pxTaskStatusArray, const UBaseType_t uxArraySize, uint32_t * const pulTotalRunTime )
 	{
-	UBaseType_t uxTask = 0, uxQueue = configMAX_PRIORITIES;
+	UBaseType_t uxTask = 0;
 
 		vTaskSuspendAll();
 		{
-			/* Is there a space in the array for each task in the system? */
+			/* Is there a space in the array for each task in the system?  No
+			task can be created or deleted until the scheduler is resumed. */
 			if( uxArraySize >= uxCurrentNumberOfTasks )
 			{
-				/* Fill in an TaskStatus_t structure with information on each
-				task in the Ready state. */
-				do
-				{
-					uxQueue--;
-					uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &( pxReadyTasksLists[ uxQueue ] ), eReady );
+				uxTask = uxTaskGetPartialSystemState( pxTaskStatusArray, uxArraySize, pulTotalRunTime, pdTRUE );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		( void ) xTaskResumeAll();
 
-				} while( uxQueue > ( UBaseType_t ) tskIDLE_PRIORITY ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+		return uxTask;
+	}
 
-				/* Fill in an TaskStatus_t structure with information on each
-				task in the Blocked state. */
-				uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( List_t * ) pxDelayedTaskList, eBlocked );
-				uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( List_t * ) pxOverflowDelayedTaskList, eBlocked );
+#endif /* configUSE_TRACE_FACILITY */
+/*----------------------------------------------------------*/
 
-				#if( INCLUDE_vTaskDelete == 1 )
-				{
-					/* Fill in an TaskStatus_t structure with information on
-					each task that has been deleted but not yet cleaned up. */
-					uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &xTasksWaitingTermination, eDeleted );
-				}
-				#endif
+#if ( configUSE_TRACE_FACILITY == 1 )
 
-				#if ( INCLUDE_vTaskSuspend == 1 )
-				{
-					/* Fill in an TaskStatus_t structure with information on
-					each task in the Suspended state. */
-					uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &xSuspendedTaskList, eSuspended );
-				}
-				#endif
+	UBaseType_t uxTaskGetPartialSystemState( TaskStatus_t * const pxTaskStatusArray, const UBaseType_t uxArraySize, uint32_t * const pulTotalRunTime, const BaseType_t xGetFreeStackSpace )
+	{
+	UBaseType_t uxTask = 0, uxQueue = configMAX_PRIORITIES;
 
-				#if ( configGENERATE_RUN_TIME_STATS == 1)
-				{
-					if( pulTotalRunTime != NULL )
-					{
-						#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
-							portALT_GET_RUN_TIME_COUNTER_VALUE( ( *pulTotalRunTime ) );
-						#else
-							*pulTotalRunTime = portGET_RUN_TIME_COUNTER_VALUE();
-						#endif
-					}
-				}
-				#else
+		vTaskSuspendAll();
+		taskLOCK_KERNEL_FROM_TASK();
+		{
+			/* Fill in an TaskStatus_t structure with information on each
+			task in the Ready state. */
+			do
+			{
+				uxQueue--;
+				uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), uxArraySize - uxTask, &( pxReadyTasksLists[ uxQueue ] ), eReady, xGetFreeStackSpace );
+
+			} while( uxQueue > ( UBaseType_t ) tskIDLE_PRIORITY ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+
+			/* Fill in an TaskStatus_t structure with information on each
+			task in the Blocked state. */
+			uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), uxArraySize - uxTask, ( List_t * ) pxDelayedTaskList, eBlocked, xGetFreeStackSpace );
+			uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), uxArraySize - uxTask, ( List_t * ) pxOverflowDelayedTaskList, eBlocked, xGetFreeStackSpace );
+
+			#if( INCLUDE_vTaskDelete == 1 )
+			{
+				/* Fill in an TaskStatus_t structure with information on
+				each task that has been deleted but not yet cleaned up. */
+				uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), uxArraySize - uxTask, &xTasksWaitingTermination, eDeleted, xGetFreeStackSpace );
+			}
+			#endif
+
+			#if ( INCLUDE_vTaskSuspend == 1 )
+			{
+				/* Fill in an TaskStatus_t structure with information on
+				each task in the Suspended state. */
+				uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), uxArraySize - uxTask, &xSuspendedTaskList, eSuspended, xGetFreeStackSpace );
+			}
+			#endif
+
+			#if ( configGENERATE_RUN_TIME_STATS == 1)
+			{
+				if( pulTotalRunTime != NULL )
 				{
-					if( pulTotalRunTime != NULL )
-					{
-						*pulTotalRunTime = 0;
-					}
+					#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
+						portALT_GET_RUN_TIME_COUNTER_VALUE( ( *pulTotalRunTime ) );
+					#else
+						*pulTotalRunTime = portGET_RUN_TIME_COUNTER_VALUE();
+					#endif
 				}
-				#endif
 			}
-			else
+			#else
 			{
-				mtCOVERAGE_TEST_MARKER();
+				if( pulTotalRunTime != NULL )
+				{
+					*pulTotalRunTime = 0;
+				}
 			}
+			#endif
 		}
+		taskUNLOCK_KERNEL_FROM_TASK();
 		( void ) xTaskResumeAll();
 
 		return uxTask;
@@ -2644,13 +2973,14 @@ BaseType_t xYieldRequired = pdFALSE;
 				/* Remove the reference to the task from the blocked list.  An
 				interrupt won't touch the xStateListItem because the
 				scheduler is suspended. */
+				taskLOCK_KERNEL_FROM_TASK();
 				( void ) uxListRemove( &( pxTCB->xStateListItem ) );
 
 				/* Is the task waiting on an event also?  If so remove it from
 				the event list too.  Interrupts can touch the event list item,
 				even though the scheduler is suspended, so a critical section
 				is used. */
-				taskENTER_CRITICAL();
+				taskENTER_KERNEL_CRITICAL();
 				{
 					if( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) != NULL )
 					{
@@ -2666,10 +2996,11 @@ BaseType_t xYieldRequired = pdFALSE;
 						mtCOVERAGE_TEST_MARKER();
 					}
 				}
-				taskEXIT_CRITICAL();
+				taskEXIT_KERNEL_CRITICAL();
 
 				/* Place the unblocked task into the appropriate ready list. */
 				prvAddTaskToReadyList( pxTCB );
+				taskUNLOCK_KERNEL_FROM_TASK();
 
 				/* A task being unblocked cannot cause an immediate context
 				switch if preemption is turned off. */
@@ -2720,6 +3051,10 @@ BaseType_t xSwitchRequired = pdFALSE;
 		block. */
 		const TickType_t xConstTickCount = xTickCount + ( TickType_t ) 1;
 
+		/* The tick interrupt runs with interrupts masked, and
+		xTaskResumeAll() calls this from a critical section. */
+		taskLOCK_KERNEL();
+
 		/* Increment the RTOS tick, switching the delayed and overflowed
 		delayed lists if it wraps to 0. */
 		xTickCount = xConstTickCount;
@@ -2757,7 +3092,7 @@ BaseType_t xSwitchRequired = pdFALSE;
 					item at the head of the delayed list.  This is the time
 					at which the task at the head of the delayed list must
 					be removed from the Blocked state. */
-					pxTCB = listGET_OWNER_OF_HEAD_ENTRY( pxDelayedTaskList ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+					pxTCB = listGET_OWNER_OF_HEAD_ENTRY_OF_TYPE( pxDelayedTaskList, TCB_t, xStateListItem ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
 					xItemValue = listGET_LIST_ITEM_VALUE( &( pxTCB->xStateListItem ) );
 
 					if( xConstTickCount < xItemValue )
@@ -2831,6 +3166,10 @@ BaseType_t xSwitchRequired = pdFALSE;
 		}
 		#endif /* ( ( configUSE_PREEMPTION == 1 ) && ( configUSE_TIME_SLICING == 1 ) ) */
 
+		/* The tick hook can use the ISR safe API, which takes object locks,
+		so is called without the kernel lock. */
+		taskUNLOCK_KERNEL();
+
 		#if ( configUSE_TICK_HOOK == 1 )
 		{
 			/* Guard against the tick hook being called when the pended tick
@@ -2895,11 +3234,11 @@ BaseType_t xSwitchRequired = pdFALSE;
 
 		/* Save the hook function in the TCB.  A critical section is required as
 		the value can be accessed from an interrupt. */
-		taskENTER_CRITICAL();
+		taskENTER_KERNEL_CRITICAL();
 		{
 			xTCB->pxTaskTag = pxHookFunction;
 		}
-		taskEXIT_CRITICAL();
+		taskEXIT_KERNEL_CRITICAL();
 	}
 
 #endif /* configUSE_APPLICATION_TASK_TAG */
@@ -2917,11 +3256,11 @@ BaseType_t xSwitchRequired = pdFALSE;
 
 		/* Save the hook function in the TCB.  A critical section is required as
 		the value can be accessed from an interrupt. */
-		taskENTER_CRITICAL();
+		taskENTER_KERNEL_CRITICAL();
 		{
 			xReturn = pxTCB->pxTaskTag;
 		}
-		taskEXIT_CRITICAL();
+		taskEXIT_KERNEL_CRITICAL();
 
 		return xReturn;
 	}
@@ -3001,12 +3340,20 @@ void vTaskSwitchContext( void )
 
 		#if ( configGENERATE_RUN_TIME_STATS == 1 )
 		{
+			#ifdef portGET_ISR_RUN_TIME_COUNTER_VALUE
+				uint32_t ulIsrTime;
+			#endif
+
 			#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
 				portALT_GET_RUN_TIME_COUNTER_VALUE( ulTotalRunTime );
 			#else
 				ulTotalRunTime = portGET_RUN_TIME_COUNTER_VALUE();
 			#endif
 
+			#ifdef portGET_ISR_RUN_TIME_COUNTER_VALUE
+				ulIsrTime = portGET_ISR_RUN_TIME_COUNTER_VALUE();
+			#endif
+
 			/* Add the amount of time the task has been running to the
 			accumulated time so far.  The time the task started running was
 			stored in ulTaskSwitchedInTime.  Note that there is no overflow
@@ -3016,13 +3363,41 @@ void vTaskSwitchContext( void )
 			are provided by the application, not the kernel. */
 			if( ulTotalRunTime > ulTaskSwitchedInTime )
 			{
-				pxCurrentTCB->ulRunTimeCounter += ( ulTotalRunTime - ulTaskSwitchedInTime );
+				#ifdef portGET_ISR_RUN_TIME_COUNTER_VALUE
+				{
+				uint32_t ulTaskTime = ulTotalRunTime - ulTaskSwitchedInTime;
+
+					/* Interrupts that ran while the task was switched in are
+					not charged to the task. */
+					if( ( ulIsrTime - ulIsrTimeAtSwitchIn ) < ulTaskTime )
+					{
+						pxCurrentTCB->ulRunTimeCounter += ( ulTaskTime - ( ulIsrTime - ulIsrTimeAtSwitchIn ) );
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				#else
+				{
+					pxCurrentTCB->ulRunTimeCounter += ( ulTotalRunTime - ulTaskSwitchedInTime );
+				}
+				#endif /* portGET_ISR_RUN_TIME_COUNTER_VALUE */
 			}
 			else
 			{
 				mtCOVERAGE_TEST_MARKER();
 			}
 			ulTaskSwitchedInTime = ulTotalRunTime;
+
+			#ifdef portGET_ISR_RUN_TIME_COUNTER_VALUE
+			{
+				/* Moved on with ulTaskSwitchedInTime even when nothing was
+				charged, otherwise interrupts that ran before this switch would
+				be taken off the next task's time as well. */
+				ulIsrTimeAtSwitchIn = ulIsrTime;
+			}
+			#endif
 		}
 		#endif /* configGENERATE_RUN_TIME_STATS */
 
@@ -3037,10 +3412,16 @@ void vTaskSwitchContext( void )
 		#endif
 
 		/* Select a new task to run using either the generic C or port
-		optimised asm code. */
+		optimised asm code.  The port calls this function with interrupts
+		masked. */
+		taskLOCK_KERNEL();
 		taskSELECT_HIGHEST_PRIORITY_TASK(); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+		taskUNLOCK_KERNEL();
 		traceTASK_SWITCHED_IN();
 
+		/* Guard the stack of the task being switched in, if configured. */
+		taskSET_STACK_GUARD();
+
 		/* After the new task is switched in, update the global errno. */
 		#if( configUSE_POSIX_ERRNO == 1 )
 		{
@@ -3061,6 +3442,18 @@ void vTaskSwitchContext( void )
 }
 /*-----------------------------------------------------------*/
 
+#if( configCHECK_FOR_STACK_OVERFLOW == 3 )
+
+	void vTaskStackGuardHit( void )
+	{
+		/* Called by the port from its fault handler when the running task
+		has accessed the guard region at the limit of its stack. */
+		vApplicationStackOverflowHook( ( TaskHandle_t ) pxCurrentTCB, pxCurrentTCB->pcTaskName );
+	}
+
+#endif /* configCHECK_FOR_STACK_OVERFLOW */
+/*-----------------------------------------------------------*/
+
 void vTaskPlaceOnEventList( List_t * const pxEventList, const TickType_t xTicksToWait )
 {
 	configASSERT( pxEventList );
@@ -3072,9 +3465,11 @@ void vTaskPlaceOnEventList( List_t * const pxEventList, const TickType_t xTicksT
 	This is placed in the list in priority order so the highest priority task
 	is the first to be woken by the event.  The queue that contains the event
 	list is locked, preventing simultaneous access from interrupts. */
+	taskLOCK_KERNEL_FROM_TASK();
 	vListInsert( pxEventList, &( pxCurrentTCB->xEventListItem ) );
 
 	prvAddCurrentTaskToDelayedList( xTicksToWait, pdTRUE );
+	taskUNLOCK_KERNEL_FROM_TASK();
 }
 /*-----------------------------------------------------------*/
 
@@ -3089,6 +3484,7 @@ void vTaskPlaceOnUnorderedEventList( List_t * pxEventList, const TickType_t xIte
 	/* Store the item value in the event list item.  It is safe to access the
 	event list item here as interrupts won't access the event list item of a
 	task that is not in the Blocked state. */
+	taskLOCK_KERNEL_FROM_TASK();
 	listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xEventListItem ), xItemValue | taskEVENT_LIST_ITEM_VALUE_IN_USE );
 
 	/* Place the event list item of the TCB at the end of the appropriate event
@@ -3099,6 +3495,7 @@ void vTaskPlaceOnUnorderedEventList( List_t * pxEventList, const TickType_t xIte
 	vListInsertEnd( pxEventList, &( pxCurrentTCB->xEventListItem ) );
 
 	prvAddCurrentTaskToDelayedList( xTicksToWait, pdTRUE );
+	taskUNLOCK_KERNEL_FROM_TASK();
 }
 /*-----------------------------------------------------------*/
 
@@ -3118,6 +3515,7 @@ void vTaskPlaceOnUnorderedEventList( List_t * pxEventList, const TickType_t xIte
 		In this case it is assume that this is the only task that is going to
 		be waiting on this event list, so the faster vListInsertEnd() function
 		can be used in place of vListInsert. */
+		taskLOCK_KERNEL_FROM_TASK();
 		vListInsertEnd( pxEventList, &( pxCurrentTCB->xEventListItem ) );
 
 		/* If the task should block indefinitely then set the block time to a
@@ -3130,6 +3528,7 @@ void vTaskPlaceOnUnorderedEventList( List_t * pxEventList, const TickType_t xIte
 
 		traceTASK_DELAY_UNTIL( ( xTickCount + xTicksToWait ) );
 		prvAddCurrentTaskToDelayedList( xTicksToWait, xWaitIndefinitely );
+		taskUNLOCK_KERNEL_FROM_TASK();
 	}
 
 #endif /* configUSE_TIMERS */
@@ -3153,7 +3552,8 @@ BaseType_t xReturn;
 
 	This function assumes that a check has already been made to ensure that
 	pxEventList is not empty. */
-	pxUnblockedTCB = listGET_OWNER_OF_HEAD_ENTRY( pxEventList ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+	taskLOCK_KERNEL();
+	pxUnblockedTCB = listGET_OWNER_OF_HEAD_ENTRY_OF_TYPE( pxEventList, TCB_t, xEventListItem ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
 	configASSERT( pxUnblockedTCB );
 	( void ) uxListRemove( &( pxUnblockedTCB->xEventListItem ) );
 
@@ -3198,6 +3598,7 @@ BaseType_t xReturn;
 	{
 		xReturn = pdFALSE;
 	}
+	taskUNLOCK_KERNEL();
 
 	return xReturn;
 }
@@ -3212,11 +3613,12 @@ TCB_t *pxUnblockedTCB;
 	configASSERT( uxSchedulerSuspended != pdFALSE );
 
 	/* Store the new item value in the event list. */
+	taskLOCK_KERNEL_FROM_TASK();
 	listSET_LIST_ITEM_VALUE( pxEventListItem, xItemValue | taskEVENT_LIST_ITEM_VALUE_IN_USE );
 
 	/* Remove the event list form the event flag.  Interrupts do not access
 	event flags. */
-	pxUnblockedTCB = listGET_LIST_ITEM_OWNER( pxEventListItem ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+	pxUnblockedTCB = listGET_LIST_ITEM_OWNER_OF_TYPE( pxEventListItem, TCB_t, xEventListItem ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
 	configASSERT( pxUnblockedTCB );
 	( void ) uxListRemove( pxEventListItem );
 
@@ -3248,18 +3650,19 @@ TCB_t *pxUnblockedTCB;
 		occurs immediately that the scheduler is resumed (unsuspended). */
 		xYieldPending = pdTRUE;
 	}
+	taskUNLOCK_KERNEL_FROM_TASK();
 }
 /*-----------------------------------------------------------*/
 
 void vTaskSetTimeOutState( TimeOut_t * const pxTimeOut )
 {
 	configASSERT( pxTimeOut );
-	taskENTER_CRITICAL();
+	taskENTER_KERNEL_CRITICAL();
 	{
 		pxTimeOut->xOverflowCount = xNumOfOverflows;
 		pxTimeOut->xTimeOnEntering = xTickCount;
 	}
-	taskEXIT_CRITICAL();
+	taskEXIT_KERNEL_CRITICAL();
 }
 /*-----------------------------------------------------------*/
 
@@ -3278,7 +3681,7 @@ BaseType_t xReturn;
 	configASSERT( pxTimeOut );
 	configASSERT( pxTicksToWait );
 
-	taskENTER_CRITICAL();
+	taskENTER_KERNEL_CRITICAL();
 	{
 		/* Minor optimisation.  The tick count cannot change in this block. */
 		const TickType_t xConstTickCount = xTickCount;
@@ -3328,7 +3731,7 @@ BaseType_t xReturn;
 			xReturn = pdTRUE;
 		}
 	}
-	taskEXIT_CRITICAL();
+	taskEXIT_KERNEL_CRITICAL();
 
 	return xReturn;
 }
@@ -3453,6 +3856,15 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 		}
 		#endif /* configUSE_IDLE_HOOK */
 
+		#if ( configUSE_IDLE_JOBS == 1 )
+		{
+			/* Give the next pending idle job a turn.  The job runs at the
+			idle priority, so any task that becomes ready preempts it, and it
+			stops at its budget or as soon as another task is ready. */
+			prvRunIdleJobs();
+		}
+		#endif /* configUSE_IDLE_JOBS */
+
 		/* This conditional compilation should use inequality to 0, not equality
 		to 1.  This is to ensure portSUPPRESS_TICKS_AND_SLEEP() is called when
 		user defined low power mode	implementations require
@@ -3468,6 +3880,16 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 			valid. */
 			xExpectedIdleTime = prvGetExpectedIdleTime();
 
+			#if ( configUSE_IDLE_JOBS == 1 )
+			{
+				/* Do not sleep while an idle job still has work to do. */
+				if( prvIdleJobsPending() != pdFALSE )
+				{
+					xExpectedIdleTime = 0;
+				}
+			}
+			#endif /* configUSE_IDLE_JOBS */
+
 			if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
 			{
 				vTaskSuspendAll();
@@ -3588,6 +4010,33 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 #endif /* configNUM_THREAD_LOCAL_STORAGE_POINTERS */
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_ARENAS == 1 )
+
+	void vTaskSetArena( TaskHandle_t xTaskToSet, struct ArenaDef_t *pxArena )
+	{
+	TCB_t *pxTCB;
+
+		pxTCB = prvGetTCBFromHandle( xTaskToSet );
+		configASSERT( pxTCB != NULL );
+		pxTCB->pxArena = pxArena;
+	}
+
+#endif /* configUSE_ARENAS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_ARENAS == 1 )
+
+	struct ArenaDef_t *xTaskGetArena( TaskHandle_t xTaskToQuery )
+	{
+	TCB_t *pxTCB;
+
+		pxTCB = prvGetTCBFromHandle( xTaskToQuery );
+		return pxTCB->pxArena;
+	}
+
+#endif /* configUSE_ARENAS */
+/*-----------------------------------------------------------*/
+
 #if ( portUSING_MPU_WRAPPERS == 1 )
 
 	void vTaskAllocateMPURegions( TaskHandle_t xTaskToModify, const MemoryRegion_t * const xRegions )
@@ -3649,14 +4098,14 @@ static void prvCheckTasksWaitingTermination( void )
 		being called too often in the idle task. */
 		while( uxDeletedTasksWaitingCleanUp > ( UBaseType_t ) 0U )
 		{
-			taskENTER_CRITICAL();
+			taskENTER_KERNEL_CRITICAL();
 			{
-				pxTCB = listGET_OWNER_OF_HEAD_ENTRY( ( &xTasksWaitingTermination ) ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+				pxTCB = listGET_OWNER_OF_HEAD_ENTRY_OF_TYPE( ( &xTasksWaitingTermination ), TCB_t, xStateListItem ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
 				( void ) uxListRemove( &( pxTCB->xStateListItem ) );
 				--uxCurrentNumberOfTasks;
 				--uxDeletedTasksWaitingCleanUp;
 			}
-			taskEXIT_CRITICAL();
+			taskEXIT_KERNEL_CRITICAL();
 
 			prvDeleteTCB( pxTCB );
 		}
@@ -3721,12 +4170,14 @@ static void prvCheckTasksWaitingTermination( void )
 					if( eState == eSuspended )
 					{
 						vTaskSuspendAll();
+						taskLOCK_KERNEL_FROM_TASK();
 						{
 							if( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) != NULL )
 							{
 								pxTaskStatus->eCurrentState = eBlocked;
 							}
 						}
+						taskUNLOCK_KERNEL_FROM_TASK();
 						( void ) xTaskResumeAll();
 					}
 				}
@@ -3763,24 +4214,33 @@ static void prvCheckTasksWaitingTermination( void )
 
 #if ( configUSE_TRACE_FACILITY == 1 )
 
-	static UBaseType_t prvListTasksWithinSingleList( TaskStatus_t *pxTaskStatusArray, List_t *pxList, eTaskState eState )
+	static UBaseType_t prvListTasksWithinSingleList( TaskStatus_t *pxTaskStatusArray, UBaseType_t uxArraySize, List_t *pxList, eTaskState eState, BaseType_t xGetFreeStackSpace )
 	{
 	configLIST_VOLATILE TCB_t *pxNextTCB, *pxFirstTCB;
 	UBaseType_t uxTask = 0;
 
 		if( listCURRENT_LIST_LENGTH( pxList ) > ( UBaseType_t ) 0 )
 		{
-			listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+			listGET_OWNER_OF_NEXT_ENTRY_OF_TYPE( pxFirstTCB, pxList, TCB_t, xStateListItem ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
 
 			/* Populate an TaskStatus_t structure within the
 			pxTaskStatusArray array for each task that is referenced from
 			pxList.  See the definition of TaskStatus_t in task.h for the
-			meaning of each TaskStatus_t structure member. */
+			meaning of each TaskStatus_t structure member.  The walk goes
+			all the way round even once the array is full, so it leaves the
+			list index where a complete walk would. */
 			do
 			{
-				listGET_OWNER_OF_NEXT_ENTRY( pxNextTCB, pxList ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
-				vTaskGetInfo( ( TaskHandle_t ) pxNextTCB, &( pxTaskStatusArray[ uxTask ] ), pdTRUE, eState );
-				uxTask++;
+				listGET_OWNER_OF_NEXT_ENTRY_OF_TYPE( pxNextTCB, pxList, TCB_t, xStateListItem ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+				if( uxTask < uxArraySize )
+				{
+					vTaskGetInfo( ( TaskHandle_t ) pxNextTCB, &( pxTaskStatusArray[ uxTask ] ), xGetFreeStackSpace, eState );
+					uxTask++;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
 			} while( pxNextTCB != pxFirstTCB );
 		}
 		else
@@ -3800,6 +4260,16 @@ static void prvCheckTasksWaitingTermination( void )
 	{
 	uint32_t ulCount = 0U;
 
+		#if( configCHECK_FOR_STACK_OVERFLOW == 3 )
+		{
+			/* The guard region at the stack limit, and the alignment gap
+			below it, can never be used by the task - an access faults - so
+			they are not counted as free.  The guard also cannot be read while
+			its task is running, so the scan starts above it. */
+			pucStackByte = ( const uint8_t * ) portSTACK_GUARD_END( pucStackByte );
+		}
+		#endif /* configCHECK_FOR_STACK_OVERFLOW */
+
 		while( *pucStackByte == ( uint8_t ) tskSTACK_FILL_BYTE )
 		{
 			pucStackByte -= portSTACK_GROWTH;
@@ -3901,6 +4371,21 @@ static void prvCheckTasksWaitingTermination( void )
 		}
 		#endif /* configUSE_NEWLIB_REENTRANT */
 
+		/* Release the memory of the arena attached to the task, if any, in
+		one go. */
+		#if ( configUSE_ARENAS == 1 )
+		{
+			if( pxTCB->pxArena != NULL )
+			{
+				vArenaDelete( pxTCB->pxArena );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif /* configUSE_ARENAS */
+
 		#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) && ( portUSING_MPU_WRAPPERS == 0 ) )
 		{
 			/* The task can only have been allocated dynamically - free both
@@ -3958,7 +4443,7 @@ TCB_t *pxTCB;
 		the item at the head of the delayed list.  This is the time at
 		which the task at the head of the delayed list should be removed
 		from the Blocked state. */
-		( pxTCB ) = listGET_OWNER_OF_HEAD_ENTRY( pxDelayedTaskList ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+		( pxTCB ) = listGET_OWNER_OF_HEAD_ENTRY_OF_TYPE( pxDelayedTaskList, TCB_t, xStateListItem ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
 		xNextTaskUnblockTime = listGET_LIST_ITEM_VALUE( &( ( pxTCB )->xStateListItem ) );
 	}
 }
@@ -4016,6 +4501,8 @@ TCB_t *pxTCB;
 	TCB_t * const pxMutexHolderTCB = pxMutexHolder;
 	BaseType_t xReturn = pdFALSE;
 
+		taskLOCK_KERNEL();
+
 		/* If the mutex was given back by an interrupt while the queue was
 		locked then the mutex holder might now be NULL.  _RB_ Is this still
 		needed as interrupts can no longer use mutexes? */
@@ -4092,6 +4579,7 @@ TCB_t *pxTCB;
 		{
 			mtCOVERAGE_TEST_MARKER();
 		}
+		taskUNLOCK_KERNEL();
 
 		return xReturn;
 	}
@@ -4106,6 +4594,8 @@ TCB_t *pxTCB;
 	TCB_t * const pxTCB = pxMutexHolder;
 	BaseType_t xReturn = pdFALSE;
 
+		taskLOCK_KERNEL();
+
 		if( pxMutexHolder != NULL )
 		{
 			/* A task can only have an inherited priority if it holds the mutex.
@@ -4172,6 +4662,7 @@ TCB_t *pxTCB;
 		{
 			mtCOVERAGE_TEST_MARKER();
 		}
+		taskUNLOCK_KERNEL();
 
 		return xReturn;
 	}
@@ -4187,6 +4678,8 @@ TCB_t *pxTCB;
 	UBaseType_t uxPriorityUsedOnEntry, uxPriorityToUse;
 	const UBaseType_t uxOnlyOneMutexHeld = ( UBaseType_t ) 1;
 
+		taskLOCK_KERNEL();
+
 		if( pxMutexHolder != NULL )
 		{
 			/* If pxMutexHolder is not NULL then the holder must hold at least
@@ -4279,6 +4772,7 @@ TCB_t *pxTCB;
 		{
 			mtCOVERAGE_TEST_MARKER();
 		}
+		taskUNLOCK_KERNEL();
 	}
 
 #endif /* configUSE_MUTEXES */
@@ -4636,7 +5130,7 @@ TickType_t uxReturn;
 	{
 	uint32_t ulReturn;
 
-		taskENTER_CRITICAL();
+		taskENTER_KERNEL_CRITICAL();
 		{
 			/* Only block if the notification count is not already non-zero. */
 			if( pxCurrentTCB->ulNotifiedValue == 0UL )
@@ -4665,9 +5159,9 @@ TickType_t uxReturn;
 				mtCOVERAGE_TEST_MARKER();
 			}
 		}
-		taskEXIT_CRITICAL();
+		taskEXIT_KERNEL_CRITICAL();
 
-		taskENTER_CRITICAL();
+		taskENTER_KERNEL_CRITICAL();
 		{
 			traceTASK_NOTIFY_TAKE();
 			ulReturn = pxCurrentTCB->ulNotifiedValue;
@@ -4690,7 +5184,7 @@ TickType_t uxReturn;
 
 			pxCurrentTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
 		}
-		taskEXIT_CRITICAL();
+		taskEXIT_KERNEL_CRITICAL();
 
 		return ulReturn;
 	}
@@ -4704,7 +5198,7 @@ TickType_t uxReturn;
 	{
 	BaseType_t xReturn;
 
-		taskENTER_CRITICAL();
+		taskENTER_KERNEL_CRITICAL();
 		{
 			/* Only block if a notification is not already pending. */
 			if( pxCurrentTCB->ucNotifyState != taskNOTIFICATION_RECEIVED )
@@ -4738,9 +5232,9 @@ TickType_t uxReturn;
 				mtCOVERAGE_TEST_MARKER();
 			}
 		}
-		taskEXIT_CRITICAL();
+		taskEXIT_KERNEL_CRITICAL();
 
-		taskENTER_CRITICAL();
+		taskENTER_KERNEL_CRITICAL();
 		{
 			traceTASK_NOTIFY_WAIT();
 
@@ -4770,7 +5264,7 @@ TickType_t uxReturn;
 
 			pxCurrentTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
 		}
-		taskEXIT_CRITICAL();
+		taskEXIT_KERNEL_CRITICAL();
 
 		return xReturn;
 	}
@@ -4789,7 +5283,7 @@ TickType_t uxReturn;
 		configASSERT( xTaskToNotify );
 		pxTCB = xTaskToNotify;
 
-		taskENTER_CRITICAL();
+		taskENTER_KERNEL_CRITICAL();
 		{
 			if( pulPreviousNotificationValue != NULL )
 			{
@@ -4884,7 +5378,7 @@ TickType_t uxReturn;
 				mtCOVERAGE_TEST_MARKER();
 			}
 		}
-		taskEXIT_CRITICAL();
+		taskEXIT_KERNEL_CRITICAL();
 
 		return xReturn;
 	}
@@ -4924,6 +5418,7 @@ TickType_t uxReturn;
 		pxTCB = xTaskToNotify;
 
 		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		taskLOCK_KERNEL();
 		{
 			if( pulPreviousNotificationValue != NULL )
 			{
@@ -5013,6 +5508,7 @@ TickType_t uxReturn;
 				}
 			}
 		}
+		taskUNLOCK_KERNEL();
 		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
 
 		return xReturn;
@@ -5052,6 +5548,7 @@ TickType_t uxReturn;
 		pxTCB = xTaskToNotify;
 
 		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		taskLOCK_KERNEL();
 		{
 			ucOriginalNotifyState = pxTCB->ucNotifyState;
 			pxTCB->ucNotifyState = taskNOTIFICATION_RECEIVED;
@@ -5101,6 +5598,7 @@ TickType_t uxReturn;
 				}
 			}
 		}
+		taskUNLOCK_KERNEL();
 		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
 	}
 
@@ -5118,7 +5616,7 @@ TickType_t uxReturn;
 		its notification state cleared. */
 		pxTCB = prvGetTCBFromHandle( xTask );
 
-		taskENTER_CRITICAL();
+		taskENTER_KERNEL_CRITICAL();
 		{
 			if( pxTCB->ucNotifyState == taskNOTIFICATION_RECEIVED )
 			{
@@ -5130,7 +5628,7 @@ TickType_t uxReturn;
 				xReturn = pdFAIL;
 			}
 		}
-		taskEXIT_CRITICAL();
+		taskEXIT_KERNEL_CRITICAL();
 
 		return xReturn;
 	}
@@ -5149,14 +5647,14 @@ TickType_t uxReturn;
 		its notification state cleared. */
 		pxTCB = prvGetTCBFromHandle( xTask );
 
-		taskENTER_CRITICAL();
+		taskENTER_KERNEL_CRITICAL();
 		{
 			/* Return the notification as it was before the bits were cleared,
 			then clear the bit mask. */
 			ulReturn = pxCurrentTCB->ulNotifiedValue;
 			pxTCB->ulNotifiedValue &= ~ulBitsToClear;
 		}
-		taskEXIT_CRITICAL();
+		taskEXIT_KERNEL_CRITICAL();
 
 		return ulReturn;
 	}
@@ -5174,6 +5672,309 @@ TickType_t uxReturn;
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_IDLE_JOBS == 1 )
+
+	IdleJobHandle_t xTaskRegisterIdleJob( const char * const pcJobName, IdleJobFunction_t pxJobFunction, void * const pvParameters, const uint32_t ulBudget ) /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+	{
+	IdleJob_t *pxJob = NULL;
+
+		configASSERT( pxJobFunction );
+
+		taskENTER_KERNEL_CRITICAL();
+		{
+			if( uxIdleJobCount < ( UBaseType_t ) configIDLE_JOB_REGISTRY_SIZE )
+			{
+				pxJob = &( xIdleJobs[ uxIdleJobCount ] );
+				pxJob->pcJobName = pcJobName;
+				pxJob->pxJobFunction = pxJobFunction;
+				pxJob->pvParameters = pvParameters;
+				pxJob->ulBudget = ulBudget;
+				pxJob->ulRunTimeCounter = 0UL;
+				pxJob->ulRuns = 0UL;
+				pxJob->ulOverruns = 0UL;
+
+				/* A new job gets its first turn at the next idle time. */
+				pxJob->xPending = pdTRUE;
+
+				/* Published last, so the idle task never sees a job that is
+				not filled in. */
+				uxIdleJobCount++;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_KERNEL_CRITICAL();
+
+		return pxJob;
+	}
+
+#endif /* configUSE_IDLE_JOBS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_IDLE_JOBS == 1 )
+
+	void vTaskTriggerIdleJob( IdleJobHandle_t xJob )
+	{
+		configASSERT( xJob );
+
+		/* A single store, so this is safe from tasks and interrupts alike. */
+		xJob->xPending = pdTRUE;
+	}
+
+#endif /* configUSE_IDLE_JOBS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_IDLE_JOBS == 1 )
+
+	BaseType_t xTaskIdleJobShouldYield( void )
+	{
+	BaseType_t xReturn;
+
+		/* Only the idle task runs jobs. */
+		configASSERT( pxCurrentIdleJob != NULL );
+		configASSERT( pxCurrentTCB == xIdleTaskHandle );
+
+		if( prvOtherTaskReady() != pdFALSE )
+		{
+			xReturn = pdTRUE;
+		}
+		else if( ( prvGetIdleRunTime() - ulIdleJobStartTime ) >= pxCurrentIdleJob->ulBudget )
+		{
+			xReturn = pdTRUE;
+		}
+		else
+		{
+			xReturn = pdFALSE;
+		}
+
+		if( xReturn != pdFALSE )
+		{
+			xIdleJobAskedToYield = pdTRUE;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_IDLE_JOBS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_IDLE_JOBS == 1 )
+
+	UBaseType_t uxTaskGetIdleJobStats( IdleJobStatus_t * const pxJobStatusArray, const UBaseType_t uxArraySize, uint32_t * const pulTotalIdleTime )
+	{
+	UBaseType_t uxJob, uxCount;
+	IdleJob_t *pxJob;
+
+		vTaskSuspendAll();
+		{
+			uxCount = uxIdleJobCount;
+			if( uxCount > uxArraySize )
+			{
+				uxCount = uxArraySize;
+			}
+
+			for( uxJob = 0; uxJob < uxCount; uxJob++ )
+			{
+				pxJob = &( xIdleJobs[ uxJob ] );
+				pxJobStatusArray[ uxJob ].xHandle = pxJob;
+				pxJobStatusArray[ uxJob ].pcJobName = pxJob->pcJobName;
+				pxJobStatusArray[ uxJob ].ulBudget = pxJob->ulBudget;
+				pxJobStatusArray[ uxJob ].ulRunTimeCounter = pxJob->ulRunTimeCounter;
+				pxJobStatusArray[ uxJob ].ulRuns = pxJob->ulRuns;
+				pxJobStatusArray[ uxJob ].ulOverruns = pxJob->ulOverruns;
+				pxJobStatusArray[ uxJob ].xPending = pxJob->xPending;
+			}
+
+			if( pulTotalIdleTime != NULL )
+			{
+				/* The idle task is not running while this task is, so its
+				counter is up to date. */
+				*pulTotalIdleTime = xIdleTaskHandle->ulRunTimeCounter;
+			}
+		}
+		( void ) xTaskResumeAll();
+
+		return uxCount;
+	}
+
+#endif /* configUSE_IDLE_JOBS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_IDLE_JOBS == 1 )
+
+	static void prvRunIdleJobs( void )
+	{
+	UBaseType_t uxChecked;
+	const UBaseType_t uxCount = uxIdleJobCount;
+	IdleJob_t *pxJob = NULL;
+	BaseType_t xMoreWork;
+	uint32_t ulElapsed;
+
+		/* Look for a pending job, starting after the one that had the last
+		turn, so every job gets a turn before any job gets a second one. */
+		for( uxChecked = 0; uxChecked < uxCount; uxChecked++ )
+		{
+			if( uxNextIdleJob >= uxCount )
+			{
+				uxNextIdleJob = 0;
+			}
+
+			if( xIdleJobs[ uxNextIdleJob ].xPending != pdFALSE )
+			{
+				pxJob = &( xIdleJobs[ uxNextIdleJob ] );
+				uxNextIdleJob++;
+				break;
+			}
+
+			uxNextIdleJob++;
+		}
+
+		if( ( pxJob != NULL ) && ( prvOtherTaskReady() == pdFALSE ) )
+		{
+			/* Cleared before the call, so a trigger that arrives while the
+			job runs is not lost. */
+			pxJob->xPending = pdFALSE;
+
+			ulIdleJobStartTime = prvGetIdleRunTime();
+			xIdleJobAskedToYield = pdFALSE;
+			pxCurrentIdleJob = pxJob;
+
+			xMoreWork = pxJob->pxJobFunction( pxJob->pvParameters );
+
+			pxCurrentIdleJob = NULL;
+			ulElapsed = prvGetIdleRunTime() - ulIdleJobStartTime;
+
+			pxJob->ulRunTimeCounter += ulElapsed;
+			pxJob->ulRuns++;
+
+			/* A job that polls xTaskIdleJobShouldYield() always finishes a
+			little after its budget runs out, which is not an overrun. */
+			if( ( ulElapsed > pxJob->ulBudget ) && ( xIdleJobAskedToYield == pdFALSE ) )
+			{
+				pxJob->ulOverruns++;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			if( xMoreWork != pdFALSE )
+			{
+				pxJob->xPending = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+#endif /* configUSE_IDLE_JOBS */
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_IDLE_JOBS == 1 ) && ( configUSE_TICKLESS_IDLE != 0 ) )
+
+	static BaseType_t prvIdleJobsPending( void )
+	{
+	UBaseType_t uxJob;
+	const UBaseType_t uxCount = uxIdleJobCount;
+	BaseType_t xReturn = pdFALSE;
+
+		for( uxJob = 0; uxJob < uxCount; uxJob++ )
+		{
+			if( xIdleJobs[ uxJob ].xPending != pdFALSE )
+			{
+				xReturn = pdTRUE;
+				break;
+			}
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_IDLE_JOBS && configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_IDLE_JOBS == 1 )
+
+	static BaseType_t prvOtherTaskReady( void )
+	{
+	BaseType_t xReturn;
+	UBaseType_t uxTopPriority;
+
+		/* No critical section is needed as an occasional stale value only
+		makes a job stop early or run one step longer. */
+		if( ( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( UBaseType_t ) 1 ) || ( xYieldPending != pdFALSE ) )
+		{
+			xReturn = pdTRUE;
+		}
+		else
+		{
+			#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 0 )
+			{
+				uxTopPriority = uxTopReadyPriority;
+			}
+			#else
+			{
+				portGET_HIGHEST_PRIORITY( uxTopPriority, uxTopReadyPriority );
+			}
+			#endif
+
+			/* With preemption a higher priority task would already be
+			running, but the cooperative scheduler leaves it to the idle
+			task to notice. */
+			xReturn = ( uxTopPriority > tskIDLE_PRIORITY ) ? pdTRUE : pdFALSE;
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_IDLE_JOBS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_IDLE_JOBS == 1 )
+
+	static uint32_t prvGetIdleRunTime( void )
+	{
+	uint32_t ulNow, ulRunTime;
+
+		/* vTaskSwitchContext() updates both the idle task's counter and
+		ulTaskSwitchedInTime, so they are read together. */
+		taskENTER_KERNEL_CRITICAL();
+		{
+			#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
+				portALT_GET_RUN_TIME_COUNTER_VALUE( ulNow );
+			#else
+				ulNow = portGET_RUN_TIME_COUNTER_VALUE();
+			#endif
+
+			ulRunTime = pxCurrentTCB->ulRunTimeCounter + ( ulNow - ulTaskSwitchedInTime );
+
+			#ifdef portGET_ISR_RUN_TIME_COUNTER_VALUE
+			{
+				/* As in vTaskSwitchContext(), interrupts are not charged. */
+				ulRunTime -= ( portGET_ISR_RUN_TIME_COUNTER_VALUE() - ulIsrTimeAtSwitchIn );
+			}
+			#endif
+		}
+		taskEXIT_KERNEL_CRITICAL();
+
+		return ulRunTime;
+	}
+
+#endif /* configUSE_IDLE_JOBS */
+/*-----------------------------------------------------------*/
+
 static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait, const BaseType_t xCanBlockIndefinitely )
 {
 TickType_t xTimeToWake;
@@ -5188,6 +5989,8 @@ const TickType_t xConstTickCount = xTickCount;
 	}
 	#endif
 
+	portASSERT_KERNEL_LOCKED();
+
 	/* Remove the task from the ready list before adding it to the blocked list
 	as the same list item is used for both lists. */
 	if( uxListRemove( &( pxCurrentTCB->xStateListItem ) ) == ( UBaseType_t ) 0 )
@@ -69,6 +69,16 @@ defining trmTIMER_SERVICE_TASK_NAME in FreeRTOSConfig.h. */
 #define tmrSTATUS_IS_STATICALLY_ALLOCATED	( ( uint8_t ) 0x02 )
 #define tmrSTATUS_IS_AUTORELOAD				( ( uint8_t ) 0x04 )
 
+/* xTimerCreate(), xTimerCreateStatic() and xTimerPendFunctionCall() use the
+first timer service, which runs at configTIMER_TASK_PRIORITY unless
+configTIMER_SERVICE_PRIORITIES says otherwise. */
+#define tmrDEFAULT_TIMER_SERVICE			( ( UBaseType_t ) 0U )
+
+/* Command sequence numbers wrap, so "newer" means no more than half the
+number range ahead. */
+#define tmrSEQUENCE_HALF_RANGE				( ( ~( UBaseType_t ) 0U ) >> 1U )
+#define tmrSEQUENCE_IS_NEWER( uxA, uxB )	( ( ( UBaseType_t ) ( ( uxA ) - ( uxB ) ) != ( UBaseType_t ) 0U ) && ( ( UBaseType_t ) ( ( uxA ) - ( uxB ) ) <= tmrSEQUENCE_HALF_RANGE ) )
+
 /* The definition of the timers themselves. */
 typedef struct tmrTimerControl /* The old naming convention is used to prevent breaking kernel aware debuggers. */
 {
@@ -80,6 +90,17 @@ typedef struct tmrTimerControl /* The old naming convention is used to prevent b
 	#if( configUSE_TRACE_FACILITY == 1 )
 		UBaseType_t			uxTimerNumber;		/*<< An ID assigned by trace tools such as FreeRTOS+Trace */
 	#endif
+	#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+		UBaseType_t			uxNextSequence;		/*<< Sequence number given to the next command posted for this timer. */
+		UBaseType_t			uxPostedSequence;	/*<< Newest sequence number successfully posted to the timer queue.  Older start/reset/stop commands still in the queue are dropped. */
+		UBaseType_t			uxPendingCommands;	/*<< Commands for this timer that are in, or on their way into, the timer queue. */
+	#endif
+	#if( configUSE_TIMER_SLACK == 1 )
+		TickType_t			xSlackInTicks;		/*<< How late the timer is allowed to expire so it can share a wake-up with other timers. */
+	#endif
+	#if( configTIMER_SERVICE_COUNT > 1 )
+		struct tmrTimerService	*pxService;		/*<< The timer service task that manages this timer. */
+	#endif
 	uint8_t 				ucStatus;			/*<< Holds bits to say if the timer was statically allocated or not, and if it is active or not. */
 } xTIMER;
 
@@ -96,6 +117,9 @@ typedef struct tmrTimerParameters
 {
 	TickType_t			xMessageValue;		/*<< An optional value used by a subset of commands, for example, when changing the period of a timer. */
 	Timer_t *			pxTimer;			/*<< The timer to which the command will be applied. */
+	#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+		UBaseType_t		uxSequence;			/*<< Compared against the timer's uxPostedSequence to detect superseded commands. */
+	#endif
 } TimerParameter_t;
 
 
@@ -111,6 +135,9 @@ that is used to determine which message type is valid. */
 typedef struct tmrTimerQueueMessage
 {
 	BaseType_t			xMessageID;			/*<< The command being sent to the timer service task. */
+	#if( configGENERATE_TIMER_COMMAND_STATS == 1 )
+		TickType_t		xTimeSent;			/*<< Tick count when the message was posted, used to measure queue latency. */
+	#endif
 	union
 	{
 		TimerParameter_t xTimerParameters;
@@ -123,23 +150,124 @@ typedef struct tmrTimerQueueMessage
 	} u;
 } DaemonTaskMessage_t;
 
+/* Everything one timer service task needs.  There are
+configTIMER_SERVICE_COUNT of these, each with its own task, command queue and
+pair of active lists, so timers with tight deadlines can be serviced at a
+higher priority than timers whose callbacks do slow housekeeping. */
+typedef struct tmrTimerService
+{
+	/* The lists in which active timers are stored.  Timers are referenced in
+	expire time order, with the nearest expiry time at the front of the list.
+	Only the owning timer service task is allowed to access these lists. */
+	List_t					xActiveTimerList1;
+	List_t					xActiveTimerList2;
+	List_t					*pxCurrentTimerList;
+	List_t					*pxOverflowTimerList;
+
+	/* A queue that is used to send commands to the timer service task. */
+	QueueHandle_t			xTimerQueue;
+	TaskHandle_t			xTimerTaskHandle;
+
+	/* The tick count when prvSampleTimeNow() was last called, used to detect
+	the tick count overflowing. */
+	TickType_t				xLastTime;
+
+	#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+		/* Set while prvSwitchTimerLists() is calling callbacks.  Commands
+		issued from those callbacks must go through the queue as the lists are
+		not yet in a consistent state. */
+		BaseType_t			xSwitchingTimerLists;
+	#endif
+
+	#if( configGENERATE_TIMER_COMMAND_STATS == 1 )
+		/* Written by the timer service task only, apart from
+		uxCommandsFailed. */
+		TimerCommandStats_t	xCommandStats;
+	#endif
+
+	#if( configUSE_OBJECT_LOCKS == 1 )
+		/* Guards the command bookkeeping of the service and of its timers,
+		see configUSE_OBJECT_LOCKS. */
+		portOBJECT_LOCK_TYPE	xObjectLock;
+	#endif
+} TimerService_t;
+
+/* With configUSE_OBJECT_LOCKS set, the critical sections that guard a timer
+take only the lock of the service the timer belongs to. */
+#if( configUSE_OBJECT_LOCKS == 1 )
+	#define tmrENTER_CRITICAL( pxService )			portENTER_OBJECT_CRITICAL( &( ( pxService )->xObjectLock ) )
+	#define tmrEXIT_CRITICAL( pxService )			portEXIT_OBJECT_CRITICAL( &( ( pxService )->xObjectLock ) )
+	#define tmrENTER_CRITICAL_FROM_ISR( pxService )	portENTER_OBJECT_CRITICAL_FROM_ISR( &( ( pxService )->xObjectLock ) )
+	#define tmrEXIT_CRITICAL_FROM_ISR( pxService, x )	portEXIT_OBJECT_CRITICAL_FROM_ISR( &( ( pxService )->xObjectLock ), ( x ) )
+	#define tmrIMAGE_LOCK_FIELDS					, .xObjectLock = portOBJECT_LOCK_INITIALISER
+#else
+	#define tmrENTER_CRITICAL( pxService )			taskENTER_CRITICAL()
+	#define tmrEXIT_CRITICAL( pxService )			taskEXIT_CRITICAL()
+	#define tmrENTER_CRITICAL_FROM_ISR( pxService )	portSET_INTERRUPT_MASK_FROM_ISR()
+	#define tmrEXIT_CRITICAL_FROM_ISR( pxService, x )	portCLEAR_INTERRUPT_MASK_FROM_ISR( ( x ) )
+	#define tmrIMAGE_LOCK_FIELDS
+#endif
+
 /*lint -save -e956 A manual analysis and inspection has been used to determine
 which static variables must be declared volatile. */
 
-/* The list in which active timers are stored.  Timers are referenced in expire
-time order, with the nearest expiry time at the front of the list.  Only the
-timer service task is allowed to access these lists.
-xActiveTimerList1 and xActiveTimerList2 could be at function scope but that
-breaks some kernel aware debuggers, and debuggers that reply on removing the
-static qualifier. */
-PRIVILEGED_DATA static List_t xActiveTimerList1;
-PRIVILEGED_DATA static List_t xActiveTimerList2;
-PRIVILEGED_DATA static List_t *pxCurrentTimerList;
-PRIVILEGED_DATA static List_t *pxOverflowTimerList;
-
-/* A queue that is used to send commands to the timer service task. */
-PRIVILEGED_DATA static QueueHandle_t xTimerQueue = NULL;
-PRIVILEGED_DATA static TaskHandle_t xTimerTaskHandle = NULL;
+/* The timer services.  This could be at function scope but that breaks some
+kernel aware debuggers, and debuggers that reply on removing the static
+qualifier.  xTimerServicesInitialised is set once the lists and queues of all
+the services have been created. */
+PRIVILEGED_DATA static TimerService_t xTimerServices[ configTIMER_SERVICE_COUNT ];
+PRIVILEGED_DATA static BaseType_t xTimerServicesInitialised = pdFALSE;
+
+/* The service that manages a timer.  With a single service the timer does not
+store it. */
+#if( configTIMER_SERVICE_COUNT > 1 )
+	#define tmrTIMER_SERVICE( pxTimer )				( ( pxTimer )->pxService )
+	#define tmrIMAGE_SERVICE_FIELD( uxService )		.pxService = &( xTimerServices[ uxService ] ),
+#else
+	#define tmrTIMER_SERVICE( pxTimer )				( ( void ) ( pxTimer ), &( xTimerServices[ tmrDEFAULT_TIMER_SERVICE ] ) )
+	#define tmrIMAGE_SERVICE_FIELD( uxService )
+#endif
+
+#if( configUSE_KERNEL_IMAGE == 1 )
+
+	/* Used by kernel_image.h to build a timer as prvInitialiseNewTimer()
+	leaves it.  A timer that starts with the scheduler is also linked into
+	the active list of its service, between pxNextItem and pxPreviousItem,
+	and expires at xExpiry. */
+	#define tmrIMAGE_TIMER_ITEM( xTimer )				( &( ( xTimer ).xTimerListItem ) )
+	#define tmrIMAGE_ACTIVE_LIST( uxService )			( &( xTimerServices[ uxService ].xActiveTimerList1 ) )
+	#define tmrIMAGE_ACTIVE_LIST_END( uxService )		listSTATIC_END_MARKER( xTimerServices[ uxService ].xActiveTimerList1 )
+	#define tmrIMAGE_TIMER( xTimer, pcName, xPeriod, pvID, pxCallback, uxService, xExpiry, pxNextItem, pxPreviousItem, pxList, ucTimerStatus )	\
+	{																																			\
+		.pcTimerName = ( pcName ),																												\
+		.xTimerListItem = listSTATIC_LIST_ITEM( ( xExpiry ), &( xTimer ), ( pxNextItem ), ( pxPreviousItem ), ( pxList ) ),						\
+		.xTimerPeriodInTicks = ( xPeriod ),																										\
+		.pvTimerID = ( pvID ),																													\
+		.pxCallbackFunction = ( pxCallback ),																									\
+		tmrIMAGE_SERVICE_FIELD( uxService )																											\
+		.ucStatus = ( ucTimerStatus )																											\
+	}
+
+	/* A service whose active list already holds the timers of the image.  The
+	other services are set up by prvCheckForValidListAndQueue() as usual, as
+	are the queues and tasks of all of them. */
+	#define tmrIMAGE_SERVICE( uxService, uxActiveTimers, pxFirstTimer, pxLastTimer )																	\
+	{																																					\
+		.xActiveTimerList1 = listSTATIC_LIST( xTimerServices[ uxService ].xActiveTimerList1, ( uxActiveTimers ), ( pxFirstTimer ), ( pxLastTimer ) ),	\
+		.xActiveTimerList2 = listSTATIC_EMPTY_LIST( xTimerServices[ uxService ].xActiveTimerList2 ),													\
+		.pxCurrentTimerList = &( xTimerServices[ uxService ].xActiveTimerList1 ),																		\
+		.pxOverflowTimerList = &( xTimerServices[ uxService ].xActiveTimerList2 )																		\
+		tmrIMAGE_LOCK_FIELDS																															\
+	}
+
+	/* Defines the timers of the image and tmrIMAGE_SERVICES. */
+	#define KERNEL_IMAGE_TIMERS
+	#include "kernel_image.h"
+	#undef KERNEL_IMAGE_TIMERS
+
+	PRIVILEGED_DATA static TimerService_t xTimerServices[ configTIMER_SERVICE_COUNT ] = tmrIMAGE_SERVICES;
+
+#endif /* configUSE_KERNEL_IMAGE */
 
 /*lint -restore */
 
@@ -153,18 +281,37 @@ PRIVILEGED_DATA static TaskHandle_t xTimerTaskHandle = NULL;
 	and TCB. */
 	extern void vApplicationGetTimerTaskMemory( StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer, uint32_t *pulTimerTaskStackSize );
 
+	#if( configTIMER_SERVICE_COUNT > 1 )
+		/* As above, for timer services 1 to configTIMER_SERVICE_COUNT - 1.
+		Service 0 still uses vApplicationGetTimerTaskMemory(). */
+		extern void vApplicationGetTimerServiceTaskMemory( UBaseType_t uxService, StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer, uint32_t *pulTimerTaskStackSize );
+	#endif
+
 #endif
 
 /*
- * Initialise the infrastructure used by the timer service task if it has not
+ * Initialise the infrastructure used by the timer service tasks if it has not
  * been initialised already.
  */
 static void prvCheckForValidListAndQueue( void ) PRIVILEGED_FUNCTION;
 
+#if( configTIMER_SERVICE_COUNT > 1 )
+
+	/*
+	 * Write pcBaseName followed by a space and the service number into
+	 * pcBuffer, truncating the base name so the whole name fits in
+	 * xBufferLength bytes including the terminator.  Service 0 keeps the base
+	 * name alone so kernel aware debuggers still find "Tmr Svc" and "TmrQ".
+	 */
+	static void prvTimerServiceName( char * const pcBuffer, const size_t xBufferLength, const char * const pcBaseName, const UBaseType_t uxService ) PRIVILEGED_FUNCTION; /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+
+#endif
+
 /*
  * The timer service task (daemon).  Timer functionality is controlled by this
- * task.  Other tasks communicate with the timer service task using the
- * xTimerQueue queue.
+ * task.  Other tasks communicate with the timer service task using its
+ * xTimerQueue queue.  pvParameters points to the TimerService_t the task
+ * manages.
  */
 static portTASK_FUNCTION_PROTO( prvTimerTask, pvParameters ) PRIVILEGED_FUNCTION;
 
@@ -172,11 +319,44 @@ static portTASK_FUNCTION_PROTO( prvTimerTask, pvParameters ) PRIVILEGED_FUNCTION
  * Called by the timer service task to interpret and process a command it
  * received on the timer queue.
  */
-static void prvProcessReceivedCommands( void ) PRIVILEGED_FUNCTION;
+static void prvProcessReceivedCommands( TimerService_t * const pxService ) PRIVILEGED_FUNCTION;
 
 /*
- * Insert the timer into either xActiveTimerList1, or xActiveTimerList2,
- * depending on if the expire time causes a timer counter overflow.
+ * Apply a single start, reset, stop, change period or delete command to a
+ * timer.  Called by the timer service task, either for a command received on
+ * the timer queue or, when configUSE_TIMER_COMMAND_COALESCING is 1, directly
+ * for a command issued by the timer service task itself.
+ */
+static void prvProcessTimerCommand( Timer_t * const pxTimer, const BaseType_t xCommandID, const TickType_t xMessageValue ) PRIVILEGED_FUNCTION;
+
+#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+
+	/*
+	 * Returns pdTRUE if a command can be applied by the calling task without
+	 * going through the timer queue - that is, the caller is the timer service
+	 * task and no other command for the timer is queued.
+	 */
+	static BaseType_t prvCanProcessCommandDirectly( const Timer_t * const pxTimer, const BaseType_t xCommandID ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TIMER_COMMAND_COALESCING */
+
+#if( ( configUSE_TIMER_COMMAND_COALESCING == 1 ) || ( configGENERATE_TIMER_COMMAND_STATS == 1 ) )
+
+	/*
+	 * Book-keeping after a timer command has been offered to the timer queue.
+	 * Must be called from within a critical section.  Once a delete command
+	 * has been posted the daemon may already have freed the timer, so
+	 * pxTimer is only dereferenced if the command is not a successfully
+	 * posted delete.
+	 */
+	static void prvCommandPosted( TimerService_t * const pxService, Timer_t * const pxTimer, const DaemonTaskMessage_t * const pxMessage, const BaseType_t xPostResult ) PRIVILEGED_FUNCTION;
+
+#endif
+
+/*
+ * Insert the timer into either xActiveTimerList1, or xActiveTimerList2, of its
+ * timer service, depending on if the expire time causes a timer counter
+ * overflow.
  */
 static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime ) PRIVILEGED_FUNCTION;
 
@@ -184,33 +364,52 @@ static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const Tic
  * An active timer has reached its expire time.  Reload the timer if it is an
  * auto-reload timer, then call its callback.
  */
-static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+static void prvProcessExpiredTimer( TimerService_t * const pxService, const TickType_t xNextExpireTime, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+/*
+ * Call the callback of a timer that expired at xExpiryTime, recording how late
+ * the call is made in the statistics of the timer's service.
+ */
+static void prvCallTimerCallback( Timer_t * const pxTimer, const TickType_t xExpiryTime ) PRIVILEGED_FUNCTION;
+
+#if( configUSE_TIMER_SLACK == 1 )
+
+	/*
+	 * The timer service task has woken because the slack of at least one timer
+	 * has run out.  Process that timer, and every other timer whose expiry time
+	 * has also been reached, before blocking again.
+	 */
+	static void prvProcessExpiredTimerBatch( TimerService_t * const pxService, TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TIMER_SLACK */
 
 /*
  * The tick count has overflowed.  Switch the timer lists after ensuring the
  * current timer list does not still reference some timers.
  */
-static void prvSwitchTimerLists( void ) PRIVILEGED_FUNCTION;
+static void prvSwitchTimerLists( TimerService_t * const pxService ) PRIVILEGED_FUNCTION;
 
 /*
  * Obtain the current tick count, setting *pxTimerListsWereSwitched to pdTRUE
  * if a tick count overflow occurred since prvSampleTimeNow() was last called.
  */
-static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched ) PRIVILEGED_FUNCTION;
+static TickType_t prvSampleTimeNow( TimerService_t * const pxService, BaseType_t * const pxTimerListsWereSwitched ) PRIVILEGED_FUNCTION;
 
 /*
  * If the timer list contains any active timers then return the expire time of
  * the timer that will expire first and set *pxListWasEmpty to false.  If the
  * timer list does not contain any timers then return 0 and set *pxListWasEmpty
- * to pdTRUE.
+ * to pdTRUE.  When configUSE_TIMER_SLACK is 1 the time returned is the
+ * earliest time by which a timer must be processed, that is the smallest
+ * expiry time plus slack.
  */
-static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty ) PRIVILEGED_FUNCTION;
+static TickType_t prvGetNextExpireTime( TimerService_t * const pxService, BaseType_t * const pxListWasEmpty ) PRIVILEGED_FUNCTION;
 
 /*
  * If a timer has expired, process it.  Otherwise, block the timer service task
  * until either a timer does expire or a command is received.
  */
-static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime, BaseType_t xListWasEmpty ) PRIVILEGED_FUNCTION;
+static void prvProcessTimerOrBlockTask( TimerService_t * const pxService, const TickType_t xNextExpireTime, BaseType_t xListWasEmpty ) PRIVILEGED_FUNCTION;
 
 /*
  * Called after a Timer_t structure has been allocated either statically or
@@ -221,51 +420,99 @@ static void prvInitialiseNewTimer(	const char * const pcTimerName,			/*lint !e97
 									const UBaseType_t uxAutoReload,
 									void * const pvTimerID,
 									TimerCallbackFunction_t pxCallbackFunction,
+									const UBaseType_t uxService,
 									Timer_t *pxNewTimer ) PRIVILEGED_FUNCTION;
 /*-----------------------------------------------------------*/
 
 BaseType_t xTimerCreateTimerTask( void )
 {
 BaseType_t xReturn = pdFAIL;
+UBaseType_t uxService;
+TimerService_t *pxService;
+static const UBaseType_t uxServicePriorities[ configTIMER_SERVICE_COUNT ] = configTIMER_SERVICE_PRIORITIES;
+#if( configTIMER_SERVICE_COUNT > 1 )
+	char pcTaskName[ configMAX_TASK_NAME_LEN ]; /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+#else
+	const char * const pcTaskName = configTIMER_SERVICE_TASK_NAME; /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+#endif
 
 	/* This function is called when the scheduler is started if
 	configUSE_TIMERS is set to 1.  Check that the infrastructure used by the
-	timer service task has been created/initialised.  If timers have already
+	timer service tasks has been created/initialised.  If timers have already
 	been created then the initialisation will already have been performed. */
 	prvCheckForValidListAndQueue();
 
-	if( xTimerQueue != NULL )
+	if( xTimerServicesInitialised != pdFALSE )
 	{
-		#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+		for( uxService = 0; uxService < ( UBaseType_t ) configTIMER_SERVICE_COUNT; uxService++ )
 		{
-			StaticTask_t *pxTimerTaskTCBBuffer = NULL;
-			StackType_t *pxTimerTaskStackBuffer = NULL;
-			uint32_t ulTimerTaskStackSize;
-
-			vApplicationGetTimerTaskMemory( &pxTimerTaskTCBBuffer, &pxTimerTaskStackBuffer, &ulTimerTaskStackSize );
-			xTimerTaskHandle = xTaskCreateStatic(	prvTimerTask,
-													configTIMER_SERVICE_TASK_NAME,
-													ulTimerTaskStackSize,
-													NULL,
-													( ( UBaseType_t ) configTIMER_TASK_PRIORITY ) | portPRIVILEGE_BIT,
-													pxTimerTaskStackBuffer,
-													pxTimerTaskTCBBuffer );
-
-			if( xTimerTaskHandle != NULL )
+			pxService = &( xTimerServices[ uxService ] );
+			configASSERT( uxServicePriorities[ uxService ] < ( UBaseType_t ) configMAX_PRIORITIES );
+
+			#if( configTIMER_SERVICE_COUNT > 1 )
 			{
-				xReturn = pdPASS;
+				/* The task name is copied into the TCB, so a buffer on the
+				stack will do. */
+				prvTimerServiceName( pcTaskName, sizeof( pcTaskName ), configTIMER_SERVICE_TASK_NAME, uxService );
+			}
+			#endif
+
+			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+			{
+				StaticTask_t *pxTimerTaskTCBBuffer = NULL;
+				StackType_t *pxTimerTaskStackBuffer = NULL;
+				uint32_t ulTimerTaskStackSize;
+
+				#if( configTIMER_SERVICE_COUNT > 1 )
+				{
+					if( uxService != ( UBaseType_t ) 0 )
+					{
+						vApplicationGetTimerServiceTaskMemory( uxService, &pxTimerTaskTCBBuffer, &pxTimerTaskStackBuffer, &ulTimerTaskStackSize );
+					}
+					else
+					{
+						vApplicationGetTimerTaskMemory( &pxTimerTaskTCBBuffer, &pxTimerTaskStackBuffer, &ulTimerTaskStackSize );
+					}
+				}
+				#else
+				{
+					vApplicationGetTimerTaskMemory( &pxTimerTaskTCBBuffer, &pxTimerTaskStackBuffer, &ulTimerTaskStackSize );
+				}
+				#endif /* configTIMER_SERVICE_COUNT */
+
+				pxService->xTimerTaskHandle = xTaskCreateStatic(	prvTimerTask,
+																	pcTaskName,
+																	ulTimerTaskStackSize,
+																	( void * ) pxService,
+																	uxServicePriorities[ uxService ] | portPRIVILEGE_BIT,
+																	pxTimerTaskStackBuffer,
+																	pxTimerTaskTCBBuffer );
+
+				if( pxService->xTimerTaskHandle != NULL )
+				{
+					xReturn = pdPASS;
+				}
+				else
+				{
+					xReturn = pdFAIL;
+				}
+			}
+			#else
+			{
+				xReturn = xTaskCreate(	prvTimerTask,
+										pcTaskName,
+										configTIMER_TASK_STACK_DEPTH,
+										( void * ) pxService,
+										uxServicePriorities[ uxService ] | portPRIVILEGE_BIT,
+										&( pxService->xTimerTaskHandle ) );
+			}
+			#endif /* configSUPPORT_STATIC_ALLOCATION */
+
+			if( xReturn == pdFAIL )
+			{
+				break;
 			}
 		}
-		#else
-		{
-			xReturn = xTaskCreate(	prvTimerTask,
-									configTIMER_SERVICE_TASK_NAME,
-									configTIMER_TASK_STACK_DEPTH,
-									NULL,
-									( ( UBaseType_t ) configTIMER_TASK_PRIORITY ) | portPRIVILEGE_BIT,
-									&xTimerTaskHandle );
-		}
-		#endif /* configSUPPORT_STATIC_ALLOCATION */
 	}
 	else
 	{
@@ -284,6 +531,17 @@ BaseType_t xReturn = pdFAIL;
 								const UBaseType_t uxAutoReload,
 								void * const pvTimerID,
 								TimerCallbackFunction_t pxCallbackFunction )
+	{
+		return xTimerCreateOnService( pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction, tmrDEFAULT_TIMER_SERVICE );
+	}
+	/*-----------------------------------------------------------*/
+
+	TimerHandle_t xTimerCreateOnService(	const char * const pcTimerName,		/*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+											const TickType_t xTimerPeriodInTicks,
+											const UBaseType_t uxAutoReload,
+											void * const pvTimerID,
+											TimerCallbackFunction_t pxCallbackFunction,
+											const UBaseType_t uxService )
 	{
 	Timer_t *pxNewTimer;
 
@@ -295,7 +553,7 @@ BaseType_t xReturn = pdFAIL;
 			and has not been started.  The auto-reload bit may get set in
 			prvInitialiseNewTimer. */
 			pxNewTimer->ucStatus = 0x00;
-			prvInitialiseNewTimer( pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction, pxNewTimer );
+			prvInitialiseNewTimer( pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction, uxService, pxNewTimer );
 		}
 
 		return pxNewTimer;
@@ -312,6 +570,18 @@ BaseType_t xReturn = pdFAIL;
 										void * const pvTimerID,
 										TimerCallbackFunction_t pxCallbackFunction,
 										StaticTimer_t *pxTimerBuffer )
+	{
+		return xTimerCreateStaticOnService( pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction, pxTimerBuffer, tmrDEFAULT_TIMER_SERVICE );
+	}
+	/*-----------------------------------------------------------*/
+
+	TimerHandle_t xTimerCreateStaticOnService(	const char * const pcTimerName,		/*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+												const TickType_t xTimerPeriodInTicks,
+												const UBaseType_t uxAutoReload,
+												void * const pvTimerID,
+												TimerCallbackFunction_t pxCallbackFunction,
+												StaticTimer_t *pxTimerBuffer,
+												const UBaseType_t uxService )
 	{
 	Timer_t *pxNewTimer;
 
@@ -337,7 +607,7 @@ BaseType_t xReturn = pdFAIL;
 			auto-reload bit may get set in prvInitialiseNewTimer(). */
 			pxNewTimer->ucStatus = tmrSTATUS_IS_STATICALLY_ALLOCATED;
 
-			prvInitialiseNewTimer( pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction, pxNewTimer );
+			prvInitialiseNewTimer( pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction, uxService, pxNewTimer );
 		}
 
 		return pxNewTimer;
@@ -351,11 +621,16 @@ static void prvInitialiseNewTimer(	const char * const pcTimerName,			/*lint !e97
 									const UBaseType_t uxAutoReload,
 									void * const pvTimerID,
 									TimerCallbackFunction_t pxCallbackFunction,
+									const UBaseType_t uxService,
 									Timer_t *pxNewTimer )
 {
 	/* 0 is not a valid value for xTimerPeriodInTicks. */
 	configASSERT( ( xTimerPeriodInTicks > 0 ) );
 
+	/* The timer service must be one of those created by
+	xTimerCreateTimerTask(). */
+	configASSERT( ( uxService < ( UBaseType_t ) configTIMER_SERVICE_COUNT ) );
+
 	if( pxNewTimer != NULL )
 	{
 		/* Ensure the infrastructure used by the timer service task has been
@@ -368,7 +643,28 @@ static void prvInitialiseNewTimer(	const char * const pcTimerName,			/*lint !e97
 		pxNewTimer->xTimerPeriodInTicks = xTimerPeriodInTicks;
 		pxNewTimer->pvTimerID = pvTimerID;
 		pxNewTimer->pxCallbackFunction = pxCallbackFunction;
+		#if( configTIMER_SERVICE_COUNT > 1 )
+		{
+			pxNewTimer->pxService = &( xTimerServices[ uxService ] );
+		}
+		#else
+		{
+			( void ) uxService;
+		}
+		#endif
 		vListInitialiseItem( &( pxNewTimer->xTimerListItem ) );
+		#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+		{
+			pxNewTimer->uxNextSequence = ( UBaseType_t ) 0U;
+			pxNewTimer->uxPostedSequence = ( UBaseType_t ) 0U;
+			pxNewTimer->uxPendingCommands = ( UBaseType_t ) 0U;
+		}
+		#endif
+		#if( configUSE_TIMER_SLACK == 1 )
+		{
+			pxNewTimer->xSlackInTicks = ( TickType_t ) 0U;
+		}
+		#endif
 		if( uxAutoReload != pdFALSE )
 		{
 			pxNewTimer->ucStatus |= tmrSTATUS_IS_AUTORELOAD;
@@ -382,12 +678,39 @@ BaseType_t xTimerGenericCommand( TimerHandle_t xTimer, const BaseType_t xCommand
 {
 BaseType_t xReturn = pdFAIL;
 DaemonTaskMessage_t xMessage;
+Timer_t * const pxTimer = xTimer;
+TimerService_t *pxService;
+#if( ( configUSE_TIMER_COMMAND_COALESCING == 1 ) || ( configGENERATE_TIMER_COMMAND_STATS == 1 ) )
+	UBaseType_t uxSavedInterruptStatus = 0;
+#endif
 
 	configASSERT( xTimer );
+	pxService = tmrTIMER_SERVICE( pxTimer );
+
+	#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+	{
+		/* A callback (or anything else) running in the timer service task
+		does not need to post to its own queue - the command can be applied
+		straight away. */
+		if( ( pxService->xTimerQueue != NULL ) && ( prvCanProcessCommandDirectly( pxTimer, xCommandID ) != pdFALSE ) )
+		{
+			prvProcessTimerCommand( pxTimer, xCommandID, xOptionalValue );
+
+			#if( configGENERATE_TIMER_COMMAND_STATS == 1 )
+			{
+				pxService->xCommandStats.uxCommandsDirect++;
+			}
+			#endif
+
+			traceTIMER_COMMAND_SEND( xTimer, xCommandID, xOptionalValue, pdPASS );
+			return pdPASS;
+		}
+	}
+	#endif /* configUSE_TIMER_COMMAND_COALESCING */
 
 	/* Send a message to the timer service task to perform a particular action
 	on a particular timer definition. */
-	if( xTimerQueue != NULL )
+	if( pxService->xTimerQueue != NULL )
 	{
 		/* Send a command to the timer service task to start the xTimer timer. */
 		xMessage.xMessageID = xCommandID;
@@ -396,18 +719,75 @@ DaemonTaskMessage_t xMessage;
 
 		if( xCommandID < tmrFIRST_FROM_ISR_COMMAND )
 		{
+			#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+			{
+				/* Number the command and note it is on its way into the queue.
+				This is done before posting so the daemon can never receive a
+				command that is not yet accounted for. */
+				tmrENTER_CRITICAL( pxService );
+				{
+					xMessage.u.xTimerParameters.uxSequence = pxTimer->uxNextSequence++;
+					pxTimer->uxPendingCommands++;
+				}
+				tmrEXIT_CRITICAL( pxService );
+			}
+			#endif
+
+			#if( configGENERATE_TIMER_COMMAND_STATS == 1 )
+			{
+				xMessage.xTimeSent = xTaskGetTickCount();
+			}
+			#endif
+
 			if( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING )
 			{
-				xReturn = xQueueSendToBack( xTimerQueue, &xMessage, xTicksToWait );
+				xReturn = xQueueSendToBack( pxService->xTimerQueue, &xMessage, xTicksToWait );
 			}
 			else
 			{
-				xReturn = xQueueSendToBack( xTimerQueue, &xMessage, tmrNO_DELAY );
+				xReturn = xQueueSendToBack( pxService->xTimerQueue, &xMessage, tmrNO_DELAY );
 			}
+
+			#if( ( configUSE_TIMER_COMMAND_COALESCING == 1 ) || ( configGENERATE_TIMER_COMMAND_STATS == 1 ) )
+			{
+				tmrENTER_CRITICAL( pxService );
+				{
+					prvCommandPosted( pxService, pxTimer, &xMessage, xReturn );
+				}
+				tmrEXIT_CRITICAL( pxService );
+			}
+			#endif
 		}
 		else
 		{
-			xReturn = xQueueSendToBackFromISR( xTimerQueue, &xMessage, pxHigherPriorityTaskWoken );
+			#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+			{
+				uxSavedInterruptStatus = tmrENTER_CRITICAL_FROM_ISR( pxService );
+				{
+					xMessage.u.xTimerParameters.uxSequence = pxTimer->uxNextSequence++;
+					pxTimer->uxPendingCommands++;
+				}
+				tmrEXIT_CRITICAL_FROM_ISR( pxService, uxSavedInterruptStatus );
+			}
+			#endif
+
+			#if( configGENERATE_TIMER_COMMAND_STATS == 1 )
+			{
+				xMessage.xTimeSent = xTaskGetTickCountFromISR();
+			}
+			#endif
+
+			xReturn = xQueueSendToBackFromISR( pxService->xTimerQueue, &xMessage, pxHigherPriorityTaskWoken );
+
+			#if( ( configUSE_TIMER_COMMAND_COALESCING == 1 ) || ( configGENERATE_TIMER_COMMAND_STATS == 1 ) )
+			{
+				uxSavedInterruptStatus = tmrENTER_CRITICAL_FROM_ISR( pxService );
+				{
+					prvCommandPosted( pxService, pxTimer, &xMessage, xReturn );
+				}
+				tmrEXIT_CRITICAL_FROM_ISR( pxService, uxSavedInterruptStatus );
+			}
+			#endif
 		}
 
 		traceTIMER_COMMAND_SEND( xTimer, xCommandID, xOptionalValue, xReturn );
@@ -417,16 +797,128 @@ DaemonTaskMessage_t xMessage;
 		mtCOVERAGE_TEST_MARKER();
 	}
 
+	#if( ( configUSE_TIMER_COMMAND_COALESCING == 1 ) || ( configGENERATE_TIMER_COMMAND_STATS == 1 ) )
+	{
+		( void ) uxSavedInterruptStatus;
+	}
+	#endif
+
 	return xReturn;
 }
 /*-----------------------------------------------------------*/
 
+#if( ( configUSE_TIMER_COMMAND_COALESCING == 1 ) || ( configGENERATE_TIMER_COMMAND_STATS == 1 ) )
+
+	static void prvCommandPosted( TimerService_t * const pxService, Timer_t * const pxTimer, const DaemonTaskMessage_t * const pxMessage, const BaseType_t xPostResult )
+	{
+		/* Called from within a critical section. */
+		if( xPostResult != pdFAIL )
+		{
+			#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+			{
+				/* Publish the sequence number so any older start, reset or
+				stop command still queued for this timer is recognised as
+				superseded when the daemon reaches it.  A posted delete is
+				left alone: a higher priority daemon can have received it
+				and freed the timer already, and nothing queued ahead of a
+				delete needs dropping. */
+				if( pxMessage->xMessageID == tmrCOMMAND_DELETE )
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+				else if( tmrSEQUENCE_IS_NEWER( pxMessage->u.xTimerParameters.uxSequence, pxTimer->uxPostedSequence ) )
+				{
+					pxTimer->uxPostedSequence = pxMessage->u.xTimerParameters.uxSequence;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			#endif
+		}
+		else
+		{
+			/* The queue was full - the command never made it in, so the
+			timer still exists even if it was a delete. */
+			#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+			{
+				pxTimer->uxPendingCommands--;
+			}
+			#endif
+
+			#if( configGENERATE_TIMER_COMMAND_STATS == 1 )
+			{
+				pxService->xCommandStats.uxCommandsFailed++;
+			}
+			#endif
+		}
+
+		( void ) pxService;
+		( void ) pxTimer;
+		( void ) pxMessage;
+	}
+
+#endif /* configUSE_TIMER_COMMAND_COALESCING || configGENERATE_TIMER_COMMAND_STATS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+
+	static BaseType_t prvCanProcessCommandDirectly( const Timer_t * const pxTimer, const BaseType_t xCommandID )
+	{
+	BaseType_t xReturn = pdFALSE;
+	const TimerService_t * const pxService = tmrTIMER_SERVICE( pxTimer );
+
+		/* Only start, reset, stop and change period are applied directly.
+		Deleting a timer from its own callback must still be deferred, and
+		tmrCOMMAND_START_DONT_TRACE is only ever sent when the lists cannot be
+		touched. */
+		switch( xCommandID )
+		{
+			case tmrCOMMAND_START :
+			case tmrCOMMAND_RESET :
+			case tmrCOMMAND_STOP :
+			case tmrCOMMAND_CHANGE_PERIOD :
+				if( ( pxService->xTimerTaskHandle != NULL ) &&
+					( pxService->xSwitchingTimerLists == pdFALSE ) &&
+					( xTaskGetCurrentTaskHandle() == pxService->xTimerTaskHandle ) )
+				{
+					/* Only the timer's own service task can reach this point,
+					and it is the only task that decrements uxPendingCommands, so
+					the count can only grow while it is being read here.  A
+					non-zero count means an older command is still queued and
+					this one must queue behind it. */
+					if( pxTimer->uxPendingCommands == ( UBaseType_t ) 0U )
+					{
+						xReturn = pdTRUE;
+					}
+				}
+				break;
+
+			default :
+				break;
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TIMER_COMMAND_COALESCING */
+/*-----------------------------------------------------------*/
+
 TaskHandle_t xTimerGetTimerDaemonTaskHandle( void )
 {
-	/* If xTimerGetTimerDaemonTaskHandle() is called before the scheduler has been
+	return xTimerGetServiceTaskHandle( tmrDEFAULT_TIMER_SERVICE );
+}
+/*-----------------------------------------------------------*/
+
+TaskHandle_t xTimerGetServiceTaskHandle( UBaseType_t uxService )
+{
+	configASSERT( ( uxService < ( UBaseType_t ) configTIMER_SERVICE_COUNT ) );
+
+	/* If xTimerGetServiceTaskHandle() is called before the scheduler has been
 	started, then xTimerTaskHandle will be NULL. */
-	configASSERT( ( xTimerTaskHandle != NULL ) );
-	return xTimerTaskHandle;
+	configASSERT( ( xTimerServices[ uxService ].xTimerTaskHandle != NULL ) );
+	return xTimerServices[ uxService ].xTimerTaskHandle;
 }
 /*-----------------------------------------------------------*/
 
@@ -444,7 +936,7 @@ void vTimerSetReloadMode( TimerHandle_t xTimer, const UBaseType_t uxAutoReload )
 Timer_t * pxTimer =  xTimer;
 
 	configASSERT( xTimer );
-	taskENTER_CRITICAL();
+	tmrENTER_CRITICAL( tmrTIMER_SERVICE( pxTimer ) );
 	{
 		if( uxAutoReload != pdFALSE )
 		{
@@ -455,7 +947,7 @@ Timer_t * pxTimer =  xTimer;
 			pxTimer->ucStatus &= ~tmrSTATUS_IS_AUTORELOAD;
 		}
 	}
-	taskEXIT_CRITICAL();
+	tmrEXIT_CRITICAL( tmrTIMER_SERVICE( pxTimer ) );
 }
 /*-----------------------------------------------------------*/
 
@@ -465,7 +957,7 @@ Timer_t * pxTimer =  xTimer;
 UBaseType_t uxReturn;
 
 	configASSERT( xTimer );
-	taskENTER_CRITICAL();
+	tmrENTER_CRITICAL( tmrTIMER_SERVICE( pxTimer ) );
 	{
 		if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) == 0 )
 		{
@@ -478,7 +970,7 @@ UBaseType_t uxReturn;
 			uxReturn = ( UBaseType_t ) pdTRUE;
 		}
 	}
-	taskEXIT_CRITICAL();
+	tmrEXIT_CRITICAL( tmrTIMER_SERVICE( pxTimer ) );
 
 	return uxReturn;
 }
@@ -504,10 +996,10 @@ Timer_t *pxTimer = xTimer;
 }
 /*-----------------------------------------------------------*/
 
-static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow )
+static void prvProcessExpiredTimer( TimerService_t * const pxService, const TickType_t xNextExpireTime, const TickType_t xTimeNow )
 {
 BaseType_t xResult;
-Timer_t * const pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+Timer_t * const pxTimer = listGET_OWNER_OF_HEAD_ENTRY_OF_TYPE( pxService->pxCurrentTimerList, Timer_t, xTimerListItem ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
 
 	/* Remove the timer from the list of active timers.  A check has already
 	been performed to ensure the list is not empty. */
@@ -541,17 +1033,75 @@ Timer_t * const pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTi
 	}
 
 	/* Call the timer callback. */
+	prvCallTimerCallback( pxTimer, xNextExpireTime );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCallTimerCallback( Timer_t * const pxTimer, const TickType_t xExpiryTime )
+{
+	#if( configGENERATE_TIMER_COMMAND_STATS == 1 )
+	{
+	TimerService_t * const pxService = tmrTIMER_SERVICE( pxTimer );
+	TickType_t xLatency;
+
+		/* How long after its expiry time the callback runs.  This includes
+		any slack, and the time spent in callbacks ahead of this one on the
+		same service. */
+		xLatency = xTaskGetTickCount() - xExpiryTime;
+		if( xLatency > pxService->xCommandStats.xMaxDispatchLatency )
+		{
+			pxService->xCommandStats.xMaxDispatchLatency = xLatency;
+		}
+		pxService->xCommandStats.xTotalDispatchLatency += xLatency;
+		pxService->xCommandStats.uxCallbacksDispatched++;
+	}
+	#else
+	{
+		( void ) xExpiryTime;
+	}
+	#endif /* configGENERATE_TIMER_COMMAND_STATS */
+
 	pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_SLACK == 1 )
+
+	static void prvProcessExpiredTimerBatch( TimerService_t * const pxService, TickType_t xTimeNow )
+	{
+	TickType_t xNextExpireTime;
+	BaseType_t xTimerListsWereSwitched;
+
+		for( ;; )
+		{
+			/* The caller has checked the head timer is due. */
+			xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxService->pxCurrentTimerList );
+			prvProcessExpiredTimer( pxService, xNextExpireTime, xTimeNow );
+
+			if( listLIST_IS_EMPTY( pxService->pxCurrentTimerList ) != pdFALSE )
+			{
+				break;
+			}
+
+			/* Callbacks take time, so check the clock again.  If the tick
+			count overflowed the remaining timers were processed when the lists
+			were switched. */
+			xTimeNow = prvSampleTimeNow( pxService, &xTimerListsWereSwitched );
+			if( ( xTimerListsWereSwitched != pdFALSE ) || ( listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxService->pxCurrentTimerList ) > xTimeNow ) )
+			{
+				break;
+			}
+		}
+	}
+
+#endif /* configUSE_TIMER_SLACK */
+/*-----------------------------------------------------------*/
+
 static portTASK_FUNCTION( prvTimerTask, pvParameters )
 {
 TickType_t xNextExpireTime;
 BaseType_t xListWasEmpty;
-
-	/* Just to avoid compiler warnings. */
-	( void ) pvParameters;
+TimerService_t * const pxService = ( TimerService_t * ) pvParameters;
 
 	#if( configUSE_DAEMON_TASK_STARTUP_HOOK == 1 )
 	{
@@ -560,8 +1110,12 @@ BaseType_t xListWasEmpty;
 		/* Allow the application writer to execute some code in the context of
 		this task at the point the task starts executing.  This is useful if the
 		application includes initialisation code that would benefit from
-		executing after the scheduler has been started. */
-		vApplicationDaemonTaskStartupHook();
+		executing after the scheduler has been started.  Only the default
+		timer service runs the hook. */
+		if( pxService == &( xTimerServices[ tmrDEFAULT_TIMER_SERVICE ] ) )
+		{
+			vApplicationDaemonTaskStartupHook();
+		}
 	}
 	#endif /* configUSE_DAEMON_TASK_STARTUP_HOOK */
 
@@ -569,19 +1123,19 @@ BaseType_t xListWasEmpty;
 	{
 		/* Query the timers list to see if it contains any timers, and if so,
 		obtain the time at which the next timer will expire. */
-		xNextExpireTime = prvGetNextExpireTime( &xListWasEmpty );
+		xNextExpireTime = prvGetNextExpireTime( pxService, &xListWasEmpty );
 
 		/* If a timer has expired, process it.  Otherwise, block this task
 		until either a timer does expire, or a command is received. */
-		prvProcessTimerOrBlockTask( xNextExpireTime, xListWasEmpty );
+		prvProcessTimerOrBlockTask( pxService, xNextExpireTime, xListWasEmpty );
 
 		/* Empty the command queue. */
-		prvProcessReceivedCommands();
+		prvProcessReceivedCommands( pxService );
 	}
 }
 /*-----------------------------------------------------------*/
 
-static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime, BaseType_t xListWasEmpty )
+static void prvProcessTimerOrBlockTask( TimerService_t * const pxService, const TickType_t xNextExpireTime, BaseType_t xListWasEmpty )
 {
 TickType_t xTimeNow;
 BaseType_t xTimerListsWereSwitched;
@@ -593,14 +1147,25 @@ BaseType_t xTimerListsWereSwitched;
 		then don't process this timer as any timers that remained in the list
 		when the lists were switched will have been processed within the
 		prvSampleTimeNow() function. */
-		xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
+		xTimeNow = prvSampleTimeNow( pxService, &xTimerListsWereSwitched );
 		if( xTimerListsWereSwitched == pdFALSE )
 		{
 			/* The tick count has not overflowed, has the timer expired? */
 			if( ( xListWasEmpty == pdFALSE ) && ( xNextExpireTime <= xTimeNow ) )
 			{
 				( void ) xTaskResumeAll();
-				prvProcessExpiredTimer( xNextExpireTime, xTimeNow );
+
+				#if( configUSE_TIMER_SLACK == 1 )
+				{
+					/* xNextExpireTime includes slack so is not the expiry
+					time of any one timer. */
+					prvProcessExpiredTimerBatch( pxService, xTimeNow );
+				}
+				#else
+				{
+					prvProcessExpiredTimer( pxService, xNextExpireTime, xTimeNow );
+				}
+				#endif
 			}
 			else
 			{
@@ -614,10 +1179,10 @@ BaseType_t xTimerListsWereSwitched;
 				{
 					/* The current timer list is empty - is the overflow list
 					also empty? */
-					xListWasEmpty = listLIST_IS_EMPTY( pxOverflowTimerList );
+					xListWasEmpty = listLIST_IS_EMPTY( pxService->pxOverflowTimerList );
 				}
 
-				vQueueWaitForMessageRestricted( xTimerQueue, ( xNextExpireTime - xTimeNow ), xListWasEmpty );
+				vQueueWaitForMessageRestricted( pxService->xTimerQueue, ( xNextExpireTime - xTimeNow ), xListWasEmpty );
 
 				if( xTaskResumeAll() == pdFALSE )
 				{
@@ -631,6 +1196,12 @@ BaseType_t xTimerListsWereSwitched;
 				{
 					mtCOVERAGE_TEST_MARKER();
 				}
+
+				#if( configGENERATE_TIMER_COMMAND_STATS == 1 )
+				{
+					pxService->xCommandStats.uxServiceTaskWakeUps++;
+				}
+				#endif
 			}
 		}
 		else
@@ -641,7 +1212,7 @@ BaseType_t xTimerListsWereSwitched;
 }
 /*-----------------------------------------------------------*/
 
-static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty )
+static TickType_t prvGetNextExpireTime( TimerService_t * const pxService, BaseType_t * const pxListWasEmpty )
 {
 TickType_t xNextExpireTime;
 
@@ -652,10 +1223,47 @@ TickType_t xNextExpireTime;
 	this task to unblock when the tick count overflows, at which point the
 	timer lists will be switched and the next expiry time can be
 	re-assessed.  */
-	*pxListWasEmpty = listLIST_IS_EMPTY( pxCurrentTimerList );
+	*pxListWasEmpty = listLIST_IS_EMPTY( pxService->pxCurrentTimerList );
 	if( *pxListWasEmpty == pdFALSE )
 	{
-		xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
+		#if( configUSE_TIMER_SLACK == 1 )
+		{
+		const ListItem_t *pxItem;
+		const ListItem_t * const pxEnd = listGET_END_MARKER( pxService->pxCurrentTimerList );
+		TickType_t xExpiry, xLatest;
+
+			/* Each timer may be processed anywhere between its expiry time
+			and its expiry time plus slack.  The task must wake by the
+			earliest of those latest times.  Timers that expire after that
+			point cannot lower it, so the scan stops there. */
+			xNextExpireTime = portMAX_DELAY;
+			for( pxItem = listGET_HEAD_ENTRY( pxService->pxCurrentTimerList ); pxItem != pxEnd; pxItem = listGET_NEXT( pxItem ) )
+			{
+				xExpiry = listGET_LIST_ITEM_VALUE( pxItem );
+				if( xExpiry >= xNextExpireTime )
+				{
+					break;
+				}
+
+				xLatest = xExpiry + listGET_LIST_ITEM_OWNER_OF_TYPE( pxItem, Timer_t, xTimerListItem )->xSlackInTicks;
+				if( xLatest < xExpiry )
+				{
+					/* Slack would carry the time past the tick count overflow,
+					and the lists are switched at that point anyway. */
+					xLatest = portMAX_DELAY;
+				}
+
+				if( xLatest < xNextExpireTime )
+				{
+					xNextExpireTime = xLatest;
+				}
+			}
+		}
+		#else
+		{
+			xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxService->pxCurrentTimerList );
+		}
+		#endif /* configUSE_TIMER_SLACK */
 	}
 	else
 	{
@@ -667,16 +1275,15 @@ TickType_t xNextExpireTime;
 }
 /*-----------------------------------------------------------*/
 
-static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched )
+static TickType_t prvSampleTimeNow( TimerService_t * const pxService, BaseType_t * const pxTimerListsWereSwitched )
 {
 TickType_t xTimeNow;
-PRIVILEGED_DATA static TickType_t xLastTime = ( TickType_t ) 0U; /*lint !e956 Variable is only accessible to one task. */
 
 	xTimeNow = xTaskGetTickCount();
 
-	if( xTimeNow < xLastTime )
+	if( xTimeNow < pxService->xLastTime )
 	{
-		prvSwitchTimerLists();
+		prvSwitchTimerLists( pxService );
 		*pxTimerListsWereSwitched = pdTRUE;
 	}
 	else
@@ -684,7 +1291,7 @@ PRIVILEGED_DATA static TickType_t xLastTime = ( TickType_t ) 0U; /*lint !e956 Va
 		*pxTimerListsWereSwitched = pdFALSE;
 	}
 
-	xLastTime = xTimeNow;
+	pxService->xLastTime = xTimeNow;
 
 	return xTimeNow;
 }
@@ -693,6 +1300,7 @@ PRIVILEGED_DATA static TickType_t xLastTime = ( TickType_t ) 0U; /*lint !e956 Va
 static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime )
 {
 BaseType_t xProcessTimerNow = pdFALSE;
+TimerService_t * const pxService = tmrTIMER_SERVICE( pxTimer );
 
 	listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xNextExpiryTime );
 	listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
@@ -709,7 +1317,7 @@ BaseType_t xProcessTimerNow = pdFALSE;
 		}
 		else
 		{
-			vListInsert( pxOverflowTimerList, &( pxTimer->xTimerListItem ) );
+			vListInsert( pxService->pxOverflowTimerList, &( pxTimer->xTimerListItem ) );
 		}
 	}
 	else
@@ -723,7 +1331,7 @@ BaseType_t xProcessTimerNow = pdFALSE;
 		}
 		else
 		{
-			vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+			vListInsert( pxService->pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
 		}
 	}
 
@@ -731,15 +1339,38 @@ BaseType_t xProcessTimerNow = pdFALSE;
 }
 /*-----------------------------------------------------------*/
 
-static void	prvProcessReceivedCommands( void )
+static void	prvProcessReceivedCommands( TimerService_t * const pxService )
 {
 DaemonTaskMessage_t xMessage;
 Timer_t *pxTimer;
-BaseType_t xTimerListsWereSwitched, xResult;
-TickType_t xTimeNow;
+#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+	BaseType_t xSuperseded;
+#endif
 
-	while( xQueueReceive( xTimerQueue, &xMessage, tmrNO_DELAY ) != pdFAIL ) /*lint !e603 xMessage does not have to be initialised as it is passed out, not in, and it is not used unless xQueueReceive() returns pdTRUE. */
+	while( xQueueReceive( pxService->xTimerQueue, &xMessage, tmrNO_DELAY ) != pdFAIL ) /*lint !e603 xMessage does not have to be initialised as it is passed out, not in, and it is not used unless xQueueReceive() returns pdTRUE. */
 	{
+		#if( configGENERATE_TIMER_COMMAND_STATS == 1 )
+		{
+			TickType_t xLatency;
+			UBaseType_t uxDepth;
+
+			/* The message just received plus those still behind it. */
+			uxDepth = uxQueueMessagesWaiting( pxService->xTimerQueue ) + ( UBaseType_t ) 1U;
+			if( uxDepth > pxService->xCommandStats.uxQueueHighWaterMark )
+			{
+				pxService->xCommandStats.uxQueueHighWaterMark = uxDepth;
+			}
+
+			xLatency = xTaskGetTickCount() - xMessage.xTimeSent;
+			if( xLatency > pxService->xCommandStats.xMaxLatency )
+			{
+				pxService->xCommandStats.xMaxLatency = xLatency;
+			}
+			pxService->xCommandStats.xTotalLatency += xLatency;
+			pxService->xCommandStats.uxCommandsReceived++;
+		}
+		#endif /* configGENERATE_TIMER_COMMAND_STATS */
+
 		#if ( INCLUDE_xTimerPendFunctionCall == 1 )
 		{
 			/* Negative commands are pended function calls rather than timer
@@ -770,139 +1401,198 @@ TickType_t xTimeNow;
 			software timer. */
 			pxTimer = xMessage.u.xTimerParameters.pxTimer;
 
-			if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) == pdFALSE ) /*lint !e961. The cast is only redundant when NULL is passed into the macro. */
+			#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
 			{
-				/* The timer is in a list, remove it. */
-				( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
-			}
-			else
-			{
-				mtCOVERAGE_TEST_MARKER();
-			}
+				xSuperseded = pdFALSE;
 
-			traceTIMER_COMMAND_RECEIVED( pxTimer, xMessage.xMessageID, xMessage.u.xTimerParameters.xMessageValue );
-
-			/* In this case the xTimerListsWereSwitched parameter is not used, but
-			it must be present in the function call.  prvSampleTimeNow() must be
-			called after the message is received from xTimerQueue so there is no
-			possibility of a higher priority task adding a message to the message
-			queue with a time that is ahead of the timer daemon task (because it
-			pre-empted the timer daemon task after the xTimeNow value was set). */
-			xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
-
-			switch( xMessage.xMessageID )
-			{
-				case tmrCOMMAND_START :
-				case tmrCOMMAND_START_FROM_ISR :
-				case tmrCOMMAND_RESET :
-				case tmrCOMMAND_RESET_FROM_ISR :
-				case tmrCOMMAND_START_DONT_TRACE :
-					/* Start or restart a timer. */
-					pxTimer->ucStatus |= tmrSTATUS_IS_ACTIVE;
-					if( prvInsertTimerInActiveList( pxTimer,  xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow, xMessage.u.xTimerParameters.xMessageValue ) != pdFALSE )
+				tmrENTER_CRITICAL( pxService );
+				{
+					pxTimer->uxPendingCommands--;
+
+					/* A start, reset or stop only sets the time the timer
+					next expires, so if a newer command for the same timer
+					has already been posted this one would be overwritten
+					anyway.  Changing the period and deleting have lasting
+					effects so are never dropped. */
+					switch( xMessage.xMessageID )
 					{
-						/* The timer expired before it was added to the active
-						timer list.  Process it now. */
-						pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
-						traceTIMER_EXPIRED( pxTimer );
-
-						if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
-						{
-							xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, NULL, tmrNO_DELAY );
-							configASSERT( xResult );
-							( void ) xResult;
-						}
-						else
-						{
-							mtCOVERAGE_TEST_MARKER();
-						}
+						case tmrCOMMAND_START :
+						case tmrCOMMAND_START_FROM_ISR :
+						case tmrCOMMAND_RESET :
+						case tmrCOMMAND_RESET_FROM_ISR :
+						case tmrCOMMAND_STOP :
+						case tmrCOMMAND_STOP_FROM_ISR :
+							xSuperseded = tmrSEQUENCE_IS_NEWER( pxTimer->uxPostedSequence, xMessage.u.xTimerParameters.uxSequence );
+							break;
+
+						default :
+							break;
 					}
-					else
+				}
+				tmrEXIT_CRITICAL( pxService );
+
+				if( xSuperseded != pdFALSE )
+				{
+					#if( configGENERATE_TIMER_COMMAND_STATS == 1 )
 					{
-						mtCOVERAGE_TEST_MARKER();
+						pxService->xCommandStats.uxCommandsCoalesced++;
 					}
-					break;
+					#endif
 
-				case tmrCOMMAND_STOP :
-				case tmrCOMMAND_STOP_FROM_ISR :
-					/* The timer has already been removed from the active list. */
-					pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
-					break;
+					continue;
+				}
+			}
+			#endif /* configUSE_TIMER_COMMAND_COALESCING */
 
-				case tmrCOMMAND_CHANGE_PERIOD :
-				case tmrCOMMAND_CHANGE_PERIOD_FROM_ISR :
-					pxTimer->ucStatus |= tmrSTATUS_IS_ACTIVE;
-					pxTimer->xTimerPeriodInTicks = xMessage.u.xTimerParameters.xMessageValue;
-					configASSERT( ( pxTimer->xTimerPeriodInTicks > 0 ) );
-
-					/* The new period does not really have a reference, and can
-					be longer or shorter than the old one.  The command time is
-					therefore set to the current time, and as the period cannot
-					be zero the next expiry time can only be in the future,
-					meaning (unlike for the xTimerStart() case above) there is
-					no fail case that needs to be handled here. */
-					( void ) prvInsertTimerInActiveList( pxTimer, ( xTimeNow + pxTimer->xTimerPeriodInTicks ), xTimeNow, xTimeNow );
-					break;
+			prvProcessTimerCommand( pxTimer, xMessage.xMessageID, xMessage.u.xTimerParameters.xMessageValue );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
 
-				case tmrCOMMAND_DELETE :
-					#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
-					{
-						/* The timer has already been removed from the active list,
-						just free up the memory if the memory was dynamically
-						allocated. */
-						if( ( pxTimer->ucStatus & tmrSTATUS_IS_STATICALLY_ALLOCATED ) == ( uint8_t ) 0 )
-						{
-							vPortFree( pxTimer );
-						}
-						else
-						{
-							pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
-						}
-					}
-					#else
-					{
-						/* If dynamic allocation is not enabled, the memory
-						could not have been dynamically allocated. So there is
-						no need to free the memory - just mark the timer as
-						"not active". */
-						pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
-					}
-					#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
-					break;
+static void prvProcessTimerCommand( Timer_t * const pxTimer, const BaseType_t xCommandID, const TickType_t xMessageValue )
+{
+BaseType_t xTimerListsWereSwitched, xResult;
+TickType_t xTimeNow;
+TimerService_t * const pxService = tmrTIMER_SERVICE( pxTimer );
 
-				default	:
-					/* Don't expect to get here. */
-					break;
+	if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) == pdFALSE ) /*lint !e961. The cast is only redundant when NULL is passed into the macro. */
+	{
+		/* The timer is in a list, remove it. */
+		( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	traceTIMER_COMMAND_RECEIVED( pxTimer, xCommandID, xMessageValue );
+
+	/* In this case the xTimerListsWereSwitched parameter is not used, but
+	it must be present in the function call.  prvSampleTimeNow() must be
+	called after the message is received from xTimerQueue so there is no
+	possibility of a higher priority task adding a message to the message
+	queue with a time that is ahead of the timer daemon task (because it
+	pre-empted the timer daemon task after the xTimeNow value was set). */
+	xTimeNow = prvSampleTimeNow( pxService, &xTimerListsWereSwitched );
+
+	switch( xCommandID )
+	{
+		case tmrCOMMAND_START :
+		case tmrCOMMAND_START_FROM_ISR :
+		case tmrCOMMAND_RESET :
+		case tmrCOMMAND_RESET_FROM_ISR :
+		case tmrCOMMAND_START_DONT_TRACE :
+			/* Start or restart a timer. */
+			pxTimer->ucStatus |= tmrSTATUS_IS_ACTIVE;
+			if( prvInsertTimerInActiveList( pxTimer,  xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow, xMessageValue ) != pdFALSE )
+			{
+				/* The timer expired before it was added to the active
+				timer list.  Process it now. */
+				prvCallTimerCallback( pxTimer, xMessageValue + pxTimer->xTimerPeriodInTicks );
+				traceTIMER_EXPIRED( pxTimer );
+
+				if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
+				{
+					xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, xMessageValue + pxTimer->xTimerPeriodInTicks, NULL, tmrNO_DELAY );
+					configASSERT( xResult );
+					( void ) xResult;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
 			}
-		}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+			break;
+
+		case tmrCOMMAND_STOP :
+		case tmrCOMMAND_STOP_FROM_ISR :
+			/* The timer has already been removed from the active list. */
+			pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
+			break;
+
+		case tmrCOMMAND_CHANGE_PERIOD :
+		case tmrCOMMAND_CHANGE_PERIOD_FROM_ISR :
+			pxTimer->ucStatus |= tmrSTATUS_IS_ACTIVE;
+			pxTimer->xTimerPeriodInTicks = xMessageValue;
+			configASSERT( ( pxTimer->xTimerPeriodInTicks > 0 ) );
+
+			/* The new period does not really have a reference, and can
+			be longer or shorter than the old one.  The command time is
+			therefore set to the current time, and as the period cannot
+			be zero the next expiry time can only be in the future,
+			meaning (unlike for the xTimerStart() case above) there is
+			no fail case that needs to be handled here. */
+			( void ) prvInsertTimerInActiveList( pxTimer, ( xTimeNow + pxTimer->xTimerPeriodInTicks ), xTimeNow, xTimeNow );
+			break;
+
+		case tmrCOMMAND_DELETE :
+			#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+			{
+				/* The timer has already been removed from the active list,
+				just free up the memory if the memory was dynamically
+				allocated. */
+				if( ( pxTimer->ucStatus & tmrSTATUS_IS_STATICALLY_ALLOCATED ) == ( uint8_t ) 0 )
+				{
+					vPortFree( pxTimer );
+				}
+				else
+				{
+					pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
+				}
+			}
+			#else
+			{
+				/* If dynamic allocation is not enabled, the memory
+				could not have been dynamically allocated. So there is
+				no need to free the memory - just mark the timer as
+				"not active". */
+				pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
+			}
+			#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+			break;
+
+		default	:
+			/* Don't expect to get here. */
+			break;
 	}
 }
 /*-----------------------------------------------------------*/
 
-static void prvSwitchTimerLists( void )
+static void prvSwitchTimerLists( TimerService_t * const pxService )
 {
 TickType_t xNextExpireTime, xReloadTime;
 List_t *pxTemp;
 Timer_t *pxTimer;
 BaseType_t xResult;
 
+	#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+	{
+		pxService->xSwitchingTimerLists = pdTRUE;
+	}
+	#endif
+
 	/* The tick count has overflowed.  The timer lists must be switched.
 	If there are any timers still referenced from the current timer list
 	then they must have expired and should be processed before the lists
 	are switched. */
-	while( listLIST_IS_EMPTY( pxCurrentTimerList ) == pdFALSE )
+	while( listLIST_IS_EMPTY( pxService->pxCurrentTimerList ) == pdFALSE )
 	{
-		xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
+		xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxService->pxCurrentTimerList );
 
 		/* Remove the timer from the list. */
-		pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+		pxTimer = listGET_OWNER_OF_HEAD_ENTRY_OF_TYPE( pxService->pxCurrentTimerList, Timer_t, xTimerListItem ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
 		( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
 		traceTIMER_EXPIRED( pxTimer );
 
 		/* Execute its callback, then send a command to restart the timer if
 		it is an auto-reload timer.  It cannot be restarted here as the lists
 		have not yet been switched. */
-		pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+		prvCallTimerCallback( pxTimer, xNextExpireTime );
 
 		if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
 		{
@@ -917,7 +1607,7 @@ BaseType_t xResult;
 			{
 				listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xReloadTime );
 				listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
-				vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+				vListInsert( pxService->pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
 			}
 			else
 			{
@@ -932,53 +1622,180 @@ BaseType_t xResult;
 		}
 	}
 
-	pxTemp = pxCurrentTimerList;
-	pxCurrentTimerList = pxOverflowTimerList;
-	pxOverflowTimerList = pxTemp;
+	pxTemp = pxService->pxCurrentTimerList;
+	pxService->pxCurrentTimerList = pxService->pxOverflowTimerList;
+	pxService->pxOverflowTimerList = pxTemp;
+
+	#if( configUSE_TIMER_COMMAND_COALESCING == 1 )
+	{
+		pxService->xSwitchingTimerLists = pdFALSE;
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
+#if( configTIMER_SERVICE_COUNT > 1 )
+
+	static void prvTimerServiceName( char * const pcBuffer, const size_t xBufferLength, const char * const pcBaseName, const UBaseType_t uxService ) /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+	{
+	char cDigits[ 4 ]; /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+	size_t xDigits = 0, xLength = 0;
+	UBaseType_t uxValue = uxService;
+
+		/* Room for a space, the digits and the terminator. */
+		configASSERT( xBufferLength >= ( sizeof( cDigits ) + ( size_t ) 2 ) );
+
+		if( uxService != ( UBaseType_t ) 0 )
+		{
+			/* The digits of the service number, least significant first. */
+			do
+			{
+				cDigits[ xDigits ] = ( char ) ( '0' + ( char ) ( uxValue % ( UBaseType_t ) 10 ) ); /*lint !e9021 !e9033 Arithmetic on characters to form a digit. */
+				xDigits++;
+				uxValue /= ( UBaseType_t ) 10;
+			} while( ( uxValue != ( UBaseType_t ) 0 ) && ( xDigits < sizeof( cDigits ) ) );
+
+			/* Leave room for the space, the digits and the terminator. */
+			while( ( pcBaseName[ xLength ] != ( char ) 0x00 ) && ( xLength < ( xBufferLength - xDigits - ( size_t ) 2 ) ) )
+			{
+				pcBuffer[ xLength ] = pcBaseName[ xLength ];
+				xLength++;
+			}
+
+			pcBuffer[ xLength ] = ' ';
+			xLength++;
+
+			while( xDigits > ( size_t ) 0 )
+			{
+				xDigits--;
+				pcBuffer[ xLength ] = cDigits[ xDigits ];
+				xLength++;
+			}
+		}
+		else
+		{
+			while( ( pcBaseName[ xLength ] != ( char ) 0x00 ) && ( xLength < ( xBufferLength - ( size_t ) 1 ) ) )
+			{
+				pcBuffer[ xLength ] = pcBaseName[ xLength ];
+				xLength++;
+			}
+		}
+
+		pcBuffer[ xLength ] = ( char ) 0x00;
+	}
+
+#endif /* configTIMER_SERVICE_COUNT */
+/*-----------------------------------------------------------*/
+
 static void prvCheckForValidListAndQueue( void )
 {
-	/* Check that the list from which active timers are referenced, and the
-	queue used to communicate with the timer service, have been
+UBaseType_t uxService;
+TimerService_t *pxService;
+
+	/* Check that the lists from which active timers are referenced, and the
+	queues used to communicate with the timer services, have been
 	initialised. */
 	taskENTER_CRITICAL();
 	{
-		if( xTimerQueue == NULL )
+		if( xTimerServicesInitialised == pdFALSE )
 		{
-			vListInitialise( &xActiveTimerList1 );
-			vListInitialise( &xActiveTimerList2 );
-			pxCurrentTimerList = &xActiveTimerList1;
-			pxOverflowTimerList = &xActiveTimerList2;
+			xTimerServicesInitialised = pdTRUE;
 
-			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+			for( uxService = 0; uxService < ( UBaseType_t ) configTIMER_SERVICE_COUNT; uxService++ )
 			{
-				/* The timer queue is allocated statically in case
-				configSUPPORT_DYNAMIC_ALLOCATION is 0. */
-				static StaticQueue_t xStaticTimerQueue; /*lint !e956 Ok to declare in this manner to prevent additional conditional compilation guards in other locations. */
-				static uint8_t ucStaticTimerQueueStorage[ ( size_t ) configTIMER_QUEUE_LENGTH * sizeof( DaemonTaskMessage_t ) ]; /*lint !e956 Ok to declare in this manner to prevent additional conditional compilation guards in other locations. */
+				pxService = &( xTimerServices[ uxService ] );
 
-				xTimerQueue = xQueueCreateStatic( ( UBaseType_t ) configTIMER_QUEUE_LENGTH, ( UBaseType_t ) sizeof( DaemonTaskMessage_t ), &( ucStaticTimerQueueStorage[ 0 ] ), &xStaticTimerQueue );
-			}
-			#else
-			{
-				xTimerQueue = xQueueCreate( ( UBaseType_t ) configTIMER_QUEUE_LENGTH, sizeof( DaemonTaskMessage_t ) );
+				/* The lists and lock of a service that has timers in the
+				kernel image are set up already. */
+				if( listLIST_IS_INITIALISED( &( pxService->xActiveTimerList1 ) ) == pdFALSE )
+				{
+					vListInitialise( &( pxService->xActiveTimerList1 ) );
+					vListInitialise( &( pxService->xActiveTimerList2 ) );
+					pxService->pxCurrentTimerList = &( pxService->xActiveTimerList1 );
+					pxService->pxOverflowTimerList = &( pxService->xActiveTimerList2 );
+
+					#if( configUSE_OBJECT_LOCKS == 1 )
+					{
+						portOBJECT_LOCK_INIT( &( pxService->xObjectLock ) );
+					}
+					#endif
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+				{
+					/* The timer queues are allocated statically in case
+					configSUPPORT_DYNAMIC_ALLOCATION is 0. */
+					static StaticQueue_t xStaticTimerQueue[ configTIMER_SERVICE_COUNT ]; /*lint !e956 Ok to declare in this manner to prevent additional conditional compilation guards in other locations. */
+					static uint8_t ucStaticTimerQueueStorage[ configTIMER_SERVICE_COUNT ][ ( size_t ) configTIMER_QUEUE_LENGTH * sizeof( DaemonTaskMessage_t ) ]; /*lint !e956 Ok to declare in this manner to prevent additional conditional compilation guards in other locations. */
+
+					pxService->xTimerQueue = xQueueCreateStatic( ( UBaseType_t ) configTIMER_QUEUE_LENGTH, ( UBaseType_t ) sizeof( DaemonTaskMessage_t ), &( ucStaticTimerQueueStorage[ uxService ][ 0 ] ), &( xStaticTimerQueue[ uxService ] ) );
+				}
+				#else
+				{
+					pxService->xTimerQueue = xQueueCreate( ( UBaseType_t ) configTIMER_QUEUE_LENGTH, sizeof( DaemonTaskMessage_t ) );
+				}
+				#endif
+
+				if( pxService->xTimerQueue == NULL )
+				{
+					xTimerServicesInitialised = pdFALSE;
+					break;
+				}
+
+				#if ( configQUEUE_REGISTRY_SIZE > 0 )
+				{
+					#if( configTIMER_SERVICE_COUNT > 1 )
+					{
+						/* The registry keeps the pointer, so the names
+						need static storage. */
+						static char pcQueueNames[ configTIMER_SERVICE_COUNT ][ configMAX_TASK_NAME_LEN ]; /*lint !e956 !e971 Only written here, inside a critical section, before the queue is registered. */
+
+						prvTimerServiceName( pcQueueNames[ uxService ], sizeof( pcQueueNames[ uxService ] ), "TmrQ", uxService );
+						vQueueAddToRegistry( pxService->xTimerQueue, pcQueueNames[ uxService ] );
+					}
+					#else
+					{
+						vQueueAddToRegistry( pxService->xTimerQueue, "TmrQ" );
+					}
+					#endif
+				}
+				#endif /* configQUEUE_REGISTRY_SIZE */
 			}
-			#endif
 
-			#if ( configQUEUE_REGISTRY_SIZE > 0 )
+			#if( configTIMER_SERVICE_COUNT > 1 )
 			{
-				if( xTimerQueue != NULL )
+				/* If the queue of a later service could not be created, do
+				not keep those of the earlier ones: nothing can use them, and
+				the next call tries again from the start. */
+				if( xTimerServicesInitialised == pdFALSE )
 				{
-					vQueueAddToRegistry( xTimerQueue, "TmrQ" );
+					for( uxService = 0; uxService < ( UBaseType_t ) configTIMER_SERVICE_COUNT; uxService++ )
+					{
+						pxService = &( xTimerServices[ uxService ] );
+
+						if( pxService->xTimerQueue != NULL )
+						{
+							#if ( configQUEUE_REGISTRY_SIZE > 0 )
+							{
+								vQueueUnregisterQueue( pxService->xTimerQueue );
+							}
+							#endif
+
+							vQueueDelete( pxService->xTimerQueue );
+							pxService->xTimerQueue = NULL;
+						}
+					}
 				}
 				else
 				{
 					mtCOVERAGE_TEST_MARKER();
 				}
 			}
-			#endif /* configQUEUE_REGISTRY_SIZE */
+			#endif /* configTIMER_SERVICE_COUNT */
 		}
 		else
 		{
@@ -997,7 +1814,7 @@ Timer_t *pxTimer = xTimer;
 	configASSERT( xTimer );
 
 	/* Is the timer in the list of active timers? */
-	taskENTER_CRITICAL();
+	tmrENTER_CRITICAL( tmrTIMER_SERVICE( pxTimer ) );
 	{
 		if( ( pxTimer->ucStatus & tmrSTATUS_IS_ACTIVE ) == 0 )
 		{
@@ -1008,7 +1825,7 @@ Timer_t *pxTimer = xTimer;
 			xReturn = pdTRUE;
 		}
 	}
-	taskEXIT_CRITICAL();
+	tmrEXIT_CRITICAL( tmrTIMER_SERVICE( pxTimer ) );
 
 	return xReturn;
 } /*lint !e818 Can't be pointer to const due to the typedef. */
@@ -1021,11 +1838,11 @@ void *pvReturn;
 
 	configASSERT( xTimer );
 
-	taskENTER_CRITICAL();
+	tmrENTER_CRITICAL( tmrTIMER_SERVICE( pxTimer ) );
 	{
 		pvReturn = pxTimer->pvTimerID;
 	}
-	taskEXIT_CRITICAL();
+	tmrEXIT_CRITICAL( tmrTIMER_SERVICE( pxTimer ) );
 
 	return pvReturn;
 }
@@ -1037,11 +1854,11 @@ Timer_t * const pxTimer = xTimer;
 
 	configASSERT( xTimer );
 
-	taskENTER_CRITICAL();
+	tmrENTER_CRITICAL( tmrTIMER_SERVICE( pxTimer ) );
 	{
 		pxTimer->pvTimerID = pvNewID;
 	}
-	taskEXIT_CRITICAL();
+	tmrEXIT_CRITICAL( tmrTIMER_SERVICE( pxTimer ) );
 }
 /*-----------------------------------------------------------*/
 
@@ -1059,7 +1876,13 @@ Timer_t * const pxTimer = xTimer;
 		xMessage.u.xCallbackParameters.pvParameter1 = pvParameter1;
 		xMessage.u.xCallbackParameters.ulParameter2 = ulParameter2;
 
-		xReturn = xQueueSendFromISR( xTimerQueue, &xMessage, pxHigherPriorityTaskWoken );
+		#if( configGENERATE_TIMER_COMMAND_STATS == 1 )
+		{
+			xMessage.xTimeSent = xTaskGetTickCountFromISR();
+		}
+		#endif
+
+		xReturn = xQueueSendFromISR( xTimerServices[ tmrDEFAULT_TIMER_SERVICE ].xTimerQueue, &xMessage, pxHigherPriorityTaskWoken );
 
 		tracePEND_FUNC_CALL_FROM_ISR( xFunctionToPend, pvParameter1, ulParameter2, xReturn );
 
@@ -1079,7 +1902,7 @@ Timer_t * const pxTimer = xTimer;
 		/* This function can only be called after a timer has been created or
 		after the scheduler has been started because, until then, the timer
 		queue does not exist. */
-		configASSERT( xTimerQueue );
+		configASSERT( xTimerServices[ tmrDEFAULT_TIMER_SERVICE ].xTimerQueue );
 
 		/* Complete the message with the function parameters and post it to the
 		daemon task. */
@@ -1088,7 +1911,13 @@ Timer_t * const pxTimer = xTimer;
 		xMessage.u.xCallbackParameters.pvParameter1 = pvParameter1;
 		xMessage.u.xCallbackParameters.ulParameter2 = ulParameter2;
 
-		xReturn = xQueueSendToBack( xTimerQueue, &xMessage, xTicksToWait );
+		#if( configGENERATE_TIMER_COMMAND_STATS == 1 )
+		{
+			xMessage.xTimeSent = xTaskGetTickCount();
+		}
+		#endif
+
+		xReturn = xQueueSendToBack( xTimerServices[ tmrDEFAULT_TIMER_SERVICE ].xTimerQueue, &xMessage, xTicksToWait );
 
 		tracePEND_FUNC_CALL( xFunctionToPend, pvParameter1, ulParameter2, xReturn );
 
@@ -1098,6 +1927,92 @@ Timer_t * const pxTimer = xTimer;
 #endif /* INCLUDE_xTimerPendFunctionCall */
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_SLACK == 1 )
+
+	void vTimerSetSlack( TimerHandle_t xTimer, const TickType_t xSlackInTicks )
+	{
+	Timer_t * const pxTimer = xTimer;
+
+		configASSERT( xTimer );
+
+		tmrENTER_CRITICAL( tmrTIMER_SERVICE( pxTimer ) );
+		{
+			pxTimer->xSlackInTicks = xSlackInTicks;
+		}
+		tmrEXIT_CRITICAL( tmrTIMER_SERVICE( pxTimer ) );
+	}
+
+#endif /* configUSE_TIMER_SLACK */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TIMER_SLACK == 1 )
+
+	TickType_t xTimerGetSlack( TimerHandle_t xTimer )
+	{
+	Timer_t * const pxTimer = xTimer;
+	TickType_t xReturn;
+
+		configASSERT( xTimer );
+
+		tmrENTER_CRITICAL( tmrTIMER_SERVICE( pxTimer ) );
+		{
+			xReturn = pxTimer->xSlackInTicks;
+		}
+		tmrEXIT_CRITICAL( tmrTIMER_SERVICE( pxTimer ) );
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TIMER_SLACK */
+/*-----------------------------------------------------------*/
+
+#if( configGENERATE_TIMER_COMMAND_STATS == 1 )
+
+	void vTimerGetCommandStats( TimerCommandStats_t *pxStats )
+	{
+		vTimerGetServiceStats( tmrDEFAULT_TIMER_SERVICE, pxStats );
+	}
+
+#endif /* configGENERATE_TIMER_COMMAND_STATS */
+/*-----------------------------------------------------------*/
+
+#if( configGENERATE_TIMER_COMMAND_STATS == 1 )
+
+	void vTimerGetServiceStats( UBaseType_t uxService, TimerCommandStats_t *pxStats )
+	{
+		configASSERT( pxStats );
+		configASSERT( ( uxService < ( UBaseType_t ) configTIMER_SERVICE_COUNT ) );
+
+		tmrENTER_CRITICAL( &( xTimerServices[ uxService ] ) );
+		{
+			*pxStats = xTimerServices[ uxService ].xCommandStats;
+		}
+		tmrEXIT_CRITICAL( &( xTimerServices[ uxService ] ) );
+	}
+
+#endif /* configGENERATE_TIMER_COMMAND_STATS */
+/*-----------------------------------------------------------*/
+
+#if( configGENERATE_TIMER_COMMAND_STATS == 1 )
+
+	void vTimerClearCommandStats( void )
+	{
+	static const TimerCommandStats_t xZeroStats = { 0 };
+	UBaseType_t uxService;
+
+		for( uxService = 0; uxService < ( UBaseType_t ) configTIMER_SERVICE_COUNT; uxService++ )
+		{
+			tmrENTER_CRITICAL( &( xTimerServices[ uxService ] ) );
+			{
+				xTimerServices[ uxService ].xCommandStats = xZeroStats;
+			}
+			tmrEXIT_CRITICAL( &( xTimerServices[ uxService ] ) );
+		}
+	}
+
+#endif /* configGENERATE_TIMER_COMMAND_STATS */
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_TRACE_FACILITY == 1 )
 
 	UBaseType_t uxTimerGetTimerNumber( TimerHandle_t xTimer )
@@ -0,0 +1,1078 @@
+/*=====================================================================
+ *  kimage - kernel image generator for FreeRTOS
+ *
+ *  Reads a description of the tasks, queues, semaphores, mutexes and
+ *  timers of a system and the project's FreeRTOSConfig.h, and writes
+ *  kernel_image.h.  With configUSE_KERNEL_IMAGE set to 1 the kernel
+ *  includes that header into tasks.c, queue.c and timers.c, where it
+ *  builds every control block, storage area and ready list at compile
+ *  time:
+ *
+ *    - the scheduler starts without creating any object and without
+ *      touching the heap, so boot is shorter,
+ *    - all of the RAM the objects use is known at link time,
+ *    - the application gets a const handle for each object.
+ *
+ *  Exit status: 0 = header written, 2 = input error.
+ *  See README.md for the file format.
+ *=====================================================================*/
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_OBJECTS     128
+#define MAX_INCLUDES    16
+#define NAME_LEN        32
+#define EXPR_LEN        128
+#define LINE_LEN        512
+
+/* -------------------------------------------------------------------
+ * Kernel settings taken from FreeRTOSConfig.h
+ * ------------------------------------------------------------------- */
+typedef struct
+{
+    long tick_rate_hz;          // configTICK_RATE_HZ
+    long max_priorities;        // configMAX_PRIORITIES
+    long max_task_name_len;     // configMAX_TASK_NAME_LEN (defaults to 16)
+    long timer_service_count;   // configTIMER_SERVICE_COUNT (defaults to 1)
+    char path[LINE_LEN];
+} kernel_config_t;
+
+typedef enum
+{
+    OBJ_TASK,
+    OBJ_QUEUE,
+    OBJ_SEMAPHORE,
+    OBJ_MUTEX,
+    OBJ_TIMER
+} object_kind_t;
+
+/* -------------------------------------------------------------------
+ * One object of the image.  Expressions (stack depth, item size,
+ * parameters) are copied into the header as written.
+ * ------------------------------------------------------------------- */
+typedef struct
+{
+    object_kind_t kind;
+    char     name[NAME_LEN];
+    char     handle[NAME_LEN];      // exported handle, empty for none
+    char     function[NAME_LEN];    // task function or timer callback
+    char     param[EXPR_LEN];       // task parameter or timer ID
+    char     stack[EXPR_LEN];       // task stack depth in words
+    char     item[EXPR_LEN];        // queue item size in bytes
+    long     priority;
+    long     length;                // queue length, semaphore maximum count
+    long     initial;               // initial semaphore count
+    int      recursive;
+    uint64_t period;                // timer period in ticks
+    int      autoreload;
+    int      start;                 // timer is active when the scheduler starts
+    long     service;               // timer service that runs the callback
+} object_t;
+
+static kernel_config_t config = { 0, 0, 16, 1, "" };
+static object_t        objects[MAX_OBJECTS];
+static int             object_count = 0;
+static char            includes[MAX_INCLUDES][LINE_LEN];
+static int             include_count = 0;
+static char            idle_stack[EXPR_LEN] = "configMINIMAL_STACK_SIZE";
+static const char     *description_path = "";
+
+/* -------------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------------- */
+static void fail(const char *file, int line, const char *msg, const char *arg)
+{
+    fprintf(stderr, "%s:%d: %s%s%s\n", file, line, msg, arg ? " " : "", arg ? arg : "");
+    exit(2);
+}
+
+static int is_identifier(const char *text)
+{
+    if (!isalpha((unsigned char)*text) && *text != '_')
+    {
+        return 0;
+    }
+    for (; *text != '\0'; text++)
+    {
+        if (!isalnum((unsigned char)*text) && *text != '_')
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void copy_field(char *dest, size_t len, const char *value, const char *path, int line)
+{
+    if (strlen(value) >= len || value[0] == '\0')
+    {
+        fail(path, line, "missing or too long value", value);
+    }
+    strcpy(dest, value);
+}
+
+static long parse_count(const char *value, const char *path, int line)
+{
+    char *end;
+    long n;
+
+    errno = 0;
+    n = strtol(value, &end, 0);
+    if (errno != 0 || end == value || *end != '\0' || n < 0)
+    {
+        fail(path, line, "bad number", value);
+    }
+    return n;
+}
+
+/* Parse "<number><unit>" where unit is ms, s or t/tick/ticks into ticks.
+ * Periods that are not a whole number of ticks are rounded up. */
+static uint64_t parse_period(const char *value, const char *path, int line)
+{
+    char *end;
+    double number, ticks;
+
+    errno = 0;
+    number = strtod(value, &end);
+    if (errno != 0 || end == value || number <= 0.0)
+    {
+        fail(path, line, "bad period", value);
+    }
+
+    if (strcmp(end, "ms") == 0)
+    {
+        ticks = number * (double)config.tick_rate_hz / 1000.0;
+    }
+    else if (strcmp(end, "s") == 0)
+    {
+        ticks = number * (double)config.tick_rate_hz;
+    }
+    else if (strcmp(end, "t") == 0 || strcmp(end, "tick") == 0 || strcmp(end, "ticks") == 0)
+    {
+        ticks = number;
+    }
+    else
+    {
+        fail(path, line, "period needs a unit (ms, s or t):", value);
+        return 0;
+    }
+
+    if (ticks > (double)UINT32_MAX)
+    {
+        fail(path, line, "period too long", value);
+    }
+    return (uint64_t)(ticks + 0.999999);
+}
+
+static int find_object(const char *name)
+{
+    for (int i = 0; i < object_count; i++)
+    {
+        if (strcmp(objects[i].name, name) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* -------------------------------------------------------------------
+ * FreeRTOSConfig.h
+ *
+ * Only plain numeric #defines are needed, e.g.
+ *   #define configTICK_RATE_HZ   ((TickType_t)1000)
+ *   #define configMAX_PRIORITIES ( 7 )
+ * The first decimal number found in the value is used.
+ * ------------------------------------------------------------------- */
+static int config_value(const char *line, const char *macro, long *out)
+{
+    const char *p = line;
+    size_t len = strlen(macro);
+
+    while (isspace((unsigned char)*p))
+    {
+        p++;
+    }
+    if (*p != '#')
+    {
+        return 0;
+    }
+    p++;
+    while (isspace((unsigned char)*p))
+    {
+        p++;
+    }
+    if (strncmp(p, "define", 6) != 0)
+    {
+        return 0;
+    }
+    p += 6;
+    while (isspace((unsigned char)*p))
+    {
+        p++;
+    }
+    if (strncmp(p, macro, len) != 0 || !isspace((unsigned char)p[len]))
+    {
+        return 0;
+    }
+    p += len;
+
+    /* Skip casts such as (TickType_t) before the number. */
+    while (*p != '\0')
+    {
+        if (*p == '(')
+        {
+            const char *close = strchr(p, ')');
+            const char *q = p + 1;
+            while (isspace((unsigned char)*q))
+            {
+                q++;
+            }
+            if (close != NULL && (isalpha((unsigned char)*q) || *q == '_'))
+            {
+                p = close + 1;
+                continue;
+            }
+        }
+        if (isdigit((unsigned char)*p))
+        {
+            *out = strtol(p, NULL, 0);
+            return 1;
+        }
+        if (*p == '/' && (p[1] == '*' || p[1] == '/'))
+        {
+            break;
+        }
+        p++;
+    }
+    return 0;
+}
+
+static void load_config(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[LINE_LEN];
+    long value;
+
+    if (f == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        exit(2);
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        if (config_value(line, "configTICK_RATE_HZ", &value) && value > 0)
+        {
+            config.tick_rate_hz = value;
+        }
+        else if (config_value(line, "configMAX_PRIORITIES", &value) && value > 0)
+        {
+            config.max_priorities = value;
+        }
+        else if (config_value(line, "configMAX_TASK_NAME_LEN", &value) && value > 0)
+        {
+            config.max_task_name_len = value;
+        }
+        else if (config_value(line, "configTIMER_SERVICE_COUNT", &value) && value > 0)
+        {
+            config.timer_service_count = value;
+        }
+    }
+    fclose(f);
+
+    if (config.tick_rate_hz == 0 || config.max_priorities == 0)
+    {
+        fprintf(stderr, "%s: configTICK_RATE_HZ or configMAX_PRIORITIES not found\n", path);
+        exit(2);
+    }
+    snprintf(config.path, sizeof(config.path), "%s", path);
+}
+
+/* -------------------------------------------------------------------
+ * System description
+ *
+ *   include   <header>
+ *   idle      stack=<words>
+ *   task      <name> function=<fn> priority=<n> stack=<words> [param=<expr>] [handle=<id>]
+ *   queue     <name> length=<n> item=<bytes> [handle=<id>]
+ *   semaphore <name> [max=<n>] [initial=<n>] [handle=<id>]
+ *   mutex     <name> [recursive] [handle=<id>]
+ *   timer     <name> period=<time> callback=<fn> [autoreload] [start]
+ *             [id=<expr>] [service=<n>] [handle=<id>]
+ * ------------------------------------------------------------------- */
+static object_t *new_object(object_kind_t kind, const char *name, const char *path, int line)
+{
+    object_t *obj;
+
+    if (name == NULL || strlen(name) >= NAME_LEN || !is_identifier(name))
+    {
+        fail(path, line, "object names must be C identifiers:", name);
+    }
+    if (find_object(name) >= 0)
+    {
+        fail(path, line, "duplicate object name", name);
+    }
+    if (object_count == MAX_OBJECTS)
+    {
+        fail(path, line, "too many objects", NULL);
+    }
+
+    obj = &objects[object_count++];
+    memset(obj, 0, sizeof(*obj));
+    obj->kind = kind;
+    obj->priority = -1;
+    obj->length = -1;
+    strcpy(obj->name, name);
+    strcpy(obj->param, "NULL");
+    return obj;
+}
+
+static void parse_field(object_t *obj, char *field, const char *path, int line)
+{
+    char *value = strchr(field, '=');
+
+    if (value == NULL)
+    {
+        if (obj->kind == OBJ_MUTEX && strcmp(field, "recursive") == 0)
+        {
+            obj->recursive = 1;
+        }
+        else if (obj->kind == OBJ_TIMER && strcmp(field, "autoreload") == 0)
+        {
+            obj->autoreload = 1;
+        }
+        else if (obj->kind == OBJ_TIMER && strcmp(field, "start") == 0)
+        {
+            obj->start = 1;
+        }
+        else
+        {
+            fail(path, line, "unknown flag", field);
+        }
+        return;
+    }
+    *value++ = '\0';
+
+    if (strcmp(field, "handle") == 0)
+    {
+        copy_field(obj->handle, sizeof(obj->handle), value, path, line);
+        if (!is_identifier(value))
+        {
+            fail(path, line, "handles must be C identifiers:", value);
+        }
+    }
+    else if (obj->kind == OBJ_TASK && strcmp(field, "function") == 0)
+    {
+        copy_field(obj->function, sizeof(obj->function), value, path, line);
+    }
+    else if (obj->kind == OBJ_TASK && strcmp(field, "priority") == 0)
+    {
+        obj->priority = parse_count(value, path, line);
+        if (obj->priority >= config.max_priorities)
+        {
+            fail(path, line, "priority must be below configMAX_PRIORITIES:", value);
+        }
+    }
+    else if (obj->kind == OBJ_TASK && strcmp(field, "stack") == 0)
+    {
+        copy_field(obj->stack, sizeof(obj->stack), value, path, line);
+    }
+    else if (obj->kind == OBJ_TASK && strcmp(field, "param") == 0)
+    {
+        copy_field(obj->param, sizeof(obj->param), value, path, line);
+    }
+    else if (obj->kind == OBJ_QUEUE && strcmp(field, "length") == 0)
+    {
+        obj->length = parse_count(value, path, line);
+    }
+    else if (obj->kind == OBJ_QUEUE && strcmp(field, "item") == 0)
+    {
+        copy_field(obj->item, sizeof(obj->item), value, path, line);
+    }
+    else if (obj->kind == OBJ_SEMAPHORE && strcmp(field, "max") == 0)
+    {
+        obj->length = parse_count(value, path, line);
+    }
+    else if (obj->kind == OBJ_SEMAPHORE && strcmp(field, "initial") == 0)
+    {
+        obj->initial = parse_count(value, path, line);
+    }
+    else if (obj->kind == OBJ_TIMER && strcmp(field, "period") == 0)
+    {
+        obj->period = parse_period(value, path, line);
+    }
+    else if (obj->kind == OBJ_TIMER && strcmp(field, "callback") == 0)
+    {
+        copy_field(obj->function, sizeof(obj->function), value, path, line);
+    }
+    else if (obj->kind == OBJ_TIMER && strcmp(field, "id") == 0)
+    {
+        copy_field(obj->param, sizeof(obj->param), value, path, line);
+    }
+    else if (obj->kind == OBJ_TIMER && strcmp(field, "service") == 0)
+    {
+        obj->service = parse_count(value, path, line);
+        if (obj->service >= config.timer_service_count)
+        {
+            fail(path, line, "service must be below configTIMER_SERVICE_COUNT:", value);
+        }
+    }
+    else
+    {
+        fail(path, line, "unknown field", field);
+    }
+}
+
+/* Fill in defaults and check that every required field was given. */
+static void finish_object(object_t *obj, const char *path, int line)
+{
+    switch (obj->kind)
+    {
+    case OBJ_TASK:
+        if (obj->function[0] == '\0' || obj->priority < 0 || obj->stack[0] == '\0')
+        {
+            fail(path, line, "task needs function=, priority= and stack=:", obj->name);
+        }
+        if ((long)strlen(obj->name) >= config.max_task_name_len)
+        {
+            fail(path, line, "task name longer than configMAX_TASK_NAME_LEN - 1:", obj->name);
+        }
+        break;
+
+    case OBJ_QUEUE:
+        if (obj->length < 1 || obj->item[0] == '\0')
+        {
+            fail(path, line, "queue needs length= and item=:", obj->name);
+        }
+        break;
+
+    case OBJ_SEMAPHORE:
+        if (obj->length < 0)
+        {
+            obj->length = 1;
+        }
+        if (obj->length < 1 || obj->initial > obj->length)
+        {
+            fail(path, line, "semaphore needs max >= 1 and initial <= max:", obj->name);
+        }
+        break;
+
+    case OBJ_MUTEX:
+        break;
+
+    case OBJ_TIMER:
+        if (obj->period == 0 || obj->function[0] == '\0')
+        {
+            fail(path, line, "timer needs period= and callback=:", obj->name);
+        }
+        break;
+    }
+}
+
+static void load_description(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[LINE_LEN];
+    int line_no = 0;
+
+    if (f == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        exit(2);
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        char *hash = strchr(line, '#');
+        char *word;
+        char *field;
+        char *save;
+        object_t *obj;
+
+        line_no++;
+        if (hash != NULL)
+        {
+            *hash = '\0';
+        }
+
+        word = strtok_r(line, " \t\r\n", &save);
+        if (word == NULL)
+        {
+            continue;
+        }
+
+        if (strcmp(word, "include") == 0)
+        {
+            char *header = strtok_r(NULL, " \t\r\n\"", &save);
+            if (header == NULL || include_count == MAX_INCLUDES)
+            {
+                fail(path, line_no, "bad or too many include lines", header);
+            }
+            strcpy(includes[include_count++], header);
+            continue;
+        }
+        else if (strcmp(word, "idle") == 0)
+        {
+            field = strtok_r(NULL, " \t\r\n", &save);
+            if (field == NULL || strncmp(field, "stack=", 6) != 0)
+            {
+                fail(path, line_no, "expected idle stack=<words>, got", field);
+            }
+            copy_field(idle_stack, sizeof(idle_stack), field + 6, path, line_no);
+            continue;
+        }
+        else if (strcmp(word, "task") == 0)
+        {
+            obj = new_object(OBJ_TASK, strtok_r(NULL, " \t\r\n", &save), path, line_no);
+        }
+        else if (strcmp(word, "queue") == 0)
+        {
+            obj = new_object(OBJ_QUEUE, strtok_r(NULL, " \t\r\n", &save), path, line_no);
+        }
+        else if (strcmp(word, "semaphore") == 0)
+        {
+            obj = new_object(OBJ_SEMAPHORE, strtok_r(NULL, " \t\r\n", &save), path, line_no);
+        }
+        else if (strcmp(word, "mutex") == 0)
+        {
+            obj = new_object(OBJ_MUTEX, strtok_r(NULL, " \t\r\n", &save), path, line_no);
+        }
+        else if (strcmp(word, "timer") == 0)
+        {
+            obj = new_object(OBJ_TIMER, strtok_r(NULL, " \t\r\n", &save), path, line_no);
+        }
+        else
+        {
+            fail(path, line_no, "unknown directive", word);
+            continue;
+        }
+
+        while ((field = strtok_r(NULL, " \t\r\n", &save)) != NULL)
+        {
+            parse_field(obj, field, path, line_no);
+        }
+        finish_object(obj, path, line_no);
+    }
+    fclose(f);
+}
+
+/* -------------------------------------------------------------------
+ * Output
+ * ------------------------------------------------------------------- */
+/* Tasks in table order: the description order, then the idle task. */
+static int task_order[MAX_OBJECTS + 1];
+static int task_order_count;
+
+#define IDLE_TASK   (-1)
+
+static long task_priority(int index)
+{
+    return index == IDLE_TASK ? 0 : objects[index].priority;
+}
+
+static const char *task_name(int index)
+{
+    return index == IDLE_TASK ? "Idle" : objects[index].name;
+}
+
+/* The state list item of the next (step 1) or previous (step -1) task of
+ * the same priority, or the end of that priority's ready list. */
+static void ready_link(char *buf, size_t len, int position, int step)
+{
+    long prio = task_priority(task_order[position]);
+
+    for (int p = position + step; p >= 0 && p < task_order_count; p += step)
+    {
+        if (task_priority(task_order[p]) == prio)
+        {
+            snprintf(buf, len, "tskIMAGE_STATE_ITEM( xKernelImageTCB_%s )", task_name(task_order[p]));
+            return;
+        }
+    }
+    snprintf(buf, len, "tskIMAGE_READY_LIST_END( %ld )", prio);
+}
+
+static int count_kind(object_kind_t kind)
+{
+    int n = 0;
+
+    for (int i = 0; i < object_count; i++)
+    {
+        n += (objects[i].kind == kind);
+    }
+    return n;
+}
+
+static void write_common(FILE *out)
+{
+    int i;
+
+    fprintf(out, "#ifndef KERNEL_IMAGE_H\n#define KERNEL_IMAGE_H\n\n");
+    fprintf(out, "#include \"FreeRTOS.h\"\n#include \"task.h\"\n#include \"queue.h\"\n"
+                 "#include \"semphr.h\"\n#include \"timers.h\"\n");
+    for (i = 0; i < include_count; i++)
+    {
+        fprintf(out, "#include \"%s\"\n", includes[i]);
+    }
+
+    fprintf(out, "\n#if( configUSE_KERNEL_IMAGE != 1 )\n"
+                 "\t#error Set configUSE_KERNEL_IMAGE to 1 in FreeRTOSConfig.h to use kernel_image.h\n"
+                 "#endif\n\n");
+    fprintf(out, "#if( configMAX_PRIORITIES != %ld )\n"
+                 "\t#error kernel_image.h was generated for configMAX_PRIORITIES %ld, run kimage again\n"
+                 "#endif\n\n", config.max_priorities, config.max_priorities);
+
+    if (count_kind(OBJ_TIMER) > 0)
+    {
+        fprintf(out, "#if( configUSE_TIMERS != 1 )\n"
+                     "\t#error The kernel image has timers, set configUSE_TIMERS to 1\n#endif\n\n");
+    }
+
+    fprintf(out, "/* Handles of the objects in the image. */\n");
+    for (i = 0; i < object_count; i++)
+    {
+        static const char *const handle_type[] =
+        {
+            "TaskHandle_t", "QueueHandle_t", "SemaphoreHandle_t", "SemaphoreHandle_t", "TimerHandle_t"
+        };
+
+        if (objects[i].handle[0] != '\0')
+        {
+            fprintf(out, "extern %s const %s;\n", handle_type[objects[i].kind], objects[i].handle);
+        }
+    }
+
+    fprintf(out, "\n/* Task functions and timer callbacks, provided by the application. */\n");
+    for (i = 0; i < object_count; i++)
+    {
+        if (objects[i].kind == OBJ_TASK)
+        {
+            fprintf(out, "void %s( void *pvParameters );\n", objects[i].function);
+        }
+        else if (objects[i].kind == OBJ_TIMER)
+        {
+            fprintf(out, "void %s( TimerHandle_t xTimer );\n", objects[i].function);
+        }
+    }
+    fprintf(out, "\n#endif /* KERNEL_IMAGE_H */\n");
+}
+
+static void write_tasks(FILE *out)
+{
+    char next[EXPR_LEN], previous[EXPR_LEN];
+    int current = IDLE_TASK;
+    unsigned long ready_mask = 0;
+    long highest = 0;
+    int i, p;
+
+    task_order_count = 0;
+    for (i = 0; i < object_count; i++)
+    {
+        if (objects[i].kind == OBJ_TASK)
+        {
+            task_order[task_order_count++] = i;
+        }
+    }
+    task_order[task_order_count++] = IDLE_TASK;
+
+    fprintf(out, "\n#if defined( KERNEL_IMAGE_TASKS )\n\n");
+
+    /* Every TCB is declared first, as each links to its neighbours. */
+    for (i = 0; i < task_order_count; i++)
+    {
+        fprintf(out, "static TCB_t xKernelImageTCB_%s;\n", task_name(task_order[i]));
+    }
+    fprintf(out, "\n");
+    for (i = 0; i < task_order_count; i++)
+    {
+        fprintf(out, "static StackType_t xKernelImageStack_%s[ %s ];\n", task_name(task_order[i]),
+                task_order[i] == IDLE_TASK ? idle_stack : objects[task_order[i]].stack);
+    }
+    fprintf(out, "\n");
+
+    for (i = 0; i < task_order_count; i++)
+    {
+        long prio = task_priority(task_order[i]);
+
+        ready_link(next, sizeof(next), i, 1);
+        ready_link(previous, sizeof(previous), i, -1);
+        fprintf(out, "static TCB_t xKernelImageTCB_%s = tskIMAGE_TCB( xKernelImageTCB_%s, \"%s\", %ldU, "
+                     "xKernelImageStack_%s, %s, %s, %dU );\n",
+                task_name(task_order[i]), task_name(task_order[i]),
+                task_order[i] == IDLE_TASK ? "IDLE" : task_name(task_order[i]), prio,
+                task_name(task_order[i]), next, previous, i + 1);
+
+        /* As with xTaskCreate(), the last task created at the highest
+         * priority runs first. */
+        ready_mask |= 1UL << prio;
+        if (prio >= highest)
+        {
+            highest = prio;
+            current = task_order[i];
+        }
+    }
+    fprintf(out, "\n");
+
+    for (i = 0; i < object_count; i++)
+    {
+        if (objects[i].kind == OBJ_TASK && objects[i].handle[0] != '\0')
+        {
+            fprintf(out, "TaskHandle_t const %s = &xKernelImageTCB_%s;\n", objects[i].handle, objects[i].name);
+        }
+    }
+
+    fprintf(out, "\nstatic const KernelImageTask_t xKernelImageTasks[] =\n{\n");
+    for (i = 0; i < task_order_count; i++)
+    {
+        if (task_order[i] == IDLE_TASK)
+        {
+            fprintf(out, "\t{ &xKernelImageTCB_Idle, NULL, NULL, ( uint32_t ) ( %s ) }\n", idle_stack);
+        }
+        else
+        {
+            const object_t *task = &objects[task_order[i]];
+            fprintf(out, "\t{ &xKernelImageTCB_%s, %s, ( void * ) ( %s ), ( uint32_t ) ( %s ) },\n",
+                    task->name, task->function, task->param, task->stack);
+        }
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "#define tskIMAGE_NUMBER_OF_TASKS\t%dU\n", task_order_count);
+    fprintf(out, "#define tskIMAGE_CURRENT_TCB\t\t( &xKernelImageTCB_%s )\n", task_name(current));
+    fprintf(out, "#define tskIMAGE_IDLE_TASK\t\t\t( &xKernelImageTCB_Idle )\n");
+    fprintf(out, "#define tskIMAGE_HIGHEST_PRIORITY\t( ( UBaseType_t ) %ldU )\n", highest);
+    fprintf(out, "#define tskIMAGE_READY_PRIORITIES\t( ( UBaseType_t ) 0x%lxUL )\n", ready_mask);
+
+    fprintf(out, "#define tskIMAGE_READY_LISTS\t\\\n{\t\\\n");
+    for (p = 0; p < config.max_priorities; p++)
+    {
+        int first = -1, last = -1, count = 0;
+
+        for (i = 0; i < task_order_count; i++)
+        {
+            if (task_priority(task_order[i]) == p)
+            {
+                if (first < 0)
+                {
+                    first = i;
+                }
+                last = i;
+                count++;
+            }
+        }
+
+        if (count == 0)
+        {
+            fprintf(out, "\tlistSTATIC_EMPTY_LIST( pxReadyTasksLists[ %d ] )", p);
+        }
+        else
+        {
+            fprintf(out, "\tlistSTATIC_LIST( pxReadyTasksLists[ %d ], %dU, tskIMAGE_STATE_ITEM( xKernelImageTCB_%s ), "
+                         "tskIMAGE_STATE_ITEM( xKernelImageTCB_%s ) )",
+                    p, count, task_name(task_order[first]), task_name(task_order[last]));
+        }
+        fprintf(out, "%s\t\\\n", p + 1 < config.max_priorities ? "," : "");
+    }
+    fprintf(out, "}\n");
+}
+
+static void write_queues(FILE *out)
+{
+    int registered = 0;
+    int i;
+
+    fprintf(out, "\n#elif defined( KERNEL_IMAGE_QUEUES )\n\n");
+
+    if (count_kind(OBJ_MUTEX) > 0)
+    {
+        fprintf(out, "#if( configUSE_MUTEXES != 1 )\n"
+                     "\t#error The kernel image has mutexes, set configUSE_MUTEXES to 1\n#endif\n\n");
+    }
+    for (i = 0; i < object_count; i++)
+    {
+        if (objects[i].kind == OBJ_MUTEX && objects[i].recursive)
+        {
+            fprintf(out, "#if( configUSE_RECURSIVE_MUTEXES != 1 )\n"
+                         "\t#error The kernel image has recursive mutexes, set configUSE_RECURSIVE_MUTEXES to 1\n#endif\n\n");
+            break;
+        }
+    }
+
+    for (i = 0; i < object_count; i++)
+    {
+        const object_t *obj = &objects[i];
+
+        switch (obj->kind)
+        {
+        case OBJ_QUEUE:
+            fprintf(out, "static uint8_t ucKernelImageStorage_%s[ ( %ld ) * ( %s ) ];\n",
+                    obj->name, obj->length, obj->item);
+            fprintf(out, "static Queue_t xKernelImageQueue_%s = queueIMAGE_QUEUE( xKernelImageQueue_%s, "
+                         "ucKernelImageStorage_%s, %ldU, ( UBaseType_t ) ( %s ), 0U, queueQUEUE_TYPE_BASE );\n",
+                    obj->name, obj->name, obj->name, obj->length, obj->item);
+            break;
+
+        case OBJ_SEMAPHORE:
+            fprintf(out, "static Queue_t xKernelImageQueue_%s = queueIMAGE_QUEUE( xKernelImageQueue_%s, "
+                         "&xKernelImageQueue_%s, %ldU, 0U, %ldU, %s );\n",
+                    obj->name, obj->name, obj->name, obj->length, obj->initial,
+                    obj->length == 1 ? "queueQUEUE_TYPE_BINARY_SEMAPHORE" : "queueQUEUE_TYPE_COUNTING_SEMAPHORE");
+            break;
+
+        case OBJ_MUTEX:
+            fprintf(out, "static Queue_t xKernelImageQueue_%s = queueIMAGE_MUTEX( xKernelImageQueue_%s, %s );\n",
+                    obj->name, obj->name,
+                    obj->recursive ? "queueQUEUE_TYPE_RECURSIVE_MUTEX" : "queueQUEUE_TYPE_MUTEX");
+            break;
+
+        default:
+            continue;
+        }
+
+        if (obj->handle[0] != '\0')
+        {
+            fprintf(out, "%s const %s = &xKernelImageQueue_%s;\n",
+                    obj->kind == OBJ_QUEUE ? "QueueHandle_t" : "SemaphoreHandle_t", obj->handle, obj->name);
+        }
+        fprintf(out, "\n");
+        registered++;
+    }
+
+    if (registered > 0)
+    {
+        fprintf(out, "#if( ( configQUEUE_REGISTRY_SIZE > 0 ) && ( configQUEUE_REGISTRY_SIZE < %d ) )\n"
+                     "\t#error The kernel image registers %d queues, raise configQUEUE_REGISTRY_SIZE\n#endif\n\n",
+                registered, registered);
+    }
+
+    fprintf(out, "#define queueIMAGE_REGISTRY\t\\\n{\t\\\n");
+    for (i = 0; i < object_count; i++)
+    {
+        if (objects[i].kind == OBJ_QUEUE || objects[i].kind == OBJ_SEMAPHORE || objects[i].kind == OBJ_MUTEX)
+        {
+            fprintf(out, "\t{ \"%s\", &xKernelImageQueue_%s },\t\\\n", objects[i].name, objects[i].name);
+        }
+    }
+    if (registered == 0)
+    {
+        fprintf(out, "\t{ NULL, NULL }\t\\\n");
+    }
+    fprintf(out, "}\n");
+}
+
+/* Timers that start with the scheduler, in expiry order.  Equal expiry
+ * times keep the description order, as vListInsert() would. */
+static int compare_expiry(const void *a, const void *b)
+{
+    const object_t *ta = &objects[*(const int *)a];
+    const object_t *tb = &objects[*(const int *)b];
+
+    if (ta->period != tb->period)
+    {
+        return ta->period < tb->period ? -1 : 1;
+    }
+    return *(const int *)a - *(const int *)b;
+}
+
+static void write_timers(FILE *out)
+{
+    int active[MAX_OBJECTS];
+    int i, s;
+
+    fprintf(out, "\n#elif defined( KERNEL_IMAGE_TIMERS )\n\n");
+
+    if (count_kind(OBJ_TIMER) > 0)
+    {
+        fprintf(out, "#if( configTIMER_SERVICE_COUNT != %ld )\n"
+                     "\t#error kernel_image.h was generated for configTIMER_SERVICE_COUNT %ld, run kimage again\n"
+                     "#endif\n\n", config.timer_service_count, config.timer_service_count);
+    }
+
+    for (i = 0; i < object_count; i++)
+    {
+        if (objects[i].kind == OBJ_TIMER)
+        {
+            fprintf(out, "static Timer_t xKernelImageTimer_%s;\n", objects[i].name);
+        }
+    }
+
+    fprintf(out, "\n#define tmrIMAGE_SERVICES\t\\\n{\t\\\n");
+    for (s = 0; s < config.timer_service_count; s++)
+    {
+        int count = 0;
+
+        for (i = 0; i < object_count; i++)
+        {
+            if (objects[i].kind == OBJ_TIMER && objects[i].start && objects[i].service == s)
+            {
+                active[count++] = i;
+            }
+        }
+        qsort(active, (size_t)count, sizeof(int), compare_expiry);
+
+        /* Services without active timers are left to the kernel, apart from
+         * service 0 which keeps the initialiser from being empty. */
+        if (count == 0 && s != 0)
+        {
+            continue;
+        }
+
+        if (count == 0)
+        {
+            fprintf(out, "\t[ %d ] = tmrIMAGE_SERVICE( %d, 0U, tmrIMAGE_ACTIVE_LIST_END( %d ), "
+                         "tmrIMAGE_ACTIVE_LIST_END( %d ) ),\t\\\n", s, s, s, s);
+        }
+        else
+        {
+            fprintf(out, "\t[ %d ] = tmrIMAGE_SERVICE( %d, %dU, tmrIMAGE_TIMER_ITEM( xKernelImageTimer_%s ), "
+                         "tmrIMAGE_TIMER_ITEM( xKernelImageTimer_%s ) ),\t\\\n",
+                    s, s, count, objects[active[0]].name, objects[active[count - 1]].name);
+        }
+    }
+    fprintf(out, "}\n\n");
+
+    for (i = 0; i < object_count; i++)
+    {
+        const object_t *obj = &objects[i];
+        char next[EXPR_LEN], previous[EXPR_LEN], list[EXPR_LEN];
+
+        if (obj->kind != OBJ_TIMER)
+        {
+            continue;
+        }
+
+        if (obj->start)
+        {
+            int count = 0;
+
+            for (int j = 0; j < object_count; j++)
+            {
+                if (objects[j].kind == OBJ_TIMER && objects[j].start && objects[j].service == obj->service)
+                {
+                    active[count++] = j;
+                }
+            }
+            qsort(active, (size_t)count, sizeof(int), compare_expiry);
+
+            for (int a = 0; a < count; a++)
+            {
+                if (active[a] != i)
+                {
+                    continue;
+                }
+                if (a + 1 < count)
+                {
+                    snprintf(next, sizeof(next), "tmrIMAGE_TIMER_ITEM( xKernelImageTimer_%s )", objects[active[a + 1]].name);
+                }
+                else
+                {
+                    snprintf(next, sizeof(next), "tmrIMAGE_ACTIVE_LIST_END( %ld )", obj->service);
+                }
+                if (a > 0)
+                {
+                    snprintf(previous, sizeof(previous), "tmrIMAGE_TIMER_ITEM( xKernelImageTimer_%s )", objects[active[a - 1]].name);
+                }
+                else
+                {
+                    snprintf(previous, sizeof(previous), "tmrIMAGE_ACTIVE_LIST_END( %ld )", obj->service);
+                }
+            }
+            snprintf(list, sizeof(list), "tmrIMAGE_ACTIVE_LIST( %ld )", obj->service);
+        }
+        else
+        {
+            strcpy(next, "NULL");
+            strcpy(previous, "NULL");
+            strcpy(list, "NULL");
+        }
+
+        fprintf(out, "static Timer_t xKernelImageTimer_%s = tmrIMAGE_TIMER( xKernelImageTimer_%s, \"%s\", "
+                     "( TickType_t ) %lluU, ( void * ) ( %s ), %s, %ldU, "
+                     "( TickType_t ) ( configINITIAL_TICK_COUNT + %lluU ), %s, %s, %s, "
+                     "tmrSTATUS_IS_STATICALLY_ALLOCATED%s%s );\n",
+                obj->name, obj->name, obj->name, (unsigned long long)obj->period, obj->param,
+                obj->function, obj->service, (unsigned long long)(obj->start ? obj->period : 0),
+                next, previous, list,
+                obj->autoreload ? " | tmrSTATUS_IS_AUTORELOAD" : "",
+                obj->start ? " | tmrSTATUS_IS_ACTIVE" : "");
+        if (obj->handle[0] != '\0')
+        {
+            fprintf(out, "TimerHandle_t const %s = &xKernelImageTimer_%s;\n", obj->handle, obj->name);
+        }
+    }
+}
+
+static void write_image(FILE *out)
+{
+    fprintf(out, "/*\n * kernel_image.h - generated by kimage from %s and\n * %s.  Do not edit.\n *\n"
+                 " * Included by the application for the object handles, and by tasks.c,\n"
+                 " * queue.c and timers.c, which select their part of the image.\n */\n\n",
+            description_path, config.path);
+
+    write_common(out);
+    write_tasks(out);
+    write_queues(out);
+    write_timers(out);
+
+    fprintf(out, "\n#endif /* KERNEL_IMAGE_TASKS */\n");
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s -c FreeRTOSConfig.h [-o kernel_image.h] system.sys\n"
+            "  -c  FreeRTOSConfig.h of the project (priority levels, tick rate)\n"
+            "  -o  output file, standard output if not given\n",
+            argv0);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    const char *config_path = NULL;
+    const char *output_path = NULL;
+    FILE *out = stdout;
+    int arg;
+
+    for (arg = 1; arg < argc && argv[arg][0] == '-'; arg++)
+    {
+        if (strcmp(argv[arg], "-c") == 0 && arg + 1 < argc)
+        {
+            config_path = argv[++arg];
+        }
+        else if (strcmp(argv[arg], "-o") == 0 && arg + 1 < argc)
+        {
+            output_path = argv[++arg];
+        }
+        else
+        {
+            usage(argv[0]);
+        }
+    }
+    if (config_path == NULL || arg + 1 != argc)
+    {
+        usage(argv[0]);
+    }
+
+    load_config(config_path);
+    description_path = argv[arg];
+    load_description(description_path);
+
+    if (output_path != NULL && (out = fopen(output_path, "w")) == NULL)
+    {
+        fprintf(stderr, "cannot create %s\n", output_path);
+        return 2;
+    }
+    write_image(out);
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    return 0;
+}
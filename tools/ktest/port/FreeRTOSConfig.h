@@ -0,0 +1,59 @@
+/*
+ * Base kernel configuration of the ktest host builds.  A test that needs more
+ * (a feature switched on, or a different setting) names a header of its own
+ * in KTEST_CONFIG; see the Makefile.  Settings in that header that are also
+ * set here must be #undef'd first.
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#define configUSE_PREEMPTION					1
+#define configSUPPORT_STATIC_ALLOCATION			1
+#define configSUPPORT_DYNAMIC_ALLOCATION		1
+#define configUSE_IDLE_HOOK						1
+#define configUSE_TICK_HOOK						0
+#define configCPU_CLOCK_HZ						( 1000000UL )
+#define configTICK_RATE_HZ						( ( TickType_t ) 1000 )
+#define configMAX_PRIORITIES					( 7 )
+#define configMINIMAL_STACK_SIZE				( ( uint16_t ) 8192 )
+#define configTOTAL_HEAP_SIZE					( ( size_t ) ( 4 * 1024 * 1024 ) )
+#define configMAX_TASK_NAME_LEN					( 16 )
+#define configUSE_16_BIT_TICKS					0
+#define configUSE_MUTEXES						1
+#define configUSE_RECURSIVE_MUTEXES				1
+#define configUSE_COUNTING_SEMAPHORES			1
+#define configQUEUE_REGISTRY_SIZE				8
+#define configUSE_TRACE_FACILITY				1
+#define configUSE_TASK_NOTIFICATIONS			1
+
+/* Software timer definitions. */
+#define configUSE_TIMERS						1
+#define configTIMER_TASK_PRIORITY				( 5 )
+#define configTIMER_QUEUE_LENGTH				10
+#define configTIMER_TASK_STACK_DEPTH			8192
+
+/* Set the following definitions to 1 to include the API function, or zero
+to exclude the API function. */
+#define INCLUDE_vTaskPrioritySet				1
+#define INCLUDE_uxTaskPriorityGet				1
+#define INCLUDE_vTaskDelete						1
+#define INCLUDE_vTaskSuspend					1
+#define INCLUDE_vTaskDelayUntil					1
+#define INCLUDE_vTaskDelay						1
+#define INCLUDE_xTaskGetSchedulerState			1
+#define INCLUDE_xTaskGetCurrentTaskHandle		1
+#define INCLUDE_xTimerPendFunctionCall			1
+#define INCLUDE_xTaskGetIdleTaskHandle			1
+#define INCLUDE_uxTaskGetStackHighWaterMark		1
+#define INCLUDE_eTaskGetState					1
+
+/* The tests are built with asserts on, whatever NDEBUG says. */
+extern void vHostAssertFailed( const char *pcExpression, const char *pcFile, int iLine );
+#define configASSERT( x ) do { if( ( x ) == 0 ) { vHostAssertFailed( #x, __FILE__, __LINE__ ); } } while( 0 )
+
+#ifdef KTEST_CONFIG
+	#include KTEST_CONFIG
+#endif
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,33 @@
+/*
+ * Stand-in for the CMSIS-Core cmsis_compiler.h in ktest host builds of the
+ * CMSIS-RTOS2 layer.  The core registers the layer reads are plain variables
+ * a test can set:
+ *
+ *  - ulHostIPSR is the exception number; a test sets it non-zero around
+ *    calls that must behave as they would in an interrupt handler.
+ *  - ulHostSysTickLoad, ulHostSysTickValue and ulHostICSR are SysTick's
+ *    reload and current value registers and the SCB ICSR, for
+ *    osKernelGetSysTimerCount().  SysTick counts down from the reload value.
+ */
+
+#ifndef KTEST_CMSIS_COMPILER_H
+#define KTEST_CMSIS_COMPILER_H
+
+#include <stdint.h>
+
+extern volatile uint32_t ulHostIPSR;
+extern volatile uint32_t ulHostPRIMASK;
+extern volatile uint32_t ulHostSysTickLoad;
+extern volatile uint32_t ulHostSysTickValue;
+extern volatile uint32_t ulHostICSR;
+
+static inline uint32_t __get_IPSR( void ) { return ulHostIPSR; }
+static inline uint32_t __get_PRIMASK( void ) { return ulHostPRIMASK; }
+static inline void __set_PRIMASK( uint32_t ulPriMask ) { ulHostPRIMASK = ulPriMask; }
+static inline void __disable_irq( void ) { ulHostPRIMASK = 1U; }
+
+#define SYSTICK_LOAD_REG	ulHostSysTickLoad
+#define SYSTICK_VALUE_REG	ulHostSysTickValue
+#define SCB_ICSR_REG		ulHostICSR
+
+#endif /* KTEST_CMSIS_COMPILER_H */
@@ -0,0 +1,262 @@
+/*
+ * Host port used by ktest - see portmacro.h.
+ *
+ * The kernel gives pxPortInitialiseStack() only the top of a task's stack, so
+ * the port assumes every stack is at least configMINIMAL_STACK_SIZE words and
+ * runs the task's context in that much of it.  The tests give every task that
+ * runs at least that much.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Kept out of the way of the stack high water mark, above the frame. */
+#define portCONTEXT_STACK_BYTES		( ( configMINIMAL_STACK_SIZE * sizeof( StackType_t ) ) - 4096U )
+
+/* What pxTopOfStack points to for a task that is not running. */
+typedef struct HostFrame
+{
+	ucontext_t xContext;
+	TaskFunction_t pxCode;
+	void *pvParameters;
+} HostFrame_t;
+
+/* The first member of the TCB is pxTopOfStack. */
+extern void * volatile pxCurrentTCB;
+
+static volatile UBaseType_t uxCriticalNesting = 0;
+static volatile UBaseType_t uxInterruptMaskNesting = 0;
+static volatile BaseType_t xSwitchPending = pdFALSE;
+static ucontext_t xSchedulerContext;
+
+#if( configUSE_OBJECT_LOCKS == 1 )
+	volatile BaseType_t xHostLocksHeld = 0;
+	volatile BaseType_t xHostKernelLocks = 0;
+#endif
+/*-----------------------------------------------------------*/
+
+static HostFrame_t *prvCurrentFrame( void )
+{
+	return *( HostFrame_t ** ) pxCurrentTCB;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTaskEntry( void )
+{
+HostFrame_t *pxFrame = prvCurrentFrame();
+
+	pxFrame->pxCode( pxFrame->pvParameters );
+
+	/* Tasks must delete themselves rather than return. */
+	fprintf( stderr, "ktest: a task returned from its function\n" );
+	abort();
+}
+/*-----------------------------------------------------------*/
+
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+uintptr_t uxFrame;
+HostFrame_t *pxFrame;
+
+	uxFrame = ( ( uintptr_t ) pxTopOfStack - sizeof( HostFrame_t ) ) & ~( uintptr_t ) 63;
+	pxFrame = ( HostFrame_t * ) uxFrame;
+
+	( void ) getcontext( &( pxFrame->xContext ) );
+	pxFrame->pxCode = pxCode;
+	pxFrame->pvParameters = pvParameters;
+	pxFrame->xContext.uc_stack.ss_sp = ( void * ) ( uxFrame - portCONTEXT_STACK_BYTES );
+	pxFrame->xContext.uc_stack.ss_size = portCONTEXT_STACK_BYTES - 256U;
+	pxFrame->xContext.uc_link = NULL;
+	makecontext( &( pxFrame->xContext ), prvTaskEntry, 0 );
+
+	return ( StackType_t * ) pxFrame;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchContext( void )
+{
+HostFrame_t *pxOld = prvCurrentFrame(), *pxNew;
+UBaseType_t uxSavedInterruptStatus;
+
+	/* PendSV selects the next task with interrupts masked. */
+	uxSavedInterruptStatus = uxPortSetInterruptMask();
+	vTaskSwitchContext();
+	vPortClearInterruptMask( uxSavedInterruptStatus );
+	pxNew = prvCurrentFrame();
+
+	if( pxNew != pxOld )
+	{
+		( void ) swapcontext( &( pxOld->xContext ), &( pxNew->xContext ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+	if( uxCriticalNesting > 0U )
+	{
+		/* As PendSV would, wait until interrupts are enabled again. */
+		xSwitchPending = pdTRUE;
+	}
+	else
+	{
+		xSwitchPending = pdFALSE;
+		prvSwitchContext();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortYieldFromISR( void )
+{
+	vPortYield();
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	configASSERT( uxCriticalNesting > 0U );
+	uxCriticalNesting--;
+
+	if( ( uxCriticalNesting == 0U ) && ( xSwitchPending != pdFALSE ) )
+	{
+		vPortYield();
+	}
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortSetInterruptMask( void )
+{
+	uxInterruptMaskNesting++;
+	return 0U;
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMask( UBaseType_t uxSavedInterruptStatus )
+{
+	( void ) uxSavedInterruptStatus;
+	configASSERT( uxInterruptMaskNesting > 0U );
+	uxInterruptMaskNesting--;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+	uxCriticalNesting = 0U;
+	( void ) swapcontext( &xSchedulerContext, &( prvCurrentFrame()->xContext ) );
+
+	/* Only reached if a test switches back to the scheduler context, which
+	none do - they end the process with exit(). */
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+}
+/*-----------------------------------------------------------*/
+
+void vHostTick( void )
+{
+UBaseType_t uxSavedInterruptStatus;
+BaseType_t xSwitchRequired;
+
+	/* As the SysTick handler, which masks interrupts around the tick. */
+	uxSavedInterruptStatus = uxPortSetInterruptMask();
+	xSwitchRequired = xTaskIncrementTick();
+	vPortClearInterruptMask( uxSavedInterruptStatus );
+
+	if( xSwitchRequired != pdFALSE )
+	{
+		vPortYield();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vHostAssertFailed( const char *pcExpression, const char *pcFile, int iLine )
+{
+	fprintf( stderr, "ktest: assert %s failed at %s:%d\n", pcExpression, pcFile, iLine );
+	abort();
+}
+/*-----------------------------------------------------------*/
+
+#if( configUSE_OBJECT_LOCKS == 1 )
+
+	void vHostLockUnderflow( const char *pcFile, int iLine )
+	{
+		fprintf( stderr, "ktest: lock released more often than taken at %s:%d\n", pcFile, iLine );
+		abort();
+	}
+/*-----------------------------------------------------------*/
+
+	void vHostCheckObjectLock( const char *pcFile, int iLine )
+	{
+		if( xHostKernelLocks != 0 )
+		{
+			fprintf( stderr, "ktest: object lock taken with the kernel lock held at %s:%d\n", pcFile, iLine );
+			abort();
+		}
+	}
+/*-----------------------------------------------------------*/
+
+	void vHostCheckKernelLock( const char *pcFile, int iLine )
+	{
+		if( ( uxCriticalNesting == 0U ) && ( uxInterruptMaskNesting == 0U ) )
+		{
+			fprintf( stderr, "ktest: kernel lock taken with interrupts enabled at %s:%d\n", pcFile, iLine );
+			abort();
+		}
+	}
+/*-----------------------------------------------------------*/
+
+	void vHostKernelNotLocked( const char *pcFile, int iLine )
+	{
+		fprintf( stderr, "ktest: kernel lists changed without the kernel lock at %s:%d\n", pcFile, iLine );
+		abort();
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+/* Time only passes while every task is blocked, one tick per pass of the idle
+loop, so a test's timing is exact and repeatable. */
+void vApplicationIdleHook( void )
+{
+	vHostTick();
+}
+/*-----------------------------------------------------------*/
+
+static StaticTask_t xIdleTaskTCB;
+static StackType_t uxIdleTaskStack[ configMINIMAL_STACK_SIZE ];
+
+void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, uint32_t *pulIdleTaskStackSize )
+{
+	*ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+	*ppxIdleTaskStackBuffer = uxIdleTaskStack;
+	*pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TIMERS == 1 )
+
+	static StaticTask_t xTimerTaskTCB;
+	static StackType_t uxTimerTaskStack[ configTIMER_TASK_STACK_DEPTH ];
+
+	void vApplicationGetTimerTaskMemory( StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer, uint32_t *pulTimerTaskStackSize )
+	{
+		*ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+		*ppxTimerTaskStackBuffer = uxTimerTaskStack;
+		*pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+	}
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ * Host port used by ktest.  Every task is a ucontext on the one host thread,
+ * so there is no real concurrency: a context switch happens only where the
+ * kernel asks for one, and the tick is driven by the idle hook or by a test
+ * calling vHostTick().  Critical sections only count their nesting, so a
+ * yield requested inside one is taken when the last one is left.
+ */
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Type definitions. */
+#define portCHAR		char
+#define portFLOAT		float
+#define portDOUBLE		double
+#define portLONG		long
+#define portSHORT		short
+#define portSTACK_TYPE	uintptr_t
+#define portBASE_TYPE	long
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#if( configUSE_16_BIT_TICKS == 1 )
+	typedef uint16_t TickType_t;
+	#define portMAX_DELAY ( TickType_t ) 0xffff
+#else
+	typedef uint32_t TickType_t;
+	#define portMAX_DELAY ( TickType_t ) 0xffffffffUL
+	#define portTICK_TYPE_IS_ATOMIC 1
+#endif
+
+#define portPOINTER_SIZE_TYPE	uintptr_t
+/*-----------------------------------------------------------*/
+
+/* Architecture specifics. */
+#define portSTACK_GROWTH		( -1 )
+#define portTICK_PERIOD_MS		( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT		16
+#define portNOP()
+#define portMEMORY_BARRIER()
+/*-----------------------------------------------------------*/
+
+/* Scheduler utilities. */
+extern void vPortYield( void );
+extern void vPortYieldFromISR( void );
+
+#define portYIELD()					vPortYield()
+#define portEND_SWITCHING_ISR( x )	do { if( ( x ) != pdFALSE ) { vPortYieldFromISR(); } } while( 0 )
+#define portYIELD_FROM_ISR( x )		portEND_SWITCHING_ISR( x )
+/*-----------------------------------------------------------*/
+
+/* Critical section management. */
+extern void vPortEnterCritical( void );
+extern void vPortExitCritical( void );
+extern UBaseType_t uxPortSetInterruptMask( void );
+extern void vPortClearInterruptMask( UBaseType_t uxSavedInterruptStatus );
+
+#define portSET_INTERRUPT_MASK_FROM_ISR()		uxPortSetInterruptMask()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )	vPortClearInterruptMask( x )
+#define portDISABLE_INTERRUPTS()
+#define portENABLE_INTERRUPTS()
+#define portENTER_CRITICAL()					vPortEnterCritical()
+#define portEXIT_CRITICAL()						vPortExitCritical()
+/*-----------------------------------------------------------*/
+
+/* Per object locks.  On one host thread a lock cannot be contended, so the
+port checks the rules in FreeRTOS.h instead, and aborts on a break:
+
+  - locks are taken and released in pairs.  xHostLocksHeld is the number of
+    object locks held and xHostKernelLocks the depth of the kernel lock, and
+    both must be 0 whenever a task runs outside the kernel;
+  - no object lock is taken while the kernel lock is held;
+  - the kernel lock is only taken with interrupts masked, by a critical
+    section or portSET_INTERRUPT_MASK_FROM_ISR();
+  - tasks.c holds the kernel lock where it asserts it does. */
+#if( configUSE_OBJECT_LOCKS == 1 )
+	extern volatile BaseType_t xHostLocksHeld;
+	extern volatile BaseType_t xHostKernelLocks;
+	extern void vHostLockUnderflow( const char *pcFile, int iLine );
+	extern void vHostCheckObjectLock( const char *pcFile, int iLine );
+	extern void vHostCheckKernelLock( const char *pcFile, int iLine );
+	extern void vHostKernelNotLocked( const char *pcFile, int iLine );
+
+	#define portOBJECT_LOCK_TYPE					volatile BaseType_t
+	#define portOBJECT_LOCK_INITIALISER				0
+	#define portOBJECT_LOCK_INIT( pxLock )			( *( pxLock ) = 0 )
+	#define portENTER_OBJECT_CRITICAL( pxLock )		do { vHostCheckObjectLock( __FILE__, __LINE__ ); vPortEnterCritical(); ( *( pxLock ) )++; xHostLocksHeld++; } while( 0 )
+	#define portEXIT_OBJECT_CRITICAL( pxLock )		do { if( *( pxLock ) <= 0 ) { vHostLockUnderflow( __FILE__, __LINE__ ); } ( *( pxLock ) )--; xHostLocksHeld--; vPortExitCritical(); } while( 0 )
+	#define portENTER_OBJECT_CRITICAL_FROM_ISR( pxLock )		( vHostCheckObjectLock( __FILE__, __LINE__ ), ( *( pxLock ) )++, xHostLocksHeld++, uxPortSetInterruptMask() )
+	#define portEXIT_OBJECT_CRITICAL_FROM_ISR( pxLock, x )	do { if( *( pxLock ) <= 0 ) { vHostLockUnderflow( __FILE__, __LINE__ ); } ( *( pxLock ) )--; xHostLocksHeld--; vPortClearInterruptMask( x ); } while( 0 )
+	#define portLOCK_KERNEL()						do { vHostCheckKernelLock( __FILE__, __LINE__ ); xHostKernelLocks++; } while( 0 )
+	#define portUNLOCK_KERNEL()						do { if( xHostKernelLocks <= 0 ) { vHostLockUnderflow( __FILE__, __LINE__ ); } xHostKernelLocks--; } while( 0 )
+	#define portASSERT_KERNEL_LOCKED()				do { if( xHostKernelLocks <= 0 ) { vHostKernelNotLocked( __FILE__, __LINE__ ); } } while( 0 )
+#endif
+/*-----------------------------------------------------------*/
+
+/* Task function macros as described on the FreeRTOS.org WEB site. */
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+/*-----------------------------------------------------------*/
+
+/* Runs one tick interrupt: increments the tick count and switches task if the
+tick unblocked a task of higher priority (or time slicing asks for it). */
+extern void vHostTick( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORTMACRO_H */
@@ -0,0 +1,65 @@
+/*
+ * Stand-in for the STM32F4 device header in ktest host builds of template
+ * code that drives peripherals, such as Core/Src/telemetry.c.  Only the
+ * registers and bits that code uses are here.  Each peripheral is a plain
+ * variable, which the test that includes this header defines, and which it
+ * reads and sets in place of the hardware:
+ *
+ *  - xHostDMA1Stream6 and xHostDMA1 are the USART2 TX DMA stream and its
+ *    controller.  The test plays the DMA: it sends NDTR bytes from M0AR once
+ *    the stream is enabled, clears EN and calls the stream's interrupt
+ *    handler.
+ *  - xHostDWT.CYCCNT is the cycle counter, which the test advances.
+ *
+ * The DMA address registers are 32 bits wide, as on the target, so a test
+ * that uses them is linked at a fixed low address (-no-pie).
+ */
+
+#ifndef KTEST_STM32F4XX_H
+#define KTEST_STM32F4XX_H
+
+#include <stdint.h>
+
+typedef struct { volatile uint32_t CR, NDTR, PAR, M0AR, M1AR, FCR; } DMA_Stream_TypeDef;
+typedef struct { volatile uint32_t LISR, HISR, LIFCR, HIFCR; } DMA_TypeDef;
+typedef struct { volatile uint32_t SR, DR, BRR, CR1, CR2, CR3; } USART_TypeDef;
+typedef struct { volatile uint32_t AHB1ENR; } RCC_TypeDef;
+typedef struct { volatile uint32_t CTRL, CYCCNT; } DWT_Type;
+typedef struct { volatile uint32_t DEMCR; } CoreDebug_Type;
+
+extern DMA_Stream_TypeDef xHostDMA1Stream6;
+extern DMA_TypeDef xHostDMA1;
+extern USART_TypeDef xHostUSART2;
+extern RCC_TypeDef xHostRCC;
+extern DWT_Type xHostDWT;
+extern CoreDebug_Type xHostCoreDebug;
+extern uint32_t SystemCoreClock;
+
+#define DMA1_Stream6				( &xHostDMA1Stream6 )
+#define DMA1						( &xHostDMA1 )
+#define USART2						( &xHostUSART2 )
+#define RCC							( &xHostRCC )
+#define DWT							( &xHostDWT )
+#define CoreDebug					( &xHostCoreDebug )
+
+#define DMA_SxCR_EN					( 1UL << 0 )
+#define DMA_SxCR_TCIE				( 1UL << 4 )
+#define DMA_SxCR_DIR_0				( 1UL << 6 )
+#define DMA_SxCR_MINC				( 1UL << 10 )
+#define DMA_SxCR_CHSEL_Pos			( 25U )
+#define DMA_HIFCR_CFEIF6			( 1UL << 16 )
+#define DMA_HIFCR_CDMEIF6			( 1UL << 18 )
+#define DMA_HIFCR_CTEIF6			( 1UL << 19 )
+#define DMA_HIFCR_CHTIF6			( 1UL << 20 )
+#define DMA_HIFCR_CTCIF6			( 1UL << 21 )
+#define RCC_AHB1ENR_DMA1EN			( 1UL << 21 )
+#define USART_CR3_DMAT				( 1UL << 7 )
+#define CoreDebug_DEMCR_TRCENA_Msk	( 1UL << 24 )
+#define DWT_CTRL_CYCCNTENA_Msk		( 1UL << 0 )
+
+typedef enum { DMA1_Stream6_IRQn = 17 } IRQn_Type;
+
+static inline void NVIC_SetPriority( IRQn_Type xIRQn, uint32_t ulPriority ) { ( void ) xIRQn; ( void ) ulPriority; }
+static inline void NVIC_EnableIRQ( IRQn_Type xIRQn ) { ( void ) xIRQn; }
+
+#endif /* KTEST_STM32F4XX_H */
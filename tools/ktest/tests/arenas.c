@@ -0,0 +1,189 @@
+/*=====================================================================
+ *  arenas - task and request scoped memory (configUSE_ARENAS)
+ *
+ *    - allocations are aligned to portBYTE_ALIGNMENT, also in a static
+ *      arena whose storage is not, and are rounded up to it,
+ *    - an allocation that does not fit, or whose rounded size would
+ *      wrap, fails and is counted,
+ *    - a rollback releases what was allocated after the mark and keeps
+ *      the rest; a reset releases everything,
+ *    - the statistics: size, use, high water mark, allocation counts,
+ *    - an arena attached to a task with vTaskSetArena() is deleted with
+ *      the task: a heap arena goes back to the heap, a static one is
+ *      scrubbed.
+ *=====================================================================*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "arena.h"
+
+#define SIZE        256
+#define ALIGNED(p)  (((uintptr_t)(p) & portBYTE_ALIGNMENT_MASK) == 0)
+
+#define CHECK(x) \
+    do { if (!(x)) { fails++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+static int fails;
+static TaskHandle_t mainTask;
+
+static void check_stats(ArenaHandle_t arena, size_t size, size_t used, size_t highWater,
+                        UBaseType_t allocations, UBaseType_t failed, int line)
+{
+    ArenaStats_t stats;
+
+    vArenaGetStats(arena, &stats);
+    if (stats.xSizeBytes != size || stats.xUsedBytes != used || stats.xHighWaterMarkBytes != highWater ||
+        stats.uxAllocations != allocations || stats.uxFailedAllocations != failed)
+    {
+        fails++;
+        printf("FAIL line %d: stats %lu %lu %lu %lu %lu\n", line, (unsigned long)stats.xSizeBytes,
+               (unsigned long)stats.xUsedBytes, (unsigned long)stats.xHighWaterMarkBytes,
+               (unsigned long)stats.uxAllocations, (unsigned long)stats.uxFailedAllocations);
+    }
+}
+
+#define STATS(arena, size, used, highWater, allocations, failed) \
+    check_stats(arena, size, used, highWater, allocations, failed, __LINE__)
+
+/* Allocates from the arena it was given, attached to itself, then lets
+   main delete it. */
+static void owner_task(void *argument)
+{
+    uint8_t *first, *second;
+
+    vTaskSetArena(NULL, argument);
+    first = pvArenaAllocFromTask(10);
+    second = pvArenaAllocFromTask(10);
+    CHECK(first != NULL && second == first + portBYTE_ALIGNMENT);
+    memset(first, 0x5A, 10);
+    xTaskNotifyGive(mainTask);
+    vTaskSuspend(NULL);
+}
+
+/* The same, but deletes itself, so the idle task frees it. */
+static void self_deleting_task(void *argument)
+{
+    vTaskSetArena(NULL, argument);
+    CHECK(pvArenaAllocFromTask(SIZE) != NULL);
+    vTaskDelete(NULL);
+}
+
+static void check_alignment_and_limits(void)
+{
+    static uint8_t storage[SIZE + 1] __attribute__((aligned(portBYTE_ALIGNMENT)));
+    static StaticArena_t buffer;
+    ArenaHandle_t arena;
+    uint8_t *a, *b;
+    size_t mark;
+
+    /* Storage one byte into an aligned buffer: the rest of the first
+       alignment unit is skipped. */
+    arena = xArenaCreateStatic(SIZE, &storage[1], &buffer);
+    CHECK(arena != NULL);
+    STATS(arena, SIZE - (portBYTE_ALIGNMENT - 1), 0, 0, 0, 0);
+
+    a = pvArenaAlloc(arena, 1);
+    b = pvArenaAlloc(arena, portBYTE_ALIGNMENT + 1);
+    CHECK(a == &storage[portBYTE_ALIGNMENT] && ALIGNED(a));
+    CHECK(b == a + portBYTE_ALIGNMENT && ALIGNED(b));
+    STATS(arena, SIZE - (portBYTE_ALIGNMENT - 1), 3 * portBYTE_ALIGNMENT, 3 * portBYTE_ALIGNMENT, 2, 0);
+
+    /* Nothing for 0 bytes, too many bytes, or sizes whose rounding wraps. */
+    CHECK(pvArenaAlloc(arena, 0) == NULL);
+    CHECK(pvArenaAlloc(arena, SIZE) == NULL);
+    CHECK(pvArenaAlloc(arena, SIZE_MAX) == NULL);
+    CHECK(pvArenaAlloc(arena, SIZE_MAX - portBYTE_ALIGNMENT_MASK + 1) == NULL);
+    STATS(arena, SIZE - (portBYTE_ALIGNMENT - 1), 3 * portBYTE_ALIGNMENT, 3 * portBYTE_ALIGNMENT, 2, 4);
+    vArenaDelete(arena);
+
+    /* Marks, nested. */
+    arena = xArenaCreate(SIZE);
+    CHECK(arena != NULL);
+    a = pvArenaAlloc(arena, 32);
+    CHECK(a != NULL && ALIGNED(a));
+    mark = xArenaGetMark(arena);
+    CHECK(mark == 32);
+    CHECK(pvArenaAlloc(arena, 100) != NULL);
+    {
+        size_t inner = xArenaGetMark(arena);
+
+        CHECK(pvArenaAlloc(arena, 64) != NULL);
+        vArenaRollback(arena, inner);
+        CHECK(xArenaGetMark(arena) == inner);
+    }
+    vArenaRollback(arena, mark);
+    b = pvArenaAlloc(arena, 1);
+    CHECK(b == a + 32);
+    STATS(arena, SIZE, 48, 32 + 112 + 64, 4, 0);
+
+    /* All of it, after a reset. */
+    vArenaReset(arena);
+    CHECK(xArenaGetMark(arena) == 0);
+    CHECK(pvArenaAlloc(arena, SIZE) == a);
+    CHECK(pvArenaAlloc(arena, 1) == NULL);
+    STATS(arena, SIZE, SIZE, SIZE, 5, 1);
+    vArenaDelete(arena);
+}
+
+static void check_task_arenas(void)
+{
+    static uint8_t storage[SIZE] __attribute__((aligned(portBYTE_ALIGNMENT)));
+    static const StaticArena_t scrubbed;
+    static StaticArena_t buffer;
+    ArenaHandle_t arena;
+    TaskHandle_t owner;
+    size_t freeHeap;
+
+    /* No arena attached. */
+    CHECK(xTaskGetArena(NULL) == NULL);
+    CHECK(pvArenaAllocFromTask(1) == NULL);
+
+    /* A task deleted by another: its arena is freed at once. */
+    freeHeap = xPortGetFreeHeapSize();
+    arena = xArenaCreate(SIZE);
+    CHECK(xTaskCreate(owner_task, "owner", configMINIMAL_STACK_SIZE, arena, 3, &owner) == pdPASS);
+    CHECK(ulTaskNotifyTake(pdTRUE, 0) == 1);
+    CHECK(xTaskGetArena(owner) == arena);
+    STATS(arena, SIZE, 2 * portBYTE_ALIGNMENT, 2 * portBYTE_ALIGNMENT, 2, 0);
+    vTaskDelete(owner);
+    CHECK(xPortGetFreeHeapSize() == freeHeap);
+
+    /* A task that deletes itself: the idle task frees the arena. */
+    arena = xArenaCreate(SIZE);
+    CHECK(xTaskCreate(self_deleting_task, "self", configMINIMAL_STACK_SIZE, arena, 3, NULL) == pdPASS);
+    vTaskDelay(2);
+    CHECK(xPortGetFreeHeapSize() == freeHeap);
+
+    /* A static arena is scrubbed instead. */
+    arena = xArenaCreateStatic(SIZE, storage, &buffer);
+    CHECK(xTaskCreate(owner_task, "owner", configMINIMAL_STACK_SIZE, arena, 3, &owner) == pdPASS);
+    CHECK(ulTaskNotifyTake(pdTRUE, 0) == 1);
+    CHECK(storage[0] == 0x5A);
+    vTaskDelete(owner);
+    CHECK(memcmp(&buffer, &scrubbed, sizeof(buffer)) == 0);
+    CHECK(xPortGetFreeHeapSize() == freeHeap);
+}
+
+static void main_task(void *argument)
+{
+    (void)argument;
+
+    mainTask = xTaskGetCurrentTaskHandle();
+    check_alignment_and_limits();
+    check_task_arenas();
+
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    exit(fails ? 1 : 0);
+}
+
+int main(void)
+{
+    xTaskCreate(main_task, "main", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+    vTaskStartScheduler();
+    return 2;
+}
@@ -0,0 +1,2 @@
+/* Kernel settings for arenas.c. */
+#define configUSE_ARENAS						1
@@ -0,0 +1,170 @@
+/*=====================================================================
+ *  idle_jobs - background jobs run by the idle task (configUSE_IDLE_JOBS)
+ *
+ *  Built three times by the Makefile: preemptive, cooperative, and with
+ *  configUSE_OBJECT_LOCKS set to 1.  The run time counter goes up by
+ *  one each time it is read, so budgets are counted in reads.
+ *
+ *    - registration, and refusal once the registry is full,
+ *    - a job that keeps work pending gets turns in round robin with the
+ *      others and yields when its budget is spent,
+ *    - a job that runs only when triggered, with its parameter,
+ *    - a job that ignores its budget is counted as an overrun,
+ *    - a job stops as soon as another task is ready,
+ *    - the statistics: no job is charged more than the idle task used.
+ *=====================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define ROUNDS      50
+
+#define CHECK(x) \
+    do { if (!(x)) { fails++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+#if (configUSE_OBJECT_LOCKS == 1)
+#define LOCKS_FREE() (xHostLocksHeld == 0 && xHostKernelLocks == 0)
+#else
+#define LOCKS_FREE() 1
+#endif
+
+static int fails;
+static uint32_t runTime;
+
+static IdleJobHandle_t scrub, flush, gc, wake;
+static TaskHandle_t waiter;
+static volatile int scrubCalls, flushCalls, gcCalls, wakeCalls, waiterRuns;
+static volatile int badParameter, wakeNotAskedToYield;
+
+uint32_t ulHostRunTime(void)
+{
+    return ++runTime;
+}
+
+/* Always has more to do: works until told to yield. */
+static BaseType_t scrub_job(void *parameter)
+{
+    (void)parameter;
+    scrubCalls++;
+    while (xTaskIdleJobShouldYield() == pdFALSE)
+    {
+    }
+    return pdTRUE;
+}
+
+/* Runs once per trigger. */
+static BaseType_t flush_job(void *parameter)
+{
+    flushCalls++;
+    if (parameter != (void *)0x1234)
+    {
+        badParameter++;
+    }
+    return pdFALSE;
+}
+
+/* Ignores its budget. */
+static BaseType_t gc_job(void *parameter)
+{
+    (void)parameter;
+    gcCalls++;
+    for (int i = 0; i < 200; i++)
+    {
+        (void)ulHostRunTime();
+    }
+    return pdFALSE;
+}
+
+/* Readies another task, as an interrupt would, and must then be told to
+   yield well inside its budget. */
+static BaseType_t wake_job(void *parameter)
+{
+    BaseType_t woken = pdFALSE;
+
+    (void)parameter;
+    wakeCalls++;
+    vTaskNotifyGiveFromISR(waiter, &woken);
+    if (xTaskIdleJobShouldYield() == pdFALSE)
+    {
+        wakeNotAskedToYield++;
+    }
+    return pdFALSE;
+}
+
+static void waiter_task(void *argument)
+{
+    (void)argument;
+
+    for (;;)
+    {
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        waiterRuns++;
+    }
+}
+
+static void main_task(void *argument)
+{
+    IdleJobStatus_t status[5];
+    uint32_t total = 0, charged = 0;
+    UBaseType_t count;
+
+    (void)argument;
+
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        vTaskDelay(2);
+        if ((i % 10) == 0)
+        {
+            vTaskTriggerIdleJob(flush);
+        }
+        if (i == 25)
+        {
+            vTaskTriggerIdleJob(wake);
+        }
+    }
+
+    count = uxTaskGetIdleJobStats(status, 5, &total);
+    CHECK(count == 4);
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        printf("  %-6s budget %3lu  time %5lu  turns %3lu  overruns %lu\n", status[i].pcJobName,
+               (unsigned long)status[i].ulBudget, (unsigned long)status[i].ulRunTimeCounter,
+               (unsigned long)status[i].ulRuns, (unsigned long)status[i].ulOverruns);
+        charged += status[i].ulRunTimeCounter;
+    }
+    CHECK(charged <= total);
+
+    CHECK(status[0].xHandle == scrub && status[0].ulRuns >= 10 && status[0].ulOverruns == 0);
+    CHECK(status[0].xPending == pdTRUE);
+    CHECK(status[1].ulRuns == 5 && flushCalls == 5 && badParameter == 0);
+    CHECK(status[2].ulRuns == 1 && status[2].ulOverruns == 1 && gcCalls == 1);
+    /* A new job is pending, so wake also ran once before its trigger. */
+    CHECK(status[3].ulRuns == 2 && status[3].ulOverruns == 0 && wakeCalls == 2);
+    CHECK(status[3].ulRunTimeCounter < status[3].ulBudget);
+    CHECK(wakeNotAskedToYield == 0 && waiterRuns == 2);
+    CHECK(uxTaskGetIdleJobStats(status, 2, NULL) == 2);
+    CHECK(LOCKS_FREE());
+
+    printf("configUSE_PREEMPTION %d, configUSE_OBJECT_LOCKS %d: idle time %lu, jobs %lu\n",
+           configUSE_PREEMPTION, configUSE_OBJECT_LOCKS, (unsigned long)total, (unsigned long)charged);
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    exit(fails ? 1 : 0);
+}
+
+int main(void)
+{
+    scrub = xTaskRegisterIdleJob("scrub", scrub_job, NULL, 50);
+    flush = xTaskRegisterIdleJob("flush", flush_job, (void *)0x1234, 50);
+    gc = xTaskRegisterIdleJob("gc", gc_job, NULL, 20);
+    wake = xTaskRegisterIdleJob("wake", wake_job, NULL, 100);
+    CHECK(scrub != NULL && flush != NULL && gc != NULL && wake != NULL);
+    CHECK(xTaskRegisterIdleJob("full", flush_job, NULL, 1) == NULL);
+
+    xTaskCreate(waiter_task, "waiter", configMINIMAL_STACK_SIZE, NULL, 1, &waiter);
+    xTaskCreate(main_task, "main", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+    vTaskStartScheduler();
+    return 2;
+}
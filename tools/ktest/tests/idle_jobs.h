@@ -0,0 +1,9 @@
+/* Kernel settings for idle_jobs.c. */
+#include <stdint.h>
+
+#define configUSE_IDLE_JOBS						1
+#define configIDLE_JOB_REGISTRY_SIZE			4
+#define configGENERATE_RUN_TIME_STATS			1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+extern uint32_t ulHostRunTime( void );
+#define portGET_RUN_TIME_COUNTER_VALUE()		ulHostRunTime()
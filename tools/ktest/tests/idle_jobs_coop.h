@@ -0,0 +1,5 @@
+/* Kernel settings for idle_jobs.c, without preemption. */
+#include "idle_jobs.h"
+
+#undef configUSE_PREEMPTION
+#define configUSE_PREEMPTION					0
@@ -0,0 +1,4 @@
+/* Kernel settings for idle_jobs.c, with the per object locks. */
+#include "idle_jobs.h"
+
+#define configUSE_OBJECT_LOCKS					1
@@ -0,0 +1,131 @@
+/*=====================================================================
+ *  isr_run_time - run time statistics with interrupt time counted
+ *                 apart (portGET_ISR_RUN_TIME_COUNTER_VALUE)
+ *
+ *  The run time counter only moves when the test moves it: run() is a
+ *  task doing work, interrupt() is a handler that ran for that long and
+ *  moves the interrupt time counter as well.
+ *
+ *    - the time of an interrupt is taken off the task it interrupted
+ *      and off no other task,
+ *    - interrupt time counted while the run time counter did not move
+ *      is not taken off the next task to run,
+ *    - the run time of the tasks and the time of the interrupts add up
+ *      to the total run time, that is to 100%.
+ *=====================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define MAX_TASKS   8
+
+#define CHECK(x) \
+    do { if (!(x)) { fails++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+static int fails;
+static uint32_t now, isr;
+
+uint32_t ulHostRunTime(void)
+{
+    return now;
+}
+
+uint32_t ulHostIsrRunTime(void)
+{
+    return isr;
+}
+
+static void run(uint32_t units)
+{
+    now += units;
+}
+
+static void interrupt(uint32_t units)
+{
+    now += units;
+    isr += units;
+}
+
+static uint32_t charged(TaskHandle_t task)
+{
+    TaskStatus_t status;
+
+    vTaskGetInfo(task, &status, pdFALSE, eInvalid);
+    return status.ulRunTimeCounter;
+}
+
+/* Runs when main yields, and yields back. */
+static void worker_task(void *argument)
+{
+    (void)argument;
+
+    run(50);
+    interrupt(25);
+    taskYIELD();
+
+    run(40);
+    for (;;)
+    {
+        taskYIELD();
+    }
+}
+
+static void main_task(void *argument)
+{
+    static TaskStatus_t status[MAX_TASKS];
+    TaskHandle_t self = xTaskGetCurrentTaskHandle(), worker;
+    uint32_t total, tasks = 0, inNow, inIsr;
+    UBaseType_t count;
+
+    (void)argument;
+
+    CHECK(xTaskCreate(worker_task, "worker", configMINIMAL_STACK_SIZE, NULL, 2, &worker) == pdPASS);
+
+    /* Interrupts charged to neither task. */
+    run(100);
+    interrupt(30);
+    run(20);
+    taskYIELD();
+    CHECK(charged(self) == 120);
+    CHECK(charged(worker) == 50);
+
+    /* A coarse run time counter: the interrupt time moved, the run time
+       counter did not. */
+    isr += 5;
+    taskYIELD();
+    inNow = now;
+    inIsr = isr;
+    CHECK(charged(self) == 120);
+    CHECK(charged(worker) == 90);
+
+    /* Every unit is a task's or an interrupt's, apart from the 5 units of
+       interrupt time the coarse counter missed.  main's own time since it
+       was switched in is not in its counter yet.  Listing the tasks moves
+       the round robin on, so this comes last. */
+    interrupt(10);
+    count = uxTaskGetSystemState(status, MAX_TASKS, &total);
+    CHECK(count > 0);
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        tasks += status[i].ulRunTimeCounter;
+    }
+    tasks += (now - inNow) - (isr - inIsr);
+    printf("  total %lu: tasks %lu, interrupts %lu\n", (unsigned long)total, (unsigned long)tasks,
+           (unsigned long)(isr - 5));
+    CHECK(total == now);
+    CHECK(tasks + isr == total + 5);
+    CHECK(tasks == 210 && isr == 70);
+
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    exit(fails ? 1 : 0);
+}
+
+int main(void)
+{
+    xTaskCreate(main_task, "main", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+    vTaskStartScheduler();
+    return 2;
+}
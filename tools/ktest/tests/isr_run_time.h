@@ -0,0 +1,10 @@
+/* Kernel settings for isr_run_time.c: run time statistics, with the time
+spent in interrupts counted apart. */
+#include <stdint.h>
+
+#define configGENERATE_RUN_TIME_STATS			1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+extern uint32_t ulHostRunTime( void );
+extern uint32_t ulHostIsrRunTime( void );
+#define portGET_RUN_TIME_COUNTER_VALUE()		ulHostRunTime()
+#define portGET_ISR_RUN_TIME_COUNTER_VALUE()	ulHostIsrRunTime()
@@ -0,0 +1,176 @@
+/*=====================================================================
+ *  kimage - a kernel image made by tools/kimage
+ *           (configUSE_KERNEL_IMAGE)
+ *
+ *  The Makefile runs kimage on kimage.sys and builds this with the
+ *  header it writes: plain, with compact list items, and with the
+ *  sized queue copy.  main() only starts the scheduler.  A change to
+ *  the kernel structures that tskIMAGE_TCB(), queueIMAGE_QUEUE() or the
+ *  list and timer initialisers do not follow shows up here.
+ *
+ *    - the tasks have their names, priorities and parameters, the
+ *      highest priority task runs first, and tasks of the same
+ *      priority take turns in the order they are listed,
+ *    - the queue, semaphores and mutexes start empty, at their initial
+ *      count or free, are registered under their names, and work:
+ *      items pass through the queue in order with tasks blocking on
+ *      both sides, a mutex has a holder and a recursive one nests,
+ *    - the started auto-reload timer fires every period from the
+ *      first tick, and the other one can be started,
+ *    - the tasks are all there, and nothing was taken from the heap.
+ *=====================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "timers.h"
+#include "kernel_image.h"
+
+#define ITEMS       6
+#define PERIOD      5
+#define TICKS       52
+
+#define CHECK(x) \
+    do { if (!(x)) { fails++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+static int fails;
+static char order[8];
+static int ran;
+static uint32_t received[ITEMS];
+static volatile int ticks, onceFired;
+static void *producerParameter;
+
+static void record(char task)
+{
+    if (ran < (int)sizeof(order) - 1)
+    {
+        order[ran++] = task;
+    }
+}
+
+void vTickCallback(TimerHandle_t xTimer)
+{
+    if (pvTimerGetTimerID(xTimer) == (void *)3)
+    {
+        ticks++;
+    }
+}
+
+void vOnceCallback(TimerHandle_t xTimer)
+{
+    (void)xTimer;
+    onceFired++;
+}
+
+/* Takes its turn after the consumer, which is ahead of it in the same
+   ready list. */
+void vSecondTask(void *pvParameters)
+{
+    (void)pvParameters;
+    record('S');
+    vTaskSuspend(NULL);
+}
+
+/* Fills the queue, blocking when it is full, then gives Done. */
+void vProducerTask(void *pvParameters)
+{
+    record('P');
+    producerParameter = pvParameters;
+    for (uint32_t i = 1; i <= ITEMS; i++)
+    {
+        xQueueSend(xItemQueue, &i, portMAX_DELAY);
+    }
+    xSemaphoreGive(xDone);
+    vTaskSuspend(NULL);
+}
+
+/* Empties the queue, then gives Ready. */
+void vConsumerTask(void *pvParameters)
+{
+    uint32_t item;
+
+    (void)pvParameters;
+    record('C');
+    for (int i = 0; i < ITEMS; i++)
+    {
+        if (xQueueReceive(xItemQueue, &item, portMAX_DELAY) == pdPASS)
+        {
+            received[i] = item;
+        }
+    }
+    xSemaphoreGive(xReady);
+    vTaskSuspend(NULL);
+}
+
+void vCheckTask(void *pvParameters)
+{
+    (void)pvParameters;
+    record('K');
+
+    /* Tasks. */
+    CHECK(strcmp(order, "PK") == 0);
+    CHECK(producerParameter == (void *)7);
+    CHECK(xTaskGetCurrentTaskHandle() == xCheckTask);
+    CHECK(strcmp(pcTaskGetName(xProducerTask), "Producer") == 0);
+    CHECK(strcmp(pcTaskGetName(xConsumerTask), "Consumer") == 0);
+    CHECK(strcmp(pcTaskGetName(xTaskGetIdleTaskHandle()), "IDLE") == 0);
+    CHECK(uxTaskPriorityGet(xProducerTask) == 3 && uxTaskPriorityGet(NULL) == 2);
+    CHECK(uxTaskPriorityGet(xConsumerTask) == 1);
+    CHECK(eTaskGetState(xProducerTask) == eBlocked && eTaskGetState(xConsumerTask) == eReady);
+    CHECK(uxTaskGetNumberOfTasks() == 6);
+
+    /* Queue, semaphores and mutexes as they start. */
+    CHECK(strcmp(pcQueueGetName(xItemQueue), "Items") == 0);
+    CHECK(strcmp(pcQueueGetName(xNested), "Nested") == 0);
+    CHECK(uxQueueMessagesWaiting(xItemQueue) == 4 && uxQueueSpacesAvailable(xItemQueue) == 0);
+    CHECK(uxSemaphoreGetCount(xReady) == 0 && uxSemaphoreGetCount(xDone) == 1);
+    CHECK(xSemaphoreGetMutexHolder(xLock) == NULL);
+    CHECK(xSemaphoreTake(xLock, 0) == pdTRUE && xSemaphoreGetMutexHolder(xLock) == xCheckTask);
+    CHECK(xSemaphoreTake(xLock, 0) == pdFALSE);
+    CHECK(xSemaphoreGive(xLock) == pdTRUE && xSemaphoreGetMutexHolder(xLock) == NULL);
+    CHECK(xSemaphoreTakeRecursive(xNested, 0) == pdTRUE && xSemaphoreTakeRecursive(xNested, 0) == pdTRUE);
+    CHECK(xSemaphoreGiveRecursive(xNested) == pdTRUE && xSemaphoreGetMutexHolder(xNested) == xCheckTask);
+    CHECK(xSemaphoreGiveRecursive(xNested) == pdTRUE && xSemaphoreGetMutexHolder(xNested) == NULL);
+
+    /* Through the queue: Done has room for the producer's give once the
+       initial count is taken. */
+    CHECK(xSemaphoreTake(xDone, 0) == pdTRUE);
+    CHECK(xSemaphoreTake(xDone, portMAX_DELAY) == pdTRUE);
+    CHECK(xSemaphoreTake(xReady, portMAX_DELAY) == pdTRUE);
+    /* Second took its turn when the producer preempted the consumer. */
+    CHECK(strcmp(order, "PKCS") == 0);
+    for (int i = 0; i < ITEMS; i++)
+    {
+        CHECK(received[i] == (uint32_t)i + 1);
+    }
+    CHECK(uxQueueMessagesWaiting(xItemQueue) == 0);
+
+    /* Timers. */
+    CHECK(strcmp(pcTimerGetName(xTickTimer), "Tick") == 0);
+    CHECK(xTimerIsTimerActive(xTickTimer) != pdFALSE && xTimerIsTimerActive(xOnceTimer) == pdFALSE);
+    CHECK(xTimerGetPeriod(xTickTimer) == PERIOD);
+    CHECK(xTimerStart(xOnceTimer, 0) == pdPASS);
+    vTaskDelay(TICKS - xTaskGetTickCount());
+    printf("  tick %lu: Tick fired %d times, Once %d\n", (unsigned long)xTaskGetTickCount(), ticks, onceFired);
+    CHECK(ticks == TICKS / PERIOD);
+    CHECK(xTimerGetExpiryTime(xTickTimer) == (TICKS / PERIOD + 1) * PERIOD);
+    CHECK(onceFired == 1 && xTimerIsTimerActive(xOnceTimer) == pdFALSE);
+
+    /* heap_4 sets the heap up on the first allocation, and there has
+       been none. */
+    CHECK(xPortGetFreeHeapSize() == 0);
+
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    exit(fails ? 1 : 0);
+}
+
+int main(void)
+{
+    vTaskStartScheduler();
+    return 2;
+}
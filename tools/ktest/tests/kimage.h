@@ -0,0 +1,4 @@
+/* Kernel settings for kimage.c: the objects come from the image in
+build/kernel_image.h. */
+#define configUSE_KERNEL_IMAGE					1
+#define INCLUDE_xSemaphoreGetMutexHolder		1
@@ -0,0 +1,4 @@
+/* Kernel settings for kimage.c, compact list items. */
+#define configUSE_KERNEL_IMAGE					1
+#define configUSE_COMPACT_LIST_ITEMS			1
+#define INCLUDE_xSemaphoreGetMutexHolder		1
@@ -0,0 +1,4 @@
+/* Kernel settings for kimage.c, with the sized queue copy. */
+#define configUSE_KERNEL_IMAGE					1
+#define configQUEUE_SIZED_COPY					1
+#define INCLUDE_xSemaphoreGetMutexHolder		1
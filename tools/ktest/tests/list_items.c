@@ -0,0 +1,239 @@
+/*=====================================================================
+ *  list_items - kernel lists with and without configUSE_COMPACT_LIST_ITEMS
+ *
+ *  Built twice by the Makefile, once with each setting.  Checks that
+ *  the owners of list items are found again and that sorted lists,
+ *  the delayed list, priority ordered event lists and the timer lists
+ *  keep their order, then times the two paths the option changes:
+ *
+ *    - a context switch between two tasks of equal priority, which
+ *      looks up the owner of the next ready list item,
+ *    - vListInsert() of items with pseudo-random values into a sorted
+ *      list, which now tests for the list end instead of relying on
+ *      its portMAX_DELAY value.
+ *
+ *  Host figures, useful for comparing the two builds.
+ *=====================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "timers.h"
+
+#define SWITCHES        200000
+#define ITEMS           32
+#define INSERT_ROUNDS   20000
+
+#define CHECK(x) \
+    do { if (!(x)) { fails++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+typedef struct
+{
+    uint32_t   id;
+    ListItem_t item;
+} item_t;
+
+static int fails;
+static item_t items[ITEMS];
+static List_t list;
+
+static QueueHandle_t queue;
+static volatile int order[4];
+static volatile int orderCount;
+static volatile int woken[3];
+static volatile int expiries[3];
+static volatile uint32_t switches;
+
+static uint64_t now_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+static item_t *owner_of(ListItem_t *listItem)
+{
+#if (configUSE_COMPACT_LIST_ITEMS == 1)
+    return listGET_LIST_ITEM_OWNER_OF_TYPE(listItem, item_t, item);
+#else
+    return (item_t *)listGET_LIST_ITEM_OWNER(listItem);
+#endif
+}
+
+static void init_item(item_t *it, uint32_t id, TickType_t value)
+{
+    it->id = id;
+    vListInitialiseItem(&it->item);
+#if (configUSE_COMPACT_LIST_ITEMS == 0)
+    listSET_LIST_ITEM_OWNER(&it->item, it);
+#endif
+    listSET_LIST_ITEM_VALUE(&it->item, value);
+}
+
+/* Inserts every item with a pseudo-random value, checks the list is
+   sorted and every owner is right, then removes them again. */
+static void fill_sorted(uint32_t seed, int check)
+{
+    ListItem_t *pos;
+    TickType_t last = 0;
+    UBaseType_t n = 0;
+
+    for (int i = 0; i < ITEMS; i++)
+    {
+        seed = seed * 1103515245U + 12345U;
+        /* Includes portMAX_DELAY, which must go last but before the end. */
+        init_item(&items[i], (uint32_t)i, (i == 5) ? portMAX_DELAY : (TickType_t)(seed >> 8));
+        vListInsert(&list, &items[i].item);
+    }
+
+    if (check)
+    {
+        for (pos = listGET_HEAD_ENTRY(&list); pos != listGET_END_MARKER(&list); pos = listGET_NEXT(pos))
+        {
+            item_t *it = owner_of(pos);
+
+            CHECK(&items[it->id].item == pos);
+            CHECK(listGET_LIST_ITEM_VALUE(pos) >= last);
+            last = listGET_LIST_ITEM_VALUE(pos);
+            n++;
+        }
+        CHECK(n == ITEMS && listCURRENT_LIST_LENGTH(&list) == ITEMS);
+        CHECK(last == portMAX_DELAY);
+    }
+
+    for (int i = 0; i < ITEMS; i++)
+    {
+        (void)uxListRemove(&items[i].item);
+    }
+}
+
+static void sleeper(void *argument)
+{
+    int delay = (int)(intptr_t)argument;
+
+    vTaskDelay((TickType_t)delay);
+    order[orderCount++] = delay;
+    vTaskDelete(NULL);
+}
+
+static void receiver(void *argument)
+{
+    int value;
+
+    xQueueReceive(queue, &value, portMAX_DELAY);
+    woken[value] = (int)uxTaskPriorityGet(NULL);
+    vTaskDelete(NULL);
+}
+
+static void timer_callback(TimerHandle_t timer)
+{
+    expiries[(int)(intptr_t)pvTimerGetTimerID(timer)] = (int)xTaskGetTickCount();
+}
+
+static TaskHandle_t yielders[2];
+static uint64_t yieldEnd;
+
+static void yielder(void *argument)
+{
+    int self = (int)(intptr_t)argument;
+
+    for (;;)
+    {
+        if (++switches == SWITCHES)
+        {
+            yieldEnd = now_ns();
+            vTaskSuspend(yielders[1 - self]);
+            vTaskSuspend(NULL);
+        }
+        taskYIELD();
+    }
+}
+
+static void main_task(void *argument)
+{
+    TimerHandle_t timers[3];
+    TickType_t start;
+    uint64_t t0, switchNs, insertNs;
+    int value;
+
+    (void)argument;
+
+    /* Sorted list and owners. */
+    vListInitialise(&list);
+    for (uint32_t seed = 1; seed < 50; seed++)
+    {
+        fill_sorted(seed, 1);
+    }
+    CHECK(listLIST_IS_EMPTY(&list));
+
+    /* Delayed list: woken in the order of their delays. */
+    xTaskCreate(sleeper, "s7", configMINIMAL_STACK_SIZE, (void *)7, 3, NULL);
+    xTaskCreate(sleeper, "s2", configMINIMAL_STACK_SIZE, (void *)2, 3, NULL);
+    xTaskCreate(sleeper, "s5", configMINIMAL_STACK_SIZE, (void *)5, 3, NULL);
+    xTaskCreate(sleeper, "s3", configMINIMAL_STACK_SIZE, (void *)3, 3, NULL);
+    vTaskDelay(10);
+    CHECK(orderCount == 4 && order[0] == 2 && order[1] == 3 && order[2] == 5 && order[3] == 7);
+
+    /* Event list: the highest priority receiver gets the first item. */
+    queue = xQueueCreate(1, sizeof(int));
+    xTaskCreate(receiver, "r1", configMINIMAL_STACK_SIZE, NULL, 1, NULL);
+    xTaskCreate(receiver, "r4", configMINIMAL_STACK_SIZE, NULL, 4, NULL);
+    xTaskCreate(receiver, "r3", configMINIMAL_STACK_SIZE, NULL, 3, NULL);
+    vTaskDelay(1);
+    for (value = 0; value < 3; value++)
+    {
+        xQueueSend(queue, &value, portMAX_DELAY);
+        vTaskDelay(1);
+    }
+    CHECK(woken[0] == 4 && woken[1] == 3 && woken[2] == 1);
+
+    /* Timer list. */
+    start = xTaskGetTickCount();
+    for (int i = 0; i < 3; i++)
+    {
+        timers[i] = xTimerCreate("t", (TickType_t)(9 - 3 * i), pdFALSE, (void *)(intptr_t)i, timer_callback);
+        xTimerStart(timers[i], 0);
+    }
+    vTaskDelay(12);
+    CHECK(expiries[0] == (int)(start + 9) && expiries[1] == (int)(start + 6) && expiries[2] == (int)(start + 3));
+
+    /* Timing: two tasks of one priority above this one yield to each
+       other, so every taskYIELD() is a switch, until they suspend. */
+    vTaskSuspendAll();
+    xTaskCreate(yielder, "ya", configMINIMAL_STACK_SIZE, (void *)0, 3, &yielders[0]);
+    xTaskCreate(yielder, "yb", configMINIMAL_STACK_SIZE, (void *)1, 3, &yielders[1]);
+    t0 = now_ns();
+    xTaskResumeAll();
+    CHECK(switches == SWITCHES);
+    switchNs = (yieldEnd - t0) / SWITCHES;
+    vTaskDelete(yielders[0]);
+    vTaskDelete(yielders[1]);
+
+    t0 = now_ns();
+    for (uint32_t round = 0; round < INSERT_ROUNDS; round++)
+    {
+        fill_sorted(round, 0);
+    }
+    insertNs = (now_ns() - t0) / ((uint64_t)INSERT_ROUNDS * ITEMS);
+
+    printf("configUSE_COMPACT_LIST_ITEMS %d: ListItem_t %u, List_t %u, TCB %u, timer %u, queue %u bytes\n",
+           configUSE_COMPACT_LIST_ITEMS, (unsigned)sizeof(ListItem_t), (unsigned)sizeof(List_t),
+           (unsigned)sizeof(StaticTask_t), (unsigned)sizeof(StaticTimer_t), (unsigned)sizeof(StaticQueue_t));
+    printf("  yield between two tasks: %4lu ns, vListInsert + remove: %4lu ns\n",
+           (unsigned long)switchNs, (unsigned long)insertNs);
+
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    exit(fails ? 1 : 0);
+}
+
+int main(void)
+{
+    xTaskCreate(main_task, "main", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+    vTaskStartScheduler();
+    return 2;
+}
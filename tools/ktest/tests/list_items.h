@@ -0,0 +1,2 @@
+/* Kernel settings for list_items.c, reference build. */
+#define configUSE_COMPACT_LIST_ITEMS			0
@@ -0,0 +1,2 @@
+/* Kernel settings for list_items.c, compact build. */
+#define configUSE_COMPACT_LIST_ITEMS			1
@@ -0,0 +1,211 @@
+/*=====================================================================
+ *  message_queues - variable length message queues (message_queue.c)
+ *
+ *    - three senders and three receivers of different priorities pass
+ *      messages of 1 to 200 bytes through a queue that only holds a
+ *      few; every message must arrive once, whole and in order,
+ *    - a read that frees room for a short message but not a long one
+ *      must let the short message's sender in, although a sender of
+ *      higher priority with a longer message is waiting too,
+ *    - the ISR functions, a receive buffer too short for the next
+ *      message, and time outs on both sides.
+ *=====================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "message_queue.h"
+
+#define SENDERS     3
+#define RECEIVERS   3
+#define MESSAGES    3000
+
+#define CHECK(x) \
+    do { if (!(x)) { fails++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+static int fails;
+
+static StaticMessageQueue_t queueBuffer;
+static uint8_t storage[700];
+static MessageQueueHandle_t queue, small;
+
+static volatile int sendersDone, receiversDone;
+static volatile int received[RECEIVERS];
+static volatile int errors;
+static volatile BaseType_t longResult, shortResult;
+static volatile int longDone, shortDone;
+
+static size_t length_of(int sender, int i)
+{
+    return 1 + (size_t)((i * 53 + sender * 17) % 200);
+}
+
+static void sender(void *argument)
+{
+    int self = (int)(intptr_t)argument;
+    uint8_t buffer[256];
+
+    for (int i = 0; i < MESSAGES; i++)
+    {
+        size_t n = length_of(self, i);
+
+        memset(buffer, (uint8_t)(self * 31 + i), n);
+        buffer[0] = (uint8_t)self;
+        if (n >= 3)
+        {
+            buffer[1] = (uint8_t)(i & 0xff);
+            buffer[2] = (uint8_t)(i >> 8);
+        }
+        if (xMessageQueueSend(queue, buffer, n, portMAX_DELAY) != pdPASS)
+        {
+            errors++;
+        }
+    }
+    sendersDone++;
+    vTaskDelete(NULL);
+}
+
+static void receiver(void *argument)
+{
+    int self = (int)(intptr_t)argument;
+    int last[SENDERS] = { -1, -1, -1 };
+    uint8_t buffer[256];
+
+    for (;;)
+    {
+        size_t n = xMessageQueueReceive(queue, buffer, sizeof(buffer), 50);
+        int from, i;
+
+        if (n == 0)
+        {
+            if (sendersDone == SENDERS)
+            {
+                break;
+            }
+            continue;
+        }
+
+        from = buffer[0];
+        if (from >= SENDERS)
+        {
+            errors++;
+            continue;
+        }
+        if (n >= 3)
+        {
+            /* Messages from one sender are read in the order sent, even
+               by different receivers. */
+            i = buffer[1] | (buffer[2] << 8);
+            if (i <= last[from] || length_of(from, i) != n)
+            {
+                errors++;
+            }
+            for (size_t k = 3; k < n; k++)
+            {
+                if (buffer[k] != (uint8_t)(from * 31 + i))
+                {
+                    errors++;
+                    break;
+                }
+            }
+            last[from] = i;
+        }
+        received[self]++;
+    }
+    receiversDone++;
+    vTaskDelete(NULL);
+}
+
+static void long_sender(void *argument)
+{
+    uint8_t message[15] = { 0 };
+
+    (void)argument;
+    longResult = xMessageQueueSend(small, message, sizeof(message), 50);
+    longDone = 1;
+    vTaskDelete(NULL);
+}
+
+static void short_sender(void *argument)
+{
+    uint8_t message[5] = { 0 };
+
+    (void)argument;
+    shortResult = xMessageQueueSend(small, message, sizeof(message), 50);
+    shortDone = 1;
+    vTaskDelete(NULL);
+}
+
+static void main_task(void *argument)
+{
+    uint8_t buffer[100] = { 0 };
+    BaseType_t woken = pdFALSE;
+    TickType_t start;
+
+    (void)argument;
+
+    /* Many senders and receivers. */
+    queue = xMessageQueueCreateStatic(sizeof(storage), storage, &queueBuffer);
+    for (int i = 0; i < SENDERS; i++)
+    {
+        xTaskCreate(sender, "s", configMINIMAL_STACK_SIZE, (void *)(intptr_t)i, 3 + (i == 2), NULL);
+    }
+    for (int i = 0; i < RECEIVERS; i++)
+    {
+        xTaskCreate(receiver, "r", configMINIMAL_STACK_SIZE, (void *)(intptr_t)i, 2 + i, NULL);
+    }
+    while (receiversDone < RECEIVERS)
+    {
+        vTaskDelay(10);
+    }
+    CHECK(errors == 0);
+    CHECK(received[0] + received[1] + received[2] == SENDERS * MESSAGES);
+    CHECK(uxMessageQueueMessagesWaiting(queue) == 0);
+
+    /* Room for the short message, not for the long one: the short
+       message's sender must not stay blocked behind the long one's. */
+    small = xMessageQueueCreate(mqSTORAGE_BYTES(2, 10));
+    CHECK(xMessageQueueSend(small, buffer, 10, 0) == pdPASS);
+    CHECK(xMessageQueueSend(small, buffer, 10, 0) == pdPASS);
+    xTaskCreate(long_sender, "long", configMINIMAL_STACK_SIZE, NULL, 4, NULL);
+    xTaskCreate(short_sender, "short", configMINIMAL_STACK_SIZE, NULL, 3, NULL);
+    CHECK(xMessageQueueReceive(small, buffer, sizeof(buffer), 0) == 10);
+    vTaskDelay(1);
+    CHECK(shortDone && shortResult == pdPASS && !longDone);
+    CHECK(xMessageQueueReceive(small, buffer, sizeof(buffer), 0) == 10);
+    vTaskDelay(1);
+    CHECK(longDone && longResult == pdPASS);
+    CHECK(uxMessageQueueMessagesWaiting(small) == 2);
+
+    /* Sending times out on a full queue. */
+    start = xTaskGetTickCount();
+    CHECK(xMessageQueueSend(small, buffer, 1, 3) == errQUEUE_FULL);
+    CHECK(xTaskGetTickCount() - start >= 3);
+    vMessageQueueDelete(small);
+
+    /* ISR functions, and a buffer too short for the next message. */
+    CHECK(xMessageQueueSendFromISR(queue, buffer, 100, &woken) == pdPASS);
+    CHECK(xMessageQueueNextLengthBytes(queue) == 100);
+    CHECK(xMessageQueueReceive(queue, buffer, 50, 10) == 0);
+    CHECK(uxMessageQueueMessagesWaiting(queue) == 1);
+    CHECK(xMessageQueueReceiveFromISR(queue, buffer, 100, &woken) == 100);
+    CHECK(xMessageQueueSpacesAvailable(queue) == sizeof(storage) - sizeof(configMESSAGE_BUFFER_LENGTH_TYPE));
+
+    /* Receiving times out on an empty queue. */
+    start = xTaskGetTickCount();
+    CHECK(xMessageQueueReceive(queue, buffer, 100, 7) == 0);
+    CHECK(xTaskGetTickCount() - start >= 7);
+
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    exit(fails ? 1 : 0);
+}
+
+int main(void)
+{
+    xTaskCreate(main_task, "main", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+    vTaskStartScheduler();
+    return 2;
+}
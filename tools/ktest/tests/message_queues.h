@@ -0,0 +1,2 @@
+/* Kernel settings for message_queues.c. */
+#define configUSE_MESSAGE_QUEUES				1
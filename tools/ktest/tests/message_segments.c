@@ -0,0 +1,146 @@
+/*=====================================================================
+ *  message_segments - messages sent and received in segments
+ *                     (xMessageBufferSendV(), xMessageBufferReceiveV())
+ *
+ *    - the segments of a send make one message, in order, whatever
+ *      zero-length segments there are among them, with or without data,
+ *    - a receive fills one segment after the other, skipping zero-length
+ *      ones, and leaves segments past the end of the message untouched,
+ *    - a message that wraps around the end of the buffer arrives whole,
+ *    - segments too short for the message, together, leave it in the
+ *      buffer for a later receive, and 0 is returned,
+ *    - a stream buffer read into segments takes what fits in them.
+ *=====================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+#include "message_buffer.h"
+
+#define SIZE        48
+#define MESSAGE     15
+#define FILL        0xEE
+
+/* xMessageBufferNextLengthBytes() ends in a ';' in V10.3.1, so cannot be
+   used in an expression. */
+#define next_length(buffer)     xStreamBufferNextMessageLengthBytes(buffer)
+
+#define CHECK(x) \
+    do { if (!(x)) { fails++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+static int fails;
+static uint8_t message[MESSAGE];
+static uint8_t header[3], payload[10], trailer[2];
+static uint8_t zero[1];
+static uint8_t out[4][SIZE];
+
+/* A header, a payload and a trailer, with two empty segments between. */
+static const StreamBufferSegment_t gather[] = {
+    { header, sizeof(header) },
+    { NULL, 0 },
+    { payload, sizeof(payload) },
+    { zero, 0 },
+    { trailer, sizeof(trailer) },
+};
+
+static size_t send(MessageBufferHandle_t buffer)
+{
+    return xMessageBufferSendV(buffer, gather, sizeof(gather) / sizeof(gather[0]), 0);
+}
+
+/* Receives into segments of the given lengths, out[0], out[1], ...;
+   returns what was received. */
+static size_t receive(MessageBufferHandle_t buffer, const size_t *lengths, UBaseType_t count)
+{
+    StreamBufferSegment_t scatter[4];
+
+    memset(out, FILL, sizeof(out));
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        scatter[i].pvData = out[i];
+        scatter[i].xLength = lengths[i];
+    }
+    return xMessageBufferReceiveV(buffer, scatter, count, 0);
+}
+
+/* Checks that out[index] holds length bytes of the message from offset,
+   and nothing after them. */
+static int holds(int index, size_t offset, size_t length)
+{
+    return memcmp(out[index], &message[offset], length) == 0 &&
+           (length == SIZE || out[index][length] == FILL);
+}
+
+static void main_task(void *argument)
+{
+    static const size_t scattered[] = { 4, 0, 5, 20 };
+    static const size_t exact[] = { MESSAGE };
+    static const size_t shortBy1[] = { 4, 0, 10 };
+    static const size_t spare[] = { 10, 10, 10 };
+    MessageBufferHandle_t buffer = xMessageBufferCreate(SIZE);
+    StreamBufferHandle_t stream = xStreamBufferCreate(SIZE, 1);
+    size_t available;
+
+    (void)argument;
+
+    for (int i = 0; i < MESSAGE; i++)
+    {
+        message[i] = (uint8_t)(i + 1);
+    }
+    memcpy(header, &message[0], sizeof(header));
+    memcpy(payload, &message[3], sizeof(payload));
+    memcpy(trailer, &message[13], sizeof(trailer));
+    CHECK(buffer != NULL && stream != NULL);
+
+    /* Gathered into one message, scattered over several segments. */
+    CHECK(send(buffer) == MESSAGE);
+    CHECK(next_length(buffer) == MESSAGE);
+    CHECK(receive(buffer, scattered, 4) == MESSAGE);
+    CHECK(holds(0, 0, 4) && out[1][0] == FILL && holds(2, 4, 5) && holds(3, 9, MESSAGE - 9));
+    CHECK(xMessageBufferIsEmpty(buffer));
+
+    /* Too short by a byte: the message stays where it is. */
+    CHECK(send(buffer) == MESSAGE);
+    available = xMessageBufferSpacesAvailable(buffer);
+    CHECK(receive(buffer, shortBy1, 3) == 0);
+    CHECK(xMessageBufferSpacesAvailable(buffer) == available);
+    CHECK(next_length(buffer) == MESSAGE);
+    CHECK(receive(buffer, exact, 1) == MESSAGE && holds(0, 0, MESSAGE));
+
+    /* More room than the message: the last segments are left alone. */
+    CHECK(send(buffer) == MESSAGE);
+    CHECK(receive(buffer, spare, 3) == MESSAGE);
+    CHECK(holds(0, 0, 10) && holds(1, 10, MESSAGE - 10) && out[2][0] == FILL);
+
+    /* Each message is 15 bytes and its length, so the head and the tail
+       move round the buffer and messages wrap at different places. */
+    for (int i = 0; i < 8; i++)
+    {
+        CHECK(send(buffer) == MESSAGE);
+        CHECK(receive(buffer, scattered, 4) == MESSAGE);
+        CHECK(holds(0, 0, 4) && holds(2, 4, 5) && holds(3, 9, MESSAGE - 9));
+    }
+
+    /* A stream buffer has no messages: segments take what they can hold. */
+    CHECK(xStreamBufferSendV(stream, gather, 5, 0) == MESSAGE);
+    CHECK(receive(stream, shortBy1, 3) == MESSAGE - 1);
+    CHECK(holds(0, 0, 4) && holds(2, 4, 10));
+    CHECK(xStreamBufferBytesAvailable(stream) == 1);
+
+    vMessageBufferDelete(buffer);
+    vStreamBufferDelete(stream);
+
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    exit(fails ? 1 : 0);
+}
+
+int main(void)
+{
+    xTaskCreate(main_task, "main", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+    vTaskStartScheduler();
+    return 2;
+}
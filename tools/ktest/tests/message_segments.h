@@ -0,0 +1 @@
+/* Kernel settings for message_segments.c: the base configuration. */
@@ -0,0 +1,163 @@
+/*=====================================================================
+ *  mpmc_queues - lock-free MPMC queues (mpmc_queue.c)
+ *
+ *  Built twice by the Makefile, with configUSE_OBJECT_LOCKS off and on.
+ *
+ *    - time outs on an empty and a full queue, and the ISR functions,
+ *    - three senders and four receivers of different priorities pass
+ *      items through a queue from the heap and a static one, both short
+ *      enough that senders and receivers block; every item must arrive
+ *      once and whole.
+ *
+ *  On this port tasks only switch where the kernel asks them to, so the
+ *  lock-free paths are never interleaved mid-operation: this checks the
+ *  blocking and waking around them, not the atomics.
+ *=====================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "mpmc_queue.h"
+
+#define ITEMS       2000
+#define SENDERS     3
+#define RECEIVERS   4
+
+#define CHECK(x) \
+    do { if (!(x)) { fails++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+#if (configUSE_OBJECT_LOCKS == 1)
+#define LOCKS_FREE() (xHostLocksHeld == 0 && xHostKernelLocks == 0)
+#else
+#define LOCKS_FREE() 1
+#endif
+
+typedef struct
+{
+    uint32_t value;
+    uint16_t sender;
+    uint8_t  marker;
+} item_t;
+
+static int fails;
+
+static MpmcQueueHandle_t heapQueue, staticQueue;
+static StaticMpmcQueue_t staticQueueBuffer;
+static size_t staticStorage[mpmcSTORAGE_WORDS(4, sizeof(item_t))];
+
+static volatile long sum;
+static volatile int received, errors, sendersDone, tasksDone;
+
+static void sender(void *argument)
+{
+    int self = (int)(intptr_t)argument;
+
+    for (int i = 1; i <= ITEMS; i++)
+    {
+        item_t item = { (uint32_t)i, (uint16_t)self, 0x5a };
+
+        if (xMpmcQueueSend((i & 1) ? heapQueue : staticQueue, &item, portMAX_DELAY) != pdPASS)
+        {
+            errors++;
+        }
+        if ((i % 97) == 0)
+        {
+            vTaskDelay(1);
+        }
+    }
+    sendersDone++;
+    tasksDone++;
+    vTaskDelete(NULL);
+}
+
+static void receiver(void *argument)
+{
+    MpmcQueueHandle_t queue = argument;
+    item_t item;
+
+    for (;;)
+    {
+        if (xMpmcQueueReceive(queue, &item, 50) == pdPASS)
+        {
+            if (item.marker != 0x5a || item.sender >= SENDERS)
+            {
+                errors++;
+            }
+            sum += item.value;
+            received++;
+        }
+        else if (sendersDone == SENDERS)
+        {
+            break;
+        }
+    }
+    tasksDone++;
+    vTaskDelete(NULL);
+}
+
+static void main_task(void *argument)
+{
+    item_t item = { 7, 0, 0x5a };
+    MpmcQueueHandle_t queue;
+    BaseType_t woken = pdFALSE;
+    TickType_t start;
+    long expected = (long)SENDERS * ITEMS * (ITEMS + 1) / 2;
+
+    (void)argument;
+
+    /* Time outs and the ISR functions. */
+    queue = xMpmcQueueCreate(2, sizeof(item_t));
+    CHECK(queue != NULL);
+    start = xTaskGetTickCount();
+    CHECK(xMpmcQueueReceive(queue, &item, 10) == pdFAIL);
+    CHECK(xTaskGetTickCount() - start >= 10);
+    CHECK(xMpmcQueueSendFromISR(queue, &item, &woken) == pdPASS);
+    CHECK(xMpmcQueueSendFromISR(queue, &item, &woken) == pdPASS);
+    CHECK(xMpmcQueueSendFromISR(queue, &item, &woken) == errQUEUE_FULL);
+    CHECK(uxMpmcQueueMessagesWaiting(queue) == 2);
+    start = xTaskGetTickCount();
+    CHECK(xMpmcQueueSend(queue, &item, 10) == errQUEUE_FULL);
+    CHECK(xTaskGetTickCount() - start >= 10);
+    CHECK(xMpmcQueueReceiveFromISR(queue, &item, &woken) == pdPASS);
+    CHECK(xMpmcQueueReceiveFromISR(queue, &item, &woken) == pdPASS);
+    CHECK(xMpmcQueueReceiveFromISR(queue, &item, &woken) == pdFAIL);
+    CHECK(uxMpmcQueueMessagesWaiting(queue) == 0);
+    vMpmcQueueDelete(queue);
+    CHECK(LOCKS_FREE());
+
+    /* Many senders and receivers. */
+    heapQueue = xMpmcQueueCreate(2, sizeof(item_t));
+    staticQueue = xMpmcQueueCreateStatic(4, sizeof(item_t), staticStorage, &staticQueueBuffer);
+    CHECK(heapQueue != NULL && staticQueue != NULL);
+    for (int i = 0; i < SENDERS; i++)
+    {
+        xTaskCreate(sender, "s", configMINIMAL_STACK_SIZE, (void *)(intptr_t)i, 1 + (i & 1), NULL);
+    }
+    for (int i = 0; i < RECEIVERS; i++)
+    {
+        xTaskCreate(receiver, "r", configMINIMAL_STACK_SIZE, (i & 1) ? heapQueue : staticQueue, 1 + (i >> 1), NULL);
+    }
+    while (tasksDone < SENDERS + RECEIVERS)
+    {
+        vTaskDelay(10);
+    }
+    CHECK(errors == 0);
+    CHECK(received == SENDERS * ITEMS && sum == expected);
+    CHECK(uxMpmcQueueMessagesWaiting(heapQueue) == 0 && uxMpmcQueueMessagesWaiting(staticQueue) == 0);
+    CHECK(LOCKS_FREE());
+    vMpmcQueueDelete(heapQueue);
+    vMpmcQueueDelete(staticQueue);
+
+    printf("configUSE_OBJECT_LOCKS %d\n", configUSE_OBJECT_LOCKS);
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    exit(fails ? 1 : 0);
+}
+
+int main(void)
+{
+    xTaskCreate(main_task, "main", configMINIMAL_STACK_SIZE, NULL, 3, NULL);
+    vTaskStartScheduler();
+    return 2;
+}
@@ -0,0 +1,2 @@
+/* Kernel settings for mpmc_queues.c. */
+#define configUSE_MPMC_QUEUES					1
@@ -0,0 +1,3 @@
+/* Kernel settings for mpmc_queues.c, with the per object locks. */
+#define configUSE_MPMC_QUEUES					1
+#define configUSE_OBJECT_LOCKS					1
@@ -0,0 +1,313 @@
+/*=====================================================================
+ *  object_locks - the kernel with and without configUSE_OBJECT_LOCKS
+ *
+ *  Built twice by the Makefile, once with each setting.  With the
+ *  locks on, port/portmacro.h aborts if a lock is released more often
+ *  than it was taken, if an object lock is taken while the kernel lock
+ *  is held, or if the kernel lock is taken with interrupts enabled.
+ *  Each step then checks that no lock is left held.
+ *
+ *    - a producer and a consumer pass data through every object type
+ *      that has its own lock: queue, mutex, queue set, stream and
+ *      message buffer, message queue, event group, and a timer,
+ *    - the paths in tasks.c that take a blocked task off its event
+ *      list: vTaskDelete(), vTaskSuspend(), xTaskAbortDelay(), a time
+ *      out in the tick, and a wake with the scheduler suspended that
+ *      xTaskResumeAll() finishes,
+ *    - priority inheritance, and disinheritance after a time out,
+ *    - the ISR safe paths: xTaskResumeFromISR() and notifications.
+ *=====================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "timers.h"
+#include "event_groups.h"
+#include "stream_buffer.h"
+#include "message_buffer.h"
+#include "message_queue.h"
+
+#define ROUNDS      20
+
+#define CHECK(x) \
+    do { if (!(x)) { fails++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+#if (configUSE_OBJECT_LOCKS == 1)
+#define LOCKS_FREE() (xHostLocksHeld == 0 && xHostKernelLocks == 0)
+#else
+#define LOCKS_FREE() 1
+#endif
+
+static int fails;
+
+static QueueHandle_t queue, setMember, waitQueue;
+static SemaphoreHandle_t mutex;
+static QueueSetHandle_t set;
+static EventGroupHandle_t group;
+static StreamBufferHandle_t stream;
+static MessageBufferHandle_t messages;
+static MessageQueueHandle_t messageQueue;
+
+static volatile int queueSum, streamSum, messageBytes, messageQueueBytes, setHits, syncs, timerHits;
+static volatile int producerDone, consumerDone;
+static volatile BaseType_t waitResult;
+static volatile int waitReturned;
+
+static void timer_callback(TimerHandle_t timer)
+{
+    (void)timer;
+    timerHits++;
+}
+
+static void producer(void *argument)
+{
+    (void)argument;
+
+    for (int i = 1; i <= ROUNDS; i++)
+    {
+        uint8_t byte = (uint8_t)i;
+
+        xQueueSend(queue, &i, portMAX_DELAY);
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        vTaskDelay(1);
+        xSemaphoreGive(mutex);
+        xStreamBufferSend(stream, &byte, 1, portMAX_DELAY);
+        xMessageBufferSend(messages, "abc", 3, portMAX_DELAY);
+        xMessageQueueSend(messageQueue, "hello", 5, portMAX_DELAY);
+        xQueueSend(setMember, &i, portMAX_DELAY);
+        xEventGroupSetBits(group, 1);
+        xEventGroupSync(group, 2, 6, 100);
+    }
+    producerDone = 1;
+    vTaskDelete(NULL);
+}
+
+static void consumer(void *argument)
+{
+    uint8_t buffer[8];
+    int value;
+
+    (void)argument;
+
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        xQueueReceive(queue, &value, portMAX_DELAY);
+        queueSum += value;
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        xSemaphoreGive(mutex);
+        xStreamBufferReceive(stream, buffer, 1, portMAX_DELAY);
+        streamSum += buffer[0];
+        messageBytes += (int)xMessageBufferReceive(messages, buffer, sizeof(buffer), portMAX_DELAY);
+        messageQueueBytes += (int)xMessageQueueReceive(messageQueue, buffer, sizeof(buffer), portMAX_DELAY);
+        if (xQueueSelectFromSet(set, portMAX_DELAY) == setMember && xQueueReceive(setMember, &value, 0) == pdPASS)
+        {
+            setHits++;
+        }
+        xEventGroupWaitBits(group, 1, pdTRUE, pdTRUE, portMAX_DELAY);
+        if ((xEventGroupSync(group, 4, 6, 100) & 6) == 6)
+        {
+            syncs++;
+        }
+    }
+    consumerDone = 1;
+    vTaskDelete(NULL);
+}
+
+/* Blocks on waitQueue with the given timeout and records the result. */
+static void waiter(void *argument)
+{
+    int value;
+
+    waitResult = xQueueReceive(waitQueue, &value, (TickType_t)(intptr_t)argument);
+    waitReturned++;
+    vTaskDelete(NULL);
+}
+
+static void mutex_holder(void *argument)
+{
+    (void)argument;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    vTaskSuspend(NULL);
+    xSemaphoreGive(mutex);
+    vTaskDelete(NULL);
+}
+
+static void mutex_waiter(void *argument)
+{
+    (void)argument;
+
+    waitResult = xSemaphoreTake(mutex, 5);
+    waitReturned++;
+    vTaskDelete(NULL);
+}
+
+static void self_suspender(void *argument)
+{
+    (void)argument;
+
+    for (;;)
+    {
+        vTaskSuspend(NULL);
+        waitReturned++;
+    }
+}
+
+static void notified(void *argument)
+{
+    (void)argument;
+
+    for (;;)
+    {
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        waitReturned++;
+    }
+}
+
+static TaskHandle_t start_waiter(TickType_t timeout, UBaseType_t priority)
+{
+    TaskHandle_t task;
+
+    waitReturned = 0;
+    xTaskCreate(waiter, "w", configMINIMAL_STACK_SIZE, (void *)(intptr_t)timeout, priority, &task);
+    vTaskDelay(1);
+    return task;
+}
+
+static void main_task(void *argument)
+{
+    TimerHandle_t timer;
+    TaskHandle_t task, holder;
+    BaseType_t woken;
+    int value = 7;
+
+    (void)argument;
+
+    /* Every object type, between two tasks. */
+    queue = xQueueCreate(2, sizeof(int));
+    mutex = xSemaphoreCreateMutex();
+    group = xEventGroupCreate();
+    stream = xStreamBufferCreate(4, 1);
+    messages = xMessageBufferCreate(16);
+    messageQueue = xMessageQueueCreate(32);
+    set = xQueueCreateSet(2);
+    setMember = xQueueCreate(2, sizeof(int));
+    xQueueAddToSet(setMember, set);
+    timer = xTimerCreate("t", 2, pdTRUE, NULL, timer_callback);
+    xTimerStart(timer, 0);
+
+    xTaskCreate(producer, "p", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+    xTaskCreate(consumer, "c", configMINIMAL_STACK_SIZE, NULL, 1, NULL);
+    while (!producerDone || !consumerDone)
+    {
+        vTaskDelay(5);
+    }
+    xTimerStop(timer, 0);
+    vTaskDelay(1);
+    CHECK(queueSum == ROUNDS * (ROUNDS + 1) / 2 && streamSum == ROUNDS * (ROUNDS + 1) / 2);
+    CHECK(messageBytes == 3 * ROUNDS && messageQueueBytes == 5 * ROUNDS);
+    CHECK(setHits == ROUNDS && syncs == ROUNDS && timerHits > 5);
+    CHECK(LOCKS_FREE());
+
+    waitQueue = xQueueCreate(1, sizeof(int));
+
+    /* vTaskDelete() of a task blocked on a queue: the item sent after it
+       stays in the queue. */
+    task = start_waiter(100, 4);
+    vTaskDelete(task);
+    vTaskDelay(1);
+    xQueueSend(waitQueue, &value, 0);
+    CHECK(uxQueueMessagesWaiting(waitQueue) == 1 && waitReturned == 0);
+    xQueueReset(waitQueue);
+    CHECK(LOCKS_FREE());
+
+    /* vTaskSuspend() of a blocked task takes it off the event list.  Once
+       resumed it blocks again for the rest of its time out. */
+    task = start_waiter(100, 4);
+    vTaskSuspend(task);
+    CHECK(eTaskGetState(task) == eSuspended);
+    xQueueSend(waitQueue, &value, 0);
+    CHECK(uxQueueMessagesWaiting(waitQueue) == 1 && waitReturned == 0);
+    xQueueReset(waitQueue);
+    vTaskResume(task);
+    CHECK(eTaskGetState(task) == eBlocked);
+    xQueueSend(waitQueue, &value, 0);
+    CHECK(waitReturned == 1 && waitResult == pdPASS);
+    CHECK(LOCKS_FREE());
+
+    /* xTaskAbortDelay(). */
+    task = start_waiter(100, 4);
+    CHECK(xTaskAbortDelay(task) == pdPASS);
+    vTaskDelay(1);
+    CHECK(waitReturned == 1 && waitResult == pdFAIL);
+    CHECK(LOCKS_FREE());
+
+    /* A time out in the tick. */
+    start_waiter(3, 4);
+    vTaskDelay(5);
+    CHECK(waitReturned == 1 && waitResult == pdFAIL);
+    CHECK(LOCKS_FREE());
+
+    /* Woken from an ISR with the scheduler suspended: the task waits on
+       the pending ready list until xTaskResumeAll(). */
+    start_waiter(100, 4);
+    vTaskSuspendAll();
+    woken = pdFALSE;
+    xQueueSendFromISR(waitQueue, &value, &woken);
+    CHECK(woken == pdTRUE && waitReturned == 0);
+    xTaskResumeAll();
+    CHECK(waitReturned == 1 && waitResult == pdPASS);
+    CHECK(LOCKS_FREE());
+
+    /* Priority inheritance, and disinheritance after the waiter times
+       out. */
+    xTaskCreate(mutex_holder, "h", configMINIMAL_STACK_SIZE, NULL, 1, &holder);
+    vTaskDelay(1);
+    CHECK(xSemaphoreGetMutexHolder(mutex) == holder);
+    waitReturned = 0;
+    xTaskCreate(mutex_waiter, "mw", configMINIMAL_STACK_SIZE, NULL, 4, NULL);
+    CHECK(uxTaskPriorityGet(holder) == 4);
+    vTaskDelay(7);
+    CHECK(waitReturned == 1 && waitResult == pdFAIL);
+    CHECK(uxTaskPriorityGet(holder) == 1);
+    vTaskResume(holder);
+    vTaskDelay(2);
+    CHECK(xSemaphoreGetMutexHolder(mutex) == NULL);
+    CHECK(LOCKS_FREE());
+
+    /* The ISR safe paths into the ready lists. */
+    waitReturned = 0;
+    xTaskCreate(self_suspender, "s", configMINIMAL_STACK_SIZE, NULL, 4, &task);
+    CHECK(xTaskResumeFromISR(task) == pdTRUE);
+    taskYIELD();
+    CHECK(waitReturned == 1);
+    vTaskDelete(task);
+
+    waitReturned = 0;
+    xTaskCreate(notified, "n", configMINIMAL_STACK_SIZE, NULL, 4, &task);
+    woken = pdFALSE;
+    vTaskNotifyGiveFromISR(task, &woken);
+    CHECK(woken == pdTRUE);
+    portYIELD_FROM_ISR(woken);
+    woken = pdFALSE;
+    xTaskNotifyFromISR(task, 0, eIncrement, &woken);
+    portYIELD_FROM_ISR(woken);
+    CHECK(waitReturned == 2);
+    vTaskDelete(task);
+    CHECK(LOCKS_FREE());
+
+    printf("configUSE_OBJECT_LOCKS %d\n", configUSE_OBJECT_LOCKS);
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    exit(fails ? 1 : 0);
+}
+
+int main(void)
+{
+    xTaskCreate(main_task, "main", configMINIMAL_STACK_SIZE, NULL, 3, NULL);
+    vTaskStartScheduler();
+    return 2;
+}
@@ -0,0 +1,7 @@
+/* Kernel settings for object_locks.c, with the per object locks. */
+#define configUSE_OBJECT_LOCKS					1
+#define configUSE_QUEUE_SETS					1
+#define configUSE_MESSAGE_QUEUES				1
+#define INCLUDE_xTaskAbortDelay					1
+#define INCLUDE_xTaskResumeFromISR				1
+#define INCLUDE_xSemaphoreGetMutexHolder		1
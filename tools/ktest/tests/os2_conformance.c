@@ -0,0 +1,490 @@
+/*=====================================================================
+ *  os2_conformance - CMSIS-RTOS2 layer (CMSIS_RTOS_V2/cmsis_os2.c)
+ *
+ *  Checks the return values and side effects the CMSIS-RTOS2 API
+ *  specifies for each object type, in thread mode and, through the
+ *  IPSR stand-in in port/cmsis_compiler.h, in handler mode:
+ *
+ *    - kernel state, lock/unlock, tick and SysTick based system timer,
+ *    - thread creation from static and heap memory, including the
+ *      attribute combinations that must be refused,
+ *    - thread flags (partial osFlagsWaitAll matches are kept),
+ *    - event flags, mutexes, semaphores, timers,
+ *    - memory pools and pointer message queues (the zero-copy path).
+ *
+ *  It then times a thread flags round trip between two threads, with
+ *  the same exchange made straight through task notifications as the
+ *  reference, so the cost of the layer itself is visible.  Host
+ *  figures, useful for comparing the two, not as target timings.
+ *=====================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmsis_os2.h"
+
+#define ROUND_TRIPS     20000
+
+#define CHECK(x) \
+    do { if (!(x)) { fails++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+/* Core registers read by the layer, see port/cmsis_compiler.h. */
+volatile uint32_t ulHostIPSR;
+volatile uint32_t ulHostPRIMASK;
+volatile uint32_t ulHostSysTickLoad;
+volatile uint32_t ulHostSysTickValue;
+volatile uint32_t ulHostICSR;
+
+static int fails;
+
+static StaticTask_t mainCb, peerCb;
+static StackType_t mainStack[configMINIMAL_STACK_SIZE * 2];
+static StackType_t peerStack[configMINIMAL_STACK_SIZE * 2];
+static osThreadId_t mainId, peerId;
+
+static osEventFlagsId_t events;
+static osMessageQueueId_t blocks;
+static osMemoryPoolId_t pool;
+static volatile int peerStage;
+static volatile uint32_t peerEvents;
+static volatile int timerHits;
+
+static uint64_t now_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+/* Calls made between these two behave as in an interrupt handler: the
+   layer sees a non-zero IPSR, and a context switch the call asks for is
+   taken when the handler returns. */
+static void isr_enter(void)
+{
+    portENTER_CRITICAL();
+    ulHostIPSR = 15U;
+}
+
+static void isr_exit(void)
+{
+    ulHostIPSR = 0U;
+    portEXIT_CRITICAL();
+}
+
+static void timer_callback(void *argument)
+{
+    timerHits += (int)(intptr_t)argument;
+}
+
+static void dummy_thread(void *argument)
+{
+    (void)argument;
+    osThreadExit();
+}
+
+/* -------------------------------------------------------------------
+ * Peer thread: answers flags, waits on event flags, then frees the
+ * pool blocks main sends it.
+ * ------------------------------------------------------------------- */
+static void peer_thread(void *argument)
+{
+    (void)argument;
+
+    for (;;)
+    {
+        uint32_t flags = osThreadFlagsWait(0x3U, osFlagsWaitAny, osWaitForever);
+
+        if ((flags & 0x2U) != 0U)
+        {
+            break;
+        }
+        osThreadFlagsSet(mainId, 0x1U);
+    }
+
+    /* The same exchange through the kernel API, as the reference. */
+    for (;;)
+    {
+        uint32_t value;
+
+        xTaskNotifyWait(0U, 0xFFFFFFFFU, &value, portMAX_DELAY);
+        if (value == 2U)
+        {
+            break;
+        }
+        xTaskNotify((TaskHandle_t)mainId, 1U, eSetBits);
+    }
+
+    peerEvents = osEventFlagsWait(events, 0x5U, osFlagsWaitAll, 1000U);
+    peerStage = 1;
+
+    for (int i = 0; i < 3; i++)
+    {
+        char *block = NULL;
+
+        CHECK(osMessageQueueGet(blocks, &block, NULL, 1000U) == osOK);
+        CHECK(block != NULL && block[0] == 'a' + i);
+        CHECK(osMemoryPoolFree(pool, block) == osOK);
+    }
+    peerStage = 2;
+
+    osThreadExit();
+}
+
+/* -------------------------------------------------------------------
+ * Checks, one function per object type.
+ * ------------------------------------------------------------------- */
+static void check_threads(void)
+{
+    static StaticTask_t cb;
+    static StackType_t stack[configMINIMAL_STACK_SIZE];
+    osThreadAttr_t attr;
+
+    CHECK(osThreadGetPriority(mainId) == osPriorityNormal);
+    CHECK(strcmp(osThreadGetName(mainId), "main") == 0);
+
+    /* Memory must be given as a whole: control block and stack, each
+       with its size. */
+    memset(&attr, 0, sizeof(attr));
+    attr.stack_mem = stack;
+    CHECK(osThreadNew(dummy_thread, NULL, &attr) == NULL);
+    attr.cb_mem = &cb;
+    attr.cb_size = sizeof(cb);
+    CHECK(osThreadNew(dummy_thread, NULL, &attr) == NULL);      /* stack_size 0 */
+    attr.stack_size = 2U;
+    CHECK(osThreadNew(dummy_thread, NULL, &attr) == NULL);      /* under one word */
+    attr.stack_mem = NULL;
+    attr.stack_size = sizeof(stack);
+    CHECK(osThreadNew(dummy_thread, NULL, &attr) == NULL);      /* no stack_mem */
+    attr.cb_size = 4U;
+    attr.stack_mem = stack;
+    CHECK(osThreadNew(dummy_thread, NULL, &attr) == NULL);      /* cb too small */
+    attr.cb_size = sizeof(cb);
+    attr.attr_bits = osThreadJoinable;
+    CHECK(osThreadNew(dummy_thread, NULL, &attr) == NULL);
+    attr.attr_bits = 0U;
+    attr.priority = (osPriority_t)100;
+    CHECK(osThreadNew(dummy_thread, NULL, &attr) == NULL);
+
+    attr.priority = osPriorityLow;
+    CHECK(osThreadNew(dummy_thread, NULL, &attr) != NULL);
+    osDelay(1U);
+    CHECK(osThreadGetCount() == 3U);    /* main, idle and the timer task */
+
+    isr_enter();
+    CHECK(osThreadNew(dummy_thread, NULL, NULL) == NULL);
+    CHECK(osDelay(1U) == osErrorISR);
+    CHECK(osThreadYield() == osErrorISR);
+    CHECK(osThreadSuspend(mainId) == osErrorISR);
+    CHECK(osThreadGetId() == mainId);
+    isr_exit();
+}
+
+static void check_thread_flags(void)
+{
+    CHECK(osThreadFlagsSet(mainId, 0x10U) == 0x10U);
+    CHECK(osThreadFlagsGet() == 0x10U);
+    CHECK(osThreadFlagsWait(0x30U, osFlagsWaitAll, 0U) == osFlagsErrorResource);
+    CHECK(osThreadFlagsGet() == 0x10U);         /* the partial match is kept */
+    CHECK(osThreadFlagsWait(0x30U, osFlagsWaitAll, 5U) == osFlagsErrorTimeout);
+    CHECK(osThreadFlagsWait(0x30U, osFlagsWaitAny | osFlagsNoClear, 0U) == 0x10U);
+    CHECK(osThreadFlagsWait(0x30U, osFlagsWaitAny, 0U) == 0x10U);
+    CHECK(osThreadFlagsGet() == 0U);
+    CHECK(osThreadFlagsSet(mainId, 0x80000000U) == osFlagsErrorParameter);
+    CHECK(osThreadFlagsClear(0x1U) == 0U);
+
+    /* Set from an interrupt, waited for in the thread. */
+    isr_enter();
+    CHECK(osThreadFlagsSet(mainId, 0x4U) == 0x4U);
+    CHECK(osThreadFlagsWait(0x4U, osFlagsWaitAny, 0U) == osFlagsErrorISR);
+    CHECK(osThreadFlagsClear(0x4U) == osFlagsErrorISR);
+    isr_exit();
+    CHECK(osThreadFlagsWait(0x4U, osFlagsWaitAny, 0U) == 0x4U);
+}
+
+static void check_kernel(void)
+{
+    uint32_t tick;
+    osVersion_t version;
+    char id[32];
+
+    CHECK(osKernelGetState() == osKernelRunning);
+    CHECK(osKernelLock() == 0 && osKernelGetState() == osKernelLocked);
+    CHECK(osKernelLock() == 1);
+    CHECK(osKernelRestoreLock(0) == 0 && osKernelGetState() == osKernelRunning);
+    CHECK(osKernelUnlock() == 0);
+
+    tick = osKernelGetTickCount();
+    CHECK(osDelayUntil(tick + 5U) == osOK && osKernelGetTickCount() == tick + 5U);
+    CHECK(osDelayUntil(tick) == osErrorParameter);
+    CHECK(osKernelGetTickFreq() == configTICK_RATE_HZ);
+
+    osKernelGetInfo(&version, id, sizeof(id));
+    CHECK(version.api == 20010003U && strncmp(id, "FreeRTOS V", 10) == 0);
+
+    /* System timer: ticks times the SysTick period plus the count since
+       the last tick, including a wrap whose tick is still pending. */
+    ulHostSysTickLoad = 999U;
+    ulHostSysTickValue = 999U - 250U;
+    ulHostICSR = 0U;
+    tick = osKernelGetTickCount();
+    CHECK(osKernelGetSysTimerCount() == tick * 1000U + 250U);
+    ulHostICSR = 1UL << 26U;
+    CHECK(osKernelGetSysTimerCount() == (tick + 1U) * 1000U + 250U);
+    ulHostICSR = 0U;
+    CHECK(ulHostPRIMASK == 0U);     /* the interrupt mask is restored */
+
+    isr_enter();
+    CHECK(osKernelLock() == (int32_t)osErrorISR);
+    CHECK(osKernelGetTickCount() == tick);
+    isr_exit();
+}
+
+static void check_event_flags(void)
+{
+    static StaticEventGroup_t cb;
+    osEventFlagsAttr_t attr = { "ev", 0U, &cb, sizeof(cb) };
+
+    events = osEventFlagsNew(&attr);
+    CHECK(events != NULL);
+    CHECK(osEventFlagsGetName(events) == NULL);    /* event groups keep no name */
+    CHECK(osEventFlagsSet(events, 0x01000000U) == osFlagsErrorParameter);
+    attr.cb_size = 4U;
+    CHECK(osEventFlagsNew(&attr) == NULL);
+}
+
+static void check_pool_and_queue(void)
+{
+    static StaticQueue_t queueCb;
+    static char *queueMem[4];
+    static osStaticMemoryPool_t poolCb;
+    static uint8_t poolMem[osMemoryPoolMemSize(3, 5)] __attribute__((aligned(8)));
+    osMessageQueueAttr_t queueAttr = { "mq", 0U, &queueCb, sizeof(queueCb), queueMem, sizeof(queueMem) };
+    osMemoryPoolAttr_t poolAttr = { "mp", 0U, &poolCb, sizeof(poolCb), poolMem, sizeof(poolMem) };
+    char *block = NULL;
+
+    blocks = osMessageQueueNew(4U, sizeof(char *), &queueAttr);
+    CHECK(blocks != NULL);
+    CHECK(osMessageQueueGetCapacity(blocks) == 4U && osMessageQueueGetMsgSize(blocks) == sizeof(char *));
+    CHECK(strcmp(osMessageQueueGetName(blocks), "mq") == 0);
+    queueAttr.mq_size = 8U;
+    CHECK(osMessageQueueNew(4U, sizeof(char *), &queueAttr) == NULL);
+
+    pool = osMemoryPoolNew(3U, 5U, &poolAttr);
+    CHECK(pool != NULL);
+    CHECK(osMemoryPoolGetCapacity(pool) == 3U && osMemoryPoolGetBlockSize(pool) == osMemoryPoolBlockSize(5));
+    CHECK(osMemoryPoolFree(pool, poolMem) == osErrorResource);         /* not allocated */
+    CHECK(osMemoryPoolFree(pool, poolMem + 1) == osErrorParameter);    /* not a block */
+
+    /* From an interrupt: no waiting, but allocation and messages work. */
+    isr_enter();
+    CHECK(osMemoryPoolAlloc(pool, 1U) == NULL);
+    block = osMemoryPoolAlloc(pool, 0U);
+    CHECK(block != NULL);
+    CHECK(osMessageQueuePut(blocks, &block, 0U, 1U) == osErrorParameter);
+    CHECK(osMessageQueuePut(blocks, &block, 0U, 0U) == osOK);
+    CHECK(osMessageQueueGetCount(blocks) == 1U && osMessageQueueGetSpace(blocks) == 3U);
+    CHECK(osMessageQueueReset(blocks) == osErrorISR);
+    isr_exit();
+    block = NULL;
+    CHECK(osMessageQueueGet(blocks, &block, NULL, 0U) == osOK && block != NULL);
+    CHECK(osMemoryPoolFree(pool, block) == osOK);
+    CHECK(osMessageQueueGet(blocks, &block, NULL, 2U) == osErrorTimeout);
+}
+
+static void check_mutexes(void)
+{
+    static StaticSemaphore_t cb;
+    osMutexAttr_t attr = { "m", osMutexRecursive, &cb, sizeof(cb) };
+    osMutexAttr_t bad = { NULL, 0U, &cb, 4U };
+    osMutexId_t mutex;
+
+    mutex = osMutexNew(&attr);
+    CHECK(mutex != NULL);
+    CHECK(osMutexAcquire(mutex, 0U) == osOK && osMutexAcquire(mutex, 0U) == osOK);
+    CHECK(osMutexGetOwner(mutex) == mainId);
+    CHECK(strcmp(osMutexGetName(mutex), "m") == 0);
+    CHECK(osMutexRelease(mutex) == osOK && osMutexRelease(mutex) == osOK);
+    CHECK(osMutexRelease(mutex) == osErrorResource);
+    CHECK(osMutexGetOwner(mutex) == NULL);
+    CHECK(osMutexDelete(mutex) == osOK);
+
+    mutex = osMutexNew(NULL);
+    CHECK(mutex != NULL);
+    CHECK(osMutexRelease(mutex) == osErrorResource);
+    CHECK(osMutexAcquire(mutex, 0U) == osOK);
+    isr_enter();
+    CHECK(osMutexAcquire(mutex, 0U) == osErrorISR);
+    CHECK(osMutexRelease(mutex) == osErrorISR);
+    CHECK(osMutexGetOwner(mutex) == mainId);
+    isr_exit();
+    CHECK(osMutexRelease(mutex) == osOK);
+    CHECK(osMutexDelete(mutex) == osOK);
+
+    CHECK(osMutexNew(&bad) == NULL);
+}
+
+static void check_semaphores(void)
+{
+    static StaticSemaphore_t cb;
+    osSemaphoreAttr_t attr = { "s", 0U, &cb, sizeof(cb) };
+    osSemaphoreId_t binary, counting;
+
+    CHECK(osSemaphoreNew(0U, 0U, NULL) == NULL);
+    CHECK(osSemaphoreNew(1U, 2U, NULL) == NULL);
+
+    binary = osSemaphoreNew(1U, 1U, NULL);
+    CHECK(osSemaphoreGetCount(binary) == 1U && osSemaphoreRelease(binary) == osErrorResource);
+    CHECK(osSemaphoreAcquire(binary, 0U) == osOK && osSemaphoreAcquire(binary, 0U) == osErrorResource);
+    CHECK(osSemaphoreAcquire(binary, 2U) == osErrorTimeout);
+
+    counting = osSemaphoreNew(3U, 0U, &attr);
+    CHECK(strcmp(osSemaphoreGetName(counting), "s") == 0);
+    CHECK(osSemaphoreRelease(counting) == osOK && osSemaphoreRelease(counting) == osOK);
+    CHECK(osSemaphoreGetCount(counting) == 2U);
+
+    isr_enter();
+    CHECK(osSemaphoreAcquire(counting, 1U) == osErrorParameter);
+    CHECK(osSemaphoreAcquire(counting, 0U) == osOK);
+    CHECK(osSemaphoreRelease(binary) == osOK);
+    CHECK(osSemaphoreRelease(binary) == osErrorResource);
+    CHECK(osSemaphoreGetCount(counting) == 1U);
+    CHECK(osSemaphoreDelete(binary) == osErrorISR);
+    isr_exit();
+
+    CHECK(osSemaphoreDelete(binary) == osOK);
+    CHECK(osSemaphoreDelete(counting) == osOK);
+}
+
+static void check_timers(void)
+{
+    static osStaticTimer_t cb;
+    osTimerAttr_t attr = { "tm", 0U, &cb, sizeof(cb) };
+    osTimerId_t timer;
+    size_t freeHeap;
+
+    timer = osTimerNew(timer_callback, osTimerPeriodic, (void *)1, &attr);
+    CHECK(timer != NULL);
+    CHECK(strcmp(osTimerGetName(timer), "tm") == 0);
+    CHECK(osTimerIsRunning(timer) == 0U && osTimerStop(timer) == osErrorResource);
+    CHECK(osTimerStart(timer, 0U) == osErrorParameter);
+    CHECK(osTimerStart(timer, 2U) == osOK);
+    osDelay(11U);
+    CHECK(osTimerIsRunning(timer) == 1U && osTimerStop(timer) == osOK);
+    CHECK(timerHits == 5);
+    isr_enter();
+    CHECK(osTimerStart(timer, 2U) == osErrorISR);
+    isr_exit();
+    CHECK(osTimerDelete(timer) == osOK);
+
+    /* A heap control block is freed by the timer task after the delete. */
+    freeHeap = xPortGetFreeHeapSize();
+    timer = osTimerNew(timer_callback, osTimerOnce, (void *)100, NULL);
+    CHECK(osTimerStart(timer, 1U) == osOK);
+    osDelay(3U);
+    CHECK(timerHits == 105);
+    CHECK(osTimerDelete(timer) == osOK);
+    osDelay(2U);
+    CHECK(xPortGetFreeHeapSize() == freeHeap);
+}
+
+/* -------------------------------------------------------------------
+ * Main thread: the checks above, then the exchanges with the peer.
+ * ------------------------------------------------------------------- */
+static void main_thread(void *argument)
+{
+    osThreadAttr_t peerAttr = { "peer", 0U, &peerCb, sizeof(peerCb), peerStack, sizeof(peerStack),
+                                osPriorityAboveNormal, 0U, 0U };
+    uint64_t start, os2Ns, kernelNs;
+    char *sent[3];
+    void *block;
+    uint32_t value;
+
+    (void)argument;
+    mainId = osThreadGetId();
+
+    check_kernel();
+    check_threads();
+    check_thread_flags();
+    check_event_flags();
+    check_pool_and_queue();
+    check_mutexes();
+    check_semaphores();
+    check_timers();
+
+    peerId = osThreadNew(peer_thread, NULL, &peerAttr);
+    CHECK(peerId != NULL);
+    CHECK(osThreadGetPriority(peerId) == osPriorityAboveNormal);
+
+    /* Round trips: main wakes the higher priority peer, which answers. */
+    start = now_ns();
+    for (int i = 0; i < ROUND_TRIPS; i++)
+    {
+        osThreadFlagsSet(peerId, 0x1U);
+        CHECK(osThreadFlagsWait(0x1U, osFlagsWaitAny, 1000U) == 0x1U);
+    }
+    os2Ns = (now_ns() - start) / ROUND_TRIPS;
+    osThreadFlagsSet(peerId, 0x2U);
+
+    start = now_ns();
+    for (int i = 0; i < ROUND_TRIPS; i++)
+    {
+        xTaskNotify((TaskHandle_t)peerId, 1U, eSetBits);
+        xTaskNotifyWait(0U, 0xFFFFFFFFU, &value, portMAX_DELAY);
+    }
+    kernelNs = (now_ns() - start) / ROUND_TRIPS;
+    xTaskNotify((TaskHandle_t)peerId, 2U, eSetBits);
+
+    printf("round trip, thread flags:        %4lu ns\n", (unsigned long)os2Ns);
+    printf("round trip, task notifications:  %4lu ns\n", (unsigned long)kernelNs);
+
+    /* Event flags: the peer waits for all of 0x5. */
+    osEventFlagsSet(events, 0x1U);
+    CHECK(peerStage == 0);
+    osEventFlagsSet(events, 0x4U);
+    CHECK(peerStage == 1 && (peerEvents & 0x5U) == 0x5U);
+    CHECK(osEventFlagsGet(events) == 0U);
+    CHECK(osEventFlagsWait(events, 0x1U, osFlagsWaitAny, 0U) == osFlagsErrorResource);
+    CHECK(osEventFlagsWait(events, 0x1U, osFlagsWaitAny, 3U) == osFlagsErrorTimeout);
+
+    /* Zero-copy: pool blocks sent by pointer.  The pool is empty until
+       the peer frees them, so the last allocation blocks until then. */
+    osThreadSuspend(peerId);
+    for (int i = 0; i < 3; i++)
+    {
+        sent[i] = osMemoryPoolAlloc(pool, 0U);
+        CHECK(sent[i] != NULL);
+        sent[i][0] = (char)('a' + i);
+    }
+    CHECK(osMemoryPoolAlloc(pool, 0U) == NULL);
+    CHECK(osMemoryPoolGetCount(pool) == 3U && osMemoryPoolGetSpace(pool) == 0U);
+    for (int i = 0; i < 3; i++)
+    {
+        CHECK(osMessageQueuePut(blocks, &sent[i], 0U, 0U) == osOK);
+    }
+    CHECK(osMessageQueueGetCount(blocks) == 3U && osMessageQueueGetSpace(blocks) == 1U);
+    osThreadResume(peerId);
+    block = osMemoryPoolAlloc(pool, 100U);
+    CHECK(block != NULL && peerStage == 2);
+    CHECK(osMemoryPoolFree(pool, block) == osOK);
+    CHECK(osMemoryPoolGetSpace(pool) == 3U);
+
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    exit(fails ? 1 : 0);
+}
+
+int main(void)
+{
+    osThreadAttr_t attr = { "main", 0U, &mainCb, sizeof(mainCb), mainStack, sizeof(mainStack),
+                            osPriorityNone, 0U, 0U };
+
+    CHECK(osKernelGetState() == osKernelInactive);
+    CHECK(osKernelInitialize() == osOK && osKernelGetState() == osKernelReady);
+    CHECK(osKernelInitialize() == osError);
+    CHECK(osThreadNew(main_thread, NULL, &attr) != NULL);
+    osKernelStart();
+
+    return 2;
+}
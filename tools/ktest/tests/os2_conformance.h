@@ -0,0 +1,3 @@
+/* Kernel settings for os2_conformance.c. */
+#define configUSE_CMSIS_RTOS_V2					1
+#define INCLUDE_xSemaphoreGetMutexHolder		1
@@ -0,0 +1,179 @@
+/*=====================================================================
+ *  queue_items - queue items of every size up to 16 bytes
+ *                (configQUEUE_SIZED_COPY)
+ *
+ *  Built with the sized copy and without.  For each item size, on a
+ *  queue with static storage that is not aligned and on one from the
+ *  heap:
+ *
+ *    - every way of putting an item in and taking it out copies all of
+ *      its bytes and none past them, also when the read and write
+ *      positions wrap,
+ *    - items come out in order: FIFO, sent to the front, overwritten,
+ *      peeked,
+ *    - a StaticQueue_t is the size of the kernel's queue (the kernel
+ *      asserts so), and without the sized copy it is the size it was in
+ *      V10.3.1.
+ *=====================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+#define LARGEST     16
+#define LENGTH      3
+#define GUARD       0x5A
+
+#define CHECK(x) \
+    do { if (!(x)) { fails++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+static int fails;
+
+/* The bytes of item number n of the given size. */
+static void make(uint8_t *item, size_t size, int n)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        item[i] = (uint8_t)(n * 31 + i + 1);
+    }
+}
+
+/* Checks that out holds item n, and that the byte after it is untouched. */
+static int is(const uint8_t *out, size_t size, int n)
+{
+    uint8_t item[LARGEST];
+
+    make(item, size, n);
+    return memcmp(out, item, size) == 0 && out[size] == GUARD;
+}
+
+static int take(QueueHandle_t queue, size_t size, int n, int peek)
+{
+    uint8_t out[LARGEST + 1];
+
+    memset(out, GUARD, sizeof(out));
+    if (peek)
+    {
+        return xQueuePeek(queue, out, 0) == pdPASS && is(out, size, n);
+    }
+    return xQueueReceive(queue, out, 0) == pdPASS && is(out, size, n);
+}
+
+static int take_from_isr(QueueHandle_t queue, size_t size, int n)
+{
+    uint8_t out[LARGEST + 1];
+    BaseType_t woken = pdFALSE;
+
+    memset(out, GUARD, sizeof(out));
+    return xQueueReceiveFromISR(queue, out, &woken) == pdPASS && is(out, size, n);
+}
+
+static void check_queue(QueueHandle_t queue, size_t size)
+{
+    uint8_t item[LARGEST];
+    BaseType_t woken = pdFALSE;
+    int n = 0;
+
+    /* FIFO, round the storage several times. */
+    for (int round = 0; round < 4 * LENGTH; round++)
+    {
+        make(item, size, n + round);
+        CHECK(xQueueSend(queue, item, 0) == pdPASS);
+        CHECK(take(queue, size, n + round, 1));
+        CHECK(take(queue, size, n + round, 0));
+    }
+    n += 4 * LENGTH;
+
+    /* Full, from both ends and from an interrupt. */
+    make(item, size, n);
+    CHECK(xQueueSendToBack(queue, item, 0) == pdPASS);
+    make(item, size, n + 1);
+    CHECK(xQueueSendToFront(queue, item, 0) == pdPASS);
+    make(item, size, n + 2);
+    CHECK(xQueueSendFromISR(queue, item, &woken) == pdPASS);
+    CHECK(xQueueSend(queue, item, 0) == errQUEUE_FULL);
+    CHECK(take(queue, size, n + 1, 0));
+    CHECK(take_from_isr(queue, size, n));
+    CHECK(take(queue, size, n + 2, 0));
+    CHECK(uxQueueMessagesWaiting(queue) == 0);
+}
+
+static void check_size(size_t size)
+{
+    static uint8_t storage[LENGTH * LARGEST + 2];
+    static StaticQueue_t buffer;
+    QueueHandle_t queue;
+    uint8_t item[LARGEST];
+
+    /* Storage one byte into a buffer, so items of 2 bytes and more are not
+       aligned; the bytes either side must survive. */
+    memset(storage, GUARD, sizeof(storage));
+    queue = xQueueCreateStatic(LENGTH, size, &storage[1], &buffer);
+    CHECK(queue != NULL);
+    check_queue(queue, size);
+    CHECK(storage[0] == GUARD && storage[1 + LENGTH * size] == GUARD);
+    vQueueDelete(queue);
+
+    queue = xQueueCreate(LENGTH, size);
+    CHECK(queue != NULL);
+    check_queue(queue, size);
+    vQueueDelete(queue);
+
+    /* A mailbox overwritten in place. */
+    queue = xQueueCreate(1, size);
+    make(item, size, 1);
+    CHECK(xQueueOverwrite(queue, item) == pdPASS);
+    make(item, size, 2);
+    CHECK(xQueueOverwrite(queue, item) == pdPASS);
+    CHECK(take(queue, size, 2, 1));
+    CHECK(take(queue, size, 2, 0));
+    vQueueDelete(queue);
+}
+
+static void main_task(void *argument)
+{
+    (void)argument;
+
+    for (size_t size = 1; size <= LARGEST; size++)
+    {
+        check_size(size);
+    }
+
+#if (configQUEUE_SIZED_COPY == 0)
+    {
+        /* The layout of StaticQueue_t in V10.3.1, with static and dynamic
+           allocation and the trace facility. */
+        typedef struct
+        {
+            void *pvDummy1[3];
+            union
+            {
+                void *pvDummy2;
+                UBaseType_t uxDummy2;
+            } u;
+            StaticList_t xDummy3[2];
+            UBaseType_t uxDummy4[3];
+            uint8_t ucDummy5[2];
+            uint8_t ucDummy6;
+            UBaseType_t uxDummy8;
+            uint8_t ucDummy9;
+        } baseline_queue_t;
+
+        CHECK(sizeof(StaticQueue_t) == sizeof(baseline_queue_t));
+    }
+#endif
+
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    exit(fails ? 1 : 0);
+}
+
+int main(void)
+{
+    xTaskCreate(main_task, "main", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+    vTaskStartScheduler();
+    return 2;
+}
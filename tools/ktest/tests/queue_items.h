@@ -0,0 +1,2 @@
+/* Kernel settings for queue_items.c. */
+#define configQUEUE_SIZED_COPY					1
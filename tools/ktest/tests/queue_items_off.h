@@ -0,0 +1,3 @@
+/* Kernel settings for queue_items.c: items copied with memcpy(), the
+default. */
+#define configQUEUE_SIZED_COPY					0
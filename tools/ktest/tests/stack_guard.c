@@ -0,0 +1,123 @@
+/*=====================================================================
+ *  stack_guard - the kernel side of a guard region at the stack limit
+ *                (configCHECK_FOR_STACK_OVERFLOW set to 3)
+ *
+ *  The host has no MPU, so the config header gives the port macros:
+ *  portSET_STACK_GUARD() notes the stack it was given, and the guard is
+ *  GUARD bytes at the first GUARD aligned address in the stack.
+ *
+ *    - the guard is moved to the stack of each task as it is switched in,
+ *    - the stack high water mark only counts the stack above the guard:
+ *      not the guard, and not the gap below it when the stack is not
+ *      aligned to the guard size,
+ *    - vTaskStackGuardHit(), which the port's fault handler calls, reports
+ *      the running task to vApplicationStackOverflowHook().
+ *=====================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define DEPTH       configMINIMAL_STACK_SIZE
+#define GAP_WORDS   3
+
+#define CHECK(x) \
+    do { if (!(x)) { fails++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+static int fails;
+static StackType_t *volatile guarded;
+static TaskHandle_t overflowed;
+static const char *overflowedName;
+
+void vHostSetStackGuard(StackType_t *stack)
+{
+    guarded = stack;
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
+{
+    overflowed = xTask;
+    overflowedName = pcTaskName;
+}
+
+static StackType_t *stack_of(TaskHandle_t task)
+{
+    TaskStatus_t status;
+
+    vTaskGetInfo(task, &status, pdFALSE, eInvalid);
+    return status.pxStackBase;
+}
+
+static void other_task(void *argument)
+{
+    StackType_t **seen = argument;
+
+    for (;;)
+    {
+        *seen = guarded;
+        vTaskDelay(1);
+    }
+}
+
+static void idle_task(void *argument)
+{
+    (void)argument;
+
+    for (;;)
+    {
+    }
+}
+
+static void main_task(void *argument)
+{
+    /* GUARD aligned, so a stack GAP_WORDS into it is not. */
+    static StackType_t buffer[DEPTH + GAP_WORDS] __attribute__((aligned(GUARD)));
+    static StaticTask_t tcb;
+    static StackType_t *seen;
+    TaskHandle_t self = xTaskGetCurrentTaskHandle(), other, never;
+    const uint8_t *guardEnd, *byte;
+    UBaseType_t free = 0;
+
+    (void)argument;
+
+    /* The guard follows the running task. */
+    CHECK(xTaskCreate(other_task, "other", DEPTH, &seen, 3, &other) == pdPASS);
+    CHECK(guarded == stack_of(self));
+    vTaskDelay(2);
+    CHECK(seen == stack_of(other));
+    CHECK(guarded == stack_of(self));
+    vTaskDelete(other);
+
+    /* A task that never runs: every byte of its stack above the guard that
+       pxPortInitialiseStack() did not write still holds the fill byte. */
+    never = xTaskCreateStatic(idle_task, "never", DEPTH, NULL, 0, &buffer[GAP_WORDS], &tcb);
+    CHECK(never != NULL && stack_of(never) == &buffer[GAP_WORDS]);
+    guardEnd = (const uint8_t *)portSTACK_GUARD_END(&buffer[GAP_WORDS]);
+    CHECK(guardEnd == (const uint8_t *)buffer + 2 * GUARD);
+    for (byte = guardEnd; *byte == 0xA5; byte++)
+    {
+        free++;
+    }
+    free /= sizeof(StackType_t);
+    printf("  %lu words free above the guard, guard and gap %lu words\n", (unsigned long)free,
+           (unsigned long)((guardEnd - (const uint8_t *)&buffer[GAP_WORDS]) / sizeof(StackType_t)));
+    CHECK(uxTaskGetStackHighWaterMark(never) == free);
+    vTaskDelete(never);
+
+    /* What the port's fault handler does on a guard hit. */
+    vTaskStackGuardHit();
+    CHECK(overflowed == self && strcmp(overflowedName, "main") == 0);
+
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    exit(fails ? 1 : 0);
+}
+
+int main(void)
+{
+    xTaskCreate(main_task, "main", DEPTH, NULL, 2, NULL);
+    vTaskStartScheduler();
+    return 2;
+}
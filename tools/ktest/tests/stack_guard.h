@@ -0,0 +1,11 @@
+/* Kernel settings for stack_guard.c: the port macros of a guard region of
+GUARD bytes, which the host cannot enforce. */
+#include <stdint.h>
+
+#define configCHECK_FOR_STACK_OVERFLOW			3
+
+#define GUARD									64U
+#define portSTACK_GUARD_END( pxStack )			( ( ( ( uintptr_t ) ( pxStack ) + GUARD - 1U ) & ~( uintptr_t ) ( GUARD - 1U ) ) + GUARD )
+
+extern void vHostSetStackGuard( uintptr_t *pxStack );
+#define portSET_STACK_GUARD( pxStack )			vHostSetStackGuard( pxStack )
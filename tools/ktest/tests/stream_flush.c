@@ -0,0 +1,185 @@
+/*=====================================================================
+ *  stream_flush - the flush deadline of stream and message buffers
+ *                 (configUSE_STREAM_BUFFER_FLUSH_DEADLINE)
+ *
+ *  A writer task above the reader writes what it is told, a given
+ *  number of ticks after it is told.  The reader checks how much it got
+ *  and at which tick:
+ *
+ *    - a read below the trigger level returns once the deadline has
+ *      passed since the first byte arrived, or at its own block time if
+ *      that is sooner,
+ *    - a read returns as soon as the trigger level is reached, and at
+ *      once if it already is,
+ *    - the deadline is timed from when the buffer went from empty to
+ *      holding data: a read that leaves data behind does not restart it,
+ *      and once it has passed every read returns at once until the
+ *      buffer is empty; the next byte then starts a new deadline,
+ *    - without a deadline a read returns at once if there is any data,
+ *      and otherwise waits for the trigger level or its block time,
+ *    - for message buffers the trigger level counts the length bytes.
+ *=====================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "stream_buffer.h"
+#include "message_buffer.h"
+
+#define SIZE        64
+#define TRIGGER     16
+#define DEADLINE    10
+
+#define CHECK(x) \
+    do { if (!(x)) { fails++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+typedef struct
+{
+    TickType_t delay;
+    size_t bytes;
+} write_t;
+
+static int fails;
+static QueueHandle_t writes;
+static StreamBufferHandle_t target;
+static uint8_t data[SIZE];
+
+static void writer_task(void *argument)
+{
+    write_t w;
+
+    (void)argument;
+
+    for (;;)
+    {
+        xQueueReceive(writes, &w, portMAX_DELAY);
+        vTaskDelay(w.delay);
+        CHECK(xStreamBufferSend(target, data, w.bytes, 0) == w.bytes);
+    }
+}
+
+/* The writer sends bytes, delay ticks after the one before. */
+static void write_after(TickType_t delay, size_t bytes)
+{
+    write_t w = { delay, bytes };
+
+    CHECK(xQueueSend(writes, &w, 0) == pdPASS);
+}
+
+/* Reads up to length bytes; returns the ticks it took, *got what it read. */
+static TickType_t read(size_t length, TickType_t wait, size_t *got)
+{
+    static uint8_t buffer[SIZE];
+    TickType_t start = xTaskGetTickCount();
+
+    *got = xStreamBufferReceive(target, buffer, length, wait);
+    return xTaskGetTickCount() - start;
+}
+
+static void stream_buffer(void)
+{
+    size_t got;
+
+    target = xStreamBufferCreate(SIZE, TRIGGER);
+    CHECK(target != NULL);
+    CHECK(xStreamBufferGetFlushDeadline(target) == 0);
+    vStreamBufferSetFlushDeadline(target, DEADLINE);
+    CHECK(xStreamBufferGetFlushDeadline(target) == DEADLINE);
+
+    /* Below the trigger level: the deadline from the first byte, not
+       moved by the bytes after it. */
+    write_after(3, 4);
+    write_after(4, 4);
+    CHECK(read(SIZE, 100, &got) == 3 + DEADLINE && got == 8);
+
+    /* The reader's own block time comes first. */
+    write_after(2, 4);
+    CHECK(read(SIZE, 5, &got) == 5 && got == 4);
+
+    /* The trigger level is reached before the deadline. */
+    write_after(3, 4);
+    write_after(2, TRIGGER - 4);
+    CHECK(read(SIZE, 100, &got) == 5 && got == TRIGGER);
+
+    /* Already at the trigger level: at once, and only what was asked for,
+       leaving less than the trigger level behind. */
+    write_after(0, TRIGGER + 4);
+    vTaskDelay(1);
+    CHECK(read(8, 100, &got) == 0 && got == 8);
+
+    /* The partial read did not restart the deadline: the rest comes when
+       it passes, timed from the write. */
+    vTaskDelay(2);
+    CHECK(read(4, 100, &got) == DEADLINE - 3 && got == 4);
+
+    /* Past the deadline, reads return at once until the buffer is empty,
+       even for data written since. */
+    write_after(0, 2);
+    vTaskDelay(1);
+    CHECK(read(4, 100, &got) == 0 && got == 4);
+    CHECK(read(SIZE, 100, &got) == 0 && got == 6);
+    CHECK(xStreamBufferIsEmpty(target));
+
+    /* Empty again: the next byte starts a new deadline. */
+    write_after(6, 1);
+    CHECK(read(SIZE, 100, &got) == 6 + DEADLINE && got == 1);
+
+    /* Without a deadline, any data is enough for a read that finds it;
+       one that waits waits for the trigger level. */
+    vStreamBufferSetFlushDeadline(target, 0);
+    write_after(0, 4);
+    vTaskDelay(1);
+    CHECK(read(SIZE, 100, &got) == 0 && got == 4);
+    write_after(3, 4);
+    CHECK(read(SIZE, 20, &got) == 20 && got == 4);
+
+    vStreamBufferDelete(target);
+}
+
+static void message_buffer(void)
+{
+    size_t got;
+
+    /* A message of 8 bytes takes 8 + sizeof(size_t) with its length; the
+       trigger level is two of them. */
+    target = xMessageBufferCreate(SIZE);
+    CHECK(target != NULL);
+    CHECK(xStreamBufferSetTriggerLevel(target, 2 * (8 + sizeof(size_t))) == pdTRUE);
+    vStreamBufferSetFlushDeadline(target, DEADLINE);
+
+    write_after(2, 8);
+    CHECK(read(SIZE, 100, &got) == 2 + DEADLINE && got == 8);
+
+    write_after(2, 8);
+    write_after(3, 8);
+    CHECK(read(SIZE, 100, &got) == 5 && got == 8);
+
+    /* The second message waits out the deadline of the first. */
+    CHECK(read(SIZE, 100, &got) == DEADLINE - 3 && got == 8);
+
+    vMessageBufferDelete(target);
+}
+
+static void main_task(void *argument)
+{
+    (void)argument;
+
+    stream_buffer();
+    message_buffer();
+
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    exit(fails ? 1 : 0);
+}
+
+int main(void)
+{
+    writes = xQueueCreate(4, sizeof(write_t));
+    xTaskCreate(writer_task, "writer", configMINIMAL_STACK_SIZE, NULL, 3, NULL);
+    xTaskCreate(main_task, "main", configMINIMAL_STACK_SIZE, NULL, 2, NULL);
+    vTaskStartScheduler();
+    return 2;
+}
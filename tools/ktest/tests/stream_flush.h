@@ -0,0 +1,2 @@
+/* Kernel settings for stream_flush.c. */
+#define configUSE_STREAM_BUFFER_FLUSH_DEADLINE	1
@@ -0,0 +1,384 @@
+/*=====================================================================
+ *  telemetry_frames - the telemetry stream of the template
+ *                     (Core/Src/telemetry.c) and
+ *                     uxTaskGetPartialSystemState()
+ *
+ *  The test stands in for the USART2 TX DMA stream of port/stm32f4xx.h:
+ *  a task copies out what the stream was given and calls the stream's
+ *  interrupt handler.  The bytes are decoded as tools/ktop would.  The run
+ *  time counter goes up by one each time it is read, and moves the cycle
+ *  counter on with it.
+ *
+ *    - uxTaskGetPartialSystemState() fills a short array, and only
+ *      measures stacks when asked; uxTaskGetSystemState() still refuses
+ *      an array that is too short,
+ *    - every frame arrives whole, in sequence, and with a good CRC,
+ *    - a key frame every TELEMETRY_KEY_EVERY frames, and in the frame
+ *      after a task first shows up in a delta frame; nothing else,
+ *    - key frames carry the stack of every task, delta frames none,
+ *    - with more tasks than TELEMETRY_MAX_TASKS the frame is full and
+ *      says how many were left out, and again 0 once they are deleted,
+ *    - the run times of the tasks in a frame add up to no more than the
+ *      period, also while tasks are left out,
+ *    - the cost of the previous frame is reported.
+ *
+ *  The cycle counts are the host's reads of the counter, not the
+ *  target's; this checks the stream, not what it costs on the board.
+ *=====================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "stm32f4xx.h"
+#include "telemetry.h"
+
+#define WORKERS     2
+#define BASE_TASKS  (5 + WORKERS)    /* with idle, timers, telemetry, dma, main */
+#define EXTRAS      3
+#define CAPTURE     (64 * 1024)
+
+#define CHECK(x) \
+    do { if (!(x)) { fails++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+/* Peripherals of port/stm32f4xx.h. */
+DMA_Stream_TypeDef xHostDMA1Stream6;
+DMA_TypeDef xHostDMA1;
+USART_TypeDef xHostUSART2;
+RCC_TypeDef xHostRCC;
+DWT_Type xHostDWT;
+CoreDebug_Type xHostCoreDebug;
+uint32_t SystemCoreClock = 100000000;
+
+extern void DMA1_Stream6_IRQHandler(void);
+
+typedef struct
+{
+    int key, sequence;
+    uint32_t period, cost, dropped, leftOut, count, runTime;
+    uint32_t number[TELEMETRY_MAX_TASKS];
+    uint8_t flags[TELEMETRY_MAX_TASKS];
+    uint32_t stack[TELEMETRY_MAX_TASKS];
+} frame_t;
+
+static int fails;
+static uint32_t runTime;
+static uint8_t capture[CAPTURE];
+static volatile size_t captured;
+static volatile int capturing = 1;
+static TaskHandle_t extras[EXTRAS];
+
+uint32_t ulHostRunTime(void)
+{
+    xHostDWT.CYCCNT += 3;
+    return ++runTime;
+}
+
+/* The DMA stream: sends what it was given in one go, once a tick. */
+static void dma_task(void *argument)
+{
+    (void)argument;
+
+    for (;;)
+    {
+        if ((xHostDMA1Stream6.CR & DMA_SxCR_EN) != 0)
+        {
+            size_t length = xHostDMA1Stream6.NDTR;
+
+            if (capturing && captured + length <= CAPTURE)
+            {
+                memcpy(&capture[captured], (void *)(uintptr_t)xHostDMA1Stream6.M0AR, length);
+                captured += length;
+            }
+            xHostDMA1Stream6.CR &= ~DMA_SxCR_EN;
+            taskENTER_CRITICAL();
+            DMA1_Stream6_IRQHandler();
+            taskEXIT_CRITICAL();
+        }
+        vTaskDelay(1);
+    }
+}
+
+static void worker_task(void *argument)
+{
+    int work = (int)(intptr_t)argument;
+
+    for (;;)
+    {
+        for (int i = 0; i < work; i++)
+        {
+            (void)ulHostRunTime();
+        }
+        vTaskDelay(3);
+    }
+}
+
+static uint16_t crc16(const uint8_t *data, size_t length)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)(data[i] << 8);
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint32_t varint(const uint8_t **p)
+{
+    uint32_t value = 0;
+    int shift = 0;
+
+    while (**p & 0x80)
+    {
+        value |= (uint32_t)(*(*p)++ & 0x7F) << shift;
+        shift += 7;
+    }
+    return value | ((uint32_t)*(*p)++ << shift);
+}
+
+/* COBS decodes one frame that ends before end; returns its length. */
+static size_t unstuff(const uint8_t *in, const uint8_t *end, uint8_t *out)
+{
+    size_t length = 0;
+
+    while (in < end)
+    {
+        uint8_t code = *in++;
+
+        for (int i = 1; i < code && in < end; i++)
+        {
+            out[length++] = *in++;
+        }
+        if (code != 0xFF && in < end)
+        {
+            out[length++] = 0;
+        }
+    }
+    return length;
+}
+
+/* Parses a decoded frame; returns 0 if it is not well formed. */
+static int parse(const uint8_t *data, size_t length, frame_t *f)
+{
+    const uint8_t *p = data;
+    uint32_t queues;
+
+    if (length < 4 || crc16(data, length - 2) != (uint16_t)(data[length - 2] | (data[length - 1] << 8)))
+    {
+        return 0;
+    }
+
+    memset(f, 0, sizeof(*f));
+    f->key = (*p++ == 1);
+    f->sequence = *p++;
+    (void)varint(&p);
+    f->period = varint(&p);
+    f->cost = varint(&p);
+    if (f->key)
+    {
+        (void)varint(&p);
+        (void)varint(&p);
+        (void)varint(&p);
+    }
+    (void)varint(&p);
+    (void)varint(&p);
+    f->dropped = varint(&p);
+    f->leftOut = varint(&p);
+    f->count = varint(&p);
+    if (f->count > TELEMETRY_MAX_TASKS)
+    {
+        return 0;
+    }
+    for (uint32_t i = 0; i < f->count; i++)
+    {
+        uint32_t taskRunTime;
+
+        f->number[i] = varint(&p);
+        f->flags[i] = *p++;
+        taskRunTime = varint(&p);
+        f->runTime += taskRunTime;
+        if (f->flags[i] & 1)
+        {
+            f->stack[i] = varint(&p);
+        }
+        if (f->flags[i] & 2)
+        {
+            p += 2;
+        }
+        if (f->flags[i] & 4)
+        {
+            p += 1 + *p;
+        }
+    }
+    queues = varint(&p);
+    for (uint32_t i = 0; i < queues; i++)
+    {
+        uint8_t flags;
+
+        (void)varint(&p);
+        flags = *p++;
+        if (flags & 1)
+        {
+            (void)varint(&p);
+        }
+        if (flags & 4)
+        {
+            p += 1 + *p;
+            (void)varint(&p);
+        }
+    }
+    return p == data + length - 2;
+}
+
+static int listed(const frame_t *f, uint32_t number)
+{
+    for (uint32_t i = 0; i < f->count; i++)
+    {
+        if (f->number[i] == number)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void check_frames(void)
+{
+    static uint8_t decoded[CAPTURE];
+    static frame_t frames[2];
+    const uint8_t *start = capture, *end = capture + captured, *zero;
+    frame_t *f, *last = NULL;
+    int total = 0, keys = 0, newTaskKeys = 0, mostLeftOut = 0, newInLast = 0;
+
+    while ((zero = memchr(start, 0, (size_t)(end - start))) != NULL)
+    {
+        size_t length = unstuff(start, zero, decoded);
+
+        f = &frames[total & 1];
+        start = zero + 1;
+        CHECK(parse(decoded, length, f));
+
+        if (last != NULL)
+        {
+            CHECK(f->sequence == ((last->sequence + 1) & 0xFF));
+        }
+        CHECK(f->dropped == 0);
+        CHECK(f->key == ((f->sequence % TELEMETRY_KEY_EVERY) == 0 || newInLast));
+        if (f->key && (f->sequence % TELEMETRY_KEY_EVERY) != 0)
+        {
+            newTaskKeys++;
+        }
+        keys += f->key;
+
+        newInLast = 0;
+        for (uint32_t i = 0; i < f->count; i++)
+        {
+            int isNew = (last == NULL) || !listed(last, f->number[i]);
+
+            if (f->key)
+            {
+                CHECK(f->flags[i] == 7 && f->stack[i] > 0);
+            }
+            else
+            {
+                CHECK((f->flags[i] & 1) == 0);
+                CHECK(((f->flags[i] & 4) != 0) == isNew);
+                newInLast |= isNew;
+            }
+        }
+
+        CHECK(f->count + f->leftOut >= BASE_TASKS);
+        CHECK(f->leftOut == 0 || f->count == TELEMETRY_MAX_TASKS);
+        if ((int)f->leftOut > mostLeftOut)
+        {
+            mostLeftOut = (int)f->leftOut;
+        }
+        if (last != NULL)
+        {
+            CHECK(f->period > 0 && f->runTime <= f->period + f->period / 4);
+            CHECK(f->cost > 0);
+        }
+
+        last = f;
+        total++;
+    }
+
+    CHECK(total >= 35);
+    CHECK(keys >= total / TELEMETRY_KEY_EVERY && newTaskKeys >= 1);
+    CHECK(mostLeftOut == 2);
+    CHECK(last != NULL && last->leftOut == 0 && last->count == BASE_TASKS);
+    printf("%d frames, %d key frames, %d after a new task, %d tasks left out at most\n",
+           total, keys, newTaskKeys, mostLeftOut);
+}
+
+static void main_task(void *argument)
+{
+    static TaskStatus_t status[16];
+    UBaseType_t count, tasks = uxTaskGetNumberOfTasks();
+    uint32_t total = 0;
+
+    (void)argument;
+
+    /* The kernel functions on their own. */
+    CHECK(uxTaskGetSystemState(status, 3, NULL) == 0);
+    CHECK(uxTaskGetPartialSystemState(status, 3, &total, pdFALSE) == 3 && total > 0);
+    for (int i = 0; i < 3; i++)
+    {
+        CHECK(status[i].usStackHighWaterMark == 0);
+    }
+    count = uxTaskGetPartialSystemState(status, 16, NULL, pdTRUE);
+    CHECK(count == tasks);
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        CHECK(status[i].usStackHighWaterMark > 0);
+    }
+    CHECK(uxTaskGetSystemState(status, 16, NULL) == tasks);
+
+    /* A new task in the middle of a run of delta frames, then two more,
+       which is more than the frame has room for, then none of them. */
+    vTaskDelay(1150);
+    xTaskCreate(worker_task, "new", configMINIMAL_STACK_SIZE, (void *)50, 1, &extras[0]);
+    vTaskDelay(850);
+    for (int i = 1; i < EXTRAS; i++)
+    {
+        xTaskCreate(worker_task, "extra", configMINIMAL_STACK_SIZE, (void *)(intptr_t)(10 * i), 1, &extras[i]);
+    }
+    vTaskDelay(1000);
+    for (int i = 0; i < EXTRAS; i++)
+    {
+        vTaskDelete(extras[i]);
+    }
+    vTaskDelay(1000);
+    capturing = 0;
+
+    check_frames();
+
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    exit(fails ? 1 : 0);
+}
+
+int main(void)
+{
+    static QueueHandle_t queue;
+
+    queue = xQueueCreate(4, sizeof(int));
+    CHECK(Telemetry_AddQueue(queue, "queue") == 1);
+
+    xTaskCreate(dma_task, "dma", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 2, NULL);
+    for (int i = 0; i < WORKERS; i++)
+    {
+        xTaskCreate(worker_task, "worker", configMINIMAL_STACK_SIZE, (void *)(intptr_t)(100 + 200 * i), 2, NULL);
+    }
+    xTaskCreate(main_task, "main", configMINIMAL_STACK_SIZE, NULL, 3, NULL);
+    Telemetry_Start();
+    vTaskStartScheduler();
+    return 2;
+}
@@ -0,0 +1,11 @@
+/* Kernel and telemetry settings for telemetry_frames.c. */
+#include <stdint.h>
+
+#define configGENERATE_RUN_TIME_STATS			1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+extern uint32_t ulHostRunTime( void );
+#define portGET_RUN_TIME_COUNTER_VALUE()		ulHostRunTime()
+#define configLIBRARY_LOWEST_INTERRUPT_PRIORITY	15
+
+#define TELEMETRY_MAX_TASKS						8
+#define TELEMETRY_KEY_EVERY						5
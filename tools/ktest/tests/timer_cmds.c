@@ -0,0 +1,205 @@
+/*=====================================================================
+ *  timer_cmds - timer commands applied directly by the timer service
+ *               and coalesced in its queue
+ *               (configUSE_TIMER_COMMAND_COALESCING)
+ *
+ *  Built twice by the Makefile, with configUSE_OBJECT_LOCKS off and on.
+ *  The timer service runs at priority 5; the main task runs above it to
+ *  let commands pile up in the queue, and below it to have each one
+ *  handled before the call that posted it returns.
+ *
+ *    - a start, reset or stop is dropped when a newer command for the
+ *      same timer is queued behind it, a period change never is, and
+ *      uxCommandsCoalesced counts the dropped ones,
+ *    - a command from a timer callback is applied at once, unless an
+ *      older command for that timer is still queued,
+ *    - a timer started and then deleted never fires, and nothing writes
+ *      to it once the service has freed it: freed blocks are filled
+ *      with a pattern by traceFREE() and must still hold it afterwards.
+ *=====================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+#define ABOVE_SERVICE   (configTIMER_TASK_PRIORITY + 1)
+#define BELOW_SERVICE   (configTIMER_TASK_PRIORITY - 3)
+#define POISON          0xA5
+#define DELETES         20
+
+#define CHECK(x) \
+    do { if (!(x)) { fails++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+#if (configUSE_OBJECT_LOCKS == 1)
+#define LOCKS_FREE() (xHostLocksHeld == 0 && xHostKernelLocks == 0)
+#else
+#define LOCKS_FREE() 1
+#endif
+
+static int fails;
+static TimerHandle_t plain, first, second;
+static volatile int plainFired, secondFired, deletedFired;
+static volatile TickType_t plainFiredAt;
+static volatile BaseType_t secondActiveInCallback, stopSecondFromISR;
+static void *watched;
+static volatile int watchedFreed;
+
+/* traceFREE() of this test's configuration: fills the block of the timer
+   being deleted with POISON. */
+void vHostTraceFree(void *block, size_t size)
+{
+    if (block == watched)
+    {
+        memset(block, POISON, sizeof(StaticTimer_t));
+        watchedFreed = 1;
+    }
+    (void)size;
+}
+
+static int still_poisoned(const void *block)
+{
+    const uint8_t *p = block;
+
+    for (size_t i = 0; i < sizeof(StaticTimer_t); i++)
+    {
+        if (p[i] != POISON)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void plain_callback(TimerHandle_t timer)
+{
+    (void)timer;
+    plainFired++;
+    plainFiredAt = xTaskGetTickCount();
+}
+
+/* Restarts the second timer from inside the timer service task. */
+static void first_callback(TimerHandle_t timer)
+{
+    (void)timer;
+    if (stopSecondFromISR)
+    {
+        /* Never applied directly, so it leaves a command queued. */
+        CHECK(xTimerStopFromISR(second, NULL) == pdPASS);
+    }
+    CHECK(xTimerStart(second, 0) == pdPASS);
+    secondActiveInCallback = xTimerIsTimerActive(second);
+}
+
+static void second_callback(TimerHandle_t timer)
+{
+    (void)timer;
+    secondFired++;
+}
+
+static void deleted_callback(TimerHandle_t timer)
+{
+    (void)timer;
+    deletedFired++;
+}
+
+static void main_task(void *argument)
+{
+    TimerCommandStats_t stats;
+    TickType_t start;
+    TimerHandle_t timer;
+    size_t freeHeap;
+
+    (void)argument;
+
+    plain = xTimerCreate("plain", 10, pdFALSE, NULL, plain_callback);
+    first = xTimerCreate("first", 5, pdFALSE, NULL, first_callback);
+    second = xTimerCreate("second", 10, pdFALSE, NULL, second_callback);
+    CHECK(plain != NULL && first != NULL && second != NULL);
+
+    /* Queued behind newer commands: only the last start is applied. */
+    vTaskDelay(1);
+    vTimerClearCommandStats();
+    start = xTaskGetTickCount();
+    CHECK(xTimerStart(plain, 0) == pdPASS);
+    CHECK(xTimerReset(plain, 0) == pdPASS);
+    CHECK(xTimerStop(plain, 0) == pdPASS);
+    CHECK(xTimerStart(plain, 0) == pdPASS);
+    CHECK(xTimerIsTimerActive(plain) == pdFALSE);
+    vTaskDelay(20);
+    CHECK(plainFired == 1 && plainFiredAt == start + 10);
+    vTimerGetCommandStats(&stats);
+    CHECK(stats.uxCommandsReceived == 4 && stats.uxCommandsCoalesced == 3);
+    CHECK(stats.uxCommandsDirect == 0 && stats.uxCommandsFailed == 0);
+
+    /* A period change in between is applied, and the stop after it. */
+    CHECK(xTimerStart(plain, 0) == pdPASS);
+    CHECK(xTimerChangePeriod(plain, 30, 0) == pdPASS);
+    CHECK(xTimerStop(plain, 0) == pdPASS);
+    vTaskDelay(50);
+    CHECK(plainFired == 1);
+    CHECK(xTimerGetPeriod(plain) == 30 && xTimerIsTimerActive(plain) == pdFALSE);
+    vTimerGetCommandStats(&stats);
+    CHECK(stats.uxCommandsReceived == 7 && stats.uxCommandsCoalesced == 4);
+
+    /* From a callback, with nothing queued for the timer: applied at once. */
+    vTimerClearCommandStats();
+    CHECK(xTimerStart(first, 0) == pdPASS);
+    vTaskDelay(30);
+    CHECK(secondActiveInCallback == pdTRUE && secondFired == 1);
+    vTimerGetCommandStats(&stats);
+    CHECK(stats.uxCommandsReceived == 1 && stats.uxCommandsDirect == 1);
+
+    /* From a callback, behind a queued stop: queued too, so the stop is
+       dropped and the start is applied after it. */
+    vTimerClearCommandStats();
+    stopSecondFromISR = pdTRUE;
+    CHECK(xTimerStart(first, 0) == pdPASS);
+    vTaskDelay(30);
+    CHECK(secondActiveInCallback == pdFALSE && secondFired == 2);
+    vTimerGetCommandStats(&stats);
+    CHECK(stats.uxCommandsReceived == 3 && stats.uxCommandsDirect == 0);
+    CHECK(stats.uxCommandsCoalesced == 1);
+    CHECK(LOCKS_FREE());
+
+    /* Start then delete, both queued. */
+    freeHeap = xPortGetFreeHeapSize();
+    timer = xTimerCreate("deleted", 10, pdFALSE, NULL, deleted_callback);
+    CHECK(timer != NULL);
+    CHECK(xTimerStart(timer, 0) == pdPASS);
+    CHECK(xTimerDelete(timer, 0) == pdPASS);
+    vTaskDelay(50);
+    CHECK(deletedFired == 0 && xPortGetFreeHeapSize() == freeHeap);
+
+    /* Start then delete from below the service, which deletes and frees
+       the timer before xTimerDelete() returns. */
+    vTaskPrioritySet(NULL, BELOW_SERVICE);
+    for (int i = 0; i < DELETES; i++)
+    {
+        timer = xTimerCreate("deleted", 1 + i % 3, pdTRUE, NULL, deleted_callback);
+        CHECK(timer != NULL);
+        watched = timer;
+        watchedFreed = 0;
+        CHECK(xTimerStart(timer, 0) == pdPASS);
+        CHECK(xTimerDelete(timer, 0) == pdPASS);
+        CHECK(watchedFreed == 1 && still_poisoned(timer));
+        watched = NULL;
+    }
+    vTaskDelay(50);
+    CHECK(deletedFired == 0 && xPortGetFreeHeapSize() == freeHeap);
+    CHECK(LOCKS_FREE());
+
+    printf("configUSE_OBJECT_LOCKS %d\n", configUSE_OBJECT_LOCKS);
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    exit(fails ? 1 : 0);
+}
+
+int main(void)
+{
+    xTaskCreate(main_task, "main", configMINIMAL_STACK_SIZE, NULL, ABOVE_SERVICE, NULL);
+    vTaskStartScheduler();
+    return 2;
+}
@@ -0,0 +1,8 @@
+/* Kernel settings for timer_cmds.c. */
+#include <stddef.h>
+
+#define configUSE_TIMER_COMMAND_COALESCING		1
+#define configGENERATE_TIMER_COMMAND_STATS		1
+
+extern void vHostTraceFree( void *pvBlock, size_t xSize );
+#define traceFREE( pvAddress, uiSize )			vHostTraceFree( ( pvAddress ), ( uiSize ) )
@@ -0,0 +1,4 @@
+/* Kernel settings for timer_cmds.c, with the per object locks. */
+#include "timer_cmds.h"
+
+#define configUSE_OBJECT_LOCKS					1
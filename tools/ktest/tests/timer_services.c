@@ -0,0 +1,188 @@
+/*=====================================================================
+ *  timer_services - timers on several timer services
+ *                   (configTIMER_SERVICE_COUNT)
+ *
+ *  Built with one service and with two.  With one, everything has to be
+ *  as it was before there could be more:
+ *
+ *    - the service task is "Tmr Svc" at configTIMER_TASK_PRIORITY, and
+ *      is the only service task; StaticTimer_t has not grown,
+ *    - xTimerCreateOnService() on service 0 is xTimerCreate(), and
+ *      callbacks and pended functions run in "Tmr Svc".
+ *
+ *  With two:
+ *
+ *    - service 0 keeps the name "Tmr Svc", service 1 is "Tmr Svc 1", each
+ *      at its priority from configTIMER_SERVICE_PRIORITIES,
+ *    - a timer's callback runs in the task of its service, for dynamic
+ *      and static timers, and commands to it reach that service,
+ *    - the higher priority service runs its callbacks first when timers
+ *      of both expire at the same tick,
+ *    - pended functions run in service 0.
+ *=====================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+#define PERIOD      10
+
+#define CHECK(x) \
+    do { if (!(x)) { fails++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+typedef struct
+{
+    const char *ran;
+    int fired, order;
+} record_t;
+
+static int fails;
+static int callbacks;
+static record_t pended;
+
+#if (configTIMER_SERVICE_COUNT > 1)
+
+static StaticTask_t serviceTCB;
+static StackType_t serviceStack[configTIMER_TASK_STACK_DEPTH];
+
+void vApplicationGetTimerServiceTaskMemory(UBaseType_t uxService, StaticTask_t **ppxTimerTaskTCBBuffer,
+                                           StackType_t **ppxTimerTaskStackBuffer, uint32_t *pulTimerTaskStackSize)
+{
+    CHECK(uxService == 1);
+    *ppxTimerTaskTCBBuffer = &serviceTCB;
+    *ppxTimerTaskStackBuffer = serviceStack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+
+#endif
+
+static void record(record_t *r)
+{
+    r->ran = pcTaskGetName(NULL);
+    r->fired++;
+    r->order = ++callbacks;
+}
+
+static void callback(TimerHandle_t handle)
+{
+    record(pvTimerGetTimerID(handle));
+}
+
+static void pend(void *parameter, uint32_t value)
+{
+    (void)value;
+    record(parameter);
+}
+
+/* Starts the timers together, lets them expire once, and stops them. */
+static void run_once(TimerHandle_t *handles, int count)
+{
+    vTaskDelay(1);
+    for (int i = 0; i < count; i++)
+    {
+        CHECK(xTimerStart(handles[i], 0) == pdPASS);
+    }
+    vTaskDelay(PERIOD + 2);
+    for (int i = 0; i < count; i++)
+    {
+        CHECK(xTimerStop(handles[i], 0) == pdPASS);
+    }
+    vTaskDelay(1);
+}
+
+static void main_task(void *argument)
+{
+    static StaticTimer_t buffer;
+    static record_t records[3];
+    TimerHandle_t handles[3];
+    TaskHandle_t service0 = xTimerGetTimerDaemonTaskHandle();
+
+    (void)argument;
+
+    /* Service 0 is what a single service always was. */
+    CHECK(xTimerGetServiceTaskHandle(0) == service0);
+    CHECK(strcmp(pcTaskGetName(service0), "Tmr Svc") == 0);
+    CHECK(uxTaskGetNumberOfTasks() == 2 + configTIMER_SERVICE_COUNT);
+
+    handles[0] = xTimerCreate("plain", PERIOD, pdTRUE, &records[0], callback);
+    handles[1] = xTimerCreateOnService("on 0", PERIOD, pdTRUE, &records[1], callback, 0);
+    handles[2] = xTimerCreateStaticOnService("static", PERIOD, pdTRUE, &records[2], callback, &buffer,
+                                             configTIMER_SERVICE_COUNT - 1);
+    for (int i = 0; i < 3; i++)
+    {
+        CHECK(handles[i] != NULL);
+    }
+    run_once(handles, 2);
+    CHECK(records[0].fired == 1 && records[1].fired == 1);
+    CHECK(records[0].ran != NULL && strcmp(records[0].ran, "Tmr Svc") == 0);
+    CHECK(records[1].ran != NULL && strcmp(records[1].ran, "Tmr Svc") == 0);
+
+    CHECK(xTimerPendFunctionCall(pend, &pended, 0, 0) == pdPASS);
+    vTaskDelay(1);
+    CHECK(pended.fired == 1 && strcmp(pended.ran, "Tmr Svc") == 0);
+
+#if (configTIMER_SERVICE_COUNT > 1)
+    {
+        TaskHandle_t service1 = xTimerGetServiceTaskHandle(1);
+        TimerHandle_t both[2] = { handles[0], handles[2] };
+
+        CHECK(strcmp(pcTaskGetName(service1), "Tmr Svc 1") == 0);
+        CHECK(uxTaskPriorityGet(service0) == 1);
+        CHECK(uxTaskPriorityGet(service1) == configMAX_PRIORITIES - 1);
+
+        /* Started after the one on service 0, but its service runs first. */
+        callbacks = 0;
+        run_once(both, 2);
+        CHECK(records[2].fired == 1 && strcmp(records[2].ran, "Tmr Svc 1") == 0);
+        CHECK(records[0].fired == 2 && strcmp(records[0].ran, "Tmr Svc") == 0);
+        CHECK(records[2].order == 1 && records[0].order == 2);
+
+        /* Commands to the timer go to the queue of its service. */
+        CHECK(xTimerChangePeriod(handles[2], 2 * PERIOD, 0) == pdPASS);
+        vTaskDelay(1);
+        CHECK(xTimerGetPeriod(handles[2]) == 2 * PERIOD && xTimerIsTimerActive(handles[2]));
+        vTaskDelay(2 * PERIOD);
+        CHECK(records[2].fired == 2 && strcmp(records[2].ran, "Tmr Svc 1") == 0);
+        CHECK(xTimerStop(handles[2], 0) == pdPASS);
+    }
+#else
+    {
+        /* The layout of StaticTimer_t in V10.3.1 with the trace facility. */
+        typedef struct
+        {
+            void *pvDummy1;
+            StaticListItem_t xDummy2;
+            TickType_t xDummy3;
+            void *pvDummy5;
+            TaskFunction_t pvDummy6;
+            UBaseType_t uxDummy7;
+            uint8_t ucDummy8;
+        } baseline_timer_t;
+
+        CHECK(uxTaskPriorityGet(service0) == configTIMER_TASK_PRIORITY);
+        CHECK(sizeof(StaticTimer_t) == sizeof(baseline_timer_t));
+        run_once(&handles[2], 1);
+        CHECK(records[2].fired == 1 && strcmp(records[2].ran, "Tmr Svc") == 0);
+    }
+#endif
+
+    for (int i = 0; i < 3; i++)
+    {
+        CHECK(xTimerDelete(handles[i], 0) == pdPASS);
+    }
+    vTaskDelay(1);
+
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    exit(fails ? 1 : 0);
+}
+
+int main(void)
+{
+    xTaskCreate(main_task, "main", configMINIMAL_STACK_SIZE, NULL, 3, NULL);
+    vTaskStartScheduler();
+    return 2;
+}
@@ -0,0 +1,3 @@
+/* Kernel settings for timer_services.c. */
+#define configTIMER_SERVICE_COUNT				2
+#define configTIMER_SERVICE_PRIORITIES			{ 1, configMAX_PRIORITIES - 1 }
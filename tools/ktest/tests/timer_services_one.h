@@ -0,0 +1,3 @@
+/* Kernel settings for timer_services.c: a single timer service, as before
+there could be more. */
+#define configTIMER_SERVICE_COUNT				1
@@ -0,0 +1,136 @@
+/*=====================================================================
+ *  timer_slack - timers allowed to expire late so they share a wake-up
+ *                (configUSE_TIMER_SLACK)
+ *
+ *  The tick count starts shortly before it overflows, so the run also
+ *  crosses the switch of the timer lists.  Callbacks take no time on
+ *  this port, so a timer is only late by the slack the service used.
+ *
+ *    - no timer fires before its expiry time, and none later than its
+ *      slack allows; a timer without slack fires on time,
+ *    - auto-reload timers keep to their period: the n-th callback is
+ *      due at start + n * period, whatever the slack made the ones
+ *      before it,
+ *    - timers with slack share wake-ups of the timer service, and the
+ *      dispatch latency it reports stays within the slack.
+ *=====================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+#define TIMERS      5
+#define RUN_TICKS   1000
+
+#define CHECK(x) \
+    do { if (!(x)) { fails++; printf("FAIL line %d: %s\n", __LINE__, #x); } } while (0)
+
+typedef struct
+{
+    const char *name;
+    TickType_t period, slack;
+    UBaseType_t autoReload;
+    TimerHandle_t handle;
+    TickType_t start;
+    int fired, early, late, onTime;
+} slack_timer_t;
+
+static int fails;
+static slack_timer_t timers[TIMERS] = {
+    { .name = "ten", .period = 10, .slack = 5, .autoReload = pdTRUE },
+    { .name = "eleven", .period = 11, .slack = 5, .autoReload = pdTRUE },
+    { .name = "thirty", .period = 30, .slack = 12, .autoReload = pdTRUE },
+    { .name = "exact", .period = 7, .slack = 0, .autoReload = pdTRUE },
+    { .name = "once", .period = 450, .slack = 40, .autoReload = pdFALSE },
+};
+
+static void callback(TimerHandle_t handle)
+{
+    slack_timer_t *t = pvTimerGetTimerID(handle);
+    TickType_t due = t->start + (TickType_t)(t->fired + 1) * t->period;
+    TickType_t late = xTaskGetTickCount() - due;
+
+    t->fired++;
+    if (late > portMAX_DELAY / 2)
+    {
+        t->early++;
+    }
+    else if (late > t->slack)
+    {
+        t->late++;
+    }
+    else if (late == 0)
+    {
+        t->onTime++;
+    }
+}
+
+static void main_task(void *argument)
+{
+    TimerCommandStats_t stats;
+    TickType_t start;
+
+    (void)argument;
+
+    for (int i = 0; i < TIMERS; i++)
+    {
+        slack_timer_t *t = &timers[i];
+
+        t->handle = xTimerCreate(t->name, t->period, t->autoReload, t, callback);
+        CHECK(t->handle != NULL);
+        CHECK(xTimerGetSlack(t->handle) == 0);
+        vTimerSetSlack(t->handle, t->slack);
+        CHECK(xTimerGetSlack(t->handle) == t->slack);
+    }
+
+    /* The timer service runs below this task, so every start is applied
+       at the same tick. */
+    vTaskDelay(1);
+    vTimerClearCommandStats();
+    start = xTaskGetTickCount();
+    for (int i = 0; i < TIMERS; i++)
+    {
+        timers[i].start = start;
+        CHECK(xTimerStart(timers[i].handle, 0) == pdPASS);
+    }
+    vTaskDelay(RUN_TICKS);
+    for (int i = 0; i < TIMERS; i++)
+    {
+        CHECK(xTimerStop(timers[i].handle, 0) == pdPASS);
+    }
+    vTaskDelay(1);
+    CHECK(xTaskGetTickCount() < start);
+
+    for (int i = 0; i < TIMERS; i++)
+    {
+        slack_timer_t *t = &timers[i];
+        /* The stop can come before a callback due on the last tick. */
+        int due = t->autoReload ? RUN_TICKS / (int)t->period : 1;
+
+        printf("  %-6s period %3lu slack %2lu: %3d callbacks, %3d on time\n", t->name,
+               (unsigned long)t->period, (unsigned long)t->slack, t->fired, t->onTime);
+        CHECK(t->early == 0 && t->late == 0);
+        CHECK(t->fired == due || t->fired == due - 1);
+    }
+    CHECK(timers[3].onTime == timers[3].fired);
+
+    vTimerGetCommandStats(&stats);
+    printf("  %lu callbacks in %lu wake-ups, latency at most %lu\n",
+           (unsigned long)stats.uxCallbacksDispatched, (unsigned long)stats.uxServiceTaskWakeUps,
+           (unsigned long)stats.xMaxDispatchLatency);
+    CHECK(stats.xMaxDispatchLatency <= 40);
+    CHECK(stats.uxServiceTaskWakeUps < stats.uxCallbacksDispatched);
+
+    printf("%s\n", fails ? "FAIL" : "PASS");
+    exit(fails ? 1 : 0);
+}
+
+int main(void)
+{
+    xTaskCreate(main_task, "main", configMINIMAL_STACK_SIZE, NULL, configTIMER_TASK_PRIORITY + 1, NULL);
+    vTaskStartScheduler();
+    return 2;
+}
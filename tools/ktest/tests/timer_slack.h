@@ -0,0 +1,6 @@
+/* Kernel settings for timer_slack.c. */
+#define configUSE_TIMER_SLACK					1
+#define configGENERATE_TIMER_COMMAND_STATS		1
+
+/* Overflows 500 ticks into the run. */
+#define configINITIAL_TICK_COUNT				( ( TickType_t ) -500 )
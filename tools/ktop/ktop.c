@@ -0,0 +1,637 @@
+/*=====================================================================
+ *  ktop - live "top" for the telemetry stream of the 05_04 template
+ *
+ *  Reads the binary frames sent by Core/Src/telemetry.c, from a serial
+ *  port or from a capture of one, and:
+ *
+ *    - decodes each COBS frame and checks its CRC,
+ *    - applies the deltas to its copy of the task and queue tables,
+ *    - redraws a table of tasks sorted by CPU use, with their state,
+ *      priority and stack high water mark,
+ *    - shows heap use, queue fill levels, the frames that were lost
+ *      on the line or dropped by the target, and the share of the
+ *      target's CPU that the telemetry itself took.
+ *
+ *  Exit status: 0 = end of input, 2 = cannot open or set up the input.
+ *  See README.md for the frame format.
+ *=====================================================================*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define MAX_TASKS       64
+#define MAX_QUEUES      32
+#define NAME_LEN        17
+#define FRAME_MAX       4096
+
+#define FRAME_KEY       1
+#define FRAME_DELTA     2
+
+#define HAS_VALUE       0x01
+#define HAS_STATE       0x02
+#define HAS_NAME        0x04
+
+/* -------------------------------------------------------------------
+ * The host copy of the target's tables.
+ * ------------------------------------------------------------------- */
+typedef struct
+{
+    uint32_t number;
+    char     name[NAME_LEN];    // empty until a frame carries it
+    uint32_t run_time;          // run time in the last period
+    uint32_t stack;             // words
+    int      state;             // eTaskState, -1 until known
+    int      priority;
+} task_t;
+
+typedef struct
+{
+    int      known;
+    char     name[NAME_LEN];
+    uint32_t waiting;
+    uint32_t length;            // 0 until a key frame carries it
+} queue_t;
+
+static task_t   tasks[MAX_TASKS];
+static int      task_count = 0;
+static queue_t  queues[MAX_QUEUES];
+static int      queue_count = 0;
+
+/* Frame header values. */
+static uint32_t tick;
+static uint32_t period;         // run time counter units in the last period
+static uint32_t cost;           // cycles the previous frame took
+static uint32_t cpu_hz;
+static uint32_t period_ms;
+static uint32_t heap_size;
+static uint32_t heap_free;
+static uint32_t heap_min;
+static uint32_t dropped;
+static uint32_t left_out;       // tasks the target had no room for
+static int      frame_type;
+
+/* Line statistics. */
+static unsigned long frames_ok = 0;
+static unsigned long frames_bad = 0;
+static unsigned long frames_lost = 0;
+static int           last_sequence = -1;
+
+static int plain = 0;           // -p: append reports instead of redrawing
+
+static const char *const state_names[] = { "run", "ready", "block", "susp", "del" };
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-b baud] [-p] [-n frames] <serial port | capture | ->\n"
+            "  -b baud    line speed when reading a serial port (default 115200)\n"
+            "  -p         print a report per frame instead of redrawing the screen\n"
+            "  -n frames  stop after this many good frames\n",
+            argv0);
+    exit(2);
+}
+
+/* -------------------------------------------------------------------
+ * Input
+ * ------------------------------------------------------------------- */
+static speed_t baud_to_speed(long baud)
+{
+    switch (baud)
+    {
+    case 9600:   return B9600;
+    case 19200:  return B19200;
+    case 38400:  return B38400;
+    case 57600:  return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+#ifdef B460800
+    case 460800: return B460800;
+#endif
+#ifdef B921600
+    case 921600: return B921600;
+#endif
+    default:     return 0;
+    }
+}
+
+static int open_input(const char *path, long baud)
+{
+    struct termios tio;
+    speed_t speed;
+    int fd;
+
+    if (strcmp(path, "-") == 0)
+    {
+        return STDIN_FILENO;
+    }
+
+    fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+        exit(2);
+    }
+
+    if (isatty(fd))
+    {
+        speed = baud_to_speed(baud);
+        if (speed == 0)
+        {
+            fprintf(stderr, "unsupported baud rate %ld\n", baud);
+            exit(2);
+        }
+        if (tcgetattr(fd, &tio) != 0)
+        {
+            fprintf(stderr, "cannot read the settings of %s: %s\n", path, strerror(errno));
+            exit(2);
+        }
+
+        /* Raw 8N1: the frames are binary. */
+        tio.c_iflag &= ~(tcflag_t)(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON | IXOFF);
+        tio.c_oflag &= ~(tcflag_t)OPOST;
+        tio.c_lflag &= ~(tcflag_t)(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+        tio.c_cflag &= ~(tcflag_t)(CSIZE | PARENB | CSTOPB);
+        tio.c_cflag |= CS8 | CREAD | CLOCAL;
+        tio.c_cc[VMIN] = 1;
+        tio.c_cc[VTIME] = 0;
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+
+        if (tcsetattr(fd, TCSANOW, &tio) != 0)
+        {
+            fprintf(stderr, "cannot set up %s: %s\n", path, strerror(errno));
+            exit(2);
+        }
+        tcflush(fd, TCIFLUSH);
+    }
+
+    return fd;
+}
+
+/* -------------------------------------------------------------------
+ * Frame decoding
+ * ------------------------------------------------------------------- */
+
+/* Decodes one COBS block sequence in place.  Returns the decoded length,
+ * or -1 if the frame is malformed. */
+static int cobs_decode(uint8_t *data, int length)
+{
+    int in = 0;
+    int out = 0;
+
+    while (in < length)
+    {
+        int code = data[in++];
+
+        if (code == 0 || in + code - 1 > length)
+        {
+            return -1;
+        }
+        for (int i = 1; i < code; i++)
+        {
+            data[out++] = data[in++];
+        }
+        if (code != 0xFF && in < length)
+        {
+            data[out++] = 0;
+        }
+    }
+
+    return out;
+}
+
+static uint16_t crc16(const uint8_t *data, int length)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (int i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)(data[i] << 8);
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+/* A bounds-checked reader over one decoded frame. */
+typedef struct
+{
+    const uint8_t *p;
+    const uint8_t *end;
+    int            error;
+} reader_t;
+
+static uint32_t get_u8(reader_t *r)
+{
+    if (r->p >= r->end)
+    {
+        r->error = 1;
+        return 0;
+    }
+    return *r->p++;
+}
+
+static uint32_t get_varint(reader_t *r)
+{
+    uint32_t value = 0;
+
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        uint32_t byte = get_u8(r);
+
+        value |= (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return value;
+        }
+    }
+
+    r->error = 1;
+    return 0;
+}
+
+static void get_name(reader_t *r, char *name)
+{
+    uint32_t length = get_u8(r);
+
+    if (length >= NAME_LEN || r->end - r->p < (long)length)
+    {
+        r->error = 1;
+        return;
+    }
+    memcpy(name, r->p, length);
+    name[length] = '\0';
+    r->p += length;
+}
+
+static task_t *find_task(task_t *list, int count, uint32_t number)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (list[i].number == number)
+        {
+            return &list[i];
+        }
+    }
+    return NULL;
+}
+
+/* Applies one frame.  Returns 0 if it did not parse; the tables are then
+ * left as they were. */
+static int apply_frame(const uint8_t *data, int length)
+{
+    reader_t r = { data, data + length, 0 };
+    task_t next[MAX_TASKS];
+    queue_t next_queues[MAX_QUEUES];
+    uint32_t count, type, sequence, next_task_count;
+    uint32_t new_cpu_hz = cpu_hz, new_period_ms = period_ms, new_heap_size = heap_size;
+    uint32_t new_tick, new_period, new_cost, new_free, new_min, new_dropped, new_left_out;
+    int next_queue_count = queue_count;
+
+    type = get_u8(&r);
+    sequence = get_u8(&r);
+    if (type != FRAME_KEY && type != FRAME_DELTA)
+    {
+        return 0;
+    }
+
+    new_tick = get_varint(&r);
+    new_period = get_varint(&r);
+    new_cost = get_varint(&r);
+    if (type == FRAME_KEY)
+    {
+        new_cpu_hz = get_varint(&r);
+        new_period_ms = get_varint(&r);
+        new_heap_size = get_varint(&r);
+    }
+    new_free = get_varint(&r);
+    new_min = get_varint(&r);
+    new_dropped = get_varint(&r);
+    new_left_out = get_varint(&r);
+
+    /* Every frame lists every task, so the table is rebuilt. */
+    count = get_varint(&r);
+    if (count > MAX_TASKS)
+    {
+        return 0;
+    }
+    next_task_count = count;
+    for (uint32_t i = 0; i < count && !r.error; i++)
+    {
+        task_t *t = &next[i];
+        const task_t *old;
+        uint32_t flags;
+
+        t->number = get_varint(&r);
+        flags = get_u8(&r);
+        t->run_time = get_varint(&r);
+
+        old = find_task(tasks, task_count, t->number);
+        if (old != NULL)
+        {
+            memcpy(t->name, old->name, NAME_LEN);
+            t->stack = old->stack;
+            t->state = old->state;
+            t->priority = old->priority;
+        }
+        else
+        {
+            t->name[0] = '\0';
+            t->stack = 0;
+            t->state = -1;
+            t->priority = 0;
+        }
+
+        if (flags & HAS_VALUE)
+        {
+            t->stack = get_varint(&r);
+        }
+        if (flags & HAS_STATE)
+        {
+            t->state = (int)get_u8(&r);
+            t->priority = (int)get_u8(&r);
+        }
+        if (flags & HAS_NAME)
+        {
+            get_name(&r, t->name);
+        }
+    }
+
+    memcpy(next_queues, queues, sizeof(queues));
+    count = get_varint(&r);
+    for (uint32_t i = 0; i < count && !r.error; i++)
+    {
+        uint32_t index = get_varint(&r);
+        uint32_t flags = get_u8(&r);
+        queue_t *q;
+
+        if (index >= MAX_QUEUES)
+        {
+            return 0;
+        }
+        q = &next_queues[index];
+        q->known = 1;
+        if ((int)index >= next_queue_count)
+        {
+            next_queue_count = (int)index + 1;
+        }
+        if (flags & HAS_VALUE)
+        {
+            q->waiting = get_varint(&r);
+        }
+        if (flags & HAS_NAME)
+        {
+            get_name(&r, q->name);
+            q->length = get_varint(&r);
+        }
+    }
+
+    if (r.error || r.p != r.end)
+    {
+        return 0;
+    }
+
+    if (last_sequence >= 0)
+    {
+        frames_lost += (sequence - (uint32_t)last_sequence - 1) & 0xFF;
+    }
+    last_sequence = (int)sequence;
+
+    frame_type = (int)type;
+    tick = new_tick;
+    period = new_period;
+    cost = new_cost;
+    cpu_hz = new_cpu_hz;
+    period_ms = new_period_ms;
+    heap_size = new_heap_size;
+    heap_free = new_free;
+    heap_min = new_min;
+    dropped = new_dropped;
+    left_out = new_left_out;
+
+    memcpy(tasks, next, sizeof(task_t) * next_task_count);
+    task_count = (int)next_task_count;
+    memcpy(queues, next_queues, sizeof(queues));
+    queue_count = next_queue_count;
+    return 1;
+}
+
+/* -------------------------------------------------------------------
+ * Display
+ * ------------------------------------------------------------------- */
+static int compare_cpu(const void *a, const void *b)
+{
+    const task_t *x = a;
+    const task_t *y = b;
+
+    if (x->run_time != y->run_time)
+    {
+        return x->run_time > y->run_time ? -1 : 1;
+    }
+    return (x->number > y->number) - (x->number < y->number);
+}
+
+static double percent(uint64_t part, uint64_t whole)
+{
+    return whole ? 100.0 * (double)part / (double)whole : 0.0;
+}
+
+static void render(void)
+{
+    task_t sorted[MAX_TASKS];
+    double overhead = 0.0;
+
+    memcpy(sorted, tasks, sizeof(task_t) * (size_t)task_count);
+    qsort(sorted, (size_t)task_count, sizeof(task_t), compare_cpu);
+
+    if (cpu_hz != 0 && period_ms != 0)
+    {
+        overhead = percent(cost, (uint64_t)cpu_hz * period_ms / 1000);
+    }
+
+    if (!plain)
+    {
+        /* Home the cursor and clear the screen. */
+        printf("\033[H\033[2J");
+    }
+
+    printf("ktop  tick %lu  %s frame  ok %lu  bad %lu  lost %lu  dropped %lu\n",
+           (unsigned long)tick, frame_type == FRAME_KEY ? "key" : "delta",
+           frames_ok, frames_bad, frames_lost, (unsigned long)dropped);
+    if (cpu_hz != 0)
+    {
+        printf("cpu %lu MHz  every %lu ms  telemetry %.3f%% cpu\n",
+               (unsigned long)(cpu_hz / 1000000), (unsigned long)period_ms, overhead);
+    }
+    else
+    {
+        printf("waiting for a key frame\n");
+    }
+    printf("heap %lu free of %lu (%.1f%% used), lowest %lu\n",
+           (unsigned long)heap_free, (unsigned long)heap_size,
+           heap_size ? percent(heap_size - heap_free, heap_size) : 0.0, (unsigned long)heap_min);
+    if (left_out != 0)
+    {
+        printf("%lu more tasks not shown: raise TELEMETRY_MAX_TASKS\n", (unsigned long)left_out);
+    }
+    printf("\n");
+
+    printf("  NUM  NAME              STATE  PRIO    CPU%%  STACK\n");
+    for (int i = 0; i < task_count; i++)
+    {
+        const task_t *t = &sorted[i];
+        const char *state = "?";
+
+        if (t->state >= 0 && t->state < (int)(sizeof(state_names) / sizeof(state_names[0])))
+        {
+            state = state_names[t->state];
+        }
+
+        printf("%5lu  %-16s  %-5s  %4d  %6.2f  %5lu\n",
+               (unsigned long)t->number, t->name[0] ? t->name : "?", state, t->priority,
+               percent(t->run_time, period), (unsigned long)t->stack);
+    }
+
+    if (queue_count > 0)
+    {
+        printf("\n  QUEUE             FILL\n");
+        for (int i = 0; i < queue_count; i++)
+        {
+            const queue_t *q = &queues[i];
+            char bar[21];
+            int filled = 0;
+
+            if (!q->known)
+            {
+                continue;
+            }
+            if (q->length != 0)
+            {
+                filled = (int)((q->waiting * 20 + q->length / 2) / q->length);
+                if (filled > 20)
+                {
+                    filled = 20;
+                }
+            }
+            memset(bar, '#', (size_t)filled);
+            memset(bar + filled, '.', (size_t)(20 - filled));
+            bar[20] = '\0';
+
+            printf("  %-16s  %4lu/%-4lu [%s]\n", q->name[0] ? q->name : "?",
+                   (unsigned long)q->waiting, (unsigned long)q->length, bar);
+        }
+    }
+
+    if (plain)
+    {
+        printf("\n");
+    }
+    fflush(stdout);
+}
+
+/* -------------------------------------------------------------------
+ * Main loop
+ * ------------------------------------------------------------------- */
+int main(int argc, char **argv)
+{
+    static uint8_t frame[FRAME_MAX];
+    uint8_t buffer[256];
+    long baud = 115200;
+    long limit = 0;
+    int length = 0;
+    int skipping = 0;           // set while dropping an overlong frame
+    int fd;
+    int arg;
+
+    for (arg = 1; arg < argc && argv[arg][0] == '-' && argv[arg][1] != '\0'; arg++)
+    {
+        if (strcmp(argv[arg], "-b") == 0 && arg + 1 < argc)
+        {
+            baud = atol(argv[++arg]);
+        }
+        else if (strcmp(argv[arg], "-p") == 0)
+        {
+            plain = 1;
+        }
+        else if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc)
+        {
+            limit = atol(argv[++arg]);
+        }
+        else
+        {
+            usage(argv[0]);
+        }
+    }
+    if (arg + 1 != argc)
+    {
+        usage(argv[0]);
+    }
+
+    fd = open_input(argv[arg], baud);
+
+    for (;;)
+    {
+        ssize_t got = read(fd, buffer, sizeof(buffer));
+
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (got <= 0)
+        {
+            break;
+        }
+
+        for (ssize_t i = 0; i < got; i++)
+        {
+            if (buffer[i] != 0)
+            {
+                /* An overlong frame is garbage; skip to the next zero. */
+                if (length == FRAME_MAX)
+                {
+                    skipping = 1;
+                }
+                else
+                {
+                    frame[length++] = buffer[i];
+                }
+                continue;
+            }
+
+            if (!skipping && length > 0)
+            {
+                int decoded = cobs_decode(frame, length);
+
+                if (decoded >= 4 &&
+                    crc16(frame, decoded - 2) == (frame[decoded - 2] | (frame[decoded - 1] << 8)) &&
+                    apply_frame(frame, decoded - 2))
+                {
+                    frames_ok++;
+                    render();
+                    if (limit > 0 && (long)frames_ok >= limit)
+                    {
+                        return 0;
+                    }
+                }
+                else
+                {
+                    frames_bad++;
+                }
+            }
+
+            length = 0;
+            skipping = 0;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,580 @@
+/*=====================================================================
+ *  pcprof - per-task profiles from PC sampler captures
+ *
+ *  Reads the "pcs" lines printed by the PC sampler of the 05_04
+ *  template (Core/Src/pc_sampler.c), or of the Linux build in
+ *  free-rtos-in-vs-code, and the matching ELF file, and:
+ *
+ *    - maps every sampled PC to the function that contains it, using
+ *      the ELF symbol table,
+ *    - prints, for each task, its share of the samples and the
+ *      functions the samples landed in,
+ *    - with -f, writes folded stacks (task;caller;function count) for
+ *      flamegraph.pl or speedscope,
+ *    - reports the CPU time the sampler itself took.
+ *
+ *  Exit status: 0 = report written, 2 = input error.
+ *  See README.md for the capture format.
+ *=====================================================================*/
+
+#include <elf.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_TASKS       64
+#define NAME_LEN        32
+#define LINE_LEN        512
+
+/* LR values from 0xFFFFFFE0 up are EXC_RETURN codes: the sample hit the
+ * first instructions of an interrupt handler, which has no caller. */
+#define EXC_RETURN_MIN  0xFFFFFFE0UL
+
+#define NO_SYMBOL       (-1)
+
+/* -------------------------------------------------------------------
+ * A function from the ELF symbol table.
+ * ------------------------------------------------------------------- */
+typedef struct
+{
+    uint64_t    addr;
+    uint64_t    size;
+    const char *name;
+} symbol_t;
+
+/* A task named by a "pcs task" line. */
+typedef struct
+{
+    unsigned long handle;
+    char          name[NAME_LEN];
+    uint64_t      samples;
+} task_t;
+
+/* One sample after symbolisation. */
+typedef struct
+{
+    int task;
+    int caller;                 // function the LR points into, or NO_SYMBOL
+    int function;               // function the PC points into, or NO_SYMBOL
+} sample_t;
+
+static symbol_t *symbols = NULL;
+static int       symbol_count = 0;
+static int       thumb = 0;     // ARM ELF: clear bit 0 of function addresses
+static char     *elf_data = NULL;
+
+static task_t    tasks[MAX_TASKS];
+static int       task_count = 0;
+
+static sample_t *samples = NULL;
+static size_t    sample_count = 0;
+static size_t    sample_capacity = 0;
+
+static unsigned long rate_hz = 0;
+static unsigned long cpu_hz = 0;
+static int           captures = 0;
+static uint64_t      sampler_cycles = 0;
+static uint64_t      elapsed_cycles = 0;
+
+static void fail(const char *file, int line, const char *msg, const char *arg)
+{
+    fprintf(stderr, "%s:%d: %s%s%s\n", file, line, msg, arg ? " " : "", arg ? arg : "");
+    exit(2);
+}
+
+/* -------------------------------------------------------------------
+ * ELF symbol table
+ * ------------------------------------------------------------------- */
+static void add_symbol(uint64_t addr, uint64_t size, const char *name)
+{
+    static int capacity = 0;
+
+    if (symbol_count == capacity)
+    {
+        capacity = capacity ? capacity * 2 : 1024;
+        symbols = realloc(symbols, (size_t)capacity * sizeof(symbol_t));
+        if (symbols == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(2);
+        }
+    }
+
+    symbols[symbol_count].addr = thumb ? (addr & ~(uint64_t)1) : addr;
+    symbols[symbol_count].size = size;
+    symbols[symbol_count].name = name;
+    symbol_count++;
+}
+
+/* The two ELF classes only differ in field widths, so one body serves
+ * both. */
+#define LOAD_SYMBOLS(Ehdr, Shdr, Sym, ST_TYPE)                                         \
+    do                                                                                  \
+    {                                                                                   \
+        const Ehdr *eh = (const Ehdr *)elf_data;                                        \
+        const Shdr *sh;                                                                 \
+                                                                                        \
+        if (eh->e_shoff == 0 || eh->e_shoff + (uint64_t)eh->e_shnum * sizeof(Shdr) > size) \
+        {                                                                               \
+            fail(path, 0, "no section headers", NULL);                                  \
+        }                                                                               \
+        sh = (const Shdr *)(elf_data + eh->e_shoff);                                    \
+        thumb = (eh->e_machine == EM_ARM);                                              \
+                                                                                        \
+        for (int s = 0; s < eh->e_shnum; s++)                                           \
+        {                                                                               \
+            const Sym *sym;                                                             \
+            const char *strtab;                                                         \
+            size_t count;                                                               \
+                                                                                        \
+            if (sh[s].sh_type != SHT_SYMTAB || sh[s].sh_link >= eh->e_shnum ||          \
+                sh[s].sh_offset + sh[s].sh_size > size ||                               \
+                sh[sh[s].sh_link].sh_offset + sh[sh[s].sh_link].sh_size > size)         \
+            {                                                                           \
+                continue;                                                               \
+            }                                                                           \
+            sym = (const Sym *)(elf_data + sh[s].sh_offset);                            \
+            strtab = elf_data + sh[sh[s].sh_link].sh_offset;                            \
+            count = sh[s].sh_size / sizeof(Sym);                                        \
+                                                                                        \
+            for (size_t i = 0; i < count; i++)                                          \
+            {                                                                           \
+                if (ST_TYPE(sym[i].st_info) == STT_FUNC && sym[i].st_value != 0 &&      \
+                    sym[i].st_name < sh[sh[s].sh_link].sh_size)                         \
+                {                                                                       \
+                    add_symbol(sym[i].st_value, sym[i].st_size, strtab + sym[i].st_name); \
+                }                                                                       \
+            }                                                                           \
+        }                                                                               \
+    } while (0)
+
+static int compare_symbol(const void *a, const void *b)
+{
+    const symbol_t *x = a;
+    const symbol_t *y = b;
+
+    if (x->addr != y->addr)
+    {
+        return x->addr < y->addr ? -1 : 1;
+    }
+    /* Prefer the symbol with a size among aliases. */
+    return (x->size < y->size) - (x->size > y->size);
+}
+
+static void load_elf(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    long length;
+    uint64_t size;
+
+    if (f == NULL)
+    {
+        fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+        exit(2);
+    }
+
+    fseek(f, 0, SEEK_END);
+    length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    size = length > 0 ? (uint64_t)length : 0;
+
+    elf_data = malloc(size > 0 ? (size_t)size : 1);
+    if (elf_data == NULL || size < EI_NIDENT || fread(elf_data, 1, (size_t)size, f) != (size_t)size)
+    {
+        fail(path, 0, "cannot read file", NULL);
+    }
+    fclose(f);
+
+    if (memcmp(elf_data, ELFMAG, SELFMAG) != 0)
+    {
+        fail(path, 0, "not an ELF file", NULL);
+    }
+
+    if (elf_data[EI_CLASS] == ELFCLASS32)
+    {
+        LOAD_SYMBOLS(Elf32_Ehdr, Elf32_Shdr, Elf32_Sym, ELF32_ST_TYPE);
+    }
+    else
+    {
+        LOAD_SYMBOLS(Elf64_Ehdr, Elf64_Shdr, Elf64_Sym, ELF64_ST_TYPE);
+    }
+
+    if (symbol_count == 0)
+    {
+        fail(path, 0, "no function symbols, was the file stripped?", NULL);
+    }
+
+    qsort(symbols, (size_t)symbol_count, sizeof(symbol_t), compare_symbol);
+}
+
+/* Returns the function that contains addr, or NO_SYMBOL. */
+static int find_symbol(uint64_t addr)
+{
+    int lo = 0;
+    int hi = symbol_count - 1;
+    int found = NO_SYMBOL;
+
+    while (lo <= hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+
+        if (symbols[mid].addr <= addr)
+        {
+            found = mid;
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+
+    /* Step back over aliases at the same address to the sized one. */
+    while (found > 0 && symbols[found - 1].addr == symbols[found].addr)
+    {
+        found--;
+    }
+
+    if (found != NO_SYMBOL && symbols[found].size != 0 &&
+        addr >= symbols[found].addr + symbols[found].size)
+    {
+        found = NO_SYMBOL;
+    }
+    return found;
+}
+
+static const char *symbol_name(int index)
+{
+    return index == NO_SYMBOL ? "[unknown]" : symbols[index].name;
+}
+
+/* -------------------------------------------------------------------
+ * Capture
+ * ------------------------------------------------------------------- */
+static int find_task(unsigned long handle)
+{
+    for (int i = 0; i < task_count; i++)
+    {
+        if (tasks[i].handle == handle)
+        {
+            return i;
+        }
+    }
+
+    if (task_count == MAX_TASKS)
+    {
+        fprintf(stderr, "more than %d tasks\n", MAX_TASKS);
+        exit(2);
+    }
+
+    /* Named later by a "pcs task" line, or never if it was deleted. */
+    tasks[task_count].handle = handle;
+    if (handle == 0)
+    {
+        snprintf(tasks[task_count].name, NAME_LEN, "[interrupts]");
+    }
+    else
+    {
+        snprintf(tasks[task_count].name, NAME_LEN, "task-%lx", handle);
+    }
+    return task_count++;
+}
+
+static void add_sample(unsigned long handle, uint64_t pc, uint64_t lr)
+{
+    sample_t *s;
+    int caller = NO_SYMBOL;
+
+    if (sample_count == sample_capacity)
+    {
+        sample_capacity = sample_capacity ? sample_capacity * 2 : 4096;
+        samples = realloc(samples, sample_capacity * sizeof(sample_t));
+        if (samples == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(2);
+        }
+    }
+
+    s = &samples[sample_count++];
+    s->task = find_task(handle);
+    s->function = find_symbol(pc);
+
+    /* LR holds the return address of the last call.  Looking one byte
+     * before it lands on the call instruction in the caller.  Inside a
+     * function that has called others since, LR points back into the
+     * function itself, which says nothing about its caller. */
+    if (lr != 0 && lr < EXC_RETURN_MIN)
+    {
+        caller = find_symbol((lr & ~(uint64_t)1) - 1);
+        if (caller == s->function)
+        {
+            caller = NO_SYMBOL;
+        }
+    }
+    s->caller = caller;
+    tasks[s->task].samples++;
+}
+
+static void load_capture(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[LINE_LEN];
+    int lineno = 0;
+
+    if (f == NULL)
+    {
+        fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+        exit(2);
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        unsigned long handle, a, b, c;
+        char name[NAME_LEN];
+        char *p = line;
+
+        lineno++;
+
+        /* Serial captures may carry other output and CR/LF endings. */
+        if (strncmp(p, "pcs ", 4) != 0)
+        {
+            continue;
+        }
+        p += 4;
+
+        if (sscanf(p, "s %lx %lx %lx", &handle, &a, &b) == 3)
+        {
+            add_sample(handle, a, b);
+        }
+        else if (sscanf(p, "task %lx %31s", &handle, name) == 2)
+        {
+            snprintf(tasks[find_task(handle)].name, NAME_LEN, "%s", name);
+        }
+        else if (sscanf(p, "begin %lu %lu", &a, &b) == 2)
+        {
+            if (rate_hz != 0 && (rate_hz != a || cpu_hz != b))
+            {
+                fail(path, lineno, "captures with different rates", NULL);
+            }
+            rate_hz = a;
+            cpu_hz = b;
+            captures++;
+        }
+        else if (sscanf(p, "end %lx %lx %lx", &a, &b, &c) == 3)
+        {
+            sampler_cycles += b;
+            elapsed_cycles += c;
+        }
+        else
+        {
+            fail(path, lineno, "bad pcs line", NULL);
+        }
+    }
+
+    fclose(f);
+
+    if (sample_count == 0)
+    {
+        fail(path, lineno, "no samples found", NULL);
+    }
+}
+
+/* -------------------------------------------------------------------
+ * Output
+ * ------------------------------------------------------------------- */
+static int compare_sample(const void *a, const void *b)
+{
+    const sample_t *x = a;
+    const sample_t *y = b;
+
+    if (x->task != y->task)
+    {
+        return x->task - y->task;
+    }
+    if (x->function != y->function)
+    {
+        return x->function - y->function;
+    }
+    return x->caller - y->caller;
+}
+
+static int compare_task(const void *a, const void *b)
+{
+    const task_t *x = a;
+    const task_t *y = b;
+
+    return (x->samples < y->samples) - (x->samples > y->samples);
+}
+
+/* Folded stacks, one line per distinct task;caller;function. */
+static void print_folded(void)
+{
+    size_t i = 0;
+
+    while (i < sample_count)
+    {
+        size_t run = i;
+
+        while (run < sample_count && compare_sample(&samples[run], &samples[i]) == 0)
+        {
+            run++;
+        }
+
+        printf("%s;", tasks[samples[i].task].name);
+        if (samples[i].caller != NO_SYMBOL)
+        {
+            printf("%s;", symbol_name(samples[i].caller));
+        }
+        printf("%s %zu\n", symbol_name(samples[i].function), run - i);
+        i = run;
+    }
+}
+
+typedef struct
+{
+    int      function;
+    uint64_t count;
+} function_count_t;
+
+static int compare_count(const void *a, const void *b)
+{
+    const function_count_t *x = a;
+    const function_count_t *y = b;
+
+    return (x->count < y->count) - (x->count > y->count);
+}
+
+static void print_report(int top)
+{
+    function_count_t *counts = malloc(sample_count * sizeof(function_count_t));
+    task_t order[MAX_TASKS];
+
+    if (counts == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(2);
+    }
+
+    printf("%zu samples", sample_count);
+    if (captures > 0)
+    {
+        printf(" in %d capture%s at %lu Hz", captures, captures == 1 ? "" : "s", rate_hz);
+    }
+    printf(", %d functions in the ELF\n", symbol_count);
+
+    if (elapsed_cycles > 0)
+    {
+        printf("sampler overhead: %.2f%% of the CPU, %llu cycles per sample\n",
+               100.0 * (double)sampler_cycles / (double)elapsed_cycles,
+               (unsigned long long)(sampler_cycles / sample_count));
+    }
+
+    memcpy(order, tasks, (size_t)task_count * sizeof(task_t));
+    qsort(order, (size_t)task_count, sizeof(task_t), compare_task);
+
+    printf("\n%-20s %8s %7s\n", "task", "samples", "share");
+    for (int t = 0; t < task_count; t++)
+    {
+        printf("%-20s %8llu %6.1f%%\n", order[t].name, (unsigned long long)order[t].samples,
+               100.0 * (double)order[t].samples / (double)sample_count);
+    }
+
+    for (int t = 0; t < task_count; t++)
+    {
+        int task = find_task(order[t].handle);
+        size_t n = 0;
+
+        /* samples[] is sorted by task then function. */
+        for (size_t i = 0; i < sample_count; i++)
+        {
+            if (samples[i].task != task)
+            {
+                continue;
+            }
+            if (n > 0 && counts[n - 1].function == samples[i].function)
+            {
+                counts[n - 1].count++;
+            }
+            else
+            {
+                counts[n].function = samples[i].function;
+                counts[n].count = 1;
+                n++;
+            }
+        }
+        qsort(counts, n, sizeof(function_count_t), compare_count);
+
+        printf("\n%s: %llu samples\n", order[t].name, (unsigned long long)order[t].samples);
+        for (size_t i = 0; i < n && (int)i < top; i++)
+        {
+            printf("  %6.1f%% %8llu  %s\n", 100.0 * (double)counts[i].count / (double)order[t].samples,
+                   (unsigned long long)counts[i].count, symbol_name(counts[i].function));
+        }
+    }
+
+    free(counts);
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s -e firmware.elf [-f] [-n count] capture.log [capture.log ...]\n"
+            "  -e  ELF file of the firmware that was sampled, with symbols\n"
+            "  -f  write folded stacks for flamegraph.pl instead of the report\n"
+            "  -n  functions listed per task (default 10)\n",
+            argv0);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    const char *elf_path = NULL;
+    int folded = 0;
+    int top = 10;
+    int first_file;
+
+    for (first_file = 1; first_file < argc && argv[first_file][0] == '-'; first_file++)
+    {
+        if (strcmp(argv[first_file], "-e") == 0 && first_file + 1 < argc)
+        {
+            elf_path = argv[++first_file];
+        }
+        else if (strcmp(argv[first_file], "-f") == 0)
+        {
+            folded = 1;
+        }
+        else if (strcmp(argv[first_file], "-n") == 0 && first_file + 1 < argc)
+        {
+            top = atoi(argv[++first_file]);
+        }
+        else
+        {
+            usage(argv[0]);
+        }
+    }
+    if (elf_path == NULL || first_file >= argc)
+    {
+        usage(argv[0]);
+    }
+
+    load_elf(elf_path);
+    for (int f = first_file; f < argc; f++)
+    {
+        load_capture(argv[f]);
+    }
+
+    qsort(samples, sample_count, sizeof(sample_t), compare_sample);
+
+    if (folded)
+    {
+        print_folded();
+    }
+    else
+    {
+        print_report(top);
+    }
+    return 0;
+}
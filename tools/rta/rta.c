@@ -0,0 +1,940 @@
+/*=====================================================================
+ *  rta - offline response-time analysis for FreeRTOS task sets
+ *
+ *  Reads one or more task-set files (a hand-written description plus,
+ *  optionally, a file of numbers measured on the target) and the
+ *  project's FreeRTOSConfig.h, then:
+ *
+ *    - computes the worst-case response time (WCRT) of every task with
+ *      classic fixed-priority response-time analysis, including release
+ *      jitter, tick interrupt overhead and priority-inheritance blocking
+ *      for mutexes,
+ *    - flags tasks whose WCRT exceeds their deadline,
+ *    - recommends a priority assignment that fits into
+ *      1 .. configMAX_PRIORITIES-1 (0 is left to the idle task).
+ *
+ *  Exit status: 0 = schedulable, 1 = NOT schedulable, 2 = input error.
+ *  See README.md for the file format.
+ *=====================================================================*/
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_TASKS       64
+#define MAX_RESOURCES   32
+#define MAX_USES        256
+#define NAME_LEN        32
+#define LINE_LEN        512
+
+#define NS_PER_US       1000ULL
+#define NS_PER_MS       1000000ULL
+#define NS_PER_S        1000000000ULL
+#define TIME_INFINITE   UINT64_MAX
+
+/* -------------------------------------------------------------------
+ * Kernel settings taken from FreeRTOSConfig.h
+ * ------------------------------------------------------------------- */
+typedef struct
+{
+    uint64_t tick_rate_hz;      // configTICK_RATE_HZ
+    int      max_priorities;    // configMAX_PRIORITIES
+    int      time_slicing;      // configUSE_TIME_SLICING (defaults to 1)
+    char     path[LINE_LEN];
+} kernel_config_t;
+
+/* -------------------------------------------------------------------
+ * One task of the analysed set. All times are in nanoseconds.
+ * ------------------------------------------------------------------- */
+typedef struct
+{
+    char     name[NAME_LEN];
+    int      prio;              // priority passed to xTaskCreate(), -1 if unset
+    uint64_t period;            // minimum inter-arrival time
+    uint64_t wcet;              // worst-case execution time
+    uint64_t jitter;            // release jitter
+    uint64_t deadline;          // relative deadline (defaults to period)
+    uint64_t cs[MAX_RESOURCES]; // longest critical section per mutex
+} task_t;
+
+/* A "resource" line names a mutex and the tasks that take it. */
+typedef struct
+{
+    char name[NAME_LEN];
+} resource_t;
+
+/* A resource use is kept by task name until every file has been read. */
+typedef struct
+{
+    char     task[NAME_LEN];
+    int      resource;
+    uint64_t length;
+} resource_use_t;
+
+static kernel_config_t config = { 1000, 5, 1, "" };
+static task_t          tasks[MAX_TASKS];
+static int             task_count = 0;
+static resource_t      resources[MAX_RESOURCES];
+static int             resource_count = 0;
+static resource_use_t  uses[MAX_USES];
+static int             use_count = 0;
+static uint64_t        runtime_hz = 0;     // run-time stats counter frequency
+static uint64_t        tick_isr_wcet = 0;  // cost of one tick interrupt
+
+/* -------------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------------- */
+static void fail(const char *file, int line, const char *msg, const char *arg)
+{
+    fprintf(stderr, "%s:%d: %s%s%s\n", file, line, msg, arg ? " " : "", arg ? arg : "");
+    exit(2);
+}
+
+static uint64_t tick_period_ns(void)
+{
+    return NS_PER_S / config.tick_rate_hz;
+}
+
+static uint64_t div_ceil(uint64_t a, uint64_t b)
+{
+    return (a + b - 1) / b;
+}
+
+/* Parse "<number><unit>" where unit is ns, us, ms, s, t/tick/ticks or
+ * cyc/cycles (run-time statistics counts, needs runtime_hz).
+ * Returns 0 on success. */
+static int parse_time(const char *text, uint64_t *out)
+{
+    char *end;
+    double value;
+
+    errno = 0;
+    value = strtod(text, &end);
+    if (errno != 0 || end == text || value < 0.0)
+    {
+        return -1;
+    }
+
+    if (strcmp(end, "ns") == 0)
+    {
+        *out = (uint64_t)(value + 0.5);
+    }
+    else if (strcmp(end, "us") == 0)
+    {
+        *out = (uint64_t)(value * NS_PER_US + 0.5);
+    }
+    else if (strcmp(end, "ms") == 0)
+    {
+        *out = (uint64_t)(value * NS_PER_MS + 0.5);
+    }
+    else if (strcmp(end, "s") == 0)
+    {
+        *out = (uint64_t)(value * NS_PER_S + 0.5);
+    }
+    else if (strcmp(end, "t") == 0 || strcmp(end, "tick") == 0 || strcmp(end, "ticks") == 0)
+    {
+        *out = (uint64_t)(value * (double)tick_period_ns() + 0.5);
+    }
+    else if (strcmp(end, "cyc") == 0 || strcmp(end, "cycles") == 0)
+    {
+        if (runtime_hz == 0)
+        {
+            return -2;
+        }
+        *out = (uint64_t)(value * (double)NS_PER_S / (double)runtime_hz + 0.5);
+    }
+    else
+    {
+        return -1;
+    }
+    return 0;
+}
+
+static int find_task(const char *name)
+{
+    for (int i = 0; i < task_count; i++)
+    {
+        if (strcmp(tasks[i].name, name) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int find_resource(const char *name)
+{
+    for (int i = 0; i < resource_count; i++)
+    {
+        if (strcmp(resources[i].name, name) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* -------------------------------------------------------------------
+ * FreeRTOSConfig.h
+ *
+ * Only plain numeric #defines are needed, e.g.
+ *   #define configTICK_RATE_HZ   ((TickType_t)1000)
+ *   #define configMAX_PRIORITIES ( 7 )
+ * The first decimal number found in the value is used.
+ * ------------------------------------------------------------------- */
+static int config_value(const char *line, const char *macro, long *out)
+{
+    const char *p = line;
+    size_t len = strlen(macro);
+
+    while (isspace((unsigned char)*p))
+    {
+        p++;
+    }
+    if (*p != '#')
+    {
+        return 0;
+    }
+    p++;
+    while (isspace((unsigned char)*p))
+    {
+        p++;
+    }
+    if (strncmp(p, "define", 6) != 0)
+    {
+        return 0;
+    }
+    p += 6;
+    while (isspace((unsigned char)*p))
+    {
+        p++;
+    }
+    if (strncmp(p, macro, len) != 0 || !isspace((unsigned char)p[len]))
+    {
+        return 0;
+    }
+    p += len;
+
+    /* Skip casts such as (TickType_t) before the number. */
+    while (*p != '\0')
+    {
+        if (*p == '(')
+        {
+            const char *close = strchr(p, ')');
+            const char *q = p + 1;
+            while (isspace((unsigned char)*q))
+            {
+                q++;
+            }
+            if (close != NULL && (isalpha((unsigned char)*q) || *q == '_'))
+            {
+                p = close + 1;
+                continue;
+            }
+        }
+        if (isdigit((unsigned char)*p))
+        {
+            *out = strtol(p, NULL, 0);
+            return 1;
+        }
+        if (*p == '/' && (p[1] == '*' || p[1] == '/'))
+        {
+            break;
+        }
+        p++;
+    }
+    return 0;
+}
+
+static void load_config(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[LINE_LEN];
+    long value;
+    int found_tick = 0, found_prio = 0;
+
+    if (f == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        exit(2);
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        if (config_value(line, "configTICK_RATE_HZ", &value) && value > 0)
+        {
+            config.tick_rate_hz = (uint64_t)value;
+            found_tick = 1;
+        }
+        else if (config_value(line, "configMAX_PRIORITIES", &value) && value > 0)
+        {
+            config.max_priorities = (int)value;
+            found_prio = 1;
+        }
+        else if (config_value(line, "configUSE_TIME_SLICING", &value))
+        {
+            config.time_slicing = (value != 0);
+        }
+    }
+    fclose(f);
+
+    if (!found_tick || !found_prio)
+    {
+        fprintf(stderr, "%s: configTICK_RATE_HZ or configMAX_PRIORITIES not found\n", path);
+        exit(2);
+    }
+    snprintf(config.path, sizeof(config.path), "%s", path);
+}
+
+/* -------------------------------------------------------------------
+ * Task-set files
+ *
+ *   runtime_hz <hz>
+ *   tick_isr   <time>
+ *   task       <name> [prio=<n>] [period=<t>] [wcet=<t>] [jitter=<t>] [deadline=<t>]
+ *   resource   <mutex> <task>=<t> [<task>=<t> ...]
+ *
+ * A later "task" line for an existing name only overrides the fields it
+ * lists, so measured numbers can be kept in a separate file.
+ * ------------------------------------------------------------------- */
+static void load_taskset(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[LINE_LEN];
+    int line_no = 0;
+
+    if (f == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        exit(2);
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        char *hash = strchr(line, '#');
+        char *word;
+        char *save;
+
+        line_no++;
+        if (hash != NULL)
+        {
+            *hash = '\0';
+        }
+
+        word = strtok_r(line, " \t\r\n", &save);
+        if (word == NULL)
+        {
+            continue;
+        }
+
+        if (strcmp(word, "runtime_hz") == 0)
+        {
+            char *value = strtok_r(NULL, " \t\r\n", &save);
+            if (value == NULL || (runtime_hz = strtoull(value, NULL, 10)) == 0)
+            {
+                fail(path, line_no, "bad runtime_hz", value);
+            }
+        }
+        else if (strcmp(word, "tick_isr") == 0)
+        {
+            char *value = strtok_r(NULL, " \t\r\n", &save);
+            if (value == NULL || parse_time(value, &tick_isr_wcet) != 0)
+            {
+                fail(path, line_no, "bad tick_isr time", value);
+            }
+        }
+        else if (strcmp(word, "task") == 0)
+        {
+            char *name = strtok_r(NULL, " \t\r\n", &save);
+            char *field;
+            int index;
+
+            if (name == NULL || strlen(name) >= NAME_LEN)
+            {
+                fail(path, line_no, "missing or too long task name", name);
+            }
+
+            index = find_task(name);
+            if (index < 0)
+            {
+                if (task_count == MAX_TASKS)
+                {
+                    fail(path, line_no, "too many tasks", NULL);
+                }
+                index = task_count++;
+                memset(&tasks[index], 0, sizeof(task_t));
+                strcpy(tasks[index].name, name);
+                tasks[index].prio = -1;
+            }
+
+            while ((field = strtok_r(NULL, " \t\r\n", &save)) != NULL)
+            {
+                char *value = strchr(field, '=');
+                uint64_t *target = NULL;
+                int rc;
+
+                if (value == NULL)
+                {
+                    fail(path, line_no, "expected key=value, got", field);
+                }
+                *value++ = '\0';
+
+                if (strcmp(field, "prio") == 0)
+                {
+                    char *end;
+                    long prio = strtol(value, &end, 10);
+
+                    /* 0 is left to the idle task. */
+                    if (end == value || *end != '\0' || prio < 1 || prio >= config.max_priorities)
+                    {
+                        fail(path, line_no, "priority not in 1 .. configMAX_PRIORITIES-1:", value);
+                    }
+                    tasks[index].prio = (int)prio;
+                    continue;
+                }
+                else if (strcmp(field, "period") == 0)
+                {
+                    target = &tasks[index].period;
+                }
+                else if (strcmp(field, "wcet") == 0)
+                {
+                    target = &tasks[index].wcet;
+                }
+                else if (strcmp(field, "jitter") == 0)
+                {
+                    target = &tasks[index].jitter;
+                }
+                else if (strcmp(field, "deadline") == 0)
+                {
+                    target = &tasks[index].deadline;
+                }
+                else
+                {
+                    fail(path, line_no, "unknown task field", field);
+                }
+
+                rc = parse_time(value, target);
+                if (rc == -2)
+                {
+                    fail(path, line_no, "cycle counts need a runtime_hz line first:", value);
+                }
+                else if (rc != 0)
+                {
+                    fail(path, line_no, "bad time", value);
+                }
+            }
+        }
+        else if (strcmp(word, "resource") == 0)
+        {
+            char *name = strtok_r(NULL, " \t\r\n", &save);
+            char *use;
+            int res;
+
+            if (name == NULL || strlen(name) >= NAME_LEN)
+            {
+                fail(path, line_no, "missing or too long resource name", name);
+            }
+
+            res = find_resource(name);
+            if (res < 0)
+            {
+                if (resource_count == MAX_RESOURCES)
+                {
+                    fail(path, line_no, "too many resources", NULL);
+                }
+                res = resource_count++;
+                strcpy(resources[res].name, name);
+            }
+
+            while ((use = strtok_r(NULL, " \t\r\n", &save)) != NULL)
+            {
+                char *value = strchr(use, '=');
+                int rc;
+
+                if (value == NULL || value == use || (size_t)(value - use) >= NAME_LEN)
+                {
+                    fail(path, line_no, "expected <task>=<time>, got", use);
+                }
+                if (use_count == MAX_USES)
+                {
+                    fail(path, line_no, "too many resource uses", NULL);
+                }
+                *value++ = '\0';
+                strcpy(uses[use_count].task, use);
+                uses[use_count].resource = res;
+                rc = parse_time(value, &uses[use_count].length);
+                if (rc != 0)
+                {
+                    fail(path, line_no, "bad critical section time", value);
+                }
+                use_count++;
+            }
+        }
+        else
+        {
+            fail(path, line_no, "unknown directive", word);
+        }
+    }
+    fclose(f);
+}
+
+/* Resolve resource uses by name and check every task is complete. */
+static void finish_taskset(void)
+{
+    int errors = 0;
+
+    for (int u = 0; u < use_count; u++)
+    {
+        int t = find_task(uses[u].task);
+        if (t < 0)
+        {
+            fprintf(stderr, "resource %s: unknown task %s\n",
+                    resources[uses[u].resource].name, uses[u].task);
+            errors++;
+            continue;
+        }
+        if (uses[u].length > tasks[t].cs[uses[u].resource])
+        {
+            tasks[t].cs[uses[u].resource] = uses[u].length;
+        }
+    }
+
+    for (int i = 0; i < task_count; i++)
+    {
+        task_t *t = &tasks[i];
+
+        if (t->period == 0 || t->wcet == 0)
+        {
+            fprintf(stderr, "task %s: period and wcet are required\n", t->name);
+            errors++;
+        }
+        if (t->deadline == 0)
+        {
+            t->deadline = t->period;
+        }
+    }
+
+    if (task_count == 0)
+    {
+        fprintf(stderr, "no tasks given\n");
+        errors++;
+    }
+    if (errors)
+    {
+        exit(2);
+    }
+}
+
+/* -------------------------------------------------------------------
+ * Analysis
+ *
+ * prio[] is the priority vector being analysed; tasks with equal
+ * priority share the CPU through time slicing, so each is treated as
+ * interfering with the other (a safe bound).
+ *
+ * Without time slicing a task of equal priority keeps the CPU until it
+ * blocks, and a task made ready goes to the back of its priority's ready
+ * list, so tasks of equal priority run in release order. That only holds
+ * while no higher priority task preempts: the scheduler then moves on to
+ * the next task of the preempted priority, not back to the preempted one.
+ * So equal priority tasks are modelled as non-preemptive among themselves
+ * only for a task with no task of higher priority: each delays it by at
+ * most the one job queued ahead of it. Otherwise the time slicing bound,
+ * which also covers this case, is used.
+ * ------------------------------------------------------------------- */
+
+/* Highest priority of any task that takes the mutex. */
+static int ceiling(int res, const int *prio)
+{
+    int c = -1;
+    for (int j = 0; j < task_count; j++)
+    {
+        if (tasks[j].cs[res] > 0 && prio[j] > c)
+        {
+            c = prio[j];
+        }
+    }
+    return c;
+}
+
+/* Priority-inheritance blocking bound: a task can be blocked at most once
+ * per mutex (by the longest critical section of a lower priority task)
+ * and at most once per lower priority task. The smaller bound holds. */
+static uint64_t blocking(int i, const int *prio)
+{
+    uint64_t by_resource = 0, by_task = 0;
+
+    for (int k = 0; k < resource_count; k++)
+    {
+        uint64_t longest = 0;
+        if (ceiling(k, prio) < prio[i])
+        {
+            continue;
+        }
+        for (int j = 0; j < task_count; j++)
+        {
+            if (prio[j] < prio[i] && tasks[j].cs[k] > longest)
+            {
+                longest = tasks[j].cs[k];
+            }
+        }
+        by_resource += longest;
+    }
+
+    for (int j = 0; j < task_count; j++)
+    {
+        uint64_t longest = 0;
+        if (prio[j] >= prio[i])
+        {
+            continue;
+        }
+        for (int k = 0; k < resource_count; k++)
+        {
+            if (tasks[j].cs[k] > longest && ceiling(k, prio) >= prio[i])
+            {
+                longest = tasks[j].cs[k];
+            }
+        }
+        by_task += longest;
+    }
+
+    return by_resource < by_task ? by_resource : by_task;
+}
+
+/* R = C + B + sum_{j in hep(i)} ceil((R + J_j) / T_j) * C_j + tick ISR load,
+ * iterated to a fixed point, with C_j in place of the ceil() term for the
+ * equal priority tasks when they cannot preempt task i (see above).
+ * Returns the WCRT including the task's own release jitter, or
+ * TIME_INFINITE once the deadline is exceeded. */
+static uint64_t response_time(int i, const int *prio, uint64_t *block_out)
+{
+    const task_t *t = &tasks[i];
+    uint64_t b = blocking(i, prio);
+    uint64_t r = t->wcet + b;
+    uint64_t limit = t->deadline > t->jitter ? t->deadline - t->jitter : 0;
+    int equals_in_order = !config.time_slicing;
+
+    for (int j = 0; j < task_count; j++)
+    {
+        if (prio[j] > prio[i])
+        {
+            equals_in_order = 0;
+        }
+    }
+
+    if (block_out != NULL)
+    {
+        *block_out = b;
+    }
+
+    for (;;)
+    {
+        uint64_t next = t->wcet + b;
+
+        if (tick_isr_wcet > 0)
+        {
+            next += div_ceil(r, tick_period_ns()) * tick_isr_wcet;
+        }
+        for (int j = 0; j < task_count; j++)
+        {
+            if (j != i && prio[j] == prio[i] && equals_in_order)
+            {
+                next += tasks[j].wcet;
+            }
+            else if (j != i && prio[j] >= prio[i])
+            {
+                next += div_ceil(r + tasks[j].jitter, tasks[j].period) * tasks[j].wcet;
+            }
+        }
+
+        if (next > limit)
+        {
+            return TIME_INFINITE;
+        }
+        if (next == r)
+        {
+            return r + t->jitter;
+        }
+        r = next;
+    }
+}
+
+static int all_schedulable(const int *prio)
+{
+    for (int i = 0; i < task_count; i++)
+    {
+        if (response_time(i, prio, NULL) == TIME_INFINITE)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Deadline-monotonic order: shorter deadline first, then shorter period. */
+static int dm_compare(const void *a, const void *b)
+{
+    const task_t *x = &tasks[*(const int *)a];
+    const task_t *y = &tasks[*(const int *)b];
+
+    if (x->deadline != y->deadline)
+    {
+        return x->deadline < y->deadline ? -1 : 1;
+    }
+    if (x->period != y->period)
+    {
+        return x->period < y->period ? -1 : 1;
+    }
+    return strcmp(x->name, y->name);
+}
+
+/* Audsley's optimal priority assignment. Fills order[] highest priority
+ * first and returns 1, or returns 0 if no order makes every task meet
+ * its deadline. Blocking is evaluated with the tasks assigned so far as
+ * the lower priority ones. */
+static int audsley(int *order)
+{
+    int level[MAX_TASKS];
+    int assigned[MAX_TASKS] = { 0 };
+
+    for (int pos = task_count - 1; pos >= 0; pos--)
+    {
+        int lowest = task_count - 1 - pos;   // abstract level being filled
+        int chosen = -1;
+
+        for (int cand = 0; cand < task_count && chosen < 0; cand++)
+        {
+            if (assigned[cand])
+            {
+                continue;
+            }
+            for (int j = 0; j < task_count; j++)
+            {
+                level[j] = assigned[j] ? level[j] : task_count;
+            }
+            level[cand] = lowest;
+            if (response_time(cand, level, NULL) != TIME_INFINITE)
+            {
+                chosen = cand;
+            }
+        }
+
+        if (chosen < 0)
+        {
+            return 0;
+        }
+        assigned[chosen] = 1;
+        level[chosen] = lowest;
+        order[pos] = chosen;
+    }
+    return 1;
+}
+
+/* Map an order (highest first) onto FreeRTOS priorities
+ * 1 .. configMAX_PRIORITIES-1. When there are more tasks than levels,
+ * neighbours in the order share a level. */
+static void order_to_priorities(const int *order, int *prio)
+{
+    int levels = config.max_priorities - 1;
+
+    for (int pos = 0; pos < task_count; pos++)
+    {
+        int from_bottom = task_count - 1 - pos;
+        int level;
+
+        if (task_count <= levels)
+        {
+            level = from_bottom + 1;
+        }
+        else
+        {
+            level = (from_bottom * levels) / task_count + 1;
+        }
+        prio[order[pos]] = level;
+    }
+}
+
+/* -------------------------------------------------------------------
+ * Report
+ * ------------------------------------------------------------------- */
+static void format_time(char *buf, size_t len, uint64_t ns)
+{
+    if (ns == TIME_INFINITE)
+    {
+        snprintf(buf, len, "-");
+    }
+    else if (ns >= NS_PER_MS)
+    {
+        snprintf(buf, len, "%.3fms", (double)ns / NS_PER_MS);
+    }
+    else
+    {
+        snprintf(buf, len, "%.1fus", (double)ns / NS_PER_US);
+    }
+}
+
+static int print_table(const char *title, const int *prio)
+{
+    int ok = 1;
+    char period[24], wcet[24], jitter[24], deadline[24], block[24], wcrt[24];
+
+    printf("\n%s\n", title);
+    printf("  %-16s %4s %11s %11s %11s %11s %11s %11s %7s  %s\n",
+           "task", "prio", "period", "wcet", "jitter", "deadline", "blocking",
+           "wcrt", "ticks", "status");
+
+    for (int p = config.max_priorities - 1; p >= 0; p--)
+    {
+        for (int i = 0; i < task_count; i++)
+        {
+            uint64_t b;
+            uint64_t r;
+
+            if (prio[i] != p)
+            {
+                continue;
+            }
+            r = response_time(i, prio, &b);
+            format_time(period, sizeof(period), tasks[i].period);
+            format_time(wcet, sizeof(wcet), tasks[i].wcet);
+            format_time(jitter, sizeof(jitter), tasks[i].jitter);
+            format_time(deadline, sizeof(deadline), tasks[i].deadline);
+            format_time(block, sizeof(block), b);
+            format_time(wcrt, sizeof(wcrt), r);
+
+            if (r == TIME_INFINITE)
+            {
+                ok = 0;
+                printf("  %-16s %4d %11s %11s %11s %11s %11s %11s %7s  DEADLINE MISS\n",
+                       tasks[i].name, prio[i], period, wcet, jitter, deadline, block, wcrt, "-");
+            }
+            else
+            {
+                printf("  %-16s %4d %11s %11s %11s %11s %11s %11s %7llu  ok\n",
+                       tasks[i].name, prio[i], period, wcet, jitter, deadline, block, wcrt,
+                       (unsigned long long)div_ceil(r, tick_period_ns()));
+            }
+        }
+    }
+    return ok;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s -c FreeRTOSConfig.h [-r runtime_hz] taskset [measurements ...]\n"
+            "  -c  FreeRTOSConfig.h of the project (tick rate, priority levels)\n"
+            "  -r  frequency of the run-time stats counter, for times given in cyc\n",
+            argv0);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    const char *config_path = NULL;
+    int current[MAX_TASKS];
+    int recommended[MAX_TASKS];
+    int order[MAX_TASKS];
+    int have_current = 1;
+    int current_ok = 0;
+    int first_file;
+    double utilisation = 0.0;
+
+    for (first_file = 1; first_file < argc && argv[first_file][0] == '-'; first_file++)
+    {
+        if (strcmp(argv[first_file], "-c") == 0 && first_file + 1 < argc)
+        {
+            config_path = argv[++first_file];
+        }
+        else if (strcmp(argv[first_file], "-r") == 0 && first_file + 1 < argc)
+        {
+            runtime_hz = strtoull(argv[++first_file], NULL, 10);
+        }
+        else
+        {
+            usage(argv[0]);
+        }
+    }
+    if (config_path == NULL || first_file >= argc)
+    {
+        usage(argv[0]);
+    }
+
+    load_config(config_path);
+    for (int f = first_file; f < argc; f++)
+    {
+        load_taskset(argv[f]);
+    }
+    finish_taskset();
+
+    printf("%s: configTICK_RATE_HZ=%llu (1 tick = %.3fms), configMAX_PRIORITIES=%d%s\n",
+           config.path, (unsigned long long)config.tick_rate_hz,
+           (double)tick_period_ns() / NS_PER_MS, config.max_priorities,
+           config.time_slicing ? "" : ", no time slicing");
+
+    for (int i = 0; i < task_count; i++)
+    {
+        utilisation += (double)tasks[i].wcet / (double)tasks[i].period;
+        current[i] = tasks[i].prio;
+        if (current[i] < 0)
+        {
+            have_current = 0;
+        }
+    }
+    if (tick_isr_wcet > 0)
+    {
+        utilisation += (double)tick_isr_wcet / (double)tick_period_ns();
+    }
+    printf("utilisation: %.1f%%\n", utilisation * 100.0);
+
+    if (utilisation > 1.0)
+    {
+        printf("\nNOT SCHEDULABLE: total utilisation exceeds 100%%\n");
+        return 1;
+    }
+
+    if (have_current)
+    {
+        current_ok = print_table("current priorities:", current);
+    }
+
+    /* Recommendation: deadline monotonic first, Audsley if that fails. */
+    for (int i = 0; i < task_count; i++)
+    {
+        order[i] = i;
+    }
+    qsort(order, (size_t)task_count, sizeof(int), dm_compare);
+    order_to_priorities(order, recommended);
+
+    if (all_schedulable(recommended))
+    {
+        print_table("recommended priorities (deadline monotonic):", recommended);
+    }
+    else if (audsley(order))
+    {
+        order_to_priorities(order, recommended);
+        print_table(all_schedulable(recommended)
+                        ? "recommended priorities (Audsley):"
+                        : "best effort priorities (Audsley, too few priority levels):",
+                    recommended);
+    }
+    else
+    {
+        printf("\nno fixed priority assignment meets every deadline\n");
+    }
+
+    if (have_current && !current_ok)
+    {
+        printf("\nNOT SCHEDULABLE with the current priorities\n");
+        return 1;
+    }
+    if (!have_current && !all_schedulable(recommended))
+    {
+        printf("\nNOT SCHEDULABLE\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,549 @@
+/*=====================================================================
+ *  wavesim - host simulator for the waveform engine of the 05_04 template
+ *
+ *  Builds Core/Src/waveform_encode.c, the part of the engine that
+ *  decides what goes on the pins, and plays it the way the target does:
+ *
+ *    - fills the two halves of the buffer with Waveform_Fill(), refills
+ *      a half each time the DMA would finish it and stops when the
+ *      other half holds no stream words, as Core/Src/waveform.c does,
+ *    - applies each BSRR word to a simulated GPIO output register at
+ *      the slot length the timer really produces at its clock,
+ *    - measures every pulse and gap on every lane, decodes the bits back
+ *      and checks them against the data sent and the timing against the
+ *      protocol's tolerances,
+ *    - optionally writes the lanes to a VCD file for a waveform viewer.
+ *
+ *  Exit status: 0 = PASS, 1 = FAIL, 2 = bad arguments.
+ *=====================================================================*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "waveform_encode.h"
+
+#define MAX_ERRORS      10      // timing errors printed per lane
+
+/* -------------------------------------------------------------------
+ * Protocols and what the receiving part accepts.
+ * ------------------------------------------------------------------- */
+typedef struct
+{
+    double t0h;                 // ns, active time of a 0 bit
+    double t1h;                 // ns, active time of a 1 bit
+    double pulse_tol;           // ns, +- on t0h and t1h
+    double bit;                 // ns, period of a bit
+    double bit_tol;             // ns, +- on bit
+    double reset;               // ns, shortest inactive time that latches
+} spec_t;
+
+typedef struct
+{
+    const char *name;
+    WaveformProtocol_t protocol;
+    spec_t spec;
+} preset_t;
+
+static const preset_t presets[] =
+{
+    // WS2812B datasheet: T0H 0.4 us, T1H 0.8 us +- 150 ns, 1.25 us bit
+    // +- 600 ns, reset above 50 us (280 us for the newer parts).
+    { "ws2812", WAVEFORM_PROTOCOL_WS2812,
+      { 400.0, 800.0, 150.0, 1250.0, 600.0, 50000.0 } },
+    // SK6812: T0H 0.3 us, T1H 0.6 us +- 150 ns, 1.2 us bit, reset 80 us.
+    { "sk6812", { 300U, 4U, { 1U, 2U }, 0U, 300U },
+      { 300.0, 600.0, 150.0, 1200.0, 300.0, 80000.0 } },
+};
+
+#define PRESET_COUNT    (sizeof(presets) / sizeof(presets[0]))
+
+/* -------------------------------------------------------------------
+ * Simulated line: the output register after each slot.
+ * ------------------------------------------------------------------- */
+static uint16_t *odr_trace = NULL;
+static size_t trace_len = 0, trace_cap = 0;
+
+static void trace_push(uint16_t odr)
+{
+    if (trace_len == trace_cap)
+    {
+        trace_cap = trace_cap ? trace_cap * 2 : 65536;
+        odr_trace = realloc(odr_trace, trace_cap * sizeof(uint16_t));
+        if (odr_trace == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(2);
+        }
+    }
+    odr_trace[trace_len++] = odr;
+}
+
+static uint16_t apply_bsrr(uint16_t odr, uint32_t word)
+{
+    // Set wins over reset, as on the part.
+    odr = (uint16_t) (odr & ~(word >> 16));
+    return (uint16_t) (odr | (word & 0xFFFF));
+}
+
+/* -------------------------------------------------------------------
+ * The engine, as Core/Src/waveform.c drives the DMA.
+ * ------------------------------------------------------------------- */
+typedef struct
+{
+    unsigned long interrupts;
+    unsigned long transfers;
+} engine_stats_t;
+
+static void run_engine(WaveformStream_t *stream, uint32_t half_words, uint16_t odr,
+                       engine_stats_t *stats)
+{
+    uint32_t *buffers[2];
+    int holds[2];
+    int half = 0;
+
+    buffers[0] = malloc(half_words * sizeof(uint32_t));
+    buffers[1] = malloc(half_words * sizeof(uint32_t));
+    if (buffers[0] == NULL || buffers[1] == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(2);
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    trace_push(odr);            // the idle level before the timer starts
+
+    holds[0] = Waveform_Fill(stream, buffers[0], half_words) != 0;
+    holds[1] = Waveform_Fill(stream, buffers[1], half_words) != 0;
+
+    while (holds[half])
+    {
+        for (uint32_t i = 0; i < half_words; i++)
+        {
+            odr = apply_bsrr(odr, buffers[half][i]);
+            trace_push(odr);
+            stats->transfers++;
+        }
+
+        // Transfer complete of this half; the DMA is on the other one.
+        stats->interrupts++;
+        holds[half] = 0;
+        if (!holds[half ^ 1])
+        {
+            break;
+        }
+        holds[half] = Waveform_Fill(stream, buffers[half], half_words) != 0;
+        half ^= 1;
+    }
+
+    free(buffers[0]);
+    free(buffers[1]);
+}
+
+/* -------------------------------------------------------------------
+ * Measuring and decoding one lane.
+ * ------------------------------------------------------------------- */
+typedef struct
+{
+    size_t bits;
+    size_t bad_bits;
+    size_t timing_errors;
+    double min_high[2], max_high[2];
+    double min_bit, max_bit;
+    double reset;               // ns from the last bit to the end of the stream
+} lane_result_t;
+
+static int lane_active(const WaveformProtocol_t *p, uint16_t odr, uint16_t pin)
+{
+    int high = (odr & pin) != 0;
+
+    return p->activeLow ? !high : high;
+}
+
+static void timing_error(lane_result_t *r, int lane, const char *what, size_t bit, double ns,
+                         double want, double tol)
+{
+    if (r->timing_errors++ < MAX_ERRORS)
+    {
+        printf("  lane %d bit %zu: %s %.1f ns, want %.1f +- %.1f\n", lane, bit, what, ns, want, tol);
+    }
+}
+
+// Pulse width coded protocols: each bit is an active pulse, the longer
+// one is a 1.
+static void decode_pulses(const WaveformProtocol_t *p, const spec_t *spec, double slot_ns,
+                          uint16_t pin, int lane, const uint8_t *data, size_t bytes,
+                          lane_result_t *r)
+{
+    size_t prev_rise = 0, last_fall = 0;
+    int have_rise = 0;
+    double threshold = (spec->t0h + spec->t1h) / 2.0;
+
+    for (size_t i = 1; i < trace_len; i++)
+    {
+        int was = lane_active(p, odr_trace[i - 1], pin);
+        int now = lane_active(p, odr_trace[i], pin);
+
+        if (!was && now)
+        {
+            if (have_rise)
+            {
+                double bit_ns = (double) (i - prev_rise) * slot_ns;
+
+                if (bit_ns < r->min_bit) r->min_bit = bit_ns;
+                if (bit_ns > r->max_bit) r->max_bit = bit_ns;
+                if (bit_ns >= spec->reset)
+                {
+                    timing_error(r, lane, "gap latches the chain:", r->bits, bit_ns, spec->bit, spec->bit_tol);
+                }
+                else if (bit_ns < spec->bit - spec->bit_tol || bit_ns > spec->bit + spec->bit_tol)
+                {
+                    timing_error(r, lane, "bit period", r->bits, bit_ns, spec->bit, spec->bit_tol);
+                }
+            }
+            prev_rise = i;
+            have_rise = 1;
+        }
+        else if (was && !now && have_rise)
+        {
+            double high_ns = (double) (i - prev_rise) * slot_ns;
+            int value = high_ns > threshold;
+            double want = value ? spec->t1h : spec->t0h;
+            size_t bit = r->bits++;
+
+            if (high_ns < r->min_high[value]) r->min_high[value] = high_ns;
+            if (high_ns > r->max_high[value]) r->max_high[value] = high_ns;
+            if (high_ns < want - spec->pulse_tol || high_ns > want + spec->pulse_tol)
+            {
+                timing_error(r, lane, value ? "T1H" : "T0H", bit, high_ns, want, spec->pulse_tol);
+            }
+            if (bit >= bytes * 8 || ((data[bit / 8] >> (7 - bit % 8)) & 1) != value)
+            {
+                r->bad_bits++;
+            }
+            last_fall = i;
+        }
+    }
+
+    r->reset = (double) (trace_len - last_fall) * slot_ns;
+}
+
+// NRZ: one level per bit, sampled in the middle of each bit period
+// counted from the start of the stream.
+static void decode_levels(const WaveformProtocol_t *p, double slot_ns, uint16_t pin,
+                          const uint8_t *data, size_t bytes, lane_result_t *r)
+{
+    size_t bits = bytes * 8;
+
+    for (size_t bit = 0; bit < bits; bit++)
+    {
+        size_t at = 1 + bit * p->slotsPerBit + p->slotsPerBit / 2;
+        int value;
+
+        if (at >= trace_len)
+        {
+            r->bad_bits += bits - bit;
+            break;
+        }
+        value = lane_active(p, odr_trace[at], pin);
+        r->bits++;
+        if (((data[bit / 8] >> (7 - bit % 8)) & 1) != value)
+        {
+            r->bad_bits++;
+        }
+    }
+
+    r->reset = (double) (trace_len - 1 - bits * p->slotsPerBit) * slot_ns;
+}
+
+/* -------------------------------------------------------------------
+ * VCD output.
+ * ------------------------------------------------------------------- */
+static int write_vcd(const char *path, int lanes, double slot_ns)
+{
+    FILE *f = fopen(path, "w");
+
+    if (f == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    fprintf(f, "$timescale 1ps $end\n$scope module waveform $end\n");
+    for (int lane = 0; lane < lanes; lane++)
+    {
+        fprintf(f, "$var wire 1 %c lane%d $end\n", '!' + lane, lane);
+    }
+    fprintf(f, "$upscope $end\n$enddefinitions $end\n");
+
+    for (size_t i = 0; i < trace_len; i++)
+    {
+        int printed = 0;
+
+        for (int lane = 0; lane < lanes; lane++)
+        {
+            uint16_t pin = (uint16_t) (1U << lane);
+
+            if (i == 0 || ((odr_trace[i] ^ odr_trace[i - 1]) & pin))
+            {
+                if (!printed)
+                {
+                    fprintf(f, "#%.0f\n", (double) i * slot_ns * 1000.0);
+                    printed = 1;
+                }
+                fprintf(f, "%d%c\n", (odr_trace[i] & pin) ? 1 : 0, '!' + lane);
+            }
+        }
+    }
+    fprintf(f, "#%.0f\n", (double) trace_len * slot_ns * 1000.0);
+
+    fclose(f);
+    return 0;
+}
+
+/* -------------------------------------------------------------------
+ * Main
+ * ------------------------------------------------------------------- */
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -p name       protocol preset: ws2812 (default), sk6812\n"
+            "  -c slot,slots,high0,high1,trailer[,low]\n"
+            "                custom protocol: slot in ns, slots per bit, active slots\n"
+            "                of a 0 and a 1 bit, trailer slots, 1 if active low\n"
+            "  -T ns         tolerance of a custom protocol (default 150)\n"
+            "  -t hz         timer clock (default 100000000)\n"
+            "  -w words      words in each half of the buffer (default 384)\n"
+            "  -l lanes      lanes sent side by side (default 1)\n"
+            "  -n bytes      bytes per lane (default 24)\n"
+            "  -s seed       seed of the random data (default 1)\n"
+            "  -o file.vcd   write the lanes to a VCD file\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    WaveformProtocol_t protocol = presets[0].protocol;
+    spec_t spec = presets[0].spec;
+    const char *vcd = NULL;
+    unsigned long timer_hz = 100000000UL;
+    unsigned long buffer_words = 384;
+    unsigned long bytes = 24;
+    unsigned long seed = 1;
+    double tolerance = 150.0;
+    int custom = 0;
+    int lanes = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:c:T:t:w:l:n:s:o:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'p':
+        {
+            size_t i;
+
+            for (i = 0; i < PRESET_COUNT && strcmp(presets[i].name, optarg) != 0; i++)
+            {
+            }
+            if (i == PRESET_COUNT)
+            {
+                fprintf(stderr, "unknown protocol %s\n", optarg);
+                return 2;
+            }
+            protocol = presets[i].protocol;
+            spec = presets[i].spec;
+            custom = 0;
+            break;
+        }
+        case 'c':
+        {
+            unsigned slot, slots, h0, h1, trailer, low = 0;
+
+            if (sscanf(optarg, "%u,%u,%u,%u,%u,%u", &slot, &slots, &h0, &h1, &trailer, &low) < 5 ||
+                slot == 0 || slots == 0 || slots > 255 || h0 > slots || h1 > slots ||
+                (h0 > 0 && (h0 >= h1 || h1 >= slots)) || trailer > 65535)
+            {
+                fprintf(stderr, "bad protocol %s\n", optarg);
+                return 2;
+            }
+            protocol.slotNs = slot;
+            protocol.slotsPerBit = (uint8_t) slots;
+            protocol.highSlots[0] = (uint8_t) h0;
+            protocol.highSlots[1] = (uint8_t) h1;
+            protocol.trailerSlots = (uint16_t) trailer;
+            protocol.activeLow = (uint8_t) (low != 0);
+            custom = 1;
+            break;
+        }
+        case 'T': tolerance = atof(optarg); break;
+        case 't': timer_hz = strtoul(optarg, NULL, 0); break;
+        case 'w': buffer_words = strtoul(optarg, NULL, 0); break;
+        case 'l': lanes = atoi(optarg); break;
+        case 'n': bytes = strtoul(optarg, NULL, 0); break;
+        case 's': seed = strtoul(optarg, NULL, 0); break;
+        case 'o': vcd = optarg; break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (timer_hz == 0 || lanes < 1 || lanes > WAVEFORM_MAX_LANES || bytes == 0)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (custom)
+    {
+        spec.t0h = (double) protocol.highSlots[0] * protocol.slotNs;
+        spec.t1h = (double) protocol.highSlots[1] * protocol.slotNs;
+        spec.pulse_tol = tolerance;
+        spec.bit = (double) protocol.slotsPerBit * protocol.slotNs;
+        spec.bit_tol = tolerance;
+        spec.reset = (double) protocol.trailerSlots * protocol.slotNs;
+    }
+
+    // The timer's slot, rounded as Waveform_Init() does.
+    uint64_t ticks = ((uint64_t) timer_hz * protocol.slotNs + 500000000U) / 1000000000U;
+    if (ticks < 16 || ticks > 65536)
+    {
+        printf("FAIL: a %u ns slot is %llu ticks of %lu Hz, the engine takes 16 to 65536\n",
+               (unsigned) protocol.slotNs, (unsigned long long) ticks, timer_hz);
+        return 1;
+    }
+    double slot_ns = (double) ticks * 1e9 / (double) timer_hz;
+
+    uint32_t half_words = (uint32_t) (buffer_words / protocol.slotsPerBit) * protocol.slotsPerBit;
+    if (half_words == 0)
+    {
+        fprintf(stderr, "a half of the buffer must hold a whole bit\n");
+        return 2;
+    }
+
+    // Random data, different on each lane.
+    uint8_t *data[WAVEFORM_MAX_LANES];
+    uint16_t pins[WAVEFORM_MAX_LANES];
+    uint32_t x = (uint32_t) seed ? (uint32_t) seed : 1U;
+
+    for (int lane = 0; lane < lanes; lane++)
+    {
+        data[lane] = malloc(bytes);
+        if (data[lane] == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            return 2;
+        }
+        for (unsigned long i = 0; i < bytes; i++)
+        {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            data[lane][i] = (uint8_t) x;
+        }
+        pins[lane] = (uint16_t) (1U << lane);
+    }
+
+    // Run the engine from the idle level Waveform_Init() sets.
+    WaveformStream_t stream;
+    engine_stats_t stats;
+    uint16_t all = (uint16_t) ((1U << lanes) - 1U);
+
+    Waveform_StreamInit(&stream, &protocol, (uint8_t) lanes, pins,
+                        (const uint8_t *const *) data, (uint32_t) bytes);
+    run_engine(&stream, half_words, protocol.activeLow ? all : 0, &stats);
+
+    printf("Protocol:  %u ns slots (%llu ticks, really %.1f ns), %u slots per bit, "
+           "active %u/%u slots, %u trailer slots%s\n",
+           (unsigned) protocol.slotNs, (unsigned long long) ticks, slot_ns,
+           (unsigned) protocol.slotsPerBit, (unsigned) protocol.highSlots[0],
+           (unsigned) protocol.highSlots[1], (unsigned) protocol.trailerSlots,
+           protocol.activeLow ? ", active low" : "");
+    printf("Stream:    %d lane(s) of %lu bytes, %.1f us until the timer stops\n",
+           lanes, bytes, (double) (trace_len - 1) * slot_ns / 1000.0);
+    printf("Engine:    %lu DMA transfers, %lu interrupts, %.1f us to refill each half\n",
+           stats.transfers, stats.interrupts, (double) half_words * slot_ns / 1000.0);
+
+    // Check each lane.
+    int pass = 1;
+
+    printf("%-5s %6s %6s %15s %15s %15s %10s\n",
+           "Lane", "Bits", "Wrong", "0 active ns", "1 active ns", "Bit ns", "Reset us");
+
+    for (int lane = 0; lane < lanes; lane++)
+    {
+        lane_result_t r;
+
+        memset(&r, 0, sizeof(r));
+        r.min_high[0] = r.min_high[1] = r.min_bit = 1e300;
+
+        if (protocol.highSlots[0] > 0)
+        {
+            decode_pulses(&protocol, &spec, slot_ns, pins[lane], lane, data[lane], bytes, &r);
+        }
+        else
+        {
+            decode_levels(&protocol, slot_ns, pins[lane], data[lane], bytes, &r);
+        }
+
+        if (r.bits != bytes * 8 || r.bad_bits != 0)
+        {
+            printf("  lane %d: decoded %zu bits, %zu differ from the data\n", lane, r.bits, r.bad_bits);
+            pass = 0;
+        }
+        if (r.reset < spec.reset)
+        {
+            printf("  lane %d: %.1f us inactive after the last bit, the chain needs %.1f us\n",
+                   lane, r.reset / 1000.0, spec.reset / 1000.0);
+            pass = 0;
+        }
+        if (r.timing_errors > 0)
+        {
+            if (r.timing_errors > MAX_ERRORS)
+            {
+                printf("  lane %d: %zu more timing errors\n", lane, r.timing_errors - MAX_ERRORS);
+            }
+            pass = 0;
+        }
+
+        printf("%-5d %6zu %6zu", lane, r.bits, r.bad_bits);
+        for (int value = 0; value < 2; value++)
+        {
+            if (r.max_high[value] > 0.0)
+            {
+                printf(" %7.1f-%-7.1f", r.min_high[value], r.max_high[value]);
+            }
+            else
+            {
+                printf(" %15s", "-");
+            }
+        }
+        if (r.max_bit > 0.0)
+        {
+            printf(" %7.1f-%-7.1f", r.min_bit, r.max_bit);
+        }
+        else
+        {
+            printf(" %15s", "-");
+        }
+        printf(" %10.1f\n", r.reset / 1000.0);
+    }
+
+    if (vcd != NULL && write_vcd(vcd, lanes, slot_ns) != 0)
+    {
+        return 2;
+    }
+
+    printf("%s\n", pass ? "PASS" : "FAIL");
+
+    for (int lane = 0; lane < lanes; lane++)
+    {
+        free(data[lane]);
+    }
+    free(odr_trace);
+    return pass ? 0 : 1;
+}